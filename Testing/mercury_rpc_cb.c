@@ -319,6 +319,53 @@ HG_TEST_RPC_CB(hg_test_cancel_rpc, handle)
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+HG_TEST_RPC_CB(hg_test_late_rpc, handle)
+{
+    hg_return_t ret = HG_SUCCESS;
+
+    /* Respond once the origin has given up */
+    hg_time_sleep(hg_time_from_double(HG_TEST_LATE_RPC_DELAY / 1000.0));
+
+    ret = HG_Respond(handle, NULL, NULL, NULL);
+    HG_TEST_CHECK_ERROR_DONE(
+        ret != HG_SUCCESS, "HG_Respond() failed (%s)", HG_Error_to_string(ret));
+
+    ret = HG_Destroy(handle);
+    HG_TEST_CHECK_ERROR_DONE(
+        ret != HG_SUCCESS, "HG_Destroy() failed (%s)", HG_Error_to_string(ret));
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+HG_TEST_RPC_CB(hg_test_echo, handle)
+{
+    perf_rpc_lat_in_t in_struct;
+    hg_return_t ret = HG_SUCCESS;
+
+    /* Get input struct */
+    ret = HG_Get_input(handle, &in_struct);
+    HG_TEST_CHECK_HG_ERROR(
+        done, ret, "HG_Get_input() failed (%s)", HG_Error_to_string(ret));
+
+    /* Send payload back */
+    ret = HG_Respond(handle, NULL, NULL, &in_struct);
+    HG_TEST_CHECK_HG_ERROR(
+        done, ret, "HG_Respond() failed (%s)", HG_Error_to_string(ret));
+
+    ret = HG_Free_input(handle, &in_struct);
+    HG_TEST_CHECK_HG_ERROR(
+        done, ret, "HG_Free_input() failed (%s)", HG_Error_to_string(ret));
+
+done:
+    ret = HG_Destroy(handle);
+    HG_TEST_CHECK_ERROR_DONE(
+        ret != HG_SUCCESS, "HG_Destroy() failed (%s)", HG_Error_to_string(ret));
+
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 HG_TEST_RPC_CB(hg_test_bulk_write, handle)
 {
@@ -903,6 +950,8 @@ HG_TEST_THREAD_CB(hg_test_rpc_open)
 HG_TEST_THREAD_CB(hg_test_rpc_open_no_resp)
 HG_TEST_THREAD_CB(hg_test_overflow)
 HG_TEST_THREAD_CB(hg_test_cancel_rpc)
+HG_TEST_THREAD_CB(hg_test_echo)
+HG_TEST_THREAD_CB(hg_test_late_rpc)
 
 HG_TEST_THREAD_CB(hg_test_bulk_write)
 HG_TEST_THREAD_CB(hg_test_bulk_bind_write)
@@ -24,6 +24,10 @@ hg_return_t
 hg_test_overflow_cb(hg_handle_t handle);
 hg_return_t
 hg_test_cancel_rpc_cb(hg_handle_t handle);
+hg_return_t
+hg_test_echo_cb(hg_handle_t handle);
+hg_return_t
+hg_test_late_rpc_cb(hg_handle_t handle);
 
 /**
  * test_bulk
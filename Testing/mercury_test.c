@@ -81,6 +81,8 @@ hg_id_t hg_test_rpc_open_id_g = 0;
 hg_id_t hg_test_rpc_open_id_no_resp_g = 0;
 hg_id_t hg_test_overflow_id_g = 0;
 hg_id_t hg_test_cancel_rpc_id_g = 0;
+hg_id_t hg_test_echo_id_g = 0;
+hg_id_t hg_test_late_rpc_id_g = 0;
 
 /* test_bulk */
 hg_id_t hg_test_bulk_write_id_g = 0;
@@ -292,6 +294,10 @@ hg_test_register(hg_class_t *hg_class)
         overflow_out_t, hg_test_overflow_cb);
     hg_test_cancel_rpc_id_g = MERCURY_REGISTER(
         hg_class, "hg_test_cancel_rpc", void, void, hg_test_cancel_rpc_cb);
+    hg_test_echo_id_g = MERCURY_REGISTER(hg_class, "hg_test_echo",
+        perf_rpc_lat_in_t, perf_rpc_lat_in_t, hg_test_echo_cb);
+    hg_test_late_rpc_id_g = MERCURY_REGISTER(
+        hg_class, "hg_test_late_rpc", void, void, hg_test_late_rpc_cb);
 
     /* test_bulk */
     hg_test_bulk_write_id_g = MERCURY_REGISTER(hg_class, "hg_test_bulk_write",
@@ -368,6 +374,16 @@ HG_Test_init(int argc, char *argv[], struct hg_test_info *hg_test_info)
     if (hg_test_info->na_test_info.busy_wait)
         hg_init_info.na_init_info.progress_mode = NA_NO_BLOCK;
 
+    /* Set single-threaded mode, servers use a progress thread and may run
+     * RPC callbacks from a thread pool */
+    if (hg_test_info->na_test_info.single_thread) {
+        HG_TEST_CHECK_ERROR(hg_test_info->na_test_info.listen ||
+                                hg_test_info->na_test_info.self_send,
+            done, ret, HG_INVALID_ARG,
+            "Single-threaded mode is only supported by clients");
+        hg_init_info.single_threaded = HG_TRUE;
+    }
+
         /* Set stats */
 #ifdef HG_HAS_COLLECT_STATS
     hg_init_info.stats = HG_TRUE;
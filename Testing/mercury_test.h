@@ -97,6 +97,10 @@ extern unsigned int HG_TEST_LOG_MASK;
 #    define HG_TEST_LOG_WARNING(...) (void) 0
 #endif
 
+/* Delay (ms) before hg_test_late_rpc responds, longer than the deadline of
+ * timed RPCs so that the response arrives after the origin gave up */
+#define HG_TEST_LATE_RPC_DELAY 300
+
 /* Branch predictor hints */
 #ifndef _WIN32
 #    define likely(x)   __builtin_expect(!!(x), 1)
@@ -98,6 +98,7 @@ na_test_usage(const char *execname)
     printf("    -k, --key           Pass auth key\n");
     printf("    -l, --loop          Number of loops (default: 1)\n");
     printf("    -b, --busy          Busy wait\n");
+    printf("    -T, --single_thread Single-threaded client\n");
     printf("    -V, --verbose       Print verbose output\n");
 }
 
@@ -161,6 +162,9 @@ na_test_parse_options(int argc, char *argv[], struct na_test_info *na_test_info)
             case 'b': /* busy */
                 na_test_info->busy_wait = NA_TRUE;
                 break;
+            case 'T': /* single thread */
+                na_test_info->single_thread = NA_TRUE;
+                break;
             case 'C': /* number of contexts */
                 na_test_info->max_contexts =
                     (na_uint8_t) atoi(na_test_opt_arg_g);
@@ -419,6 +423,10 @@ NA_Test_init(int argc, char *argv[], struct na_test_info *na_test_info)
         na_init_info.progress_mode = NA_NO_BLOCK;
         printf("# Initializing NA in busy wait mode\n");
     }
+    if (na_test_info->single_thread) {
+        na_init_info.progress_mode |= NA_SINGLE_THREAD;
+        printf("# Initializing NA in single-threaded mode\n");
+    }
     na_init_info.auth_key = na_test_info->key;
     na_init_info.max_contexts = na_test_info->max_contexts;
 
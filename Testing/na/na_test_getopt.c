@@ -17,7 +17,7 @@
 
 int na_test_opt_ind_g = 1;            /* token pointer */
 const char *na_test_opt_arg_g = NULL; /* flag argument (or value) */
-const char *na_test_short_opt_g = "hc:d:p:H:P:LsSak:l:t:bmC:V";
+const char *na_test_short_opt_g = "hc:d:p:H:P:LsSak:l:t:bTmC:V";
 const struct na_test_opt na_test_opt_g[] = {
     {"help", no_arg, 'h'}, {"comm", require_arg, 'c'},
     {"domain", require_arg, 'd'}, {"protocol", require_arg, 'p'},
@@ -26,8 +26,9 @@ const struct na_test_opt na_test_opt_g[] = {
     {"self_send", no_arg, 'S'}, {"auth", no_arg, 'a'},
     {"key", require_arg, 'k'}, {"loop", require_arg, 'l'},
     {"threads", require_arg, 't'}, {"busy", no_arg, 'b'},
-    {"memory", no_arg, 'm'}, {"contexts", require_arg, 'C'},
-    {"verbose", no_arg, 'V'}, {NULL, 0, '\0'} /* Must add this at the end */
+    {"single_thread", no_arg, 'T'}, {"memory", no_arg, 'm'},
+    {"contexts", require_arg, 'C'}, {"verbose", no_arg, 'V'},
+    {NULL, 0, '\0'} /* Must add this at the end */
 };
 
 int
@@ -0,0 +1,2050 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#include "mercury.h"
+#include "mercury_bulk.h"
+#include "mercury_core.h"
+#include "mercury_macros.h"
+#include "mercury_proc.h"
+#include "mercury_proc_bulk.h"
+
+#ifdef NA_HAS_SM
+#    include "na_sm.h"
+#endif
+
+#include "mercury_atomic.h"
+#include "mercury_atomic_queue.h"
+#include "mercury_bench.h"
+#include "mercury_thread.h"
+#include "mercury_thread_mutex.h"
+#include "mercury_time.h"
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/****************/
+/* Local Macros */
+/****************/
+
+#define HG_BENCH_MAX_LIST         64
+#define HG_BENCH_MAX_PROCS        256
+#define HG_BENCH_MAX_CONTEXTS     64
+#define HG_BENCH_ADDR_MAX         256
+#define HG_BENCH_PROGRESS_TIMEOUT 100 /* ms */
+
+#define HG_BENCH_DEFAULT_INFO       "na+sm"
+#define HG_BENCH_DEFAULT_ITERATIONS 10000
+#define HG_BENCH_DEFAULT_WARMUP     100
+#define HG_BENCH_DEFAULT_TOLERANCE  20 /* % */
+
+/* Report errors and bail out */
+#define HG_BENCH_CHECK(cond, label, ...)                                       \
+    do {                                                                       \
+        if (cond) {                                                            \
+            fprintf(stderr, "hg_bench: " __VA_ARGS__);                         \
+            fputc('\n', stderr);                                               \
+            goto label;                                                        \
+        }                                                                      \
+    } while (0)
+
+/************************************/
+/* Local Type and Struct Definition */
+/************************************/
+
+/* Benchmark types */
+typedef enum {
+    HG_BENCH_RPC_LAT,  /* Ping-pong latency */
+    HG_BENCH_RPC_RATE, /* RPC rate with several RPCs in flight */
+    HG_BENCH_BULK_BW,  /* Bulk pull / push bandwidth */
+    HG_BENCH_OVERFLOW, /* RPCs larger than the eager size */
+    HG_BENCH_LOOKUP    /* Address lookup */
+} hg_bench_type_t;
+
+/* Process modes */
+typedef enum {
+    HG_BENCH_MODE_INPROC, /* Server thread in the same process */
+    HG_BENCH_MODE_FORK,   /* Server in a forked process */
+    HG_BENCH_MODE_SERVER, /* Server only */
+    HG_BENCH_MODE_CLIENT  /* Client only */
+} hg_bench_mode_t;
+
+struct hg_bench_command {
+    const char *name;
+    hg_bench_type_t type;
+    const char *sizes;  /* Default sizes */
+    const char *depths; /* Default in-flight depths */
+    const char *description;
+};
+
+struct hg_bench_opts {
+    const struct hg_bench_command *command;
+    hg_bench_mode_t mode;
+    const char *info_string;
+    const char *addr_string;
+    const char *addr_file;
+    const char *json_path;
+    const char *baseline_path;
+    struct hg_bench_baseline *baseline; /* Regression gate */
+    double tolerance;
+    size_t sizes[HG_BENCH_MAX_LIST];
+    size_t depths[HG_BENCH_MAX_LIST];
+    size_t threads[HG_BENCH_MAX_LIST];
+    size_t contexts[HG_BENCH_MAX_LIST];
+    size_t procs[HG_BENCH_MAX_LIST];
+    unsigned int nsizes;
+    unsigned int ndepths;
+    unsigned int nthreads;
+    unsigned int ncontexts;
+    unsigned int nprocs;
+    int report_fd; /* Reports results to the parent (client processes) */
+    unsigned int iterations;
+    unsigned int warmup;
+    unsigned int repeat;
+    hg_bool_t push;
+    hg_bool_t single_threaded;
+    hg_bool_t shutdown;
+    hg_bool_t update_baseline;
+};
+
+/* RPC payload (echoed by the server) */
+struct hg_bench_payload {
+    hg_uint64_t size;
+    void *buf;
+};
+
+/* Bulk RPC input */
+struct hg_bench_bulk_in {
+    hg_bulk_t bulk;
+    hg_uint64_t size;
+    hg_uint8_t push;
+};
+
+/* Registered server buffer */
+struct hg_bench_buf {
+    struct hg_bench_buf *next;
+    void *buf;
+    size_t size;
+    hg_bulk_t bulk;
+};
+
+struct hg_bench_server {
+    hg_class_t *hg_class;
+    hg_context_t *context;
+    hg_thread_t thread;
+    hg_thread_mutex_t buf_lock;
+    struct hg_bench_buf *bufs;
+    hg_atomic_int32_t done;
+    char addr_string[HG_BENCH_ADDR_MAX];
+};
+
+/* Pending bulk transfer on the server */
+struct hg_bench_bulk_arg {
+    hg_handle_t handle;
+    struct hg_bench_buf *buf;
+    struct hg_bench_bulk_in in;
+};
+
+struct hg_bench_client {
+    struct hg_bench_opts *opts;
+    hg_class_t *hg_class;
+    hg_context_t *contexts[HG_BENCH_MAX_CONTEXTS];
+    unsigned int ncontexts;
+    hg_addr_t addr;
+    hg_id_t rpc_id;
+    hg_id_t bulk_id;
+    hg_id_t shutdown_id;
+    const char *addr_string;
+};
+
+struct hg_bench_worker;
+
+/* One operation in flight */
+struct hg_bench_op {
+    struct hg_bench_worker *worker;
+    hg_handle_t handle;
+    hg_time_fast_t start;
+    struct hg_bench_payload rpc_in;
+    struct hg_bench_bulk_in bulk_in;
+    void *buf;
+};
+
+struct hg_bench_worker {
+    struct hg_bench_client *client;
+    hg_context_t *context;
+    hg_thread_t thread;
+    struct hg_bench_op *ops;
+    struct hg_atomic_queue *ready; /* Completed ops, forwarded by the worker */
+    unsigned int timeout;          /* Progress timeout (ms) */
+    size_t depth;
+    size_t size;
+    hg_util_int32_t total;
+    hg_atomic_int32_t issued;
+    hg_atomic_int32_t completed;
+    hg_atomic_int32_t errors;
+    hg_bool_t recording;
+    hg_time_fast_t start;
+    hg_time_fast_t end;
+    struct hg_bench_hist hist;
+};
+
+/* NA SM counters accumulated over one configuration */
+struct hg_bench_sm_stats {
+    hg_util_uint64_t send_retries;        /* Server sends retried */
+    hg_util_uint64_t client_send_retries; /* Client sends retried */
+    hg_util_uint64_t unexpected_queued;   /* Server unexpected msgs queued */
+    hg_util_uint64_t unexpected_depth_max; /* Server unexpected queue max */
+    hg_util_uint64_t poll_wakeups;        /* Server poll wakeups */
+    hg_util_uint64_t notify_wakeups;      /* Server notifications */
+};
+
+/* Result of one configuration */
+struct hg_bench_result {
+    size_t size;
+    size_t depth;
+    size_t threads;
+    size_t contexts;
+    size_t procs; /* Client processes (0 if single process) */
+    hg_util_uint64_t ops;
+    hg_util_uint64_t errors;
+    double elapsed;
+    struct hg_bench_stats lat; /* us */
+    hg_bool_t has_sm_stats;
+    struct hg_bench_sm_stats sm_stats;
+};
+
+/* Report sent by a client process after each configuration, followed by
+ * its latency histogram */
+struct hg_bench_report {
+    struct hg_bench_result result;
+    int rc;
+};
+
+/* Client process launched by hg_bench_procs_run() */
+struct hg_bench_proc {
+    pid_t pid;
+    int fd;
+};
+
+/********************/
+/* Local Prototypes */
+/********************/
+
+static void
+hg_bench_usage(const char *execname);
+
+static int
+hg_bench_parse_opts(int argc, char *argv[], struct hg_bench_opts *opts);
+
+static hg_return_t
+hg_proc_hg_bench_payload(hg_proc_t proc, void *data);
+
+static hg_return_t
+hg_proc_hg_bench_bulk_in(hg_proc_t proc, void *data);
+
+static void
+hg_bench_register(hg_class_t *hg_class, void *data, hg_id_t *rpc_id,
+    hg_id_t *bulk_id, hg_id_t *shutdown_id);
+
+static hg_return_t
+hg_bench_rpc_cb(hg_handle_t handle);
+
+static hg_return_t
+hg_bench_bulk_cb(hg_handle_t handle);
+
+static hg_return_t
+hg_bench_bulk_transfer_cb(const struct hg_cb_info *callback_info);
+
+static hg_return_t
+hg_bench_shutdown_cb(hg_handle_t handle);
+
+static int
+hg_bench_server_init(
+    struct hg_bench_server *server, const struct hg_bench_opts *opts);
+
+static void
+hg_bench_server_run(struct hg_bench_server *server);
+
+static HG_THREAD_RETURN_TYPE
+hg_bench_server_thread(void *arg);
+
+static void
+hg_bench_server_finalize(struct hg_bench_server *server);
+
+static int
+hg_bench_client_init(struct hg_bench_client *client,
+    struct hg_bench_opts *opts, const char *addr_string);
+
+static void
+hg_bench_client_finalize(struct hg_bench_client *client);
+
+static int
+hg_bench_client_run(struct hg_bench_client *client);
+
+static int
+hg_bench_measure(struct hg_bench_client *client, size_t size, size_t depth,
+    size_t nthreads, size_t ncontexts, struct hg_bench_hist *hist,
+    struct hg_bench_result *result);
+
+static void
+hg_bench_default_sizes(struct hg_bench_opts *opts, hg_class_t *hg_class);
+
+static hg_bool_t
+hg_bench_get_sm_stats(hg_class_t *hg_class, struct hg_bench_sm_stats *stats);
+
+static int
+hg_bench_report(struct hg_bench_client *client, size_t size, size_t depth,
+    size_t nthreads, size_t ncontexts);
+
+static int
+hg_bench_procs_spawn(char *argv[], char *addr_string,
+    struct hg_bench_proc *procs, size_t nprocs);
+
+static int
+hg_bench_procs_wait(struct hg_bench_proc *procs, size_t nprocs);
+
+static int
+hg_bench_procs_measure(struct hg_bench_server *server,
+    struct hg_bench_proc *procs, size_t nprocs, struct hg_bench_hist *hist,
+    struct hg_bench_result *result);
+
+static int
+hg_bench_procs_run(
+    struct hg_bench_opts *opts, struct hg_bench_server *server, char *argv[]);
+
+static int
+hg_bench_read_full(int fd, void *buf, size_t count);
+
+static int
+hg_bench_write_full(int fd, const void *buf, size_t count);
+
+static int
+hg_bench_worker_init(struct hg_bench_worker *worker);
+
+static void
+hg_bench_worker_finalize(struct hg_bench_worker *worker);
+
+static HG_THREAD_RETURN_TYPE
+hg_bench_worker_run(void *arg);
+
+static void
+hg_bench_worker_phase(struct hg_bench_worker *worker, unsigned int count,
+    hg_bool_t recording);
+
+static void
+hg_bench_worker_lookup(struct hg_bench_worker *worker, unsigned int count,
+    hg_bool_t recording);
+
+static hg_return_t
+hg_bench_op_forward(struct hg_bench_op *op);
+
+static hg_return_t
+hg_bench_forward_cb(const struct hg_cb_info *callback_info);
+
+static void
+hg_bench_progress(hg_context_t *context, unsigned int timeout);
+
+static FILE *
+hg_bench_json_begin(struct hg_bench_json *json,
+    const struct hg_bench_opts *opts, hg_class_t *hg_class);
+
+static void
+hg_bench_json_end(struct hg_bench_json *json, FILE *fp);
+
+static void
+hg_bench_print_header(const struct hg_bench_opts *opts);
+
+static void
+hg_bench_print_result(
+    const struct hg_bench_opts *opts, const struct hg_bench_result *result);
+
+static void
+hg_bench_check_result(
+    const struct hg_bench_opts *opts, const struct hg_bench_result *result);
+
+static void
+hg_bench_json_result(struct hg_bench_json *json,
+    const struct hg_bench_opts *opts, const struct hg_bench_result *result);
+
+/*******************/
+/* Local Variables */
+/*******************/
+
+static const struct hg_bench_command hg_bench_commands_g[] = {
+    {"rpc-lat", HG_BENCH_RPC_LAT, "8-64k", "1", "RPC round-trip latency"},
+    {"rpc-rate", HG_BENCH_RPC_RATE, "8", "1-64", "RPC rate"},
+    {"bulk-bw", HG_BENCH_BULK_BW, "4k-4m", "1,8", "Bulk transfer bandwidth"},
+    {"overflow", HG_BENCH_OVERFLOW, NULL, "1",
+        "RPCs larger than the eager size"},
+    {"lookup", HG_BENCH_LOOKUP, "0", "1", "Address lookup latency"}};
+
+/* Worker of the calling thread, records latencies of triggered callbacks */
+static hg_thread_key_t hg_bench_worker_key_g;
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_usage(const char *execname)
+{
+    size_t i;
+
+    printf("usage: %s <command> [OPTIONS]\n", execname);
+    printf("  Commands:\n");
+    for (i = 0; i < sizeof(hg_bench_commands_g) / sizeof(*hg_bench_commands_g);
+         i++)
+        printf("    %-12s%s\n", hg_bench_commands_g[i].name,
+            hg_bench_commands_g[i].description);
+    printf("  Options:\n");
+    printf("    -h, --help          Print a usage message and exit\n");
+    printf("    -i, --info          NA info string (default: %s)\n",
+        HG_BENCH_DEFAULT_INFO);
+    printf("    -m, --mode          inproc | fork | server | client "
+           "(default: inproc)\n");
+    printf("    -a, --addr          Server address (client mode)\n");
+    printf("    -f, --addr-file     File where the server address is "
+           "written / read\n");
+    printf("    -s, --sizes         Message sizes (e.g., 8,1k or 8-64k)\n");
+    printf("    -d, --depths        RPCs in flight per thread\n");
+    printf("    -t, --threads       Client threads\n");
+    printf("    -c, --contexts      Client contexts (threads share them)\n");
+    printf("    -P, --procs         Client processes sharing one server "
+           "(e.g., 1-16)\n");
+    printf("    -n, --iterations    Operations per thread (default: %d)\n",
+        HG_BENCH_DEFAULT_ITERATIONS);
+    printf("    -w, --warmup        Warmup operations per thread "
+           "(default: %d)\n",
+        HG_BENCH_DEFAULT_WARMUP);
+    printf("    -r, --repeat        Runs of each configuration (baseline "
+           "uses the median)\n");
+    printf("    -p, --push          Push instead of pull (bulk-bw)\n");
+    printf("    -S, --single        Single-threaded client class\n");
+    printf("    -k, --shutdown      Stop server when done (client mode)\n");
+    printf("    -j, --json          Write JSON results to file ('-' for "
+           "stdout)\n");
+    printf("    -b, --baseline      Fail if results regressed from baseline "
+           "file\n");
+    printf("    -T, --tolerance     Allowed regression in %% (default: %d)\n",
+        HG_BENCH_DEFAULT_TOLERANCE);
+    printf("    -U, --update        Update baseline file with results\n");
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_parse_opts(int argc, char *argv[], struct hg_bench_opts *opts)
+{
+    static const struct option long_opts[] = {{"help", no_argument, NULL, 'h'},
+        {"info", required_argument, NULL, 'i'},
+        {"mode", required_argument, NULL, 'm'},
+        {"addr", required_argument, NULL, 'a'},
+        {"addr-file", required_argument, NULL, 'f'},
+        {"sizes", required_argument, NULL, 's'},
+        {"depths", required_argument, NULL, 'd'},
+        {"threads", required_argument, NULL, 't'},
+        {"contexts", required_argument, NULL, 'c'},
+        {"procs", required_argument, NULL, 'P'},
+        {"report-fd", required_argument, NULL, 'R'},
+        {"iterations", required_argument, NULL, 'n'},
+        {"warmup", required_argument, NULL, 'w'},
+        {"repeat", required_argument, NULL, 'r'},
+        {"push", no_argument, NULL, 'p'},
+        {"single", no_argument, NULL, 'S'},
+        {"shutdown", no_argument, NULL, 'k'},
+        {"json", required_argument, NULL, 'j'},
+        {"baseline", required_argument, NULL, 'b'},
+        {"tolerance", required_argument, NULL, 'T'},
+        {"update", no_argument, NULL, 'U'}, {NULL, 0, NULL, 0}};
+    const char *sizes = NULL, *depths = NULL, *threads = "1",
+               *contexts = "1", *procs = NULL;
+    size_t i;
+    int opt;
+
+    memset(opts, 0, sizeof(*opts));
+    opts->mode = HG_BENCH_MODE_INPROC;
+    opts->info_string = HG_BENCH_DEFAULT_INFO;
+    opts->iterations = HG_BENCH_DEFAULT_ITERATIONS;
+    opts->warmup = HG_BENCH_DEFAULT_WARMUP;
+    opts->repeat = 1;
+    opts->report_fd = -1;
+    opts->tolerance = HG_BENCH_DEFAULT_TOLERANCE;
+
+    if (argc < 2 || argv[1][0] == '-') {
+        hg_bench_usage(argv[0]);
+        return -1;
+    }
+    for (i = 0; i < sizeof(hg_bench_commands_g) / sizeof(*hg_bench_commands_g);
+         i++)
+        if (strcmp(argv[1], hg_bench_commands_g[i].name) == 0)
+            opts->command = &hg_bench_commands_g[i];
+    HG_BENCH_CHECK(
+        opts->command == NULL, error, "unknown command \"%s\"", argv[1]);
+
+    optind = 2;
+    while ((opt = getopt_long(argc, argv, "hi:m:a:f:s:d:t:c:P:n:w:r:pSkj:b:T:U",
+                long_opts, NULL)) != -1) {
+        switch (opt) {
+            case 'i':
+                opts->info_string = optarg;
+                break;
+            case 'm':
+                if (strcmp(optarg, "inproc") == 0)
+                    opts->mode = HG_BENCH_MODE_INPROC;
+                else if (strcmp(optarg, "fork") == 0)
+                    opts->mode = HG_BENCH_MODE_FORK;
+                else if (strcmp(optarg, "server") == 0)
+                    opts->mode = HG_BENCH_MODE_SERVER;
+                else if (strcmp(optarg, "client") == 0)
+                    opts->mode = HG_BENCH_MODE_CLIENT;
+                else
+                    HG_BENCH_CHECK(1, error, "unknown mode \"%s\"", optarg);
+                break;
+            case 'a':
+                opts->addr_string = optarg;
+                break;
+            case 'f':
+                opts->addr_file = optarg;
+                break;
+            case 's':
+                sizes = optarg;
+                break;
+            case 'd':
+                depths = optarg;
+                break;
+            case 't':
+                threads = optarg;
+                break;
+            case 'c':
+                contexts = optarg;
+                break;
+            case 'P':
+                procs = optarg;
+                break;
+            case 'R':
+                opts->report_fd = (int) strtol(optarg, NULL, 0);
+                break;
+            case 'n':
+                opts->iterations = (unsigned int) strtoul(optarg, NULL, 0);
+                break;
+            case 'w':
+                opts->warmup = (unsigned int) strtoul(optarg, NULL, 0);
+                break;
+            case 'r':
+                opts->repeat = (unsigned int) strtoul(optarg, NULL, 0);
+                break;
+            case 'p':
+                opts->push = HG_TRUE;
+                break;
+            case 'S':
+                opts->single_threaded = HG_TRUE;
+                break;
+            case 'k':
+                opts->shutdown = HG_TRUE;
+                break;
+            case 'j':
+                opts->json_path = optarg;
+                break;
+            case 'b':
+                opts->baseline_path = optarg;
+                break;
+            case 'T':
+                opts->tolerance = strtod(optarg, NULL);
+                break;
+            case 'U':
+                opts->update_baseline = HG_TRUE;
+                break;
+            case 'h':
+            default:
+                hg_bench_usage(argv[0]);
+                return -1;
+        }
+    }
+
+    /* Overflow sizes depend on the eager size and are set by the client */
+    if (sizes == NULL)
+        sizes = opts->command->sizes;
+    if (sizes) {
+        opts->nsizes =
+            hg_bench_parse_list(sizes, opts->sizes, HG_BENCH_MAX_LIST);
+        HG_BENCH_CHECK(opts->nsizes == 0, error, "invalid sizes \"%s\"", sizes);
+    }
+    if (depths == NULL)
+        depths = opts->command->depths;
+    opts->ndepths =
+        hg_bench_parse_list(depths, opts->depths, HG_BENCH_MAX_LIST);
+    HG_BENCH_CHECK(opts->ndepths == 0, error, "invalid depths \"%s\"", depths);
+    opts->nthreads =
+        hg_bench_parse_list(threads, opts->threads, HG_BENCH_MAX_LIST);
+    HG_BENCH_CHECK(
+        opts->nthreads == 0, error, "invalid threads \"%s\"", threads);
+    opts->ncontexts =
+        hg_bench_parse_list(contexts, opts->contexts, HG_BENCH_MAX_LIST);
+    HG_BENCH_CHECK(
+        opts->ncontexts == 0, error, "invalid contexts \"%s\"", contexts);
+    if (procs) {
+        opts->nprocs =
+            hg_bench_parse_list(procs, opts->procs, HG_BENCH_MAX_LIST);
+        HG_BENCH_CHECK(
+            opts->nprocs == 0, error, "invalid procs \"%s\"", procs);
+    }
+
+    for (i = 0; i < opts->ndepths; i++)
+        HG_BENCH_CHECK(opts->depths[i] == 0, error, "depth must be > 0");
+    for (i = 0; i < opts->nthreads; i++)
+        HG_BENCH_CHECK(opts->threads[i] == 0, error, "threads must be > 0");
+    for (i = 0; i < opts->ncontexts; i++)
+        HG_BENCH_CHECK(opts->contexts[i] == 0 ||
+                           opts->contexts[i] > HG_BENCH_MAX_CONTEXTS,
+            error, "contexts must be within [1, %d]", HG_BENCH_MAX_CONTEXTS);
+    for (i = 0; i < opts->nprocs; i++)
+        HG_BENCH_CHECK(opts->procs[i] == 0 ||
+                           opts->procs[i] > HG_BENCH_MAX_PROCS,
+            error, "procs must be within [1, %d]", HG_BENCH_MAX_PROCS);
+    HG_BENCH_CHECK(opts->nprocs > 0 && opts->mode != HG_BENCH_MODE_INPROC &&
+                       opts->report_fd < 0,
+        error, "--procs requires inproc mode");
+    HG_BENCH_CHECK(opts->iterations == 0, error, "iterations must be > 0");
+    HG_BENCH_CHECK(opts->repeat == 0, error, "repeat must be > 0");
+    HG_BENCH_CHECK(opts->update_baseline && opts->baseline_path == NULL,
+        error, "--update requires --baseline");
+    HG_BENCH_CHECK(opts->mode == HG_BENCH_MODE_CLIENT &&
+                       opts->addr_string == NULL && opts->addr_file == NULL,
+        error, "client mode requires --addr or --addr-file");
+
+    return 0;
+
+error:
+    return -1;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_proc_hg_bench_payload(hg_proc_t proc, void *data)
+{
+    struct hg_bench_payload *payload = (struct hg_bench_payload *) data;
+    hg_return_t ret;
+
+    ret = hg_proc_hg_uint64_t(proc, &payload->size);
+    if (ret != HG_SUCCESS || payload->size == 0)
+        return ret;
+
+    switch (hg_proc_get_op(proc)) {
+        case HG_DECODE:
+            payload->buf = malloc(payload->size);
+            if (payload->buf == NULL)
+                return HG_NOMEM;
+            ret = hg_proc_raw(proc, payload->buf, payload->size);
+            break;
+        case HG_ENCODE:
+            ret = hg_proc_raw(proc, payload->buf, payload->size);
+            break;
+        case HG_FREE:
+            free(payload->buf);
+            payload->buf = NULL;
+            break;
+        default:
+            break;
+    }
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_proc_hg_bench_bulk_in(hg_proc_t proc, void *data)
+{
+    struct hg_bench_bulk_in *in = (struct hg_bench_bulk_in *) data;
+    hg_return_t ret;
+
+    ret = hg_proc_hg_bulk_t(proc, &in->bulk);
+    if (ret != HG_SUCCESS)
+        return ret;
+    ret = hg_proc_hg_uint64_t(proc, &in->size);
+    if (ret != HG_SUCCESS)
+        return ret;
+
+    return hg_proc_hg_uint8_t(proc, &in->push);
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_register(hg_class_t *hg_class, void *data, hg_id_t *rpc_id,
+    hg_id_t *bulk_id, hg_id_t *shutdown_id)
+{
+    hg_id_t id;
+
+    id = MERCURY_REGISTER(hg_class, "hg_bench_rpc", hg_bench_payload,
+        hg_bench_payload, hg_bench_rpc_cb);
+    if (rpc_id)
+        *rpc_id = id;
+    id = MERCURY_REGISTER(
+        hg_class, "hg_bench_bulk", hg_bench_bulk_in, void, hg_bench_bulk_cb);
+    if (data)
+        HG_Register_data(hg_class, id, data, NULL);
+    if (bulk_id)
+        *bulk_id = id;
+    id = MERCURY_REGISTER(
+        hg_class, "hg_bench_shutdown", void, void, hg_bench_shutdown_cb);
+    if (data)
+        HG_Register_data(hg_class, id, data, NULL);
+    if (shutdown_id)
+        *shutdown_id = id;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_bench_rpc_cb(hg_handle_t handle)
+{
+    struct hg_bench_payload payload = {0, NULL};
+    hg_return_t ret;
+
+    ret = HG_Get_input(handle, &payload);
+    if (ret == HG_SUCCESS) {
+        /* Echo payload back */
+        ret = HG_Respond(handle, NULL, NULL, &payload);
+        HG_Free_input(handle, &payload);
+    }
+    HG_Destroy(handle);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_bench_bulk_cb(hg_handle_t handle)
+{
+    const struct hg_info *info = HG_Get_info(handle);
+    struct hg_bench_server *server =
+        (struct hg_bench_server *) HG_Registered_data(info->hg_class, info->id);
+    struct hg_bench_bulk_arg *arg = NULL;
+    struct hg_bench_buf **buf_ptr;
+    hg_return_t ret;
+
+    arg = (struct hg_bench_bulk_arg *) calloc(1, sizeof(*arg));
+    HG_BENCH_CHECK(arg == NULL, error, "could not allocate bulk arg");
+    arg->handle = handle;
+
+    ret = HG_Get_input(handle, &arg->in);
+    HG_BENCH_CHECK(ret != HG_SUCCESS, error, "could not get bulk input");
+
+    /* Reuse a registered buffer that is large enough */
+    hg_thread_mutex_lock(&server->buf_lock);
+    for (buf_ptr = &server->bufs; *buf_ptr; buf_ptr = &(*buf_ptr)->next)
+        if ((*buf_ptr)->size >= arg->in.size) {
+            arg->buf = *buf_ptr;
+            *buf_ptr = arg->buf->next;
+            break;
+        }
+    hg_thread_mutex_unlock(&server->buf_lock);
+
+    if (arg->buf == NULL && arg->in.size > 0) {
+        arg->buf = (struct hg_bench_buf *) calloc(1, sizeof(*arg->buf));
+        HG_BENCH_CHECK(arg->buf == NULL, error, "could not allocate buffer");
+        arg->buf->size = (size_t) arg->in.size;
+        arg->buf->buf = malloc(arg->buf->size);
+        HG_BENCH_CHECK(
+            arg->buf->buf == NULL, error, "could not allocate buffer");
+        ret = HG_Bulk_create(info->hg_class, 1, &arg->buf->buf,
+            &arg->in.size, HG_BULK_READWRITE, &arg->buf->bulk);
+        HG_BENCH_CHECK(ret != HG_SUCCESS, error, "could not create bulk");
+    }
+
+    if (arg->in.size == 0) {
+        struct hg_cb_info callback_info;
+
+        callback_info.arg = arg;
+        callback_info.ret = HG_SUCCESS;
+        return hg_bench_bulk_transfer_cb(&callback_info);
+    }
+
+    ret = HG_Bulk_transfer(info->context, hg_bench_bulk_transfer_cb, arg,
+        arg->in.push ? HG_BULK_PUSH : HG_BULK_PULL, info->addr, arg->in.bulk,
+        0, arg->buf->bulk, 0, arg->in.size, HG_OP_ID_IGNORE);
+    HG_BENCH_CHECK(ret != HG_SUCCESS, error, "could not transfer bulk");
+
+    return HG_SUCCESS;
+
+error:
+    if (arg) {
+        if (arg->buf) {
+            HG_Bulk_free(arg->buf->bulk);
+            free(arg->buf->buf);
+            free(arg->buf);
+        }
+        HG_Free_input(handle, &arg->in);
+        free(arg);
+    }
+    HG_Destroy(handle);
+
+    return HG_OTHER_ERROR;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_bench_bulk_transfer_cb(const struct hg_cb_info *callback_info)
+{
+    struct hg_bench_bulk_arg *arg =
+        (struct hg_bench_bulk_arg *) callback_info->arg;
+    const struct hg_info *info = HG_Get_info(arg->handle);
+    struct hg_bench_server *server =
+        (struct hg_bench_server *) HG_Registered_data(info->hg_class, info->id);
+    hg_return_t ret;
+
+    ret = HG_Respond(arg->handle, NULL, NULL, NULL);
+
+    if (arg->buf) {
+        hg_thread_mutex_lock(&server->buf_lock);
+        arg->buf->next = server->bufs;
+        server->bufs = arg->buf;
+        hg_thread_mutex_unlock(&server->buf_lock);
+    }
+    HG_Free_input(arg->handle, &arg->in);
+    HG_Destroy(arg->handle);
+    free(arg);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_bench_shutdown_cb(hg_handle_t handle)
+{
+    const struct hg_info *info = HG_Get_info(handle);
+    struct hg_bench_server *server =
+        (struct hg_bench_server *) HG_Registered_data(info->hg_class, info->id);
+    hg_return_t ret;
+
+    ret = HG_Respond(handle, NULL, NULL, NULL);
+    HG_Destroy(handle);
+    hg_atomic_set32(&server->done, 1);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_server_init(
+    struct hg_bench_server *server, const struct hg_bench_opts *opts)
+{
+    hg_size_t addr_string_size = HG_BENCH_ADDR_MAX;
+    hg_addr_t self_addr = HG_ADDR_NULL;
+    hg_return_t ret;
+
+    memset(server, 0, sizeof(*server));
+    hg_thread_mutex_init(&server->buf_lock);
+    hg_atomic_init32(&server->done, 0);
+
+    server->hg_class = HG_Init(opts->info_string, HG_TRUE);
+    HG_BENCH_CHECK(server->hg_class == NULL, error,
+        "could not initialize server with \"%s\"", opts->info_string);
+    server->context = HG_Context_create(server->hg_class);
+    HG_BENCH_CHECK(
+        server->context == NULL, error, "could not create server context");
+    hg_bench_register(server->hg_class, server, NULL, NULL, NULL);
+
+    ret = HG_Addr_self(server->hg_class, &self_addr);
+    HG_BENCH_CHECK(ret != HG_SUCCESS, error, "could not get self address");
+    ret = HG_Addr_to_string(server->hg_class, server->addr_string,
+        &addr_string_size, self_addr);
+    HG_Addr_free(server->hg_class, self_addr);
+    HG_BENCH_CHECK(ret != HG_SUCCESS, error, "could not convert address");
+
+    return 0;
+
+error:
+    hg_bench_server_finalize(server);
+    return -1;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_server_run(struct hg_bench_server *server)
+{
+    unsigned int i;
+
+    while (!hg_atomic_get32(&server->done))
+        hg_bench_progress(server->context, HG_BENCH_PROGRESS_TIMEOUT);
+
+    /* Let the shutdown response go through */
+    for (i = 0; i < 10; i++) {
+        unsigned int count;
+
+        HG_Progress(server->context, 10);
+        HG_Trigger(server->context, 0, 64, &count);
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_THREAD_RETURN_TYPE
+hg_bench_server_thread(void *arg)
+{
+    hg_thread_ret_t tret = (hg_thread_ret_t) 0;
+
+    hg_bench_server_run((struct hg_bench_server *) arg);
+
+    return tret;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_server_finalize(struct hg_bench_server *server)
+{
+    while (server->bufs) {
+        struct hg_bench_buf *buf = server->bufs;
+
+        server->bufs = buf->next;
+        HG_Bulk_free(buf->bulk);
+        free(buf->buf);
+        free(buf);
+    }
+    if (server->context)
+        HG_Context_destroy(server->context);
+    if (server->hg_class)
+        HG_Finalize(server->hg_class);
+    hg_thread_mutex_destroy(&server->buf_lock);
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_client_init(struct hg_bench_client *client,
+    struct hg_bench_opts *opts, const char *addr_string)
+{
+    struct hg_init_info init_info = HG_INIT_INFO_INITIALIZER;
+    size_t max_contexts = 1;
+    unsigned int i;
+    hg_return_t ret;
+
+    memset(client, 0, sizeof(*client));
+    client->opts = opts;
+    client->addr_string = addr_string;
+
+    for (i = 0; i < opts->ncontexts; i++)
+        if (opts->contexts[i] > max_contexts)
+            max_contexts = opts->contexts[i];
+    init_info.na_init_info.max_contexts = (na_uint8_t) max_contexts;
+    init_info.single_threaded = opts->single_threaded;
+    HG_BENCH_CHECK(opts->single_threaded &&
+                       (max_contexts > 1 || opts->nthreads > 1 ||
+                           opts->threads[0] > 1),
+        error, "single-threaded mode requires one thread and one context");
+
+    client->hg_class = HG_Init_opt(opts->info_string, HG_FALSE, &init_info);
+    HG_BENCH_CHECK(client->hg_class == NULL, error,
+        "could not initialize client with \"%s\"", opts->info_string);
+    for (i = 0; i < max_contexts; i++) {
+        client->contexts[i] =
+            HG_Context_create_id(client->hg_class, (hg_uint8_t) i);
+        HG_BENCH_CHECK(client->contexts[i] == NULL, error,
+            "could not create client context %u", i);
+        client->ncontexts++;
+    }
+    hg_bench_register(client->hg_class, NULL, &client->rpc_id,
+        &client->bulk_id, &client->shutdown_id);
+
+    ret = HG_Addr_lookup2(client->hg_class, addr_string, &client->addr);
+    HG_BENCH_CHECK(
+        ret != HG_SUCCESS, error, "could not lookup \"%s\"", addr_string);
+
+    return 0;
+
+error:
+    hg_bench_client_finalize(client);
+    return -1;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_client_finalize(struct hg_bench_client *client)
+{
+    unsigned int i;
+
+    if (client->addr != HG_ADDR_NULL)
+        HG_Addr_free(client->hg_class, client->addr);
+    for (i = 0; i < client->ncontexts; i++)
+        HG_Context_destroy(client->contexts[i]);
+    if (client->hg_class)
+        HG_Finalize(client->hg_class);
+    memset(client, 0, sizeof(*client));
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_client_shutdown(struct hg_bench_client *client)
+{
+    struct hg_bench_worker worker;
+    struct hg_bench_op op;
+    hg_return_t ret;
+
+    /* Use a worker for a single op with no input */
+    memset(&worker, 0, sizeof(worker));
+    memset(&op, 0, sizeof(op));
+    worker.client = client;
+    worker.context = client->contexts[0];
+    worker.total = 1;
+    hg_atomic_init32(&worker.issued, 1);
+    hg_atomic_init32(&worker.completed, 0);
+    hg_atomic_init32(&worker.errors, 0);
+    op.worker = &worker;
+
+    ret = HG_Create(
+        worker.context, client->addr, client->shutdown_id, &op.handle);
+    HG_BENCH_CHECK(ret != HG_SUCCESS, error, "could not create handle");
+    ret = HG_Forward(op.handle, hg_bench_forward_cb, &op, NULL);
+    HG_BENCH_CHECK(ret != HG_SUCCESS, error, "could not forward shutdown");
+    while (hg_atomic_get32(&worker.completed) < 1)
+        hg_bench_progress(worker.context, HG_BENCH_PROGRESS_TIMEOUT);
+    HG_Destroy(op.handle);
+
+    return 0;
+
+error:
+    if (op.handle)
+        HG_Destroy(op.handle);
+    return -1;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_client_run(struct hg_bench_client *client)
+{
+    struct hg_bench_opts *opts = client->opts;
+    struct hg_bench_json json;
+    struct hg_bench_hist *hist = NULL;
+    FILE *json_fp = NULL;
+    unsigned int s, d, t, c, r;
+    int rc = 0;
+
+    hg_bench_default_sizes(opts, client->hg_class);
+
+    hist = (struct hg_bench_hist *) malloc(sizeof(*hist));
+    HG_BENCH_CHECK(hist == NULL, error, "could not allocate histogram");
+
+    /* Results of client processes are reported by the parent */
+    if (opts->report_fd < 0) {
+        if (opts->json_path) {
+            json_fp = hg_bench_json_begin(&json, opts, client->hg_class);
+            if (json_fp == NULL)
+                goto error;
+        }
+        if (json_fp != stdout)
+            hg_bench_print_header(opts);
+    }
+
+    for (s = 0; s < opts->nsizes; s++)
+        for (d = 0; d < opts->ndepths; d++)
+            for (t = 0; t < opts->nthreads; t++)
+                for (c = 0; c < opts->ncontexts; c++)
+                    for (r = 0; r < opts->repeat; r++) {
+                        struct hg_bench_result result;
+
+                        /* Extra contexts would not be used */
+                        if (opts->contexts[c] > opts->threads[t])
+                            continue;
+
+                        if (opts->report_fd >= 0) {
+                            rc = hg_bench_report(client, opts->sizes[s],
+                                opts->depths[d], opts->threads[t],
+                                opts->contexts[c]);
+                            if (rc != 0)
+                                goto done;
+                            continue;
+                        }
+
+                        rc = hg_bench_measure(client, opts->sizes[s],
+                            opts->depths[d], opts->threads[t],
+                            opts->contexts[c], hist, &result);
+                        if (rc != 0)
+                            goto done;
+                        if (json_fp)
+                            hg_bench_json_result(&json, opts, &result);
+                        if (json_fp != stdout)
+                            hg_bench_print_result(opts, &result);
+                        hg_bench_check_result(opts, &result);
+                    }
+
+done:
+    if (json_fp)
+        hg_bench_json_end(&json, json_fp);
+    free(hist);
+
+    return rc;
+
+error:
+    free(hist);
+    return -1;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_measure(struct hg_bench_client *client, size_t size, size_t depth,
+    size_t nthreads, size_t ncontexts, struct hg_bench_hist *hist,
+    struct hg_bench_result *result)
+{
+    struct hg_bench_worker *workers = NULL;
+    size_t i;
+    int rc = -1;
+
+    memset(result, 0, sizeof(*result));
+    hg_bench_hist_reset(hist);
+    workers = (struct hg_bench_worker *) calloc(nthreads, sizeof(*workers));
+    HG_BENCH_CHECK(workers == NULL, done, "could not allocate workers");
+
+    for (i = 0; i < nthreads; i++) {
+        workers[i].client = client;
+        workers[i].context = client->contexts[i % ncontexts];
+        /* Callbacks of ops may be triggered by threads sharing the context,
+         * the worker must not block in progress while they are pending */
+        workers[i].timeout =
+            (nthreads > ncontexts) ? 0 : HG_BENCH_PROGRESS_TIMEOUT;
+        workers[i].depth = depth;
+        workers[i].size = size;
+        if (hg_bench_worker_init(&workers[i]) != 0) {
+            nthreads = i;
+            goto done;
+        }
+    }
+
+    for (i = 0; i < nthreads; i++)
+        hg_thread_create(&workers[i].thread, hg_bench_worker_run, &workers[i]);
+    for (i = 0; i < nthreads; i++)
+        hg_thread_join(workers[i].thread);
+
+    result->size = size;
+    result->depth = depth;
+    result->threads = nthreads;
+    result->contexts = ncontexts;
+    for (i = 0; i < nthreads; i++) {
+        double elapsed =
+            (double) hg_time_fast_to_ns(workers[i].end - workers[i].start) /
+            1e9;
+
+        hg_bench_hist_merge(hist, &workers[i].hist);
+        result->errors +=
+            (hg_util_uint64_t) hg_atomic_get32(&workers[i].errors);
+        if (elapsed > result->elapsed)
+            result->elapsed = elapsed;
+    }
+    result->ops = hist->count;
+    hg_bench_hist_stats(hist, 1000.0, &result->lat);
+    rc = result->errors ? -1 : 0;
+    HG_BENCH_CHECK(rc != 0, done, "%llu operation(s) failed",
+        (unsigned long long) result->errors);
+
+done:
+    if (workers)
+        for (i = 0; i < nthreads; i++)
+            hg_bench_worker_finalize(&workers[i]);
+    free(workers);
+
+    return rc;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_default_sizes(struct hg_bench_opts *opts, hg_class_t *hg_class)
+{
+    size_t size = 1;
+
+    if (opts->nsizes > 0)
+        return;
+
+    /* Default overflow sizes: from twice the eager size up to 1 MB */
+    while (size <= HG_Class_get_input_eager_size(hg_class))
+        size *= 2;
+    for (size *= 2; size <= (1 << 20); size *= 2)
+        opts->sizes[opts->nsizes++] = size;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_bool_t
+hg_bench_get_sm_stats(hg_class_t *hg_class, struct hg_bench_sm_stats *stats)
+{
+#ifdef NA_HAS_SM
+    struct na_sm_stats na_sm_stats;
+
+    /* Fails if the class does not use NA SM */
+    if (NA_SM_Get_stats(HG_Core_class_get_na(hg_class->core_class),
+            &na_sm_stats) != NA_SUCCESS)
+        return HG_FALSE;
+
+    stats->send_retries = na_sm_stats.send_retries;
+    stats->client_send_retries = 0;
+    stats->unexpected_queued = na_sm_stats.unexpected_queued;
+    stats->unexpected_depth_max = na_sm_stats.unexpected_depth_max;
+    stats->poll_wakeups = na_sm_stats.poll_wakeups;
+    stats->notify_wakeups = na_sm_stats.notify_wakeups;
+
+    return HG_TRUE;
+#else
+    (void) hg_class;
+    (void) stats;
+
+    return HG_FALSE;
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_report(struct hg_bench_client *client, size_t size, size_t depth,
+    size_t nthreads, size_t ncontexts)
+{
+    int fd = client->opts->report_fd;
+    struct hg_bench_report report;
+    struct hg_bench_sm_stats start, end;
+    struct hg_bench_hist *hist = NULL;
+    char c = 'r';
+    int rc = -1;
+
+    hist = (struct hg_bench_hist *) malloc(sizeof(*hist));
+    HG_BENCH_CHECK(hist == NULL, done, "could not allocate histogram");
+    memset(&report, 0, sizeof(report));
+    memset(&start, 0, sizeof(start));
+
+    /* Tell the parent we are ready and wait until all processes are */
+    HG_BENCH_CHECK(hg_bench_write_full(fd, &c, 1) != 0 ||
+                       hg_bench_read_full(fd, &c, 1) != 0,
+        done, "could not synchronize with parent");
+
+    hg_bench_get_sm_stats(client->hg_class, &start);
+    report.rc = hg_bench_measure(
+        client, size, depth, nthreads, ncontexts, hist, &report.result);
+    if (hg_bench_get_sm_stats(client->hg_class, &end)) {
+        report.result.has_sm_stats = HG_TRUE;
+        report.result.sm_stats.client_send_retries =
+            end.send_retries - start.send_retries;
+    }
+
+    HG_BENCH_CHECK(hg_bench_write_full(fd, &report, sizeof(report)) != 0 ||
+                       hg_bench_write_full(fd, hist, sizeof(*hist)) != 0,
+        done, "could not report to parent");
+    rc = report.rc;
+
+done:
+    free(hist);
+
+    return rc;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_procs_spawn(char *argv[], char *addr_string,
+    struct hg_bench_proc *procs, size_t nprocs)
+{
+    size_t argc, i;
+    char **child_argv = NULL;
+    char fd_string[16];
+
+    for (argc = 0; argv[argc] != NULL; argc++)
+        continue;
+    child_argv = (char **) malloc((argc + 7) * sizeof(*child_argv));
+    HG_BENCH_CHECK(child_argv == NULL, error, "could not allocate argv");
+
+    /* Same options, later ones take precedence */
+    memcpy(child_argv, argv, argc * sizeof(*child_argv));
+    child_argv[argc] = (char *) "--mode";
+    child_argv[argc + 1] = (char *) "client";
+    child_argv[argc + 2] = (char *) "--addr";
+    child_argv[argc + 3] = addr_string;
+    child_argv[argc + 4] = (char *) "--report-fd";
+    child_argv[argc + 5] = fd_string;
+    child_argv[argc + 6] = NULL;
+
+    for (i = 0; i < nprocs; i++) {
+        procs[i].pid = -1;
+        procs[i].fd = -1;
+    }
+    for (i = 0; i < nprocs; i++) {
+        int fds[2];
+
+        HG_BENCH_CHECK(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0, error,
+            "could not create socket pair");
+        /* Other client processes must not inherit the parent's end */
+        fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+        snprintf(fd_string, sizeof(fd_string), "%d", fds[1]);
+
+        procs[i].pid = fork();
+        if (procs[i].pid == 0) {
+            /* argv[0] may be a relative path or a name looked up in PATH
+             * that resolves to another executable, prefer the running one */
+            execv("/proc/self/exe", child_argv);
+            execvp(argv[0], child_argv);
+            _exit(EXIT_FAILURE);
+        }
+        close(fds[1]);
+        procs[i].fd = fds[0];
+        HG_BENCH_CHECK(procs[i].pid < 0, error, "could not fork");
+    }
+    free(child_argv);
+
+    return 0;
+
+error:
+    free(child_argv);
+    return -1;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_procs_wait(struct hg_bench_proc *procs, size_t nprocs)
+{
+    size_t i;
+    int rc = 0;
+
+    for (i = 0; i < nprocs; i++) {
+        int status = 0;
+
+        /* Closing the socket makes a client stuck on a read exit */
+        if (procs[i].fd >= 0)
+            close(procs[i].fd);
+        if (procs[i].pid <= 0) {
+            rc = -1;
+            continue;
+        }
+        waitpid(procs[i].pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            rc = -1;
+    }
+
+    return rc;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_procs_measure(struct hg_bench_server *server,
+    struct hg_bench_proc *procs, size_t nprocs, struct hg_bench_hist *hist,
+    struct hg_bench_result *result)
+{
+    struct hg_bench_hist *proc_hist = NULL;
+    struct hg_bench_sm_stats start, end;
+    hg_bool_t has_sm_stats;
+    size_t i;
+    char c;
+    int rc = -1;
+
+    memset(result, 0, sizeof(*result));
+    memset(&start, 0, sizeof(start));
+    hg_bench_hist_reset(hist);
+    proc_hist = (struct hg_bench_hist *) malloc(sizeof(*proc_hist));
+    HG_BENCH_CHECK(proc_hist == NULL, done, "could not allocate histogram");
+
+    /* Start all client processes together once they are all ready */
+    for (i = 0; i < nprocs; i++)
+        HG_BENCH_CHECK(hg_bench_read_full(procs[i].fd, &c, 1) != 0, done,
+            "client process %zu exited", i);
+    has_sm_stats = hg_bench_get_sm_stats(server->hg_class, &start);
+    for (i = 0; i < nprocs; i++)
+        HG_BENCH_CHECK(hg_bench_write_full(procs[i].fd, &c, 1) != 0, done,
+            "could not start client process %zu", i);
+
+    for (i = 0; i < nprocs; i++) {
+        struct hg_bench_report report;
+
+        HG_BENCH_CHECK(
+            hg_bench_read_full(procs[i].fd, &report, sizeof(report)) != 0 ||
+                hg_bench_read_full(
+                    procs[i].fd, proc_hist, sizeof(*proc_hist)) != 0,
+            done, "could not get report of client process %zu", i);
+        if (i == 0)
+            *result = report.result;
+        else {
+            result->errors += report.result.errors;
+            if (report.result.elapsed > result->elapsed)
+                result->elapsed = report.result.elapsed;
+            result->sm_stats.client_send_retries +=
+                report.result.sm_stats.client_send_retries;
+        }
+        if (report.rc != 0 && result->errors == 0)
+            result->errors = 1;
+        hg_bench_hist_merge(hist, proc_hist);
+    }
+    if (has_sm_stats && hg_bench_get_sm_stats(server->hg_class, &end)) {
+        result->has_sm_stats = HG_TRUE;
+        result->sm_stats.send_retries = end.send_retries - start.send_retries;
+        result->sm_stats.unexpected_queued =
+            end.unexpected_queued - start.unexpected_queued;
+        result->sm_stats.unexpected_depth_max = end.unexpected_depth_max;
+        result->sm_stats.poll_wakeups =
+            end.poll_wakeups - start.poll_wakeups;
+        result->sm_stats.notify_wakeups =
+            end.notify_wakeups - start.notify_wakeups;
+    }
+
+    /* Aggregate rate over the slowest process */
+    result->procs = nprocs;
+    result->ops = hist->count;
+    hg_bench_hist_stats(hist, 1000.0, &result->lat);
+    rc = result->errors ? -1 : 0;
+    HG_BENCH_CHECK(rc != 0, done, "%llu operation(s) failed",
+        (unsigned long long) result->errors);
+
+done:
+    free(proc_hist);
+
+    return rc;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_procs_run(
+    struct hg_bench_opts *opts, struct hg_bench_server *server, char *argv[])
+{
+    struct hg_bench_proc *procs = NULL;
+    struct hg_bench_hist *hist = NULL;
+    struct hg_bench_json json;
+    FILE *json_fp = NULL;
+    unsigned int p, s, d, t, c, r;
+    int rc = 0;
+
+    hg_bench_default_sizes(opts, server->hg_class);
+
+    procs = (struct hg_bench_proc *) malloc(
+        HG_BENCH_MAX_PROCS * sizeof(*procs));
+    hist = (struct hg_bench_hist *) malloc(sizeof(*hist));
+    HG_BENCH_CHECK(procs == NULL || hist == NULL, error,
+        "could not allocate client processes");
+
+    if (opts->json_path) {
+        json_fp = hg_bench_json_begin(&json, opts, server->hg_class);
+        if (json_fp == NULL)
+            goto error;
+    }
+    if (json_fp != stdout)
+        hg_bench_print_header(opts);
+
+    for (p = 0; p < opts->nprocs && rc == 0; p++) {
+        size_t nprocs = opts->procs[p];
+
+        /* Each client process goes through the same configurations */
+        rc = hg_bench_procs_spawn(argv, server->addr_string, procs, nprocs);
+        for (s = 0; s < opts->nsizes && rc == 0; s++)
+            for (d = 0; d < opts->ndepths && rc == 0; d++)
+                for (t = 0; t < opts->nthreads && rc == 0; t++)
+                    for (c = 0; c < opts->ncontexts && rc == 0; c++)
+                        for (r = 0; r < opts->repeat && rc == 0; r++) {
+                            struct hg_bench_result result;
+
+                            if (opts->contexts[c] > opts->threads[t])
+                                continue;
+
+                            rc = hg_bench_procs_measure(
+                                server, procs, nprocs, hist, &result);
+                            if (rc != 0)
+                                break;
+                            if (json_fp)
+                                hg_bench_json_result(&json, opts, &result);
+                            if (json_fp != stdout)
+                                hg_bench_print_result(opts, &result);
+                            hg_bench_check_result(opts, &result);
+                        }
+        if (hg_bench_procs_wait(procs, nprocs) != 0)
+            rc = -1;
+    }
+
+    if (json_fp)
+        hg_bench_json_end(&json, json_fp);
+    free(procs);
+    free(hist);
+
+    return rc;
+
+error:
+    free(procs);
+    free(hist);
+    return -1;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_read_full(int fd, void *buf, size_t count)
+{
+    char *ptr = (char *) buf;
+
+    while (count > 0) {
+        ssize_t n = read(fd, ptr, count);
+
+        if (n <= 0)
+            return -1;
+        ptr += n;
+        count -= (size_t) n;
+    }
+
+    return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_write_full(int fd, const void *buf, size_t count)
+{
+    const char *ptr = (const char *) buf;
+
+    while (count > 0) {
+        ssize_t n = write(fd, ptr, count);
+
+        if (n <= 0)
+            return -1;
+        ptr += n;
+        count -= (size_t) n;
+    }
+
+    return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_worker_init(struct hg_bench_worker *worker)
+{
+    struct hg_bench_client *client = worker->client;
+    hg_bench_type_t type = client->opts->command->type;
+    unsigned int ready_size = 1;
+    size_t i;
+    hg_return_t ret;
+
+    hg_atomic_init32(&worker->issued, 0);
+    hg_atomic_init32(&worker->completed, 0);
+    hg_atomic_init32(&worker->errors, 0);
+    if (type == HG_BENCH_LOOKUP)
+        return 0;
+
+    worker->ops =
+        (struct hg_bench_op *) calloc(worker->depth, sizeof(*worker->ops));
+    HG_BENCH_CHECK(worker->ops == NULL, error, "could not allocate ops");
+
+    /* Holds all ops in flight (one slot of the ring is always empty) */
+    while (ready_size <= worker->depth)
+        ready_size <<= 1;
+    worker->ready = hg_atomic_queue_alloc(ready_size);
+    HG_BENCH_CHECK(worker->ready == NULL, error, "could not allocate queue");
+
+    for (i = 0; i < worker->depth; i++) {
+        struct hg_bench_op *op = &worker->ops[i];
+        size_t j;
+
+        op->worker = worker;
+        op->buf = malloc(worker->size ? worker->size : 1);
+        HG_BENCH_CHECK(op->buf == NULL, error, "could not allocate buffer");
+        for (j = 0; j < worker->size; j++)
+            ((char *) op->buf)[j] = (char) j;
+
+        ret = HG_Create(worker->context, client->addr,
+            (type == HG_BENCH_BULK_BW) ? client->bulk_id : client->rpc_id,
+            &op->handle);
+        HG_BENCH_CHECK(ret != HG_SUCCESS, error, "could not create handle");
+
+        if (type == HG_BENCH_BULK_BW) {
+            hg_size_t buf_size = (hg_size_t) worker->size;
+
+            op->bulk_in.size = worker->size;
+            op->bulk_in.push = (hg_uint8_t) client->opts->push;
+            if (worker->size > 0) {
+                ret = HG_Bulk_create(client->hg_class, 1, &op->buf, &buf_size,
+                    HG_BULK_READWRITE, &op->bulk_in.bulk);
+                HG_BENCH_CHECK(
+                    ret != HG_SUCCESS, error, "could not create bulk");
+            }
+        } else {
+            op->rpc_in.size = worker->size;
+            op->rpc_in.buf = op->buf;
+        }
+    }
+
+    return 0;
+
+error:
+    return -1;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_worker_finalize(struct hg_bench_worker *worker)
+{
+    size_t i;
+
+    if (worker->ready != NULL) {
+        hg_atomic_queue_free(worker->ready);
+        worker->ready = NULL;
+    }
+    if (worker->ops == NULL)
+        return;
+
+    for (i = 0; i < worker->depth; i++) {
+        if (worker->ops[i].bulk_in.bulk != HG_BULK_NULL)
+            HG_Bulk_free(worker->ops[i].bulk_in.bulk);
+        if (worker->ops[i].handle != HG_HANDLE_NULL)
+            HG_Destroy(worker->ops[i].handle);
+        free(worker->ops[i].buf);
+    }
+    free(worker->ops);
+    worker->ops = NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_THREAD_RETURN_TYPE
+hg_bench_worker_run(void *arg)
+{
+    struct hg_bench_worker *worker = (struct hg_bench_worker *) arg;
+    const struct hg_bench_opts *opts = worker->client->opts;
+    hg_thread_ret_t tret = (hg_thread_ret_t) 0;
+
+    hg_thread_setspecific(hg_bench_worker_key_g, worker);
+
+    if (opts->command->type == HG_BENCH_LOOKUP) {
+        hg_bench_worker_lookup(worker, opts->warmup, HG_FALSE);
+        hg_bench_worker_lookup(worker, opts->iterations, HG_TRUE);
+    } else {
+        hg_bench_worker_phase(worker, opts->warmup, HG_FALSE);
+        hg_bench_worker_phase(worker, opts->iterations, HG_TRUE);
+    }
+
+    hg_thread_setspecific(hg_bench_worker_key_g, NULL);
+
+    return tret;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_worker_phase(
+    struct hg_bench_worker *worker, unsigned int count, hg_bool_t recording)
+{
+    struct hg_bench_op *op;
+    size_t i;
+
+    if (count == 0)
+        return;
+
+    worker->total = (hg_util_int32_t) count;
+    worker->recording = recording;
+    hg_atomic_set32(&worker->issued, 0);
+    hg_atomic_set32(&worker->completed, 0);
+
+    worker->start = hg_time_fast_now();
+    for (i = 0; i < worker->depth; i++) {
+        if (hg_atomic_incr32(&worker->issued) > worker->total)
+            break;
+        if (hg_bench_op_forward(&worker->ops[i]) != HG_SUCCESS) {
+            hg_atomic_incr32(&worker->errors);
+            hg_atomic_incr32(&worker->completed);
+        }
+    }
+
+    while (hg_atomic_get32(&worker->completed) < worker->total) {
+        hg_bench_progress(worker->context, worker->timeout);
+
+        /* Keep the same number of operations in flight */
+        while ((op = (struct hg_bench_op *) hg_atomic_queue_pop_sc(
+                    worker->ready)) != NULL) {
+            if (hg_atomic_incr32(&worker->issued) <= worker->total &&
+                hg_bench_op_forward(op) != HG_SUCCESS) {
+                hg_atomic_incr32(&worker->errors);
+                hg_atomic_incr32(&worker->completed);
+            }
+        }
+    }
+    worker->end = hg_time_fast_now();
+
+    /* Ops completed last are not forwarded again */
+    while (hg_atomic_queue_pop_sc(worker->ready) != NULL)
+        continue;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_worker_lookup(
+    struct hg_bench_worker *worker, unsigned int count, hg_bool_t recording)
+{
+    struct hg_bench_client *client = worker->client;
+    unsigned int i;
+
+    worker->start = hg_time_fast_now();
+    for (i = 0; i < count; i++) {
+        hg_time_fast_t t1, t2;
+        hg_addr_t addr;
+        hg_return_t ret;
+
+        t1 = hg_time_fast_now();
+        ret = HG_Addr_lookup2(client->hg_class, client->addr_string, &addr);
+        t2 = hg_time_fast_now();
+        if (ret != HG_SUCCESS) {
+            hg_atomic_incr32(&worker->errors);
+            continue;
+        }
+        HG_Addr_free(client->hg_class, addr);
+        if (recording)
+            hg_bench_hist_record(&worker->hist, hg_time_fast_to_ns(t2 - t1));
+    }
+    worker->end = hg_time_fast_now();
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_bench_op_forward(struct hg_bench_op *op)
+{
+    void *in = (op->worker->client->opts->command->type == HG_BENCH_BULK_BW)
+                   ? (void *) &op->bulk_in
+                   : (void *) &op->rpc_in;
+
+    op->start = hg_time_fast_now();
+
+    return HG_Forward(op->handle, hg_bench_forward_cb, op, in);
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_bench_forward_cb(const struct hg_cb_info *callback_info)
+{
+    struct hg_bench_op *op = (struct hg_bench_op *) callback_info->arg;
+    struct hg_bench_worker *worker = op->worker;
+    struct hg_bench_client *client = worker->client;
+
+    if (callback_info->ret != HG_SUCCESS)
+        hg_atomic_incr32(&worker->errors);
+    else if (HG_Get_info(op->handle)->id == client->rpc_id) {
+        struct hg_bench_payload out = {0, NULL};
+
+        /* Decode is part of the measured round-trip */
+        if (HG_Get_output(op->handle, &out) != HG_SUCCESS ||
+            out.size != op->rpc_in.size)
+            hg_atomic_incr32(&worker->errors);
+        else
+            HG_Free_output(op->handle, &out);
+    }
+
+    if (worker->recording) {
+        struct hg_bench_worker *self = (struct hg_bench_worker *)
+            hg_thread_getspecific(hg_bench_worker_key_g);
+
+        /* Record in the histogram of the thread that triggered the callback,
+         * histograms are merged once all threads are done */
+        hg_bench_hist_record(self ? &self->hist : &worker->hist,
+            hg_time_fast_to_ns(hg_time_fast_now() - op->start));
+    }
+
+    /* Forwarded again by the worker thread and not from the callback, which
+     * may be triggered by another thread sharing the context */
+    if (worker->ready != NULL)
+        hg_atomic_queue_push(worker->ready, op);
+    hg_atomic_incr32(&worker->completed);
+
+    return HG_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_progress(hg_context_t *context, unsigned int timeout)
+{
+    unsigned int count;
+    hg_return_t ret;
+
+    /* Trigger after progress so that callers can check for completion
+     * without blocking in progress once the last operation has completed */
+    HG_Progress(context, timeout);
+
+    do {
+        count = 0;
+        ret = HG_Trigger(context, 0, 64, &count);
+    } while (ret == HG_SUCCESS && count > 0);
+}
+
+/*---------------------------------------------------------------------------*/
+static FILE *
+hg_bench_json_begin(struct hg_bench_json *json,
+    const struct hg_bench_opts *opts, hg_class_t *hg_class)
+{
+    FILE *fp = (strcmp(opts->json_path, "-") == 0)
+                   ? stdout
+                   : fopen(opts->json_path, "w");
+
+    HG_BENCH_CHECK(
+        fp == NULL, done, "could not open \"%s\"", opts->json_path);
+    hg_bench_json_init(json, fp);
+    hg_bench_json_object_begin(json, NULL);
+    hg_bench_json_string(json, "benchmark", opts->command->name);
+    hg_bench_json_string(json, "info", opts->info_string);
+    hg_bench_json_string(json, "class", HG_Class_get_name(hg_class));
+    hg_bench_json_string(json, "protocol", HG_Class_get_protocol(hg_class));
+    hg_bench_json_uint(json, "iterations", opts->iterations);
+    hg_bench_json_uint(json, "warmup", opts->warmup);
+    hg_bench_json_string(json, "latency_unit", "us");
+    hg_bench_json_array_begin(json, "results");
+
+done:
+    return fp;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_json_end(struct hg_bench_json *json, FILE *fp)
+{
+    hg_bench_json_array_end(json);
+    hg_bench_json_object_end(json);
+    if (fp != stdout)
+        fclose(fp);
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_print_header(const struct hg_bench_opts *opts)
+{
+    printf("# %s (%s), %u iterations per thread\n", opts->command->name,
+        opts->info_string, opts->iterations);
+    if (opts->nprocs > 0)
+        printf("%5s ", "procs");
+    printf("%-10s %6s %4s %4s %12s %10s %10s %10s %10s %10s %10s", "size",
+        "depth", "thr", "ctx", "ops/s", "MB/s", "avg(us)", "p50(us)",
+        "p99(us)", "p99.9(us)", "max(us)");
+    if (opts->nprocs > 0)
+        printf(" %9s %9s %9s %7s %9s %9s", "retry", "cl_retry", "unexp",
+            "unexp_hw", "wakeups", "notify");
+    printf("\n");
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_print_result(
+    const struct hg_bench_opts *opts, const struct hg_bench_result *result)
+{
+    double rate = result->elapsed > 0 ? (double) result->ops / result->elapsed
+                                      : 0;
+
+    if (opts->nprocs > 0)
+        printf("%5zu ", result->procs);
+    printf("%-10zu %6zu %4zu %4zu %12.1f %10.2f %10.2f %10.2f %10.2f %10.2f "
+           "%10.2f",
+        result->size, result->depth, result->threads, result->contexts, rate,
+        rate * (double) result->size / (1024.0 * 1024.0), result->lat.mean,
+        result->lat.p50, result->lat.p99, result->lat.p999, result->lat.max);
+    if (opts->nprocs > 0 && result->has_sm_stats)
+        printf(" %9llu %9llu %9llu %7llu %9llu %9llu",
+            (unsigned long long) result->sm_stats.send_retries,
+            (unsigned long long) result->sm_stats.client_send_retries,
+            (unsigned long long) result->sm_stats.unexpected_queued,
+            (unsigned long long) result->sm_stats.unexpected_depth_max,
+            (unsigned long long) result->sm_stats.poll_wakeups,
+            (unsigned long long) result->sm_stats.notify_wakeups);
+    printf("\n");
+    fflush(stdout);
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_check_result(
+    const struct hg_bench_opts *opts, const struct hg_bench_result *result)
+{
+    char key[HG_BENCH_BASELINE_KEY_MAX];
+    int len;
+
+    if (opts->baseline == NULL)
+        return;
+
+    len = snprintf(key, sizeof(key), "%s.%s.size=%zu.depth=%zu.thr=%zu.ctx=%zu",
+        opts->command->name, opts->info_string, result->size, result->depth,
+        result->threads, result->contexts);
+    if (result->procs > 0 && len > 0 && (size_t) len < sizeof(key))
+        len += snprintf(
+            key + len, sizeof(key) - (size_t) len, ".procs=%zu", result->procs);
+    if (len < 0 || (size_t) len >= sizeof(key) - 8)
+        return;
+
+    /* Gate on the median for latencies, which is less noisy than the tail */
+    if (opts->command->type == HG_BENCH_RPC_LAT ||
+        opts->command->type == HG_BENCH_LOOKUP) {
+        strcat(key, ".p50_us");
+        hg_bench_baseline_check(opts->baseline, key, result->lat.p50, 0);
+    } else {
+        strcat(key, ".ops_s");
+        hg_bench_baseline_check(opts->baseline, key,
+            result->elapsed > 0 ? (double) result->ops / result->elapsed : 0,
+            1);
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_json_result(struct hg_bench_json *json,
+    const struct hg_bench_opts *opts, const struct hg_bench_result *result)
+{
+    double rate = result->elapsed > 0 ? (double) result->ops / result->elapsed
+                                      : 0;
+
+    (void) opts;
+    hg_bench_json_object_begin(json, NULL);
+    if (result->procs > 0)
+        hg_bench_json_uint(json, "procs", result->procs);
+    hg_bench_json_uint(json, "size", result->size);
+    hg_bench_json_uint(json, "depth", result->depth);
+    hg_bench_json_uint(json, "threads", result->threads);
+    hg_bench_json_uint(json, "contexts", result->contexts);
+    hg_bench_json_uint(json, "ops", result->ops);
+    hg_bench_json_double(json, "elapsed_s", result->elapsed);
+    hg_bench_json_double(json, "rate_ops", rate);
+    hg_bench_json_double(
+        json, "bw_mbs", rate * (double) result->size / (1024.0 * 1024.0));
+    hg_bench_json_stats(json, "latency", &result->lat);
+    if (result->has_sm_stats) {
+        hg_bench_json_object_begin(json, "sm");
+        hg_bench_json_uint(
+            json, "send_retries", result->sm_stats.send_retries);
+        hg_bench_json_uint(json, "client_send_retries",
+            result->sm_stats.client_send_retries);
+        hg_bench_json_uint(
+            json, "unexpected_queued", result->sm_stats.unexpected_queued);
+        hg_bench_json_uint(json, "unexpected_depth_max",
+            result->sm_stats.unexpected_depth_max);
+        hg_bench_json_uint(
+            json, "poll_wakeups", result->sm_stats.poll_wakeups);
+        hg_bench_json_uint(
+            json, "notify_wakeups", result->sm_stats.notify_wakeups);
+        hg_bench_json_object_end(json);
+    }
+    hg_bench_json_object_end(json);
+}
+
+/*---------------------------------------------------------------------------*/
+int
+main(int argc, char *argv[])
+{
+    struct hg_bench_opts opts;
+    struct hg_bench_server server;
+    struct hg_bench_client client;
+    char addr_string[HG_BENCH_ADDR_MAX] = {'\0'};
+    pid_t pid = -1;
+    int pipe_fds[2] = {-1, -1};
+    hg_bool_t server_started = HG_FALSE;
+    int rc = EXIT_FAILURE;
+
+    if (hg_bench_parse_opts(argc, argv, &opts) != 0)
+        return EXIT_FAILURE;
+
+    /* Client processes of --procs are checked by their parent */
+    if (opts.baseline_path && opts.report_fd < 0) {
+        int ret;
+
+        opts.baseline = (struct hg_bench_baseline *) malloc(
+            sizeof(*opts.baseline));
+        HG_BENCH_CHECK(
+            opts.baseline == NULL, out, "could not allocate baseline");
+        ret = hg_bench_baseline_init(opts.baseline, opts.baseline_path,
+            opts.tolerance / 100.0, opts.update_baseline);
+        if (ret != 0) {
+            free(opts.baseline);
+            return (ret == HG_BENCH_SKIP) ? HG_BENCH_SKIP : EXIT_FAILURE;
+        }
+    }
+    hg_thread_key_create(&hg_bench_worker_key_g);
+    hg_time_fast_init();
+
+    switch (opts.mode) {
+        case HG_BENCH_MODE_INPROC:
+            if (hg_bench_server_init(&server, &opts) != 0)
+                goto done;
+            server_started = HG_TRUE;
+            strcpy(addr_string, server.addr_string);
+            hg_thread_create(&server.thread, hg_bench_server_thread, &server);
+            if (opts.nprocs > 0) {
+                /* Clients run in separate processes */
+                if (hg_bench_procs_run(&opts, &server, argv) == 0)
+                    rc = EXIT_SUCCESS;
+                goto done;
+            }
+            break;
+
+        case HG_BENCH_MODE_FORK:
+            HG_BENCH_CHECK(pipe(pipe_fds) != 0, done, "could not create pipe");
+            pid = fork();
+            HG_BENCH_CHECK(pid < 0, done, "could not fork");
+            if (pid == 0) {
+                close(pipe_fds[0]);
+                if (hg_bench_server_init(&server, &opts) != 0)
+                    _exit(EXIT_FAILURE);
+                if (write(pipe_fds[1], server.addr_string,
+                        strlen(server.addr_string) + 1) < 0)
+                    _exit(EXIT_FAILURE);
+                close(pipe_fds[1]);
+                hg_bench_server_run(&server);
+                hg_bench_server_finalize(&server);
+                _exit(EXIT_SUCCESS);
+            }
+            close(pipe_fds[1]);
+            HG_BENCH_CHECK(
+                read(pipe_fds[0], addr_string, sizeof(addr_string) - 1) <= 0,
+                done, "could not get server address");
+            close(pipe_fds[0]);
+            break;
+
+        case HG_BENCH_MODE_SERVER:
+            if (hg_bench_server_init(&server, &opts) != 0)
+                goto done;
+            printf("# %s\n", server.addr_string);
+            fflush(stdout);
+            if (opts.addr_file) {
+                FILE *fp = fopen(opts.addr_file, "w");
+
+                HG_BENCH_CHECK(fp == NULL, done, "could not open \"%s\"",
+                    opts.addr_file);
+                fprintf(fp, "%s\n", server.addr_string);
+                fclose(fp);
+            }
+            hg_bench_server_run(&server);
+            hg_bench_server_finalize(&server);
+            rc = EXIT_SUCCESS;
+            goto done;
+
+        case HG_BENCH_MODE_CLIENT:
+        default:
+            if (opts.addr_string)
+                strncpy(addr_string, opts.addr_string, sizeof(addr_string) - 1);
+            else {
+                FILE *fp = fopen(opts.addr_file, "r");
+
+                HG_BENCH_CHECK(fp == NULL, done, "could not open \"%s\"",
+                    opts.addr_file);
+                if (fgets(addr_string, sizeof(addr_string), fp) == NULL)
+                    addr_string[0] = '\0';
+                fclose(fp);
+                addr_string[strcspn(addr_string, "\n")] = '\0';
+            }
+            break;
+    }
+
+    if (hg_bench_client_init(&client, &opts, addr_string) == 0) {
+        if (hg_bench_client_run(&client) == 0)
+            rc = EXIT_SUCCESS;
+        if (opts.mode != HG_BENCH_MODE_CLIENT ||
+            (opts.shutdown && opts.report_fd < 0))
+            hg_bench_client_shutdown(&client);
+        hg_bench_client_finalize(&client);
+    }
+
+    if (opts.mode == HG_BENCH_MODE_FORK && pid > 0) {
+        int status = 0;
+
+        waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            rc = EXIT_FAILURE;
+    }
+
+done:
+    if (server_started) {
+        /* Stop server thread if the client could not */
+        hg_atomic_set32(&server.done, 1);
+        hg_thread_join(server.thread);
+        hg_bench_server_finalize(&server);
+    }
+    hg_thread_key_delete(hg_bench_worker_key_g);
+    if (opts.baseline) {
+        if (hg_bench_baseline_finalize(opts.baseline) != 0)
+            rc = EXIT_FAILURE;
+        free(opts.baseline);
+    }
+
+out:
+    return rc;
+}
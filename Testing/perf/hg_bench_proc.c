@@ -0,0 +1,906 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#include "mercury.h"
+#include "mercury_bulk.h"
+#include "mercury_proc.h"
+#include "mercury_proc_bulk.h"
+#include "mercury_proc_string.h"
+
+#include "mercury_bench.h"
+#include "mercury_time.h"
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/****************/
+/* Local Macros */
+/****************/
+
+#define HG_BENCH_PROC_MAX_LIST     64
+#define HG_BENCH_PROC_ENTRY_VALUES 8
+
+#define HG_BENCH_PROC_DEFAULT_INFO       "na+sm"
+#define HG_BENCH_PROC_DEFAULT_ITERATIONS 100000
+#define HG_BENCH_PROC_DEFAULT_HASHES     "none,crc16,crc32,crc64"
+#define HG_BENCH_PROC_DEFAULT_TOLERANCE  20 /* % */
+
+#ifdef HG_HAS_XDR
+#    define HG_BENCH_PROC_ENCODING "xdr"
+#else
+#    define HG_BENCH_PROC_ENCODING "native"
+#endif
+
+/* Report errors and bail out */
+#define HG_BENCH_PROC_CHECK(cond, label, ...)                                  \
+    do {                                                                       \
+        if (cond) {                                                            \
+            fprintf(stderr, "hg_bench_proc: " __VA_ARGS__);                    \
+            fputc('\n', stderr);                                               \
+            goto label;                                                        \
+        }                                                                      \
+    } while (0)
+
+/************************************/
+/* Local Type and Struct Definition */
+/************************************/
+
+/* Fixed-size scalars */
+typedef struct {
+    hg_uint8_t val8;
+    hg_uint16_t val16;
+    hg_uint32_t val32;
+    hg_uint64_t val64;
+    hg_int32_t sval32;
+    hg_int64_t sval64;
+    hg_uint64_t cookie;
+    hg_uint32_t flags;
+} hg_bench_proc_scalar_t;
+
+/* String of <size> characters */
+typedef struct {
+    hg_string_t string;
+    hg_uint32_t flags;
+} hg_bench_proc_string_t;
+
+/* Array of <size> nested structs */
+typedef struct {
+    hg_uint64_t id;
+    hg_uint32_t flags;
+    hg_uint64_t values[HG_BENCH_PROC_ENTRY_VALUES];
+} hg_bench_proc_entry_t;
+
+typedef struct {
+    hg_uint32_t count;
+    hg_bench_proc_entry_t *entries;
+} hg_bench_proc_array_t;
+
+/* Bulk handle of <size> segments */
+typedef struct {
+    hg_bulk_t bulk;
+    hg_uint64_t offset;
+    void *buf; /* Not serialized */
+} hg_bench_proc_bulk_t;
+
+/* Raw payload of <size> bytes */
+typedef struct {
+    hg_uint64_t size;
+    void *buf;
+} hg_bench_proc_raw_t;
+
+/* Benchmark case */
+struct hg_bench_proc_case {
+    const char *name;
+    const char *description;
+    const char *sizes; /* Default sizes */
+    size_t struct_size;
+    hg_proc_cb_t proc_cb;
+    int (*init)(hg_class_t *hg_class, void *data, size_t size);
+    void (*finalize)(void *data);
+};
+
+struct hg_bench_proc_opts {
+    const struct hg_bench_proc_case *cases[8];
+    unsigned int ncases;
+    const char *info_string;
+    const char *sizes;
+    const char *json_path;
+    const char *baseline_path;
+    double tolerance;
+    hg_proc_hash_t hashes[4];
+    unsigned int nhashes;
+    unsigned int iterations;
+    unsigned int repeat;
+    hg_bool_t update_baseline;
+};
+
+struct hg_bench_proc_result {
+    const char *hash;
+    size_t size;
+    hg_size_t encoded_size;
+    hg_bool_t overflow;
+    double encode_ns;
+    double decode_ns;
+};
+
+/********************/
+/* Local Prototypes */
+/********************/
+
+static hg_return_t
+hg_proc_hg_bench_proc_scalar_t(hg_proc_t proc, void *data);
+
+static hg_return_t
+hg_proc_hg_bench_proc_string_t(hg_proc_t proc, void *data);
+
+static hg_return_t
+hg_proc_hg_bench_proc_entry_t(hg_proc_t proc, void *data);
+
+static hg_return_t
+hg_proc_hg_bench_proc_array_t(hg_proc_t proc, void *data);
+
+static hg_return_t
+hg_proc_hg_bench_proc_bulk_t(hg_proc_t proc, void *data);
+
+static hg_return_t
+hg_proc_hg_bench_proc_raw_t(hg_proc_t proc, void *data);
+
+static int
+hg_bench_proc_scalar_init(hg_class_t *hg_class, void *data, size_t size);
+
+static int
+hg_bench_proc_string_init(hg_class_t *hg_class, void *data, size_t size);
+
+static void
+hg_bench_proc_string_finalize(void *data);
+
+static int
+hg_bench_proc_array_init(hg_class_t *hg_class, void *data, size_t size);
+
+static void
+hg_bench_proc_array_finalize(void *data);
+
+static int
+hg_bench_proc_bulk_init(hg_class_t *hg_class, void *data, size_t size);
+
+static void
+hg_bench_proc_bulk_finalize(void *data);
+
+static int
+hg_bench_proc_raw_init(hg_class_t *hg_class, void *data, size_t size);
+
+static void
+hg_bench_proc_raw_finalize(void *data);
+
+static void
+hg_bench_proc_usage(const char *execname);
+
+static int
+hg_bench_proc_parse_opts(
+    int argc, char *argv[], struct hg_bench_proc_opts *opts);
+
+static int
+hg_bench_proc_measure(hg_class_t *hg_class,
+    const struct hg_bench_proc_opts *opts,
+    const struct hg_bench_proc_case *bench_case, hg_proc_hash_t hash,
+    size_t size, struct hg_bench_proc_result *result);
+
+/*******************/
+/* Local Variables */
+/*******************/
+
+static const struct hg_bench_proc_case hg_bench_proc_cases_g[] = {
+    {"scalar", "fixed-size scalars", "0", sizeof(hg_bench_proc_scalar_t),
+        hg_proc_hg_bench_proc_scalar_t, hg_bench_proc_scalar_init, NULL},
+    {"string", "string of <size> characters", "16,256,4k",
+        sizeof(hg_bench_proc_string_t), hg_proc_hg_bench_proc_string_t,
+        hg_bench_proc_string_init, hg_bench_proc_string_finalize},
+    {"array", "array of <size> nested structs", "1,16,64",
+        sizeof(hg_bench_proc_array_t), hg_proc_hg_bench_proc_array_t,
+        hg_bench_proc_array_init, hg_bench_proc_array_finalize},
+    {"bulk", "bulk handle of <size> segments", "1,4,16",
+        sizeof(hg_bench_proc_bulk_t), hg_proc_hg_bench_proc_bulk_t,
+        hg_bench_proc_bulk_init, hg_bench_proc_bulk_finalize},
+    {"overflow", "raw payload of <size> bytes (overflows eager buffer)",
+        "16k,64k,1m", sizeof(hg_bench_proc_raw_t), hg_proc_hg_bench_proc_raw_t,
+        hg_bench_proc_raw_init, hg_bench_proc_raw_finalize}};
+
+static const char *const hg_bench_proc_hash_names_g[] = {
+    "crc16", "crc32", "crc64", "none"};
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_proc_hg_bench_proc_scalar_t(hg_proc_t proc, void *data)
+{
+    hg_bench_proc_scalar_t *struct_data = (hg_bench_proc_scalar_t *) data;
+    hg_return_t ret;
+
+    ret = hg_proc_hg_uint8_t(proc, &struct_data->val8);
+    if (ret != HG_SUCCESS)
+        return ret;
+    ret = hg_proc_hg_uint16_t(proc, &struct_data->val16);
+    if (ret != HG_SUCCESS)
+        return ret;
+    ret = hg_proc_hg_uint32_t(proc, &struct_data->val32);
+    if (ret != HG_SUCCESS)
+        return ret;
+    ret = hg_proc_hg_uint64_t(proc, &struct_data->val64);
+    if (ret != HG_SUCCESS)
+        return ret;
+    ret = hg_proc_hg_int32_t(proc, &struct_data->sval32);
+    if (ret != HG_SUCCESS)
+        return ret;
+    ret = hg_proc_hg_int64_t(proc, &struct_data->sval64);
+    if (ret != HG_SUCCESS)
+        return ret;
+    ret = hg_proc_hg_uint64_t(proc, &struct_data->cookie);
+    if (ret != HG_SUCCESS)
+        return ret;
+
+    return hg_proc_hg_uint32_t(proc, &struct_data->flags);
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_proc_hg_bench_proc_string_t(hg_proc_t proc, void *data)
+{
+    hg_bench_proc_string_t *struct_data = (hg_bench_proc_string_t *) data;
+    hg_return_t ret;
+
+    ret = hg_proc_hg_string_t(proc, &struct_data->string);
+    if (ret != HG_SUCCESS)
+        return ret;
+
+    return hg_proc_hg_uint32_t(proc, &struct_data->flags);
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_proc_hg_bench_proc_entry_t(hg_proc_t proc, void *data)
+{
+    hg_bench_proc_entry_t *struct_data = (hg_bench_proc_entry_t *) data;
+    hg_return_t ret;
+
+    ret = hg_proc_hg_uint64_t(proc, &struct_data->id);
+    if (ret != HG_SUCCESS)
+        return ret;
+    ret = hg_proc_hg_uint32_t(proc, &struct_data->flags);
+    if (ret != HG_SUCCESS)
+        return ret;
+
+    return hg_proc_uint64_array(
+        proc, struct_data->values, HG_BENCH_PROC_ENTRY_VALUES);
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_proc_hg_bench_proc_array_t(hg_proc_t proc, void *data)
+{
+    hg_bench_proc_array_t *struct_data = (hg_bench_proc_array_t *) data;
+    hg_uint32_t i;
+    hg_return_t ret;
+
+    ret = hg_proc_hg_uint32_t(proc, &struct_data->count);
+    if (ret != HG_SUCCESS)
+        return ret;
+
+    if (hg_proc_get_op(proc) == HG_DECODE) {
+        struct_data->entries = (hg_bench_proc_entry_t *) malloc(
+            struct_data->count * sizeof(*struct_data->entries));
+        if (struct_data->entries == NULL)
+            return HG_NOMEM;
+    }
+
+    if (hg_proc_get_op(proc) != HG_FREE)
+        for (i = 0; i < struct_data->count; i++) {
+            ret = hg_proc_hg_bench_proc_entry_t(
+                proc, &struct_data->entries[i]);
+            if (ret != HG_SUCCESS)
+                return ret;
+        }
+    else {
+        free(struct_data->entries);
+        struct_data->entries = NULL;
+    }
+
+    return HG_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_proc_hg_bench_proc_bulk_t(hg_proc_t proc, void *data)
+{
+    hg_bench_proc_bulk_t *struct_data = (hg_bench_proc_bulk_t *) data;
+    hg_return_t ret;
+
+    ret = hg_proc_hg_bulk_t(proc, &struct_data->bulk);
+    if (ret != HG_SUCCESS)
+        return ret;
+
+    return hg_proc_hg_uint64_t(proc, &struct_data->offset);
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_proc_hg_bench_proc_raw_t(hg_proc_t proc, void *data)
+{
+    hg_bench_proc_raw_t *struct_data = (hg_bench_proc_raw_t *) data;
+    hg_return_t ret;
+
+    ret = hg_proc_hg_uint64_t(proc, &struct_data->size);
+    if (ret != HG_SUCCESS)
+        return ret;
+
+    switch (hg_proc_get_op(proc)) {
+        case HG_DECODE:
+            struct_data->buf = malloc(struct_data->size);
+            if (struct_data->buf == NULL)
+                return HG_NOMEM;
+            ret = hg_proc_raw(proc, struct_data->buf, struct_data->size);
+            break;
+        case HG_ENCODE:
+            ret = hg_proc_raw(proc, struct_data->buf, struct_data->size);
+            break;
+        case HG_FREE:
+            free(struct_data->buf);
+            struct_data->buf = NULL;
+            break;
+        default:
+            break;
+    }
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_proc_scalar_init(hg_class_t *hg_class, void *data, size_t size)
+{
+    hg_bench_proc_scalar_t *struct_data = (hg_bench_proc_scalar_t *) data;
+
+    (void) hg_class;
+    (void) size;
+    struct_data->val8 = 0x12;
+    struct_data->val16 = 0x1234;
+    struct_data->val32 = 0x12345678;
+    struct_data->val64 = 0x123456789ABCDEF0ULL;
+    struct_data->sval32 = -42;
+    struct_data->sval64 = -4242;
+    struct_data->cookie = 0xDEADBEEFCAFEULL;
+    struct_data->flags = 0x5;
+
+    return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_proc_string_init(hg_class_t *hg_class, void *data, size_t size)
+{
+    hg_bench_proc_string_t *struct_data = (hg_bench_proc_string_t *) data;
+    size_t i;
+
+    (void) hg_class;
+    struct_data->string = (hg_string_t) malloc(size + 1);
+    if (struct_data->string == NULL)
+        return -1;
+    for (i = 0; i < size; i++)
+        struct_data->string[i] = (char) ('a' + i % 26);
+    struct_data->string[size] = '\0';
+    struct_data->flags = 0x5;
+
+    return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_proc_string_finalize(void *data)
+{
+    free(((hg_bench_proc_string_t *) data)->string);
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_proc_array_init(hg_class_t *hg_class, void *data, size_t size)
+{
+    hg_bench_proc_array_t *struct_data = (hg_bench_proc_array_t *) data;
+    size_t i, j;
+
+    (void) hg_class;
+    struct_data->count = (hg_uint32_t) size;
+    struct_data->entries = (hg_bench_proc_entry_t *) malloc(
+        (size ? size : 1) * sizeof(*struct_data->entries));
+    if (struct_data->entries == NULL)
+        return -1;
+    for (i = 0; i < size; i++) {
+        struct_data->entries[i].id = i;
+        struct_data->entries[i].flags = (hg_uint32_t) i;
+        for (j = 0; j < HG_BENCH_PROC_ENTRY_VALUES; j++)
+            struct_data->entries[i].values[j] = i * j;
+    }
+
+    return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_proc_array_finalize(void *data)
+{
+    free(((hg_bench_proc_array_t *) data)->entries);
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_proc_bulk_init(hg_class_t *hg_class, void *data, size_t size)
+{
+    hg_bench_proc_bulk_t *struct_data = (hg_bench_proc_bulk_t *) data;
+    hg_uint32_t count = (hg_uint32_t) (size ? size : 1), i;
+    void **bufs = NULL;
+    hg_size_t *buf_sizes = NULL;
+    hg_return_t ret;
+    int rc = -1;
+
+    /* Segments are never accessed, use distinct addresses of one buffer */
+    bufs = (void **) malloc(count * sizeof(*bufs));
+    buf_sizes = (hg_size_t *) malloc(count * sizeof(*buf_sizes));
+    struct_data->offset = 0;
+    if (bufs == NULL || buf_sizes == NULL)
+        goto done;
+    bufs[0] = malloc((size_t) count * 4096);
+    if (bufs[0] == NULL)
+        goto done;
+    for (i = 0; i < count; i++) {
+        bufs[i] = (char *) bufs[0] + (size_t) i * 4096;
+        buf_sizes[i] = 4096;
+    }
+
+    ret = HG_Bulk_create(hg_class, count, bufs, buf_sizes, HG_BULK_READWRITE,
+        &struct_data->bulk);
+    if (ret != HG_SUCCESS) {
+        free(bufs[0]);
+        goto done;
+    }
+    struct_data->buf = bufs[0];
+    rc = 0;
+
+done:
+    free(bufs);
+    free(buf_sizes);
+    return rc;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_proc_bulk_finalize(void *data)
+{
+    hg_bench_proc_bulk_t *struct_data = (hg_bench_proc_bulk_t *) data;
+
+    HG_Bulk_free(struct_data->bulk);
+    free(struct_data->buf);
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_proc_raw_init(hg_class_t *hg_class, void *data, size_t size)
+{
+    hg_bench_proc_raw_t *struct_data = (hg_bench_proc_raw_t *) data;
+
+    (void) hg_class;
+    struct_data->size = size;
+    struct_data->buf = malloc(size ? size : 1);
+    if (struct_data->buf == NULL)
+        return -1;
+    memset(struct_data->buf, 0xA5, size);
+
+    return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_proc_raw_finalize(void *data)
+{
+    free(((hg_bench_proc_raw_t *) data)->buf);
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_proc_usage(const char *execname)
+{
+    size_t i;
+
+    printf("usage: %s [OPTIONS] [CASE...]\n", execname);
+    printf("  Cases (default: all):\n");
+    for (i = 0;
+         i < sizeof(hg_bench_proc_cases_g) / sizeof(*hg_bench_proc_cases_g);
+         i++)
+        printf("    %-10s%s\n", hg_bench_proc_cases_g[i].name,
+            hg_bench_proc_cases_g[i].description);
+    printf("  Options:\n");
+    printf("    -h, --help          Print a usage message and exit\n");
+    printf("    -i, --info          NA info string used for bulk handles "
+           "(default: %s)\n",
+        HG_BENCH_PROC_DEFAULT_INFO);
+    printf("    -s, --sizes         Sizes (overrides defaults of cases)\n");
+    printf("    -H, --hashes        Checksums (default: %s)\n",
+        HG_BENCH_PROC_DEFAULT_HASHES);
+    printf("    -n, --iterations    Iterations (default: %d)\n",
+        HG_BENCH_PROC_DEFAULT_ITERATIONS);
+    printf("    -r, --repeat        Runs of each configuration (baseline "
+           "uses the median)\n");
+    printf("    -j, --json          Write JSON results to file ('-' for "
+           "stdout)\n");
+    printf("    -b, --baseline      Fail if results regressed from baseline "
+           "file\n");
+    printf("    -T, --tolerance     Allowed regression in %% (default: %d)\n",
+        HG_BENCH_PROC_DEFAULT_TOLERANCE);
+    printf("    -U, --update        Update baseline file with results\n");
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_proc_parse_opts(
+    int argc, char *argv[], struct hg_bench_proc_opts *opts)
+{
+    static const struct option long_opts[] = {{"help", no_argument, NULL, 'h'},
+        {"info", required_argument, NULL, 'i'},
+        {"sizes", required_argument, NULL, 's'},
+        {"hashes", required_argument, NULL, 'H'},
+        {"iterations", required_argument, NULL, 'n'},
+        {"repeat", required_argument, NULL, 'r'},
+        {"json", required_argument, NULL, 'j'},
+        {"baseline", required_argument, NULL, 'b'},
+        {"tolerance", required_argument, NULL, 'T'},
+        {"update", no_argument, NULL, 'U'}, {NULL, 0, NULL, 0}};
+    const size_t ncases =
+        sizeof(hg_bench_proc_cases_g) / sizeof(*hg_bench_proc_cases_g);
+    char hashes[64];
+    char *hash, *saveptr = NULL;
+    size_t i;
+    int opt;
+
+    memset(opts, 0, sizeof(*opts));
+    opts->info_string = HG_BENCH_PROC_DEFAULT_INFO;
+    opts->iterations = HG_BENCH_PROC_DEFAULT_ITERATIONS;
+    opts->tolerance = HG_BENCH_PROC_DEFAULT_TOLERANCE;
+    opts->repeat = 1;
+    strcpy(hashes, HG_BENCH_PROC_DEFAULT_HASHES);
+
+    while ((opt = getopt_long(
+                argc, argv, "hi:s:H:n:r:j:b:T:U", long_opts, NULL)) != -1) {
+        switch (opt) {
+            case 'i':
+                opts->info_string = optarg;
+                break;
+            case 's':
+                opts->sizes = optarg;
+                break;
+            case 'H':
+                strncpy(hashes, optarg, sizeof(hashes) - 1);
+                hashes[sizeof(hashes) - 1] = '\0';
+                break;
+            case 'n':
+                opts->iterations = (unsigned int) strtoul(optarg, NULL, 0);
+                break;
+            case 'r':
+                opts->repeat = (unsigned int) strtoul(optarg, NULL, 0);
+                break;
+            case 'j':
+                opts->json_path = optarg;
+                break;
+            case 'b':
+                opts->baseline_path = optarg;
+                break;
+            case 'T':
+                opts->tolerance = strtod(optarg, NULL);
+                break;
+            case 'U':
+                opts->update_baseline = HG_TRUE;
+                break;
+            case 'h':
+            default:
+                hg_bench_proc_usage(argv[0]);
+                return -1;
+        }
+    }
+    HG_BENCH_PROC_CHECK(
+        opts->iterations == 0, error, "iterations must be > 0");
+    HG_BENCH_PROC_CHECK(opts->repeat == 0, error, "repeat must be > 0");
+    HG_BENCH_PROC_CHECK(opts->update_baseline && opts->baseline_path == NULL,
+        error, "--update requires --baseline");
+
+    for (; optind < argc; optind++) {
+        for (i = 0; i < ncases; i++)
+            if (strcmp(argv[optind], hg_bench_proc_cases_g[i].name) == 0)
+                break;
+        HG_BENCH_PROC_CHECK(
+            i == ncases, error, "unknown case \"%s\"", argv[optind]);
+        HG_BENCH_PROC_CHECK(opts->ncases ==
+                                sizeof(opts->cases) / sizeof(*opts->cases),
+            error, "too many cases");
+        opts->cases[opts->ncases++] = &hg_bench_proc_cases_g[i];
+    }
+    if (opts->ncases == 0)
+        for (i = 0; i < ncases; i++)
+            opts->cases[opts->ncases++] = &hg_bench_proc_cases_g[i];
+
+    for (hash = strtok_r(hashes, ",", &saveptr); hash;
+         hash = strtok_r(NULL, ",", &saveptr)) {
+        for (i = 0; i < sizeof(hg_bench_proc_hash_names_g) /
+                            sizeof(*hg_bench_proc_hash_names_g);
+             i++)
+            if (strcmp(hash, hg_bench_proc_hash_names_g[i]) == 0)
+                break;
+        HG_BENCH_PROC_CHECK(i == sizeof(hg_bench_proc_hash_names_g) /
+                                     sizeof(*hg_bench_proc_hash_names_g),
+            error, "unknown hash \"%s\"", hash);
+#ifndef HG_HAS_CHECKSUMS
+        /* Checksums are compiled out, all hashes would be identical */
+        if ((hg_proc_hash_t) i != HG_NOHASH)
+            continue;
+#endif
+        HG_BENCH_PROC_CHECK(opts->nhashes ==
+                                sizeof(opts->hashes) / sizeof(*opts->hashes),
+            error, "too many hashes");
+        opts->hashes[opts->nhashes++] = (hg_proc_hash_t) i;
+    }
+    HG_BENCH_PROC_CHECK(opts->nhashes == 0, error,
+        "no hash selected (checksums are only available with "
+        "MERCURY_USE_CHECKSUMS)");
+
+    return 0;
+
+error:
+    return -1;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_proc_measure(hg_class_t *hg_class,
+    const struct hg_bench_proc_opts *opts,
+    const struct hg_bench_proc_case *bench_case, hg_proc_hash_t hash,
+    size_t size, struct hg_bench_proc_result *result)
+{
+    hg_size_t buf_size = HG_Class_get_input_eager_size(hg_class);
+    hg_proc_t proc = HG_PROC_NULL;
+    void *in = NULL, *out = NULL, *enc_buf = NULL, *dec_buf = NULL;
+    hg_size_t dec_size;
+    hg_uint64_t checksum = 0;
+    hg_time_fast_t t1, t2;
+    hg_bool_t in_init = HG_FALSE;
+    unsigned int i;
+    hg_return_t ret;
+    int rc = -1;
+
+    memset(result, 0, sizeof(*result));
+    result->hash = hg_bench_proc_hash_names_g[hash];
+    result->size = size;
+
+    ret = hg_proc_create(hg_class, hash, &proc);
+    HG_BENCH_PROC_CHECK(ret != HG_SUCCESS, done, "could not create proc");
+
+    in = calloc(1, bench_case->struct_size);
+    out = calloc(1, bench_case->struct_size);
+    enc_buf = calloc(1, (size_t) buf_size);
+    HG_BENCH_PROC_CHECK(in == NULL || out == NULL || enc_buf == NULL, done,
+        "could not allocate buffers");
+    HG_BENCH_PROC_CHECK(bench_case->init(hg_class, in, size) != 0, done,
+        "could not initialize %s", bench_case->name);
+    in_init = HG_TRUE;
+
+    /* Encode: reset + proc + flush (+ checksum), a payload that does not fit
+     * in the eager buffer is encoded into an extra buffer allocated by proc */
+    t1 = hg_time_fast_now();
+    for (i = 0; i < opts->iterations; i++) {
+        ret = hg_proc_reset(proc, enc_buf, buf_size, HG_ENCODE);
+        if (ret == HG_SUCCESS)
+            ret = bench_case->proc_cb(proc, in);
+        if (ret == HG_SUCCESS)
+            ret = hg_proc_flush(proc);
+#ifdef HG_HAS_CHECKSUMS
+        if (ret == HG_SUCCESS && hash != HG_NOHASH)
+            ret = hg_proc_checksum_get(proc, &checksum, sizeof(checksum));
+#endif
+        HG_BENCH_PROC_CHECK(ret != HG_SUCCESS, done, "could not encode %s",
+            bench_case->name);
+    }
+    t2 = hg_time_fast_now();
+    result->encode_ns =
+        (double) hg_time_fast_to_ns(t2 - t1) / (double) opts->iterations;
+    result->encoded_size = hg_proc_get_size_used(proc);
+    result->overflow = (hg_proc_get_extra_buf(proc) != NULL);
+
+    /* Simulate RPC copy */
+    dec_size = result->overflow ? result->encoded_size : buf_size;
+    dec_buf = malloc((size_t) dec_size);
+    HG_BENCH_PROC_CHECK(dec_buf == NULL, done, "could not allocate buffer");
+    memcpy(dec_buf, result->overflow ? hg_proc_get_extra_buf(proc) : enc_buf,
+        (size_t) dec_size);
+
+    /* Decode: reset + proc + flush (+ verify) and free of decoded struct */
+    t1 = hg_time_fast_now();
+    for (i = 0; i < opts->iterations; i++) {
+        ret = hg_proc_reset(proc, dec_buf, dec_size, HG_DECODE);
+        if (ret == HG_SUCCESS)
+            ret = bench_case->proc_cb(proc, out);
+        if (ret == HG_SUCCESS)
+            ret = hg_proc_flush(proc);
+#ifdef HG_HAS_CHECKSUMS
+        if (ret == HG_SUCCESS && hash != HG_NOHASH)
+            ret = hg_proc_checksum_verify(proc, &checksum, sizeof(checksum));
+#endif
+        HG_BENCH_PROC_CHECK(ret != HG_SUCCESS, done, "could not decode %s",
+            bench_case->name);
+        ret = hg_proc_reset(proc, dec_buf, dec_size, HG_FREE);
+        if (ret == HG_SUCCESS)
+            ret = bench_case->proc_cb(proc, out);
+        HG_BENCH_PROC_CHECK(ret != HG_SUCCESS, done, "could not free %s",
+            bench_case->name);
+    }
+    t2 = hg_time_fast_now();
+    result->decode_ns =
+        (double) hg_time_fast_to_ns(t2 - t1) / (double) opts->iterations;
+    (void) checksum;
+
+    rc = 0;
+
+done:
+    if (in_init && bench_case->finalize)
+        bench_case->finalize(in);
+    if (proc != HG_PROC_NULL)
+        hg_proc_free(proc);
+    free(in);
+    free(out);
+    free(enc_buf);
+    free(dec_buf);
+
+    return rc;
+}
+
+/*---------------------------------------------------------------------------*/
+int
+main(int argc, char *argv[])
+{
+    struct hg_bench_proc_opts opts;
+    struct hg_bench_json json;
+    struct hg_bench_baseline *baseline = NULL;
+    hg_class_t *hg_class = NULL;
+    FILE *json_fp = NULL;
+    unsigned int c;
+    int rc = EXIT_FAILURE;
+
+    if (hg_bench_proc_parse_opts(argc, argv, &opts) != 0)
+        return EXIT_FAILURE;
+    if (opts.baseline_path) {
+        int ret;
+
+        baseline = (struct hg_bench_baseline *) malloc(sizeof(*baseline));
+        if (baseline == NULL)
+            return EXIT_FAILURE;
+        ret = hg_bench_baseline_init(baseline, opts.baseline_path,
+            opts.tolerance / 100.0, opts.update_baseline);
+        if (ret != 0) {
+            free(baseline);
+            return (ret == HG_BENCH_SKIP) ? HG_BENCH_SKIP : EXIT_FAILURE;
+        }
+    }
+    hg_time_fast_init();
+
+    /* Class is needed to serialize bulk handles */
+    hg_class = HG_Init(opts.info_string, HG_FALSE);
+    HG_BENCH_PROC_CHECK(hg_class == NULL, done,
+        "could not initialize with \"%s\"", opts.info_string);
+
+    if (opts.json_path) {
+        json_fp = (strcmp(opts.json_path, "-") == 0)
+                      ? stdout
+                      : fopen(opts.json_path, "w");
+        HG_BENCH_PROC_CHECK(json_fp == NULL, done, "could not open \"%s\"",
+            opts.json_path);
+        hg_bench_json_init(&json, json_fp);
+        hg_bench_json_object_begin(&json, NULL);
+        hg_bench_json_string(&json, "benchmark", "proc");
+        hg_bench_json_string(&json, "encoding", HG_BENCH_PROC_ENCODING);
+        hg_bench_json_uint(&json, "iterations", opts.iterations);
+        hg_bench_json_uint(
+            &json, "eager_size", HG_Class_get_input_eager_size(hg_class));
+        hg_bench_json_array_begin(&json, "results");
+    }
+    if (json_fp != stdout) {
+        printf("# proc (%s encoding), %u iterations, eager size %llu\n",
+            HG_BENCH_PROC_ENCODING, opts.iterations,
+            (unsigned long long) HG_Class_get_input_eager_size(hg_class));
+        printf("%-9s %-6s %9s %10s %12s %10s %12s %10s\n", "case", "hash",
+            "size", "encoded", "enc(ns)", "enc(GB/s)", "dec(ns)",
+            "dec(GB/s)");
+    }
+
+    for (c = 0; c < opts.ncases; c++) {
+        const struct hg_bench_proc_case *bench_case = opts.cases[c];
+        const char *sizes = opts.sizes ? opts.sizes : bench_case->sizes;
+        size_t size_list[HG_BENCH_PROC_MAX_LIST];
+        unsigned int nsizes, s, h, r;
+
+        nsizes = hg_bench_parse_list(sizes, size_list, HG_BENCH_PROC_MAX_LIST);
+        HG_BENCH_PROC_CHECK(nsizes == 0, done, "invalid sizes \"%s\"", sizes);
+
+        for (s = 0; s < nsizes; s++)
+            for (h = 0; h < opts.nhashes; h++)
+                for (r = 0; r < opts.repeat; r++) {
+                    struct hg_bench_proc_result result;
+                    double enc_gbs, dec_gbs;
+
+                    if (hg_bench_proc_measure(hg_class, &opts, bench_case,
+                            opts.hashes[h], size_list[s], &result) != 0)
+                        goto done;
+
+                    /* Bytes per ns is GB/s */
+                    enc_gbs = (double) result.encoded_size / result.encode_ns;
+                    dec_gbs = (double) result.encoded_size / result.decode_ns;
+                    if (json_fp) {
+                        hg_bench_json_object_begin(&json, NULL);
+                        hg_bench_json_string(&json, "case", bench_case->name);
+                        hg_bench_json_string(&json, "hash", result.hash);
+                        hg_bench_json_uint(&json, "size", result.size);
+                        hg_bench_json_uint(
+                            &json, "encoded_size", result.encoded_size);
+                        hg_bench_json_uint(&json, "overflow", result.overflow);
+                        hg_bench_json_double(
+                            &json, "encode_ns", result.encode_ns);
+                        hg_bench_json_double(&json, "encode_gbs", enc_gbs);
+                        hg_bench_json_double(
+                            &json, "decode_ns", result.decode_ns);
+                        hg_bench_json_double(&json, "decode_gbs", dec_gbs);
+                        hg_bench_json_object_end(&json);
+                    }
+                    if (json_fp != stdout) {
+                        printf("%-9s %-6s %9zu %10llu %12.1f %10.3f %12.1f "
+                               "%10.3f\n",
+                            bench_case->name, result.hash, result.size,
+                            (unsigned long long) result.encoded_size,
+                            result.encode_ns, enc_gbs, result.decode_ns,
+                            dec_gbs);
+                        fflush(stdout);
+                    }
+                    if (baseline) {
+                        char key[HG_BENCH_BASELINE_KEY_MAX];
+
+                        snprintf(key, sizeof(key),
+                            "proc.%s.%s.size=%zu.encode_ns", bench_case->name,
+                            result.hash, result.size);
+                        hg_bench_baseline_check(
+                            baseline, key, result.encode_ns, 0);
+                        snprintf(key, sizeof(key),
+                            "proc.%s.%s.size=%zu.decode_ns", bench_case->name,
+                            result.hash, result.size);
+                        hg_bench_baseline_check(
+                            baseline, key, result.decode_ns, 0);
+                    }
+                }
+    }
+    rc = EXIT_SUCCESS;
+
+done:
+    if (json_fp) {
+        hg_bench_json_array_end(&json);
+        hg_bench_json_object_end(&json);
+        if (json_fp != stdout)
+            fclose(json_fp);
+    }
+    if (hg_class)
+        HG_Finalize(hg_class);
+    if (baseline) {
+        if (hg_bench_baseline_finalize(baseline) != 0)
+            rc = EXIT_FAILURE;
+        free(baseline);
+    }
+
+    return rc;
+}
@@ -0,0 +1,936 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+/* CPU_SET() and related macros */
+#if !defined(_WIN32) && !defined(_GNU_SOURCE)
+#    define _GNU_SOURCE
+#endif
+
+#include "mercury_bench.h"
+
+#include "mercury_atomic.h"
+#include "mercury_atomic_queue.h"
+#include "mercury_event.h"
+#include "mercury_hash_table.h"
+#include "mercury_poll.h"
+#include "mercury_thread.h"
+#include "mercury_thread_mutex.h"
+#include "mercury_thread_pool.h"
+#include "mercury_thread_spin.h"
+#include "mercury_time.h"
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/****************/
+/* Local Macros */
+/****************/
+
+#define HG_BENCH_UTIL_MAX_THREADS 256
+#define HG_BENCH_UTIL_QUEUE_SIZE  1024 /* Power of 2 */
+#define HG_BENCH_UTIL_TABLE_KEYS  1024
+#define HG_BENCH_UTIL_POLL_WAIT   1000 /* ms */
+#define HG_BENCH_UTIL_SPIN_MAX    128  /* Spins before yielding */
+
+#if !defined(_WIN32) && !defined(__APPLE__)
+#    define HG_BENCH_UTIL_HAS_PIN
+#endif
+
+/* Report errors and bail out */
+#define HG_BENCH_UTIL_CHECK(cond, label, ...)                                  \
+    do {                                                                       \
+        if (cond) {                                                            \
+            fprintf(stderr, "hg_bench_util: " __VA_ARGS__);                    \
+            fputc('\n', stderr);                                               \
+            goto label;                                                        \
+        }                                                                      \
+    } while (0)
+
+/************************************/
+/* Local Type and Struct Definition */
+/************************************/
+
+struct hg_bench_util_state;
+
+struct hg_bench_util_thread {
+    struct hg_bench_util_state *state;
+    hg_thread_t thread;
+    unsigned int index;
+    int event_fd;               /* Poll benchmark */
+    hg_poll_set_t *poll_set;    /* Poll benchmark */
+    hg_util_uint64_t seed;      /* Hash table benchmark */
+    hg_util_uint64_t errors;
+    hg_time_fast_t start;
+    hg_time_fast_t end;
+};
+
+/* Benchmark description, init / finalize are optional */
+struct hg_bench_util_command {
+    const char *name;
+    const char *description;
+    unsigned int iterations; /* Default iterations per thread */
+    int (*init)(struct hg_bench_util_state *state);
+    void (*run)(struct hg_bench_util_thread *thread);
+    void (*finalize)(struct hg_bench_util_state *state);
+};
+
+struct hg_bench_util_opts {
+    const struct hg_bench_util_command *command;
+    size_t threads[HG_BENCH_UTIL_MAX_THREADS];
+    unsigned int nthreads;
+    unsigned int iterations;
+    unsigned int pool_threads;
+    hg_util_bool_t pin;
+    const char *json_path;
+};
+
+/* State shared by all threads of one run */
+struct hg_bench_util_state {
+    const struct hg_bench_util_opts *opts;
+    struct hg_bench_util_thread *threads;
+    unsigned int nthreads;
+    unsigned int iterations;
+    hg_atomic_int32_t ready; /* Start barrier */
+    hg_atomic_int32_t go;
+    /* Benchmark specific */
+    struct hg_atomic_queue *queue;
+    hg_hash_table_t *table;
+    hg_util_uint64_t *keys;
+    hg_thread_spin_t spin;
+    hg_thread_mutex_t mutex;
+    hg_util_uint64_t counter;
+    hg_thread_pool_t *pool;
+    struct hg_thread_work *works;
+    hg_atomic_int32_t done;
+};
+
+/* Result of one run */
+struct hg_bench_util_result {
+    unsigned int threads;
+    hg_util_uint64_t ops;
+    double elapsed;
+    double rate;
+    double speedup;    /* Rate relative to one thread */
+    double efficiency; /* Speedup divided by threads */
+};
+
+/********************/
+/* Local Prototypes */
+/********************/
+
+static void
+hg_bench_util_usage(const char *execname);
+
+static int
+hg_bench_util_parse_opts(
+    int argc, char *argv[], struct hg_bench_util_opts *opts);
+
+static int
+hg_bench_util_measure(const struct hg_bench_util_opts *opts,
+    unsigned int nthreads, struct hg_bench_util_result *result);
+
+static HG_THREAD_RETURN_TYPE
+hg_bench_util_thread_run(void *arg);
+
+static void
+hg_bench_util_barrier(struct hg_bench_util_thread *thread);
+
+static void
+hg_bench_util_pin(hg_thread_t thread, unsigned int index);
+
+static int
+hg_bench_util_queue_init(struct hg_bench_util_state *state);
+
+static void
+hg_bench_util_queue_run(struct hg_bench_util_thread *thread);
+
+static void
+hg_bench_util_queue_finalize(struct hg_bench_util_state *state);
+
+static unsigned int
+hg_bench_util_table_hash(hg_hash_table_key_t key);
+
+static int
+hg_bench_util_table_equal(hg_hash_table_key_t key1, hg_hash_table_key_t key2);
+
+static int
+hg_bench_util_table_init(struct hg_bench_util_state *state);
+
+static void
+hg_bench_util_table_run(struct hg_bench_util_thread *thread);
+
+static void
+hg_bench_util_table_finalize(struct hg_bench_util_state *state);
+
+static int
+hg_bench_util_lock_init(struct hg_bench_util_state *state);
+
+static void
+hg_bench_util_spin_run(struct hg_bench_util_thread *thread);
+
+static void
+hg_bench_util_mutex_run(struct hg_bench_util_thread *thread);
+
+static void
+hg_bench_util_lock_finalize(struct hg_bench_util_state *state);
+
+static int
+hg_bench_util_event_init(struct hg_bench_util_state *state);
+
+static void
+hg_bench_util_event_run(struct hg_bench_util_thread *thread);
+
+static void
+hg_bench_util_poll_run(struct hg_bench_util_thread *thread);
+
+static void
+hg_bench_util_event_finalize(struct hg_bench_util_state *state);
+
+static int
+hg_bench_util_pool_init(struct hg_bench_util_state *state);
+
+static HG_THREAD_RETURN_TYPE
+hg_bench_util_pool_work(void *arg);
+
+static void
+hg_bench_util_pool_run(struct hg_bench_util_thread *thread);
+
+static void
+hg_bench_util_pool_finalize(struct hg_bench_util_state *state);
+
+static void
+hg_bench_util_time_run(struct hg_bench_util_thread *thread);
+
+static void
+hg_bench_util_time_fast_run(struct hg_bench_util_thread *thread);
+
+/*******************/
+/* Local Variables */
+/*******************/
+
+static const struct hg_bench_util_command hg_bench_util_commands_g[] = {
+    {"atomic-queue", "hg_atomic_queue push / pop_mc pairs", 1000000,
+        hg_bench_util_queue_init, hg_bench_util_queue_run,
+        hg_bench_util_queue_finalize},
+    {"hash-table", "hg_hash_table lookup of random keys", 1000000,
+        hg_bench_util_table_init, hg_bench_util_table_run,
+        hg_bench_util_table_finalize},
+    {"spin", "hg_thread_spin lock / unlock of a shared lock", 1000000,
+        hg_bench_util_lock_init, hg_bench_util_spin_run,
+        hg_bench_util_lock_finalize},
+    {"mutex", "hg_thread_mutex lock / unlock of a shared lock", 1000000,
+        hg_bench_util_lock_init, hg_bench_util_mutex_run,
+        hg_bench_util_lock_finalize},
+    {"event", "hg_event_set / hg_event_get on a per-thread event", 1000000,
+        hg_bench_util_event_init, hg_bench_util_event_run,
+        hg_bench_util_event_finalize},
+    {"poll", "hg_poll_wait wakeups passed around a ring of threads", 100000,
+        hg_bench_util_event_init, hg_bench_util_poll_run,
+        hg_bench_util_event_finalize},
+    {"thread-pool", "hg_thread_pool_post of empty work items", 1000000,
+        hg_bench_util_pool_init, hg_bench_util_pool_run,
+        hg_bench_util_pool_finalize},
+    {"time", "hg_time_get_current", 10000000, NULL, hg_bench_util_time_run,
+        NULL},
+    {"time-fast", "hg_time_fast_now", 10000000, NULL,
+        hg_bench_util_time_fast_run, NULL}};
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_util_usage(const char *execname)
+{
+    size_t i;
+
+    printf("usage: %s <command> [OPTIONS]\n", execname);
+    printf("  Commands:\n");
+    for (i = 0; i < sizeof(hg_bench_util_commands_g) /
+                        sizeof(*hg_bench_util_commands_g);
+         i++)
+        printf("    %-14s%s\n", hg_bench_util_commands_g[i].name,
+            hg_bench_util_commands_g[i].description);
+    printf("  Options:\n");
+    printf("    -h, --help          Print a usage message and exit\n");
+    printf("    -t, --threads       Thread counts (default: 1-<ncpus>)\n");
+    printf("    -n, --iterations    Operations per thread\n");
+    printf("    -p, --pool-threads  Pool size for thread-pool (default: "
+           "threads)\n");
+    printf("    -P, --pin           Pin thread i to the i-th available "
+           "core\n");
+    printf("    -j, --json          Write JSON results to file ('-' for "
+           "stdout)\n");
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_util_parse_opts(
+    int argc, char *argv[], struct hg_bench_util_opts *opts)
+{
+    static const struct option long_opts[] = {{"help", no_argument, NULL, 'h'},
+        {"threads", required_argument, NULL, 't'},
+        {"iterations", required_argument, NULL, 'n'},
+        {"pool-threads", required_argument, NULL, 'p'},
+        {"pin", no_argument, NULL, 'P'},
+        {"json", required_argument, NULL, 'j'}, {NULL, 0, NULL, 0}};
+    char default_threads[32];
+    const char *threads = NULL;
+    size_t i;
+    int opt;
+
+    memset(opts, 0, sizeof(*opts));
+
+    if (argc < 2 || argv[1][0] == '-') {
+        hg_bench_util_usage(argv[0]);
+        return -1;
+    }
+    for (i = 0; i < sizeof(hg_bench_util_commands_g) /
+                        sizeof(*hg_bench_util_commands_g);
+         i++)
+        if (strcmp(argv[1], hg_bench_util_commands_g[i].name) == 0)
+            opts->command = &hg_bench_util_commands_g[i];
+    HG_BENCH_UTIL_CHECK(
+        opts->command == NULL, error, "unknown command \"%s\"", argv[1]);
+    opts->iterations = opts->command->iterations;
+
+    optind = 2;
+    while ((opt = getopt_long(argc, argv, "ht:n:p:Pj:", long_opts, NULL)) !=
+           -1) {
+        switch (opt) {
+            case 't':
+                threads = optarg;
+                break;
+            case 'n':
+                opts->iterations = (unsigned int) strtoul(optarg, NULL, 0);
+                break;
+            case 'p':
+                opts->pool_threads = (unsigned int) strtoul(optarg, NULL, 0);
+                break;
+            case 'P':
+                opts->pin = HG_UTIL_TRUE;
+                break;
+            case 'j':
+                opts->json_path = optarg;
+                break;
+            case 'h':
+            default:
+                hg_bench_util_usage(argv[0]);
+                return -1;
+        }
+    }
+
+    /* Default to powers of two up to the number of online cores */
+    if (threads == NULL) {
+        long ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+        snprintf(default_threads, sizeof(default_threads), "1-%ld",
+            (ncpus > 0) ? ncpus : 1);
+        threads = default_threads;
+    }
+    opts->nthreads =
+        hg_bench_parse_list(threads, opts->threads, HG_BENCH_UTIL_MAX_THREADS);
+    HG_BENCH_UTIL_CHECK(
+        opts->nthreads == 0, error, "invalid threads \"%s\"", threads);
+    for (i = 0; i < opts->nthreads; i++)
+        HG_BENCH_UTIL_CHECK(opts->threads[i] == 0 ||
+                                opts->threads[i] > HG_BENCH_UTIL_MAX_THREADS,
+            error, "threads must be within [1, %d]", HG_BENCH_UTIL_MAX_THREADS);
+    HG_BENCH_UTIL_CHECK(opts->iterations == 0, error, "iterations must be > 0");
+
+    return 0;
+
+error:
+    return -1;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_util_measure(const struct hg_bench_util_opts *opts,
+    unsigned int nthreads, struct hg_bench_util_result *result)
+{
+    struct hg_bench_util_state state;
+    hg_util_uint64_t errors = 0;
+    unsigned int i;
+    int rc = -1;
+
+    memset(&state, 0, sizeof(state));
+    state.opts = opts;
+    state.nthreads = nthreads;
+    state.iterations = opts->iterations;
+    hg_atomic_init32(&state.ready, 0);
+    hg_atomic_init32(&state.go, 0);
+    hg_atomic_init32(&state.done, 0);
+
+    state.threads = (struct hg_bench_util_thread *) calloc(
+        nthreads, sizeof(*state.threads));
+    HG_BENCH_UTIL_CHECK(
+        state.threads == NULL, done, "could not allocate threads");
+    for (i = 0; i < nthreads; i++) {
+        state.threads[i].state = &state;
+        state.threads[i].index = i;
+        state.threads[i].event_fd = -1;
+        state.threads[i].seed = 0x9E3779B97F4A7C15ULL * (i + 1);
+    }
+
+    if (opts->command->init) {
+        rc = opts->command->init(&state);
+        HG_BENCH_UTIL_CHECK(
+            rc != 0, done, "could not initialize %s", opts->command->name);
+    }
+
+    for (i = 0; i < nthreads; i++) {
+        hg_thread_create(&state.threads[i].thread, hg_bench_util_thread_run,
+            &state.threads[i]);
+        if (opts->pin)
+            hg_bench_util_pin(state.threads[i].thread, i);
+    }
+
+    /* Release all threads at once */
+    while ((unsigned int) hg_atomic_get32(&state.ready) < nthreads)
+        hg_thread_yield();
+    hg_atomic_set32(&state.go, 1);
+
+    for (i = 0; i < nthreads; i++)
+        hg_thread_join(state.threads[i].thread);
+
+    memset(result, 0, sizeof(*result));
+    result->threads = nthreads;
+    for (i = 0; i < nthreads; i++) {
+        double elapsed = (double) hg_time_fast_to_ns(
+                             state.threads[i].end - state.threads[i].start) /
+                         1e9;
+
+        if (elapsed > result->elapsed)
+            result->elapsed = elapsed;
+        errors += state.threads[i].errors;
+    }
+    result->ops = (hg_util_uint64_t) nthreads * opts->iterations;
+    result->rate =
+        (result->elapsed > 0) ? (double) result->ops / result->elapsed : 0;
+    rc = errors ? -1 : 0;
+    HG_BENCH_UTIL_CHECK(rc != 0, done, "%llu operation(s) failed",
+        (unsigned long long) errors);
+
+done:
+    if (opts->command->finalize)
+        opts->command->finalize(&state);
+    free(state.threads);
+
+    return rc;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_THREAD_RETURN_TYPE
+hg_bench_util_thread_run(void *arg)
+{
+    struct hg_bench_util_thread *thread = (struct hg_bench_util_thread *) arg;
+    hg_thread_ret_t tret = (hg_thread_ret_t) 0;
+
+    hg_bench_util_barrier(thread);
+    thread->start = hg_time_fast_now();
+    thread->state->opts->command->run(thread);
+    thread->end = hg_time_fast_now();
+
+    return tret;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_util_barrier(struct hg_bench_util_thread *thread)
+{
+    hg_atomic_incr32(&thread->state->ready);
+    while (!hg_atomic_get32(&thread->state->go))
+        hg_thread_yield();
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_util_pin(hg_thread_t thread, unsigned int index)
+{
+#ifdef HG_BENCH_UTIL_HAS_PIN
+    static hg_cpu_set_t allowed;
+    static int ncpus = -1;
+    hg_cpu_set_t cpu_set;
+    int cpu, n = 0, target;
+
+    /* CPUs available to the process */
+    if (ncpus < 0) {
+        if (hg_thread_getaffinity(hg_thread_self(), &allowed) !=
+            HG_UTIL_SUCCESS)
+            return;
+        ncpus = CPU_COUNT(&allowed);
+    }
+    if (ncpus == 0)
+        return;
+
+    target = (int) (index % (unsigned int) ncpus);
+    for (cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (!CPU_ISSET(cpu, &allowed))
+            continue;
+        if (n++ == target)
+            break;
+    }
+    CPU_ZERO(&cpu_set);
+    CPU_SET(cpu, &cpu_set);
+    hg_thread_setaffinity(thread, &cpu_set);
+#else
+    (void) thread;
+    (void) index;
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_util_queue_init(struct hg_bench_util_state *state)
+{
+    state->queue = hg_atomic_queue_alloc(HG_BENCH_UTIL_QUEUE_SIZE);
+
+    return (state->queue == NULL) ? -1 : 0;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_util_queue_run(struct hg_bench_util_thread *thread)
+{
+    struct hg_atomic_queue *queue = thread->state->queue;
+    unsigned int i;
+
+    /* Each thread has at most one entry in the queue, pop may return the
+     * entry of another thread. Yield after a bounded spin so that threads
+     * holding entries can run when oversubscribed */
+    for (i = 0; i < thread->state->iterations; i++) {
+        unsigned int spin = 0;
+
+        if (hg_atomic_queue_push(queue, thread) != HG_UTIL_SUCCESS)
+            thread->errors++;
+        while (hg_atomic_queue_pop_mc(queue) == NULL) {
+            if (++spin < HG_BENCH_UTIL_SPIN_MAX)
+                cpu_spinwait();
+            else {
+                hg_thread_yield();
+                spin = 0;
+            }
+        }
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_util_queue_finalize(struct hg_bench_util_state *state)
+{
+    if (state->queue)
+        hg_atomic_queue_free(state->queue);
+}
+
+/*---------------------------------------------------------------------------*/
+static unsigned int
+hg_bench_util_table_hash(hg_hash_table_key_t key)
+{
+    hg_util_uint64_t k = *(const hg_util_uint64_t *) key;
+
+    return (unsigned int) (k ^ (k >> 32));
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_util_table_equal(hg_hash_table_key_t key1, hg_hash_table_key_t key2)
+{
+    return *(const hg_util_uint64_t *) key1 ==
+           *(const hg_util_uint64_t *) key2;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_util_table_init(struct hg_bench_util_state *state)
+{
+    unsigned int i;
+
+#ifdef HG_UTIL_HAS_OA_HASH_TABLE
+    state->table = hg_hash_table_new_concurrent(
+        hg_bench_util_table_hash, hg_bench_util_table_equal);
+#else
+    state->table = hg_hash_table_new(
+        hg_bench_util_table_hash, hg_bench_util_table_equal);
+#endif
+    state->keys = (hg_util_uint64_t *) malloc(
+        HG_BENCH_UTIL_TABLE_KEYS * sizeof(*state->keys));
+    if (state->table == NULL || state->keys == NULL)
+        return -1;
+
+    for (i = 0; i < HG_BENCH_UTIL_TABLE_KEYS; i++) {
+        state->keys[i] = 0xC2B2AE3D27D4EB4FULL * (i + 1);
+        if (!hg_hash_table_insert(
+                state->table, &state->keys[i], &state->keys[i]))
+            return -1;
+    }
+
+    return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_util_table_run(struct hg_bench_util_thread *thread)
+{
+    struct hg_bench_util_state *state = thread->state;
+    hg_util_uint64_t seed = thread->seed;
+    unsigned int i;
+
+    /* Read-only, lookups may run concurrently without a writer */
+    for (i = 0; i < state->iterations; i++) {
+        hg_util_uint64_t *key;
+
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        key = &state->keys[seed % HG_BENCH_UTIL_TABLE_KEYS];
+#ifdef HG_UTIL_HAS_OA_HASH_TABLE
+        if (hg_hash_table_lookup_concurrent(state->table, key) != key)
+#else
+        if (hg_hash_table_lookup(state->table, key) != key)
+#endif
+            thread->errors++;
+    }
+    thread->seed = seed;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_util_table_finalize(struct hg_bench_util_state *state)
+{
+    if (state->table)
+        hg_hash_table_free(state->table);
+    free(state->keys);
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_util_lock_init(struct hg_bench_util_state *state)
+{
+    if (hg_thread_spin_init(&state->spin) != HG_UTIL_SUCCESS)
+        return -1;
+
+    return hg_thread_mutex_init(&state->mutex) == HG_UTIL_SUCCESS ? 0 : -1;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_util_spin_run(struct hg_bench_util_thread *thread)
+{
+    struct hg_bench_util_state *state = thread->state;
+    unsigned int i;
+
+    for (i = 0; i < state->iterations; i++) {
+        hg_thread_spin_lock(&state->spin);
+        state->counter++;
+        hg_thread_spin_unlock(&state->spin);
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_util_mutex_run(struct hg_bench_util_thread *thread)
+{
+    struct hg_bench_util_state *state = thread->state;
+    unsigned int i;
+
+    for (i = 0; i < state->iterations; i++) {
+        hg_thread_mutex_lock(&state->mutex);
+        state->counter++;
+        hg_thread_mutex_unlock(&state->mutex);
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_util_lock_finalize(struct hg_bench_util_state *state)
+{
+    /* Check that the lock did protect the counter */
+    if (state->counter != 0 &&
+        state->counter !=
+            (hg_util_uint64_t) state->nthreads * state->iterations)
+        state->threads[0].errors++;
+    hg_thread_spin_destroy(&state->spin);
+    hg_thread_mutex_destroy(&state->mutex);
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_util_event_init(struct hg_bench_util_state *state)
+{
+    unsigned int i;
+
+    for (i = 0; i < state->nthreads; i++) {
+        struct hg_bench_util_thread *thread = &state->threads[i];
+        struct hg_poll_event event;
+
+        thread->event_fd = hg_event_create();
+        if (thread->event_fd < 0)
+            return -1;
+        thread->poll_set = hg_poll_create();
+        if (thread->poll_set == NULL)
+            return -1;
+        event.events = HG_POLLIN;
+        event.data.ptr = thread;
+        if (hg_poll_add(thread->poll_set, thread->event_fd, &event) !=
+            HG_UTIL_SUCCESS)
+            return -1;
+    }
+
+    return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_util_event_run(struct hg_bench_util_thread *thread)
+{
+    unsigned int i;
+
+    for (i = 0; i < thread->state->iterations; i++) {
+        hg_util_bool_t signaled = HG_UTIL_FALSE;
+
+        if (hg_event_set(thread->event_fd) != HG_UTIL_SUCCESS ||
+            hg_event_get(thread->event_fd, &signaled) != HG_UTIL_SUCCESS ||
+            !signaled)
+            thread->errors++;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_util_poll_run(struct hg_bench_util_thread *thread)
+{
+    struct hg_bench_util_state *state = thread->state;
+    struct hg_bench_util_thread *next =
+        &state->threads[(thread->index + 1) % state->nthreads];
+    unsigned int i;
+
+    /* A single token goes around the ring, each thread receives it
+     * iterations times */
+    if (thread->index == 0 && hg_event_set(next->event_fd) != HG_UTIL_SUCCESS)
+        thread->errors++;
+
+    for (i = 0; i < state->iterations; i++) {
+        struct hg_poll_event event;
+        hg_util_bool_t signaled = HG_UTIL_FALSE;
+        unsigned int nevents = 0;
+
+        if (hg_poll_wait(thread->poll_set, HG_BENCH_UTIL_POLL_WAIT, 1, &event,
+                &nevents) != HG_UTIL_SUCCESS ||
+            nevents == 0 ||
+            hg_event_get(thread->event_fd, &signaled) != HG_UTIL_SUCCESS ||
+            !signaled) {
+            thread->errors++;
+            break;
+        }
+        if (thread->index == 0 && i == state->iterations - 1)
+            break;
+        if (hg_event_set(next->event_fd) != HG_UTIL_SUCCESS)
+            thread->errors++;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_util_event_finalize(struct hg_bench_util_state *state)
+{
+    unsigned int i;
+
+    for (i = 0; i < state->nthreads; i++) {
+        struct hg_bench_util_thread *thread = &state->threads[i];
+
+        if (thread->poll_set) {
+            if (thread->event_fd >= 0)
+                hg_poll_remove(thread->poll_set, thread->event_fd);
+            hg_poll_destroy(thread->poll_set);
+        }
+        if (thread->event_fd >= 0)
+            hg_event_destroy(thread->event_fd);
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_bench_util_pool_init(struct hg_bench_util_state *state)
+{
+    unsigned int pool_threads = state->opts->pool_threads
+                                    ? state->opts->pool_threads
+                                    : state->nthreads;
+    size_t i, nworks = (size_t) state->nthreads * state->iterations;
+
+    state->works = (struct hg_thread_work *) malloc(
+        nworks * sizeof(*state->works));
+    if (state->works == NULL)
+        return -1;
+    for (i = 0; i < nworks; i++) {
+        state->works[i].func = hg_bench_util_pool_work;
+        state->works[i].args = state;
+    }
+
+    return hg_thread_pool_init(pool_threads, &state->pool) == HG_UTIL_SUCCESS
+               ? 0
+               : -1;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_THREAD_RETURN_TYPE
+hg_bench_util_pool_work(void *arg)
+{
+    struct hg_bench_util_state *state = (struct hg_bench_util_state *) arg;
+    hg_thread_ret_t tret = (hg_thread_ret_t) 0;
+
+    hg_atomic_incr32(&state->done);
+
+    return tret;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_util_pool_run(struct hg_bench_util_thread *thread)
+{
+    struct hg_bench_util_state *state = thread->state;
+    struct hg_thread_work *works =
+        &state->works[(size_t) thread->index * state->iterations];
+    hg_util_int32_t total =
+        (hg_util_int32_t) (state->nthreads * state->iterations);
+    unsigned int i;
+
+    for (i = 0; i < state->iterations; i++)
+        if (hg_thread_pool_post(state->pool, &works[i]) != HG_UTIL_SUCCESS)
+            thread->errors++;
+
+    /* Time until all work items have run */
+    while (hg_atomic_get32(&state->done) < total && thread->errors == 0)
+        hg_thread_yield();
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_util_pool_finalize(struct hg_bench_util_state *state)
+{
+    if (state->pool)
+        hg_thread_pool_destroy(state->pool);
+    free(state->works);
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_util_time_run(struct hg_bench_util_thread *thread)
+{
+    hg_time_t t, last = {0, 0};
+    unsigned int i;
+
+    for (i = 0; i < thread->state->iterations; i++) {
+        hg_time_get_current(&t);
+        if (hg_time_less(t, last))
+            thread->errors++;
+        last = t;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_util_time_fast_run(struct hg_bench_util_thread *thread)
+{
+    hg_time_fast_t t, last = 0;
+    unsigned int i;
+
+    for (i = 0; i < thread->state->iterations; i++) {
+        t = hg_time_fast_now();
+        if (t < last)
+            thread->errors++;
+        last = t;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+int
+main(int argc, char *argv[])
+{
+    struct hg_bench_util_opts opts;
+    struct hg_bench_json json;
+    FILE *json_fp = NULL;
+    double base_rate = 0;
+    unsigned int i;
+    int rc = EXIT_SUCCESS;
+
+    if (hg_bench_util_parse_opts(argc, argv, &opts) != 0)
+        return EXIT_FAILURE;
+    hg_time_fast_init();
+
+    if (opts.json_path) {
+        json_fp = (strcmp(opts.json_path, "-") == 0)
+                      ? stdout
+                      : fopen(opts.json_path, "w");
+        HG_BENCH_UTIL_CHECK(json_fp == NULL, error, "could not open \"%s\"",
+            opts.json_path);
+        hg_bench_json_init(&json, json_fp);
+        hg_bench_json_object_begin(&json, NULL);
+        hg_bench_json_string(&json, "benchmark", opts.command->name);
+        hg_bench_json_uint(&json, "iterations", opts.iterations);
+        hg_bench_json_uint(&json, "pinned", opts.pin);
+        hg_bench_json_array_begin(&json, "results");
+    }
+    if (json_fp != stdout) {
+        printf("# %s: %s, %u iterations per thread%s\n", opts.command->name,
+            opts.command->description, opts.iterations,
+            opts.pin ? ", pinned" : "");
+        printf("%-8s %14s %14s %10s %10s %10s\n", "threads", "ops/s",
+            "ops/s/thread", "ns/op", "speedup", "efficiency");
+    }
+
+    for (i = 0; i < opts.nthreads; i++) {
+        struct hg_bench_util_result result;
+
+        if (hg_bench_util_measure(
+                &opts, (unsigned int) opts.threads[i], &result) != 0) {
+            rc = EXIT_FAILURE;
+            break;
+        }
+
+        /* Scaling is relative to the first (smallest) thread count */
+        if (i == 0)
+            base_rate = result.rate / result.threads;
+        result.speedup = (base_rate > 0) ? result.rate / base_rate : 0;
+        result.efficiency = result.speedup / result.threads;
+
+        if (json_fp) {
+            hg_bench_json_object_begin(&json, NULL);
+            hg_bench_json_uint(&json, "threads", result.threads);
+            hg_bench_json_uint(&json, "ops", result.ops);
+            hg_bench_json_double(&json, "elapsed_s", result.elapsed);
+            hg_bench_json_double(&json, "rate_ops", result.rate);
+            hg_bench_json_double(
+                &json, "rate_ops_per_thread", result.rate / result.threads);
+            hg_bench_json_double(&json, "speedup", result.speedup);
+            hg_bench_json_double(&json, "efficiency", result.efficiency);
+            hg_bench_json_object_end(&json);
+        }
+        if (json_fp != stdout) {
+            printf("%-8u %14.0f %14.0f %10.2f %10.2f %10.2f\n", result.threads,
+                result.rate, result.rate / result.threads,
+                (result.rate > 0) ? 1e9 * result.threads / result.rate : 0,
+                result.speedup, result.efficiency);
+            fflush(stdout);
+        }
+    }
+
+    if (json_fp) {
+        hg_bench_json_array_end(&json);
+        hg_bench_json_object_end(&json);
+        if (json_fp != stdout)
+            fclose(json_fp);
+    }
+
+    return rc;
+
+error:
+    return EXIT_FAILURE;
+}
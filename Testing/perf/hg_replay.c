@@ -0,0 +1,834 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+/*
+ * Replay a capture log recorded with HG_Capture_start() / HG_CAPTURE_FILE
+ * against a server: requests are re-issued with their recorded RPC ID,
+ * input and inter-arrival times, bulk regions of the recorded sizes are
+ * synthesized and their descriptors substituted in the input. The server
+ * must have the captured RPCs registered. Requests whose input exceeded the
+ * eager size are skipped (the extra payload is not captured), as well as
+ * requests to the RPCs given with --skip, which by default are the shutdown
+ * RPCs of the test server and of hg_bench so that replay leaves the server
+ * running.
+ */
+
+#include "mercury.h"
+#include "mercury_bulk.h"
+#include "mercury_capture.h"
+#include "mercury_core.h"
+
+#include "mercury_bench.h"
+#include "mercury_hash_string.h"
+#include "mercury_time.h"
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/****************/
+/* Local Macros */
+/****************/
+
+#define HG_REPLAY_ADDR_MAX         256
+#define HG_REPLAY_PROGRESS_TIMEOUT 10 /* ms */
+
+#define HG_REPLAY_DEFAULT_INFO  "na+sm"
+#define HG_REPLAY_DEFAULT_DEPTH 64
+#define HG_REPLAY_DEFAULT_SKIP  "hg_test_finalize,hg_bench_shutdown"
+
+#define HG_REPLAY_SKIP_MAX 64
+
+/* Report errors and bail out */
+#define HG_REPLAY_CHECK(cond, label, ...)                                      \
+    do {                                                                       \
+        if (cond) {                                                            \
+            fprintf(stderr, "hg_replay: " __VA_ARGS__);                        \
+            fputc('\n', stderr);                                               \
+            goto label;                                                        \
+        }                                                                      \
+    } while (0)
+
+/************************************/
+/* Local Type and Struct Definition */
+/************************************/
+
+struct hg_replay_opts {
+    const char *info_string;
+    const char *addr_string;
+    const char *addr_file;
+    const char *json_path;
+    const char *capture_path;
+    const char *skip;   /* RPC names or IDs not replayed */
+    double speed;       /* Time scale of inter-arrival times (0: no wait) */
+    unsigned int depth; /* Max requests in flight */
+    size_t count;       /* Max requests replayed (0: all) */
+};
+
+/* Captured request */
+struct hg_replay_req {
+    struct hg_capture_record record;
+    struct hg_capture_bulk *bulks;
+    char *in;
+};
+
+/* Per RPC ID results */
+struct hg_replay_rpc {
+    hg_id_t id;
+    size_t ops;
+    size_t errors;
+    struct hg_bench_hist hist;
+};
+
+struct hg_replay {
+    const struct hg_replay_opts *opts;
+    hg_id_t skip_ids[HG_REPLAY_SKIP_MAX];
+    unsigned int nskip_ids;
+    hg_class_t *hg_class;
+    hg_context_t *context;
+    hg_addr_t addr;
+    struct hg_replay_req *reqs;
+    size_t nreqs;
+    struct hg_replay_rpc *rpcs;
+    unsigned int nrpcs;
+    struct hg_bench_hist hist; /* All RPCs */
+    unsigned int in_flight;
+    size_t ops;
+    size_t errors;
+    size_t skipped;
+    hg_uint64_t lag_max; /* Max issue delay behind schedule (ns) */
+    double elapsed;      /* Replay time (s) */
+};
+
+/* Request in flight */
+struct hg_replay_op {
+    struct hg_replay *replay;
+    struct hg_replay_rpc *rpc;
+    hg_handle_t handle;
+    hg_bulk_t bulks[HG_CAPTURE_BULK_MAX];
+    unsigned int bulk_count;
+    hg_time_fast_t start;
+};
+
+/********************/
+/* Local Prototypes */
+/********************/
+
+static void
+hg_replay_usage(const char *execname);
+
+static int
+hg_replay_parse_opts(int argc, char *argv[], struct hg_replay_opts *opts);
+
+static int
+hg_replay_parse_skip(struct hg_replay *replay, const char *skip);
+
+static hg_bool_t
+hg_replay_skipped(const struct hg_replay *replay, hg_id_t id);
+
+static int
+hg_replay_load(struct hg_replay *replay, const char *path);
+
+static int
+hg_replay_req_cmp(const void *a, const void *b);
+
+static int
+hg_replay_init(struct hg_replay *replay, const struct hg_replay_opts *opts,
+    const char *addr_string);
+
+static void
+hg_replay_finalize(struct hg_replay *replay);
+
+static struct hg_replay_rpc *
+hg_replay_rpc_get(struct hg_replay *replay, hg_id_t id);
+
+static int
+hg_replay_encode(struct hg_replay *replay, const struct hg_replay_req *req,
+    struct hg_replay_op *op, char *buf, hg_size_t buf_size,
+    hg_size_t *payload_size);
+
+static int
+hg_replay_issue(struct hg_replay *replay, const struct hg_replay_req *req);
+
+static hg_return_t
+hg_replay_forward_cb(const struct hg_core_cb_info *callback_info);
+
+static void
+hg_replay_op_free(struct hg_replay_op *op);
+
+static void
+hg_replay_progress(struct hg_replay *replay, unsigned int timeout);
+
+static int
+hg_replay_run(struct hg_replay *replay);
+
+static void
+hg_replay_print(const struct hg_replay *replay);
+
+static int
+hg_replay_json(const struct hg_replay *replay);
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_replay_usage(const char *execname)
+{
+    printf("usage: %s [OPTIONS] <capture file>\n", execname);
+    printf("  Options:\n");
+    printf("    -h, --help          Print a usage message and exit\n");
+    printf("    -i, --info          NA info string (default: %s)\n",
+        HG_REPLAY_DEFAULT_INFO);
+    printf("    -a, --addr          Server address\n");
+    printf("    -f, --addr-file     File where the server address is read\n");
+    printf("    -x, --speed         Replay speed factor, 0 does not wait "
+           "between requests (default: 1)\n");
+    printf("    -d, --depth         Max requests in flight (default: %d)\n",
+        HG_REPLAY_DEFAULT_DEPTH);
+    printf("    -n, --count         Max requests replayed (default: all)\n");
+    printf("    -s, --skip          RPC names or IDs not replayed (default: "
+           "%s, empty to replay all)\n",
+        HG_REPLAY_DEFAULT_SKIP);
+    printf("    -j, --json          Write JSON results to file ('-' for "
+           "stdout)\n");
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_replay_parse_opts(int argc, char *argv[], struct hg_replay_opts *opts)
+{
+    static const struct option long_opts[] = {{"help", no_argument, NULL, 'h'},
+        {"info", required_argument, NULL, 'i'},
+        {"addr", required_argument, NULL, 'a'},
+        {"addr-file", required_argument, NULL, 'f'},
+        {"speed", required_argument, NULL, 'x'},
+        {"depth", required_argument, NULL, 'd'},
+        {"count", required_argument, NULL, 'n'},
+        {"skip", required_argument, NULL, 's'},
+        {"json", required_argument, NULL, 'j'}, {NULL, 0, NULL, 0}};
+    int opt;
+
+    memset(opts, 0, sizeof(*opts));
+    opts->info_string = HG_REPLAY_DEFAULT_INFO;
+    opts->speed = 1.0;
+    opts->depth = HG_REPLAY_DEFAULT_DEPTH;
+    opts->skip = HG_REPLAY_DEFAULT_SKIP;
+
+    while ((opt = getopt_long(argc, argv, "hi:a:f:x:d:n:s:j:", long_opts,
+                NULL)) != -1) {
+        switch (opt) {
+            case 'i':
+                opts->info_string = optarg;
+                break;
+            case 'a':
+                opts->addr_string = optarg;
+                break;
+            case 'f':
+                opts->addr_file = optarg;
+                break;
+            case 'x':
+                opts->speed = strtod(optarg, NULL);
+                break;
+            case 'd':
+                opts->depth = (unsigned int) strtoul(optarg, NULL, 0);
+                break;
+            case 'n':
+                opts->count = (size_t) strtoul(optarg, NULL, 0);
+                break;
+            case 's':
+                opts->skip = optarg;
+                break;
+            case 'j':
+                opts->json_path = optarg;
+                break;
+            case 'h':
+            default:
+                hg_replay_usage(argv[0]);
+                return -1;
+        }
+    }
+    if (optind != argc - 1) {
+        hg_replay_usage(argv[0]);
+        return -1;
+    }
+    opts->capture_path = argv[optind];
+
+    HG_REPLAY_CHECK(opts->speed < 0, error, "speed must be >= 0");
+    HG_REPLAY_CHECK(opts->depth == 0, error, "depth must be > 0");
+    HG_REPLAY_CHECK(opts->addr_string == NULL && opts->addr_file == NULL,
+        error, "--addr or --addr-file is required");
+
+    return 0;
+
+error:
+    return -1;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_replay_parse_skip(struct hg_replay *replay, const char *skip)
+{
+    char *list = strdup(skip), *token, *saveptr = NULL;
+
+    HG_REPLAY_CHECK(list == NULL, error, "could not allocate skip list");
+
+    for (token = strtok_r(list, ",", &saveptr); token != NULL;
+         token = strtok_r(NULL, ",", &saveptr)) {
+        char *end;
+        hg_id_t id = (hg_id_t) strtoull(token, &end, 0);
+
+        HG_REPLAY_CHECK(replay->nskip_ids == HG_REPLAY_SKIP_MAX, error,
+            "too many RPCs to skip (max %d)", HG_REPLAY_SKIP_MAX);
+
+        /* RPC IDs registered by name are the hash of the name */
+        if (*end != '\0')
+            id = (hg_id_t) hg_hash_string(token);
+        replay->skip_ids[replay->nskip_ids++] = id;
+    }
+    free(list);
+
+    return 0;
+
+error:
+    free(list);
+    return -1;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_bool_t
+hg_replay_skipped(const struct hg_replay *replay, hg_id_t id)
+{
+    unsigned int i;
+
+    for (i = 0; i < replay->nskip_ids; i++)
+        if (replay->skip_ids[i] == id)
+            return HG_TRUE;
+
+    return HG_FALSE;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_replay_load(struct hg_replay *replay, const char *path)
+{
+    struct hg_capture_file_header header;
+    size_t max_reqs = 0;
+    FILE *fp;
+
+    fp = fopen(path, "rb");
+    HG_REPLAY_CHECK(fp == NULL, error, "could not open \"%s\"", path);
+    HG_REPLAY_CHECK(fread(&header, sizeof(header), 1, fp) != 1 ||
+                        memcmp(header.magic, HG_CAPTURE_MAGIC,
+                            sizeof(header.magic)) != 0,
+        error, "\"%s\" is not a capture file", path);
+    HG_REPLAY_CHECK(header.version != HG_CAPTURE_VERSION, error,
+        "unsupported capture version %u", header.version);
+
+    for (;;) {
+        struct hg_replay_req *req;
+
+        if (replay->nreqs == max_reqs) {
+            struct hg_replay_req *reqs;
+
+            max_reqs = (max_reqs) ? max_reqs * 2 : 1024;
+            reqs = (struct hg_replay_req *) realloc(
+                replay->reqs, max_reqs * sizeof(struct hg_replay_req));
+            HG_REPLAY_CHECK(reqs == NULL, error, "could not allocate requests");
+            replay->reqs = reqs;
+        }
+        req = &replay->reqs[replay->nreqs];
+        memset(req, 0, sizeof(*req));
+
+        if (fread(&req->record, sizeof(req->record), 1, fp) != 1)
+            break;
+        HG_REPLAY_CHECK(req->record.bulk_count > HG_CAPTURE_BULK_MAX, error,
+            "invalid bulk count in record %zu", replay->nreqs);
+        replay->nreqs++;
+
+        req->in = (char *) malloc(req->record.in_size);
+        HG_REPLAY_CHECK(req->in == NULL && req->record.in_size > 0, error,
+            "could not allocate input");
+        if (req->record.bulk_count > 0) {
+            req->bulks = (struct hg_capture_bulk *) malloc(
+                req->record.bulk_count * sizeof(struct hg_capture_bulk));
+            HG_REPLAY_CHECK(
+                req->bulks == NULL, error, "could not allocate bulk records");
+        }
+        HG_REPLAY_CHECK(fread(req->in, 1, req->record.in_size, fp) !=
+                                req->record.in_size ||
+                            fread(req->bulks, sizeof(struct hg_capture_bulk),
+                                req->record.bulk_count,
+                                fp) != req->record.bulk_count,
+            error, "truncated record %zu", replay->nreqs - 1);
+
+        /* Drop requests that must not be replayed, e.g., shutdown */
+        if (hg_replay_skipped(replay, req->record.id)) {
+            free(req->in);
+            free(req->bulks);
+            replay->nreqs--;
+            replay->skipped++;
+        }
+    }
+    fclose(fp);
+
+    /* Records are written on completion, replay in arrival order */
+    qsort(replay->reqs, replay->nreqs, sizeof(struct hg_replay_req),
+        hg_replay_req_cmp);
+
+    return 0;
+
+error:
+    if (fp)
+        fclose(fp);
+    return -1;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_replay_req_cmp(const void *a, const void *b)
+{
+    const struct hg_replay_req *req_a = (const struct hg_replay_req *) a;
+    const struct hg_replay_req *req_b = (const struct hg_replay_req *) b;
+
+    if (req_a->record.time_ns != req_b->record.time_ns)
+        return (req_a->record.time_ns < req_b->record.time_ns) ? -1 : 1;
+
+    return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_replay_init(struct hg_replay *replay, const struct hg_replay_opts *opts,
+    const char *addr_string)
+{
+    hg_return_t ret;
+    size_t i;
+
+    replay->opts = opts;
+    hg_bench_hist_reset(&replay->hist);
+
+    replay->hg_class = HG_Init(opts->info_string, HG_FALSE);
+    HG_REPLAY_CHECK(replay->hg_class == NULL, error,
+        "could not initialize client with \"%s\"", opts->info_string);
+    replay->context = HG_Context_create(replay->hg_class);
+    HG_REPLAY_CHECK(replay->context == NULL, error, "could not create context");
+
+    ret = HG_Addr_lookup2(replay->hg_class, addr_string, &replay->addr);
+    HG_REPLAY_CHECK(
+        ret != HG_SUCCESS, error, "could not lookup \"%s\"", addr_string);
+
+    /* Register all RPC IDs first, ops in flight point to their results */
+    for (i = 0; i < replay->nreqs; i++)
+        if (hg_replay_rpc_get(replay, replay->reqs[i].record.id) == NULL)
+            goto error;
+
+    return 0;
+
+error:
+    return -1;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_replay_finalize(struct hg_replay *replay)
+{
+    size_t i;
+
+    if (replay->addr != HG_ADDR_NULL)
+        HG_Addr_free(replay->hg_class, replay->addr);
+    if (replay->context)
+        HG_Context_destroy(replay->context);
+    if (replay->hg_class)
+        HG_Finalize(replay->hg_class);
+    for (i = 0; i < replay->nreqs; i++) {
+        free(replay->reqs[i].in);
+        free(replay->reqs[i].bulks);
+    }
+    free(replay->reqs);
+    free(replay->rpcs);
+    memset(replay, 0, sizeof(*replay));
+}
+
+/*---------------------------------------------------------------------------*/
+static struct hg_replay_rpc *
+hg_replay_rpc_get(struct hg_replay *replay, hg_id_t id)
+{
+    struct hg_replay_rpc *rpcs;
+    hg_return_t ret;
+    unsigned int i;
+
+    for (i = 0; i < replay->nrpcs; i++)
+        if (replay->rpcs[i].id == id)
+            return &replay->rpcs[i];
+
+    /* Input is sent raw, no proc callbacks are needed */
+    ret = HG_Register(replay->hg_class, id, NULL, NULL, NULL);
+    HG_REPLAY_CHECK(ret != HG_SUCCESS, error,
+        "could not register RPC ID %llu", (unsigned long long) id);
+
+    rpcs = (struct hg_replay_rpc *) realloc(
+        replay->rpcs, (replay->nrpcs + 1) * sizeof(struct hg_replay_rpc));
+    HG_REPLAY_CHECK(rpcs == NULL, error, "could not allocate RPC results");
+    replay->rpcs = rpcs;
+    memset(&rpcs[replay->nrpcs], 0, sizeof(struct hg_replay_rpc));
+    rpcs[replay->nrpcs].id = id;
+    hg_bench_hist_reset(&rpcs[replay->nrpcs].hist);
+
+    return &replay->rpcs[replay->nrpcs++];
+
+error:
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_replay_encode(struct hg_replay *replay, const struct hg_replay_req *req,
+    struct hg_replay_op *op, char *buf, hg_size_t buf_size,
+    hg_size_t *payload_size)
+{
+    hg_size_t in_offset = 0, buf_offset = 0;
+    unsigned int i;
+
+    /* Bulk descriptors are encoded as a 64-bit size followed by the
+     * serialized descriptor, substitute descriptors of local regions */
+    for (i = 0; i < req->record.bulk_count; i++) {
+        const struct hg_capture_bulk *bulk = &req->bulks[i];
+        hg_size_t bulk_size = bulk->bulk_size;
+        hg_uint64_t desc_size, orig_desc_size;
+        hg_return_t ret;
+
+        if (bulk->desc_offset < in_offset + sizeof(hg_uint64_t) ||
+            bulk->desc_offset + bulk->desc_size > req->record.in_size)
+            goto error;
+        memcpy(&orig_desc_size, req->in + bulk->desc_offset -
+                                    sizeof(hg_uint64_t),
+            sizeof(hg_uint64_t));
+        if (orig_desc_size != bulk->desc_size)
+            goto error; /* Not a native encoding */
+
+        ret = HG_Bulk_create(replay->hg_class, 1, NULL, &bulk_size,
+            HG_BULK_READWRITE, &op->bulks[op->bulk_count]);
+        HG_REPLAY_CHECK(
+            ret != HG_SUCCESS, error, "could not create bulk handle");
+        op->bulk_count++;
+
+        desc_size =
+            HG_Bulk_get_serialize_size(op->bulks[op->bulk_count - 1], HG_FALSE);
+        if (buf_offset + (bulk->desc_offset - in_offset) + desc_size >
+            buf_size)
+            goto error;
+
+        memcpy(buf + buf_offset, req->in + in_offset,
+            bulk->desc_offset - sizeof(hg_uint64_t) - in_offset);
+        buf_offset += bulk->desc_offset - sizeof(hg_uint64_t) - in_offset;
+        memcpy(buf + buf_offset, &desc_size, sizeof(hg_uint64_t));
+        buf_offset += sizeof(hg_uint64_t);
+        ret = HG_Bulk_serialize(buf + buf_offset, desc_size, HG_FALSE,
+            op->bulks[op->bulk_count - 1]);
+        HG_REPLAY_CHECK(
+            ret != HG_SUCCESS, error, "could not serialize bulk handle");
+        buf_offset += desc_size;
+        in_offset = bulk->desc_offset + bulk->desc_size;
+    }
+
+    if (buf_offset + (req->record.in_size - in_offset) > buf_size)
+        goto error;
+    memcpy(buf + buf_offset, req->in + in_offset,
+        req->record.in_size - in_offset);
+    *payload_size = buf_offset + (req->record.in_size - in_offset);
+
+    return 0;
+
+error:
+    return -1;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_replay_issue(struct hg_replay *replay, const struct hg_replay_req *req)
+{
+    struct hg_replay_op *op = NULL;
+    hg_size_t buf_size, payload_size;
+    void *buf;
+    hg_return_t ret;
+
+    if (req->record.flags & HG_CAPTURE_MORE_DATA)
+        goto skip;
+
+    op = (struct hg_replay_op *) calloc(1, sizeof(*op));
+    HG_REPLAY_CHECK(op == NULL, error, "could not allocate op");
+    op->replay = replay;
+    op->rpc = hg_replay_rpc_get(replay, req->record.id);
+    if (op->rpc == NULL)
+        goto error;
+
+    ret = HG_Create(replay->context, replay->addr, req->record.id, &op->handle);
+    HG_REPLAY_CHECK(ret != HG_SUCCESS, error, "could not create handle");
+
+    /* Input is copied as is after the core header */
+    HG_Core_get_input(op->handle->core_handle, &buf, &buf_size);
+    if (hg_replay_encode(replay, req, op, (char *) buf, buf_size,
+            &payload_size) != 0)
+        goto skip;
+
+    op->start = hg_time_fast_now();
+    ret = HG_Core_forward(op->handle->core_handle, hg_replay_forward_cb, op,
+        (req->record.flags & HG_CAPTURE_NO_RESPONSE) ? HG_CORE_NO_RESPONSE
+                                                     : 0,
+        payload_size);
+    HG_REPLAY_CHECK(ret != HG_SUCCESS, error, "could not forward RPC %llu",
+        (unsigned long long) req->record.id);
+    replay->in_flight++;
+
+    return 0;
+
+skip:
+    replay->skipped++;
+    hg_replay_op_free(op);
+    return 0;
+
+error:
+    hg_replay_op_free(op);
+    return -1;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_replay_forward_cb(const struct hg_core_cb_info *callback_info)
+{
+    struct hg_replay_op *op = (struct hg_replay_op *) callback_info->arg;
+    struct hg_replay *replay = op->replay;
+    hg_uint64_t lat = hg_time_fast_to_ns(hg_time_fast_now() - op->start);
+
+    if (callback_info->ret != HG_SUCCESS) {
+        op->rpc->errors++;
+        replay->errors++;
+    } else {
+        hg_bench_hist_record(&op->rpc->hist, lat);
+        hg_bench_hist_record(&replay->hist, lat);
+    }
+    op->rpc->ops++;
+    replay->ops++;
+    replay->in_flight--;
+    hg_replay_op_free(op);
+
+    return HG_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_replay_op_free(struct hg_replay_op *op)
+{
+    unsigned int i;
+
+    if (op == NULL)
+        return;
+    for (i = 0; i < op->bulk_count; i++)
+        HG_Bulk_free(op->bulks[i]);
+    if (op->handle)
+        HG_Destroy(op->handle);
+    free(op);
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_replay_progress(struct hg_replay *replay, unsigned int timeout)
+{
+    unsigned int count;
+    hg_return_t ret;
+
+    HG_Progress(replay->context, timeout);
+
+    do {
+        count = 0;
+        ret = HG_Trigger(replay->context, 0, 64, &count);
+    } while (ret == HG_SUCCESS && count > 0);
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_replay_run(struct hg_replay *replay)
+{
+    size_t nreqs = replay->nreqs, next = 0;
+    double scale = (replay->opts->speed > 0) ? 1.0 / replay->opts->speed : 0;
+    hg_time_fast_t t0;
+    hg_uint64_t time0;
+
+    if (replay->opts->count > 0 && replay->opts->count < nreqs)
+        nreqs = replay->opts->count;
+    if (nreqs == 0)
+        return 0;
+
+    time0 = replay->reqs[0].record.time_ns;
+    t0 = hg_time_fast_now();
+
+    while (next < nreqs || replay->in_flight > 0) {
+        hg_uint64_t now = hg_time_fast_to_ns(hg_time_fast_now() - t0), due;
+        unsigned int timeout = HG_REPLAY_PROGRESS_TIMEOUT;
+
+        /* Issue all requests that are due */
+        while (next < nreqs && replay->in_flight < replay->opts->depth) {
+            due = (hg_uint64_t) (scale *
+                                 (double) (replay->reqs[next].record.time_ns -
+                                           time0));
+            if (due > now) {
+                hg_uint64_t wait_ms = (due - now) / 1000000;
+
+                if (wait_ms < timeout)
+                    timeout = (unsigned int) wait_ms;
+                break;
+            }
+            if (now - due > replay->lag_max)
+                replay->lag_max = now - due;
+            if (hg_replay_issue(replay, &replay->reqs[next]) != 0)
+                goto error;
+            next++;
+        }
+
+        /* Also waits for the next request when none is in flight */
+        hg_replay_progress(replay, timeout);
+    }
+    replay->elapsed =
+        (double) hg_time_fast_to_ns(hg_time_fast_now() - t0) / 1e9;
+
+    return 0;
+
+error:
+    /* Drain requests in flight */
+    while (replay->in_flight > 0)
+        hg_replay_progress(replay, HG_REPLAY_PROGRESS_TIMEOUT);
+    return -1;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_replay_print(const struct hg_replay *replay)
+{
+    struct hg_bench_stats stats;
+    unsigned int i;
+
+    printf("# %s (%s), %zu requests, %zu skipped, %zu errors, %.3f s, max "
+           "lag %.2f us\n",
+        replay->opts->capture_path, replay->opts->info_string, replay->ops,
+        replay->skipped, replay->errors, replay->elapsed,
+        (double) replay->lag_max / 1000.0);
+    printf("%-20s %10s %8s %10s %10s %10s %10s %10s %10s\n", "rpc_id", "ops",
+        "errors", "avg(us)", "p50(us)", "p90(us)", "p99(us)", "p99.9(us)",
+        "max(us)");
+    for (i = 0; i < replay->nrpcs; i++) {
+        const struct hg_replay_rpc *rpc = &replay->rpcs[i];
+
+        hg_bench_hist_stats(&rpc->hist, 1000.0, &stats);
+        printf("%-20llu %10zu %8zu %10.2f %10.2f %10.2f %10.2f %10.2f %10.2f\n",
+            (unsigned long long) rpc->id, rpc->ops, rpc->errors, stats.mean,
+            stats.p50, stats.p90, stats.p99, stats.p999, stats.max);
+    }
+    hg_bench_hist_stats(&replay->hist, 1000.0, &stats);
+    printf("%-20s %10zu %8zu %10.2f %10.2f %10.2f %10.2f %10.2f %10.2f\n",
+        "all", replay->ops, replay->errors, stats.mean, stats.p50, stats.p90,
+        stats.p99, stats.p999, stats.max);
+    fflush(stdout);
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_replay_json(const struct hg_replay *replay)
+{
+    struct hg_bench_json json;
+    struct hg_bench_stats stats;
+    const char *path = replay->opts->json_path;
+    FILE *fp = (strcmp(path, "-") == 0) ? stdout : fopen(path, "w");
+    unsigned int i;
+
+    HG_REPLAY_CHECK(fp == NULL, error, "could not open \"%s\"", path);
+
+    hg_bench_json_init(&json, fp);
+    hg_bench_json_object_begin(&json, NULL);
+    hg_bench_json_string(&json, "capture", replay->opts->capture_path);
+    hg_bench_json_string(&json, "info", replay->opts->info_string);
+    hg_bench_json_double(&json, "speed", replay->opts->speed);
+    hg_bench_json_uint(&json, "ops", replay->ops);
+    hg_bench_json_uint(&json, "skipped", replay->skipped);
+    hg_bench_json_uint(&json, "errors", replay->errors);
+    hg_bench_json_double(&json, "elapsed_s", replay->elapsed);
+    hg_bench_json_double(
+        &json, "lag_max_us", (double) replay->lag_max / 1000.0);
+    hg_bench_json_string(&json, "latency_unit", "us");
+    hg_bench_hist_stats(&replay->hist, 1000.0, &stats);
+    hg_bench_json_stats(&json, "latency", &stats);
+    hg_bench_json_array_begin(&json, "rpcs");
+    for (i = 0; i < replay->nrpcs; i++) {
+        const struct hg_replay_rpc *rpc = &replay->rpcs[i];
+
+        hg_bench_json_object_begin(&json, NULL);
+        hg_bench_json_uint(&json, "id", rpc->id);
+        hg_bench_json_uint(&json, "ops", rpc->ops);
+        hg_bench_json_uint(&json, "errors", rpc->errors);
+        hg_bench_hist_stats(&rpc->hist, 1000.0, &stats);
+        hg_bench_json_stats(&json, "latency", &stats);
+        hg_bench_json_object_end(&json);
+    }
+    hg_bench_json_array_end(&json);
+    hg_bench_json_object_end(&json);
+    if (fp != stdout)
+        fclose(fp);
+
+    return 0;
+
+error:
+    return -1;
+}
+
+/*---------------------------------------------------------------------------*/
+int
+main(int argc, char *argv[])
+{
+    struct hg_replay_opts opts;
+    struct hg_replay replay;
+    char addr_string[HG_REPLAY_ADDR_MAX] = {'\0'};
+    int rc = EXIT_FAILURE;
+
+    if (hg_replay_parse_opts(argc, argv, &opts) != 0)
+        return EXIT_FAILURE;
+
+    hg_time_fast_init();
+    memset(&replay, 0, sizeof(replay));
+
+    if (opts.addr_string)
+        strncpy(addr_string, opts.addr_string, sizeof(addr_string) - 1);
+    else {
+        FILE *fp = fopen(opts.addr_file, "r");
+
+        HG_REPLAY_CHECK(
+            fp == NULL, done, "could not open \"%s\"", opts.addr_file);
+        if (fgets(addr_string, sizeof(addr_string), fp) == NULL)
+            addr_string[0] = '\0';
+        fclose(fp);
+        addr_string[strcspn(addr_string, "\n")] = '\0';
+    }
+
+    if (hg_replay_parse_skip(&replay, opts.skip) != 0)
+        goto done;
+    if (hg_replay_load(&replay, opts.capture_path) != 0)
+        goto done;
+    if (hg_replay_init(&replay, &opts, addr_string) != 0)
+        goto done;
+    if (hg_replay_run(&replay) != 0)
+        goto done;
+
+    hg_replay_print(&replay);
+    if (opts.json_path && hg_replay_json(&replay) != 0)
+        goto done;
+
+    rc = EXIT_SUCCESS;
+
+done:
+    hg_replay_finalize(&replay);
+    return rc;
+}
@@ -0,0 +1,94 @@
+#------------------------------------------------------------------------------
+# Capture / replay test
+#------------------------------------------------------------------------------
+#
+# Captures the traffic of an in-process hg_bench run, then replays it with
+# hg_replay against an hg_bench server. The server runs concurrently with
+# the client side of this script (PHASE=client), which replays the capture
+# and stops the server. Captured shutdown requests must be skipped by the
+# replay, otherwise the server would be gone before the client side stops it.
+#
+# Variables:
+#   HG_BENCH   path to hg_bench
+#   HG_REPLAY  path to hg_replay
+#   INFO       NA info string
+#   WORK_DIR   directory of the capture, address and result files
+#
+
+set(capture_file "${WORK_DIR}/capture.bin")
+set(addr_file "${WORK_DIR}/addr.txt")
+set(json_file "${WORK_DIR}/replay.json")
+set(bench_args rpc-lat --info ${INFO} --sizes 8 --warmup 0)
+
+if(NOT PHASE STREQUAL "client")
+  file(MAKE_DIRECTORY ${WORK_DIR})
+  file(REMOVE ${capture_file} ${addr_file} ${json_file})
+
+  # Capture requests received by the in-process server, including shutdown
+  set(ENV{HG_CAPTURE_FILE} ${capture_file})
+  execute_process(COMMAND ${HG_BENCH} ${bench_args} --iterations 100
+    RESULT_VARIABLE bench_result
+    OUTPUT_QUIET
+  )
+  unset(ENV{HG_CAPTURE_FILE})
+  if(NOT bench_result EQUAL 0 OR NOT EXISTS ${capture_file})
+    message(FATAL_ERROR "Capture run failed (${bench_result})")
+  endif()
+
+  # Server output is piped to the client side and ignored
+  execute_process(
+    COMMAND ${HG_BENCH} ${bench_args} --mode server --addr-file ${addr_file}
+    COMMAND ${CMAKE_COMMAND} -DPHASE=client -DHG_BENCH=${HG_BENCH}
+      -DHG_REPLAY=${HG_REPLAY} -DINFO=${INFO} -DWORK_DIR=${WORK_DIR}
+      -P ${CMAKE_CURRENT_LIST_FILE}
+    RESULT_VARIABLE client_result
+  )
+  if(NOT client_result EQUAL 0)
+    message(FATAL_ERROR "Replay failed (${client_result})")
+  endif()
+  return()
+endif()
+
+# Wait for the server address
+set(addr_string "")
+foreach(i RANGE 100)
+  if(EXISTS ${addr_file})
+    file(READ ${addr_file} addr_string)
+  endif()
+  if(addr_string MATCHES "\n")
+    break()
+  endif()
+  execute_process(COMMAND ${CMAKE_COMMAND} -E sleep 0.1)
+endforeach()
+if(NOT addr_string MATCHES "\n")
+  message(FATAL_ERROR "Server did not start")
+endif()
+
+execute_process(
+  COMMAND ${HG_REPLAY} --info ${INFO} --addr-file ${addr_file} --speed 0
+    --json ${json_file} ${capture_file}
+  RESULT_VARIABLE replay_result
+)
+
+# Always stop the server
+execute_process(
+  COMMAND ${HG_BENCH} ${bench_args} --mode client --addr-file ${addr_file}
+    --iterations 1 --shutdown
+  RESULT_VARIABLE shutdown_result
+  OUTPUT_QUIET
+)
+
+if(NOT replay_result EQUAL 0 OR NOT EXISTS ${json_file})
+  message(FATAL_ERROR "hg_replay failed (${replay_result})")
+endif()
+if(NOT shutdown_result EQUAL 0)
+  message(FATAL_ERROR "Server did not survive replay (${shutdown_result})")
+endif()
+
+# All 100 RPCs replayed without errors, shutdown request skipped
+file(READ ${json_file} json)
+if(NOT json MATCHES "\"ops\": 100,"
+    OR NOT json MATCHES "\"skipped\": 1,"
+    OR NOT json MATCHES "\"errors\": 0,")
+  message(FATAL_ERROR "Unexpected replay results:\n${json}")
+endif()
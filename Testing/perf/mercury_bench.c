@@ -0,0 +1,511 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#include "mercury_bench.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <math.h>
+#include <string.h>
+
+/****************/
+/* Local Macros */
+/****************/
+
+#define HG_BENCH_JSON_INDENT 2
+
+/********************/
+/* Local Prototypes */
+/********************/
+
+/**
+ * Midpoint of bucket.
+ */
+static double
+hg_bench_hist_bucket_value(unsigned int index);
+
+/**
+ * Parse one value with optional suffix.
+ */
+static const char *
+hg_bench_parse_value(const char *str, size_t *value);
+
+/**
+ * Write separator / indentation and key before a new element.
+ */
+static void
+hg_bench_json_key(struct hg_bench_json *json, const char *key);
+
+/**
+ * Find entry of key.
+ */
+static struct hg_bench_baseline_entry *
+hg_bench_baseline_find(struct hg_bench_baseline *baseline, const char *key);
+
+/**
+ * Median of measured values.
+ */
+static double
+hg_bench_baseline_median(const struct hg_bench_baseline_entry *entry);
+
+/*---------------------------------------------------------------------------*/
+void
+hg_bench_hist_reset(struct hg_bench_hist *hist)
+{
+    memset(hist, 0, sizeof(*hist));
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_bench_hist_merge(struct hg_bench_hist *dst, const struct hg_bench_hist *src)
+{
+    unsigned int i;
+
+    if (src->count == 0)
+        return;
+
+    for (i = 0; i < HG_BENCH_HIST_BUCKETS; i++)
+        dst->buckets[i] += src->buckets[i];
+
+    if (dst->count == 0 || src->min < dst->min)
+        dst->min = src->min;
+    if (src->max > dst->max)
+        dst->max = src->max;
+    dst->sum += src->sum;
+    dst->count += src->count;
+}
+
+/*---------------------------------------------------------------------------*/
+static double
+hg_bench_hist_bucket_value(unsigned int index)
+{
+    unsigned int shift;
+    hg_util_uint64_t low;
+
+    if (index < HG_BENCH_HIST_SUB_COUNT)
+        return (double) index;
+
+    shift = index / HG_BENCH_HIST_SUB_COUNT - 1;
+    low = (hg_util_uint64_t)(HG_BENCH_HIST_SUB_COUNT +
+                             index % HG_BENCH_HIST_SUB_COUNT)
+          << shift;
+
+    return (double) low + (double) (((hg_util_uint64_t) 1 << shift) - 1) / 2.0;
+}
+
+/*---------------------------------------------------------------------------*/
+double
+hg_bench_hist_percentile(const struct hg_bench_hist *hist, double percentile)
+{
+    hg_util_uint64_t target, total = 0;
+    double value = 0;
+    unsigned int i;
+
+    if (hist->count == 0)
+        return 0;
+
+    /* Rank of the value at percentile (1-based) */
+    target = (hg_util_uint64_t) ceil(percentile / 100.0 * (double) hist->count);
+    if (target == 0)
+        target = 1;
+
+    for (i = 0; i < HG_BENCH_HIST_BUCKETS; i++) {
+        total += hist->buckets[i];
+        if (total >= target) {
+            value = hg_bench_hist_bucket_value(i);
+            break;
+        }
+    }
+
+    if (value < (double) hist->min)
+        value = (double) hist->min;
+    if (value > (double) hist->max)
+        value = (double) hist->max;
+
+    return value;
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_bench_hist_stats(const struct hg_bench_hist *hist, double scale,
+    struct hg_bench_stats *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    stats->count = hist->count;
+    if (hist->count == 0)
+        return;
+
+    stats->min = (double) hist->min / scale;
+    stats->mean = hist->sum / (double) hist->count / scale;
+    stats->p50 = hg_bench_hist_percentile(hist, 50.0) / scale;
+    stats->p90 = hg_bench_hist_percentile(hist, 90.0) / scale;
+    stats->p99 = hg_bench_hist_percentile(hist, 99.0) / scale;
+    stats->p999 = hg_bench_hist_percentile(hist, 99.9) / scale;
+    stats->max = (double) hist->max / scale;
+}
+
+/*---------------------------------------------------------------------------*/
+static const char *
+hg_bench_parse_value(const char *str, size_t *value)
+{
+    char *end = NULL;
+    unsigned long long val;
+
+    if (!isdigit((unsigned char) *str))
+        return NULL;
+
+    val = strtoull(str, &end, 0);
+    switch (tolower((unsigned char) *end)) {
+        case 'g':
+            val <<= 10;
+            /* FALLTHRU */
+        case 'm':
+            val <<= 10;
+            /* FALLTHRU */
+        case 'k':
+            val <<= 10;
+            end++;
+            break;
+        default:
+            break;
+    }
+    *value = (size_t) val;
+
+    return end;
+}
+
+/*---------------------------------------------------------------------------*/
+unsigned int
+hg_bench_parse_list(const char *str, size_t *values, unsigned int max_values)
+{
+    unsigned int count = 0;
+
+    while (*str) {
+        size_t first, last;
+
+        str = hg_bench_parse_value(str, &first);
+        if (str == NULL)
+            return 0;
+        last = first;
+
+        if (*str == '-') {
+            str = hg_bench_parse_value(str + 1, &last);
+            if (str == NULL || last < first)
+                return 0;
+        }
+
+        /* Expand range by powers of two (a 0 start value is kept as is) */
+        for (;;) {
+            if (count == max_values)
+                return 0;
+            values[count++] = first;
+            if (first >= last)
+                break;
+            first = (first == 0) ? 1 : first * 2;
+            if (first > last)
+                break;
+        }
+
+        if (*str == ',')
+            str++;
+        else if (*str != '\0')
+            return 0;
+    }
+
+    return count;
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_bench_json_init(struct hg_bench_json *json, FILE *fp)
+{
+    json->fp = fp;
+    json->depth = 0;
+    json->first[0] = 1;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_bench_json_key(struct hg_bench_json *json, const char *key)
+{
+    if (json->depth > 0) {
+        fprintf(json->fp, "%s\n%*s", json->first[json->depth] ? "" : ",",
+            json->depth * HG_BENCH_JSON_INDENT, "");
+        json->first[json->depth] = 0;
+    }
+    if (key)
+        fprintf(json->fp, "\"%s\": ", key);
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_bench_json_object_begin(struct hg_bench_json *json, const char *key)
+{
+    hg_bench_json_key(json, key);
+    fputc('{', json->fp);
+    if (json->depth < HG_BENCH_JSON_MAX_DEPTH - 1)
+        json->first[++json->depth] = 1;
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_bench_json_object_end(struct hg_bench_json *json)
+{
+    json->depth--;
+    fprintf(json->fp, "\n%*s}", json->depth * HG_BENCH_JSON_INDENT, "");
+    if (json->depth == 0)
+        fputc('\n', json->fp);
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_bench_json_array_begin(struct hg_bench_json *json, const char *key)
+{
+    hg_bench_json_key(json, key);
+    fputc('[', json->fp);
+    if (json->depth < HG_BENCH_JSON_MAX_DEPTH - 1)
+        json->first[++json->depth] = 1;
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_bench_json_array_end(struct hg_bench_json *json)
+{
+    json->depth--;
+    fprintf(json->fp, "\n%*s]", json->depth * HG_BENCH_JSON_INDENT, "");
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_bench_json_string(
+    struct hg_bench_json *json, const char *key, const char *value)
+{
+    const char *ptr;
+
+    hg_bench_json_key(json, key);
+    fputc('"', json->fp);
+    for (ptr = value; *ptr; ptr++) {
+        if (*ptr == '"' || *ptr == '\\')
+            fputc('\\', json->fp);
+        fputc(*ptr, json->fp);
+    }
+    fputc('"', json->fp);
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_bench_json_uint(
+    struct hg_bench_json *json, const char *key, hg_util_uint64_t value)
+{
+    hg_bench_json_key(json, key);
+    fprintf(json->fp, "%llu", (unsigned long long) value);
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_bench_json_double(struct hg_bench_json *json, const char *key, double value)
+{
+    hg_bench_json_key(json, key);
+    fprintf(json->fp, "%.6g", value);
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_bench_json_stats(struct hg_bench_json *json, const char *key,
+    const struct hg_bench_stats *stats)
+{
+    hg_bench_json_object_begin(json, key);
+    hg_bench_json_uint(json, "count", stats->count);
+    hg_bench_json_double(json, "min", stats->min);
+    hg_bench_json_double(json, "mean", stats->mean);
+    hg_bench_json_double(json, "p50", stats->p50);
+    hg_bench_json_double(json, "p90", stats->p90);
+    hg_bench_json_double(json, "p99", stats->p99);
+    hg_bench_json_double(json, "p99.9", stats->p999);
+    hg_bench_json_double(json, "max", stats->max);
+    hg_bench_json_object_end(json);
+}
+
+/*---------------------------------------------------------------------------*/
+int
+hg_bench_baseline_init(struct hg_bench_baseline *baseline, const char *path,
+    double tolerance, int update)
+{
+    char line[HG_BENCH_BASELINE_KEY_MAX + 64];
+    FILE *fp;
+
+    memset(baseline, 0, sizeof(*baseline));
+    baseline->path = path;
+    baseline->tolerance = tolerance;
+    baseline->update = update;
+
+    fp = fopen(path, "r");
+    if (fp == NULL) {
+        if (errno == ENOENT && update)
+            return 0;
+        fprintf(stderr, "No baseline \"%s\" (%s)\n", path, strerror(errno));
+        return (errno == ENOENT) ? HG_BENCH_SKIP : -1;
+    }
+
+    while (fgets(line, (int) sizeof(line), fp) != NULL) {
+        struct hg_bench_baseline_entry *entry;
+        char key[HG_BENCH_BASELINE_KEY_MAX];
+        double value, entry_tolerance = -1.0;
+        int n;
+
+        if (line[0] == '#' || line[0] == '\n')
+            continue;
+        /* Width must be HG_BENCH_BASELINE_KEY_MAX - 1 */
+        n = sscanf(line, "%127s %lf %lf", key, &value, &entry_tolerance);
+        if (n < 2 || (n == 3 && entry_tolerance < 0) ||
+            baseline->count == HG_BENCH_BASELINE_MAX) {
+            fprintf(stderr, "Invalid baseline \"%s\"\n", path);
+            fclose(fp);
+            return -1;
+        }
+        entry = &baseline->entries[baseline->count++];
+        strcpy(entry->key, key);
+        entry->value = value;
+        entry->tolerance = (n == 3) ? entry_tolerance / 100.0 : -1.0;
+        entry->has_value = 1;
+    }
+    fclose(fp);
+
+    return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+static struct hg_bench_baseline_entry *
+hg_bench_baseline_find(struct hg_bench_baseline *baseline, const char *key)
+{
+    unsigned int i;
+
+    for (i = 0; i < baseline->count; i++)
+        if (strcmp(baseline->entries[i].key, key) == 0)
+            return &baseline->entries[i];
+
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_bench_baseline_check(struct hg_bench_baseline *baseline, const char *key,
+    double value, int higher_is_better)
+{
+    struct hg_bench_baseline_entry *entry =
+        hg_bench_baseline_find(baseline, key);
+
+    if (entry == NULL) {
+        if (baseline->count == HG_BENCH_BASELINE_MAX ||
+            strlen(key) >= HG_BENCH_BASELINE_KEY_MAX) {
+            fprintf(stderr, "Too many metrics, ignoring \"%s\"\n", key);
+            return;
+        }
+        entry = &baseline->entries[baseline->count++];
+        memset(entry, 0, sizeof(*entry));
+        strcpy(entry->key, key);
+        entry->tolerance = -1.0;
+    }
+
+    if (entry->runs == HG_BENCH_BASELINE_RUNS) {
+        fprintf(stderr, "Too many runs, ignoring \"%s\" value\n", key);
+        return;
+    }
+    entry->samples[entry->runs++] = value;
+    entry->higher_is_better = higher_is_better;
+}
+
+/*---------------------------------------------------------------------------*/
+static double
+hg_bench_baseline_median(const struct hg_bench_baseline_entry *entry)
+{
+    double samples[HG_BENCH_BASELINE_RUNS];
+    unsigned int i, j;
+
+    /* Insertion sort, there are only a few runs */
+    for (i = 0; i < entry->runs; i++) {
+        double value = entry->samples[i];
+
+        for (j = i; j > 0 && samples[j - 1] > value; j--)
+            samples[j] = samples[j - 1];
+        samples[j] = value;
+    }
+
+    return (entry->runs % 2)
+               ? samples[entry->runs / 2]
+               : (samples[entry->runs / 2 - 1] + samples[entry->runs / 2]) / 2;
+}
+
+/*---------------------------------------------------------------------------*/
+int
+hg_bench_baseline_finalize(struct hg_bench_baseline *baseline)
+{
+    unsigned int regressions = 0, i;
+    FILE *fp;
+
+    if (baseline->update) {
+        fp = fopen(baseline->path, "w");
+        if (fp == NULL) {
+            fprintf(stderr, "Could not write \"%s\" (%s)\n", baseline->path,
+                strerror(errno));
+            return -1;
+        }
+        fprintf(fp, "# Mercury benchmark baseline, "
+                    "<metric> <value> [<tolerance in %%>]\n");
+        for (i = 0; i < baseline->count; i++) {
+            const struct hg_bench_baseline_entry *entry =
+                &baseline->entries[i];
+
+            fprintf(fp, "%s %.6g", entry->key,
+                entry->runs > 0 ? hg_bench_baseline_median(entry)
+                                : entry->value);
+            /* Keep tolerances that were tuned by hand */
+            if (entry->tolerance >= 0)
+                fprintf(fp, " %.6g", entry->tolerance * 100.0);
+            fprintf(fp, "\n");
+        }
+        fclose(fp);
+
+        return 0;
+    }
+
+    for (i = 0; i < baseline->count; i++) {
+        const struct hg_bench_baseline_entry *entry = &baseline->entries[i];
+        double measured, tolerance, change;
+        int regressed;
+
+        if (entry->runs == 0)
+            continue;
+        measured = hg_bench_baseline_median(entry);
+        /* New metrics do not fail the check until the baseline is refreshed */
+        if (!entry->has_value) {
+            fprintf(stderr, "%s: %g (no baseline)\n", entry->key, measured);
+            continue;
+        }
+
+        tolerance =
+            (entry->tolerance >= 0) ? entry->tolerance : baseline->tolerance;
+        change =
+            (entry->value != 0) ? (measured - entry->value) / entry->value : 0;
+        regressed = entry->higher_is_better ? (change < -tolerance)
+                                            : (change > tolerance);
+        fprintf(stderr,
+            "%s: %g, median of %u (baseline %g, %+.1f%%, max %.0f%%)%s\n",
+            entry->key, measured, entry->runs, entry->value, change * 100.0,
+            tolerance * 100.0, regressed ? " REGRESSION" : "");
+        if (regressed)
+            regressions++;
+    }
+    if (regressions > 0)
+        fprintf(stderr, "%u value(s) regressed by more than their tolerance\n",
+            regressions);
+
+    return (regressions > 0) ? -1 : 0;
+}
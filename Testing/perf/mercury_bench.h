@@ -0,0 +1,280 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#ifndef MERCURY_BENCH_H
+#define MERCURY_BENCH_H
+
+#include "mercury_util_config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/*************************************/
+/* Public Type and Struct Definition */
+/*************************************/
+
+/*
+ * Log-linear histogram (HDR style): values below HG_BENCH_HIST_SUB_COUNT are
+ * exact, larger values fall into HG_BENCH_HIST_SUB_COUNT linear buckets per
+ * power of two, which bounds the relative error to 1 / HG_BENCH_HIST_SUB_COUNT.
+ */
+#define HG_BENCH_HIST_SUB_BITS  7
+#define HG_BENCH_HIST_SUB_COUNT (1 << HG_BENCH_HIST_SUB_BITS)
+#define HG_BENCH_HIST_MAX_BITS  48 /* Values are clamped to 2^48 - 1 */
+#define HG_BENCH_HIST_BUCKETS                                                  \
+    ((HG_BENCH_HIST_MAX_BITS - HG_BENCH_HIST_SUB_BITS + 1) *                   \
+        HG_BENCH_HIST_SUB_COUNT)
+
+struct hg_bench_hist {
+    hg_util_uint64_t count; /* Number of recorded values */
+    hg_util_uint64_t min;   /* Min value */
+    hg_util_uint64_t max;   /* Max value */
+    double sum;             /* Sum of values */
+    hg_util_uint64_t buckets[HG_BENCH_HIST_BUCKETS];
+};
+
+/* Summary of a histogram */
+struct hg_bench_stats {
+    hg_util_uint64_t count;
+    double min, mean, p50, p90, p99, p999, max;
+};
+
+/* Minimal streaming JSON writer */
+#define HG_BENCH_JSON_MAX_DEPTH 16
+
+struct hg_bench_json {
+    FILE *fp;                             /* Output stream */
+    int depth;                            /* Current nesting depth */
+    int first[HG_BENCH_JSON_MAX_DEPTH];   /* No element written yet */
+};
+
+/*
+ * Baseline of metrics used as a regression gate. A baseline file has one
+ * "<key> <value> [<tolerance>]" line per metric, where the optional tolerance
+ * (in %) overrides the global one for noisier metrics. Lines starting with
+ * '#' are ignored.
+ */
+#define HG_BENCH_BASELINE_MAX     256
+#define HG_BENCH_BASELINE_KEY_MAX 128
+#define HG_BENCH_BASELINE_RUNS    32 /* Max samples kept per metric */
+
+/* Exit code of a gated benchmark that has no baseline (CTest skip code) */
+#define HG_BENCH_SKIP 77
+
+struct hg_bench_baseline_entry {
+    char key[HG_BENCH_BASELINE_KEY_MAX];
+    double value;         /* Baseline value */
+    double tolerance;     /* Allowed relative regression, < 0 if global */
+    double samples[HG_BENCH_BASELINE_RUNS]; /* Measured values */
+    unsigned int runs;    /* Number of samples */
+    int has_value;        /* Entry was loaded from the baseline file */
+    int higher_is_better; /* Direction of the metric */
+};
+
+struct hg_bench_baseline {
+    const char *path;   /* Baseline file */
+    double tolerance;   /* Allowed relative regression (e.g., 0.2) */
+    int update;         /* Record values instead of checking them */
+    unsigned int count; /* Number of entries */
+    struct hg_bench_baseline_entry entries[HG_BENCH_BASELINE_MAX];
+};
+
+/*********************/
+/* Public Prototypes */
+/*********************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Reset histogram.
+ *
+ * \param hist [IN/OUT]         pointer to histogram
+ */
+void
+hg_bench_hist_reset(struct hg_bench_hist *hist);
+
+/**
+ * Record a value.
+ *
+ * \param hist [IN/OUT]         pointer to histogram
+ * \param value [IN]            value (e.g., latency in ns)
+ */
+static HG_UTIL_INLINE void
+hg_bench_hist_record(struct hg_bench_hist *hist, hg_util_uint64_t value);
+
+/**
+ * Add values of src to dst.
+ *
+ * \param dst [IN/OUT]          pointer to histogram
+ * \param src [IN]              pointer to histogram
+ */
+void
+hg_bench_hist_merge(struct hg_bench_hist *dst, const struct hg_bench_hist *src);
+
+/**
+ * Get value at percentile.
+ *
+ * \param hist [IN]             pointer to histogram
+ * \param percentile [IN]       percentile (0 to 100)
+ *
+ * \return Value (midpoint of the matching bucket, within [min, max])
+ */
+double
+hg_bench_hist_percentile(const struct hg_bench_hist *hist, double percentile);
+
+/**
+ * Summarize histogram, values are divided by scale (e.g., 1000 for ns to us).
+ *
+ * \param hist [IN]             pointer to histogram
+ * \param scale [IN]            divisor
+ * \param stats [OUT]           pointer to summary
+ */
+void
+hg_bench_hist_stats(const struct hg_bench_hist *hist, double scale,
+    struct hg_bench_stats *stats);
+
+/**
+ * Parse a list of sizes / counts. Elements are separated by ',' and accept
+ * k/m/g suffixes (powers of 1024). A range "a-b" expands to the powers of two
+ * times a up to b.
+ *
+ * \param str [IN]              string to parse
+ * \param values [OUT]          array of values
+ * \param max_values [IN]       max number of values
+ *
+ * \return Number of values or 0 on parsing error
+ */
+unsigned int
+hg_bench_parse_list(
+    const char *str, size_t *values, unsigned int max_values);
+
+/**
+ * Start JSON output on stream fp.
+ */
+void
+hg_bench_json_init(struct hg_bench_json *json, FILE *fp);
+
+/**
+ * Open object / array. key is NULL within arrays.
+ */
+void
+hg_bench_json_object_begin(struct hg_bench_json *json, const char *key);
+void
+hg_bench_json_object_end(struct hg_bench_json *json);
+void
+hg_bench_json_array_begin(struct hg_bench_json *json, const char *key);
+void
+hg_bench_json_array_end(struct hg_bench_json *json);
+
+/**
+ * Write key / value pairs.
+ */
+void
+hg_bench_json_string(
+    struct hg_bench_json *json, const char *key, const char *value);
+void
+hg_bench_json_uint(
+    struct hg_bench_json *json, const char *key, hg_util_uint64_t value);
+void
+hg_bench_json_double(struct hg_bench_json *json, const char *key, double value);
+
+/**
+ * Write summary of histogram as an object.
+ */
+void
+hg_bench_json_stats(struct hg_bench_json *json, const char *key,
+    const struct hg_bench_stats *stats);
+
+/**
+ * Load baseline from path. In update mode, a missing file is not an error
+ * and values passed to hg_bench_baseline_check() replace existing ones.
+ *
+ * \param baseline [OUT]        pointer to baseline
+ * \param path [IN]             baseline file
+ * \param tolerance [IN]        allowed relative regression
+ * \param update [IN]           update baseline instead of checking it
+ *
+ * \return 0 on success, HG_BENCH_SKIP if there is no baseline to check
+ * against, -1 on error
+ */
+int
+hg_bench_baseline_init(struct hg_bench_baseline *baseline, const char *path,
+    double tolerance, int update);
+
+/**
+ * Record measured value of a metric. When a metric is measured several times,
+ * the median of the runs is compared to the baseline, which filters out
+ * outliers in both directions.
+ *
+ * \param baseline [IN/OUT]     pointer to baseline
+ * \param key [IN]              metric name
+ * \param value [IN]            measured value
+ * \param higher_is_better [IN] direction of the metric (rate vs latency)
+ */
+void
+hg_bench_baseline_check(struct hg_bench_baseline *baseline, const char *key,
+    double value, int higher_is_better);
+
+/**
+ * Compare measured values to the baseline and report them on stderr, or
+ * write the baseline file in update mode.
+ *
+ * \param baseline [IN]         pointer to baseline
+ *
+ * \return 0 on success, -1 on error or if any value regressed by more than
+ * the tolerance
+ */
+int
+hg_bench_baseline_finalize(struct hg_bench_baseline *baseline);
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE void
+hg_bench_hist_record(struct hg_bench_hist *hist, hg_util_uint64_t value)
+{
+    unsigned int index;
+
+    if (value >= ((hg_util_uint64_t) 1 << HG_BENCH_HIST_MAX_BITS))
+        value = ((hg_util_uint64_t) 1 << HG_BENCH_HIST_MAX_BITS) - 1;
+
+    if (value < HG_BENCH_HIST_SUB_COUNT)
+        index = (unsigned int) value;
+    else {
+        unsigned int msb;
+        unsigned int shift;
+
+#if defined(__GNUC__)
+        msb = 63 - (unsigned int) __builtin_clzll(value);
+#else
+        for (msb = HG_BENCH_HIST_SUB_BITS; (value >> (msb + 1)) != 0; msb++)
+            continue;
+#endif
+        shift = msb - HG_BENCH_HIST_SUB_BITS;
+
+        index = (shift + 1) * HG_BENCH_HIST_SUB_COUNT +
+                (unsigned int) ((value >> shift) &
+                                (HG_BENCH_HIST_SUB_COUNT - 1));
+    }
+    hist->buckets[index]++;
+
+    if (hist->count == 0 || value < hist->min)
+        hist->min = value;
+    if (value > hist->max)
+        hist->max = value;
+    hist->sum += (double) value;
+    hist->count++;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MERCURY_BENCH_H */
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#include "mercury_test.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/********************/
+/* Local Prototypes */
+/********************/
+
+/* Defined in test_coro_task.cpp */
+hg_return_t
+hg_test_coro_rpc(hg_context_t *context, hg_addr_t addr, hg_id_t rpc_id);
+hg_return_t
+hg_test_coro_detach(hg_context_t *context, hg_addr_t addr, hg_id_t rpc_id);
+
+/*******************/
+/* Local Variables */
+/*******************/
+
+extern hg_id_t hg_test_rpc_open_id_g;
+
+/*---------------------------------------------------------------------------*/
+int
+main(int argc, char *argv[])
+{
+    struct hg_test_info hg_test_info = {0};
+    hg_return_t hg_ret;
+    int ret = EXIT_SUCCESS;
+
+    /* Initialize the interface */
+    hg_ret = HG_Test_init(argc, argv, &hg_test_info);
+    HG_TEST_CHECK_ERROR(
+        hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE, "HG_Test_init() failed");
+
+    /* co_await forward test */
+    HG_TEST("coroutine RPC");
+    hg_ret = hg_test_coro_rpc(hg_test_info.context, hg_test_info.target_addr,
+        hg_test_rpc_open_id_g);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+        "coroutine RPC test failed (%s)", HG_Error_to_string(hg_ret));
+    HG_PASSED();
+
+    /* Task destroyed before its forward completes */
+    HG_TEST("detached coroutine RPC");
+    hg_ret = hg_test_coro_detach(hg_test_info.context,
+        hg_test_info.target_addr, hg_test_rpc_open_id_g);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+        "detached coroutine RPC test failed (%s)", HG_Error_to_string(hg_ret));
+    HG_PASSED();
+
+done:
+    if (ret != EXIT_SUCCESS)
+        HG_FAILED();
+
+    hg_ret = HG_Test_finalize(&hg_test_info);
+    HG_TEST_CHECK_ERROR_DONE(hg_ret != HG_SUCCESS, "HG_Test_finalize() failed");
+
+    return ret;
+}
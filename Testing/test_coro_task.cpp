@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+/*
+ * Coroutines used by test_coro.c, kept in a separate C++ file since the
+ * test framework headers are C only.
+ */
+
+#include "mercury_coro.hpp"
+
+#include "mercury_test_config.h"
+#include "test_rpc.h"
+
+/****************/
+/* Local Macros */
+/****************/
+
+#define RPC_OPEN_COOKIE 100
+
+/* Max number of progress calls before giving up */
+#define MAX_PROGRESS 1000
+
+/********************/
+/* Local Prototypes */
+/********************/
+
+extern "C" {
+hg_return_t
+hg_test_coro_rpc(hg_context_t *context, hg_addr_t addr, hg_id_t rpc_id);
+hg_return_t
+hg_test_coro_detach(hg_context_t *context, hg_addr_t addr, hg_id_t rpc_id);
+}
+
+static hg::task
+hg_test_coro_forward(hg_handle_t handle);
+
+/*******************/
+/* Local Variables */
+/*******************/
+
+/* Number of tasks resumed after their forward completed */
+static int hg_test_coro_resumed_g = 0;
+
+/*---------------------------------------------------------------------------*/
+static hg::task
+hg_test_coro_forward(hg_handle_t handle)
+{
+    hg_const_string_t rpc_open_path = HG_TEST_TEMP_DIRECTORY "/test.h5";
+    rpc_open_in_t in_struct;
+    rpc_open_out_t out_struct;
+    hg_return_t ret;
+
+    in_struct.path = rpc_open_path;
+    in_struct.handle.cookie = RPC_OPEN_COOKIE;
+
+    ret = co_await hg::forward(handle, &in_struct);
+
+    /* Frame must remain valid even if the task was destroyed meanwhile */
+    hg_test_coro_resumed_g++;
+    if (ret != HG_SUCCESS)
+        co_return ret;
+
+    ret = HG_Get_output(handle, &out_struct);
+    if (ret != HG_SUCCESS)
+        co_return ret;
+    if (out_struct.event_id != RPC_OPEN_COOKIE)
+        ret = HG_FAULT;
+    (void) HG_Free_output(handle, &out_struct);
+
+    co_return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+hg_test_coro_rpc(hg_context_t *context, hg_addr_t addr, hg_id_t rpc_id)
+{
+    hg::executor executor(context);
+    hg_handle_t handle = HG_HANDLE_NULL;
+    hg_return_t ret;
+
+    ret = HG_Create(context, addr, rpc_id, &handle);
+    if (ret != HG_SUCCESS)
+        return ret;
+
+    {
+        hg::task task = hg_test_coro_forward(handle);
+
+        /* Forward was posted, callback cannot run before next trigger */
+        if (task.done() || task.result() != HG_BUSY)
+            ret = HG_FAULT;
+        else
+            ret = executor.run(task);
+    }
+
+    (void) HG_Destroy(handle);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+hg_test_coro_detach(hg_context_t *context, hg_addr_t addr, hg_id_t rpc_id)
+{
+    hg::executor executor(context);
+    hg_handle_t handle = HG_HANDLE_NULL;
+    hg_return_t ret;
+    int i;
+
+    ret = HG_Create(context, addr, rpc_id, &handle);
+    if (ret != HG_SUCCESS)
+        return ret;
+
+    /* Task is destroyed while its forward is in flight */
+    hg_test_coro_resumed_g = 0;
+    (void) hg_test_coro_forward(handle);
+
+    for (i = 0; i < MAX_PROGRESS && hg_test_coro_resumed_g == 0; i++) {
+        ret = executor.run_once();
+        if (ret != HG_SUCCESS)
+            break;
+    }
+    if (ret == HG_SUCCESS && hg_test_coro_resumed_g == 0)
+        ret = HG_TIMEOUT;
+
+    (void) HG_Destroy(handle);
+
+    return ret;
+}
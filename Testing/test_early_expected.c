@@ -0,0 +1,328 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#include "mercury_test.h"
+#ifdef NA_HAS_SM
+#    include "na_sm.h"
+#endif
+
+#include "mercury_time.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/****************/
+/* Local Macros */
+/****************/
+
+/* Tag used by the expected messages */
+#define NA_TEST_EARLY_TAG 42
+
+/* Expected messages sent past the early queue bound (more than the number
+ * of copy buffers so that the sender is held back) */
+#define NA_TEST_EARLY_EXTRA 256
+
+/* Max time to wait for all the messages (ms) */
+#define NA_TEST_EARLY_TIMEOUT 10000
+
+/************************************/
+/* Local Type and Struct Definition */
+/************************************/
+
+struct na_test_early_info {
+    unsigned int completed; /* Number of completed operations */
+    unsigned int failed;    /* Number of failed operations */
+    na_addr_t source;       /* Source of unexpected msg */
+};
+
+/********************/
+/* Local Prototypes */
+/********************/
+
+#ifdef NA_HAS_SM
+static int
+na_test_early_cb(const struct na_cb_info *callback_info);
+
+static na_return_t
+na_test_early_wait(na_class_t *na_class, na_context_t *context,
+    struct na_test_early_info *info, unsigned int count);
+
+static na_return_t
+na_test_early_run(na_class_t *na_class, na_context_t *context);
+
+/*---------------------------------------------------------------------------*/
+static int
+na_test_early_cb(const struct na_cb_info *callback_info)
+{
+    struct na_test_early_info *info =
+        (struct na_test_early_info *) callback_info->arg;
+
+    if (callback_info->ret != NA_SUCCESS)
+        info->failed++;
+    else if (callback_info->type == NA_CB_RECV_UNEXPECTED)
+        info->source = callback_info->info.recv_unexpected.source;
+    info->completed++;
+
+    return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_test_early_wait(na_class_t *na_class, na_context_t *context,
+    struct na_test_early_info *info, unsigned int count)
+{
+    hg_time_t deadline, now;
+    na_return_t ret = NA_SUCCESS;
+
+    hg_time_get_current_ms(&now);
+    deadline = hg_time_add(
+        now, hg_time_from_double(NA_TEST_EARLY_TIMEOUT / 1000.0));
+
+    while (info->completed < count) {
+        unsigned int actual_count = 0;
+
+        do {
+            ret = NA_Trigger(context, 0, 1, NULL, &actual_count);
+        } while (ret == NA_SUCCESS && actual_count);
+        HG_TEST_CHECK_ERROR(ret != NA_SUCCESS && ret != NA_TIMEOUT, done, ret,
+            ret, "NA_Trigger() failed (%s)", NA_Error_to_string(ret));
+        ret = NA_SUCCESS;
+
+        if (info->completed >= count)
+            break;
+
+        hg_time_get_current_ms(&now);
+        HG_TEST_CHECK_ERROR(hg_time_less(deadline, now), done, ret, NA_TIMEOUT,
+            "Timed out (%u/%u operations completed)", info->completed, count);
+
+        ret = NA_Progress(na_class, context, 100);
+        HG_TEST_CHECK_ERROR(ret != NA_SUCCESS && ret != NA_TIMEOUT, done, ret,
+            ret, "NA_Progress() failed (%s)", NA_Error_to_string(ret));
+        ret = NA_SUCCESS;
+    }
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static na_return_t
+na_test_early_run(na_class_t *na_class, na_context_t *context)
+{
+    struct na_test_early_info send_info = {0, 0, NA_ADDR_NULL},
+                              recv_info = {0, 0, NA_ADDR_NULL};
+    struct na_sm_stats stats;
+    na_addr_t self_addr = NA_ADDR_NULL, target_addr = NA_ADDR_NULL;
+    char addr_string[256];
+    na_size_t addr_string_len = sizeof(addr_string);
+    na_op_id_t *send_op_ids = NULL, *recv_op_ids = NULL;
+    na_op_id_t unexpected_send_op_id = NA_OP_ID_NULL,
+               unexpected_recv_op_id = NA_OP_ID_NULL;
+    na_uint32_t *send_bufs = NULL, *recv_bufs = NULL, unexpected_buf = 0;
+    unsigned int count = 0, i;
+    hg_time_t deadline, now;
+    na_return_t ret;
+
+    HG_TEST("early expected msgs past the queue bound");
+
+    /* Connect to ourself */
+    ret = NA_Addr_self(na_class, &self_addr);
+    HG_TEST_CHECK_ERROR(ret != NA_SUCCESS, done, ret, ret,
+        "NA_Addr_self() failed (%s)", NA_Error_to_string(ret));
+    ret = NA_Addr_to_string(na_class, addr_string, &addr_string_len, self_addr);
+    HG_TEST_CHECK_ERROR(ret != NA_SUCCESS, done, ret, ret,
+        "NA_Addr_to_string() failed (%s)", NA_Error_to_string(ret));
+    ret = NA_Addr_lookup(na_class, addr_string, &target_addr);
+    HG_TEST_CHECK_ERROR(ret != NA_SUCCESS, done, ret, ret,
+        "NA_Addr_lookup() failed (%s)", NA_Error_to_string(ret));
+
+    /* Expected recvs must be posted for the source of the unexpected msg */
+    unexpected_recv_op_id = NA_Op_create(na_class);
+    ret = NA_Msg_recv_unexpected(na_class, context, na_test_early_cb,
+        &recv_info, &unexpected_buf, sizeof(unexpected_buf), NULL,
+        &unexpected_recv_op_id);
+    HG_TEST_CHECK_ERROR(ret != NA_SUCCESS, done, ret, ret,
+        "NA_Msg_recv_unexpected() failed (%s)", NA_Error_to_string(ret));
+    unexpected_send_op_id = NA_Op_create(na_class);
+    ret = NA_Msg_send_unexpected(na_class, context, na_test_early_cb,
+        &send_info, &unexpected_buf, sizeof(unexpected_buf), NULL, target_addr,
+        0, 0, &unexpected_send_op_id);
+    HG_TEST_CHECK_ERROR(ret != NA_SUCCESS, done, ret, ret,
+        "NA_Msg_send_unexpected() failed (%s)", NA_Error_to_string(ret));
+    ret = na_test_early_wait(na_class, context, &recv_info, 1);
+    HG_TEST_CHECK_ERROR(ret != NA_SUCCESS, done, ret, ret,
+        "Could not receive unexpected msg");
+    ret = na_test_early_wait(na_class, context, &send_info, 1);
+    HG_TEST_CHECK_ERROR(ret != NA_SUCCESS, done, ret, ret,
+        "Could not send unexpected msg");
+    HG_TEST_CHECK_ERROR(recv_info.failed || recv_info.source == NA_ADDR_NULL,
+        done, ret, NA_PROTOCOL_ERROR, "Unexpected msg has no source");
+
+    ret = NA_SM_Get_stats(na_class, &stats);
+    HG_TEST_CHECK_ERROR(ret != NA_SUCCESS, done, ret, ret,
+        "NA_SM_Get_stats() failed (%s)", NA_Error_to_string(ret));
+    count = (unsigned int) stats.early_expected_max + NA_TEST_EARLY_EXTRA;
+
+    send_op_ids = (na_op_id_t *) calloc(count, sizeof(na_op_id_t));
+    recv_op_ids = (na_op_id_t *) calloc(count, sizeof(na_op_id_t));
+    send_bufs = (na_uint32_t *) malloc(count * sizeof(na_uint32_t));
+    recv_bufs = (na_uint32_t *) malloc(count * sizeof(na_uint32_t));
+    HG_TEST_CHECK_ERROR(send_op_ids == NULL || recv_op_ids == NULL ||
+                            send_bufs == NULL || recv_bufs == NULL,
+        done, ret, NA_NOMEM, "Could not allocate msgs");
+
+    /* Send all the msgs before any recv is posted */
+    send_info.completed = 0;
+    for (i = 0; i < count; i++) {
+        send_bufs[i] = i;
+        send_op_ids[i] = NA_Op_create(na_class);
+        ret = NA_Msg_send_expected(na_class, context, na_test_early_cb,
+            &send_info, &send_bufs[i], sizeof(send_bufs[i]), NULL, target_addr,
+            0, NA_TEST_EARLY_TAG, &send_op_ids[i]);
+        HG_TEST_CHECK_ERROR(ret != NA_SUCCESS, done, ret, ret,
+            "NA_Msg_send_expected() failed (%s)", NA_Error_to_string(ret));
+    }
+
+    /* Make progress until the early queue is full and the rx queue stalls,
+     * msgs past the bound must not be dropped */
+    hg_time_get_current_ms(&now);
+    deadline = hg_time_add(
+        now, hg_time_from_double(NA_TEST_EARLY_TIMEOUT / 1000.0));
+    do {
+        unsigned int actual_count = 0;
+
+        /* Progress returns early while completions are left to trigger */
+        do {
+            ret = NA_Trigger(context, 0, 1, NULL, &actual_count);
+        } while (ret == NA_SUCCESS && actual_count);
+
+        ret = NA_Progress(na_class, context, 10);
+        HG_TEST_CHECK_ERROR(ret != NA_SUCCESS && ret != NA_TIMEOUT, done, ret,
+            ret, "NA_Progress() failed (%s)", NA_Error_to_string(ret));
+        ret = NA_SM_Get_stats(na_class, &stats);
+        HG_TEST_CHECK_ERROR(ret != NA_SUCCESS, done, ret, ret,
+            "NA_SM_Get_stats() failed (%s)", NA_Error_to_string(ret));
+        hg_time_get_current_ms(&now);
+        HG_TEST_CHECK_ERROR(hg_time_less(deadline, now), done, ret, NA_TIMEOUT,
+            "Rx queue did not stall (early queue depth %lu)",
+            (unsigned long) stats.early_expected_depth);
+    } while (stats.rx_stalls == 0);
+    HG_TEST_CHECK_ERROR(stats.early_expected_depth != stats.early_expected_max,
+        done, ret, NA_PROTOCOL_ERROR,
+        "Early queue depth is %lu, expected %lu",
+        (unsigned long) stats.early_expected_depth,
+        (unsigned long) stats.early_expected_max);
+
+    /* Post the recvs, the sender is resumed as the early queue drains */
+    recv_info.completed = 0;
+    for (i = 0; i < count; i++) {
+        recv_bufs[i] = (na_uint32_t) -1;
+        recv_op_ids[i] = NA_Op_create(na_class);
+        ret = NA_Msg_recv_expected(na_class, context, na_test_early_cb,
+            &recv_info, &recv_bufs[i], sizeof(recv_bufs[i]), NULL,
+            recv_info.source, 0, NA_TEST_EARLY_TAG, &recv_op_ids[i]);
+        HG_TEST_CHECK_ERROR(ret != NA_SUCCESS, done, ret, ret,
+            "NA_Msg_recv_expected() failed (%s)", NA_Error_to_string(ret));
+    }
+    ret = na_test_early_wait(na_class, context, &recv_info, count);
+    HG_TEST_CHECK_ERROR(ret != NA_SUCCESS, done, ret, ret,
+        "Could not receive expected msgs");
+    ret = na_test_early_wait(na_class, context, &send_info, count);
+    HG_TEST_CHECK_ERROR(ret != NA_SUCCESS, done, ret, ret,
+        "Could not send expected msgs");
+    HG_TEST_CHECK_ERROR(send_info.failed || recv_info.failed, done, ret,
+        NA_PROTOCOL_ERROR, "%u sends and %u recvs failed", send_info.failed,
+        recv_info.failed);
+
+    /* Msgs of a same tag are received in order */
+    for (i = 0; i < count; i++)
+        HG_TEST_CHECK_ERROR(recv_bufs[i] != i, done, ret, NA_PROTOCOL_ERROR,
+            "Recv %u got msg %u", i, recv_bufs[i]);
+
+    ret = NA_SM_Get_stats(na_class, &stats);
+    HG_TEST_CHECK_ERROR(ret != NA_SUCCESS, done, ret, ret,
+        "NA_SM_Get_stats() failed (%s)", NA_Error_to_string(ret));
+    HG_TEST_CHECK_ERROR(stats.early_expected_depth != 0, done, ret,
+        NA_PROTOCOL_ERROR, "%lu msgs left in early queue",
+        (unsigned long) stats.early_expected_depth);
+
+    HG_PASSED();
+
+done:
+    if (send_op_ids) {
+        for (i = 0; i < count; i++)
+            if (send_op_ids[i] != NA_OP_ID_NULL)
+                NA_Op_destroy(na_class, send_op_ids[i]);
+        free(send_op_ids);
+    }
+    if (recv_op_ids) {
+        for (i = 0; i < count; i++)
+            if (recv_op_ids[i] != NA_OP_ID_NULL)
+                NA_Op_destroy(na_class, recv_op_ids[i]);
+        free(recv_op_ids);
+    }
+    free(send_bufs);
+    free(recv_bufs);
+    if (unexpected_send_op_id != NA_OP_ID_NULL)
+        NA_Op_destroy(na_class, unexpected_send_op_id);
+    if (unexpected_recv_op_id != NA_OP_ID_NULL)
+        NA_Op_destroy(na_class, unexpected_recv_op_id);
+    if (recv_info.source != NA_ADDR_NULL)
+        NA_Addr_free(na_class, recv_info.source);
+    if (target_addr != NA_ADDR_NULL)
+        NA_Addr_free(na_class, target_addr);
+    if (self_addr != NA_ADDR_NULL)
+        NA_Addr_free(na_class, self_addr);
+
+    return ret;
+}
+#endif
+
+/*---------------------------------------------------------------------------*/
+int
+main(void)
+{
+#ifdef NA_HAS_SM
+    na_class_t *na_class = NULL;
+    na_context_t *context = NULL;
+    na_return_t na_ret;
+    int ret = EXIT_SUCCESS;
+
+    na_class = NA_Initialize("na+sm", NA_TRUE);
+    HG_TEST_CHECK_ERROR(
+        na_class == NULL, done, ret, EXIT_FAILURE, "NA_Initialize() failed");
+    context = NA_Context_create(na_class);
+    HG_TEST_CHECK_ERROR(context == NULL, done, ret, EXIT_FAILURE,
+        "NA_Context_create() failed");
+
+    HG_TEST("early expected msgs capability");
+    HG_TEST_CHECK_ERROR(!NA_Msg_has_early_expected(na_class), done, ret,
+        EXIT_FAILURE, "na+sm does not report early expected msgs");
+    HG_PASSED();
+
+    na_ret = na_test_early_run(na_class, context);
+    HG_TEST_CHECK_ERROR(na_ret != NA_SUCCESS, done, ret, EXIT_FAILURE,
+        "Early expected msgs test failed");
+
+done:
+    if (context)
+        NA_Context_destroy(na_class, context);
+    if (na_class)
+        NA_Finalize(na_class);
+    if (ret != EXIT_SUCCESS)
+        HG_FAILED();
+
+    return ret;
+#else
+    printf("Early expected msgs test requires na+sm, skipping\n");
+    return EXIT_SUCCESS;
+#endif
+}
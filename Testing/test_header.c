@@ -0,0 +1,310 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#include "mercury_test.h"
+
+#include "mercury_core_header.h"
+
+/****************/
+/* Local Macros */
+/****************/
+
+#define HG_TEST_HEADER_ID     0x0102030405060708ULL
+#define HG_TEST_HEADER_COOKIE 0x2A
+#define HG_TEST_HEADER_FLAGS  HG_CORE_MORE_DATA_FRAG
+
+/********************/
+/* Local Prototypes */
+/********************/
+
+static hg_return_t
+hg_test_header_request(hg_uint8_t protocol);
+
+static hg_return_t
+hg_test_header_response(hg_uint8_t protocol);
+
+static hg_return_t
+hg_test_header_unsupported(void);
+
+#ifdef HG_HAS_CHECKSUMS
+static hg_uint32_t
+hg_test_header_crc32c_ref(const void *buf, size_t len);
+
+static hg_return_t
+hg_test_header_crc32c(void);
+
+static hg_return_t
+hg_test_header_corrupt(hg_uint8_t protocol);
+#endif
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_header_request(hg_uint8_t protocol)
+{
+    struct hg_core_header header, decoded;
+    unsigned char buf[sizeof(struct hg_core_header_request)];
+    hg_uint64_t id;
+    hg_return_t ret;
+
+    hg_core_header_request_init(&header);
+    hg_core_header_request_init(&decoded);
+    header.msg.request.protocol = protocol;
+    header.msg.request.id = HG_TEST_HEADER_ID;
+    header.msg.request.flags = HG_TEST_HEADER_FLAGS;
+    header.msg.request.cookie = HG_TEST_HEADER_COOKIE;
+
+    ret = hg_core_header_request_proc(HG_ENCODE, buf, sizeof(buf), &header);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "Could not encode request header (%s)",
+        HG_Error_to_string(ret));
+
+    /* Check wire layout of each format */
+    HG_TEST_CHECK_ERROR(buf[0] != HG_CORE_IDENTIFIER || buf[1] != protocol,
+        done, ret, HG_FAULT, "Invalid HG byte or protocol");
+    if (protocol == HG_CORE_PROTOCOL_VERSION) {
+        HG_TEST_CHECK_ERROR(buf[2] != HG_TEST_HEADER_FLAGS ||
+                                buf[3] != HG_TEST_HEADER_COOKIE ||
+                                buf[4] != 0x08 || buf[11] != 0x01,
+            done, ret, HG_FAULT, "Invalid compact request layout");
+    } else {
+        HG_TEST_CHECK_ERROR(buf[2] != 0x01 || buf[9] != 0x08 ||
+                                buf[10] != HG_TEST_HEADER_FLAGS ||
+                                buf[11] != HG_TEST_HEADER_COOKIE,
+            done, ret, HG_FAULT, "Invalid NBO request layout");
+    }
+
+    ret = hg_core_header_request_proc(HG_DECODE, buf, sizeof(buf), &decoded);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "Could not decode request header (%s)",
+        HG_Error_to_string(ret));
+    ret = hg_core_header_request_verify(&decoded);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "Could not verify request header (%s)",
+        HG_Error_to_string(ret));
+
+    id = decoded.msg.request.id;
+    HG_TEST_CHECK_ERROR(decoded.msg.request.protocol != protocol ||
+                            id != HG_TEST_HEADER_ID ||
+                            decoded.msg.request.flags != HG_TEST_HEADER_FLAGS ||
+                            decoded.msg.request.cookie != HG_TEST_HEADER_COOKIE,
+        done, ret, HG_FAULT, "Decoded request header does not match");
+
+done:
+    hg_core_header_request_finalize(&header);
+    hg_core_header_request_finalize(&decoded);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_header_response(hg_uint8_t protocol)
+{
+    struct hg_core_header header, decoded;
+    const struct hg_core_header_response *response;
+    unsigned char buf[sizeof(struct hg_core_header_response)];
+    hg_return_t ret;
+
+    hg_core_header_response_init(&header);
+    hg_core_header_response_init(&decoded);
+
+    /* Responses follow the protocol of the request they answer */
+    header.protocol = protocol;
+    decoded.protocol = protocol;
+    header.msg.response.ret_code = (hg_int8_t) HG_NOENTRY;
+    header.msg.response.flags = HG_TEST_HEADER_FLAGS;
+    header.msg.response.cookie = 0x1234;
+
+    ret = hg_core_header_response_proc(HG_ENCODE, buf, sizeof(buf), &header);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "Could not encode response header (%s)",
+        HG_Error_to_string(ret));
+
+    if (protocol == HG_CORE_PROTOCOL_VERSION)
+        HG_TEST_CHECK_ERROR(buf[2] != 0x34 || buf[3] != 0x12, done, ret,
+            HG_FAULT, "Invalid compact response layout");
+    else
+        HG_TEST_CHECK_ERROR(buf[2] != 0x12 || buf[3] != 0x34, done, ret,
+            HG_FAULT, "Invalid NBO response layout");
+
+    ret = hg_core_header_response_proc(HG_DECODE, buf, sizeof(buf), &decoded);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "Could not decode response header (%s)",
+        HG_Error_to_string(ret));
+
+    response = &decoded.msg.response;
+    HG_TEST_CHECK_ERROR(response->ret_code != (hg_int8_t) HG_NOENTRY ||
+                            response->flags != HG_TEST_HEADER_FLAGS ||
+                            response->cookie != 0x1234,
+        done, ret, HG_FAULT, "Decoded response header does not match");
+
+done:
+    hg_core_header_response_finalize(&header);
+    hg_core_header_response_finalize(&decoded);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_header_unsupported(void)
+{
+    static const hg_uint8_t protocols[] = {
+        0x03, HG_CORE_PROTOCOL_VERSION + 1};
+    hg_return_t ret = HG_SUCCESS;
+    unsigned int i;
+
+    for (i = 0; i < sizeof(protocols) / sizeof(protocols[0]); i++) {
+        struct hg_core_header header;
+        hg_return_t verify_ret;
+
+        hg_core_header_request_init(&header);
+        header.msg.request.protocol = protocols[i];
+        verify_ret = hg_core_header_request_verify(&header);
+        hg_core_header_request_finalize(&header);
+        HG_TEST_CHECK_ERROR(verify_ret != HG_PROTONOSUPPORT, done, ret,
+            HG_FAULT, "Protocol 0x%02X was not rejected", protocols[i]);
+    }
+
+done:
+    return ret;
+}
+
+#ifdef HG_HAS_CHECKSUMS
+/*---------------------------------------------------------------------------*/
+static hg_uint32_t
+hg_test_header_crc32c_ref(const void *buf, size_t len)
+{
+    const unsigned char *ptr = (const unsigned char *) buf;
+    hg_uint32_t crc = 0xFFFFFFFFU;
+
+    while (len--) {
+        int i;
+
+        crc ^= *ptr++;
+        for (i = 0; i < 8; i++)
+            crc = (crc & 1U) ? (crc >> 1) ^ 0x82F63B78U : (crc >> 1);
+    }
+
+    return ~crc;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_header_crc32c(void)
+{
+    static const char check[] = "123456789";
+    unsigned char buf[64 + 3];
+    hg_return_t ret = HG_SUCCESS;
+    size_t offset, len;
+
+    /* Standard check value of CRC32C */
+    HG_TEST_CHECK_ERROR(hg_core_header_crc32c(check, sizeof(check) - 1) !=
+                            0xE3069283U,
+        done, ret, HG_FAULT, "Invalid CRC32C check value");
+
+    /* Instruction paths must match the bitwise CRC for any length and
+     * alignment */
+    for (offset = 0; offset < sizeof(buf); offset++)
+        buf[offset] = (unsigned char) (offset * 31 + 7);
+    for (offset = 0; offset < 4; offset++)
+        for (len = 0; len + offset <= sizeof(buf); len++)
+            HG_TEST_CHECK_ERROR(hg_core_header_crc32c(buf + offset, len) !=
+                                    hg_test_header_crc32c_ref(
+                                        buf + offset, len),
+                done, ret, HG_FAULT,
+                "CRC32C mismatch (offset %zu, length %zu)", offset, len);
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_header_corrupt(hg_uint8_t protocol)
+{
+    struct hg_core_header header, decoded;
+    unsigned char buf[sizeof(struct hg_core_header_request)];
+    hg_return_t ret;
+
+    hg_core_header_request_init(&header);
+    hg_core_header_request_init(&decoded);
+    header.msg.request.protocol = protocol;
+    header.msg.request.id = HG_TEST_HEADER_ID;
+
+    ret = hg_core_header_request_proc(HG_ENCODE, buf, sizeof(buf), &header);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "Could not encode request header (%s)",
+        HG_Error_to_string(ret));
+
+    /* Flip one bit of the RPC ID */
+    buf[5] ^= 0x10;
+    ret = hg_core_header_request_proc(HG_DECODE, buf, sizeof(buf), &decoded);
+    HG_TEST_CHECK_ERROR(ret != HG_CHECKSUM_ERROR, done, ret, HG_FAULT,
+        "Corrupted header was not detected (%s)", HG_Error_to_string(ret));
+    ret = HG_SUCCESS;
+
+done:
+    hg_core_header_request_finalize(&header);
+    hg_core_header_request_finalize(&decoded);
+
+    return ret;
+}
+#endif
+
+/*---------------------------------------------------------------------------*/
+int
+main(void)
+{
+    static const hg_uint8_t protocols[] = {HG_CORE_PROTOCOL_VERSION,
+        HG_CORE_PROTOCOL_VERSION_NBO, HG_CORE_PROTOCOL_VERSION_NBO_MIN};
+    hg_return_t hg_ret;
+    int ret = EXIT_SUCCESS;
+    unsigned int i;
+
+    for (i = 0; i < sizeof(protocols) / sizeof(protocols[0]); i++) {
+        char name[64];
+
+        snprintf(name, sizeof(name), "request header (0x%02X)", protocols[i]);
+        HG_TEST(name);
+        hg_ret = hg_test_header_request(protocols[i]);
+        HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+            "request header test failed");
+        HG_PASSED();
+
+        snprintf(name, sizeof(name), "response header (0x%02X)", protocols[i]);
+        HG_TEST(name);
+        hg_ret = hg_test_header_response(protocols[i]);
+        HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+            "response header test failed");
+        HG_PASSED();
+    }
+
+    HG_TEST("unsupported header versions");
+    hg_ret = hg_test_header_unsupported();
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+        "unsupported header test failed");
+    HG_PASSED();
+
+#ifdef HG_HAS_CHECKSUMS
+    HG_TEST("CRC32C");
+    hg_ret = hg_test_header_crc32c();
+    HG_TEST_CHECK_ERROR(
+        hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE, "CRC32C test failed");
+    HG_PASSED();
+
+    for (i = 0; i < 2; i++) {
+        HG_TEST(i == 0 ? "corrupted compact header" : "corrupted NBO header");
+        hg_ret = hg_test_header_corrupt(protocols[i]);
+        HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+            "corrupted header test failed");
+        HG_PASSED();
+    }
+#endif
+
+done:
+    if (ret != EXIT_SUCCESS)
+        HG_FAILED();
+    return ret;
+}
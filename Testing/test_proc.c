@@ -17,6 +17,8 @@
 /* Local Macros */
 /****************/
 
+#define HG_TEST_PROC_ARRAY_COUNT 37 /* Not a multiple of vector width */
+
 /************************************/
 /* Local Type and Struct Definition */
 /************************************/
@@ -32,6 +34,12 @@ typedef struct {
     hg_const_string_t string;
 } hg_test_proc_string_t;
 
+typedef struct {
+    hg_uint16_t array16[HG_TEST_PROC_ARRAY_COUNT];
+    hg_uint32_t array32[HG_TEST_PROC_ARRAY_COUNT];
+    hg_uint64_t array64[HG_TEST_PROC_ARRAY_COUNT];
+} hg_test_proc_array_t;
+
 /********************/
 /* Local Prototypes */
 /********************/
@@ -74,6 +82,113 @@ hg_proc_hg_test_proc_string_t(hg_proc_t proc, void *data)
     return ret;
 }
 
+static hg_return_t
+hg_proc_hg_test_proc_array_t(hg_proc_t proc, void *data)
+{
+    hg_test_proc_array_t *struct_data = (hg_test_proc_array_t *) data;
+    hg_return_t ret = HG_SUCCESS;
+
+    ret = hg_proc_uint16_array(
+        proc, struct_data->array16, HG_TEST_PROC_ARRAY_COUNT);
+    if (ret != HG_SUCCESS)
+        return ret;
+
+    ret = hg_proc_uint32_array(
+        proc, struct_data->array32, HG_TEST_PROC_ARRAY_COUNT);
+    if (ret != HG_SUCCESS)
+        return ret;
+
+    ret = hg_proc_uint64_array(
+        proc, struct_data->array64, HG_TEST_PROC_ARRAY_COUNT);
+    if (ret != HG_SUCCESS)
+        return ret;
+
+    return ret;
+}
+
+/* Byte-order flag sent by a peer of the other byte order */
+static hg_uint32_t
+hg_test_proc_foreign_order(void)
+{
+    const union {
+        hg_uint32_t i;
+        char c[4];
+    } u = {1};
+
+    /* Little endian is 0, big endian is 1 */
+    return (u.c[0] == 1) ? 1 : 0;
+}
+
+static hg_uint16_t
+hg_test_proc_swap16(hg_uint16_t val)
+{
+    return (hg_uint16_t)(((val & 0x00FFU) << 8) | ((val & 0xFF00U) >> 8));
+}
+
+static hg_uint32_t
+hg_test_proc_swap32(hg_uint32_t val)
+{
+    return ((val & 0x000000FFU) << 24) | ((val & 0x0000FF00U) << 8) |
+           ((val & 0x00FF0000U) >> 8) | ((val & 0xFF000000U) >> 24);
+}
+
+static hg_uint64_t
+hg_test_proc_swap64(hg_uint64_t val)
+{
+    return ((hg_uint64_t) hg_test_proc_swap32((hg_uint32_t)(val & 0xFFFFFFFFU))
+               << 32) |
+           (hg_uint64_t) hg_test_proc_swap32((hg_uint32_t)(val >> 32));
+}
+
+/* Encode array as sent by a peer of the other byte order (data must already
+ * be in that byte order), same layout as hg_proc_array() */
+static hg_return_t
+hg_test_proc_foreign_array(hg_proc_t proc, void *data, hg_size_t data_size)
+{
+    hg_uint32_t byte_order = hg_test_proc_foreign_order();
+    void *buf_ptr;
+    hg_return_t ret;
+
+    ret = hg_proc_hg_uint32_t(proc, &byte_order);
+    if (ret != HG_SUCCESS)
+        return ret;
+
+    buf_ptr = hg_proc_save_ptr(proc, data_size);
+    if (buf_ptr == NULL)
+        return HG_OVERFLOW;
+    memcpy(buf_ptr, data, data_size);
+
+    return hg_proc_restore_ptr(proc, buf_ptr, data_size);
+}
+
+static hg_return_t
+hg_proc_hg_test_proc_foreign_array_t(hg_proc_t proc, void *data)
+{
+    hg_test_proc_array_t *struct_data = (hg_test_proc_array_t *) data;
+    hg_return_t ret = HG_SUCCESS;
+
+    /* Decode and free go through the regular proc */
+    if (hg_proc_get_op(proc) != HG_ENCODE)
+        return hg_proc_hg_test_proc_array_t(proc, data);
+
+    ret = hg_test_proc_foreign_array(
+        proc, struct_data->array16, sizeof(struct_data->array16));
+    if (ret != HG_SUCCESS)
+        return ret;
+
+    ret = hg_test_proc_foreign_array(
+        proc, struct_data->array32, sizeof(struct_data->array32));
+    if (ret != HG_SUCCESS)
+        return ret;
+
+    ret = hg_test_proc_foreign_array(
+        proc, struct_data->array64, sizeof(struct_data->array64));
+    if (ret != HG_SUCCESS)
+        return ret;
+
+    return ret;
+}
+
 /*******************/
 /* Local Variables */
 /*******************/
@@ -228,6 +343,83 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_proc_array(void)
+{
+    hg_return_t ret;
+    hg_test_proc_array_t *in = NULL, *out = NULL, *foreign = NULL;
+    unsigned int i;
+
+    in = (hg_test_proc_array_t *) calloc(1, sizeof(*in));
+    HG_TEST_CHECK_ERROR(
+        in == NULL, done, ret, HG_NOMEM_ERROR, "Could not allocate array");
+    foreign = (hg_test_proc_array_t *) calloc(1, sizeof(*foreign));
+    HG_TEST_CHECK_ERROR(
+        foreign == NULL, done, ret, HG_NOMEM_ERROR, "Could not allocate array");
+    out = (hg_test_proc_array_t *) calloc(1, sizeof(*out));
+    HG_TEST_CHECK_ERROR(
+        out == NULL, done, ret, HG_NOMEM_ERROR, "Could not allocate array");
+
+    for (i = 0; i < HG_TEST_PROC_ARRAY_COUNT; i++) {
+        in->array16[i] = (hg_uint16_t)(0x0102 + i);
+        in->array32[i] = 0x01020304U + i;
+        in->array64[i] = 0x0102030405060708ULL + i;
+    }
+
+    ret = hg_test_proc_generic(hg_proc_hg_test_proc_array_t, in, out);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "hg_test_proc_generic() failed");
+
+    HG_TEST_CHECK_ERROR(memcmp(in, out, sizeof(*in)) != 0, done, ret,
+        HG_PROTOCOL_ERROR, "Encoded and decoded arrays do not match");
+
+    /* Byte swap must be its own inverse and reverse each element */
+    hg_proc_byte_swap(out->array16, HG_TEST_PROC_ARRAY_COUNT, 2);
+    hg_proc_byte_swap(out->array32, HG_TEST_PROC_ARRAY_COUNT, 4);
+    hg_proc_byte_swap(out->array64, HG_TEST_PROC_ARRAY_COUNT, 8);
+    for (i = 0; i < HG_TEST_PROC_ARRAY_COUNT; i++) {
+        HG_TEST_CHECK_ERROR(
+            out->array16[i] != hg_test_proc_swap16(in->array16[i]) ||
+                out->array32[i] != hg_test_proc_swap32(in->array32[i]) ||
+                out->array64[i] != hg_test_proc_swap64(in->array64[i]),
+            done, ret, HG_PROTOCOL_ERROR, "Byte swap failed at index %u", i);
+    }
+    hg_proc_byte_swap(out->array16, HG_TEST_PROC_ARRAY_COUNT, 2);
+    hg_proc_byte_swap(out->array32, HG_TEST_PROC_ARRAY_COUNT, 4);
+    hg_proc_byte_swap(out->array64, HG_TEST_PROC_ARRAY_COUNT, 8);
+    HG_TEST_CHECK_ERROR(memcmp(in, out, sizeof(*in)) != 0, done, ret,
+        HG_PROTOCOL_ERROR, "Double byte swap does not match");
+
+    /* Arrays sent by a peer of the other byte order are swapped on decode */
+    for (i = 0; i < HG_TEST_PROC_ARRAY_COUNT; i++) {
+        foreign->array16[i] = hg_test_proc_swap16(in->array16[i]);
+        foreign->array32[i] = hg_test_proc_swap32(in->array32[i]);
+        foreign->array64[i] = hg_test_proc_swap64(in->array64[i]);
+    }
+    memset(out, 0, sizeof(*out));
+
+    ret = hg_test_proc_generic(
+        hg_proc_hg_test_proc_foreign_array_t, foreign, out);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "hg_test_proc_generic() failed");
+
+    for (i = 0; i < HG_TEST_PROC_ARRAY_COUNT; i++) {
+        HG_TEST_CHECK_ERROR(out->array16[i] != in->array16[i] ||
+                                out->array32[i] != in->array32[i] ||
+                                out->array64[i] != in->array64[i],
+            done, ret, HG_PROTOCOL_ERROR,
+            "Foreign byte order decode failed at index %u", i);
+    }
+
+    ret = hg_test_proc_free(hg_proc_hg_test_proc_array_t, out);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "hg_test_proc_free() failed");
+
+done:
+    free(in);
+    free(out);
+    free(foreign);
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 int
 main(void)
@@ -249,6 +441,13 @@ main(void)
         "string proc test failed");
     HG_PASSED();
 
+    /* array proc test */
+    HG_TEST("array proc");
+    hg_ret = hg_test_proc_array();
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+        "array proc test failed");
+    HG_PASSED();
+
 done:
     if (ret != EXIT_SUCCESS)
         HG_FAILED();
@@ -0,0 +1,248 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#include "mercury_test.h"
+
+/****************/
+/* Local Macros */
+/****************/
+
+/* Progress timeout (ms) */
+#define HG_TEST_PROGRESS_TIMEOUT 20
+
+/********************/
+/* Local Prototypes */
+/********************/
+
+#ifdef HG_HAS_COLLECT_STATS
+static hg_return_t
+hg_test_progress_stats_lookup_cb(const struct hg_cb_info *callback_info);
+
+static hg_return_t
+hg_test_progress_stats_check(const struct hg_progress_stats *stats);
+
+static hg_return_t
+hg_test_progress_stats_run(hg_class_t *hg_class, hg_context_t *context);
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_progress_stats_lookup_cb(const struct hg_cb_info *callback_info)
+{
+    hg_addr_t *addr_p = (hg_addr_t *) callback_info->arg;
+
+    if (callback_info->ret == HG_SUCCESS)
+        *addr_p = callback_info->info.lookup.addr;
+
+    return HG_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_progress_stats_check(const struct hg_progress_stats *stats)
+{
+    hg_return_t ret = HG_SUCCESS;
+
+    /* Sub-phases are nested within progress and trigger */
+    HG_TEST_CHECK_ERROR(stats->ns[HG_PROGRESS_PHASE_POLL_WAIT] +
+                                stats->ns[HG_PROGRESS_PHASE_NA_PROGRESS] +
+                                stats->ns[HG_PROGRESS_PHASE_NA_TRIGGER] >
+                            stats->ns[HG_PROGRESS_PHASE_PROGRESS],
+        done, ret, HG_FAULT, "Progress phases exceed progress time");
+    HG_TEST_CHECK_ERROR(stats->ns[HG_PROGRESS_PHASE_TRIGGER_WAIT] +
+                                stats->ns[HG_PROGRESS_PHASE_CALLBACK] >
+                            stats->ns[HG_PROGRESS_PHASE_TRIGGER],
+        done, ret, HG_FAULT, "Trigger phases exceed trigger time");
+    HG_TEST_CHECK_ERROR(stats->ns[HG_PROGRESS_PHASE_PROGRESS] +
+                                stats->ns[HG_PROGRESS_PHASE_TRIGGER] >
+                            stats->elapsed_ns,
+        done, ret, HG_FAULT, "Accounted time exceeds elapsed time");
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_progress_stats_run(hg_class_t *hg_class, hg_context_t *context)
+{
+    struct hg_progress_stats stats;
+    hg_addr_t addr = HG_ADDR_NULL, lookup_addr = HG_ADDR_NULL;
+    char addr_string[256];
+    hg_size_t addr_string_len = sizeof(addr_string);
+    unsigned int actual_count, i;
+    hg_return_t hg_ret, ret = HG_SUCCESS;
+
+    HG_TEST("progress stats accounting");
+    hg_ret = HG_Context_get_progress_stats(context, &stats);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, HG_FAULT,
+        "HG_Context_get_progress_stats() failed (%s)",
+        HG_Error_to_string(hg_ret));
+    for (i = 0; i < HG_PROGRESS_PHASE_MAX; i++)
+        HG_TEST_CHECK_ERROR(stats.count[i] != 0 || stats.ns[i] != 0, done,
+            ret, HG_FAULT, "Phase %u accounted before progress", i);
+
+    /* Idle progress waits for the whole timeout */
+    hg_ret = HG_Progress(context, HG_TEST_PROGRESS_TIMEOUT);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_TIMEOUT, done, ret, HG_FAULT,
+        "HG_Progress() did not time out (%s)", HG_Error_to_string(hg_ret));
+    hg_ret = HG_Context_get_progress_stats(context, &stats);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, HG_FAULT,
+        "HG_Context_get_progress_stats() failed (%s)",
+        HG_Error_to_string(hg_ret));
+    HG_TEST_CHECK_ERROR(stats.count[HG_PROGRESS_PHASE_PROGRESS] != 1, done,
+        ret, HG_FAULT, "Progress entered %lu times",
+        (unsigned long) stats.count[HG_PROGRESS_PHASE_PROGRESS]);
+    HG_TEST_CHECK_ERROR(stats.ns[HG_PROGRESS_PHASE_PROGRESS] <
+                            (hg_uint64_t) HG_TEST_PROGRESS_TIMEOUT * 500000,
+        done, ret, HG_FAULT, "Progress time too short (%lu ns)",
+        (unsigned long) stats.ns[HG_PROGRESS_PHASE_PROGRESS]);
+    HG_TEST_CHECK_ERROR(stats.count[HG_PROGRESS_PHASE_TRIGGER] != 0, done,
+        ret, HG_FAULT, "Trigger accounted without trigger");
+    hg_ret = hg_test_progress_stats_check(&stats);
+    HG_TEST_CHECK_ERROR(
+        hg_ret != HG_SUCCESS, done, ret, HG_FAULT, "Invalid stats");
+
+    /* Lookup completion runs a user callback */
+    hg_ret = HG_Addr_self(hg_class, &addr);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, HG_FAULT,
+        "HG_Addr_self() failed (%s)", HG_Error_to_string(hg_ret));
+    hg_ret = HG_Addr_to_string(hg_class, addr_string, &addr_string_len, addr);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, HG_FAULT,
+        "HG_Addr_to_string() failed (%s)", HG_Error_to_string(hg_ret));
+    hg_ret = HG_Addr_lookup1(context, hg_test_progress_stats_lookup_cb,
+        &lookup_addr, addr_string, HG_OP_ID_IGNORE);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, HG_FAULT,
+        "HG_Addr_lookup1() failed (%s)", HG_Error_to_string(hg_ret));
+    for (i = 0; i < 100 && lookup_addr == HG_ADDR_NULL; i++) {
+        hg_ret =
+            HG_Trigger(context, HG_TEST_PROGRESS_TIMEOUT, 1, &actual_count);
+        if (hg_ret == HG_TIMEOUT)
+            HG_Progress(context, HG_TEST_PROGRESS_TIMEOUT);
+    }
+    HG_TEST_CHECK_ERROR(lookup_addr == HG_ADDR_NULL, done, ret, HG_FAULT,
+        "Lookup did not complete");
+    hg_ret = HG_Context_get_progress_stats(context, &stats);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, HG_FAULT,
+        "HG_Context_get_progress_stats() failed (%s)",
+        HG_Error_to_string(hg_ret));
+    HG_TEST_CHECK_ERROR(stats.count[HG_PROGRESS_PHASE_TRIGGER] == 0 ||
+                            stats.count[HG_PROGRESS_PHASE_CALLBACK] != 1,
+        done, ret, HG_FAULT, "Callback entered %lu times",
+        (unsigned long) stats.count[HG_PROGRESS_PHASE_CALLBACK]);
+    hg_ret = hg_test_progress_stats_check(&stats);
+    HG_TEST_CHECK_ERROR(
+        hg_ret != HG_SUCCESS, done, ret, HG_FAULT, "Invalid stats");
+    HG_PASSED();
+
+    HG_TEST("progress stats reset");
+    hg_ret = HG_Context_reset_progress_stats(context);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, HG_FAULT,
+        "HG_Context_reset_progress_stats() failed (%s)",
+        HG_Error_to_string(hg_ret));
+    hg_ret = HG_Context_get_progress_stats(context, &stats);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, HG_FAULT,
+        "HG_Context_get_progress_stats() failed (%s)",
+        HG_Error_to_string(hg_ret));
+    for (i = 0; i < HG_PROGRESS_PHASE_MAX; i++)
+        HG_TEST_CHECK_ERROR(stats.count[i] != 0 || stats.ns[i] != 0, done,
+            ret, HG_FAULT, "Phase %u not reset", i);
+    HG_TEST_CHECK_ERROR(stats.elapsed_ns >=
+                            (hg_uint64_t) HG_TEST_PROGRESS_TIMEOUT * 1000000,
+        done, ret, HG_FAULT, "Elapsed time not reset");
+    HG_PASSED();
+
+done:
+    if (lookup_addr != HG_ADDR_NULL)
+        HG_Addr_free(hg_class, lookup_addr);
+    if (addr != HG_ADDR_NULL)
+        HG_Addr_free(hg_class, addr);
+
+    return ret;
+}
+#endif
+
+/*---------------------------------------------------------------------------*/
+int
+main(void)
+{
+    struct hg_init_info hg_init_info = HG_INIT_INFO_INITIALIZER;
+    struct hg_progress_stats stats;
+    hg_class_t *hg_class = NULL;
+    hg_context_t *context = NULL;
+    hg_return_t hg_ret;
+    int ret = EXIT_SUCCESS;
+
+#ifndef NA_HAS_SM
+    printf("Progress stats test requires na+sm, skipping\n");
+    return EXIT_SUCCESS;
+#endif
+
+    /* Accounting is off unless stats are requested */
+    HG_TEST("progress stats disabled");
+    hg_class = HG_Init("na+sm", HG_TRUE);
+    HG_TEST_CHECK_ERROR(
+        hg_class == NULL, done, ret, EXIT_FAILURE, "HG_Init() failed");
+    context = HG_Context_create(hg_class);
+    HG_TEST_CHECK_ERROR(context == NULL, done, ret, EXIT_FAILURE,
+        "HG_Context_create() failed");
+    hg_ret = HG_Context_get_progress_stats(context, &stats);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_OPNOTSUPPORTED, done, ret, EXIT_FAILURE,
+        "Accounting enabled without stats (%s)", HG_Error_to_string(hg_ret));
+    hg_ret = HG_Context_reset_progress_stats(context);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_OPNOTSUPPORTED, done, ret, EXIT_FAILURE,
+        "Accounting enabled without stats (%s)", HG_Error_to_string(hg_ret));
+    HG_Context_destroy(context);
+    context = NULL;
+    HG_Finalize(hg_class);
+    hg_class = NULL;
+    HG_PASSED();
+
+    hg_init_info.stats = HG_TRUE;
+    hg_class = HG_Init_opt("na+sm", HG_TRUE, &hg_init_info);
+    HG_TEST_CHECK_ERROR(
+        hg_class == NULL, done, ret, EXIT_FAILURE, "HG_Init_opt() failed");
+    context = HG_Context_create(hg_class);
+    HG_TEST_CHECK_ERROR(context == NULL, done, ret, EXIT_FAILURE,
+        "HG_Context_create() failed");
+
+    HG_TEST("progress stats arguments");
+    hg_ret = HG_Core_context_get_progress_stats(NULL, &stats);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_INVALID_ARG, done, ret, EXIT_FAILURE,
+        "NULL context was accepted");
+    hg_ret = HG_Context_get_progress_stats(context, NULL);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_INVALID_ARG, done, ret, EXIT_FAILURE,
+        "NULL stats were accepted");
+    hg_ret = HG_Core_context_reset_progress_stats(NULL);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_INVALID_ARG, done, ret, EXIT_FAILURE,
+        "NULL context was accepted");
+    HG_PASSED();
+
+#ifdef HG_HAS_COLLECT_STATS
+    hg_ret = hg_test_progress_stats_run(hg_class, context);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+        "Progress stats test failed");
+#else
+    HG_TEST("progress stats without stats support");
+    hg_ret = HG_Context_get_progress_stats(context, &stats);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_OPNOTSUPPORTED, done, ret, EXIT_FAILURE,
+        "Accounting enabled without stats support");
+    HG_PASSED();
+#endif
+
+done:
+    if (context)
+        HG_Context_destroy(context);
+    if (hg_class)
+        HG_Finalize(hg_class);
+    if (ret != EXIT_SUCCESS)
+        HG_FAILED();
+
+    return ret;
+}
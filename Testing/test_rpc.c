@@ -9,6 +9,9 @@
  */
 
 #include "mercury_test.h"
+#ifdef NA_HAS_SM
+#    include "na_sm.h"
+#endif
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -19,6 +22,14 @@
 
 #define NINFLIGHT (HG_TEST_MAX_HANDLES)
 
+/* Deadline of timed RPCs (ms) */
+#define TIMED_RPC_TIMEOUT 100
+
+/* Payload of fragmented RPCs, above the eager size and below the default
+ * fragment threshold */
+#define FRAG_RPC_SIZE  (16384)
+#define FRAG_RPC_COUNT (100)
+
 /************************************/
 /* Local Type and Struct Definition */
 /************************************/
@@ -33,6 +44,24 @@ struct lookup_cb_args {
     hg_addr_t *addr_ptr;
 };
 
+struct forward_timed_cb_args {
+    hg_request_t *request;
+    hg_return_t ret;
+};
+
+struct forward_frag_cb_args {
+    hg_request_t *request;
+    hg_return_t ret;
+    unsigned int count; /* Number of times callback was called */
+};
+
+#ifdef HG_TEST_HAS_THREAD_POOL
+struct frag_thread_args {
+    struct hg_test_info *hg_test_info;
+    hg_return_t ret;
+};
+#endif
+
 /********************/
 /* Local Prototypes */
 /********************/
@@ -51,6 +80,10 @@ hg_test_rpc_forward_reset_cb(const struct hg_cb_info *callback_info);
 static hg_return_t
 hg_test_rpc_forward_overflow_cb(const struct hg_cb_info *callback_info);
 #endif
+static hg_return_t
+hg_test_rpc_forward_timed_cb(const struct hg_cb_info *callback_info);
+static hg_return_t
+hg_test_rpc_forward_frag_cb(const struct hg_cb_info *callback_info);
 
 static hg_return_t
 hg_test_rpc(hg_context_t *context, hg_request_class_t *request_class,
@@ -75,6 +108,22 @@ hg_test_overflow(hg_context_t *context, hg_request_class_t *request_class,
 static hg_return_t
 hg_test_cancel_rpc(hg_context_t *context, hg_request_class_t *request_class,
     hg_addr_t addr, hg_id_t rpc_id, hg_cb_t callback);
+static hg_return_t
+hg_test_timed_rpc(hg_context_t *context, hg_request_class_t *request_class,
+    hg_addr_t addr, hg_id_t rpc_id, hg_cb_t callback);
+static hg_return_t
+hg_test_late_rpc(hg_class_t *hg_class, hg_context_t *context,
+    hg_request_class_t *request_class, hg_addr_t addr, hg_id_t rpc_id,
+    hg_cb_t callback);
+static hg_return_t
+hg_test_frag_rpc(hg_context_t *context, hg_request_class_t *request_class,
+    hg_addr_t addr, hg_id_t rpc_id, hg_cb_t callback);
+#ifdef HG_TEST_HAS_THREAD_POOL
+static HG_THREAD_RETURN_TYPE
+hg_test_frag_thread(void *arg);
+#endif
+static hg_return_t
+hg_test_mem_usage(hg_context_t *context, hg_addr_t addr, hg_id_t inv_id);
 
 /*******************/
 /* Local Variables */
@@ -85,6 +134,8 @@ extern hg_id_t hg_test_rpc_open_id_g;
 extern hg_id_t hg_test_rpc_open_id_no_resp_g;
 extern hg_id_t hg_test_overflow_id_g;
 extern hg_id_t hg_test_cancel_rpc_id_g;
+extern hg_id_t hg_test_echo_id_g;
+extern hg_id_t hg_test_late_rpc_id_g;
 
 /*---------------------------------------------------------------------------*/
 static hg_return_t
@@ -249,6 +300,54 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_rpc_forward_timed_cb(const struct hg_cb_info *callback_info)
+{
+    struct forward_timed_cb_args *args =
+        (struct forward_timed_cb_args *) callback_info->arg;
+
+    args->ret = callback_info->ret;
+    hg_request_complete(args->request);
+
+    return HG_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_rpc_forward_frag_cb(const struct hg_cb_info *callback_info)
+{
+    struct forward_frag_cb_args *args =
+        (struct forward_frag_cb_args *) callback_info->arg;
+    perf_rpc_lat_in_t out_struct;
+    hg_return_t ret = HG_SUCCESS;
+
+    args->count++;
+    args->ret = callback_info->ret;
+    HG_TEST_CHECK_ERROR_NORET(callback_info->ret != HG_SUCCESS, done,
+        "Error in HG callback (%s)", HG_Error_to_string(callback_info->ret));
+
+    /* Payload must come back unchanged */
+    ret = HG_Get_output(callback_info->info.forward.handle, &out_struct);
+    HG_TEST_CHECK_HG_ERROR(
+        done, ret, "HG_Get_output() failed (%s)", HG_Error_to_string(ret));
+
+    if (out_struct.buf_size != FRAG_RPC_SIZE ||
+        ((const char *) out_struct.buf)[FRAG_RPC_SIZE - 1] !=
+            (char) (FRAG_RPC_SIZE - 1)) {
+        HG_TEST_LOG_ERROR("Echoed payload does not match");
+        args->ret = HG_PROTOCOL_ERROR;
+    }
+
+    ret = HG_Free_output(callback_info->info.forward.handle, &out_struct);
+    HG_TEST_CHECK_HG_ERROR(
+        done, ret, "HG_Free_output() failed (%s)", HG_Error_to_string(ret));
+
+done:
+    hg_request_complete(args->request);
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 static hg_return_t
 hg_test_rpc_null(
@@ -732,6 +831,256 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_timed_rpc(hg_context_t *context, hg_request_class_t *request_class,
+    hg_addr_t addr, hg_id_t rpc_id, hg_cb_t callback)
+{
+    hg_request_t *request_m[NINFLIGHT];
+    hg_handle_t handle_m[NINFLIGHT];
+    struct forward_timed_cb_args forward_cb_args_m[NINFLIGHT];
+    hg_return_t ret = HG_SUCCESS;
+    unsigned int i;
+
+    /* Target never responds, all RPCs must time out */
+    HG_TEST_LOG_DEBUG("Forwarding %u timed RPCs...", NINFLIGHT);
+    for (i = 0; i < NINFLIGHT; i++) {
+        request_m[i] = hg_request_create(request_class);
+        ret = HG_Create(context, addr, rpc_id, handle_m + i);
+        HG_TEST_CHECK_HG_ERROR(
+            done, ret, "HG_Create() failed (%s)", HG_Error_to_string(ret));
+
+        forward_cb_args_m[i].request = request_m[i];
+        forward_cb_args_m[i].ret = HG_SUCCESS;
+        ret = HG_Forward_timed(handle_m[i], callback, &forward_cb_args_m[i],
+            NULL, TIMED_RPC_TIMEOUT);
+        HG_TEST_CHECK_HG_ERROR(done, ret, "HG_Forward_timed() failed (%s)",
+            HG_Error_to_string(ret));
+    }
+
+    /* Complete */
+    for (i = 0; i < NINFLIGHT; i++) {
+        hg_request_wait(request_m[i], HG_MAX_IDLE_TIME, NULL);
+        HG_TEST_CHECK_ERROR(forward_cb_args_m[i].ret != HG_TIMEOUT, done, ret,
+            HG_PROTOCOL_ERROR, "RPC %u did not time out (%s)", i,
+            HG_Error_to_string(forward_cb_args_m[i].ret));
+
+        ret = HG_Destroy(handle_m[i]);
+        HG_TEST_CHECK_HG_ERROR(
+            done, ret, "HG_Destroy() failed (%s)", HG_Error_to_string(ret));
+
+        hg_request_destroy(request_m[i]);
+    }
+    HG_TEST_LOG_DEBUG("Done");
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_late_rpc(hg_class_t *hg_class, hg_context_t *context,
+    hg_request_class_t *request_class, hg_addr_t addr, hg_id_t rpc_id,
+    hg_cb_t callback)
+{
+#ifdef NA_HAS_SM
+    struct na_sm_stats stats_before, stats_after;
+    hg_bool_t has_stats;
+#endif
+    hg_request_t *request = NULL, *idle_request = NULL;
+    hg_handle_t handle = HG_HANDLE_NULL;
+    struct forward_timed_cb_args forward_cb_args;
+    hg_return_t ret = HG_SUCCESS, cleanup_ret;
+
+#ifdef NA_HAS_SM
+    /* Fails if the class does not use NA SM */
+    has_stats = (NA_SM_Get_stats(HG_Core_class_get_na(hg_class->core_class),
+                     &stats_before) == NA_SUCCESS);
+#else
+    (void) hg_class;
+#endif
+
+    ret = HG_Create(context, addr, rpc_id, &handle);
+    HG_TEST_CHECK_HG_ERROR(
+        done, ret, "HG_Create() failed (%s)", HG_Error_to_string(ret));
+
+    /* Target responds after the deadline */
+    request = hg_request_create(request_class);
+    forward_cb_args.request = request;
+    forward_cb_args.ret = HG_SUCCESS;
+    ret = HG_Forward_timed(
+        handle, callback, &forward_cb_args, NULL, TIMED_RPC_TIMEOUT);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "HG_Forward_timed() failed (%s)",
+        HG_Error_to_string(ret));
+
+    hg_request_wait(request, HG_MAX_IDLE_TIME, NULL);
+    HG_TEST_CHECK_ERROR(forward_cb_args.ret != HG_TIMEOUT, done, ret,
+        HG_PROTOCOL_ERROR, "RPC did not time out (%s)",
+        HG_Error_to_string(forward_cb_args.ret));
+
+    /* Keep making progress until the late response has been received */
+    idle_request = hg_request_create(request_class);
+    hg_request_wait(idle_request, 2 * HG_TEST_LATE_RPC_DELAY, NULL);
+
+#ifdef NA_HAS_SM
+    if (has_stats) {
+        na_return_t na_ret = NA_SM_Get_stats(
+            HG_Core_class_get_na(hg_class->core_class), &stats_after);
+        HG_TEST_CHECK_ERROR(na_ret != NA_SUCCESS, done, ret, HG_PROTOCOL_ERROR,
+            "NA_SM_Get_stats() failed (%s)", NA_Error_to_string(na_ret));
+
+        /* Late response must not remain queued as an early expected msg */
+        HG_TEST_CHECK_ERROR(stats_after.late_expected_dropped ==
+                                stats_before.late_expected_dropped,
+            done, ret, HG_PROTOCOL_ERROR, "Late response was not dropped");
+        HG_TEST_CHECK_ERROR(stats_after.early_expected_depth !=
+                                stats_before.early_expected_depth,
+            done, ret, HG_PROTOCOL_ERROR,
+            "Late response is left in early expected queue (depth %lu)",
+            (unsigned long) stats_after.early_expected_depth);
+    }
+#endif
+
+done:
+    if (handle != HG_HANDLE_NULL) {
+        cleanup_ret = HG_Destroy(handle);
+        HG_TEST_CHECK_ERROR_DONE(cleanup_ret != HG_SUCCESS,
+            "HG_Destroy() failed (%s)", HG_Error_to_string(cleanup_ret));
+    }
+    if (request)
+        hg_request_destroy(request);
+    if (idle_request)
+        hg_request_destroy(idle_request);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_frag_rpc(hg_context_t *context, hg_request_class_t *request_class,
+    hg_addr_t addr, hg_id_t rpc_id, hg_cb_t callback)
+{
+    hg_handle_t handle = HG_HANDLE_NULL;
+    perf_rpc_lat_in_t in_struct;
+    struct forward_frag_cb_args forward_cb_args;
+    hg_return_t ret = HG_SUCCESS, cleanup_ret;
+    unsigned int i;
+
+    in_struct.buf_size = FRAG_RPC_SIZE;
+    in_struct.buf = malloc(FRAG_RPC_SIZE);
+    HG_TEST_CHECK_ERROR(in_struct.buf == NULL, done, ret, HG_NOMEM_ERROR,
+        "Could not allocate payload");
+    for (i = 0; i < FRAG_RPC_SIZE; i++)
+        ((char *) in_struct.buf)[i] = (char) i;
+
+    ret = HG_Create(context, addr, rpc_id, &handle);
+    HG_TEST_CHECK_HG_ERROR(
+        done, ret, "HG_Create() failed (%s)", HG_Error_to_string(ret));
+
+    /* Reuse the same handle, which must only complete once all of its
+     * fragments have been sent and received */
+    for (i = 0; i < FRAG_RPC_COUNT; i++) {
+        forward_cb_args.request = hg_request_create(request_class);
+        forward_cb_args.ret = HG_SUCCESS;
+        forward_cb_args.count = 0;
+
+        ret = HG_Forward(handle, callback, &forward_cb_args, &in_struct);
+        if (ret != HG_SUCCESS)
+            hg_request_destroy(forward_cb_args.request);
+        HG_TEST_CHECK_HG_ERROR(
+            done, ret, "HG_Forward() failed (%s)", HG_Error_to_string(ret));
+
+        hg_request_wait(forward_cb_args.request, HG_MAX_IDLE_TIME, NULL);
+        hg_request_destroy(forward_cb_args.request);
+
+        /* Errors after the request was posted are reported to the callback,
+         * which must be called exactly once */
+        HG_TEST_CHECK_ERROR(forward_cb_args.count != 1, done, ret,
+            HG_PROTOCOL_ERROR, "Callback was called %u times",
+            forward_cb_args.count);
+        ret = forward_cb_args.ret;
+        HG_TEST_CHECK_HG_ERROR(
+            done, ret, "RPC %u failed (%s)", i, HG_Error_to_string(ret));
+    }
+
+done:
+    cleanup_ret = HG_Destroy(handle);
+    HG_TEST_CHECK_ERROR_DONE(cleanup_ret != HG_SUCCESS,
+        "HG_Destroy() failed (%s)", HG_Error_to_string(cleanup_ret));
+
+    free(in_struct.buf);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+#ifdef HG_TEST_HAS_THREAD_POOL
+static HG_THREAD_RETURN_TYPE
+hg_test_frag_thread(void *arg)
+{
+    struct frag_thread_args *args = (struct frag_thread_args *) arg;
+
+    args->ret = hg_test_frag_rpc(args->hg_test_info->context,
+        args->hg_test_info->request_class, args->hg_test_info->target_addr,
+        hg_test_echo_id_g, hg_test_rpc_forward_frag_cb);
+
+    return NULL;
+}
+#endif
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_mem_usage(hg_context_t *context, hg_addr_t addr, hg_id_t inv_id)
+{
+    static const hg_mem_usage_type_t types[] = {
+        HG_MEM_USAGE_HANDLE, HG_MEM_USAGE_MSG_BUF};
+    struct hg_mem_usage before, usage;
+    hg_handle_t handle = HG_HANDLE_NULL;
+    hg_return_t ret;
+    unsigned int i;
+
+    ret = HG_Mem_usage(&before);
+    if (ret == HG_OPNOTSUPPORTED)
+        return HG_SUCCESS; /* Not accounted */
+    HG_TEST_CHECK_HG_ERROR(
+        done, ret, "HG_Mem_usage() failed (%s)", HG_Error_to_string(ret));
+
+    /* Handle and its buffers are accounted while it exists */
+    ret = HG_Create(context, addr, hg_test_rpc_null_id_g, &handle);
+    HG_TEST_CHECK_HG_ERROR(
+        done, ret, "HG_Create() failed (%s)", HG_Error_to_string(ret));
+    HG_Mem_usage(&usage);
+    for (i = 0; i < sizeof(types) / sizeof(types[0]); i++)
+        HG_TEST_CHECK_ERROR(usage.current[types[i]] <= before.current[types[i]],
+            done, ret, HG_FAULT, "%s usage did not increase",
+            HG_Mem_usage_type_to_string(types[i]));
+
+    ret = HG_Destroy(handle);
+    handle = HG_HANDLE_NULL;
+    HG_TEST_CHECK_HG_ERROR(
+        done, ret, "HG_Destroy() failed (%s)", HG_Error_to_string(ret));
+
+    /* Failed creation releases everything it accounted */
+    ret = HG_Create(context, addr, inv_id, &handle);
+    HG_TEST_CHECK_ERROR(ret != HG_NOENTRY, done, ret, HG_FAULT,
+        "HG_Create() did not fail (%s)", HG_Error_to_string(ret));
+    ret = HG_SUCCESS;
+
+    HG_Mem_usage(&usage);
+    for (i = 0; i < sizeof(types) / sizeof(types[0]); i++)
+        HG_TEST_CHECK_ERROR(usage.current[types[i]] != before.current[types[i]],
+            done, ret, HG_FAULT, "%s usage is %lu bytes instead of %lu",
+            HG_Mem_usage_type_to_string(types[i]),
+            (unsigned long) usage.current[types[i]],
+            (unsigned long) before.current[types[i]]);
+
+done:
+    if (handle != HG_HANDLE_NULL)
+        HG_Destroy(handle);
+
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 int
 main(int argc, char *argv[])
@@ -846,6 +1195,14 @@ main(int argc, char *argv[])
         "unregistered RPC test failed");
     HG_PASSED();
 
+    /* Memory usage test */
+    HG_TEST("memory usage");
+    hg_ret = hg_test_mem_usage(
+        hg_test_info.context, hg_test_info.target_addr, inv_id);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+        "memory usage test failed");
+    HG_PASSED();
+
     if (!hg_test_info.na_test_info.self_send) {
         /* RPC test with invalid ID (not registered on server) */
         inv_id =
@@ -914,6 +1271,54 @@ main(int argc, char *argv[])
         HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
             "cancel RPC test failed");
         HG_PASSED();
+
+        HG_TEST("timed RPC");
+        hg_ret = hg_test_timed_rpc(hg_test_info.context,
+            hg_test_info.request_class, hg_test_info.target_addr,
+            hg_test_cancel_rpc_id_g, hg_test_rpc_forward_timed_cb);
+        HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+            "timed RPC test failed");
+        HG_PASSED();
+
+        HG_TEST("late response to timed RPC");
+        hg_ret = hg_test_late_rpc(hg_test_info.hg_class, hg_test_info.context,
+            hg_test_info.request_class, hg_test_info.target_addr,
+            hg_test_late_rpc_id_g, hg_test_rpc_forward_timed_cb);
+        HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+            "late response test failed");
+        HG_PASSED();
+    }
+
+    /* Fragmented RPCs, each thread forwards and reuses its own handle */
+    if (!hg_test_info.na_test_info.self_send) {
+#ifdef HG_TEST_HAS_THREAD_POOL
+        hg_thread_t threads[HG_TEST_NUM_THREADS_DEFAULT];
+        struct frag_thread_args frag_thread_args[HG_TEST_NUM_THREADS_DEFAULT];
+        int i;
+#endif
+
+        HG_TEST("fragmented RPCs");
+#ifdef HG_TEST_HAS_THREAD_POOL
+        if (!hg_test_info.na_test_info.single_thread) {
+            for (i = 0; i < HG_TEST_NUM_THREADS_DEFAULT; i++) {
+                frag_thread_args[i].hg_test_info = &hg_test_info;
+                frag_thread_args[i].ret = HG_SUCCESS;
+                hg_thread_create(
+                    &threads[i], hg_test_frag_thread, &frag_thread_args[i]);
+            }
+            for (i = 0; i < HG_TEST_NUM_THREADS_DEFAULT; i++) {
+                hg_thread_join(threads[i]);
+                if (frag_thread_args[i].ret != HG_SUCCESS)
+                    hg_ret = frag_thread_args[i].ret;
+            }
+        } else
+#endif
+            hg_ret = hg_test_frag_rpc(hg_test_info.context,
+                hg_test_info.request_class, hg_test_info.target_addr,
+                hg_test_echo_id_g, hg_test_rpc_forward_frag_cb);
+        HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+            "fragmented RPC test failed");
+        HG_PASSED();
     }
 
 done:
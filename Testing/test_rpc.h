@@ -139,7 +139,7 @@ hg_proc_perf_rpc_lat_in_t(hg_proc_t proc, void *data)
 #ifdef HG_TEST_HAS_VERIFY_DATA
         if (hg_proc_get_op(proc) == HG_DECODE) {
             hg_size_t i;
-            char *buf_ptr = struct_data->buf;
+            char *buf_ptr = (char *) struct_data->buf;
 
             for (i = 0; i < struct_data->buf_size; i++) {
                 if (buf_ptr[i] != (char) i) {
@@ -0,0 +1,401 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#include "mercury_test.h"
+#include "mercury_tool.h"
+
+/****************/
+/* Local Macros */
+/****************/
+
+/* Max number of recorded events */
+#define HG_TEST_TOOL_EVENT_MAX 64
+
+/* Max number of progress rounds before giving up on an RPC */
+#define HG_TEST_TOOL_PROGRESS_MAX 500
+
+/* Value sent and returned by the RPC */
+#define HG_TEST_TOOL_VALUE 42
+
+/************************************/
+/* Local Type and Struct Definition */
+/************************************/
+
+/* Recorded event */
+struct hg_test_tool_event {
+    hg_tool_event_t event;
+    hg_core_context_t *context;
+    hg_core_handle_t handle;
+    hg_id_t id;
+    hg_size_t size;
+    hg_uint64_t time_ns;
+    hg_return_t ret;
+};
+
+/* Recorded events of a tool */
+struct hg_test_tool_record {
+    struct hg_test_tool_event events[HG_TEST_TOOL_EVENT_MAX];
+    unsigned int count;
+};
+
+/********************/
+/* Local Prototypes */
+/********************/
+
+static void
+hg_test_tool_cb(const struct hg_tool_event_info *event_info, void *arg);
+
+static hg_return_t
+hg_test_tool_rpc_cb(hg_handle_t handle);
+
+static hg_return_t
+hg_test_tool_forward_cb(const struct hg_cb_info *callback_info);
+
+static hg_return_t
+hg_test_tool_forward(hg_context_t *context, hg_context_t *target_context,
+    hg_addr_t addr, hg_id_t id);
+
+static const struct hg_test_tool_event *
+hg_test_tool_find(
+    const struct hg_test_tool_record *record, hg_tool_event_t event);
+
+static hg_return_t
+hg_test_tool_order(const struct hg_test_tool_record *record, hg_id_t id);
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_test_tool_cb(const struct hg_tool_event_info *event_info, void *arg)
+{
+    struct hg_test_tool_record *record = (struct hg_test_tool_record *) arg;
+    struct hg_test_tool_event *event;
+
+    if (record->count == HG_TEST_TOOL_EVENT_MAX)
+        return;
+
+    event = &record->events[record->count++];
+    event->event = event_info->event;
+    event->context = event_info->context;
+    event->handle = event_info->handle;
+    event->id = (event_info->info) ? event_info->info->id : 0;
+    event->size = event_info->size;
+    event->time_ns = event_info->time_ns;
+    event->ret = event_info->ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_tool_rpc_cb(hg_handle_t handle)
+{
+    hg_uint32_t value;
+    hg_return_t ret;
+
+    ret = HG_Get_input(handle, &value);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "HG_Get_input() failed");
+
+    HG_Free_input(handle, &value);
+
+    ret = HG_Respond(handle, NULL, NULL, &value);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "HG_Respond() failed");
+
+done:
+    HG_Destroy(handle);
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_tool_forward_cb(const struct hg_cb_info *callback_info)
+{
+    hg_return_t *ret_p = (hg_return_t *) callback_info->arg;
+    hg_uint32_t value = 0;
+    hg_return_t ret = callback_info->ret;
+
+    HG_TEST_CHECK_HG_ERROR(done, ret, "Error in HG callback (%s)",
+        HG_Error_to_string(callback_info->ret));
+
+    ret = HG_Get_output(callback_info->info.forward.handle, &value);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "HG_Get_output() failed");
+
+    HG_Free_output(callback_info->info.forward.handle, &value);
+
+    HG_TEST_CHECK_ERROR(value != HG_TEST_TOOL_VALUE, done, ret, HG_FAULT,
+        "Returned value %u does not match %u", value, HG_TEST_TOOL_VALUE);
+
+done:
+    *ret_p = ret;
+    return HG_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_tool_forward(hg_context_t *context, hg_context_t *target_context,
+    hg_addr_t addr, hg_id_t id)
+{
+    hg_handle_t handle = HG_HANDLE_NULL;
+    hg_uint32_t value = HG_TEST_TOOL_VALUE;
+    hg_return_t forward_ret = HG_TIMEOUT, ret;
+    unsigned int i;
+
+    ret = HG_Create(context, addr, id, &handle);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "HG_Create() failed");
+
+    ret = HG_Forward(handle, hg_test_tool_forward_cb, &forward_ret, &value);
+    HG_TEST_CHECK_HG_ERROR(done, ret, "HG_Forward() failed");
+
+    for (i = 0; i < HG_TEST_TOOL_PROGRESS_MAX && forward_ret == HG_TIMEOUT;
+         i++) {
+        hg_context_t *contexts[2] = {target_context, context};
+        unsigned int j;
+
+        /* Drive target first so that its response is ready for origin */
+        for (j = 0; j < 2; j++) {
+            unsigned int actual_count = 0;
+
+            ret = HG_Progress(contexts[j], 10);
+            HG_TEST_CHECK_ERROR(ret != HG_SUCCESS && ret != HG_TIMEOUT, done,
+                ret, ret, "HG_Progress() failed");
+
+            do {
+                ret = HG_Trigger(contexts[j], 0, 1, &actual_count);
+            } while (ret == HG_SUCCESS && actual_count);
+        }
+    }
+    ret = forward_ret;
+    HG_TEST_CHECK_HG_ERROR(done, ret, "RPC did not complete");
+
+done:
+    if (handle != HG_HANDLE_NULL)
+        HG_Destroy(handle);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static const struct hg_test_tool_event *
+hg_test_tool_find(
+    const struct hg_test_tool_record *record, hg_tool_event_t event)
+{
+    const struct hg_test_tool_event *found = NULL;
+    unsigned int i;
+
+    for (i = 0; i < record->count; i++) {
+        if (record->events[i].event != event)
+            continue;
+        if (found)
+            return NULL; /* Events must be reported once per RPC */
+        found = &record->events[i];
+    }
+
+    return found;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_test_tool_order(const struct hg_test_tool_record *record, hg_id_t id)
+{
+    /* Expected order of events of an RPC, the handler responds before it
+     * returns and the response is processed once the handler has returned */
+    static const hg_tool_event_t order[] = {HG_TOOL_FORWARD_POSTED,
+        HG_TOOL_REQUEST_RECEIVED, HG_TOOL_HANDLER_START,
+        HG_TOOL_RESPOND_POSTED, HG_TOOL_HANDLER_END,
+        HG_TOOL_RESPONSE_RECEIVED};
+    const struct hg_test_tool_event *events[HG_TOOL_EVENT_MAX];
+    const struct hg_test_tool_event *prev = NULL;
+    hg_return_t ret = HG_SUCCESS;
+    unsigned int i;
+
+    HG_TEST_CHECK_ERROR(record->count != sizeof(order) / sizeof(order[0]),
+        done, ret, HG_FAULT, "Recorded %u events, expected %u", record->count,
+        (unsigned int) (sizeof(order) / sizeof(order[0])));
+
+    for (i = 0; i < sizeof(order) / sizeof(order[0]); i++) {
+        const struct hg_test_tool_event *event =
+            hg_test_tool_find(record, order[i]);
+
+        HG_TEST_CHECK_ERROR(event == NULL, done, ret, HG_FAULT,
+            "%s not reported once", HG_Tool_event_to_string(order[i]));
+        HG_TEST_CHECK_ERROR(prev && (event < prev ||
+                                        event->time_ns < prev->time_ns),
+            done, ret, HG_FAULT, "%s reported before %s",
+            HG_Tool_event_to_string(order[i]),
+            HG_Tool_event_to_string(prev->event));
+        HG_TEST_CHECK_ERROR(event->handle == NULL || event->context == NULL,
+            done, ret, HG_FAULT, "%s has no handle or context",
+            HG_Tool_event_to_string(order[i]));
+        HG_TEST_CHECK_ERROR(event->id != id, done, ret, HG_FAULT,
+            "%s has wrong RPC ID", HG_Tool_event_to_string(order[i]));
+        HG_TEST_CHECK_ERROR(event->ret != HG_SUCCESS, done, ret, HG_FAULT,
+            "%s has wrong status (%s)", HG_Tool_event_to_string(order[i]),
+            HG_Error_to_string(event->ret));
+        events[order[i]] = event;
+        prev = event;
+    }
+
+    /* Sizes reported on both sides of each message must match */
+    HG_TEST_CHECK_ERROR(events[HG_TOOL_FORWARD_POSTED]->size == 0 ||
+                            events[HG_TOOL_FORWARD_POSTED]->size !=
+                                events[HG_TOOL_REQUEST_RECEIVED]->size,
+        done, ret, HG_FAULT, "Request sizes do not match (%lu, %lu)",
+        (unsigned long) events[HG_TOOL_FORWARD_POSTED]->size,
+        (unsigned long) events[HG_TOOL_REQUEST_RECEIVED]->size);
+    HG_TEST_CHECK_ERROR(events[HG_TOOL_RESPOND_POSTED]->size == 0 ||
+                            events[HG_TOOL_RESPOND_POSTED]->size !=
+                                events[HG_TOOL_RESPONSE_RECEIVED]->size,
+        done, ret, HG_FAULT, "Response sizes do not match (%lu, %lu)",
+        (unsigned long) events[HG_TOOL_RESPOND_POSTED]->size,
+        (unsigned long) events[HG_TOOL_RESPONSE_RECEIVED]->size);
+
+    /* Handler events refer to the target handle */
+    HG_TEST_CHECK_ERROR(
+        events[HG_TOOL_HANDLER_START]->handle !=
+                events[HG_TOOL_REQUEST_RECEIVED]->handle ||
+            events[HG_TOOL_HANDLER_END]->handle !=
+                events[HG_TOOL_RESPOND_POSTED]->handle,
+        done, ret, HG_FAULT, "Target events refer to different handles");
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+int
+main(void)
+{
+    static struct hg_test_tool_record record_all, record_response;
+    hg_class_t *hg_class = NULL, *target_class = NULL;
+    hg_context_t *context = NULL, *target_context = NULL;
+    hg_addr_t addr = HG_ADDR_NULL, target_addr = HG_ADDR_NULL;
+    char addr_string[256];
+    hg_size_t addr_string_len = sizeof(addr_string);
+    hg_tool_id_t tool_all = -1, tool_response = -1, tool_id;
+    hg_id_t id;
+    hg_return_t hg_ret;
+    int ret = EXIT_SUCCESS;
+
+#ifndef NA_HAS_SM
+    printf("Tool test requires na+sm, skipping\n");
+    return EXIT_SUCCESS;
+#endif
+
+    HG_TEST("tool registration");
+    hg_ret = HG_Tool_register(
+        HG_TOOL_EVENT_ALL, NULL, &record_all, &tool_id);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_INVALID_ARG, done, ret, EXIT_FAILURE,
+        "NULL callback was accepted");
+    hg_ret = HG_Tool_register(0, hg_test_tool_cb, &record_all, &tool_id);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_INVALID_ARG, done, ret, EXIT_FAILURE,
+        "Empty event mask was accepted");
+    hg_ret = HG_Tool_deregister(HG_TOOL_MAX);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_INVALID_ARG, done, ret, EXIT_FAILURE,
+        "Invalid tool ID was accepted");
+    hg_ret = HG_Tool_register(
+        HG_TOOL_EVENT_ALL, hg_test_tool_cb, &record_all, &tool_all);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+        "HG_Tool_register() failed (%s)", HG_Error_to_string(hg_ret));
+    hg_ret = HG_Tool_register(HG_TOOL_EVENT_MASK(HG_TOOL_RESPONSE_RECEIVED),
+        hg_test_tool_cb, &record_response, &tool_response);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+        "HG_Tool_register() failed (%s)", HG_Error_to_string(hg_ret));
+    HG_PASSED();
+
+    /* Origin and target are separate classes within this process */
+    target_class = HG_Init("na+sm", HG_TRUE);
+    HG_TEST_CHECK_ERROR(
+        target_class == NULL, done, ret, EXIT_FAILURE, "HG_Init() failed");
+    target_context = HG_Context_create(target_class);
+    HG_TEST_CHECK_ERROR(target_context == NULL, done, ret, EXIT_FAILURE,
+        "HG_Context_create() failed");
+    id = HG_Register_name(target_class, "hg_test_tool", hg_proc_hg_uint32_t,
+        hg_proc_hg_uint32_t, hg_test_tool_rpc_cb);
+    hg_ret = HG_Addr_self(target_class, &target_addr);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+        "HG_Addr_self() failed (%s)", HG_Error_to_string(hg_ret));
+    hg_ret = HG_Addr_to_string(
+        target_class, addr_string, &addr_string_len, target_addr);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+        "HG_Addr_to_string() failed (%s)", HG_Error_to_string(hg_ret));
+
+    hg_class = HG_Init("na+sm", HG_FALSE);
+    HG_TEST_CHECK_ERROR(
+        hg_class == NULL, done, ret, EXIT_FAILURE, "HG_Init() failed");
+    context = HG_Context_create(hg_class);
+    HG_TEST_CHECK_ERROR(context == NULL, done, ret, EXIT_FAILURE,
+        "HG_Context_create() failed");
+    HG_Register_name(hg_class, "hg_test_tool", hg_proc_hg_uint32_t,
+        hg_proc_hg_uint32_t, NULL);
+    hg_ret = HG_Addr_lookup2(hg_class, addr_string, &addr);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+        "HG_Addr_lookup2() failed (%s)", HG_Error_to_string(hg_ret));
+
+    HG_TEST("tool event order and payload");
+    hg_ret = hg_test_tool_forward(context, target_context, addr, id);
+    HG_TEST_CHECK_ERROR(
+        hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE, "RPC failed");
+    hg_ret = hg_test_tool_order(&record_all, id);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+        "Wrong sequence of events");
+    HG_TEST_CHECK_ERROR(record_response.count != 1 ||
+                            record_response.events[0].event !=
+                                HG_TOOL_RESPONSE_RECEIVED,
+        done, ret, EXIT_FAILURE, "Event mask was not honored");
+    HG_PASSED();
+
+    HG_TEST("tool deregistration");
+    hg_ret = HG_Tool_deregister(tool_all);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+        "HG_Tool_deregister() failed (%s)", HG_Error_to_string(hg_ret));
+    hg_ret = HG_Tool_deregister(tool_all);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_NOENTRY, done, ret, EXIT_FAILURE,
+        "Tool was deregistered twice");
+    memset(&record_all, 0, sizeof(record_all));
+    hg_ret = hg_test_tool_forward(context, target_context, addr, id);
+    HG_TEST_CHECK_ERROR(
+        hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE, "RPC failed");
+    HG_TEST_CHECK_ERROR(record_all.count != 0, done, ret, EXIT_FAILURE,
+        "Deregistered tool was notified");
+    HG_TEST_CHECK_ERROR(record_response.count != 2, done, ret, EXIT_FAILURE,
+        "Remaining tool was not notified");
+
+    /* Slot of the deregistered tool is reused */
+    hg_ret = HG_Tool_register(
+        HG_TOOL_EVENT_ALL, hg_test_tool_cb, &record_all, &tool_id);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS || tool_id != tool_all, done,
+        ret, EXIT_FAILURE, "Tool slot was not reused");
+    tool_all = tool_id;
+    hg_ret = hg_test_tool_forward(context, target_context, addr, id);
+    HG_TEST_CHECK_ERROR(
+        hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE, "RPC failed");
+    hg_ret = hg_test_tool_order(&record_all, id);
+    HG_TEST_CHECK_ERROR(hg_ret != HG_SUCCESS, done, ret, EXIT_FAILURE,
+        "Wrong sequence of events after slot reuse");
+    HG_PASSED();
+
+done:
+    if (tool_all >= 0)
+        HG_Tool_deregister(tool_all);
+    if (tool_response >= 0)
+        HG_Tool_deregister(tool_response);
+    if (addr != HG_ADDR_NULL)
+        HG_Addr_free(hg_class, addr);
+    if (context)
+        HG_Context_destroy(context);
+    if (hg_class)
+        HG_Finalize(hg_class);
+    if (target_addr != HG_ADDR_NULL)
+        HG_Addr_free(target_class, target_addr);
+    if (target_context)
+        HG_Context_destroy(target_context);
+    if (target_class)
+        HG_Finalize(target_class);
+    if (ret != EXIT_SUCCESS)
+        HG_FAILED();
+
+    return ret;
+}
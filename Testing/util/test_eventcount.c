@@ -0,0 +1,97 @@
+#include "mercury_atomic.h"
+#include "mercury_eventcount.h"
+#include "mercury_thread.h"
+
+#include "mercury_test_config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define EVENTCOUNT_NUM_POSTS 10000
+
+static hg_eventcount_t ec;
+static hg_atomic_int32_t posted;
+static hg_atomic_int32_t consumed;
+
+static HG_THREAD_RETURN_TYPE
+thread_cb_wait(void *arg)
+{
+    hg_thread_ret_t thread_ret = (hg_thread_ret_t) 0;
+    (void) arg;
+
+    while (hg_atomic_get32(&consumed) < EVENTCOUNT_NUM_POSTS) {
+        hg_util_int32_t count = hg_atomic_get32(&posted);
+        hg_util_int32_t key;
+
+        /* Consume one posted item if any */
+        if (hg_atomic_get32(&consumed) < count) {
+            hg_util_int32_t n = hg_atomic_get32(&consumed);
+            if (n < count)
+                hg_atomic_cas32(&consumed, n, n + 1);
+            continue;
+        }
+
+        key = hg_eventcount_prepare_wait(&ec);
+        if (hg_atomic_get32(&consumed) < hg_atomic_get32(&posted) ||
+            hg_atomic_get32(&consumed) >= EVENTCOUNT_NUM_POSTS)
+            hg_eventcount_cancel_wait(&ec);
+        else
+            hg_eventcount_commit_wait(&ec, key, HG_EVENTCOUNT_INFINITE);
+    }
+
+    hg_thread_exit(thread_ret);
+    return thread_ret;
+}
+
+int
+main(int argc, char *argv[])
+{
+    hg_thread_t thread[HG_TEST_NUM_THREADS_DEFAULT];
+    hg_util_int32_t key;
+    int ret = EXIT_SUCCESS;
+    int i;
+
+    (void) argc;
+    (void) argv;
+
+    hg_eventcount_init(&ec);
+    hg_atomic_init32(&posted, 0);
+    hg_atomic_init32(&consumed, 0);
+
+    /* Nothing posted, wait must time out */
+    key = hg_eventcount_prepare_wait(&ec);
+    if (hg_eventcount_commit_wait(&ec, key, 10) == HG_UTIL_SUCCESS) {
+        fprintf(stderr, "Error: wait did not time out\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+    /* Notification before commit, wait must return immediately */
+    key = hg_eventcount_prepare_wait(&ec);
+    hg_eventcount_notify(&ec);
+    if (hg_eventcount_commit_wait(&ec, key, 1000) != HG_UTIL_SUCCESS) {
+        fprintf(stderr, "Error: notification was lost\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+    /* No wake up must be lost between producer and consumers */
+    for (i = 0; i < HG_TEST_NUM_THREADS_DEFAULT; i++)
+        hg_thread_create(&thread[i], thread_cb_wait, NULL);
+
+    for (i = 0; i < EVENTCOUNT_NUM_POSTS; i++) {
+        hg_atomic_incr32(&posted);
+        hg_eventcount_notify(&ec);
+    }
+    while (hg_atomic_get32(&consumed) < EVENTCOUNT_NUM_POSTS)
+        hg_thread_yield();
+    hg_eventcount_notify_all(&ec);
+
+    for (i = 0; i < HG_TEST_NUM_THREADS_DEFAULT; i++)
+        hg_thread_join(thread[i]);
+
+done:
+    hg_eventcount_destroy(&ec);
+
+    return ret;
+}
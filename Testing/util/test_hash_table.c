@@ -1,10 +1,28 @@
 #include "mercury_hash_table.h"
+#ifdef HG_UTIL_HAS_OA_HASH_TABLE
+#    include "mercury_atomic.h"
+#    include "mercury_thread.h"
+#endif
 
 #include "mercury_test_config.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 
+#define HASH_TABLE_NUM_KEYS 10000
+
+#ifdef HG_UTIL_HAS_OA_HASH_TABLE
+#    define HASH_TABLE_NUM_READERS 4
+#    define HASH_TABLE_NUM_ROUNDS  10
+
+struct concurrent_arg {
+    hg_hash_table_t *hash_table;
+    int *keys;
+    hg_atomic_int32_t done;
+    hg_atomic_int32_t errors;
+};
+#endif
+
 static int
 int_equal(hg_hash_table_key_t vlocation1, hg_hash_table_key_t vlocation2)
 {
@@ -29,6 +47,97 @@ int_hash_value_free(hg_hash_table_value_t value)
     free((int *) value);
 }
 
+#ifdef HG_UTIL_HAS_OA_HASH_TABLE
+static HG_THREAD_RETURN_TYPE
+concurrent_lookup_cb(void *arg)
+{
+    hg_thread_ret_t thread_ret = (hg_thread_ret_t) 0;
+    struct concurrent_arg *concurrent_arg = (struct concurrent_arg *) arg;
+    hg_util_int32_t done;
+    int i;
+
+    /* Lookups race with inserts, removals and growth of the table, a value
+     * may or may not be found but must never be another key's */
+    do {
+        done = hg_atomic_get32(&concurrent_arg->done);
+        for (i = 0; i < HASH_TABLE_NUM_KEYS; i++) {
+            int *value = (int *) hg_hash_table_lookup_concurrent(
+                concurrent_arg->hash_table, &concurrent_arg->keys[i]);
+
+            if (value != HG_HASH_TABLE_NULL && *value != i) {
+                fprintf(stderr, "Error: key %d returned value %d\n", i, *value);
+                hg_atomic_incr32(&concurrent_arg->errors);
+                goto done;
+            }
+            /* Writer is done, table must be stable */
+            if (done && (i % 2 == 0) != (value == HG_HASH_TABLE_NULL)) {
+                fprintf(stderr, "Error: unexpected lookup result for key %d\n",
+                    i);
+                hg_atomic_incr32(&concurrent_arg->errors);
+                goto done;
+            }
+        }
+    } while (!done);
+
+done:
+    hg_thread_exit(thread_ret);
+    return thread_ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+concurrent_lookup_test(int *keys)
+{
+    hg_thread_t threads[HASH_TABLE_NUM_READERS];
+    struct concurrent_arg concurrent_arg;
+    int i, round, nthreads = 0, ret = EXIT_SUCCESS;
+
+    concurrent_arg.hash_table =
+        hg_hash_table_new_concurrent(int_hash, int_equal);
+    if (concurrent_arg.hash_table == NULL) {
+        fprintf(stderr, "Error: could not create concurrent hash table\n");
+        return EXIT_FAILURE;
+    }
+    for (i = 0; i < HASH_TABLE_NUM_KEYS; i++)
+        keys[i] = i;
+    concurrent_arg.keys = keys;
+    hg_atomic_init32(&concurrent_arg.done, 0);
+    hg_atomic_init32(&concurrent_arg.errors, 0);
+
+    for (i = 0; i < HASH_TABLE_NUM_READERS; i++) {
+        if (hg_thread_create(&threads[i], concurrent_lookup_cb,
+                &concurrent_arg) != HG_UTIL_SUCCESS) {
+            fprintf(stderr, "Error: could not create thread\n");
+            ret = EXIT_FAILURE;
+            break;
+        }
+        nthreads++;
+    }
+
+    /* Single writer, table grows several times during the first round, later
+     * rounds reuse deleted slots */
+    for (round = 0; round < HASH_TABLE_NUM_ROUNDS; round++) {
+        for (i = 0; i < HASH_TABLE_NUM_KEYS; i++)
+            hg_hash_table_insert(
+                concurrent_arg.hash_table, &keys[i], &keys[i]);
+        for (i = 0; i < HASH_TABLE_NUM_KEYS; i += 2)
+            hg_hash_table_remove(concurrent_arg.hash_table, &keys[i]);
+        hg_thread_yield();
+    }
+    hg_atomic_set32(&concurrent_arg.done, 1);
+
+    for (i = 0; i < nthreads; i++)
+        hg_thread_join(threads[i]);
+
+    if (hg_atomic_get32(&concurrent_arg.errors) != 0)
+        ret = EXIT_FAILURE;
+
+    hg_hash_table_free(concurrent_arg.hash_table);
+
+    return ret;
+}
+#endif
+
 /*---------------------------------------------------------------------------*/
 
 int
@@ -39,7 +148,8 @@ main(int argc, char *argv[])
 
     int *key1, *key2;
     int *value1, *value2;
-    int ret = EXIT_SUCCESS;
+    int keys[HASH_TABLE_NUM_KEYS];
+    int i, ret = EXIT_SUCCESS;
 
     (void) argc;
     (void) argv;
@@ -95,6 +205,37 @@ main(int argc, char *argv[])
         ret = EXIT_FAILURE;
         goto done;
     }
+    hg_hash_table_free(hash_table);
+
+    /* Grow table and remove every other key */
+    hash_table = hg_hash_table_new(int_hash, int_equal);
+    for (i = 0; i < HASH_TABLE_NUM_KEYS; i++) {
+        keys[i] = i;
+        hg_hash_table_insert(hash_table, &keys[i], &keys[i]);
+    }
+    for (i = 0; i < HASH_TABLE_NUM_KEYS; i += 2)
+        hg_hash_table_remove(hash_table, &keys[i]);
+
+    if (HASH_TABLE_NUM_KEYS / 2 != hg_hash_table_num_entries(hash_table)) {
+        fprintf(stderr, "Error: was expecting %d entries, got %u\n",
+            HASH_TABLE_NUM_KEYS / 2, hg_hash_table_num_entries(hash_table));
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    for (i = 0; i < HASH_TABLE_NUM_KEYS; i++) {
+        int *value = (int *) hg_hash_table_lookup(hash_table, &keys[i]);
+
+        if ((i % 2 == 0 && value != HG_HASH_TABLE_NULL) ||
+            (i % 2 == 1 && (value == HG_HASH_TABLE_NULL || *value != i))) {
+            fprintf(stderr, "Error: unexpected lookup result for key %d\n", i);
+            ret = EXIT_FAILURE;
+            goto done;
+        }
+    }
+
+#ifdef HG_UTIL_HAS_OA_HASH_TABLE
+    ret = concurrent_lookup_test(keys);
+#endif
 
 done:
     hg_hash_table_free(hash_table);
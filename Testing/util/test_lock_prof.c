@@ -0,0 +1,207 @@
+#include "mercury_thread.h"
+#include "mercury_thread_lock_prof.h"
+
+#include "mercury_test_config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NTHREADS 4
+#define NLOOPS   10000
+
+static hg_thread_spin_t thread_spin;
+static hg_thread_mutex_t thread_mutex;
+static hg_thread_rwlock_t thread_rwlock;
+static hg_thread_lock_prof_t spin_prof;
+static hg_thread_lock_prof_t mutex_prof;
+static hg_thread_lock_prof_t rwlock_prof;
+static int spin_value = 0;
+static int mutex_value = 0;
+static int rwlock_value = 0;
+
+static HG_THREAD_RETURN_TYPE
+thread_cb_locks(void *arg)
+{
+    hg_thread_ret_t thread_ret = (hg_thread_ret_t) 0;
+    int i;
+
+    (void) arg;
+
+    for (i = 0; i < NLOOPS; i++) {
+        hg_thread_spin_lock_prof(&thread_spin, spin_prof);
+        spin_value++;
+        hg_thread_spin_unlock(&thread_spin);
+
+        hg_thread_mutex_lock_prof(&thread_mutex, mutex_prof);
+        mutex_value++;
+        hg_thread_mutex_unlock(&thread_mutex);
+
+        hg_thread_rwlock_wrlock_prof(&thread_rwlock, rwlock_prof);
+        rwlock_value++;
+        hg_thread_rwlock_release_wrlock(&thread_rwlock);
+
+        hg_thread_rwlock_rdlock_prof(&thread_rwlock, rwlock_prof);
+        hg_thread_rwlock_release_rdlock(&thread_rwlock);
+    }
+
+    hg_thread_exit(thread_ret);
+    return thread_ret;
+}
+
+static HG_THREAD_RETURN_TYPE
+thread_cb_wait(void *arg)
+{
+    hg_thread_ret_t thread_ret = (hg_thread_ret_t) 0;
+
+    (void) arg;
+
+    hg_thread_mutex_lock_prof(&thread_mutex, mutex_prof);
+    mutex_value++;
+    hg_thread_mutex_unlock(&thread_mutex);
+
+    hg_thread_exit(thread_ret);
+    return thread_ret;
+}
+
+#ifdef HG_UTIL_HAS_LOCK_PROF
+static const struct hg_thread_lock_prof_info *
+find_info(const struct hg_thread_lock_prof_info *info, unsigned int count,
+    const char *name)
+{
+    unsigned int i;
+
+    for (i = 0; i < count; i++)
+        if (strcmp(info[i].name, name) == 0)
+            return &info[i];
+
+    return NULL;
+}
+#endif
+
+int
+main(int argc, char *argv[])
+{
+    struct hg_thread_lock_prof_info info[HG_THREAD_LOCK_PROF_MAX];
+    hg_thread_t threads[NTHREADS], thread;
+    unsigned int count;
+    int ret = EXIT_SUCCESS;
+    int i;
+
+    (void) argc;
+    (void) argv;
+
+    hg_thread_spin_init(&thread_spin);
+    hg_thread_mutex_init(&thread_mutex);
+    hg_thread_rwlock_init(&thread_rwlock);
+
+    /* Profiles are registered once, at lock init */
+    spin_prof = hg_thread_lock_prof_register("test.spin");
+    mutex_prof = hg_thread_lock_prof_register("test.mutex");
+    rwlock_prof = hg_thread_lock_prof_register("test.rwlock");
+
+#ifdef HG_UTIL_HAS_LOCK_PROF
+    if (spin_prof == NULL || mutex_prof == NULL || rwlock_prof == NULL) {
+        fprintf(stderr, "Error: could not register lock profiles\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    if (spin_prof == mutex_prof || mutex_prof == rwlock_prof) {
+        fprintf(stderr, "Error: distinct names share a profile\n");
+        ret = EXIT_FAILURE;
+    }
+    if (hg_thread_lock_prof_register("test.spin") != spin_prof) {
+        fprintf(stderr, "Error: same name registered twice\n");
+        ret = EXIT_FAILURE;
+    }
+#else
+    if (spin_prof != NULL || mutex_prof != NULL || rwlock_prof != NULL) {
+        fprintf(stderr, "Error: profiles registered while disabled\n");
+        ret = EXIT_FAILURE;
+    }
+#endif
+
+    for (i = 0; i < NTHREADS; i++)
+        hg_thread_create(&threads[i], thread_cb_locks, NULL);
+    for (i = 0; i < NTHREADS; i++)
+        hg_thread_join(threads[i]);
+
+    /* Force one contended acquisition */
+    hg_thread_mutex_lock(&thread_mutex);
+    hg_thread_create(&thread, thread_cb_wait, NULL);
+    hg_time_sleep(hg_time_from_double(0.1));
+    hg_thread_mutex_unlock(&thread_mutex);
+    hg_thread_join(thread);
+
+    if (spin_value != NTHREADS * NLOOPS || mutex_value != NTHREADS * NLOOPS + 1
+        || rwlock_value != NTHREADS * NLOOPS) {
+        fprintf(stderr, "Error: values are %d, %d, %d\n", spin_value,
+            mutex_value, rwlock_value);
+        ret = EXIT_FAILURE;
+    }
+
+    count = hg_thread_lock_prof_get(info, HG_THREAD_LOCK_PROF_MAX);
+#ifdef HG_UTIL_HAS_LOCK_PROF
+    {
+        const struct hg_thread_lock_prof_info *spin_info =
+            find_info(info, count, "test.spin");
+        const struct hg_thread_lock_prof_info *mutex_info =
+            find_info(info, count, "test.mutex");
+        const struct hg_thread_lock_prof_info *rwlock_info =
+            find_info(info, count, "test.rwlock");
+
+        if (count != 3 || !spin_info || !mutex_info || !rwlock_info) {
+            fprintf(stderr, "Error: %u profiles returned\n", count);
+            ret = EXIT_FAILURE;
+            goto done;
+        }
+        if (spin_info->acquire_count != (hg_util_uint64_t) (NTHREADS * NLOOPS)
+            || mutex_info->acquire_count !=
+                   (hg_util_uint64_t) (NTHREADS * NLOOPS + 1)
+            || rwlock_info->acquire_count !=
+                   (hg_util_uint64_t) (2 * NTHREADS * NLOOPS)) {
+            fprintf(stderr, "Error: acquire counts are %llu, %llu, %llu\n",
+                (unsigned long long) spin_info->acquire_count,
+                (unsigned long long) mutex_info->acquire_count,
+                (unsigned long long) rwlock_info->acquire_count);
+            ret = EXIT_FAILURE;
+        }
+        if (mutex_info->contended_count == 0 || mutex_info->wait_ns == 0) {
+            fprintf(stderr, "Error: contended acquisition not accounted\n");
+            ret = EXIT_FAILURE;
+        }
+        if (info[0].wait_ns < info[1].wait_ns ||
+            info[1].wait_ns < info[2].wait_ns) {
+            fprintf(stderr, "Error: profiles not sorted by wait time\n");
+            ret = EXIT_FAILURE;
+        }
+    }
+
+    /* Names are kept on reset */
+    hg_thread_lock_prof_reset();
+    count = hg_thread_lock_prof_get(info, HG_THREAD_LOCK_PROF_MAX);
+    for (i = 0; i < (int) count; i++) {
+        if (info[i].acquire_count || info[i].contended_count ||
+            info[i].wait_ns) {
+            fprintf(stderr, "Error: %s not reset\n", info[i].name);
+            ret = EXIT_FAILURE;
+        }
+    }
+    if (count != 3) {
+        fprintf(stderr, "Error: %u profiles after reset\n", count);
+        ret = EXIT_FAILURE;
+    }
+
+done:
+#else
+    if (count != 0) {
+        fprintf(stderr, "Error: %u profiles returned while disabled\n", count);
+        ret = EXIT_FAILURE;
+    }
+#endif
+    hg_thread_rwlock_destroy(&thread_rwlock);
+    hg_thread_mutex_destroy(&thread_mutex);
+    hg_thread_spin_destroy(&thread_spin);
+
+    return ret;
+}
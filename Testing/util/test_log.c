@@ -0,0 +1,192 @@
+#include "mercury_log.h"
+#include "mercury_thread.h"
+
+#include "mercury_test_config.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NTHREADS 4
+#define NLOGS    100
+
+static char log_buf[4096];
+static const char *log_msg = "";
+static int log_count = 0;
+
+static int
+log_func(FILE *stream, const char *format, ...)
+{
+    va_list ap;
+    char *msg;
+    int ret;
+
+    (void) stream;
+
+    va_start(ap, format);
+    ret = vsnprintf(log_buf, sizeof(log_buf), format, ap);
+    va_end(ap);
+    log_count++;
+
+    /* Message follows "main(): " (or its colored variant) */
+    msg = strstr(log_buf, "main()");
+    msg = (msg) ? strstr(msg, ": ") : NULL;
+    if (msg) {
+        msg += 2;
+        msg[strcspn(msg, "\n")] = '\0';
+        log_msg = msg;
+    } else
+        log_msg = "";
+
+    return ret;
+}
+
+static int
+check_format(const char *expected, const char *format, ...)
+{
+    char buf[256];
+    va_list ap;
+
+    va_start(ap, format);
+    vsnprintf(buf, sizeof(buf), format, ap);
+    va_end(ap);
+
+    if (strcmp(buf, expected) != 0) {
+        fprintf(stderr, "Error: vsnprintf gives \"%s\"\n", buf);
+        return EXIT_FAILURE;
+    }
+    if (strcmp(log_msg, expected) != 0) {
+        fprintf(stderr, "Error: expected \"%s\", got \"%s\"\n", expected,
+            log_msg);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+static HG_THREAD_RETURN_TYPE
+thread_cb_log(void *arg)
+{
+    hg_thread_ret_t thread_ret = (hg_thread_ret_t) 0;
+    int i;
+
+    (void) arg;
+
+    for (i = 0; i < NLOGS; i++)
+        hg_log_write(HG_LOG_TYPE_DEBUG, "Test", __FILE__, __LINE__, __func__,
+            "message %d", i);
+
+    hg_thread_exit(thread_ret);
+    return thread_ret;
+}
+
+static HG_THREAD_RETURN_TYPE
+thread_cb_set_async(void *arg)
+{
+    hg_thread_ret_t thread_ret = (hg_thread_ret_t) 0;
+
+    (void) arg;
+
+    if (hg_log_set_async(HG_UTIL_TRUE, 0) != HG_UTIL_SUCCESS)
+        fprintf(stderr, "Error: could not enable async logging\n");
+
+    hg_thread_exit(thread_ret);
+    return thread_ret;
+}
+
+int
+main(int argc, char *argv[])
+{
+    hg_thread_t threads[NTHREADS];
+    const char *null_str = NULL;
+    unsigned int mask;
+    int ret = EXIT_SUCCESS;
+    int i;
+
+    (void) argc;
+    (void) argv;
+
+    hg_log_set_func(log_func);
+
+    if (hg_log_level_to_mask("warning", &mask) != HG_UTIL_SUCCESS ||
+        mask != (HG_LOG_TYPE_ERROR | HG_LOG_TYPE_WARNING)) {
+        fprintf(stderr, "Error: could not convert log level\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+    if (hg_log_set_async(HG_UTIL_TRUE, 0) != HG_UTIL_SUCCESS) {
+        fprintf(stderr, "Error: could not enable async logging\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+    /* Formats are replayed from binary records */
+    hg_log_write(HG_LOG_TYPE_DEBUG, "Test", __FILE__, __LINE__, __func__,
+        "%d %5u %-3x|%lld %zu %c %.2f %s %*d %.*s %% %s", -1, 2U, 0xaU,
+        -4LL, (size_t) 5, 'c', 0.25, "str", 4, 7, 2, "abc", null_str);
+    hg_log_flush();
+    if (check_format("-1     2 a  |-4 5 c 0.25 str    7 ab % (null)",
+            "%d %5u %-3x|%lld %zu %c %.2f %s %*d %.*s %% %s", -1, 2U, 0xaU,
+            -4LL, (size_t) 5, 'c', 0.25, "str", 4, 7, 2, "abc",
+            null_str) != EXIT_SUCCESS) {
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+    /* Records from multiple threads are all written */
+    log_count = 0;
+    for (i = 0; i < NTHREADS; i++)
+        hg_thread_create(&threads[i], thread_cb_log, NULL);
+    for (i = 0; i < NTHREADS; i++)
+        hg_thread_join(threads[i]);
+    hg_log_flush();
+    if (log_count != NTHREADS * NLOGS) {
+        fprintf(stderr, "Error: %d messages logged\n", log_count);
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+    hg_log_set_async(HG_UTIL_FALSE, 0);
+
+    /* Rate limiting per call site */
+    hg_log_set_rate_limit(2, 60000);
+    log_count = 0;
+    for (i = 0; i < 10; i++)
+        HG_LOG_WRITE_DEBUG("Test", "rate limited %d", i);
+    if (log_count != 2) {
+        fprintf(stderr, "Error: %d messages logged\n", log_count);
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+    /* Errors are not rate limited */
+    log_count = 0;
+    for (i = 0; i < 10; i++)
+        HG_LOG_WRITE_ERROR("Test", "not rate limited %d", i);
+    hg_log_set_rate_limit(0, 0);
+    if (log_count != 10) {
+        fprintf(stderr, "Error: %d errors logged\n", log_count);
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+    /* Async logging can be re-enabled, concurrent calls start one thread */
+    for (i = 0; i < NTHREADS; i++)
+        hg_thread_create(&threads[i], thread_cb_set_async, NULL);
+    for (i = 0; i < NTHREADS; i++)
+        hg_thread_join(threads[i]);
+    log_count = 0;
+    HG_LOG_WRITE_DEBUG("Test", "async %d", 1);
+    hg_log_set_async(HG_UTIL_FALSE, 0);
+    if (log_count != 1 || strcmp(log_msg, "async 1") != 0) {
+        fprintf(stderr, "Error: expected \"async 1\", got \"%s\"\n",
+            log_msg);
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+done:
+    return ret;
+}
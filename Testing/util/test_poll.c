@@ -1,11 +1,117 @@
 #include "mercury_event.h"
 #include "mercury_poll.h"
+#include "mercury_thread.h"
 
 #include "mercury_test_config.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 
+struct poll_wait_arg {
+    hg_poll_set_t *poll_set;
+    struct hg_poll_event event;
+    unsigned int nevents;
+};
+
+static HG_THREAD_RETURN_TYPE
+poll_wait_cb(void *arg)
+{
+    hg_thread_ret_t thread_ret = (hg_thread_ret_t) 0;
+    struct poll_wait_arg *poll_wait_arg = (struct poll_wait_arg *) arg;
+
+    hg_poll_wait(poll_wait_arg->poll_set, 5000, 1, &poll_wait_arg->event,
+        &poll_wait_arg->nevents);
+
+    hg_thread_exit(thread_ret);
+    return thread_ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+poll_exclusive_test(void)
+{
+    hg_poll_set_t *poll_sets[2] = {NULL, NULL};
+    struct poll_wait_arg poll_wait_arg;
+    struct hg_poll_event event, events[2];
+    hg_thread_t thread;
+    unsigned int nevents = 0, expected_nevents = 1;
+    hg_util_bool_t signaled = HG_UTIL_FALSE;
+    int event_fd, ret = EXIT_SUCCESS;
+
+    poll_sets[0] = hg_poll_create();
+    poll_sets[1] = hg_poll_create();
+    event_fd = hg_event_create();
+
+    /* Same fd in two poll sets */
+    event.events = HG_POLLIN | HG_POLLEXCLUSIVE;
+    event.data.u32 = 1;
+    if (hg_poll_add(poll_sets[0], event_fd, &event) != HG_UTIL_SUCCESS ||
+        hg_poll_add(poll_sets[1], event_fd, &event) != HG_UTIL_SUCCESS) {
+        fprintf(stderr, "Error: could not add exclusive fd\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+#ifdef HG_UTIL_HAS_SYSEPOLL_H
+    /* Epoll fds cannot be added exclusively, flag must be dropped */
+    event.data.u32 = 2;
+    if (hg_poll_add(poll_sets[0], hg_poll_get_fd(poll_sets[1]), &event) !=
+        HG_UTIL_SUCCESS) {
+        fprintf(stderr, "Error: could not add poll fd\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    expected_nevents = 2;
+#endif
+
+    /* Blocked waiter is woken up */
+    poll_wait_arg.poll_set = poll_sets[1];
+    poll_wait_arg.nevents = 0;
+    hg_thread_create(&thread, poll_wait_cb, &poll_wait_arg);
+    hg_thread_yield();
+    hg_event_set(event_fd);
+    hg_thread_join(thread);
+    if (poll_wait_arg.nevents != 1 || poll_wait_arg.event.data.u32 != 1) {
+        fprintf(stderr, "Error: exclusive waiter was not woken up\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+    /* Fd is reported directly and through the nested poll set */
+    hg_poll_wait(poll_sets[0], 0, 2, events, &nevents);
+    if (nevents != expected_nevents) {
+        fprintf(stderr, "Error: expected %u events, got %u\n",
+            expected_nevents, nevents);
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    hg_event_get(event_fd, &signaled);
+    if (!signaled) {
+        fprintf(stderr, "Error: should have been signaled\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+    /* Exclusive fds can be removed */
+    if (hg_poll_remove(poll_sets[0], event_fd) != HG_UTIL_SUCCESS ||
+        hg_poll_remove(poll_sets[1], event_fd) != HG_UTIL_SUCCESS) {
+        fprintf(stderr, "Error: could not remove exclusive fd\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+#ifdef HG_UTIL_HAS_SYSEPOLL_H
+    hg_poll_remove(poll_sets[0], hg_poll_get_fd(poll_sets[1]));
+#endif
+
+done:
+    hg_poll_destroy(poll_sets[0]);
+    hg_poll_destroy(poll_sets[1]);
+    hg_event_destroy(event_fd);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
 int
 main(void)
 {
@@ -133,6 +239,8 @@ main(void)
         goto done;
     }
 
+    ret = poll_exclusive_test();
+
 done:
     hg_poll_remove(poll_set, event_fd1);
     hg_poll_remove(poll_set, event_fd2);
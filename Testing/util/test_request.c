@@ -1,11 +1,17 @@
 #include "mercury_request.h"
+#include "mercury_thread.h"
 
 #include "mercury_test_config.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 
+#define NTHREADS 8
+
 static hg_request_t *request;
+static hg_request_t *thread_requests[NTHREADS];
+static hg_atomic_int32_t next_request;
+static hg_atomic_int32_t completed_count;
 
 static int progressed = 0;
 static int triggered = 0;
@@ -52,6 +58,79 @@ trigger(unsigned int timeout, unsigned int *flag, void *arg)
     return HG_UTIL_SUCCESS;
 }
 
+static int
+progress_threads(unsigned int timeout, void *arg)
+{
+    hg_util_int32_t i = hg_atomic_incr32(&next_request) - 1;
+
+    (void) timeout;
+    (void) arg;
+
+    /* Complete one request each time progress is made */
+    if (i < NTHREADS)
+        hg_request_complete(thread_requests[i]);
+
+    return HG_UTIL_SUCCESS;
+}
+
+static int
+trigger_threads(unsigned int timeout, unsigned int *flag, void *arg)
+{
+    (void) timeout;
+    (void) arg;
+    *flag = 0;
+
+    return HG_UTIL_SUCCESS;
+}
+
+static HG_THREAD_RETURN_TYPE
+thread_cb_wait(void *arg)
+{
+    hg_thread_ret_t thread_ret = (hg_thread_ret_t) 0;
+    hg_request_t *thread_request = (hg_request_t *) arg;
+    unsigned int flag = 0;
+
+    hg_request_wait(thread_request, 10000, &flag);
+    if (flag)
+        hg_atomic_incr32(&completed_count);
+
+    hg_thread_exit(thread_ret);
+    return thread_ret;
+}
+
+static int
+test_threads(void)
+{
+    hg_request_class_t *request_class;
+    hg_thread_t threads[NTHREADS];
+    int ret = EXIT_SUCCESS;
+    int i;
+
+    hg_atomic_init32(&next_request, 0);
+    hg_atomic_init32(&completed_count, 0);
+    request_class = hg_request_init(progress_threads, trigger_threads, NULL);
+    for (i = 0; i < NTHREADS; i++)
+        thread_requests[i] = hg_request_create(request_class);
+
+    /* Each thread waits on its own request */
+    for (i = 0; i < NTHREADS; i++)
+        hg_thread_create(&threads[i], thread_cb_wait, thread_requests[i]);
+    for (i = 0; i < NTHREADS; i++)
+        hg_thread_join(threads[i]);
+
+    if (hg_atomic_get32(&completed_count) != NTHREADS) {
+        fprintf(stderr, "Only %d requests completed\n",
+            hg_atomic_get32(&completed_count));
+        ret = EXIT_FAILURE;
+    }
+
+    for (i = 0; i < NTHREADS; i++)
+        hg_request_destroy(thread_requests[i]);
+    hg_request_finalize(request_class, NULL);
+
+    return ret;
+}
+
 int
 main(int argc, char *argv[])
 {
@@ -80,5 +159,8 @@ main(int argc, char *argv[])
     hg_request_destroy(request);
     hg_request_finalize(request_class, NULL);
 
+    if (test_threads() != EXIT_SUCCESS)
+        ret = EXIT_FAILURE;
+
     return ret;
 }
@@ -6,8 +6,17 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#define NTHREADS 4
+#define NLOOPS   10000
+
 static hg_thread_spin_t thread_spin;
+static hg_thread_ticket_t thread_ticket;
+static hg_thread_mcs_t thread_mcs;
+static hg_thread_adaptive_t thread_adaptive;
 static int thread_value = 0;
+static int ticket_value = 0;
+static int mcs_value = 0;
+static int adaptive_value = 0;
 
 static HG_THREAD_RETURN_TYPE
 thread_cb_mutex(void *arg)
@@ -27,11 +36,41 @@ thread_cb_mutex(void *arg)
     return thread_ret;
 }
 
+static HG_THREAD_RETURN_TYPE
+thread_cb_locks(void *arg)
+{
+    hg_thread_ret_t thread_ret = (hg_thread_ret_t) 0;
+    struct hg_thread_mcs_node node;
+    int i;
+
+    (void) arg;
+
+    for (i = 0; i < NLOOPS; i++) {
+        if (hg_thread_ticket_try_lock(&thread_ticket) != HG_UTIL_SUCCESS)
+            hg_thread_ticket_lock(&thread_ticket);
+        ticket_value++;
+        hg_thread_ticket_unlock(&thread_ticket);
+
+        hg_thread_mcs_lock(&thread_mcs, &node);
+        mcs_value++;
+        hg_thread_mcs_unlock(&thread_mcs, &node);
+
+        if (hg_thread_adaptive_try_lock(&thread_adaptive) != HG_UTIL_SUCCESS)
+            hg_thread_adaptive_lock(&thread_adaptive);
+        adaptive_value++;
+        hg_thread_adaptive_unlock(&thread_adaptive);
+    }
+
+    hg_thread_exit(thread_ret);
+    return thread_ret;
+}
+
 int
 main(int argc, char *argv[])
 {
-    hg_thread_t thread1, thread2;
+    hg_thread_t thread1, thread2, threads[NTHREADS];
     int ret = EXIT_SUCCESS;
+    int i;
 
     (void) argc;
     (void) argv;
@@ -51,5 +90,38 @@ main(int argc, char *argv[])
     }
 
     hg_thread_spin_destroy(&thread_spin);
+
+    /* Ticket, MCS and adaptive locks */
+    hg_thread_ticket_init(&thread_ticket);
+    hg_thread_mcs_init(&thread_mcs);
+    hg_thread_adaptive_init(&thread_adaptive);
+
+    for (i = 0; i < NTHREADS; i++)
+        hg_thread_create(&threads[i], thread_cb_locks, NULL);
+    for (i = 0; i < NTHREADS; i++)
+        hg_thread_join(threads[i]);
+
+    if (ticket_value != NTHREADS * NLOOPS) {
+        fprintf(stderr, "Error: ticket value is %d\n", ticket_value);
+        ret = EXIT_FAILURE;
+    }
+    if (mcs_value != NTHREADS * NLOOPS) {
+        fprintf(stderr, "Error: mcs value is %d\n", mcs_value);
+        ret = EXIT_FAILURE;
+    }
+    if (adaptive_value != NTHREADS * NLOOPS) {
+        fprintf(stderr, "Error: adaptive value is %d\n", adaptive_value);
+        ret = EXIT_FAILURE;
+    }
+
+#ifdef HG_UTIL_HAS_LOCK_STATS
+    if (thread_ticket.stats.acquire_count !=
+        (hg_util_uint64_t) (NTHREADS * NLOOPS)) {
+        fprintf(stderr, "Error: ticket acquire count is %llu\n",
+            (unsigned long long) thread_ticket.stats.acquire_count);
+        ret = EXIT_FAILURE;
+    }
+#endif
+
     return ret;
 }
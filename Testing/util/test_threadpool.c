@@ -28,12 +28,17 @@ myfunc(void *args)
 
 static unsigned int ncalls = 0;
 static hg_thread_mutex_t mymutex;
+static hg_thread_pool_t *thread_pool;
 
 static HG_THREAD_RETURN_TYPE
 myfunc(void *args)
 {
     hg_thread_ret_t ret = 0;
-    (void) args;
+    struct hg_thread_work *child = (struct hg_thread_work *) args;
+
+    /* Post nested work from worker thread */
+    if (child)
+        hg_thread_pool_post(thread_pool, child);
 
     hg_thread_mutex_lock(&mymutex);
     ncalls++;
@@ -47,8 +52,9 @@ int
 main(int argc, char *argv[])
 {
     int i;
-    hg_thread_pool_t *thread_pool;
-    struct hg_thread_work work[POOL_NUM_POSTS];
+    struct hg_thread_work work[POOL_NUM_POSTS], child_work[POOL_NUM_POSTS];
+    struct hg_thread_pool_stats stats;
+    hg_util_uint64_t executed = 0;
     int ret = EXIT_SUCCESS;
 
     (void) argc;
@@ -57,18 +63,31 @@ main(int argc, char *argv[])
     hg_thread_pool_init(HG_TEST_NUM_THREADS_DEFAULT, &thread_pool);
 
     for (i = 0; i < POOL_NUM_POSTS; i++) {
+        child_work[i].func = myfunc;
+        child_work[i].args = NULL;
         work[i].func = myfunc;
-        work[i].args = NULL;
+        work[i].args = &child_work[i];
         hg_thread_pool_post(thread_pool, &work[i]);
     }
 
+    /* Wait for nested posts to complete before shutting down */
+    while (executed != 2 * POOL_NUM_POSTS) {
+        hg_thread_yield();
+        for (i = 0, executed = 0; i < HG_TEST_NUM_THREADS_DEFAULT; i++) {
+            if (hg_thread_pool_get_stats(
+                    thread_pool, (unsigned int) i, &stats) != HG_UTIL_SUCCESS)
+                break;
+            executed += stats.executed;
+        }
+    }
+
     /* printf("Finalizing...\n"); */
     hg_thread_pool_destroy(thread_pool);
     hg_thread_mutex_destroy(&mymutex);
 
-    if (ncalls != POOL_NUM_POSTS) {
+    if (ncalls != 2 * POOL_NUM_POSTS) {
         fprintf(stderr, "Did not execute all the operations posted (%u/%d)\n",
-            ncalls, POOL_NUM_POSTS);
+            ncalls, 2 * POOL_NUM_POSTS);
         ret = EXIT_FAILURE;
     }
     return ret;
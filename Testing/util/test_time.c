@@ -11,8 +11,9 @@ main(int argc, char *argv[])
 {
     hg_time_t t1, t2, diff1, diff2;
     hg_time_t sleep_time = {1, 0};
+    hg_time_fast_t f1, f2;
     double epsilon = 1e-9;
-    double t1_double, t2_double;
+    double t1_double, t2_double, fast_diff;
     int ret = EXIT_SUCCESS;
 
     (void) argc;
@@ -21,9 +22,11 @@ main(int argc, char *argv[])
     printf("Current time: %s\n", hg_time_stamp());
 
     hg_time_get_current(&t1);
+    f1 = hg_time_fast_now();
 
     hg_time_sleep(sleep_time);
 
+    f2 = hg_time_fast_now();
     hg_time_get_current(&t2);
 
     /* Should have slept at least sleep_time */
@@ -63,6 +66,20 @@ main(int argc, char *argv[])
         goto done;
     }
 
+    /* Fast clock should agree with monotonic clock within 1% */
+    fast_diff = hg_time_fast_diff(f2, f1);
+    if (fabs(fast_diff - hg_time_diff(t2, t1)) > 0.01 * hg_time_diff(t2, t1)) {
+        fprintf(stderr, "Error: fast clock diff is %f, clock diff is %f\n",
+            fast_diff, hg_time_diff(t2, t1));
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+    if (hg_time_fast_to_ns(f2 - f1) < 990000000) {
+        fprintf(stderr, "Error: fast clock did not advance by sleep time\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
 done:
     return ret;
 }
@@ -0,0 +1,214 @@
+#include "mercury_timer_wheel.h"
+#include "mercury_time.h"
+
+#include "mercury_test_config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NTIMERS_SMALL 1000
+#define NTIMERS       100000
+#define NREPS         5
+
+/* Max ratio between per-timer cost at NTIMERS and at NTIMERS_SMALL */
+#define MAX_COST_RATIO 8.0
+
+static unsigned int
+rand_next(unsigned int *seed)
+{
+    *seed = *seed * 1103515245 + 12345;
+    return (*seed >> 8);
+}
+
+static int
+check_order(struct hg_timer_wheel_node *nodes)
+{
+    struct hg_timer_wheel wheel;
+    struct hg_timer_wheel_node *node;
+    hg_util_uint64_t expected[] = {1, 2, 3, 5, 6, 7, 8, 9, 11};
+    unsigned int i, count = 0;
+
+    /* Armed in reverse order */
+    hg_timer_wheel_init(&wheel, 0);
+    for (i = 10; i > 0; i--) {
+        hg_timer_wheel_node_init(&nodes[i]);
+        hg_timer_wheel_arm(&wheel, &nodes[i], i);
+    }
+    hg_timer_wheel_advance(&wheel, 10);
+
+    /* Disarm expired timers, including last one */
+    hg_timer_wheel_disarm(&wheel, &nodes[4]);
+    hg_timer_wheel_disarm(&wheel, &nodes[10]);
+
+    hg_timer_wheel_node_init(&nodes[11]);
+    hg_timer_wheel_arm(&wheel, &nodes[11], 11);
+    hg_timer_wheel_advance(&wheel, 11);
+
+    while ((node = hg_timer_wheel_pop(&wheel)) != NULL) {
+        if (count == sizeof(expected) / sizeof(expected[0]) ||
+            node->expire != expected[count]) {
+            fprintf(stderr, "Error: timer %u expired out of order\n",
+                (unsigned int) (node - nodes));
+            return EXIT_FAILURE;
+        }
+        count++;
+    }
+    if (count != sizeof(expected) / sizeof(expected[0])) {
+        fprintf(stderr, "Error: %u timers expired\n", count);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+static int
+check_expire(struct hg_timer_wheel_node *nodes, unsigned int n)
+{
+    struct hg_timer_wheel wheel;
+    struct hg_timer_wheel_node *node;
+    hg_util_uint64_t start = 123456789, now = start, prev, last;
+    unsigned int seed = 42, i, expired = 0, disarmed = 0, fired = 0;
+
+    hg_timer_wheel_init(&wheel, now);
+
+    /* Mostly short timers, some beyond range of the wheel */
+    for (i = 0; i < n; i++) {
+        hg_util_uint64_t delta = (i % 100 == 0)
+                                     ? ((hg_util_uint64_t) 1 << 24) +
+                                           rand_next(&seed) % 1000000
+                                     : rand_next(&seed) % 300000;
+
+        hg_timer_wheel_node_init(&nodes[i]);
+        hg_timer_wheel_arm(&wheel, &nodes[i], now + delta);
+    }
+
+    /* Disarm some */
+    for (i = 0; i < n; i += 7) {
+        hg_timer_wheel_disarm(&wheel, &nodes[i]);
+        disarmed++;
+    }
+
+    while (fired + disarmed < n) {
+        prev = now;
+        now += 1 + rand_next(&seed) % 5000;
+        expired = hg_timer_wheel_advance(&wheel, now);
+
+        last = prev;
+        while ((node = hg_timer_wheel_pop(&wheel)) != NULL) {
+            unsigned int index = (unsigned int) (node - nodes);
+
+            if (index % 7 == 0) {
+                fprintf(stderr, "Error: disarmed timer %u expired\n", index);
+                return EXIT_FAILURE;
+            }
+            if (node->expire > now || node->expire <= prev) {
+                fprintf(stderr,
+                    "Error: timer %u expired at %llu, should be %llu\n", index,
+                    (unsigned long long) (now - start),
+                    (unsigned long long) (node->expire - start));
+                return EXIT_FAILURE;
+            }
+            if (node->expire < last) {
+                fprintf(stderr, "Error: timer %u expired out of order\n",
+                    index);
+                return EXIT_FAILURE;
+            }
+            last = node->expire;
+            expired--;
+            fired++;
+        }
+        if (expired != 0) {
+            fprintf(stderr, "Error: expired count mismatch\n");
+            return EXIT_FAILURE;
+        }
+        if (now - start > ((hg_util_uint64_t) 1 << 26)) {
+            fprintf(stderr, "Error: %u timers never expired\n",
+                n - fired - disarmed);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (hg_timer_wheel_next(&wheel) != HG_TIMER_WHEEL_NEVER) {
+        fprintf(stderr, "Error: wheel should be empty\n");
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/* Time spent per timer to arm n timers, expire half and disarm the rest */
+static double
+timer_cost(struct hg_timer_wheel_node *nodes, unsigned int n)
+{
+    struct hg_timer_wheel wheel;
+    double best = 0;
+    unsigned int rep;
+
+    for (rep = 0; rep < NREPS; rep++) {
+        hg_util_uint64_t now = 1000;
+        unsigned int seed = 7, i;
+        hg_time_fast_t t1, t2;
+        double cost;
+
+        t1 = hg_time_fast_now();
+        hg_timer_wheel_init(&wheel, now);
+        for (i = 0; i < n; i++) {
+            hg_timer_wheel_node_init(&nodes[i]);
+            hg_timer_wheel_arm(&wheel, &nodes[i],
+                now + 1 + (i % 2) * 100000 + rand_next(&seed) % 60000);
+        }
+        for (now += 1000; now <= 61001; now += 1000) {
+            hg_timer_wheel_advance(&wheel, now);
+            while (hg_timer_wheel_pop(&wheel) != NULL)
+                continue;
+        }
+        for (i = 1; i < n; i += 2)
+            hg_timer_wheel_disarm(&wheel, &nodes[i]);
+        t2 = hg_time_fast_now();
+
+        cost = (double) hg_time_fast_to_ns(t2 - t1) / n;
+        if (rep == 0 || cost < best)
+            best = cost;
+    }
+
+    return best;
+}
+
+int
+main(void)
+{
+    struct hg_timer_wheel_node *nodes;
+    double cost_small, cost;
+    int ret = EXIT_SUCCESS;
+
+    nodes = (struct hg_timer_wheel_node *) malloc(
+        NTIMERS * sizeof(struct hg_timer_wheel_node));
+    if (nodes == NULL) {
+        fprintf(stderr, "Error: could not allocate timers\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+    ret = check_order(nodes);
+    if (ret != EXIT_SUCCESS)
+        goto done;
+
+    ret = check_expire(nodes, NTIMERS);
+    if (ret != EXIT_SUCCESS)
+        goto done;
+
+    /* Cost per timer must not depend on number of timers */
+    cost_small = timer_cost(nodes, NTIMERS_SMALL);
+    cost = timer_cost(nodes, NTIMERS);
+    printf("Cost per timer: %.1f ns (%u timers), %.1f ns (%u timers)\n",
+        cost_small, NTIMERS_SMALL, cost, NTIMERS);
+    if (cost > MAX_COST_RATIO * cost_small) {
+        fprintf(stderr, "Error: timer cost grows with number of timers\n");
+        ret = EXIT_FAILURE;
+        goto done;
+    }
+
+done:
+    free(nodes);
+    return ret;
+}
@@ -10,12 +10,16 @@
 
 #include "mercury.h"
 #include "mercury_bulk.h"
+#include "mercury_core_header.h"
 #include "mercury_error.h"
 #include "mercury_proc.h"
 #include "mercury_proc_bulk.h"
 
 #include "mercury_hash_string.h"
+#include "mercury_log.h"
 #include "mercury_mem.h"
+#include "mercury_queue.h"
+#include "mercury_thread_lock_prof.h"
 #include "mercury_thread_spin.h"
 
 #include <assert.h>
@@ -31,16 +35,45 @@
 #define HG_CONTEXT_CLASS(context)                                              \
     ((struct hg_private_class *) (context->hg_class))
 
+/* Extra payload pool: power-of-two size classes from 2^MIN_SHIFT up to
+ * 2^MAX_SHIFT bytes, at most MAX_CACHED buffers kept per size class. Pooled
+ * buffers only receive payloads (bulk pull destination or reassembled
+ * fragments), their bulk handles are never sent to a peer. */
+#define HG_EXTRA_POOL_MIN_SHIFT  (13) /* 8 KB */
+#define HG_EXTRA_POOL_MAX_SHIFT  (18) /* 256 KB */
+#define HG_EXTRA_POOL_NCLASSES                                                 \
+    (HG_EXTRA_POOL_MAX_SHIFT - HG_EXTRA_POOL_MIN_SHIFT + 1)
+#define HG_EXTRA_POOL_MAX_CACHED (16)
+
 /************************************/
 /* Local Type and Struct Definition */
 /************************************/
 
+/* Pooled extra payload buffer (registered once for RMA) */
+struct hg_extra_buf {
+    void *buf;                          /* Buffer */
+    hg_bulk_t bulk;                     /* Bulk handle registered for buf */
+    unsigned int class_id;              /* Size class */
+    HG_QUEUE_ENTRY(hg_extra_buf) entry; /* Entry in free list */
+};
+
+/* Extra payload buffer size class */
+struct hg_extra_buf_class {
+    HG_QUEUE_HEAD(hg_extra_buf) free_list; /* Free buffers */
+    hg_thread_spin_t lock;                 /* Free list lock */
+    hg_thread_lock_prof_t lock_prof;       /* Free list lock profile */
+    unsigned int count;                    /* Number of free buffers */
+};
+
 /* HG class */
 struct hg_private_class {
     struct hg_class hg_class; /* Must remain as first field */
+    struct hg_extra_buf_class extra_pool[HG_EXTRA_POOL_NCLASSES]; /* Pool */
+    hg_atomic_int32_t extra_pool_n_used; /* Pooled buffers held by handles */
     hg_return_t (*handle_create)(hg_handle_t, void *); /* handle_create */
     void *handle_create_arg;                           /* handle_create arg */
     hg_thread_spin_t register_lock;                    /* Register lock */
+    hg_thread_lock_prof_t register_lock_prof; /* Register lock profile */
 };
 
 /* Info for function map */
@@ -65,6 +98,8 @@ struct hg_private_handle {
     void *respond_arg;            /* Respond callback args */
     void *in_extra_buf;           /* Extra input buffer */
     void *out_extra_buf;          /* Extra output buffer */
+    struct hg_extra_buf *in_extra_pool_buf;  /* Pooled extra input buffer */
+    struct hg_extra_buf *out_extra_pool_buf; /* Pooled extra output buffer */
     hg_proc_t in_proc;            /* Proc for input */
     hg_proc_t out_proc;           /* Proc for output */
     hg_bulk_t in_extra_bulk;      /* Extra input bulk handle */
@@ -163,6 +198,39 @@ static hg_return_t
 hg_free_struct(struct hg_private_handle *hg_handle,
     const struct hg_proc_info *hg_proc_info, hg_op_t op, void *struct_ptr);
 
+/**
+ * Initialize extra payload pool.
+ */
+static void
+hg_extra_pool_init(struct hg_private_class *hg_class);
+
+/**
+ * Free buffers cached in extra payload pool.
+ */
+static void
+hg_extra_pool_clear(struct hg_private_class *hg_class);
+
+/**
+ * Destroy extra payload pool.
+ */
+static void
+hg_extra_pool_destroy(struct hg_private_class *hg_class);
+
+/**
+ * Get registered buffer of at least size bytes from extra payload pool, the
+ * buffer is registered for local access only. Return NULL if size exceeds the
+ * largest size class.
+ */
+static struct hg_extra_buf *
+hg_extra_pool_get(struct hg_private_class *hg_class, hg_size_t size);
+
+/**
+ * Return buffer to extra payload pool.
+ */
+static void
+hg_extra_pool_release(
+    struct hg_private_class *hg_class, struct hg_extra_buf *extra_buf);
+
 /**
  * Get extra user payload using bulk transfer.
  */
@@ -409,6 +477,137 @@ hg_core_addr_lookup_cb(const struct hg_core_cb_info *callback_info)
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+static void
+hg_extra_pool_init(struct hg_private_class *hg_class)
+{
+    unsigned int i;
+
+    for (i = 0; i < HG_EXTRA_POOL_NCLASSES; i++) {
+        HG_QUEUE_INIT(&hg_class->extra_pool[i].free_list);
+        hg_thread_spin_init(&hg_class->extra_pool[i].lock);
+        hg_class->extra_pool[i].lock_prof =
+            hg_thread_lock_prof_register("hg.extra_pool");
+        hg_class->extra_pool[i].count = 0;
+    }
+    hg_atomic_init32(&hg_class->extra_pool_n_used, 0);
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_extra_pool_clear(struct hg_private_class *hg_class)
+{
+    unsigned int i;
+
+    for (i = 0; i < HG_EXTRA_POOL_NCLASSES; i++) {
+        struct hg_extra_buf_class *buf_class = &hg_class->extra_pool[i];
+
+        hg_thread_spin_lock_prof(&buf_class->lock, buf_class->lock_prof);
+        while (!HG_QUEUE_IS_EMPTY(&buf_class->free_list)) {
+            struct hg_extra_buf *extra_buf =
+                HG_QUEUE_FIRST(&buf_class->free_list);
+            HG_QUEUE_POP_HEAD(&buf_class->free_list, entry);
+
+            HG_Bulk_free(extra_buf->bulk);
+            hg_mem_aligned_free(extra_buf->buf);
+            free(extra_buf);
+        }
+        buf_class->count = 0;
+        hg_thread_spin_unlock(&buf_class->lock);
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_extra_pool_destroy(struct hg_private_class *hg_class)
+{
+    unsigned int i;
+
+    hg_extra_pool_clear(hg_class);
+    for (i = 0; i < HG_EXTRA_POOL_NCLASSES; i++)
+        hg_thread_spin_destroy(&hg_class->extra_pool[i].lock);
+}
+
+/*---------------------------------------------------------------------------*/
+static struct hg_extra_buf *
+hg_extra_pool_get(struct hg_private_class *hg_class, hg_size_t size)
+{
+    struct hg_extra_buf_class *buf_class;
+    struct hg_extra_buf *extra_buf = NULL;
+    hg_size_t buf_size;
+    unsigned int class_id = 0;
+    hg_return_t ret;
+
+    /* Find smallest size class that fits */
+    while (((hg_size_t) 1 << (HG_EXTRA_POOL_MIN_SHIFT + class_id)) < size)
+        if (++class_id == HG_EXTRA_POOL_NCLASSES)
+            return NULL;
+    buf_class = &hg_class->extra_pool[class_id];
+    buf_size = (hg_size_t) 1 << (HG_EXTRA_POOL_MIN_SHIFT + class_id);
+
+    hg_thread_spin_lock_prof(&buf_class->lock, buf_class->lock_prof);
+    extra_buf = HG_QUEUE_FIRST(&buf_class->free_list);
+    if (extra_buf) {
+        HG_QUEUE_POP_HEAD(&buf_class->free_list, entry);
+        buf_class->count--;
+    }
+    hg_thread_spin_unlock(&buf_class->lock);
+    if (extra_buf)
+        goto done;
+
+    /* Free list is empty, allocate and register a new buffer */
+    extra_buf = (struct hg_extra_buf *) malloc(sizeof(struct hg_extra_buf));
+    HG_CHECK_ERROR_NORET(
+        extra_buf == NULL, error, "Could not allocate extra buf");
+    extra_buf->bulk = HG_BULK_NULL;
+    extra_buf->class_id = class_id;
+
+    extra_buf->buf =
+        hg_mem_aligned_alloc((hg_size_t) hg_mem_get_page_size(), buf_size);
+    HG_CHECK_ERROR_NORET(extra_buf->buf == NULL, error,
+        "Could not allocate extra payload buffer");
+
+    ret = HG_Bulk_create((hg_class_t *) hg_class, 1, &extra_buf->buf,
+        &buf_size, HG_BULK_READWRITE, &extra_buf->bulk);
+    HG_CHECK_HG_ERROR(error, ret, "Could not create HG bulk handle");
+
+done:
+    hg_atomic_incr32(&hg_class->extra_pool_n_used);
+    return extra_buf;
+
+error:
+    if (extra_buf) {
+        hg_mem_aligned_free(extra_buf->buf);
+        free(extra_buf);
+    }
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_extra_pool_release(
+    struct hg_private_class *hg_class, struct hg_extra_buf *extra_buf)
+{
+    struct hg_extra_buf_class *buf_class =
+        &hg_class->extra_pool[extra_buf->class_id];
+
+    hg_atomic_decr32(&hg_class->extra_pool_n_used);
+
+    hg_thread_spin_lock_prof(&buf_class->lock, buf_class->lock_prof);
+    if (buf_class->count < HG_EXTRA_POOL_MAX_CACHED) {
+        HG_QUEUE_PUSH_TAIL(&buf_class->free_list, extra_buf, entry);
+        buf_class->count++;
+        extra_buf = NULL;
+    }
+    hg_thread_spin_unlock(&buf_class->lock);
+
+    if (extra_buf) {
+        HG_Bulk_free(extra_buf->bulk);
+        hg_mem_aligned_free(extra_buf->buf);
+        free(extra_buf);
+    }
+}
+
 /*---------------------------------------------------------------------------*/
 static hg_return_t
 hg_get_struct(struct hg_private_handle *hg_handle,
@@ -532,6 +731,9 @@ hg_set_struct(struct hg_private_handle *hg_handle,
     struct hg_header_hash *hg_header_hash = NULL;
 #endif
     hg_size_t header_offset = hg_header_get_size(op);
+    hg_size_t frag_size;
+    hg_uint8_t frag;
+    hg_bool_t legacy;
     hg_return_t ret = HG_SUCCESS;
 
     switch (op) {
@@ -615,7 +817,8 @@ hg_set_struct(struct hg_private_handle *hg_handle,
      * If the payload did not fit into the original buffer, we need to send a
      * message with "more data" flag set along with the bulk data descriptor
      * for the extra buffer so that the target can pull that buffer and use
-     * it to retrieve the data.
+     * it to retrieve the data. Payloads below the fragment threshold are
+     * instead pushed by the core layer as a series of expected messages.
      */
     if (hg_proc_get_extra_buf(proc)) {
         /* Potentially free previous payload if handle was not reset */
@@ -624,27 +827,64 @@ hg_set_struct(struct hg_private_handle *hg_handle,
         HG_GOTO_ERROR(done, ret, HG_OVERFLOW,
             "Arguments overflow is not supported with XDR");
 #endif
-        /* Create a bulk descriptor only of the size that is used */
-        *extra_buf = hg_proc_get_extra_buf(proc);
+        /* Only the size that is used needs to be transferred */
         *extra_buf_size = hg_proc_get_size_used(proc);
 
-        /* Prevent buffer from being freed when proc_reset is called */
-        hg_proc_set_extra_buf_is_mine(proc, HG_TRUE);
-
-        /* Create bulk descriptor */
-        ret = HG_Bulk_create(hg_handle->handle.info.hg_class, 1, extra_buf,
-            extra_buf_size, HG_BULK_READ_ONLY, extra_bulk);
-        HG_CHECK_HG_ERROR(done, ret, "Could not create bulk data handle");
+        /* Peers that use an older core protocol only understand the extra
+         * bulk handle, fragments are never used with them */
+        legacy = (HG_Core_get_protocol(hg_handle->handle.core_handle) !=
+                  HG_CORE_PROTOCOL_VERSION);
+        frag = (hg_uint8_t) (!legacy &&
+                             *extra_buf_size <=
+                                 HG_Core_class_get_frag_threshold(
+                                     hg_handle->handle.info.hg_class
+                                         ->core_class));
+        if (frag) {
+            /* Fragments are copied out by the core layer, no bulk needed */
+            *extra_buf = hg_proc_get_extra_buf(proc);
+            hg_proc_set_extra_buf_is_mine(proc, HG_TRUE);
+
+            ret = HG_Core_set_frag(
+                hg_handle->handle.core_handle, *extra_buf, *extra_buf_size);
+            HG_CHECK_HG_ERROR(done, ret, "Could not set fragments");
+        } else {
+            *extra_buf = hg_proc_get_extra_buf(proc);
+
+            /* Prevent buffer from being freed when proc_reset is called */
+            hg_proc_set_extra_buf_is_mine(proc, HG_TRUE);
+
+            /* Create bulk descriptor */
+            ret = HG_Bulk_create(hg_handle->handle.info.hg_class, 1, extra_buf,
+                extra_buf_size, HG_BULK_READ_ONLY, extra_bulk);
+            HG_CHECK_HG_ERROR(done, ret, "Could not create bulk data handle");
+        }
 
         /* Reset proc */
         ret = hg_proc_reset(proc, buf, buf_size, HG_ENCODE);
         HG_CHECK_HG_ERROR(done, ret, "Could not reset proc");
 
-        /* Encode extra_bulk_handle, we can do that safely here because
-         * the user payload has been copied so we don't have to worry
-         * about overwriting the user's data */
-        ret = hg_proc_hg_bulk_t(proc, extra_bulk);
-        HG_CHECK_HG_ERROR(done, ret, "Could not process extra bulk handle");
+        /* Encode transfer mode, size and frag size or extra_bulk_handle, we
+         * can do that safely here because the user payload has been copied
+         * so we don't have to worry about overwriting the user's data */
+        if (!legacy) {
+            ret = hg_proc_hg_uint8_t(proc, &frag);
+            HG_CHECK_HG_ERROR(done, ret, "Could not process extra frag flag");
+
+            /* Encode payload size, target picks its receive buffer from it */
+            ret = hg_proc_hg_size_t(proc, extra_buf_size);
+            HG_CHECK_HG_ERROR(done, ret, "Could not process extra buf size");
+        }
+
+        if (frag) {
+            /* Target checks that it splits the payload the same way */
+            frag_size = HG_Core_get_frag_size(hg_handle->handle.core_handle);
+            ret = hg_proc_hg_size_t(proc, &frag_size);
+            HG_CHECK_HG_ERROR(done, ret, "Could not process frag size");
+        } else {
+            ret = hg_proc_hg_bulk_t(proc, extra_bulk);
+            HG_CHECK_HG_ERROR(
+                done, ret, "Could not process extra bulk handle");
+        }
 
         ret = hg_proc_flush(proc);
         HG_CHECK_HG_ERROR(done, ret, "Error in proc flush");
@@ -749,9 +989,13 @@ hg_get_extra_payload(struct hg_private_handle *hg_handle, hg_op_t op,
     void *buf, **extra_buf;
     hg_size_t buf_size, *extra_buf_size;
     hg_bulk_t *extra_bulk = NULL;
+    struct hg_extra_buf **extra_pool_buf;
     hg_size_t header_offset = hg_header_get_size(op);
     hg_size_t page_size = (hg_size_t) hg_mem_get_page_size();
-    hg_bulk_t local_handle = HG_BULK_NULL;
+    hg_bulk_t local_handle = HG_BULK_NULL, transfer_handle;
+    hg_size_t frag_size = 0;
+    hg_uint8_t frag = 0;
+    hg_bool_t legacy;
     hg_return_t ret = HG_SUCCESS;
 
     switch (op) {
@@ -768,6 +1012,7 @@ hg_get_extra_payload(struct hg_private_handle *hg_handle, hg_op_t op,
             extra_buf = &hg_handle->in_extra_buf;
             extra_buf_size = &hg_handle->in_extra_buf_size;
             extra_bulk = &hg_handle->in_extra_bulk;
+            extra_pool_buf = &hg_handle->in_extra_pool_buf;
             break;
         case HG_OUTPUT:
             /* Use custom header offset */
@@ -782,6 +1027,7 @@ hg_get_extra_payload(struct hg_private_handle *hg_handle, hg_op_t op,
             extra_buf = &hg_handle->out_extra_buf;
             extra_buf_size = &hg_handle->out_extra_buf_size;
             extra_bulk = &hg_handle->out_extra_bulk;
+            extra_pool_buf = &hg_handle->out_extra_pool_buf;
             break;
         default:
             HG_GOTO_ERROR(done, ret, HG_INVALID_ARG, "Invalid HG op");
@@ -794,29 +1040,88 @@ hg_get_extra_payload(struct hg_private_handle *hg_handle, hg_op_t op,
     ret = hg_proc_reset(proc, buf, buf_size, HG_DECODE);
     HG_CHECK_HG_ERROR(done, ret, "Could not reset proc");
 
-    /* Decode extra bulk handle */
-    ret = hg_proc_hg_bulk_t(proc, extra_bulk);
-    HG_CHECK_HG_ERROR(done, ret, "Could not process extra bulk handle");
+    /* Decode transfer mode, size and frag size or extra bulk handle, older
+     * core protocols only carry the extra bulk handle */
+    legacy = (HG_Core_get_protocol(hg_handle->handle.core_handle) !=
+              HG_CORE_PROTOCOL_VERSION);
+    if (!legacy) {
+        ret = hg_proc_hg_uint8_t(proc, &frag);
+        HG_CHECK_HG_ERROR(done, ret, "Could not process extra frag flag");
+
+        ret = hg_proc_hg_size_t(proc, extra_buf_size);
+        HG_CHECK_HG_ERROR(done, ret, "Could not process extra buf size");
+    }
+
+    if (frag) {
+        ret = hg_proc_hg_size_t(proc, &frag_size);
+        HG_CHECK_HG_ERROR(done, ret, "Could not process frag size");
+    } else {
+        ret = hg_proc_hg_bulk_t(proc, extra_bulk);
+        HG_CHECK_HG_ERROR(done, ret, "Could not process extra bulk handle");
+    }
 
     ret = hg_proc_flush(proc);
     HG_CHECK_HG_ERROR(done, ret, "Error in proc flush");
 
-    /* Create a new local handle to read the data */
-    *extra_buf_size = HG_Bulk_get_size(*extra_bulk);
-    *extra_buf = hg_mem_aligned_alloc(page_size, *extra_buf_size);
-    HG_CHECK_ERROR(*extra_buf == NULL, done, ret, HG_NOMEM,
-        "Could not allocate extra payload buffer");
+    if (frag) {
+        /* Fragments are received into buffers of the local expected size */
+        HG_CHECK_ERROR(
+            frag_size != HG_Core_get_frag_size(hg_handle->handle.core_handle),
+            done, ret, HG_PROTOCOL_ERROR,
+            "Remote fragment size (%lu) does not match local fragment size "
+            "(%lu)",
+            (unsigned long) frag_size,
+            (unsigned long) HG_Core_get_frag_size(
+                hg_handle->handle.core_handle));
+
+        /* Payload is pushed by the origin as fragments, reassemble it */
+        *extra_pool_buf = hg_extra_pool_get(
+            (struct hg_private_class *) hg_handle->handle.info.hg_class,
+            *extra_buf_size);
+        if (*extra_pool_buf)
+            *extra_buf = (*extra_pool_buf)->buf;
+        else {
+            *extra_buf = hg_mem_aligned_alloc(page_size, *extra_buf_size);
+            HG_CHECK_ERROR(*extra_buf == NULL, done, ret, HG_NOMEM,
+                "Could not allocate extra payload buffer");
+        }
+
+        ret = HG_Core_recv_frag(hg_handle->handle.core_handle, *extra_buf,
+            *extra_buf_size, done_cb);
+        HG_CHECK_HG_ERROR(done, ret, "Could not receive fragments");
+        goto done;
+    }
+
+    if (legacy)
+        *extra_buf_size = HG_Bulk_get_size(*extra_bulk);
+    HG_CHECK_ERROR(*extra_buf_size > HG_Bulk_get_size(*extra_bulk), done, ret,
+        HG_PROTOCOL_ERROR, "Extra buf size exceeds size of extra bulk handle");
+
+    /* Use a pre-registered buffer from the class pool if one fits */
+    *extra_pool_buf = hg_extra_pool_get(
+        (struct hg_private_class *) hg_handle->handle.info.hg_class,
+        *extra_buf_size);
+    if (*extra_pool_buf) {
+        *extra_buf = (*extra_pool_buf)->buf;
+        transfer_handle = (*extra_pool_buf)->bulk;
+    } else {
+        /* Create a new local handle to read the data */
+        *extra_buf = hg_mem_aligned_alloc(page_size, *extra_buf_size);
+        HG_CHECK_ERROR(*extra_buf == NULL, done, ret, HG_NOMEM,
+            "Could not allocate extra payload buffer");
 
-    ret = HG_Bulk_create(hg_handle->handle.info.hg_class, 1, extra_buf,
-        extra_buf_size, HG_BULK_READWRITE, &local_handle);
-    HG_CHECK_HG_ERROR(done, ret, "Could not create HG bulk handle");
+        ret = HG_Bulk_create(hg_handle->handle.info.hg_class, 1, extra_buf,
+            extra_buf_size, HG_BULK_READWRITE, &local_handle);
+        HG_CHECK_HG_ERROR(done, ret, "Could not create HG bulk handle");
+        transfer_handle = local_handle;
+    }
 
     /* Read bulk data here and wait for the data to be here  */
     hg_handle->extra_bulk_transfer_cb = done_cb;
     ret = HG_Bulk_transfer_id(hg_handle->handle.info.context,
         hg_get_extra_payload_cb, hg_handle, HG_BULK_PULL,
         (hg_addr_t) hg_core_info->addr, hg_core_info->context_id, *extra_bulk,
-        0, local_handle, 0, *extra_buf_size,
+        0, transfer_handle, 0, *extra_buf_size,
         HG_OP_ID_IGNORE /* TODO not used for now */);
     HG_CHECK_HG_ERROR(done, ret, "Could not transfer bulk data");
 
@@ -848,6 +1153,26 @@ done:
 static void
 hg_free_extra_payload(struct hg_private_handle *hg_handle)
 {
+    struct hg_private_class *hg_class =
+        (struct hg_private_class *) hg_handle->handle.info.hg_class;
+
+    /* Return pooled buffers, bulk handle is owned by the pool */
+    if (hg_handle->in_extra_pool_buf) {
+        hg_extra_pool_release(hg_class, hg_handle->in_extra_pool_buf);
+        hg_handle->in_extra_pool_buf = NULL;
+        hg_handle->in_extra_bulk = HG_BULK_NULL;
+        hg_handle->in_extra_buf = NULL;
+        hg_handle->in_extra_buf_size = 0;
+    }
+
+    if (hg_handle->out_extra_pool_buf) {
+        hg_extra_pool_release(hg_class, hg_handle->out_extra_pool_buf);
+        hg_handle->out_extra_pool_buf = NULL;
+        hg_handle->out_extra_bulk = HG_BULK_NULL;
+        hg_handle->out_extra_buf = NULL;
+        hg_handle->out_extra_buf_size = 0;
+    }
+
     /* Free extra bulk buf if there was any */
     if (hg_handle->in_extra_buf) {
         HG_Bulk_free(hg_handle->in_extra_bulk);
@@ -935,6 +1260,51 @@ HG_Error_to_string(hg_return_t errnum)
     return hg_return_name[errnum];
 }
 
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Set_log_level(const char *level)
+{
+#ifdef HG_HAS_VERBOSE_ERROR
+    unsigned int mask;
+
+    if (level == NULL || hg_log_level_to_mask(level, &mask) != HG_UTIL_SUCCESS)
+        return HG_INVALID_ARG;
+    HG_LOG_MASK = mask;
+
+    return HG_SUCCESS;
+#else
+    (void) level;
+
+    return HG_OPNOTSUPPORTED;
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Mem_usage(struct hg_mem_usage *usage)
+{
+    hg_return_t ret = HG_SUCCESS;
+
+    HG_CHECK_ERROR(
+        usage == NULL, done, ret, HG_INVALID_ARG, "NULL memory usage report");
+
+#ifdef HG_UTIL_HAS_MEM_STATS
+    hg_mem_usage_get(usage);
+#else
+    ret = HG_OPNOTSUPPORTED;
+#endif
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+const char *
+HG_Mem_usage_type_to_string(hg_mem_usage_type_t type)
+{
+    return hg_mem_usage_type_to_string(type);
+}
+
 /*---------------------------------------------------------------------------*/
 hg_class_t *
 HG_Init(const char *na_info_string, hg_bool_t na_listen)
@@ -953,8 +1323,12 @@ HG_Init_opt(const char *na_info_string, hg_bool_t na_listen,
 
     /* Set log level */
     log_level = getenv("HG_LOG_LEVEL");
-    if (log_level && (strcmp(log_level, "debug") == 0))
-        HG_LOG_MASK |= HG_LOG_TYPE_DEBUG;
+    if (log_level)
+        HG_Set_log_level(log_level);
+
+    /* Move log formatting and writing off the calling threads */
+    if (getenv("HG_LOG_ASYNC"))
+        hg_log_set_async(HG_UTIL_TRUE, 0);
 #endif
 
     /* Make sure error return codes match */
@@ -966,6 +1340,8 @@ HG_Init_opt(const char *na_info_string, hg_bool_t na_listen,
 
     memset(hg_class, 0, sizeof(struct hg_private_class));
     hg_thread_spin_init(&hg_class->register_lock);
+    hg_class->register_lock_prof = hg_thread_lock_prof_register("hg.register");
+    hg_extra_pool_init(hg_class);
 
     hg_class->hg_class.core_class =
         HG_Core_init_opt(na_info_string, na_listen, hg_init_info);
@@ -981,6 +1357,7 @@ HG_Init_opt(const char *na_info_string, hg_bool_t na_listen,
 error:
     if (hg_class) {
         hg_thread_spin_destroy(&hg_class->register_lock);
+        hg_extra_pool_destroy(hg_class);
         free(hg_class);
     }
     return NULL;
@@ -994,12 +1371,22 @@ HG_Finalize(hg_class_t *hg_class)
         (struct hg_private_class *) hg_class;
     hg_return_t ret = HG_SUCCESS;
 
+    /* Pooled buffers must be deregistered before NA is finalized, wait for
+     * handles to return the buffers they hold */
+    HG_CHECK_ERROR(hg_atomic_get32(&private_class->extra_pool_n_used) > 0,
+        done, ret, HG_BUSY, "Extra payload buffers are still in use");
+    hg_extra_pool_clear(private_class);
+
     ret = HG_Core_finalize(private_class->hg_class.core_class);
     HG_CHECK_HG_ERROR(done, ret, "Could not finalize HG core class");
 
     hg_thread_spin_destroy(&private_class->register_lock);
+    hg_extra_pool_destroy(private_class);
     free(private_class);
 
+    /* Write pending asynchronous log records */
+    hg_log_flush();
+
 done:
     return ret;
 }
@@ -1147,7 +1534,8 @@ HG_Registered_name(
     /* Generate an ID from the function name */
     rpc_id = hg_hash_string(func_name);
 
-    hg_thread_spin_lock(&private_class->register_lock);
+    hg_thread_spin_lock_prof(&private_class->register_lock,
+        private_class->register_lock_prof);
 
     ret = HG_Core_registered(private_class->hg_class.core_class, rpc_id, flag);
     HG_CHECK_HG_ERROR(unlock, ret, "Could not check for registered RPC ID (%s)",
@@ -1177,7 +1565,8 @@ HG_Register(hg_class_t *hg_class, hg_id_t id, hg_proc_cb_t in_proc_cb,
     HG_CHECK_ERROR(
         hg_class == NULL, done, ret, HG_INVALID_ARG, "NULL HG class");
 
-    hg_thread_spin_lock(&private_class->register_lock);
+    hg_thread_spin_lock_prof(&private_class->register_lock,
+        private_class->register_lock_prof);
 
     /* Check if already registered */
     ret = HG_Core_registered(hg_class->core_class, id, &registered);
@@ -1238,7 +1627,8 @@ HG_Deregister(hg_class_t *hg_class, hg_id_t id)
     HG_CHECK_ERROR(
         hg_class == NULL, done, ret, HG_INVALID_ARG, "NULL HG class");
 
-    hg_thread_spin_lock(&private_class->register_lock);
+    hg_thread_spin_lock_prof(&private_class->register_lock,
+        private_class->register_lock_prof);
     ret = HG_Core_deregister(hg_class->core_class, id);
     hg_thread_spin_unlock(&private_class->register_lock);
     HG_CHECK_HG_ERROR(
@@ -1259,7 +1649,8 @@ HG_Registered(hg_class_t *hg_class, hg_id_t id, hg_bool_t *flag)
     HG_CHECK_ERROR(
         hg_class == NULL, done, ret, HG_INVALID_ARG, "NULL HG class");
 
-    hg_thread_spin_lock(&private_class->register_lock);
+    hg_thread_spin_lock_prof(&private_class->register_lock,
+        private_class->register_lock_prof);
     ret = HG_Core_registered(hg_class->core_class, id, flag);
     hg_thread_spin_unlock(&private_class->register_lock);
     HG_CHECK_HG_ERROR(done, ret, "Could not check for registered RPC ID (s)",
@@ -1282,7 +1673,8 @@ HG_Registered_proc_cb(hg_class_t *hg_class, hg_id_t id, hg_bool_t *flag,
     HG_CHECK_ERROR(
         hg_class == NULL, done, ret, HG_INVALID_ARG, "NULL HG class");
 
-    hg_thread_spin_lock(&private_class->register_lock);
+    hg_thread_spin_lock_prof(&private_class->register_lock,
+        private_class->register_lock_prof);
 
     ret = HG_Core_registered(hg_class->core_class, id, flag);
     HG_CHECK_HG_ERROR(unlock, ret, "Could not check for registered RPC ID (%s)",
@@ -1321,7 +1713,8 @@ HG_Register_data(
     HG_CHECK_ERROR(
         hg_class == NULL, done, ret, HG_INVALID_ARG, "NULL HG class");
 
-    hg_thread_spin_lock(&private_class->register_lock);
+    hg_thread_spin_lock_prof(&private_class->register_lock,
+        private_class->register_lock_prof);
 
     /* Retrieve proc function from function map */
     hg_proc_info = (struct hg_proc_info *) HG_Core_registered_data(
@@ -1350,7 +1743,8 @@ HG_Registered_data(hg_class_t *hg_class, hg_id_t id)
 
     HG_CHECK_ERROR_NORET(hg_class == NULL, done, "NULL HG class");
 
-    hg_thread_spin_lock(&private_class->register_lock);
+    hg_thread_spin_lock_prof(&private_class->register_lock,
+        private_class->register_lock_prof);
 
     /* Retrieve proc function from function map */
     hg_proc_info = (struct hg_proc_info *) HG_Core_registered_data(
@@ -1380,7 +1774,8 @@ HG_Registered_disable_response(
     HG_CHECK_ERROR(
         hg_class == NULL, done, ret, HG_INVALID_ARG, "NULL HG class");
 
-    hg_thread_spin_lock(&private_class->register_lock);
+    hg_thread_spin_lock_prof(&private_class->register_lock,
+        private_class->register_lock_prof);
 
     /* Retrieve proc function from function map */
     hg_proc_info = (struct hg_proc_info *) HG_Core_registered_data(
@@ -1412,7 +1807,8 @@ HG_Registered_disabled_response(
     HG_CHECK_ERROR(disabled == NULL, done, ret, HG_INVALID_ARG,
         "NULL pointer to disabled flag");
 
-    hg_thread_spin_lock(&private_class->register_lock);
+    hg_thread_spin_lock_prof(&private_class->register_lock,
+        private_class->register_lock_prof);
 
     /* Retrieve proc function from function map */
     hg_proc_info = (struct hg_proc_info *) HG_Core_registered_data(
@@ -1878,6 +2274,14 @@ done:
 /*---------------------------------------------------------------------------*/
 hg_return_t
 HG_Forward(hg_handle_t handle, hg_cb_t callback, void *arg, void *in_struct)
+{
+    return HG_Forward_timed(handle, callback, arg, in_struct, 0);
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Forward_timed(hg_handle_t handle, hg_cb_t callback, void *arg,
+    void *in_struct, unsigned int timeout)
 {
     struct hg_private_handle *private_handle =
         (struct hg_private_handle *) handle;
@@ -1915,8 +2319,8 @@ HG_Forward(hg_handle_t handle, hg_cb_t callback, void *arg, void *in_struct)
         flags |= HG_CORE_NO_RESPONSE;
 
     /* Send request */
-    ret = HG_Core_forward(
-        handle->core_handle, hg_core_forward_cb, handle, flags, payload_size);
+    ret = HG_Core_forward_timed(handle->core_handle, hg_core_forward_cb, handle,
+        flags, payload_size, timeout);
     if (ret == HG_AGAIN)
         goto done;
     HG_CHECK_HG_ERROR(
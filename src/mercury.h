@@ -15,6 +15,7 @@
 #include "mercury_types.h"
 
 #include "mercury_core.h"
+#include "mercury_mem.h"
 
 /*************************************/
 /* Public Type and Struct Definition */
@@ -58,6 +59,44 @@ HG_Version_get(unsigned int *major, unsigned int *minor, unsigned int *patch);
 HG_PUBLIC const char *
 HG_Error_to_string(hg_return_t errnum);
 
+/**
+ * Set log level of the HG layer at runtime ("none", "error", "warning" or
+ * "debug"). The level can also be set with the HG_LOG_LEVEL environment
+ * variable, HG_LOG_ASYNC enables asynchronous logging.
+ *
+ * \param level [IN]            log level name
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+HG_Set_log_level(const char *level);
+
+/**
+ * Retrieve memory held by mercury (current and high-water, in bytes) for each
+ * category of hg_mem_usage_type_t, over all classes of the process. Buffer
+ * pools of NA plugins back message buffers, HG_MEM_USAGE_NA_POOL and
+ * HG_MEM_USAGE_MSG_BUF may therefore overlap. HG_MEM_USAGE_BULK accounts for
+ * memory registered through HG_Bulk_create(), which may be owned by the user.
+ * Memory is only accounted if mercury was built with MERCURY_ENABLE_STATS.
+ *
+ * \param usage [OUT]           pointer to memory usage report
+ *
+ * \return HG_SUCCESS, HG_OPNOTSUPPORTED if memory is not accounted, or
+ * corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+HG_Mem_usage(struct hg_mem_usage *usage);
+
+/**
+ * Convert memory usage category to string (null terminated).
+ *
+ * \param type [IN]             memory usage category
+ *
+ * \return String
+ */
+HG_PUBLIC const char *
+HG_Mem_usage_type_to_string(hg_mem_usage_type_t type);
+
 /**
  * Initialize the Mercury layer.
  * Must be finalized with HG_Finalize().
@@ -90,11 +129,13 @@ HG_Init_opt(const char *na_info_string, hg_bool_t na_listen,
     const struct hg_init_info *hg_init_info);
 
 /**
- * Finalize the Mercury layer.
+ * Finalize the Mercury layer. Contexts and addresses must have been released
+ * and handles destroyed first, HG_BUSY is returned otherwise, including when
+ * a handle still holds one of the class extra payload buffers.
  *
  * \param hg_class [IN]         pointer to HG class
  *
- * \return HG_SUCCESS or corresponding HG error code
+ * \return HG_SUCCESS, HG_BUSY or corresponding HG error code
  */
 HG_PUBLIC hg_return_t
 HG_Finalize(hg_class_t *hg_class);
@@ -162,6 +203,32 @@ HG_Class_get_input_eager_size(const hg_class_t *hg_class);
 static HG_INLINE hg_size_t
 HG_Class_get_output_eager_size(const hg_class_t *hg_class);
 
+/**
+ * Set the maximum size of RPC extra payload (i.e., payload that exceeds the
+ * eager size) that is sent as a series of eager messages instead of being
+ * pulled by the target through a bulk transfer. Setting the threshold to 0
+ * always uses bulk transfers. Fragments are only used by default with plugins
+ * that support them, see HG_Core_class_set_frag_threshold() for the plugin
+ * requirements, origin and target must use the same threshold.
+ *
+ * \param hg_class [IN]         pointer to HG class
+ * \param threshold [IN]        threshold size
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+static HG_INLINE hg_return_t
+HG_Class_set_frag_threshold(hg_class_t *hg_class, hg_size_t threshold);
+
+/**
+ * Get the maximum size of RPC extra payload that is sent as eager messages.
+ *
+ * \param hg_class [IN]         pointer to HG class
+ *
+ * \return the threshold size, or 0 if extra payload always uses bulk transfers
+ */
+static HG_INLINE hg_size_t
+HG_Class_get_frag_threshold(const hg_class_t *hg_class);
+
 /**
  * Set offset used for serializing / deserializing input. This allows upper
  * layers to manually define a reserved space that can be used for the
@@ -318,6 +385,29 @@ HG_Context_set_data(
 static HG_INLINE void *
 HG_Context_get_data(const hg_context_t *context);
 
+/**
+ * Retrieve progress loop accounting of context.
+ * See HG_Core_context_get_progress_stats().
+ *
+ * \param context [IN]          pointer to HG context
+ * \param stats [OUT]           pointer to progress stats
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+static HG_INLINE hg_return_t
+HG_Context_get_progress_stats(
+    hg_context_t *context, struct hg_progress_stats *stats);
+
+/**
+ * Reset progress loop accounting of context.
+ *
+ * \param context [IN]          pointer to HG context
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+static HG_INLINE hg_return_t
+HG_Context_reset_progress_stats(hg_context_t *context);
+
 /**
  * Dynamically register a function func_name as an RPC as well as the
  * RPC callback executed when the RPC request ID associated to func_name is
@@ -844,6 +934,8 @@ HG_Set_target_id(hg_handle_t handle, hg_uint8_t id);
  * registered input proc. After completion, user callback is placed into a
  * completion queue and can be triggered using HG_Trigger(). RPC output can
  * be queried using HG_Get_output() and freed using HG_Free_output().
+ * Errors that occur once the request has been posted, such as a failure to
+ * send the fragments of a large input, are reported to the callback.
  *
  * \remark This routine is internally equivalent to:
  *   - HG_Core_get_input()
@@ -860,6 +952,24 @@ HG_Set_target_id(hg_handle_t handle, hg_uint8_t id);
 HG_PUBLIC hg_return_t
 HG_Forward(hg_handle_t handle, hg_cb_t callback, void *arg, void *in_struct);
 
+/**
+ * Forward a call with a deadline, see HG_Forward(). If the RPC has not
+ * completed within timeout, it is canceled and the user callback is passed
+ * HG_TIMEOUT. Deadlines are only enforced while progress is made on the
+ * handle's context. Timed forwards to self are not supported.
+ *
+ * \param handle [IN]           HG handle
+ * \param callback [IN]         pointer to function callback
+ * \param arg [IN]              pointer to data passed to callback
+ * \param in_struct [IN]        pointer to input structure
+ * \param timeout [IN]          timeout (in milliseconds, 0 if none)
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+HG_Forward_timed(hg_handle_t handle, hg_cb_t callback, void *arg,
+    void *in_struct, unsigned int timeout);
+
 /**
  * Respond back to origin using an existing HG handle.
  * Output structure can be passed and parameters serialized using a previously
@@ -988,6 +1098,20 @@ HG_Class_get_output_eager_size(const hg_class_t *hg_class)
     return (core > header) ? core - header : 0;
 }
 
+/*---------------------------------------------------------------------------*/
+static HG_INLINE hg_return_t
+HG_Class_set_frag_threshold(hg_class_t *hg_class, hg_size_t threshold)
+{
+    return HG_Core_class_set_frag_threshold(hg_class->core_class, threshold);
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE hg_size_t
+HG_Class_get_frag_threshold(const hg_class_t *hg_class)
+{
+    return HG_Core_class_get_frag_threshold(hg_class->core_class);
+}
+
 /*---------------------------------------------------------------------------*/
 static HG_INLINE hg_return_t
 HG_Class_set_input_offset(hg_class_t *hg_class, hg_size_t offset)
@@ -1058,6 +1182,21 @@ HG_Context_get_data(const hg_context_t *context)
     return HG_Core_context_get_data(context->core_context);
 }
 
+/*---------------------------------------------------------------------------*/
+static HG_INLINE hg_return_t
+HG_Context_get_progress_stats(
+    hg_context_t *context, struct hg_progress_stats *stats)
+{
+    return HG_Core_context_get_progress_stats(context->core_context, stats);
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE hg_return_t
+HG_Context_reset_progress_stats(hg_context_t *context)
+{
+    return HG_Core_context_reset_progress_stats(context->core_context);
+}
+
 /*---------------------------------------------------------------------------*/
 static HG_INLINE hg_return_t
 HG_Ref_incr(hg_handle_t handle)
@@ -14,6 +14,7 @@
 #include "mercury_private.h"
 
 #include "mercury_atomic.h"
+#include "mercury_mem.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -63,6 +64,7 @@ struct hg_bulk_op_id {
     hg_atomic_int32_t canceled;     /* Operation canceled */
     hg_atomic_int32_t op_completed_count; /* Number of operations completed */
     unsigned int op_count;                /* Number of ongoing operations */
+    hg_size_t size;                       /* Transfer size */
     hg_bulk_op_t op;                      /* Operation type */
     hg_bool_t is_self;                    /* Is self operation */
 };
@@ -97,6 +99,7 @@ struct hg_bulk {
     void *serialize_ptr;             /* Cached serialization buffer */
     hg_size_t total_size;            /* Total size of data abstracted */
     hg_size_t serialize_size;        /* Cached serialization size */
+    hg_size_t registered_size;       /* Size accounted as registered */
     hg_uint32_t segment_count;       /* Number of segments */
     hg_uint32_t na_mem_handle_count; /* Number of handles */
     hg_atomic_int32_t ref_count;     /* Reference count */
@@ -446,6 +449,9 @@ hg_bulk_create(struct hg_class *hg_class, hg_uint32_t count, void **buf_ptrs,
 #endif
     }
 
+    hg_bulk->registered_size = hg_bulk->total_size;
+    hg_mem_usage_add(HG_MEM_USAGE_BULK, hg_bulk->registered_size);
+
     *hg_bulk_ptr = hg_bulk;
 
     return ret;
@@ -556,6 +562,9 @@ hg_bulk_free(struct hg_bulk *hg_bulk)
     }
     free(hg_bulk->segments);
 
+    if (hg_bulk->registered_size)
+        hg_mem_usage_sub(HG_MEM_USAGE_BULK, hg_bulk->registered_size);
+
     /* Free addr if any was attached to handle */
     ret = HG_Core_addr_free(hg_bulk->hg_class->core_class, hg_bulk->addr);
     HG_CHECK_HG_ERROR(done, ret, "Could not free bulk addr");
@@ -846,6 +855,7 @@ hg_bulk_transfer(hg_context_t *context, hg_cb_t callback, void *arg,
     hg_bulk_op_id->op_count = 1; /* Default */
     hg_atomic_set32(&hg_bulk_op_id->op_completed_count, 0);
     hg_bulk_op_id->op = op;
+    hg_bulk_op_id->size = size;
     hg_bulk_op_id->hg_bulk_origin = hg_bulk_origin;
     hg_atomic_incr32(&hg_bulk_origin->ref_count); /* Increment ref count */
     hg_bulk_op_id->hg_bulk_local = hg_bulk_local;
@@ -887,6 +897,14 @@ hg_bulk_transfer(hg_context_t *context, hg_cb_t callback, void *arg,
             HG_NA_ERROR, "Could not create NA op ID");
     }
 
+    HG_TOOL_NOTIFY(HG_TOOL_BULK_START, context->core_context, NULL,
+        hg_bulk_op_id, size, HG_SUCCESS);
+
+    if (HG_CAPTURE_ENABLED())
+        hg_capture_bulk(hg_bulk_origin->serialize_ptr,
+            hg_bulk_origin->serialize_size, hg_bulk_origin->total_size, size,
+            op);
+
     /* Do actual transfer */
     ret = hg_bulk_transfer_pieces(na_bulk_op, na_origin_addr, origin_id, use_sm,
         hg_bulk_origin, origin_segment_start_index, origin_segment_start_offset,
@@ -920,6 +938,10 @@ hg_bulk_complete(struct hg_bulk_op_id *hg_bulk_op_id)
     /* Mark operation as completed */
     hg_atomic_incr32(&hg_bulk_op_id->completed);
 
+    HG_TOOL_NOTIFY(HG_TOOL_BULK_END, context->core_context, NULL,
+        hg_bulk_op_id, hg_bulk_op_id->size,
+        hg_atomic_get32(&hg_bulk_op_id->canceled) ? HG_CANCELED : HG_SUCCESS);
+
     if (hg_bulk_op_id->hg_bulk_origin->eager_mode) {
         /* In the case of eager bulk transfer, directly trigger the operation
          * to avoid potential deadlocks */
@@ -0,0 +1,276 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#include "mercury_capture.h"
+#include "mercury_error.h"
+#include "mercury_private.h"
+
+#include "mercury_list.h"
+#include "mercury_thread_mutex.h"
+#include "mercury_time.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/************************************/
+/* Local Type and Struct Definition */
+/************************************/
+
+/* Request being captured */
+struct hg_capture_entry {
+    struct hg_capture_record record;                    /* Record header */
+    struct hg_capture_bulk bulks[HG_CAPTURE_BULK_MAX]; /* Bulk records */
+    HG_LIST_ENTRY(hg_capture_entry) entry;              /* In-flight entry */
+    const char *in_buf; /* Input buffer of handle */
+    unsigned int gen;   /* Capture generation */
+    char in[1];         /* Copy of input */
+};
+
+/********************/
+/* Local Prototypes */
+/********************/
+
+/**
+ * Stop capture started from the environment.
+ */
+static void
+hg_capture_atexit(void);
+
+/*******************/
+/* Local Variables */
+/*******************/
+
+/* Capture is active */
+hg_atomic_int32_t hg_capture_enabled_g = HG_ATOMIC_VAR_INIT(0);
+
+/* Log file (NULL if not active) */
+static FILE *hg_capture_file_g = NULL;
+
+/* Incremented on each start, entries of previous captures are not written */
+static unsigned int hg_capture_gen_g = 0;
+
+/* Requests in flight */
+static HG_LIST_HEAD(hg_capture_entry) hg_capture_list_g =
+    HG_LIST_HEAD_INITIALIZER(hg_capture_list_g);
+
+/* Protects file and list */
+static hg_thread_mutex_t hg_capture_mutex_g = HG_THREAD_MUTEX_INITIALIZER;
+
+/* Environment was checked */
+static hg_bool_t hg_capture_env_checked_g = HG_FALSE;
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_capture_atexit(void)
+{
+    (void) HG_Capture_stop();
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_capture_init_env(void)
+{
+    const char *path;
+    hg_bool_t start = HG_FALSE;
+
+    hg_thread_mutex_lock(&hg_capture_mutex_g);
+    if (!hg_capture_env_checked_g) {
+        hg_capture_env_checked_g = HG_TRUE;
+        start = HG_TRUE;
+    }
+    hg_thread_mutex_unlock(&hg_capture_mutex_g);
+
+    path = getenv(HG_CAPTURE_FILE_ENV);
+    if (!start || path == NULL || *path == '\0')
+        return;
+
+    if (HG_Capture_start(path) != HG_SUCCESS)
+        return;
+
+    HG_CHECK_WARNING(atexit(hg_capture_atexit) != 0,
+        "Could not register capture stop at exit");
+}
+
+/*---------------------------------------------------------------------------*/
+struct hg_capture_entry *
+hg_capture_request(
+    hg_id_t id, hg_uint32_t flags, const void *in_buf, hg_size_t in_size)
+{
+    struct hg_capture_entry *hg_capture_entry;
+
+    hg_capture_entry = (struct hg_capture_entry *) malloc(
+        sizeof(struct hg_capture_entry) + in_size);
+    HG_CHECK_ERROR_NORET(
+        hg_capture_entry == NULL, done, "Could not allocate capture entry");
+
+    memset(&hg_capture_entry->record, 0, sizeof(struct hg_capture_record));
+    hg_capture_entry->record.time_ns = hg_time_fast_to_ns(hg_time_fast_now());
+    hg_capture_entry->record.id = id;
+    hg_capture_entry->record.in_size = (hg_uint32_t) in_size;
+    hg_capture_entry->record.flags = flags;
+    hg_capture_entry->in_buf = (const char *) in_buf;
+    memcpy(hg_capture_entry->in, in_buf, in_size);
+
+    hg_thread_mutex_lock(&hg_capture_mutex_g);
+    hg_capture_entry->gen = hg_capture_gen_g;
+    HG_LIST_INSERT_HEAD(&hg_capture_list_g, hg_capture_entry, entry);
+    hg_thread_mutex_unlock(&hg_capture_mutex_g);
+
+done:
+    return hg_capture_entry;
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_capture_respond(
+    struct hg_capture_entry *hg_capture_entry, hg_size_t out_size)
+{
+    hg_capture_entry->record.out_size = (hg_uint32_t) out_size;
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_capture_bulk(const void *desc, hg_size_t desc_size, hg_size_t bulk_size,
+    hg_size_t size, hg_bulk_op_t op)
+{
+    struct hg_capture_entry *hg_capture_entry;
+    const char *desc_ptr = (const char *) desc;
+
+    if (desc_ptr == NULL)
+        return;
+
+    hg_thread_mutex_lock(&hg_capture_mutex_g);
+
+    /* Find request whose input carried the descriptor */
+    HG_LIST_FOREACH (hg_capture_entry, &hg_capture_list_g, entry) {
+        struct hg_capture_record *record = &hg_capture_entry->record;
+        hg_uint32_t desc_offset, i;
+
+        if (desc_ptr < hg_capture_entry->in_buf ||
+            desc_ptr >= hg_capture_entry->in_buf + record->in_size)
+            continue;
+
+        /* Transfers on the same descriptor are accumulated */
+        desc_offset = (hg_uint32_t) (desc_ptr - hg_capture_entry->in_buf);
+        for (i = 0; i < record->bulk_count; i++)
+            if (hg_capture_entry->bulks[i].desc_offset == desc_offset)
+                break;
+        if (i == record->bulk_count) {
+            if (i == HG_CAPTURE_BULK_MAX)
+                break;
+            memset(&hg_capture_entry->bulks[i], 0,
+                sizeof(struct hg_capture_bulk));
+            hg_capture_entry->bulks[i].desc_offset = desc_offset;
+            hg_capture_entry->bulks[i].desc_size = (hg_uint32_t) desc_size;
+            hg_capture_entry->bulks[i].bulk_size = bulk_size;
+            hg_capture_entry->bulks[i].op = (hg_uint32_t) op;
+            record->bulk_count++;
+        }
+        hg_capture_entry->bulks[i].transfer_size += size;
+        break;
+    }
+
+    hg_thread_mutex_unlock(&hg_capture_mutex_g);
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_capture_complete(struct hg_capture_entry *hg_capture_entry)
+{
+    hg_thread_mutex_lock(&hg_capture_mutex_g);
+
+    HG_LIST_REMOVE(hg_capture_entry, entry);
+
+    if (hg_capture_file_g && hg_capture_entry->gen == hg_capture_gen_g) {
+        struct hg_capture_record *record = &hg_capture_entry->record;
+        size_t n = 0;
+
+        n += fwrite(record, sizeof(*record), 1, hg_capture_file_g);
+        n += fwrite(hg_capture_entry->in, 1, record->in_size,
+            hg_capture_file_g);
+        n += fwrite(hg_capture_entry->bulks, sizeof(struct hg_capture_bulk),
+            record->bulk_count, hg_capture_file_g);
+        HG_CHECK_WARNING(n != 1 + record->in_size + record->bulk_count,
+            "Could not write capture record");
+    }
+
+    hg_thread_mutex_unlock(&hg_capture_mutex_g);
+
+    free(hg_capture_entry);
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Capture_start(const char *path)
+{
+    struct hg_capture_file_header header;
+    hg_return_t ret = HG_SUCCESS;
+
+    HG_CHECK_ERROR(path == NULL, done, ret, HG_INVALID_ARG, "NULL path");
+
+    hg_thread_mutex_lock(&hg_capture_mutex_g);
+
+    if (hg_capture_file_g) {
+        hg_thread_mutex_unlock(&hg_capture_mutex_g);
+        HG_GOTO_ERROR(done, ret, HG_BUSY, "Capture is already active");
+    }
+
+    hg_capture_file_g = fopen(path, "wb");
+    if (hg_capture_file_g == NULL) {
+        hg_thread_mutex_unlock(&hg_capture_mutex_g);
+        HG_GOTO_ERROR(done, ret, HG_NOENTRY, "Could not open %s", path);
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, HG_CAPTURE_MAGIC, sizeof(header.magic));
+    header.version = HG_CAPTURE_VERSION;
+    if (fwrite(&header, sizeof(header), 1, hg_capture_file_g) != 1) {
+        fclose(hg_capture_file_g);
+        hg_capture_file_g = NULL;
+        hg_thread_mutex_unlock(&hg_capture_mutex_g);
+        HG_GOTO_ERROR(done, ret, HG_OTHER_ERROR, "Could not write %s", path);
+    }
+
+    hg_capture_gen_g++;
+    hg_atomic_set32(&hg_capture_enabled_g, 1);
+
+    hg_thread_mutex_unlock(&hg_capture_mutex_g);
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Capture_stop(void)
+{
+    hg_return_t ret = HG_SUCCESS;
+    int rc;
+
+    hg_thread_mutex_lock(&hg_capture_mutex_g);
+
+    if (hg_capture_file_g == NULL) {
+        hg_thread_mutex_unlock(&hg_capture_mutex_g);
+        HG_GOTO_ERROR(done, ret, HG_NOENTRY, "Capture is not active");
+    }
+
+    hg_atomic_set32(&hg_capture_enabled_g, 0);
+    rc = fclose(hg_capture_file_g);
+    hg_capture_file_g = NULL;
+
+    hg_thread_mutex_unlock(&hg_capture_mutex_g);
+
+    HG_CHECK_ERROR(
+        rc != 0, done, ret, HG_OTHER_ERROR, "Could not close capture file");
+
+done:
+    return ret;
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#ifndef MERCURY_CAPTURE_H
+#define MERCURY_CAPTURE_H
+
+#include "mercury_types.h"
+
+/*
+ * RPC traffic capture. While capture is active, every request received by
+ * a target is recorded to a binary log that can later be replayed against a
+ * server (see Testing/perf/hg_replay). The log is made of a file header
+ * followed by one record per request, written when the request completes:
+ *
+ *   struct hg_capture_file_header
+ *   { struct hg_capture_record                     (time_ns, id, sizes...)
+ *     in_size bytes of input                       (HG header and payload)
+ *     bulk_count x struct hg_capture_bulk }*       (bulk transfers)
+ *
+ * All values are stored in host byte order. Bulk transfers are attributed
+ * to the request whose input carried the origin bulk descriptor, only bulk
+ * sizes are recorded, not bulk data.
+ */
+
+/*************************************/
+/* Public Type and Struct Definition */
+/*************************************/
+
+/* File header */
+struct hg_capture_file_header {
+    char magic[8];       /* HG_CAPTURE_MAGIC */
+    hg_uint32_t version; /* HG_CAPTURE_VERSION */
+    hg_uint32_t reserved;
+};
+
+/* Request record */
+struct hg_capture_record {
+    hg_uint64_t time_ns;    /* Arrival time stamp (ns, monotonic) */
+    hg_uint64_t id;         /* RPC ID */
+    hg_uint32_t in_size;    /* Size of input that follows */
+    hg_uint32_t out_size;   /* Size of response payload (0 if none) */
+    hg_uint32_t bulk_count; /* Number of bulk records that follow input */
+    hg_uint32_t flags;      /* HG_CAPTURE_* flags */
+};
+
+/* Bulk record */
+struct hg_capture_bulk {
+    hg_uint32_t desc_offset;   /* Offset of bulk descriptor within input */
+    hg_uint32_t desc_size;     /* Size of serialized bulk descriptor */
+    hg_uint64_t bulk_size;     /* Size of data exposed by origin */
+    hg_uint64_t transfer_size; /* Total size transferred */
+    hg_uint32_t op;            /* hg_bulk_op_t of first transfer */
+    hg_uint32_t reserved;
+};
+
+/*****************/
+/* Public Macros */
+/*****************/
+
+#define HG_CAPTURE_MAGIC   "HGCAPTR1"
+#define HG_CAPTURE_VERSION 1
+
+/* Record flags */
+#define HG_CAPTURE_NO_RESPONSE (1 << 0) /* No response was expected */
+#define HG_CAPTURE_MORE_DATA   (1 << 1) /* Input exceeded eager size */
+
+/* Max number of bulk records per request */
+#define HG_CAPTURE_BULK_MAX 8
+
+/* Environment variable that starts capture to a file at init */
+#define HG_CAPTURE_FILE_ENV "HG_CAPTURE_FILE"
+
+/*********************/
+/* Public Prototypes */
+/*********************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Start capturing requests received by all classes of the process to the
+ * file at path (truncated if it exists). Capture can also be started at
+ * init time by setting HG_CAPTURE_FILE in the environment, in which case it
+ * is stopped at exit. When capture is not active, each request costs a
+ * single test of a global flag.
+ *
+ * \param path [IN]             path of log file
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+HG_Capture_start(const char *path);
+
+/**
+ * Stop capture and close log file. Requests still in flight are not
+ * recorded.
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+HG_Capture_stop(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MERCURY_CAPTURE_H */
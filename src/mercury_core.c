@@ -16,21 +16,24 @@
 #    include "mercury_event.h"
 #endif
 #include "mercury_error.h"
+#include "mercury_eventcount.h"
 #include "mercury_hash_table.h"
 #include "mercury_list.h"
 #include "mercury_mem.h"
 #include "mercury_poll.h"
 #include "mercury_queue.h"
-#include "mercury_thread_condition.h"
+#include "mercury_thread_lock_prof.h"
 #include "mercury_thread_mutex.h"
 #include "mercury_thread_pool.h"
 #include "mercury_thread_spin.h"
 #include "mercury_time.h"
+#include "mercury_timer_wheel.h"
 
 #ifdef HG_HAS_SM_ROUTING
 #    include <na_sm.h>
 #endif
 
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -41,8 +44,11 @@
 #define HG_CORE_ATOMIC_QUEUE_SIZE 1024
 #define HG_CORE_PENDING_INCR      256
 #define HG_CORE_CLEANUP_TIMEOUT   1000
-#define HG_CORE_MAX_EVENTS        1
+#define HG_CORE_MAX_EVENTS        3 /* One per poll source */
+
 #define HG_CORE_MAX_TRIGGER_COUNT 1
+/* Default threshold for sending extra payload as fragments */
+#define HG_CORE_FRAG_THRESHOLD_DEFAULT (64 * 1024)
 #ifdef HG_HAS_SM_ROUTING
 #    define HG_CORE_ADDR_MAX_SIZE   256
 #    define HG_CORE_PROTO_DELIMITER ":"
@@ -50,6 +56,14 @@
 #    define HG_CORE_MIN(a, b)       (a < b) ? a : b /* Min macro */
 #endif
 
+/* Memory held by a completion queue */
+#define HG_CORE_ATOMIC_QUEUE_MEM                                               \
+    (sizeof(struct hg_atomic_queue) +                                          \
+        HG_CORE_ATOMIC_QUEUE_SIZE * sizeof(hg_atomic_int64_t))
+
+/* Number of locks shown in lock profile report */
+#define HG_CORE_STATS_LOCK_COUNT 10
+
 /* Remove warnings when routine does not use arguments */
 #if defined(__cplusplus)
 #    define HG_UNUSED
@@ -73,6 +87,33 @@ typedef hg_atomic_int32_t hg_core_stat_t;
 #    define HG_CORE_STAT_INIT HG_ATOMIC_VAR_INIT
 #endif
 
+/* Progress loop accounting, only active if stats were requested at init */
+#ifdef HG_HAS_COLLECT_STATS
+#    define HG_CORE_ACCT_BEGIN(context, t)                                     \
+        do {                                                                   \
+            if ((context)->progress_acct)                                      \
+                (t) = hg_time_fast_now();                                      \
+        } while (0)
+#    define HG_CORE_ACCT_END(context, phase, t)                                \
+        do {                                                                   \
+            if ((context)->progress_acct)                                      \
+                hg_core_progress_acct_add((context)->progress_acct, phase, t); \
+        } while (0)
+#    define HG_CORE_ACCT_REPORT(context)                                       \
+        do {                                                                   \
+            if ((context)->progress_acct &&                                    \
+                (context)->progress_acct->interval_ns)                         \
+                hg_core_progress_acct_report(context);                         \
+        } while (0)
+#else
+#    define HG_CORE_ACCT_BEGIN(context, t)      ((void) (context), (void) (t))
+#    define HG_CORE_ACCT_END(context, phase, t) ((void) (context), (void) (t))
+#    define HG_CORE_ACCT_REPORT(context)        ((void) (context))
+#endif
+
+/* Env variable used to set the progress accounting report interval (s) */
+#define HG_CORE_PROGRESS_STATS_INTERVAL_ENV "HG_PROGRESS_STATS_INTERVAL"
+
 #define HG_CORE_CONTEXT_CLASS(context)                                         \
     ((struct hg_core_private_class *) (context->core_context.core_class))
 
@@ -81,6 +122,10 @@ typedef hg_atomic_int32_t hg_core_stat_t;
 #define HG_CORE_HANDLE_CONTEXT(handle)                                         \
     ((struct hg_core_private_context *) (handle->core_handle.info.context))
 
+/* Class and contexts are only used from one thread */
+#define HG_CORE_SINGLE_THREAD(hg_core_class)                                   \
+    ((hg_core_class)->progress_mode & NA_SINGLE_THREAD)
+
 /************************************/
 /* Local Type and Struct Definition */
 /************************************/
@@ -96,12 +141,14 @@ struct hg_core_private_class {
         hg_return_t (*done_callback)(hg_core_handle_t)); /* more_data_acquire */
     void (*more_data_release)(hg_core_handle_t);         /* more_data_release */
     na_tag_t request_max_tag;                            /* Max value for tag */
+    hg_size_t frag_threshold; /* Max extra payload size sent as fragments */
     hg_atomic_int32_t n_contexts;   /* Atomic used for number of contexts */
     hg_atomic_int32_t n_addrs;      /* Atomic used for number of addrs */
     hg_atomic_int32_t request_tag;  /* Atomic used for tag generation */
     hg_thread_spin_t func_map_lock; /* Function map lock */
-    na_uint32_t progress_mode;      /* NA progress mode */
-    hg_bool_t na_ext_init;          /* NA externally initialized */
+    hg_thread_lock_prof_t func_map_lock_prof; /* Function map lock profile */
+    na_uint32_t progress_mode;                /* NA progress mode */
+    hg_bool_t na_ext_init;                    /* NA externally initialized */
 #ifdef HG_HAS_COLLECT_STATS
     hg_bool_t stats; /* (Debug) Print stats at exit */
 #endif
@@ -116,12 +163,25 @@ typedef enum hg_core_poll_type {
     HG_CORE_POLL_NA
 } hg_core_poll_type_t;
 
+#ifdef HG_HAS_COLLECT_STATS
+/* Progress loop accounting */
+struct hg_core_progress_acct {
+    hg_atomic_int64_t count[HG_PROGRESS_PHASE_MAX]; /* Phase entry count */
+    hg_atomic_int64_t ticks[HG_PROGRESS_PHASE_MAX]; /* Time spent in phase */
+    hg_atomic_int64_t start;       /* Accounting start time stamp */
+    hg_atomic_int64_t last_report; /* Last periodic report time stamp */
+    hg_uint64_t interval_ns;       /* Periodic report interval (0 if none) */
+};
+#endif
+
 /* HG context */
 struct hg_core_private_context {
     struct hg_core_context core_context;      /* Must remain as first field */
-    hg_thread_cond_t completion_queue_cond;   /* Completion queue cond */
+    hg_eventcount_t completion_queue_ec;      /* Completion queue wait */
     hg_thread_mutex_t completion_queue_mutex; /* Completion queue mutex */
     hg_thread_mutex_t completion_queue_notify_mutex; /* Notify mutex */
+    hg_thread_lock_prof_t completion_queue_mutex_prof; /* Lock profiles */
+    hg_thread_lock_prof_t completion_queue_notify_mutex_prof;
     HG_QUEUE_HEAD(hg_completion_entry)
     backfill_queue;                           /* Backfill completion queue */
     struct hg_atomic_queue *completion_queue; /* Default completion queue */
@@ -136,17 +196,23 @@ struct hg_core_private_context {
     hg_return_t (*handle_create)(hg_core_handle_t, void *); /* handle_create */
     void *handle_create_arg;      /* handle_create arg */
     struct hg_poll_set *poll_set; /* Context poll set */
-    struct hg_poll_event
-        poll_events[HG_CORE_MAX_EVENTS]; /* Context poll events */
     hg_atomic_int32_t
         completion_queue_must_notify; /* Notify of completion queue events */
     hg_atomic_int32_t backfill_queue_count; /* Backfill queue count */
-    hg_atomic_int32_t trigger_waiting;      /* Waiting in trigger */
     hg_atomic_int32_t n_handles;        /* Atomic used for number of handles */
     hg_thread_spin_t created_list_lock; /* Handle list lock */
     hg_thread_spin_t pending_list_lock; /* Pending list lock */
+    hg_thread_lock_prof_t created_list_lock_prof; /* Lock profiles */
+    hg_thread_lock_prof_t pending_list_lock_prof;
+    struct hg_timer_wheel timer_wheel; /* Deadlines of timed forwards */
+    hg_thread_spin_t timer_wheel_lock; /* Timer wheel lock */
+    hg_thread_lock_prof_t timer_wheel_lock_prof; /* Timer wheel lock profile */
+    hg_atomic_int32_t n_timers;                  /* Number of armed timers */
 #ifdef HG_HAS_SELF_FORWARD
     int completion_queue_notify; /* Self notification */
+#endif
+#ifdef HG_HAS_COLLECT_STATS
+    struct hg_core_progress_acct *progress_acct; /* Progress accounting */
 #endif
     hg_bool_t finalizing; /* Prevent reposts */
 };
@@ -183,6 +249,16 @@ typedef enum {
     HG_CORE_PROCESS /*!< Process completion */
 } hg_core_op_type_t;
 
+/* HG core fragment (extra payload sent as expected message) */
+struct hg_core_frag {
+    struct hg_core_private_handle *hg_core_handle; /* Parent handle */
+    void *buf;                                     /* NA message buffer */
+    void *buf_plugin_data;                         /* NA plugin data */
+    char *dest;                                    /* Recv destination */
+    na_size_t size;                                /* Payload size */
+    na_op_id_t na_op_id;                           /* NA operation ID */
+};
+
 /* HG core handle */
 struct hg_core_private_handle {
     struct hg_core_handle core_handle; /* Must remain as first field */
@@ -214,12 +290,30 @@ struct hg_core_private_handle {
     na_size_t in_buf_used;     /* Amount of input buffer used */
     na_size_t out_buf_used;    /* Amount of output buffer used */
     na_tag_t tag;              /* Tag used for request and response */
+    struct hg_core_frag *send_frags; /* Fragments for sending extra payload */
+    struct hg_core_frag *recv_frags; /* Fragments for recving extra payload */
+    unsigned int send_frag_max;      /* Number of allocated send fragments */
+    unsigned int recv_frag_max;      /* Number of allocated recv fragments */
+    unsigned int send_frag_count;    /* Number of send fragments in use */
+    unsigned int recv_frag_count;    /* Number of recv fragments in use */
+    const void *frag_buf;            /* Extra payload to send as fragments */
+    na_size_t frag_buf_size;         /* Size of extra payload */
+    hg_return_t (*frag_done_callback)(
+        hg_core_handle_t); /* Called once all fragments are received */
+    struct hg_capture_entry *capture;    /* Request capture (target) */
+    struct hg_timer_wheel_node timer;    /* Forward deadline */
+    hg_atomic_int32_t frag_recv_pending; /* Fragments not yet received */
+    hg_atomic_int32_t frag_send_pending; /* Fragment sends not completed */
     hg_atomic_int32_t
         na_op_completed_count;   /* Number of NA operations completed */
     hg_atomic_int32_t in_use;    /* Is in use */
     hg_atomic_int32_t ref_count; /* Reference count */
     hg_atomic_int32_t posted;    /* Handle has been posted */
     hg_atomic_int32_t canceling; /* Handle is being canceled */
+    hg_atomic_int32_t timed_out; /* Forward deadline has expired */
+    hg_atomic_int32_t forward_gen; /* Incremented by each forward */
+    hg_atomic_int32_t expiring;    /* Deadline cancelations in progress */
+    hg_util_int32_t timer_gen;     /* Forward that armed timer (wheel lock) */
     unsigned int na_op_count;    /* Number of ongoing operations */
     hg_core_op_type_t op_type;   /* Core operation type */
     hg_return_t ret;             /* Return code associated to handle */
@@ -268,6 +362,37 @@ hg_core_int_hash(void *vlocation);
 static void
 hg_core_func_map_value_free(hg_hash_table_value_t value);
 
+/**
+ * Lock / unlock, no-ops in single-threaded mode. Lock profiles are used for
+ * contention profiling (see mercury_thread_lock_prof.h).
+ */
+static HG_INLINE void
+hg_core_spin_lock(struct hg_core_private_class *hg_core_class,
+    hg_thread_spin_t *lock, hg_thread_lock_prof_t prof);
+static HG_INLINE void
+hg_core_spin_unlock(
+    struct hg_core_private_class *hg_core_class, hg_thread_spin_t *lock);
+static HG_INLINE void
+hg_core_mutex_lock(struct hg_core_private_class *hg_core_class,
+    hg_thread_mutex_t *mutex, hg_thread_lock_prof_t prof);
+static HG_INLINE void
+hg_core_mutex_unlock(
+    struct hg_core_private_class *hg_core_class, hg_thread_mutex_t *mutex);
+
+/**
+ * Atomic operations, plain loads and stores in single-threaded mode.
+ */
+static HG_INLINE hg_util_int32_t
+hg_core_atomic_incr32(
+    struct hg_core_private_class *hg_core_class, hg_atomic_int32_t *ptr);
+static HG_INLINE hg_util_int32_t
+hg_core_atomic_decr32(
+    struct hg_core_private_class *hg_core_class, hg_atomic_int32_t *ptr);
+static HG_INLINE hg_util_bool_t
+hg_core_atomic_cas32(struct hg_core_private_class *hg_core_class,
+    hg_atomic_int32_t *ptr, hg_util_int32_t compare_value,
+    hg_util_int32_t swap_value);
+
 /**
  * Generate a new tag.
  */
@@ -454,6 +579,12 @@ static hg_return_t
 hg_core_process_input(
     struct hg_core_private_handle *hg_core_handle, hg_bool_t *completed);
 
+/**
+ * Start capturing received request.
+ */
+static void
+hg_core_capture_request(struct hg_core_private_handle *hg_core_handle);
+
 /**
  * Send output callback.
  */
@@ -491,6 +622,52 @@ hg_core_send_ack_cb(const struct na_cb_info *callback_info);
 static HG_INLINE int
 hg_core_recv_ack_cb(const struct na_cb_info *callback_info);
 
+/**
+ * Number of fragments required for buf_size.
+ */
+static HG_INLINE unsigned int
+hg_core_frag_count(
+    struct hg_core_private_handle *hg_core_handle, na_size_t buf_size);
+
+/**
+ * Make sure that count fragments are allocated.
+ */
+static hg_return_t
+hg_core_frag_alloc(struct hg_core_private_handle *hg_core_handle,
+    struct hg_core_frag **frags, unsigned int *frag_max, unsigned int count);
+
+/**
+ * Free fragments.
+ */
+static void
+hg_core_frag_free(struct hg_core_private_handle *hg_core_handle,
+    struct hg_core_frag **frags, unsigned int *frag_max);
+
+/**
+ * Post sends for extra payload fragments (HG_CORE_MORE_DATA_FRAG flag).
+ */
+static hg_return_t
+hg_core_send_frags(struct hg_core_private_handle *hg_core_handle);
+
+/**
+ * Send fragment callback.
+ */
+static HG_INLINE int
+hg_core_send_frag_cb(const struct na_cb_info *callback_info);
+
+/**
+ * Recv fragment callback.
+ */
+static HG_INLINE int
+hg_core_recv_frag_cb(const struct na_cb_info *callback_info);
+
+/**
+ * Complete handle once extra output has been received, no ack is needed.
+ * (HG_CORE_MORE_DATA_FRAG flag on output)
+ */
+static hg_return_t
+hg_core_complete_output(hg_core_handle_t handle);
+
 #ifdef HG_HAS_SELF_FORWARD
 /**
  * Wrapper for local callback execution.
@@ -554,7 +731,7 @@ hg_core_reset_post(struct hg_core_private_handle *hg_core_handle);
  * Make progress on NA layer.
  */
 static hg_return_t
-hg_core_progress_na(
+hg_core_progress_na(struct hg_core_private_context *context,
     na_class_t *na_class, na_context_t *na_context, unsigned int timeout);
 
 #ifdef HG_HAS_SELF_FORWARD
@@ -608,12 +785,104 @@ hg_bulk_trigger_entry(struct hg_bulk_op_id *hg_bulk_op_id);
 static hg_return_t
 hg_core_cancel(struct hg_core_private_handle *hg_core_handle);
 
+/**
+ * Forward handle, timeout (ms) of 0 means no deadline.
+ */
+static hg_return_t
+hg_core_forward(struct hg_core_private_handle *hg_core_handle,
+    hg_core_cb_t callback, void *arg, hg_uint8_t flags,
+    hg_size_t payload_size, unsigned int timeout);
+
+/**
+ * Current time in ms, unit of timer wheel ticks.
+ */
+static HG_INLINE hg_uint64_t
+hg_core_timer_now(void);
+
+/**
+ * Arm deadline of forward.
+ */
+static void
+hg_core_timer_arm(
+    struct hg_core_private_handle *hg_core_handle, unsigned int timeout);
+
+/**
+ * Disarm deadline of forward (no-op if not armed).
+ */
+static void
+hg_core_timer_disarm(struct hg_core_private_handle *hg_core_handle);
+
+/**
+ * Cancel forwards whose deadline has expired, they complete with HG_TIMEOUT.
+ */
+static void
+hg_core_timer_expire(struct hg_core_private_context *context);
+
+/**
+ * Bound timeout (ms) by the next deadline.
+ */
+static unsigned int
+hg_core_timer_wait(
+    struct hg_core_private_context *context, unsigned int timeout);
+
 #ifdef HG_HAS_COLLECT_STATS
 /**
  * Print stats.
  */
 static void
 hg_core_print_stats(void);
+
+/**
+ * Print memory usage.
+ */
+static void
+hg_core_print_mem_usage(void);
+
+/**
+ * Create progress accounting.
+ */
+static struct hg_core_progress_acct *
+hg_core_progress_acct_create(void);
+
+/**
+ * Reset progress accounting.
+ */
+static void
+hg_core_progress_acct_reset(struct hg_core_progress_acct *acct);
+
+/**
+ * Account time spent in phase since t.
+ */
+static HG_INLINE void
+hg_core_progress_acct_add(struct hg_core_progress_acct *acct,
+    hg_progress_phase_t phase, hg_time_fast_t t);
+
+/**
+ * Copy progress accounting into stats.
+ */
+static void
+hg_core_progress_acct_get(
+    struct hg_core_progress_acct *acct, struct hg_progress_stats *stats);
+
+/**
+ * Print progress accounting summary.
+ */
+static void
+hg_core_progress_acct_print(struct hg_core_private_context *context);
+
+/**
+ * Print progress accounting summary if report interval has elapsed.
+ */
+static void
+hg_core_progress_acct_report(struct hg_core_private_context *context);
+#endif
+
+#ifdef HG_UTIL_HAS_LOCK_PROF
+/**
+ * Print hottest locks at exit (only available with MERCURY_ENABLE_LOCK_PROF).
+ */
+static void
+hg_core_print_lock_prof(void);
 #endif
 
 /*******************/
@@ -626,6 +895,10 @@ static hg_core_stat_t hg_core_rpc_count_g = HG_CORE_STAT_INIT(0);
 static hg_core_stat_t hg_core_rpc_extra_count_g = HG_CORE_STAT_INIT(0);
 static hg_core_stat_t hg_core_bulk_count_g = HG_CORE_STAT_INIT(0);
 #endif
+#ifdef HG_UTIL_HAS_LOCK_PROF
+static hg_atomic_int32_t hg_core_print_lock_prof_registered_g =
+    HG_ATOMIC_VAR_INIT(0);
+#endif
 
 /*---------------------------------------------------------------------------*/
 #ifdef HG_HAS_COLLECT_STATS
@@ -642,6 +915,185 @@ hg_core_print_stats(void)
         (unsigned long) hg_core_stat_get(&hg_core_rpc_extra_count_g));
     printf("Bulk transfer count:  %lu\n",
         (unsigned long) hg_core_stat_get(&hg_core_bulk_count_g));
+    hg_core_print_mem_usage();
+}
+#endif
+
+/*---------------------------------------------------------------------------*/
+#ifdef HG_HAS_COLLECT_STATS
+static void
+hg_core_print_mem_usage(void)
+{
+    struct hg_mem_usage usage;
+    unsigned int i;
+
+    hg_mem_usage_get(&usage);
+
+    printf("Memory usage:         %16s %16s\n", "current", "high-water");
+    for (i = 0; i < HG_MEM_USAGE_MAX; i++)
+        printf("  %-19s %16lu %16lu\n",
+            hg_mem_usage_type_to_string((hg_mem_usage_type_t) i),
+            (unsigned long) usage.current[i],
+            (unsigned long) usage.high_water[i]);
+}
+#endif
+
+/*---------------------------------------------------------------------------*/
+#ifdef HG_UTIL_HAS_LOCK_PROF
+static void
+hg_core_print_lock_prof(void)
+{
+    struct hg_thread_lock_prof_info info[HG_CORE_STATS_LOCK_COUNT];
+    unsigned int count, i;
+
+    count = hg_thread_lock_prof_get(info, HG_CORE_STATS_LOCK_COUNT);
+    if (count == 0)
+        return;
+
+    printf("\n================================================================="
+           "\n");
+    printf("Mercury lock profile\n");
+    printf("--------------------\n");
+    printf("%-33s %16s %16s %16s\n", "Lock contention:", "acquired",
+        "contended", "wait (us)");
+    for (i = 0; i < count; i++)
+        printf("  %-31s %16lu %16lu %16lu\n", info[i].name,
+            (unsigned long) info[i].acquire_count,
+            (unsigned long) info[i].contended_count,
+            (unsigned long) (info[i].wait_ns / 1000));
+}
+#endif
+
+/*---------------------------------------------------------------------------*/
+#ifdef HG_HAS_COLLECT_STATS
+static struct hg_core_progress_acct *
+hg_core_progress_acct_create(void)
+{
+    struct hg_core_progress_acct *acct = NULL;
+    const char *interval_str;
+
+    acct = (struct hg_core_progress_acct *) malloc(
+        sizeof(struct hg_core_progress_acct));
+    HG_CHECK_ERROR_NORET(
+        acct == NULL, done, "Could not allocate progress accounting");
+
+    memset(acct, 0, sizeof(struct hg_core_progress_acct));
+    hg_core_progress_acct_reset(acct);
+
+    /* Periodic summary is printed if interval is set */
+    interval_str = getenv(HG_CORE_PROGRESS_STATS_INTERVAL_ENV);
+    if (interval_str) {
+        double interval = atof(interval_str);
+
+        if (interval > 0)
+            acct->interval_ns = (hg_uint64_t) (interval * 1000000000.0);
+    }
+
+done:
+    return acct;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_core_progress_acct_reset(struct hg_core_progress_acct *acct)
+{
+    hg_time_fast_t now = hg_time_fast_now();
+    unsigned int i;
+
+    for (i = 0; i < HG_PROGRESS_PHASE_MAX; i++) {
+        hg_atomic_init64(&acct->count[i], 0);
+        hg_atomic_init64(&acct->ticks[i], 0);
+    }
+    hg_atomic_set64(&acct->last_report, (hg_util_int64_t) now);
+    hg_atomic_set64(&acct->start, (hg_util_int64_t) now);
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE void
+hg_core_progress_acct_add(struct hg_core_progress_acct *acct,
+    hg_progress_phase_t phase, hg_time_fast_t t)
+{
+    hg_util_int64_t ticks = (hg_util_int64_t) (hg_time_fast_now() - t);
+    hg_util_int64_t old;
+
+    /* Contexts are usually progressed by a single thread, the CAS should
+     * therefore not be contended */
+    hg_atomic_incr64(&acct->count[phase]);
+    do {
+        old = hg_atomic_get64(&acct->ticks[phase]);
+    } while (!hg_atomic_cas64(&acct->ticks[phase], old, old + ticks));
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_core_progress_acct_get(
+    struct hg_core_progress_acct *acct, struct hg_progress_stats *stats)
+{
+    unsigned int i;
+
+    for (i = 0; i < HG_PROGRESS_PHASE_MAX; i++) {
+        stats->count[i] = (hg_uint64_t) hg_atomic_get64(&acct->count[i]);
+        stats->ns[i] = hg_time_fast_to_ns(
+            (hg_time_fast_t) hg_atomic_get64(&acct->ticks[i]));
+    }
+    stats->elapsed_ns = hg_time_fast_to_ns(
+        hg_time_fast_now() - (hg_time_fast_t) hg_atomic_get64(&acct->start));
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_core_progress_acct_print(struct hg_core_private_context *context)
+{
+    static const char *const phase_names[HG_PROGRESS_PHASE_MAX] = {"progress",
+        "poll_wait", "na_progress", "na_trigger", "trigger", "trigger_wait",
+        "callback"};
+    struct hg_progress_stats stats;
+    hg_uint64_t total_ns, idle_ns, busy_ns;
+    unsigned int i;
+
+    hg_core_progress_acct_get(context->progress_acct, &stats);
+    total_ns = stats.ns[HG_PROGRESS_PHASE_PROGRESS] +
+               stats.ns[HG_PROGRESS_PHASE_TRIGGER];
+    idle_ns = stats.ns[HG_PROGRESS_PHASE_POLL_WAIT] +
+              stats.ns[HG_PROGRESS_PHASE_TRIGGER_WAIT];
+    busy_ns = (total_ns > idle_ns) ? total_ns - idle_ns : 0;
+
+    printf("\n================================================================="
+           "\n");
+    printf("Mercury progress report (context %u, %.3f s elapsed)\n",
+        (unsigned int) context->core_context.id,
+        (double) stats.elapsed_ns / 1e9);
+    printf("-------------------\n");
+    printf("%-14s %12s %14s %10s\n", "Phase", "Count", "Time (ms)",
+        "Avg (us)");
+    for (i = 0; i < HG_PROGRESS_PHASE_MAX; i++) {
+        double avg_us = 0.0;
+
+        if (stats.count[i])
+            avg_us = (double) stats.ns[i] / 1e3 / (double) stats.count[i];
+
+        printf("%-14s %12lu %14.3f %10.3f\n", phase_names[i],
+            (unsigned long) stats.count[i], (double) stats.ns[i] / 1e6, avg_us);
+    }
+    printf("Idle/busy:      %.3f / %.3f ms (%.1f%% idle)\n",
+        (double) idle_ns / 1e6, (double) busy_ns / 1e6,
+        total_ns ? 100.0 * (double) idle_ns / (double) total_ns : 0.0);
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_core_progress_acct_report(struct hg_core_private_context *context)
+{
+    struct hg_core_progress_acct *acct = context->progress_acct;
+    hg_util_int64_t last = hg_atomic_get64(&acct->last_report);
+    hg_time_fast_t now = hg_time_fast_now();
+
+    if (hg_time_fast_to_ns(now - (hg_time_fast_t) last) < acct->interval_ns)
+        return;
+
+    /* Only one thread prints the summary */
+    if (hg_atomic_cas64(&acct->last_report, last, (hg_util_int64_t) now))
+        hg_core_progress_acct_print(context);
 }
 #endif
 
@@ -671,6 +1123,88 @@ hg_core_func_map_value_free(hg_hash_table_value_t value)
     free(hg_core_rpc_info);
 }
 
+/*---------------------------------------------------------------------------*/
+static HG_INLINE void
+hg_core_spin_lock(struct hg_core_private_class *hg_core_class,
+    hg_thread_spin_t *lock, hg_thread_lock_prof_t prof)
+{
+    if (!HG_CORE_SINGLE_THREAD(hg_core_class))
+        hg_thread_spin_lock_prof(lock, prof);
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE void
+hg_core_spin_unlock(
+    struct hg_core_private_class *hg_core_class, hg_thread_spin_t *lock)
+{
+    if (!HG_CORE_SINGLE_THREAD(hg_core_class))
+        hg_thread_spin_unlock(lock);
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE void
+hg_core_mutex_lock(struct hg_core_private_class *hg_core_class,
+    hg_thread_mutex_t *mutex, hg_thread_lock_prof_t prof)
+{
+    if (!HG_CORE_SINGLE_THREAD(hg_core_class))
+        hg_thread_mutex_lock_prof(mutex, prof);
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE void
+hg_core_mutex_unlock(
+    struct hg_core_private_class *hg_core_class, hg_thread_mutex_t *mutex)
+{
+    if (!HG_CORE_SINGLE_THREAD(hg_core_class))
+        hg_thread_mutex_unlock(mutex);
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE hg_util_int32_t
+hg_core_atomic_incr32(
+    struct hg_core_private_class *hg_core_class, hg_atomic_int32_t *ptr)
+{
+    if (HG_CORE_SINGLE_THREAD(hg_core_class)) {
+        hg_util_int32_t value = hg_atomic_get32(ptr) + 1;
+
+        hg_atomic_set32(ptr, value);
+        return value;
+    }
+
+    return hg_atomic_incr32(ptr);
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE hg_util_int32_t
+hg_core_atomic_decr32(
+    struct hg_core_private_class *hg_core_class, hg_atomic_int32_t *ptr)
+{
+    if (HG_CORE_SINGLE_THREAD(hg_core_class)) {
+        hg_util_int32_t value = hg_atomic_get32(ptr) - 1;
+
+        hg_atomic_set32(ptr, value);
+        return value;
+    }
+
+    return hg_atomic_decr32(ptr);
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE hg_util_bool_t
+hg_core_atomic_cas32(struct hg_core_private_class *hg_core_class,
+    hg_atomic_int32_t *ptr, hg_util_int32_t compare_value,
+    hg_util_int32_t swap_value)
+{
+    if (HG_CORE_SINGLE_THREAD(hg_core_class)) {
+        if (hg_atomic_get32(ptr) != compare_value)
+            return HG_UTIL_FALSE;
+        hg_atomic_set32(ptr, swap_value);
+        return HG_UTIL_TRUE;
+    }
+
+    return hg_atomic_cas32(ptr, compare_value, swap_value);
+}
+
 /*---------------------------------------------------------------------------*/
 static HG_INLINE na_tag_t
 hg_core_gen_request_tag(struct hg_core_private_class *hg_core_class)
@@ -678,10 +1212,11 @@ hg_core_gen_request_tag(struct hg_core_private_class *hg_core_class)
     na_tag_t request_tag = 0;
 
     /* Compare and swap tag if reached max tag */
-    if (!hg_atomic_cas32(&hg_core_class->request_tag,
+    if (!hg_core_atomic_cas32(hg_core_class, &hg_core_class->request_tag,
             (hg_util_int32_t) hg_core_class->request_max_tag, 0)) {
         /* Increment tag */
-        request_tag = (na_tag_t) hg_atomic_incr32(&hg_core_class->request_tag);
+        request_tag = (na_tag_t) hg_core_atomic_incr32(
+            hg_core_class, &hg_core_class->request_tag);
     }
 
     return request_tag;
@@ -744,7 +1279,8 @@ hg_core_pending_list_cancel(struct hg_core_private_context *context)
     struct hg_core_private_handle *hg_core_handle;
     hg_return_t ret = HG_SUCCESS;
 
-    hg_thread_spin_lock(&context->pending_list_lock);
+    hg_core_spin_lock(HG_CORE_CONTEXT_CLASS(context),
+        &context->pending_list_lock, context->pending_list_lock_prof);
 
     HG_QUEUE_FOREACH (hg_core_handle, &context->pending_list, pending) {
         /* Prevent reposts */
@@ -767,7 +1303,8 @@ hg_core_pending_list_cancel(struct hg_core_private_context *context)
 #endif
 
 done:
-    hg_thread_spin_unlock(&context->pending_list_lock);
+    hg_core_spin_unlock(HG_CORE_CONTEXT_CLASS(context),
+        &context->pending_list_lock);
     return ret;
 }
 
@@ -788,10 +1325,10 @@ hg_core_context_lists_wait(struct hg_core_private_context *context)
 
     do {
         unsigned int actual_count = 0;
-        hg_time_t t1, t2;
+        hg_time_fast_t t1, t2;
         hg_return_t trigger_ret, progress_ret;
 
-        hg_time_get_current_ms(&t1);
+        t1 = hg_time_fast_now();
 
         /* Trigger everything we can from HG */
         do {
@@ -800,16 +1337,20 @@ hg_core_context_lists_wait(struct hg_core_private_context *context)
         HG_CHECK_ERROR(trigger_ret != HG_SUCCESS && trigger_ret != HG_TIMEOUT,
             done, ret, trigger_ret, "Could not trigger entry");
 
-        hg_thread_spin_lock(&context->created_list_lock);
+        hg_core_spin_lock(HG_CORE_CONTEXT_CLASS(context),
+            &context->created_list_lock, context->created_list_lock_prof);
         created_list_empty = HG_LIST_IS_EMPTY(&context->created_list);
-        hg_thread_spin_unlock(&context->created_list_lock);
+        hg_core_spin_unlock(HG_CORE_CONTEXT_CLASS(context),
+            &context->created_list_lock);
 
-        hg_thread_spin_lock(&context->pending_list_lock);
+        hg_core_spin_lock(HG_CORE_CONTEXT_CLASS(context),
+            &context->pending_list_lock, context->pending_list_lock_prof);
         pending_list_empty = HG_LIST_IS_EMPTY(&context->pending_list);
 #ifdef HG_HAS_SM_ROUTING
         sm_pending_list_empty = HG_LIST_IS_EMPTY(&context->sm_pending_list);
 #endif
-        hg_thread_spin_unlock(&context->pending_list_lock);
+        hg_core_spin_unlock(HG_CORE_CONTEXT_CLASS(context),
+            &context->pending_list_lock);
 
         if (created_list_empty && pending_list_empty && sm_pending_list_empty)
             break;
@@ -818,8 +1359,8 @@ hg_core_context_lists_wait(struct hg_core_private_context *context)
             hg_core_progress(context, (unsigned int) (remaining * 1000.0));
         HG_CHECK_ERROR(progress_ret != HG_SUCCESS && progress_ret != HG_TIMEOUT,
             done, ret, progress_ret, "Could not make progress");
-        hg_time_get_current_ms(&t2);
-        remaining -= hg_time_diff(t2, t1);
+        t2 = hg_time_fast_now();
+        remaining -= hg_time_fast_diff(t2, t1);
         if (remaining < 0)
             remaining = 0;
     } while (remaining > 0 || !pending_list_empty || !sm_pending_list_empty);
@@ -842,6 +1383,8 @@ hg_core_init(const char *na_info_string, hg_bool_t na_listen,
     na_tag_t na_sm_max_tag;
     hg_bool_t auto_sm = HG_FALSE;
 #endif
+    struct na_init_info na_init_info = NA_INIT_INFO_INITIALIZER;
+    const struct na_init_info *na_init_info_p = NULL;
     hg_return_t ret = HG_SUCCESS;
 
     /* Create new HG class */
@@ -858,7 +1401,11 @@ hg_core_init(const char *na_info_string, hg_bool_t na_listen,
             hg_core_class->core_class.na_class = hg_init_info->na_class;
             hg_core_class->na_ext_init = HG_TRUE;
         }
-        hg_core_class->progress_mode = hg_init_info->na_init_info.progress_mode;
+        na_init_info = hg_init_info->na_init_info;
+        if (hg_init_info->single_threaded)
+            na_init_info.progress_mode |= NA_SINGLE_THREAD;
+        na_init_info_p = &na_init_info;
+        hg_core_class->progress_mode = na_init_info.progress_mode;
 #ifdef HG_HAS_SM_ROUTING
         auto_sm = hg_init_info->auto_sm;
 #else
@@ -877,10 +1424,22 @@ hg_core_init(const char *na_info_string, hg_bool_t na_listen,
 #endif
     }
 
+#ifdef HG_UTIL_HAS_LOCK_PROF
+    /* Lock profile is always reported when profiling is built in */
+    if (hg_atomic_cas32(&hg_core_print_lock_prof_registered_g, 0, 1)) {
+        int rc = atexit(hg_core_print_lock_prof);
+        HG_CHECK_ERROR(rc != 0, error, ret, HG_PROTOCOL_ERROR,
+            "Could not register hg_core_print_lock_prof");
+    }
+#endif
+
+    /* Start capture if requested from the environment */
+    hg_capture_init_env();
+
     /* Initialize NA if not provided externally */
     if (!hg_core_class->na_ext_init) {
-        hg_core_class->core_class.na_class = NA_Initialize_opt(
-            na_info_string, na_listen, &hg_init_info->na_init_info);
+        hg_core_class->core_class.na_class =
+            NA_Initialize_opt(na_info_string, na_listen, na_init_info_p);
         HG_CHECK_ERROR(hg_core_class->core_class.na_class == NULL, error, ret,
             HG_NA_ERROR, "Could not initialize NA class");
     }
@@ -899,7 +1458,7 @@ hg_core_init(const char *na_info_string, hg_bool_t na_listen,
 
         /* Initialize NA SM first so that tmp directories are created */
         hg_core_class->core_class.na_sm_class =
-            NA_Initialize_opt("na+sm", na_listen, &hg_init_info->na_init_info);
+            NA_Initialize_opt("na+sm", na_listen, na_init_info_p);
         HG_CHECK_ERROR(hg_core_class->core_class.na_sm_class == NULL, error,
             ret, HG_NA_ERROR, "Could not initialize NA SM class");
 
@@ -916,6 +1475,15 @@ hg_core_init(const char *na_info_string, hg_bool_t na_listen,
         na_max_tag == 0, error, ret, HG_NA_ERROR, "NA Max tag is not defined");
     hg_core_class->request_max_tag = na_max_tag;
 
+    /* Fragments rely on expected messages being buffered by the plugin when
+     * they arrive before the corresponding recv is posted, and on messages of
+     * a same tag being delivered in order. Other plugins (e.g., ofi, which may
+     * reorder sends retried on FI_EAGAIN) default to bulk transfers. */
+    if (NA_Msg_has_early_expected(hg_core_class->core_class.na_class))
+        hg_core_class->frag_threshold = HG_CORE_FRAG_THRESHOLD_DEFAULT;
+    else
+        hg_core_class->frag_threshold = 0;
+
 #ifdef HG_HAS_SM_ROUTING
     if (auto_sm) {
         na_sm_max_tag =
@@ -948,6 +1516,8 @@ hg_core_init(const char *na_info_string, hg_bool_t na_listen,
 
     /* Initialize mutex */
     hg_thread_spin_init(&hg_core_class->func_map_lock);
+    hg_core_class->func_map_lock_prof =
+        hg_thread_lock_prof_register("hg_core.func_map");
 
     // TODO
     (void) ret;
@@ -1034,7 +1604,7 @@ hg_core_addr_create(
     hg_atomic_init32(&hg_core_addr->ref_count, 1);
 
     /* Increment N addrs from HG class */
-    hg_atomic_incr32(&hg_core_class->n_addrs);
+    hg_core_atomic_incr32(hg_core_class, &hg_core_class->n_addrs);
 
 done:
     return hg_core_addr;
@@ -1128,12 +1698,12 @@ hg_core_addr_free(struct hg_core_private_class *hg_core_class,
     if (!hg_core_addr)
         goto done;
 
-    if (hg_atomic_decr32(&hg_core_addr->ref_count))
+    if (hg_core_atomic_decr32(hg_core_class, &hg_core_addr->ref_count))
         /* Cannot free yet */
         goto done;
 
     /* Decrement N addrs from HG class */
-    hg_atomic_decr32(&hg_core_class->n_addrs);
+    hg_core_atomic_decr32(hg_core_class, &hg_core_class->n_addrs);
 
 #ifdef HG_HAS_SM_ROUTING
     /* Self address case with SM */
@@ -1224,7 +1794,7 @@ hg_core_addr_dup(struct hg_core_private_class *hg_core_class,
 
         *hg_new_addr = dup;
     } else {
-        hg_atomic_incr32(&hg_core_addr->ref_count);
+        hg_core_atomic_incr32(hg_core_class, &hg_core_addr->ref_count);
         *hg_new_addr = hg_core_addr;
     }
 
@@ -1309,6 +1879,8 @@ hg_core_create(struct hg_core_private_context *context, hg_bool_t use_sm)
         sizeof(struct hg_core_private_handle));
     HG_CHECK_ERROR_NORET(
         hg_core_handle == NULL, error, "Could not allocate handle");
+    hg_mem_usage_add(
+        HG_MEM_USAGE_HANDLE, sizeof(struct hg_core_private_handle));
 
     memset(hg_core_handle, 0, sizeof(struct hg_core_private_handle));
 
@@ -1324,11 +1896,12 @@ hg_core_create(struct hg_core_private_context *context, hg_bool_t use_sm)
     hg_core_handle->ret = HG_SUCCESS;
 
     /* Add handle to handle list so that we can track it */
-    hg_thread_spin_lock(
-        &HG_CORE_HANDLE_CONTEXT(hg_core_handle)->created_list_lock);
+    hg_core_spin_lock(HG_CORE_HANDLE_CLASS(hg_core_handle),
+        &HG_CORE_HANDLE_CONTEXT(hg_core_handle)->created_list_lock,
+        HG_CORE_HANDLE_CONTEXT(hg_core_handle)->created_list_lock_prof);
     HG_LIST_INSERT_HEAD(&HG_CORE_HANDLE_CONTEXT(hg_core_handle)->created_list,
         hg_core_handle, created);
-    hg_thread_spin_unlock(
+    hg_core_spin_unlock(HG_CORE_HANDLE_CLASS(hg_core_handle),
         &HG_CORE_HANDLE_CONTEXT(hg_core_handle)->created_list_lock);
 
     /* Handle is not in use */
@@ -1340,6 +1913,17 @@ hg_core_create(struct hg_core_private_context *context, hg_bool_t use_sm)
     /* Handle is not being canceled */
     hg_atomic_init32(&hg_core_handle->canceling, HG_FALSE);
 
+    /* No deadline */
+    hg_timer_wheel_node_init(&hg_core_handle->timer);
+    hg_atomic_init32(&hg_core_handle->timed_out, HG_FALSE);
+    hg_atomic_init32(&hg_core_handle->forward_gen, 0);
+    hg_atomic_init32(&hg_core_handle->expiring, 0);
+    hg_core_handle->timer_gen = 0;
+
+    /* No fragment pending */
+    hg_atomic_init32(&hg_core_handle->frag_recv_pending, 0);
+    hg_atomic_init32(&hg_core_handle->frag_send_pending, 0);
+
     /* Init in/out header */
     hg_core_header_request_init(&hg_core_handle->in_header);
     hg_core_header_response_init(&hg_core_handle->out_header);
@@ -1348,7 +1932,7 @@ hg_core_create(struct hg_core_private_context *context, hg_bool_t use_sm)
     hg_atomic_init32(&hg_core_handle->ref_count, 1);
 
     /* Increment N handles from HG context */
-    hg_atomic_incr32(&context->n_handles);
+    hg_core_atomic_incr32(HG_CORE_CONTEXT_CLASS(context), &context->n_handles);
 
     /* Alloc/init NA resources */
     ret = hg_core_alloc_na(hg_core_handle, use_sm);
@@ -1368,18 +1952,27 @@ hg_core_destroy(struct hg_core_private_handle *hg_core_handle)
     if (!hg_core_handle)
         goto done;
 
-    if (hg_atomic_decr32(&hg_core_handle->ref_count))
+    if (hg_core_atomic_decr32(
+            HG_CORE_HANDLE_CLASS(hg_core_handle), &hg_core_handle->ref_count))
         goto done; /* Cannot free yet */
 
+    /* Request is complete, write its record */
+    if (hg_core_handle->capture) {
+        hg_capture_complete(hg_core_handle->capture);
+        hg_core_handle->capture = NULL;
+    }
+
     /* Remove handle from list */
-    hg_thread_spin_lock(
-        &HG_CORE_HANDLE_CONTEXT(hg_core_handle)->created_list_lock);
+    hg_core_spin_lock(HG_CORE_HANDLE_CLASS(hg_core_handle),
+        &HG_CORE_HANDLE_CONTEXT(hg_core_handle)->created_list_lock,
+        HG_CORE_HANDLE_CONTEXT(hg_core_handle)->created_list_lock_prof);
     HG_LIST_REMOVE(hg_core_handle, created);
-    hg_thread_spin_unlock(
+    hg_core_spin_unlock(HG_CORE_HANDLE_CLASS(hg_core_handle),
         &HG_CORE_HANDLE_CONTEXT(hg_core_handle)->created_list_lock);
 
     /* Decrement N handles from HG context */
-    hg_atomic_decr32(&HG_CORE_HANDLE_CONTEXT(hg_core_handle)->n_handles);
+    hg_core_atomic_decr32(HG_CORE_HANDLE_CLASS(hg_core_handle),
+        &HG_CORE_HANDLE_CONTEXT(hg_core_handle)->n_handles);
 
     /* Remove reference to HG addr */
     hg_core_addr_free(HG_CORE_HANDLE_CLASS(hg_core_handle),
@@ -1402,6 +1995,8 @@ hg_core_destroy(struct hg_core_private_handle *hg_core_handle)
     hg_core_free_na(hg_core_handle);
 
     free(hg_core_handle);
+    hg_mem_usage_sub(
+        HG_MEM_USAGE_HANDLE, sizeof(struct hg_core_private_handle));
 
 done:
     return;
@@ -1445,6 +2040,8 @@ hg_core_alloc_na(
         &hg_core_handle->in_buf_plugin_data);
     HG_CHECK_ERROR(hg_core_handle->core_handle.in_buf == NULL, error, ret,
         HG_NOMEM, "Could not allocate buffer for input");
+    hg_mem_usage_add(
+        HG_MEM_USAGE_MSG_BUF, hg_core_handle->core_handle.in_buf_size);
 
     na_ret = NA_Msg_init_unexpected(hg_core_handle->na_class,
         hg_core_handle->core_handle.in_buf,
@@ -1457,6 +2054,8 @@ hg_core_alloc_na(
         &hg_core_handle->out_buf_plugin_data);
     HG_CHECK_ERROR(hg_core_handle->core_handle.out_buf == NULL, error, ret,
         HG_NOMEM, "Could not allocate buffer for output");
+    hg_mem_usage_add(
+        HG_MEM_USAGE_MSG_BUF, hg_core_handle->core_handle.out_buf_size);
 
     na_ret = NA_Msg_init_expected(hg_core_handle->na_class,
         hg_core_handle->core_handle.out_buf,
@@ -1510,21 +2109,30 @@ hg_core_free_na(struct hg_core_private_handle *hg_core_handle)
         "Could not destroy ack op ID (%s)", NA_Error_to_string(na_ret));
     hg_core_handle->na_ack_op_id = NA_OP_ID_NULL;
 
-    /* Free buffers */
-    na_ret = NA_Msg_buf_free(hg_core_handle->na_class,
-        hg_core_handle->core_handle.in_buf, hg_core_handle->in_buf_plugin_data);
-    HG_CHECK_ERROR_NORET(na_ret != NA_SUCCESS, done,
-        "Could not free input buffer (%s)", NA_Error_to_string(na_ret));
-    hg_core_handle->core_handle.in_buf = NULL;
-    hg_core_handle->in_buf_plugin_data = NULL;
+    /* Free buffers (only account for buffers that were allocated) */
+    if (hg_core_handle->core_handle.in_buf) {
+        na_ret = NA_Msg_buf_free(hg_core_handle->na_class,
+            hg_core_handle->core_handle.in_buf,
+            hg_core_handle->in_buf_plugin_data);
+        HG_CHECK_ERROR_NORET(na_ret != NA_SUCCESS, done,
+            "Could not free input buffer (%s)", NA_Error_to_string(na_ret));
+        hg_mem_usage_sub(
+            HG_MEM_USAGE_MSG_BUF, hg_core_handle->core_handle.in_buf_size);
+        hg_core_handle->core_handle.in_buf = NULL;
+        hg_core_handle->in_buf_plugin_data = NULL;
+    }
 
-    na_ret = NA_Msg_buf_free(hg_core_handle->na_class,
-        hg_core_handle->core_handle.out_buf,
-        hg_core_handle->out_buf_plugin_data);
-    HG_CHECK_ERROR_NORET(na_ret != NA_SUCCESS, done,
-        "Could not free output buffer (%s)", NA_Error_to_string(na_ret));
-    hg_core_handle->core_handle.out_buf = NULL;
-    hg_core_handle->out_buf_plugin_data = NULL;
+    if (hg_core_handle->core_handle.out_buf) {
+        na_ret = NA_Msg_buf_free(hg_core_handle->na_class,
+            hg_core_handle->core_handle.out_buf,
+            hg_core_handle->out_buf_plugin_data);
+        HG_CHECK_ERROR_NORET(na_ret != NA_SUCCESS, done,
+            "Could not free output buffer (%s)", NA_Error_to_string(na_ret));
+        hg_mem_usage_sub(
+            HG_MEM_USAGE_MSG_BUF, hg_core_handle->core_handle.out_buf_size);
+        hg_core_handle->core_handle.out_buf = NULL;
+        hg_core_handle->out_buf_plugin_data = NULL;
+    }
 
     if (hg_core_handle->ack_buf) {
         na_ret = NA_Msg_buf_free(hg_core_handle->na_class,
@@ -1535,6 +2143,12 @@ hg_core_free_na(struct hg_core_private_handle *hg_core_handle)
         hg_core_handle->ack_buf_plugin_data = NULL;
     }
 
+    /* Free fragments */
+    hg_core_frag_free(hg_core_handle, &hg_core_handle->send_frags,
+        &hg_core_handle->send_frag_max);
+    hg_core_frag_free(hg_core_handle, &hg_core_handle->recv_frags,
+        &hg_core_handle->recv_frag_max);
+
 done:
     return;
 }
@@ -1544,6 +2158,12 @@ static void
 hg_core_reset(
     struct hg_core_private_handle *hg_core_handle, hg_bool_t reset_info)
 {
+    /* Request is complete, write its record */
+    if (hg_core_handle->capture) {
+        hg_capture_complete(hg_core_handle->capture);
+        hg_core_handle->capture = NULL;
+    }
+
     /* Reset source address */
     if (reset_info) {
         if (hg_core_handle->core_handle.info.addr != HG_CORE_ADDR_NULL &&
@@ -1571,6 +2191,11 @@ hg_core_reset(
     hg_core_handle->na_op_count = 1; /* Default (no response) */
     hg_atomic_set32(&hg_core_handle->na_op_completed_count, 0);
     hg_core_handle->no_response = HG_FALSE;
+    hg_core_handle->send_frag_count = 0;
+    hg_core_handle->recv_frag_count = 0;
+    hg_core_handle->frag_buf = NULL;
+    hg_core_handle->frag_buf_size = 0;
+    hg_core_handle->frag_done_callback = NULL;
 
     /* Free extra data here if needed */
     if (HG_CORE_HANDLE_CLASS(hg_core_handle)->more_data_release)
@@ -1609,7 +2234,9 @@ hg_core_set_rpc(struct hg_core_private_handle *hg_core_handle,
             hg_core_addr_free(
                 HG_CORE_HANDLE_CLASS(hg_core_handle), *handle_addr);
         *handle_addr = addr;
-        hg_atomic_incr32(&(*addr).ref_count); /* Increase ref to addr */
+        /* Increase ref to addr */
+        hg_core_atomic_incr32(
+            HG_CORE_HANDLE_CLASS(hg_core_handle), &(*addr).ref_count);
 
         /* Set forward call depending on address self */
         hg_core_handle->is_self =
@@ -1628,12 +2255,13 @@ hg_core_set_rpc(struct hg_core_private_handle *hg_core_handle,
         struct hg_core_rpc_info *hg_core_rpc_info;
 
         /* Retrieve ID function from function map */
-        hg_thread_spin_lock(
-            &HG_CORE_HANDLE_CLASS(hg_core_handle)->func_map_lock);
+        hg_core_spin_lock(HG_CORE_HANDLE_CLASS(hg_core_handle),
+            &HG_CORE_HANDLE_CLASS(hg_core_handle)->func_map_lock,
+            HG_CORE_HANDLE_CLASS(hg_core_handle)->func_map_lock_prof);
         hg_core_rpc_info = (struct hg_core_rpc_info *) hg_hash_table_lookup(
             HG_CORE_HANDLE_CLASS(hg_core_handle)->func_map,
             (hg_hash_table_key_t) &id);
-        hg_thread_spin_unlock(
+        hg_core_spin_unlock(HG_CORE_HANDLE_CLASS(hg_core_handle),
             &HG_CORE_HANDLE_CLASS(hg_core_handle)->func_map_lock);
         if (!hg_core_rpc_info)
             HG_GOTO_DONE(done, ret, HG_NOENTRY);
@@ -1658,6 +2286,12 @@ hg_core_forward_self(struct hg_core_private_handle *hg_core_handle)
     /* Set operation type for trigger */
     hg_core_handle->op_type = HG_CORE_FORWARD_SELF;
 
+    /* Request is processed inline, notify before target events */
+    HG_TOOL_NOTIFY(HG_TOOL_FORWARD_POSTED,
+        hg_core_handle->core_handle.info.context,
+        (hg_core_handle_t) hg_core_handle, NULL, hg_core_handle->in_buf_used,
+        HG_SUCCESS);
+
     /* Post operation to self processing pool */
     ret = hg_core_process_self(hg_core_handle);
     HG_CHECK_HG_ERROR(done, ret, "Could not self process handle");
@@ -1699,7 +2333,21 @@ hg_core_forward_na(struct hg_core_private_handle *hg_core_handle)
         hg_core_handle->na_op_count++;
 
         /* Take reference to make sure the handle does not get freed */
-        hg_atomic_incr32(&hg_core_handle->ref_count);
+        hg_core_atomic_incr32(HG_CORE_HANDLE_CLASS(hg_core_handle),
+            &hg_core_handle->ref_count);
+    }
+
+    /* Extra payload fragments are sent right after the request */
+    if (hg_core_handle->frag_buf_size > 0) {
+        ret = hg_core_frag_alloc(hg_core_handle, &hg_core_handle->send_frags,
+            &hg_core_handle->send_frag_max,
+            hg_core_frag_count(hg_core_handle, hg_core_handle->frag_buf_size));
+        HG_CHECK_HG_ERROR(cancel, ret, "Could not allocate fragments");
+
+        /* Increment number of expected NA operations */
+        hg_core_handle->send_frag_count =
+            hg_core_frag_count(hg_core_handle, hg_core_handle->frag_buf_size);
+        hg_core_handle->na_op_count += hg_core_handle->send_frag_count;
     }
 
     /* Mark handle as posted */
@@ -1720,12 +2368,20 @@ hg_core_forward_na(struct hg_core_private_handle *hg_core_handle)
         "Could not post send for input buffer (%s)",
         NA_Error_to_string(na_ret));
 
+    /* Request is on its way, errors are reported through the callback */
+    if (hg_core_handle->send_frag_count > 0) {
+        hg_return_t frag_ret = hg_core_send_frags(hg_core_handle);
+        HG_CHECK_ERROR_DONE(frag_ret != HG_SUCCESS, "Could not send fragments");
+    }
+
 done:
     return ret;
 
 cancel:
     if (!hg_core_handle->no_response)
         hg_core_handle->na_op_count--;
+    hg_core_handle->na_op_count -= hg_core_handle->send_frag_count;
+    hg_core_handle->send_frag_count = 0;
 
     /* Handle is no longer posted and being canceled*/
     hg_atomic_set32(&hg_core_handle->posted, HG_FALSE);
@@ -1790,8 +2446,21 @@ hg_core_respond_na(struct hg_core_private_handle *hg_core_handle)
     /* Set operation type for trigger */
     hg_core_handle->op_type = HG_CORE_RESPOND;
 
-    /* More data on output requires an ack once it is processed */
-    if (hg_core_handle->out_header.msg.response.flags & HG_CORE_MORE_DATA) {
+    /* Extra payload fragments are sent right after the response */
+    if (hg_core_handle->out_header.msg.response.flags &
+        HG_CORE_MORE_DATA_FRAG) {
+        ret = hg_core_frag_alloc(hg_core_handle, &hg_core_handle->send_frags,
+            &hg_core_handle->send_frag_max,
+            hg_core_frag_count(hg_core_handle, hg_core_handle->frag_buf_size));
+        HG_CHECK_HG_ERROR(error, ret, "Could not allocate fragments");
+
+        /* Increment number of expected NA operations */
+        hg_core_handle->send_frag_count =
+            hg_core_frag_count(hg_core_handle, hg_core_handle->frag_buf_size);
+        hg_core_handle->na_op_count += hg_core_handle->send_frag_count;
+    } else if (hg_core_handle->out_header.msg.response.flags &
+               HG_CORE_MORE_DATA) {
+        /* More data on output requires an ack once it is processed */
         /* Increment number of expected NA operations */
         hg_core_handle->na_op_count++;
 
@@ -1832,9 +2501,17 @@ hg_core_respond_na(struct hg_core_private_handle *hg_core_handle)
         "Could not post send for output buffer (%s)",
         NA_Error_to_string(na_ret));
 
+    /* Response is on its way, errors are reported through the callback */
+    if (hg_core_handle->send_frag_count > 0) {
+        hg_return_t frag_ret = hg_core_send_frags(hg_core_handle);
+        HG_CHECK_ERROR_DONE(frag_ret != HG_SUCCESS, "Could not send fragments");
+    }
+
     return ret;
 
 error:
+    hg_core_handle->na_op_count -= hg_core_handle->send_frag_count;
+    hg_core_handle->send_frag_count = 0;
     if (ack_recv_posted) {
         /* Cancel the above posted recv ack op */
         na_ret = NA_Cancel(hg_core_handle->na_class, hg_core_handle->na_context,
@@ -1920,10 +2597,11 @@ hg_core_recv_input_cb(const struct na_cb_info *callback_info)
     hg_return_t ret;
 
     /* Remove handle from pending list */
-    hg_thread_spin_lock(
-        &HG_CORE_HANDLE_CONTEXT(hg_core_handle)->pending_list_lock);
+    hg_core_spin_lock(HG_CORE_HANDLE_CLASS(hg_core_handle),
+        &HG_CORE_HANDLE_CONTEXT(hg_core_handle)->pending_list_lock,
+        HG_CORE_HANDLE_CONTEXT(hg_core_handle)->pending_list_lock_prof);
     HG_LIST_REMOVE(hg_core_handle, pending);
-    hg_thread_spin_unlock(
+    hg_core_spin_unlock(HG_CORE_HANDLE_CLASS(hg_core_handle),
         &HG_CORE_HANDLE_CONTEXT(hg_core_handle)->pending_list_lock);
 
     /* If canceled, mark handle as canceled */
@@ -1950,8 +2628,9 @@ hg_core_recv_input_cb(const struct na_cb_info *callback_info)
 
 #ifndef HG_HAS_POST_LIMIT
     /* Check if we need more handles */
-    hg_thread_spin_lock(
-        &HG_CORE_HANDLE_CONTEXT(hg_core_handle)->pending_list_lock);
+    hg_core_spin_lock(HG_CORE_HANDLE_CLASS(hg_core_handle),
+        &HG_CORE_HANDLE_CONTEXT(hg_core_handle)->pending_list_lock,
+        HG_CORE_HANDLE_CONTEXT(hg_core_handle)->pending_list_lock_prof);
 
 #    ifdef HG_HAS_SM_ROUTING
     if (hg_core_handle->na_class ==
@@ -1964,7 +2643,7 @@ hg_core_recv_input_cb(const struct na_cb_info *callback_info)
         pending_empty = HG_LIST_IS_EMPTY(
             &HG_CORE_HANDLE_CONTEXT(hg_core_handle)->pending_list);
 
-    hg_thread_spin_unlock(
+    hg_core_spin_unlock(HG_CORE_HANDLE_CLASS(hg_core_handle),
         &HG_CORE_HANDLE_CONTEXT(hg_core_handle)->pending_list_lock);
 
     /* If pending list is empty, post more handles */
@@ -2014,6 +2693,14 @@ hg_core_process_input(
     /* TODO assign target ID from cookie directly for now */
     hg_core_handle->core_handle.info.context_id = hg_core_handle->cookie;
 
+    HG_TOOL_NOTIFY(HG_TOOL_REQUEST_RECEIVED,
+        hg_core_handle->core_handle.info.context,
+        (hg_core_handle_t) hg_core_handle, NULL, hg_core_handle->in_buf_used,
+        HG_SUCCESS);
+
+    if (HG_CAPTURE_ENABLED())
+        hg_core_capture_request(hg_core_handle);
+
     /* Parse flags */
     hg_core_handle->no_response =
         hg_core_handle->in_header.msg.request.flags & HG_CORE_NO_RESPONSE;
@@ -2040,6 +2727,10 @@ hg_core_process_input(
         /* Increment counter */
         hg_core_stat_incr(&hg_core_rpc_extra_count_g);
 #endif
+        HG_TOOL_NOTIFY(HG_TOOL_OVERFLOW,
+            hg_core_handle->core_handle.info.context,
+            (hg_core_handle_t) hg_core_handle, NULL,
+            hg_core_handle->in_buf_used, HG_SUCCESS);
         ret = HG_CORE_HANDLE_CLASS(hg_core_handle)
                   ->more_data_acquire((hg_core_handle_t) hg_core_handle,
                       HG_INPUT, hg_core_complete);
@@ -2053,6 +2744,29 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+static void
+hg_core_capture_request(struct hg_core_private_handle *hg_core_handle)
+{
+    hg_size_t header_offset = hg_core_header_request_get_size() +
+                              hg_core_handle->core_handle.na_in_header_offset;
+    hg_uint8_t in_flags = hg_core_handle->in_header.msg.request.flags;
+    hg_uint32_t flags = 0;
+
+    if (hg_core_handle->in_buf_used < header_offset)
+        return;
+
+    if (in_flags & HG_CORE_NO_RESPONSE)
+        flags |= HG_CAPTURE_NO_RESPONSE;
+    if (in_flags & HG_CORE_MORE_DATA)
+        flags |= HG_CAPTURE_MORE_DATA;
+
+    hg_core_handle->capture =
+        hg_capture_request(hg_core_handle->core_handle.info.id, flags,
+            (char *) hg_core_handle->core_handle.in_buf + header_offset,
+            hg_core_handle->in_buf_used - header_offset);
+}
+
 /*---------------------------------------------------------------------------*/
 static HG_INLINE int
 hg_core_send_output_cb(const struct na_cb_info *callback_info)
@@ -2106,6 +2820,10 @@ hg_core_recv_output_cb(const struct na_cb_info *callback_info)
         HG_CHECK_ERROR_NORET(callback_info->ret != NA_SUCCESS, done,
             "Error in NA callback (s)", NA_Error_to_string(callback_info->ret));
 
+    /* Amount of output buffer actually received */
+    hg_core_handle->out_buf_used =
+        callback_info->info.recv_expected.actual_buf_size;
+
     /* Process output information */
     ret = hg_core_process_output(hg_core_handle, &completed, hg_core_send_ack);
     HG_CHECK_HG_ERROR(done, ret, "Could not process output");
@@ -2128,7 +2846,9 @@ hg_core_process_output(struct hg_core_private_handle *hg_core_handle,
 {
     hg_return_t ret = HG_SUCCESS;
 
-    /* Get and verify output header */
+    /* Get and verify output header, response uses request protocol */
+    hg_core_handle->out_header.protocol =
+        hg_core_handle->in_header.msg.request.protocol;
     ret = hg_core_proc_header_response(
         &hg_core_handle->core_handle, &hg_core_handle->out_header, HG_DECODE);
     HG_CHECK_HG_ERROR(done, ret, "Could not decode header");
@@ -2137,6 +2857,11 @@ hg_core_process_output(struct hg_core_private_handle *hg_core_handle,
     hg_core_handle->ret =
         (hg_return_t) hg_core_handle->out_header.msg.response.ret_code;
 
+    HG_TOOL_NOTIFY(HG_TOOL_RESPONSE_RECEIVED,
+        hg_core_handle->core_handle.info.context,
+        (hg_core_handle_t) hg_core_handle, NULL, hg_core_handle->out_buf_used,
+        hg_core_handle->ret);
+
     /* Parse flags */
 
     /* Must let upper layer get extra payload if HG_CORE_MORE_DATA is set */
@@ -2145,12 +2870,30 @@ hg_core_process_output(struct hg_core_private_handle *hg_core_handle,
             done, ret, HG_OPNOTSUPPORTED,
             "No callback defined for acquiring more data");
 
+        HG_TOOL_NOTIFY(HG_TOOL_OVERFLOW,
+            hg_core_handle->core_handle.info.context,
+            (hg_core_handle_t) hg_core_handle, NULL,
+            hg_core_handle->core_handle.out_buf_size, HG_SUCCESS);
+
+        /* Fragments are pushed by the target, which therefore does not
+         * wait for an ack. Receiving them counts as one more NA operation so
+         * that the handle does not complete before its own send fragments */
+        if (hg_core_handle->out_header.msg.response.flags &
+            HG_CORE_MORE_DATA_FRAG)
+            hg_core_handle->na_op_count++;
         ret = HG_CORE_HANDLE_CLASS(hg_core_handle)
                   ->more_data_acquire((hg_core_handle_t) hg_core_handle,
-                      HG_OUTPUT, done_callback);
+                      HG_OUTPUT,
+                      (hg_core_handle->out_header.msg.response.flags &
+                          HG_CORE_MORE_DATA_FRAG)
+                          ? hg_core_complete_output
+                          : done_callback);
         HG_CHECK_HG_ERROR(
             done, ret, "Error in HG core handle more data acquire callback");
-        *completed = HG_FALSE;
+        *completed = (hg_core_handle->out_header.msg.response.flags &
+                         HG_CORE_MORE_DATA_FRAG)
+                         ? HG_TRUE
+                         : HG_FALSE;
     } else
         *completed = HG_TRUE;
 
@@ -2255,6 +2998,240 @@ done:
     return (int) completed;
 }
 
+/*---------------------------------------------------------------------------*/
+static HG_INLINE unsigned int
+hg_core_frag_count(
+    struct hg_core_private_handle *hg_core_handle, na_size_t buf_size)
+{
+    na_size_t frag_size = hg_core_handle->core_handle.out_buf_size -
+                          hg_core_handle->core_handle.na_out_header_offset;
+
+    return (unsigned int) ((buf_size + frag_size - 1) / frag_size);
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_core_frag_alloc(struct hg_core_private_handle *hg_core_handle,
+    struct hg_core_frag **frags, unsigned int *frag_max, unsigned int count)
+{
+    struct hg_core_frag *new_frags;
+    hg_return_t ret = HG_SUCCESS;
+
+    if (count <= *frag_max)
+        goto done;
+
+    /* Fragments are kept with the handle so that they can be re-used */
+    new_frags = (struct hg_core_frag *) realloc(
+        *frags, count * sizeof(struct hg_core_frag));
+    HG_CHECK_ERROR(new_frags == NULL, done, ret, HG_NOMEM,
+        "Could not allocate fragments");
+    memset(new_frags + *frag_max, 0,
+        (count - *frag_max) * sizeof(struct hg_core_frag));
+    *frags = new_frags;
+
+    for (; *frag_max < count; (*frag_max)++) {
+        struct hg_core_frag *frag = &new_frags[*frag_max];
+        na_return_t na_ret;
+
+        frag->hg_core_handle = hg_core_handle;
+        frag->buf = NA_Msg_buf_alloc(hg_core_handle->na_class,
+            hg_core_handle->core_handle.out_buf_size, &frag->buf_plugin_data);
+        HG_CHECK_ERROR(frag->buf == NULL, done, ret, HG_NOMEM,
+            "Could not allocate buffer for fragment");
+        hg_mem_usage_add(
+            HG_MEM_USAGE_MSG_BUF, hg_core_handle->core_handle.out_buf_size);
+
+        na_ret = NA_Msg_init_expected(hg_core_handle->na_class, frag->buf,
+            hg_core_handle->core_handle.out_buf_size);
+        HG_CHECK_ERROR(na_ret != NA_SUCCESS, error, ret, (hg_return_t) na_ret,
+            "Could not initialize fragment buffer (%s)",
+            NA_Error_to_string(na_ret));
+
+        frag->na_op_id = NA_Op_create(hg_core_handle->na_class);
+        HG_CHECK_ERROR(frag->na_op_id == NA_OP_ID_NULL, error, ret,
+            HG_NA_ERROR, "Could not create NA op ID");
+    }
+
+done:
+    return ret;
+
+error:
+    NA_Msg_buf_free(hg_core_handle->na_class, (*frags)[*frag_max].buf,
+        (*frags)[*frag_max].buf_plugin_data);
+    hg_mem_usage_sub(
+        HG_MEM_USAGE_MSG_BUF, hg_core_handle->core_handle.out_buf_size);
+    (*frags)[*frag_max].buf = NULL;
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_core_frag_free(struct hg_core_private_handle *hg_core_handle,
+    struct hg_core_frag **frags, unsigned int *frag_max)
+{
+    unsigned int i;
+
+    for (i = 0; i < *frag_max; i++) {
+        na_return_t na_ret;
+
+        na_ret = NA_Op_destroy(hg_core_handle->na_class, (*frags)[i].na_op_id);
+        HG_CHECK_ERROR_DONE(na_ret != NA_SUCCESS,
+            "Could not destroy frag op ID (%s)", NA_Error_to_string(na_ret));
+
+        na_ret = NA_Msg_buf_free(hg_core_handle->na_class, (*frags)[i].buf,
+            (*frags)[i].buf_plugin_data);
+        HG_CHECK_ERROR_DONE(na_ret != NA_SUCCESS,
+            "Could not free frag buffer (%s)", NA_Error_to_string(na_ret));
+        if (na_ret == NA_SUCCESS)
+            hg_mem_usage_sub(
+                HG_MEM_USAGE_MSG_BUF, hg_core_handle->core_handle.out_buf_size);
+    }
+    free(*frags);
+    *frags = NULL;
+    *frag_max = 0;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_core_send_frags(struct hg_core_private_handle *hg_core_handle)
+{
+    na_size_t header_offset = hg_core_handle->core_handle.na_out_header_offset;
+    na_size_t frag_size =
+        hg_core_handle->core_handle.out_buf_size - header_offset;
+    const char *src = (const char *) hg_core_handle->frag_buf;
+    na_size_t remaining = hg_core_handle->frag_buf_size;
+    unsigned int i, count;
+    hg_return_t ret = HG_SUCCESS;
+
+    /* All fragments carry the request tag, ordering between messages of a
+     * same tag is preserved by the NA plugins so that fragments are received
+     * in order after the request / response */
+    for (i = 0; i < hg_core_handle->send_frag_count; i++) {
+        struct hg_core_frag *frag = &hg_core_handle->send_frags[i];
+        na_return_t na_ret;
+
+        frag->size = (remaining < frag_size) ? remaining : frag_size;
+        memcpy((char *) frag->buf + header_offset, src, frag->size);
+        src += frag->size;
+        remaining -= frag->size;
+
+        /* Op ID is not reposted until hg_core_send_frag_cb() has run */
+        hg_core_atomic_incr32(HG_CORE_HANDLE_CLASS(hg_core_handle),
+            &hg_core_handle->frag_send_pending);
+        na_ret = NA_Msg_send_expected(hg_core_handle->na_class,
+            hg_core_handle->na_context, hg_core_send_frag_cb, frag, frag->buf,
+            header_offset + frag->size, frag->buf_plugin_data,
+            hg_core_handle->core_handle.info.addr->na_addr,
+            hg_core_handle->core_handle.info.context_id, hg_core_handle->tag,
+            &frag->na_op_id);
+        if (na_ret != NA_SUCCESS)
+            hg_core_atomic_decr32(HG_CORE_HANDLE_CLASS(hg_core_handle),
+                &hg_core_handle->frag_send_pending);
+        /* Expected sends should always succeed after retry */
+        HG_CHECK_ERROR(na_ret != NA_SUCCESS, error, ret, (hg_return_t) na_ret,
+            "Could not post send for fragment (%s)",
+            NA_Error_to_string(na_ret));
+    }
+
+    return ret;
+
+error:
+    hg_core_handle->ret = ret;
+
+    /* Target will never receive the full payload, do not wait for response */
+    if (hg_core_handle->op_type == HG_CORE_FORWARD &&
+        !hg_core_handle->no_response) {
+        na_return_t na_ret = NA_Cancel(hg_core_handle->na_class,
+            hg_core_handle->na_context, hg_core_handle->na_recv_op_id);
+        HG_CHECK_ERROR_DONE(na_ret != NA_SUCCESS,
+            "Could not cancel recv op id (%s)", NA_Error_to_string(na_ret));
+    }
+
+    /* Account for fragments that were not posted */
+    count = hg_core_handle->send_frag_count;
+    hg_core_handle->send_frag_count = i;
+    for (; i < count; i++) {
+        hg_bool_t completed = HG_TRUE;
+        hg_core_complete_na(hg_core_handle, &completed);
+    }
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE int
+hg_core_send_frag_cb(const struct na_cb_info *callback_info)
+{
+    struct hg_core_frag *frag = (struct hg_core_frag *) callback_info->arg;
+    struct hg_core_private_handle *hg_core_handle = frag->hg_core_handle;
+    hg_bool_t completed = HG_TRUE;
+    hg_return_t ret;
+
+    /* If canceled, mark handle as canceled */
+    if (callback_info->ret == NA_CANCELED) {
+        if (hg_core_handle->ret == HG_SUCCESS)
+            hg_core_handle->ret = HG_CANCELED;
+    } else if (callback_info->ret != NA_SUCCESS) {
+        HG_LOG_WARNING("NA callback returned error (%s)",
+            NA_Error_to_string(callback_info->ret));
+        hg_core_handle->ret = HG_NA_ERROR;
+    }
+
+    /* Op ID can be reused */
+    hg_core_atomic_decr32(HG_CORE_HANDLE_CLASS(hg_core_handle),
+        &hg_core_handle->frag_send_pending);
+
+    /* Complete operation */
+    ret = hg_core_complete_na(hg_core_handle, &completed);
+    HG_CHECK_HG_ERROR(done, ret, "Could not complete operation");
+
+done:
+    return (int) completed;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE int
+hg_core_recv_frag_cb(const struct na_cb_info *callback_info)
+{
+    struct hg_core_frag *frag = (struct hg_core_frag *) callback_info->arg;
+    struct hg_core_private_handle *hg_core_handle = frag->hg_core_handle;
+    na_size_t header_offset = hg_core_handle->core_handle.na_out_header_offset;
+    hg_return_t ret;
+
+    if (callback_info->ret == NA_CANCELED) {
+        if (hg_core_handle->ret == HG_SUCCESS)
+            hg_core_handle->ret = HG_CANCELED;
+    } else if (callback_info->ret != NA_SUCCESS) {
+        HG_LOG_WARNING("NA callback returned error (%s)",
+            NA_Error_to_string(callback_info->ret));
+        hg_core_handle->ret = HG_NA_ERROR;
+    } else
+        memcpy(frag->dest, (char *) frag->buf + header_offset, frag->size);
+
+    /* Wait for all fragments */
+    if (hg_core_atomic_decr32(HG_CORE_HANDLE_CLASS(hg_core_handle),
+            &hg_core_handle->frag_recv_pending) > 0)
+        return 0;
+
+    ret = hg_core_handle->frag_done_callback((hg_core_handle_t) hg_core_handle);
+    HG_CHECK_HG_ERROR(done, ret, "Could not execute frag done callback");
+
+done:
+    return 1;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_core_complete_output(hg_core_handle_t handle)
+{
+    hg_bool_t completed = HG_TRUE;
+
+    /* Fragments of the request may still be in flight, the handle completes
+     * with the last of its NA operations */
+    return hg_core_complete_na(
+        (struct hg_core_private_handle *) handle, &completed);
+}
+
 /*---------------------------------------------------------------------------*/
 #ifdef HG_HAS_SELF_FORWARD
 static hg_return_t
@@ -2281,7 +3258,8 @@ hg_core_self_cb(const struct hg_core_cb_info *callback_info)
     hg_core_handle->op_type = HG_CORE_FORWARD_SELF;
 
     /* Increment refcount and push handle back to completion queue */
-    hg_atomic_incr32(&hg_core_handle->ref_count);
+    hg_core_atomic_incr32(HG_CORE_HANDLE_CLASS(hg_core_handle),
+        &hg_core_handle->ref_count);
 
     /* Process output */
     ret = hg_core_process_output(hg_core_handle, &completed, hg_core_complete);
@@ -2330,11 +3308,14 @@ hg_core_process(struct hg_core_private_handle *hg_core_handle)
     hg_return_t ret = HG_SUCCESS;
 
     /* Retrieve exe function from function map */
-    hg_thread_spin_lock(&HG_CORE_HANDLE_CLASS(hg_core_handle)->func_map_lock);
+    hg_core_spin_lock(HG_CORE_HANDLE_CLASS(hg_core_handle),
+        &HG_CORE_HANDLE_CLASS(hg_core_handle)->func_map_lock,
+        HG_CORE_HANDLE_CLASS(hg_core_handle)->func_map_lock_prof);
     hg_core_rpc_info = (struct hg_core_rpc_info *) hg_hash_table_lookup(
         HG_CORE_HANDLE_CLASS(hg_core_handle)->func_map,
         (hg_hash_table_key_t) &hg_core_handle->core_handle.info.id);
-    hg_thread_spin_unlock(&HG_CORE_HANDLE_CLASS(hg_core_handle)->func_map_lock);
+    hg_core_spin_unlock(HG_CORE_HANDLE_CLASS(hg_core_handle),
+        &HG_CORE_HANDLE_CLASS(hg_core_handle)->func_map_lock);
     if (!hg_core_rpc_info) {
         HG_LOG_WARNING("Could not find RPC ID in function map");
         ret = HG_NOENTRY;
@@ -2349,10 +3330,19 @@ hg_core_process(struct hg_core_private_handle *hg_core_handle)
 
     /* Increment ref count here so that a call to HG_Destroy in user's RPC
      * callback does not free the handle but only schedules its completion */
-    hg_atomic_incr32(&hg_core_handle->ref_count);
+    hg_core_atomic_incr32(HG_CORE_HANDLE_CLASS(hg_core_handle),
+        &hg_core_handle->ref_count);
 
     /* Execute RPC callback */
+    HG_TOOL_NOTIFY(HG_TOOL_HANDLER_START,
+        hg_core_handle->core_handle.info.context,
+        (hg_core_handle_t) hg_core_handle, NULL, hg_core_handle->in_buf_used,
+        HG_SUCCESS);
     ret = hg_core_rpc_info->rpc_cb((hg_core_handle_t) hg_core_handle);
+    HG_TOOL_NOTIFY(HG_TOOL_HANDLER_END,
+        hg_core_handle->core_handle.info.context,
+        (hg_core_handle_t) hg_core_handle, NULL, hg_core_handle->in_buf_used,
+        ret);
     HG_CHECK_HG_ERROR(done, ret, "Error while executing RPC callback");
 
 done:
@@ -2367,7 +3357,8 @@ hg_core_complete_na(
     hg_return_t ret = HG_SUCCESS;
 
     /* Add handle to completion queue when expected operations have completed */
-    if (hg_atomic_incr32(&hg_core_handle->na_op_completed_count) ==
+    if (hg_core_atomic_incr32(HG_CORE_HANDLE_CLASS(hg_core_handle),
+            &hg_core_handle->na_op_completed_count) ==
             (hg_util_int32_t) hg_core_handle->na_op_count &&
         *completed) {
         /* Handle is no longer posted */
@@ -2397,6 +3388,12 @@ hg_core_complete(hg_core_handle_t handle)
         &hg_core_handle->hg_completion_entry;
     hg_return_t ret = HG_SUCCESS;
 
+    /* Operations canceled because the deadline expired report a timeout */
+    hg_core_timer_disarm(hg_core_handle);
+    if (hg_atomic_get32(&hg_core_handle->timed_out) &&
+        hg_core_handle->ret == HG_CANCELED)
+        hg_core_handle->ret = HG_TIMEOUT;
+
     hg_completion_entry->op_type = HG_RPC;
     hg_completion_entry->op_id.hg_core_handle = handle;
 
@@ -2416,6 +3413,8 @@ hg_core_completion_add(struct hg_core_context *context,
 {
     struct hg_core_private_context *private_context =
         (struct hg_core_private_context *) context;
+    struct hg_core_private_class *hg_core_class =
+        HG_CORE_CONTEXT_CLASS(private_context);
     hg_return_t ret = HG_SUCCESS;
 
 #ifdef HG_HAS_COLLECT_STATS
@@ -2424,29 +3423,34 @@ hg_core_completion_add(struct hg_core_context *context,
         hg_core_stat_incr(&hg_core_bulk_count_g);
 #endif
 
-    if (hg_atomic_queue_push(private_context->completion_queue,
+    /* Single-threaded mode only uses the (unlocked) backfill queue */
+    if (HG_CORE_SINGLE_THREAD(hg_core_class) ||
+        hg_atomic_queue_push(private_context->completion_queue,
             hg_completion_entry) != HG_UTIL_SUCCESS) {
         /* Queue is full */
-        hg_thread_mutex_lock(&private_context->completion_queue_mutex);
+        hg_core_mutex_lock(hg_core_class,
+            &private_context->completion_queue_mutex,
+            private_context->completion_queue_mutex_prof);
         HG_QUEUE_PUSH_TAIL(
             &private_context->backfill_queue, hg_completion_entry, entry);
-        hg_atomic_incr32(&private_context->backfill_queue_count);
-        hg_thread_mutex_unlock(&private_context->completion_queue_mutex);
+        hg_core_atomic_incr32(
+            hg_core_class, &private_context->backfill_queue_count);
+        hg_core_mutex_unlock(
+            hg_core_class, &private_context->completion_queue_mutex);
     }
 
-    if (hg_atomic_get32(&private_context->trigger_waiting)) {
-        hg_thread_mutex_lock(&private_context->completion_queue_mutex);
-        /* Callback is pushed to the completion queue when something completes
-         * so wake up anyone waiting in the trigger */
-        hg_thread_cond_signal(&private_context->completion_queue_cond);
-        hg_thread_mutex_unlock(&private_context->completion_queue_mutex);
-    }
+    /* Callback is pushed to the completion queue when something completes
+     * so wake up anyone waiting in the trigger */
+    if (!HG_CORE_SINGLE_THREAD(hg_core_class))
+        hg_eventcount_notify(&private_context->completion_queue_ec);
 
 #ifdef HG_HAS_SELF_FORWARD
     if (!(HG_CORE_CONTEXT_CLASS(private_context)->progress_mode &
             NA_NO_BLOCK) &&
         self_notify && (private_context->completion_queue_notify > 0)) {
-        hg_thread_mutex_lock(&private_context->completion_queue_notify_mutex);
+        hg_core_mutex_lock(HG_CORE_CONTEXT_CLASS(private_context),
+            &private_context->completion_queue_notify_mutex,
+            private_context->completion_queue_notify_mutex_prof);
         /* Do not bother notifying if it's not needed as any event call will
          * increase latency */
         if (hg_atomic_get32(&private_context->completion_queue_must_notify)) {
@@ -2454,7 +3458,8 @@ hg_core_completion_add(struct hg_core_context *context,
             HG_CHECK_ERROR(rc != HG_UTIL_SUCCESS, done, ret, HG_FAULT,
                 "Could not signal completion queue");
         }
-        hg_thread_mutex_unlock(&private_context->completion_queue_notify_mutex);
+        hg_core_mutex_unlock(HG_CORE_CONTEXT_CLASS(private_context),
+            &private_context->completion_queue_notify_mutex);
     }
 #else
     (void) self_notify;
@@ -2530,21 +3535,23 @@ hg_core_post(struct hg_core_private_handle *hg_core_handle)
 #ifdef HG_HAS_SM_ROUTING
     if (hg_core_handle->na_class ==
         hg_core_handle->core_handle.info.core_class->na_sm_class) {
-        hg_thread_spin_lock(
-            &HG_CORE_HANDLE_CONTEXT(hg_core_handle)->pending_list_lock);
+        hg_core_spin_lock(HG_CORE_HANDLE_CLASS(hg_core_handle),
+            &HG_CORE_HANDLE_CONTEXT(hg_core_handle)->pending_list_lock,
+            HG_CORE_HANDLE_CONTEXT(hg_core_handle)->pending_list_lock_prof);
         HG_LIST_INSERT_HEAD(
             &HG_CORE_HANDLE_CONTEXT(hg_core_handle)->sm_pending_list,
             hg_core_handle, pending);
-        hg_thread_spin_unlock(
+        hg_core_spin_unlock(HG_CORE_HANDLE_CLASS(hg_core_handle),
             &HG_CORE_HANDLE_CONTEXT(hg_core_handle)->pending_list_lock);
     } else {
 #endif
-        hg_thread_spin_lock(
-            &HG_CORE_HANDLE_CONTEXT(hg_core_handle)->pending_list_lock);
+        hg_core_spin_lock(HG_CORE_HANDLE_CLASS(hg_core_handle),
+            &HG_CORE_HANDLE_CONTEXT(hg_core_handle)->pending_list_lock,
+            HG_CORE_HANDLE_CONTEXT(hg_core_handle)->pending_list_lock_prof);
         HG_LIST_INSERT_HEAD(
             &HG_CORE_HANDLE_CONTEXT(hg_core_handle)->pending_list,
             hg_core_handle, pending);
-        hg_thread_spin_unlock(
+        hg_core_spin_unlock(HG_CORE_HANDLE_CLASS(hg_core_handle),
             &HG_CORE_HANDLE_CONTEXT(hg_core_handle)->pending_list_lock);
 #ifdef HG_HAS_SM_ROUTING
     }
@@ -2563,10 +3570,11 @@ hg_core_post(struct hg_core_private_handle *hg_core_handle)
     return ret;
 
 error:
-    hg_thread_spin_lock(
-        &HG_CORE_HANDLE_CONTEXT(hg_core_handle)->pending_list_lock);
+    hg_core_spin_lock(HG_CORE_HANDLE_CLASS(hg_core_handle),
+        &HG_CORE_HANDLE_CONTEXT(hg_core_handle)->pending_list_lock,
+        HG_CORE_HANDLE_CONTEXT(hg_core_handle)->pending_list_lock_prof);
     HG_LIST_REMOVE(hg_core_handle, pending);
-    hg_thread_spin_unlock(
+    hg_core_spin_unlock(HG_CORE_HANDLE_CLASS(hg_core_handle),
         &HG_CORE_HANDLE_CONTEXT(hg_core_handle)->pending_list_lock);
     hg_atomic_set32(&hg_core_handle->in_use, HG_FALSE);
     return ret;
@@ -2578,7 +3586,8 @@ hg_core_reset_post(struct hg_core_private_handle *hg_core_handle)
 {
     hg_return_t ret = HG_SUCCESS;
 
-    if (hg_atomic_decr32(&hg_core_handle->ref_count))
+    if (hg_core_atomic_decr32(
+            HG_CORE_HANDLE_CLASS(hg_core_handle), &hg_core_handle->ref_count))
         goto done;
 
     /* Reset the handle */
@@ -2598,7 +3607,7 @@ done:
 
 /*---------------------------------------------------------------------------*/
 static hg_return_t
-hg_core_progress_na(
+hg_core_progress_na(struct hg_core_private_context *context,
     na_class_t *na_class, na_context_t *na_context, unsigned int timeout)
 {
     double remaining =
@@ -2610,10 +3619,11 @@ hg_core_progress_na(
         unsigned int actual_count = 0;
         unsigned int progress_timeout;
         na_return_t na_ret;
-        hg_time_t t1, t2;
+        hg_time_fast_t t1, t2, acct_t = 0;
 
         /* Trigger everything we can from NA, if something completed it will
          * be moved to the HG context completion queue */
+        HG_CORE_ACCT_BEGIN(context, acct_t);
         do {
             int cb_ret[HG_CORE_MAX_TRIGGER_COUNT] = {0};
             unsigned int i;
@@ -2625,6 +3635,7 @@ hg_core_progress_na(
             for (i = 0; i < actual_count; i++)
                 completed_count += (unsigned int) cb_ret[i];
         } while ((na_ret == NA_SUCCESS) && actual_count);
+        HG_CORE_ACCT_END(context, HG_PROGRESS_PHASE_NA_TRIGGER, acct_t);
         HG_CHECK_ERROR(na_ret != NA_SUCCESS && na_ret != NA_TIMEOUT, done, ret,
             (hg_return_t) na_ret, "Could not trigger NA callback (%s)",
             NA_Error_to_string(na_ret));
@@ -2639,7 +3650,7 @@ hg_core_progress_na(
             break;
 
         if (timeout)
-            hg_time_get_current_ms(&t1);
+            t1 = hg_time_fast_now();
 
         /* Make sure that it is safe to block */
         if (timeout && NA_Poll_try_wait(na_class, na_context))
@@ -2648,7 +3659,12 @@ hg_core_progress_na(
             progress_timeout = 0;
 
         /* Otherwise try to make progress on NA */
+        HG_CORE_ACCT_BEGIN(context, acct_t);
         na_ret = NA_Progress(na_class, na_context, progress_timeout);
+        HG_CORE_ACCT_END(context,
+            progress_timeout ? HG_PROGRESS_PHASE_POLL_WAIT
+                             : HG_PROGRESS_PHASE_NA_PROGRESS,
+            acct_t);
         if (na_ret == NA_TIMEOUT && (remaining <= 0))
             break;
         else
@@ -2657,8 +3673,8 @@ hg_core_progress_na(
                 NA_Error_to_string(na_ret));
 
         if (timeout) {
-            hg_time_get_current_ms(&t2);
-            remaining -= hg_time_diff(t2, t1);
+            t2 = hg_time_fast_now();
+            remaining -= hg_time_fast_diff(t2, t1);
         }
     }
 
@@ -2716,41 +3732,56 @@ hg_core_progress(struct hg_core_private_context *context, unsigned int timeout)
 {
     double remaining =
         timeout / 1000.0; /* Convert timeout in ms into seconds */
+    hg_time_fast_t acct_t = 0;
     hg_return_t ret = HG_TIMEOUT;
 
+    HG_CORE_ACCT_BEGIN(context, acct_t);
+
     do {
-        hg_time_t t1, t2;
+        hg_time_fast_t t1 = 0, t2, wait_t = 0;
         hg_bool_t safe_wait = HG_FALSE;
+        unsigned int wait_timeout;
 
         if (timeout)
-            hg_time_get_current_ms(&t1);
+            t1 = hg_time_fast_now();
+
+        /* Cancel expired forwards, do not wait past the next deadline */
+        hg_core_timer_expire(context);
+        wait_timeout =
+            hg_core_timer_wait(context, (unsigned int) (remaining * 1000.0));
 
         if (!(HG_CORE_CONTEXT_CLASS(context)->progress_mode & NA_NO_BLOCK) &&
             timeout) {
-            hg_thread_mutex_lock(&context->completion_queue_notify_mutex);
+            hg_core_mutex_lock(HG_CORE_CONTEXT_CLASS(context),
+                &context->completion_queue_notify_mutex,
+                context->completion_queue_notify_mutex_prof);
 
             if (hg_core_poll_try_wait(context)) {
                 safe_wait = HG_TRUE;
                 hg_atomic_set32(&context->completion_queue_must_notify, 1);
             }
 
-            hg_thread_mutex_unlock(&context->completion_queue_notify_mutex);
+            hg_core_mutex_unlock(HG_CORE_CONTEXT_CLASS(context),
+                &context->completion_queue_notify_mutex);
         }
 
         /* Only enter blocking wait if it is safe to */
         if (context->poll_set && safe_wait) {
+            struct hg_poll_event poll_events[HG_CORE_MAX_EVENTS];
             unsigned int i, nevents;
             int rc;
 
-            rc = hg_poll_wait(context->poll_set,
-                (unsigned int) (remaining * 1000.0), HG_CORE_MAX_EVENTS,
-                context->poll_events, &nevents);
+            /* Harvest all ready sources and service each of them */
+            HG_CORE_ACCT_BEGIN(context, wait_t);
+            rc = hg_poll_wait(context->poll_set, wait_timeout,
+                HG_CORE_MAX_EVENTS, poll_events, &nevents);
+            HG_CORE_ACCT_END(context, HG_PROGRESS_PHASE_POLL_WAIT, wait_t);
             hg_atomic_set32(&context->completion_queue_must_notify, 0);
             HG_CHECK_ERROR(rc != HG_UTIL_SUCCESS, done, ret, HG_PROTOCOL_ERROR,
                 "hg_poll_wait() failed");
 
             for (i = 0; i < nevents; i++) {
-                switch (context->poll_events[i].data.u32) {
+                switch (poll_events[i].data.u32) {
 #ifdef HG_HAS_SELF_FORWARD
                     case HG_CORE_POLL_LOOPBACK:
                         HG_LOG_DEBUG("HG_CORE_POLL_LOOPBACK event");
@@ -2762,8 +3793,9 @@ hg_core_progress(struct hg_core_private_context *context, unsigned int timeout)
 #ifdef HG_HAS_SM_ROUTING
                     case HG_CORE_POLL_SM:
                         HG_LOG_DEBUG("HG_CORE_POLL_SM event");
-                        ret = hg_core_progress_na(HG_CORE_CONTEXT_CLASS(context)
-                                                      ->core_class.na_sm_class,
+                        ret = hg_core_progress_na(context,
+                            HG_CORE_CONTEXT_CLASS(context)
+                                ->core_class.na_sm_class,
                             context->core_context.na_sm_context, 0);
                         if (ret != HG_TIMEOUT)
                             HG_CHECK_HG_ERROR(
@@ -2772,7 +3804,7 @@ hg_core_progress(struct hg_core_private_context *context, unsigned int timeout)
 #endif
                     case HG_CORE_POLL_NA:
                         HG_LOG_DEBUG("HG_CORE_POLL_NA event");
-                        ret = hg_core_progress_na(
+                        ret = hg_core_progress_na(context,
                             HG_CORE_CONTEXT_CLASS(context)->core_class.na_class,
                             context->core_context.na_context, 0);
                         if (ret != HG_TIMEOUT)
@@ -2782,7 +3814,7 @@ hg_core_progress(struct hg_core_private_context *context, unsigned int timeout)
                     default:
                         HG_GOTO_ERROR(done, ret, HG_INVALID_ARG,
                             "Invalid type of poll event (%d)",
-                            (int) context->poll_events[i].data.u32);
+                            (int) poll_events[i].data.u32);
                 }
             }
 
@@ -2798,7 +3830,7 @@ hg_core_progress(struct hg_core_private_context *context, unsigned int timeout)
             if (context->core_context.na_sm_context) {
                 progress_timeout = 0;
 
-                ret = hg_core_progress_na(
+                ret = hg_core_progress_na(context,
                     HG_CORE_CONTEXT_CLASS(context)->core_class.na_sm_class,
                     context->core_context.na_sm_context, progress_timeout);
                 if (ret == HG_SUCCESS)
@@ -2808,14 +3840,13 @@ hg_core_progress(struct hg_core_private_context *context, unsigned int timeout)
                         done, ret, "hg_core_progress_na() failed");
             } else {
 #else
-            progress_timeout =
-                safe_wait ? (unsigned int) (remaining * 1000.0) : 0;
+            progress_timeout = safe_wait ? wait_timeout : 0;
 #endif
 #ifdef HG_HAS_SM_ROUTING
             }
 #endif
 
-            ret = hg_core_progress_na(
+            ret = hg_core_progress_na(context,
                 HG_CORE_CONTEXT_CLASS(context)->core_class.na_class,
                 context->core_context.na_context, progress_timeout);
             if (ret == HG_SUCCESS)
@@ -2838,12 +3869,15 @@ hg_core_progress(struct hg_core_private_context *context, unsigned int timeout)
         }
 
         if (timeout) {
-            hg_time_get_current_ms(&t2);
-            remaining -= hg_time_diff(t2, t1);
+            t2 = hg_time_fast_now();
+            remaining -= hg_time_fast_diff(t2, t1);
         }
     } while ((int) (remaining * 1000.0) > 0);
 
 done:
+    HG_CORE_ACCT_END(context, HG_PROGRESS_PHASE_PROGRESS, acct_t);
+    HG_CORE_ACCT_REPORT(context);
+
     return ret;
 }
 
@@ -2854,9 +3888,12 @@ hg_core_trigger(struct hg_core_private_context *context, unsigned int timeout,
 {
     double remaining =
         timeout / 1000.0; /* Convert timeout in ms into seconds */
+    hg_time_fast_t acct_t = 0, cb_t = 0;
     unsigned int count = 0;
     hg_return_t ret = HG_SUCCESS;
 
+    HG_CORE_ACCT_BEGIN(context, acct_t);
+
     while (count < max_count) {
         struct hg_completion_entry *hg_completion_entry = NULL;
 
@@ -2864,15 +3901,20 @@ hg_core_trigger(struct hg_core_private_context *context, unsigned int timeout,
         if (!hg_completion_entry) {
             /* Check backfill queue */
             if (hg_atomic_get32(&context->backfill_queue_count)) {
-                hg_thread_mutex_lock(&context->completion_queue_mutex);
+                hg_core_mutex_lock(HG_CORE_CONTEXT_CLASS(context),
+                    &context->completion_queue_mutex,
+                    context->completion_queue_mutex_prof);
                 hg_completion_entry = HG_QUEUE_FIRST(&context->backfill_queue);
                 HG_QUEUE_POP_HEAD(&context->backfill_queue, entry);
-                hg_atomic_decr32(&context->backfill_queue_count);
-                hg_thread_mutex_unlock(&context->completion_queue_mutex);
+                hg_core_atomic_decr32(HG_CORE_CONTEXT_CLASS(context),
+                    &context->backfill_queue_count);
+                hg_core_mutex_unlock(HG_CORE_CONTEXT_CLASS(context),
+                    &context->completion_queue_mutex);
                 if (!hg_completion_entry)
                     continue; /* Give another change to grab it */
             } else {
-                hg_time_t t1, t2;
+                hg_time_fast_t t1, t2;
+                hg_util_int32_t key;
 
                 /* If something was already processed leave */
                 if (count)
@@ -2884,29 +3926,27 @@ hg_core_trigger(struct hg_core_private_context *context, unsigned int timeout,
                     break;
                 }
 
-                hg_time_get_current_ms(&t1);
+                t1 = hg_time_fast_now();
 
-                hg_atomic_incr32(&context->trigger_waiting);
-                hg_thread_mutex_lock(&context->completion_queue_mutex);
                 /* Otherwise wait timeout ms */
-                while (hg_atomic_queue_is_empty(context->completion_queue) &&
-                       !hg_atomic_get32(&context->backfill_queue_count)) {
-                    if (hg_thread_cond_timedwait(
-                            &context->completion_queue_cond,
-                            &context->completion_queue_mutex,
-                            timeout) != HG_UTIL_SUCCESS) {
-                        /* Timeout occurred so leave */
-                        ret = HG_TIMEOUT;
-                        break;
-                    }
-                }
-                hg_thread_mutex_unlock(&context->completion_queue_mutex);
-                hg_atomic_decr32(&context->trigger_waiting);
-                if (ret == HG_TIMEOUT)
+                key = hg_eventcount_prepare_wait(&context->completion_queue_ec);
+                if (!hg_atomic_queue_is_empty(context->completion_queue) ||
+                    hg_atomic_get32(&context->backfill_queue_count))
+                    hg_eventcount_cancel_wait(&context->completion_queue_ec);
+                else if (hg_eventcount_commit_wait(
+                             &context->completion_queue_ec, key,
+                             (unsigned int) (remaining * 1000.0)) !=
+                         HG_UTIL_SUCCESS) {
+                    /* Timeout occurred so leave */
+                    HG_CORE_ACCT_END(
+                        context, HG_PROGRESS_PHASE_TRIGGER_WAIT, t1);
+                    ret = HG_TIMEOUT;
                     break;
+                }
+                HG_CORE_ACCT_END(context, HG_PROGRESS_PHASE_TRIGGER_WAIT, t1);
 
-                hg_time_get_current_ms(&t2);
-                remaining -= hg_time_diff(t2, t1);
+                t2 = hg_time_fast_now();
+                remaining -= hg_time_fast_diff(t2, t1);
                 continue; /* Give another change to grab it */
             }
         }
@@ -2916,6 +3956,7 @@ hg_core_trigger(struct hg_core_private_context *context, unsigned int timeout,
             "NULL completion entry");
 
         /* Trigger entry */
+        HG_CORE_ACCT_BEGIN(context, cb_t);
         switch (hg_completion_entry->op_type) {
             case HG_ADDR:
                 ret = hg_core_trigger_lookup_entry(
@@ -2941,6 +3982,7 @@ hg_core_trigger(struct hg_core_private_context *context, unsigned int timeout,
                     "Invalid type of completion entry (%d)",
                     (int) hg_completion_entry->op_type);
         }
+        HG_CORE_ACCT_END(context, HG_PROGRESS_PHASE_CALLBACK, cb_t);
 
         count++;
     }
@@ -2949,6 +3991,8 @@ hg_core_trigger(struct hg_core_private_context *context, unsigned int timeout,
         *actual_count = count;
 
 done:
+    HG_CORE_ACCT_END(context, HG_PROGRESS_PHASE_TRIGGER, acct_t);
+
     return ret;
 }
 
@@ -2984,7 +4028,8 @@ hg_core_trigger_entry(struct hg_core_private_handle *hg_core_handle)
 
     if (hg_core_handle->op_type == HG_CORE_PROCESS) {
         /* Take another reference to make sure the handle does not get freed */
-        hg_atomic_incr32(&hg_core_handle->ref_count);
+        hg_core_atomic_incr32(HG_CORE_HANDLE_CLASS(hg_core_handle),
+            &hg_core_handle->ref_count);
 
         /* Run RPC callback */
         ret = hg_core_process(hg_core_handle);
@@ -3072,6 +4117,7 @@ done:
 static hg_return_t
 hg_core_cancel(struct hg_core_private_handle *hg_core_handle)
 {
+    unsigned int i;
     hg_return_t ret = HG_SUCCESS;
 
     HG_CHECK_ERROR(hg_core_handle->is_self, done, ret, HG_OPNOTSUPPORTED,
@@ -3099,123 +4145,472 @@ hg_core_cancel(struct hg_core_private_handle *hg_core_handle)
             "Could not cancel ack op id (%s)", NA_Error_to_string(na_ret));
     }
 
+    for (i = 0; i < hg_core_handle->send_frag_count; i++) {
+        na_return_t na_ret = NA_Cancel(hg_core_handle->na_class,
+            hg_core_handle->na_context,
+            hg_core_handle->send_frags[i].na_op_id);
+        HG_CHECK_ERROR(na_ret != NA_SUCCESS, done, ret, (hg_return_t) na_ret,
+            "Could not cancel send frag op id (%s)",
+            NA_Error_to_string(na_ret));
+    }
+
+    for (i = 0; i < hg_core_handle->recv_frag_count; i++) {
+        na_return_t na_ret = NA_Cancel(hg_core_handle->na_class,
+            hg_core_handle->na_context,
+            hg_core_handle->recv_frags[i].na_op_id);
+        HG_CHECK_ERROR(na_ret != NA_SUCCESS, done, ret, (hg_return_t) na_ret,
+            "Could not cancel recv frag op id (%s)",
+            NA_Error_to_string(na_ret));
+    }
+
 done:
     return ret;
 }
 
 /*---------------------------------------------------------------------------*/
-hg_core_class_t *
-HG_Core_init(const char *na_info_string, hg_bool_t na_listen)
+static HG_INLINE hg_uint64_t
+hg_core_timer_now(void)
 {
-    return HG_Core_init_opt(na_info_string, na_listen, NULL);
+    return hg_time_fast_to_ns(hg_time_fast_now()) / 1000000;
 }
 
 /*---------------------------------------------------------------------------*/
-hg_core_class_t *
-HG_Core_init_opt(const char *na_info_string, hg_bool_t na_listen,
-    const struct hg_init_info *hg_init_info)
+static void
+hg_core_timer_arm(
+    struct hg_core_private_handle *hg_core_handle, unsigned int timeout)
 {
-    struct hg_core_private_class *hg_core_class = NULL;
-
-    hg_core_class = hg_core_init(na_info_string, na_listen, hg_init_info);
-    HG_CHECK_ERROR_NORET(
-        hg_core_class == NULL, done, "Cannot initialize HG core layer");
-
-done:
-    return (hg_core_class_t *) hg_core_class;
+    struct hg_core_private_context *context =
+        HG_CORE_HANDLE_CONTEXT(hg_core_handle);
+
+    hg_core_spin_lock(HG_CORE_CONTEXT_CLASS(context),
+        &context->timer_wheel_lock, context->timer_wheel_lock_prof);
+    hg_timer_wheel_arm(&context->timer_wheel, &hg_core_handle->timer,
+        hg_core_timer_now() + timeout);
+    hg_core_handle->timer_gen = hg_atomic_get32(&hg_core_handle->forward_gen);
+    hg_core_atomic_incr32(HG_CORE_CONTEXT_CLASS(context), &context->n_timers);
+    hg_core_spin_unlock(
+        HG_CORE_CONTEXT_CLASS(context), &context->timer_wheel_lock);
 }
 
 /*---------------------------------------------------------------------------*/
-hg_return_t
-HG_Core_finalize(hg_core_class_t *hg_core_class)
+static void
+hg_core_timer_disarm(struct hg_core_private_handle *hg_core_handle)
 {
-    hg_return_t ret;
-
-    ret = hg_core_finalize((struct hg_core_private_class *) hg_core_class);
-    HG_CHECK_HG_ERROR(done, ret, "Cannot finalize HG core layer");
-
-done:
-    return ret;
+    struct hg_core_private_context *context =
+        HG_CORE_HANDLE_CONTEXT(hg_core_handle);
+
+    /* No timed forward in flight */
+    if (hg_atomic_get32(&context->n_timers) == 0)
+        return;
+
+    hg_core_spin_lock(HG_CORE_CONTEXT_CLASS(context),
+        &context->timer_wheel_lock, context->timer_wheel_lock_prof);
+    if (hg_core_handle->timer.slot != HG_TIMER_WHEEL_NONE) {
+        hg_timer_wheel_disarm(&context->timer_wheel, &hg_core_handle->timer);
+        hg_core_atomic_decr32(
+            HG_CORE_CONTEXT_CLASS(context), &context->n_timers);
+    }
+    hg_core_spin_unlock(
+        HG_CORE_CONTEXT_CLASS(context), &context->timer_wheel_lock);
 }
 
 /*---------------------------------------------------------------------------*/
-void
-HG_Core_cleanup(void)
+static void
+hg_core_timer_expire(struct hg_core_private_context *context)
 {
-    NA_Cleanup();
-}
+    hg_bool_t advanced = HG_FALSE;
 
-/*---------------------------------------------------------------------------*/
-hg_return_t
-HG_Core_set_more_data_callback(struct hg_core_class *hg_core_class,
-    hg_return_t (*more_data_acquire_callback)(hg_core_handle_t, hg_op_t,
-        hg_return_t (*done_callback)(hg_core_handle_t)),
-    void (*more_data_release_callback)(hg_core_handle_t))
-{
-    struct hg_core_private_class *private_class =
-        (struct hg_core_private_class *) hg_core_class;
-    hg_return_t ret = HG_SUCCESS;
+    if (hg_atomic_get32(&context->n_timers) == 0)
+        return;
 
-    HG_CHECK_ERROR(
-        hg_core_class == NULL, done, ret, HG_INVALID_ARG, "NULL HG core class");
+    for (;;) {
+        struct hg_core_private_handle *hg_core_handle = NULL;
+        struct hg_timer_wheel_node *node;
+        hg_util_int32_t gen = 0;
+        hg_return_t ret;
+
+        /* Take a reference so that the handle remains valid while it is
+         * canceled, even if it completes concurrently */
+        hg_core_spin_lock(HG_CORE_CONTEXT_CLASS(context),
+            &context->timer_wheel_lock, context->timer_wheel_lock_prof);
+        if (!advanced) {
+            hg_timer_wheel_advance(&context->timer_wheel, hg_core_timer_now());
+            advanced = HG_TRUE;
+        }
+        node = hg_timer_wheel_pop(&context->timer_wheel);
+        if (node) {
+            hg_core_handle = (struct hg_core_private_handle *) ((char *) node -
+                offsetof(struct hg_core_private_handle, timer));
+            hg_core_atomic_decr32(
+                HG_CORE_CONTEXT_CLASS(context), &context->n_timers);
+            hg_core_atomic_incr32(
+                HG_CORE_CONTEXT_CLASS(context), &hg_core_handle->ref_count);
+            gen = hg_core_handle->timer_gen;
+        }
+        hg_core_spin_unlock(
+            HG_CORE_CONTEXT_CLASS(context), &context->timer_wheel_lock);
 
-    private_class->more_data_acquire = more_data_acquire_callback;
-    private_class->more_data_release = more_data_release_callback;
+        if (hg_core_handle == NULL)
+            break;
 
-done:
-    return ret;
+        /* The handle may have completed and been forwarded again since its
+         * deadline expired, only cancel the forward that armed it. A new
+         * forward waits for expiring to drop before posting operations. */
+        hg_core_atomic_incr32(
+            HG_CORE_CONTEXT_CLASS(context), &hg_core_handle->expiring);
+        if (hg_atomic_get32(&hg_core_handle->forward_gen) == gen) {
+            HG_LOG_DEBUG(
+                "Deadline expired on handle %p", (void *) hg_core_handle);
+            hg_atomic_set32(&hg_core_handle->timed_out, HG_TRUE);
+            ret = hg_core_cancel(hg_core_handle);
+            HG_CHECK_WARNING(
+                ret != HG_SUCCESS, "Could not cancel timed out handle");
+        }
+        hg_core_atomic_decr32(
+            HG_CORE_CONTEXT_CLASS(context), &hg_core_handle->expiring);
+
+        /* Release reference */
+        hg_core_destroy(hg_core_handle);
+    }
 }
 
 /*---------------------------------------------------------------------------*/
-hg_core_context_t *
-HG_Core_context_create(hg_core_class_t *hg_core_class)
+static unsigned int
+hg_core_timer_wait(
+    struct hg_core_private_context *context, unsigned int timeout)
 {
-    return HG_Core_context_create_id(hg_core_class, 0);
+    hg_uint64_t next, now;
+
+    if (hg_atomic_get32(&context->n_timers) == 0)
+        return timeout;
+
+    hg_core_spin_lock(HG_CORE_CONTEXT_CLASS(context),
+        &context->timer_wheel_lock, context->timer_wheel_lock_prof);
+    next = hg_timer_wheel_next(&context->timer_wheel);
+    hg_core_spin_unlock(
+        HG_CORE_CONTEXT_CLASS(context), &context->timer_wheel_lock);
+
+    now = hg_core_timer_now();
+    if (next <= now)
+        return 0;
+
+    return (next - now < timeout) ? (unsigned int) (next - now) : timeout;
 }
 
 /*---------------------------------------------------------------------------*/
-hg_core_context_t *
-HG_Core_context_create_id(hg_core_class_t *hg_core_class, hg_uint8_t id)
+static hg_return_t
+hg_core_forward(struct hg_core_private_handle *hg_core_handle,
+    hg_core_cb_t callback, void *arg, hg_uint8_t flags,
+    hg_size_t payload_size, unsigned int timeout)
 {
-    struct hg_core_private_context *context = NULL;
-    int na_poll_fd;
-
-    HG_CHECK_ERROR_NORET(hg_core_class == NULL, error, "NULL HG core class");
-
-    context = (struct hg_core_private_context *) malloc(
-        sizeof(struct hg_core_private_context));
-    HG_CHECK_ERROR_NORET(
-        context == NULL, error, "Could not allocate HG context");
+    hg_size_t header_size;
+    hg_bool_t in_use;
+    hg_return_t ret = HG_SUCCESS;
 
-    memset(context, 0, sizeof(struct hg_core_private_context));
-    context->core_context.core_class = hg_core_class;
-    context->completion_queue =
-        hg_atomic_queue_alloc(HG_CORE_ATOMIC_QUEUE_SIZE);
-    HG_CHECK_ERROR_NORET(
-        context->completion_queue == NULL, error, "Could not allocate queue");
+    HG_CHECK_ERROR(hg_core_handle->core_handle.info.addr == HG_CORE_ADDR_NULL,
+        done, ret, HG_INVALID_ARG, "NULL target addr");
+    HG_CHECK_ERROR(hg_core_handle->core_handle.info.id == 0, done, ret,
+        HG_INVALID_ARG, "NULL RPC ID");
 
-    HG_QUEUE_INIT(&context->backfill_queue);
-    hg_atomic_init32(&context->backfill_queue_count, 0);
-    HG_LIST_INIT(&context->pending_list);
-#ifdef HG_HAS_SM_ROUTING
-    HG_LIST_INIT(&context->sm_pending_list);
+#ifndef HG_HAS_SELF_FORWARD
+    HG_CHECK_ERROR(hg_core_handle->is_self, done, ret, HG_INVALID_PARAM,
+        "Forward to self not enabled, please enable HG_USE_SELF_FORWARD");
 #endif
-    HG_LIST_INIT(&context->created_list);
+    /* Fragment op IDs of the previous call must not be reposted */
+    HG_CHECK_ERROR(hg_atomic_get32(&hg_core_handle->frag_send_pending) > 0,
+        done, ret, HG_BUSY, "Fragments of previous call are still in flight");
 
-    /* No handle created yet */
-    hg_atomic_init32(&context->n_handles, 0);
+    in_use = (hg_core_atomic_cas32(HG_CORE_HANDLE_CLASS(hg_core_handle),
+                  &hg_core_handle->in_use, HG_FALSE, HG_TRUE) != HG_UTIL_TRUE);
+    /* Not safe to reset
+     * TODO could add the ability to defer the reset operation */
+    HG_CHECK_ERROR(in_use, done, ret, HG_BUSY,
+        "Not safe to use HG core handle, handle is still in use, refcount: %d",
+        hg_atomic_get32(&hg_core_handle->ref_count));
+
+    /* Make sure any cancelation has been processed on this handle before
+     * re-using it */
+    while (hg_atomic_get32(&hg_core_handle->canceling)) {
+        int cb_ret[HG_CORE_MAX_TRIGGER_COUNT] = {0};
+        unsigned int trigger_count = 0;
+        na_return_t na_ret;
+
+        na_ret = NA_Trigger(hg_core_handle->na_context, 0,
+            HG_CORE_MAX_TRIGGER_COUNT, cb_ret, &trigger_count);
+        HG_CHECK_ERROR(na_ret != NA_SUCCESS && na_ret != NA_TIMEOUT, done, ret,
+            (hg_return_t) na_ret, "Could not trigger NA callback (%s)",
+            NA_Error_to_string(na_ret));
+    }
+
+#ifdef HG_HAS_COLLECT_STATS
+    /* Increment counter */
+    hg_core_stat_incr(&hg_core_rpc_count_g);
+#endif
+
+    /* Reset op counts */
+    hg_core_handle->na_op_count = 1; /* Default (no response) */
+    hg_atomic_set32(&hg_core_handle->na_op_completed_count, 0);
+
+    /* An expired deadline of the previous forward must not cancel this one,
+     * see hg_core_timer_expire() */
+    hg_core_atomic_incr32(
+        HG_CORE_HANDLE_CLASS(hg_core_handle), &hg_core_handle->forward_gen);
+    while (hg_atomic_get32(&hg_core_handle->expiring))
+        cpu_spinwait();
+
+    /* Reset handle ret */
+    hg_core_handle->ret = HG_SUCCESS;
+    hg_atomic_set32(&hg_core_handle->timed_out, HG_FALSE);
+
+    /* Increase ref count here so that a call to HG_Destroy does not free the
+     * handle but only schedules its completion
+     */
+    hg_core_atomic_incr32(HG_CORE_HANDLE_CLASS(hg_core_handle),
+        &hg_core_handle->ref_count);
+
+    /* Set header size */
+    header_size = hg_core_header_request_get_size() +
+                  hg_core_handle->core_handle.na_in_header_offset;
+
+    /* Set the actual size of the msg that needs to be transmitted */
+    hg_core_handle->in_buf_used = header_size + payload_size;
+    HG_CHECK_ERROR(
+        hg_core_handle->in_buf_used > hg_core_handle->core_handle.in_buf_size,
+        error, ret, HG_MSGSIZE, "Exceeding input buffer size");
+
+    /* Parse flags */
+    if (flags & HG_CORE_NO_RESPONSE)
+        hg_core_handle->no_response = HG_TRUE;
+    if (hg_core_handle->is_self)
+        flags |= HG_CORE_SELF_FORWARD;
+    else if (hg_core_handle->frag_buf_size > 0)
+        flags |= HG_CORE_MORE_DATA_FRAG;
+    hg_core_handle->send_frag_count = 0;
+
+    /* Set callback, keep request and response callbacks separate so that
+     * they do not get overwritten when forwarding to ourself */
+    hg_core_handle->request_callback = callback;
+    hg_core_handle->request_arg = arg;
+
+    /* Set header */
+    hg_core_handle->in_header.msg.request.id =
+        hg_core_handle->core_handle.info.id;
+    hg_core_handle->in_header.msg.request.flags = flags;
+    /* Set the cookie as origin context ID, so that when the cookie is unpacked
+     * by the target and assigned to HG info context_id, the NA layer knows
+     * which context ID it needs to send the response to. */
+    hg_core_handle->in_header.msg.request.cookie =
+        hg_core_handle->core_handle.info.context->id;
+
+    /* Encode request header */
+    ret = hg_core_proc_header_request(
+        &hg_core_handle->core_handle, &hg_core_handle->in_header, HG_ENCODE);
+    HG_CHECK_HG_ERROR(error, ret, "Could not encode header");
+
+    /* Arm deadline before operations are posted, as they may complete
+     * before forward returns */
+    if (timeout > 0)
+        hg_core_timer_arm(hg_core_handle, timeout);
+
+    /* If addr is self, forward locally, otherwise send the encoded buffer
+     * through NA and pre-post response */
+    ret = hg_core_handle->forward(hg_core_handle);
+
+    /* Fragments must be registered again before next call */
+    hg_core_handle->frag_buf = NULL;
+    hg_core_handle->frag_buf_size = 0;
+
+    if (ret == HG_AGAIN)
+        goto error;
+
+    HG_CHECK_HG_ERROR(error, ret, "Could not forward buffer");
+
+    /* Only notify once the request is posted (self forwards notify from
+     * hg_core_forward_self() as the request is processed inline) */
+    if (!hg_core_handle->is_self)
+        HG_TOOL_NOTIFY(HG_TOOL_FORWARD_POSTED,
+            hg_core_handle->core_handle.info.context,
+            (hg_core_handle_t) hg_core_handle, NULL,
+            hg_core_handle->in_buf_used, HG_SUCCESS);
+
+done:
+    return ret;
+
+error:
+    /* Deadline no longer applies */
+    hg_core_timer_disarm(hg_core_handle);
+
+    /* Handle is no longer in use */
+    hg_atomic_set32(&hg_core_handle->in_use, HG_FALSE);
+    /* Rollback ref_count taken above */
+    hg_core_atomic_decr32(HG_CORE_HANDLE_CLASS(hg_core_handle),
+        &hg_core_handle->ref_count);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_core_class_t *
+HG_Core_init(const char *na_info_string, hg_bool_t na_listen)
+{
+    return HG_Core_init_opt(na_info_string, na_listen, NULL);
+}
+
+/*---------------------------------------------------------------------------*/
+hg_core_class_t *
+HG_Core_init_opt(const char *na_info_string, hg_bool_t na_listen,
+    const struct hg_init_info *hg_init_info)
+{
+    struct hg_core_private_class *hg_core_class = NULL;
+
+    hg_core_class = hg_core_init(na_info_string, na_listen, hg_init_info);
+    HG_CHECK_ERROR_NORET(
+        hg_core_class == NULL, done, "Cannot initialize HG core layer");
+
+done:
+    return (hg_core_class_t *) hg_core_class;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Core_finalize(hg_core_class_t *hg_core_class)
+{
+    hg_return_t ret;
+
+    ret = hg_core_finalize((struct hg_core_private_class *) hg_core_class);
+    HG_CHECK_HG_ERROR(done, ret, "Cannot finalize HG core layer");
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+void
+HG_Core_cleanup(void)
+{
+    NA_Cleanup();
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Core_set_more_data_callback(struct hg_core_class *hg_core_class,
+    hg_return_t (*more_data_acquire_callback)(hg_core_handle_t, hg_op_t,
+        hg_return_t (*done_callback)(hg_core_handle_t)),
+    void (*more_data_release_callback)(hg_core_handle_t))
+{
+    struct hg_core_private_class *private_class =
+        (struct hg_core_private_class *) hg_core_class;
+    hg_return_t ret = HG_SUCCESS;
+
+    HG_CHECK_ERROR(
+        hg_core_class == NULL, done, ret, HG_INVALID_ARG, "NULL HG core class");
+
+    private_class->more_data_acquire = more_data_acquire_callback;
+    private_class->more_data_release = more_data_release_callback;
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Core_class_set_frag_threshold(
+    hg_core_class_t *hg_core_class, hg_size_t threshold)
+{
+    hg_return_t ret = HG_SUCCESS;
+
+    HG_CHECK_ERROR(
+        hg_core_class == NULL, done, ret, HG_INVALID_ARG, "NULL HG core class");
+    HG_CHECK_ERROR(threshold > 0 &&
+                       !NA_Msg_has_early_expected(hg_core_class->na_class),
+        done, ret, HG_OPNOTSUPPORTED,
+        "NA plugin does not support early expected messages");
+
+    ((struct hg_core_private_class *) hg_core_class)->frag_threshold =
+        threshold;
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_size_t
+HG_Core_class_get_frag_threshold(const hg_core_class_t *hg_core_class)
+{
+    HG_CHECK_ERROR_NORET(hg_core_class == NULL, error, "NULL HG core class");
+
+    return ((const struct hg_core_private_class *) hg_core_class)
+        ->frag_threshold;
+
+error:
+    return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_core_context_t *
+HG_Core_context_create(hg_core_class_t *hg_core_class)
+{
+    return HG_Core_context_create_id(hg_core_class, 0);
+}
+
+/*---------------------------------------------------------------------------*/
+hg_core_context_t *
+HG_Core_context_create_id(hg_core_class_t *hg_core_class, hg_uint8_t id)
+{
+    struct hg_core_private_context *context = NULL;
+    int na_poll_fd;
+
+    HG_CHECK_ERROR_NORET(hg_core_class == NULL, error, "NULL HG core class");
+
+    context = (struct hg_core_private_context *) malloc(
+        sizeof(struct hg_core_private_context));
+    HG_CHECK_ERROR_NORET(
+        context == NULL, error, "Could not allocate HG context");
+
+    memset(context, 0, sizeof(struct hg_core_private_context));
+    context->core_context.core_class = hg_core_class;
+    context->completion_queue =
+        hg_atomic_queue_alloc(HG_CORE_ATOMIC_QUEUE_SIZE);
+    HG_CHECK_ERROR_NORET(
+        context->completion_queue == NULL, error, "Could not allocate queue");
+    hg_mem_usage_add(HG_MEM_USAGE_COMPLETION_QUEUE, HG_CORE_ATOMIC_QUEUE_MEM);
+
+    HG_QUEUE_INIT(&context->backfill_queue);
+    hg_atomic_init32(&context->backfill_queue_count, 0);
+    HG_LIST_INIT(&context->pending_list);
+#ifdef HG_HAS_SM_ROUTING
+    HG_LIST_INIT(&context->sm_pending_list);
+#endif
+    HG_LIST_INIT(&context->created_list);
+
+    /* No handle created yet */
+    hg_atomic_init32(&context->n_handles, 0);
 
     /* Notifications of completion queue events */
     hg_atomic_init32(&context->completion_queue_must_notify, 0);
     hg_thread_mutex_init(&context->completion_queue_notify_mutex);
+    context->completion_queue_notify_mutex_prof =
+        hg_thread_lock_prof_register("hg_core.completion_queue_notify");
 
     /* Initialize completion queue mutex/cond */
     hg_thread_mutex_init(&context->completion_queue_mutex);
-    hg_thread_cond_init(&context->completion_queue_cond);
-    hg_atomic_init32(&context->trigger_waiting, 0);
+    context->completion_queue_mutex_prof =
+        hg_thread_lock_prof_register("hg_core.completion_queue");
+    hg_eventcount_init(&context->completion_queue_ec);
 
     hg_thread_spin_init(&context->pending_list_lock);
     hg_thread_spin_init(&context->created_list_lock);
+    context->pending_list_lock_prof =
+        hg_thread_lock_prof_register("hg_core.pending_list");
+    context->created_list_lock_prof =
+        hg_thread_lock_prof_register("hg_core.created_list");
+
+    /* No timed forward yet */
+    hg_timer_wheel_init(&context->timer_wheel, hg_core_timer_now());
+    hg_thread_spin_init(&context->timer_wheel_lock);
+    context->timer_wheel_lock_prof =
+        hg_thread_lock_prof_register("hg_core.timer_wheel");
+    hg_atomic_init32(&context->n_timers, 0);
 
     context->core_context.na_context =
         NA_Context_create_id(hg_core_class->na_class, id);
@@ -3246,6 +4641,8 @@ HG_Core_context_create_id(hg_core_class_t *hg_core_class, hg_uint8_t id)
         HG_CHECK_ERROR_NORET(
             context->poll_set == NULL, error, "Could not create poll set");
 
+        /* NA fds may also be polled from other poll sets, only wake up one */
+        event.events = HG_POLLIN | HG_POLLEXCLUSIVE;
         event.data.u32 = (hg_util_uint32_t) HG_CORE_POLL_NA;
         rc = hg_poll_add(context->poll_set, na_poll_fd, &event);
         HG_CHECK_ERROR_NORET(
@@ -3272,6 +4669,7 @@ HG_Core_context_create_id(hg_core_class_t *hg_core_class, hg_uint8_t id)
             "Could not create event");
 
         /* Add event to context poll set */
+        event.events = HG_POLLIN;
         event.data.u32 = (hg_util_uint32_t) HG_CORE_POLL_LOOPBACK;
         rc = hg_poll_add(
             context->poll_set, context->completion_queue_notify, &event);
@@ -3283,6 +4681,15 @@ HG_Core_context_create_id(hg_core_class_t *hg_core_class, hg_uint8_t id)
     /* Assign context ID */
     context->core_context.id = id;
 
+#ifdef HG_HAS_COLLECT_STATS
+    /* Progress accounting */
+    if (HG_CORE_CONTEXT_CLASS(context)->stats) {
+        context->progress_acct = hg_core_progress_acct_create();
+        HG_CHECK_ERROR_NORET(context->progress_acct == NULL, error,
+            "Could not create progress accounting");
+    }
+#endif
+
     /* Increment context count of parent class */
     hg_atomic_incr32(&HG_CORE_CONTEXT_CLASS(context)->n_contexts);
 
@@ -3348,13 +4755,16 @@ HG_Core_context_destroy(hg_core_context_t *context)
         HG_LOG_ERROR("HG core handles must be freed before destroying context "
                      "(%d remaining)",
             n_handles);
-        hg_thread_spin_lock(&private_context->created_list_lock);
+        hg_core_spin_lock(HG_CORE_CONTEXT_CLASS(private_context),
+            &private_context->created_list_lock,
+            private_context->created_list_lock_prof);
         HG_LIST_FOREACH (
             hg_core_handle, &private_context->created_list, created) {
             HG_LOG_ERROR("HG core handle at address %p was not destroyed",
                 hg_core_handle);
         }
-        hg_thread_spin_unlock(&private_context->created_list_lock);
+        hg_core_spin_unlock(HG_CORE_CONTEXT_CLASS(private_context),
+            &private_context->created_list_lock);
         ret = HG_BUSY;
         goto done;
     }
@@ -3363,11 +4773,15 @@ HG_Core_context_destroy(hg_core_context_t *context)
     HG_CHECK_ERROR(!hg_atomic_queue_is_empty(private_context->completion_queue),
         done, ret, HG_BUSY, "Completion queue should be empty");
     hg_atomic_queue_free(private_context->completion_queue);
+    hg_mem_usage_sub(HG_MEM_USAGE_COMPLETION_QUEUE, HG_CORE_ATOMIC_QUEUE_MEM);
 
     /* Check that completion queue is empty now */
-    hg_thread_mutex_lock(&private_context->completion_queue_mutex);
+    hg_core_mutex_lock(HG_CORE_CONTEXT_CLASS(private_context),
+        &private_context->completion_queue_mutex,
+        private_context->completion_queue_mutex_prof);
     empty = HG_QUEUE_IS_EMPTY(&private_context->backfill_queue);
-    hg_thread_mutex_unlock(&private_context->completion_queue_mutex);
+    hg_core_mutex_unlock(HG_CORE_CONTEXT_CLASS(private_context),
+        &private_context->completion_queue_mutex);
     HG_CHECK_ERROR(
         !empty, done, ret, HG_BUSY, "Completion queue should be empty");
 
@@ -3440,13 +4854,22 @@ HG_Core_context_destroy(hg_core_context_t *context)
     /* Destroy completion queue mutex/cond */
     hg_thread_mutex_destroy(&private_context->completion_queue_notify_mutex);
     hg_thread_mutex_destroy(&private_context->completion_queue_mutex);
-    hg_thread_cond_destroy(&private_context->completion_queue_cond);
+    hg_eventcount_destroy(&private_context->completion_queue_ec);
     hg_thread_spin_destroy(&private_context->pending_list_lock);
     hg_thread_spin_destroy(&private_context->created_list_lock);
+    hg_thread_spin_destroy(&private_context->timer_wheel_lock);
 
     /* Decrement context count of parent class */
     hg_atomic_decr32(&HG_CORE_CONTEXT_CLASS(private_context)->n_contexts);
 
+#ifdef HG_HAS_COLLECT_STATS
+    /* Print progress accounting summary */
+    if (private_context->progress_acct) {
+        hg_core_progress_acct_print(private_context);
+        free(private_context->progress_acct);
+    }
+#endif
+
     free(private_context);
 
 done:
@@ -3502,6 +4925,63 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Core_context_get_progress_stats(
+    hg_core_context_t *context, struct hg_progress_stats *stats)
+{
+    hg_return_t ret = HG_SUCCESS;
+
+    HG_CHECK_ERROR(
+        context == NULL, done, ret, HG_INVALID_ARG, "NULL HG core context");
+    HG_CHECK_ERROR(
+        stats == NULL, done, ret, HG_INVALID_ARG, "NULL progress stats");
+
+#ifdef HG_HAS_COLLECT_STATS
+    {
+        struct hg_core_private_context *private_context =
+            (struct hg_core_private_context *) context;
+
+        HG_CHECK_ERROR(private_context->progress_acct == NULL, done, ret,
+            HG_OPNOTSUPPORTED, "Progress accounting is not enabled");
+        hg_core_progress_acct_get(private_context->progress_acct, stats);
+    }
+#else
+    HG_GOTO_ERROR(done, ret, HG_OPNOTSUPPORTED,
+        "Progress accounting requires stats support");
+#endif
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Core_context_reset_progress_stats(hg_core_context_t *context)
+{
+    hg_return_t ret = HG_SUCCESS;
+
+    HG_CHECK_ERROR(
+        context == NULL, done, ret, HG_INVALID_ARG, "NULL HG core context");
+
+#ifdef HG_HAS_COLLECT_STATS
+    {
+        struct hg_core_private_context *private_context =
+            (struct hg_core_private_context *) context;
+
+        HG_CHECK_ERROR(private_context->progress_acct == NULL, done, ret,
+            HG_OPNOTSUPPORTED, "Progress accounting is not enabled");
+        hg_core_progress_acct_reset(private_context->progress_acct);
+    }
+#else
+    HG_GOTO_ERROR(done, ret, HG_OPNOTSUPPORTED,
+        "Progress accounting requires stats support");
+#endif
+
+done:
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 hg_return_t
 HG_Core_register(
@@ -3518,12 +4998,13 @@ HG_Core_register(
         "NULL HG core class");
 
     /* Check if registered and set RPC CB */
-    hg_thread_spin_lock(&private_class->func_map_lock);
+    hg_core_spin_lock(private_class, &private_class->func_map_lock,
+        private_class->func_map_lock_prof);
     hg_core_rpc_info = (struct hg_core_rpc_info *) hg_hash_table_lookup(
         private_class->func_map, (hg_hash_table_key_t) &id);
     if (hg_core_rpc_info && rpc_cb)
         hg_core_rpc_info->rpc_cb = rpc_cb;
-    hg_thread_spin_unlock(&private_class->func_map_lock);
+    hg_core_spin_unlock(private_class, &private_class->func_map_lock);
 
     if (!hg_core_rpc_info) {
         /* Allocate the key */
@@ -3542,10 +5023,11 @@ HG_Core_register(
         hg_core_rpc_info->data = NULL;
         hg_core_rpc_info->free_callback = NULL;
 
-        hg_thread_spin_lock(&private_class->func_map_lock);
+        hg_core_spin_lock(private_class, &private_class->func_map_lock,
+            private_class->func_map_lock_prof);
         hash_ret = hg_hash_table_insert(private_class->func_map,
             (hg_hash_table_key_t) func_key, hg_core_rpc_info);
-        hg_thread_spin_unlock(&private_class->func_map_lock);
+        hg_core_spin_unlock(private_class, &private_class->func_map_lock);
         HG_CHECK_ERROR(hash_ret == 0, error, ret, HG_INVALID_ARG,
             "Could not insert RPC ID into function map (already registered?)");
     }
@@ -3571,10 +5053,11 @@ HG_Core_deregister(hg_core_class_t *hg_core_class, hg_id_t id)
     HG_CHECK_ERROR(
         hg_core_class == NULL, done, ret, HG_INVALID_ARG, "NULL HG core class");
 
-    hg_thread_spin_lock(&private_class->func_map_lock);
+    hg_core_spin_lock(private_class, &private_class->func_map_lock,
+        private_class->func_map_lock_prof);
     hash_ret = hg_hash_table_remove(
         private_class->func_map, (hg_hash_table_key_t) &id);
-    hg_thread_spin_unlock(&private_class->func_map_lock);
+    hg_core_spin_unlock(private_class, &private_class->func_map_lock);
     HG_CHECK_ERROR(hash_ret == 0, done, ret, HG_NOENTRY,
         "Could not deregister RPC ID from function map");
 
@@ -3594,10 +5077,11 @@ HG_Core_registered(hg_core_class_t *hg_core_class, hg_id_t id, hg_bool_t *flag)
         hg_core_class == NULL, done, ret, HG_INVALID_ARG, "NULL HG core class");
     HG_CHECK_ERROR(flag == NULL, done, ret, HG_INVALID_ARG, "NULL flag");
 
-    hg_thread_spin_lock(&private_class->func_map_lock);
+    hg_core_spin_lock(private_class, &private_class->func_map_lock,
+        private_class->func_map_lock_prof);
     *flag = (hg_bool_t)(hg_hash_table_lookup(private_class->func_map,
                             (hg_hash_table_key_t) &id) != HG_HASH_TABLE_NULL);
-    hg_thread_spin_unlock(&private_class->func_map_lock);
+    hg_core_spin_unlock(private_class, &private_class->func_map_lock);
 
 done:
     return ret;
@@ -3616,10 +5100,11 @@ HG_Core_register_data(hg_core_class_t *hg_core_class, hg_id_t id, void *data,
     HG_CHECK_ERROR(
         hg_core_class == NULL, done, ret, HG_INVALID_ARG, "NULL HG core class");
 
-    hg_thread_spin_lock(&private_class->func_map_lock);
+    hg_core_spin_lock(private_class, &private_class->func_map_lock,
+        private_class->func_map_lock_prof);
     hg_core_rpc_info = (struct hg_core_rpc_info *) hg_hash_table_lookup(
         private_class->func_map, (hg_hash_table_key_t) &id);
-    hg_thread_spin_unlock(&private_class->func_map_lock);
+    hg_core_spin_unlock(private_class, &private_class->func_map_lock);
     HG_CHECK_ERROR(hg_core_rpc_info == NULL, done, ret, HG_NOENTRY,
         "Could not find RPC ID in function map");
 
@@ -3643,10 +5128,11 @@ HG_Core_registered_data(hg_core_class_t *hg_core_class, hg_id_t id)
 
     HG_CHECK_ERROR_NORET(hg_core_class == NULL, done, "NULL HG core class");
 
-    hg_thread_spin_lock(&private_class->func_map_lock);
+    hg_core_spin_lock(private_class, &private_class->func_map_lock,
+        private_class->func_map_lock_prof);
     hg_core_rpc_info = (struct hg_core_rpc_info *) hg_hash_table_lookup(
         private_class->func_map, (hg_hash_table_key_t) &id);
-    hg_thread_spin_unlock(&private_class->func_map_lock);
+    hg_core_spin_unlock(private_class, &private_class->func_map_lock);
     HG_CHECK_ERROR_NORET(hg_core_rpc_info == NULL, done,
         "Could not find RPC ID in function map");
 
@@ -3973,6 +5459,8 @@ HG_Core_reset(hg_core_handle_t handle, hg_core_addr_t addr, hg_id_t id)
         "Cannot reset HG core handle, still in use, "
         "refcount: %d",
         hg_atomic_get32(&hg_core_handle->ref_count));
+    HG_CHECK_ERROR(hg_atomic_get32(&hg_core_handle->frag_send_pending) > 0,
+        done, ret, HG_BUSY, "Cannot reset HG core handle, fragments in flight");
 
 #ifdef HG_HAS_SM_ROUTING
     if (hg_core_addr &&
@@ -4013,7 +5501,8 @@ HG_Core_ref_incr(hg_core_handle_t handle)
 
     HG_CHECK_ERROR(hg_core_handle == NULL, done, ret, HG_INVALID_ARG,
         "NULL HG core handle");
-    hg_atomic_incr32(&hg_core_handle->ref_count);
+    hg_core_atomic_incr32(HG_CORE_HANDLE_CLASS(hg_core_handle),
+        &hg_core_handle->ref_count);
 
 done:
     return ret;
@@ -4040,116 +5529,38 @@ hg_return_t
 HG_Core_forward(hg_core_handle_t handle, hg_core_cb_t callback, void *arg,
     hg_uint8_t flags, hg_size_t payload_size)
 {
-    struct hg_core_private_handle *hg_core_handle =
-        (struct hg_core_private_handle *) handle;
-    hg_size_t header_size;
-    hg_bool_t in_use;
     hg_return_t ret = HG_SUCCESS;
 
-    HG_CHECK_ERROR(hg_core_handle == NULL, done, ret, HG_INVALID_ARG,
+    HG_CHECK_ERROR(handle == HG_CORE_HANDLE_NULL, done, ret, HG_INVALID_ARG,
         "NULL HG core handle");
-    HG_CHECK_ERROR(hg_core_handle->core_handle.info.addr == HG_CORE_ADDR_NULL,
-        done, ret, HG_INVALID_ARG, "NULL target addr");
-    HG_CHECK_ERROR(hg_core_handle->core_handle.info.id == 0, done, ret,
-        HG_INVALID_ARG, "NULL RPC ID");
-
-#ifndef HG_HAS_SELF_FORWARD
-    HG_CHECK_ERROR(hg_core_handle->is_self, done, ret, HG_INVALID_PARAM,
-        "Forward to self not enabled, please enable HG_USE_SELF_FORWARD");
-#endif
-    in_use = (hg_atomic_cas32(&hg_core_handle->in_use, HG_FALSE, HG_TRUE) !=
-              HG_UTIL_TRUE);
-    /* Not safe to reset
-     * TODO could add the ability to defer the reset operation */
-    HG_CHECK_ERROR(in_use, done, ret, HG_BUSY,
-        "Not safe to use HG core handle, handle is still in use, refcount: %d",
-        hg_atomic_get32(&hg_core_handle->ref_count));
-
-    /* Make sure any cancelation has been processed on this handle before
-     * re-using it */
-    while (hg_atomic_get32(&hg_core_handle->canceling)) {
-        int cb_ret[HG_CORE_MAX_TRIGGER_COUNT] = {0};
-        unsigned int trigger_count = 0;
-        na_return_t na_ret;
-
-        na_ret = NA_Trigger(hg_core_handle->na_context, 0,
-            HG_CORE_MAX_TRIGGER_COUNT, cb_ret, &trigger_count);
-        HG_CHECK_ERROR(na_ret != NA_SUCCESS && na_ret != NA_TIMEOUT, done, ret,
-            (hg_return_t) na_ret, "Could not trigger NA callback (%s)",
-            NA_Error_to_string(na_ret));
-    }
-
-#ifdef HG_HAS_COLLECT_STATS
-    /* Increment counter */
-    hg_core_stat_incr(&hg_core_rpc_count_g);
-#endif
-
-    /* Reset op counts */
-    hg_core_handle->na_op_count = 1; /* Default (no response) */
-    hg_atomic_set32(&hg_core_handle->na_op_completed_count, 0);
-
-    /* Reset handle ret */
-    hg_core_handle->ret = HG_SUCCESS;
-
-    /* Increase ref count here so that a call to HG_Destroy does not free the
-     * handle but only schedules its completion
-     */
-    hg_atomic_incr32(&hg_core_handle->ref_count);
-
-    /* Set header size */
-    header_size = hg_core_header_request_get_size() +
-                  hg_core_handle->core_handle.na_in_header_offset;
-
-    /* Set the actual size of the msg that needs to be transmitted */
-    hg_core_handle->in_buf_used = header_size + payload_size;
-    HG_CHECK_ERROR(
-        hg_core_handle->in_buf_used > hg_core_handle->core_handle.in_buf_size,
-        error, ret, HG_MSGSIZE, "Exceeding input buffer size");
-
-    /* Parse flags */
-    if (flags & HG_CORE_NO_RESPONSE)
-        hg_core_handle->no_response = HG_TRUE;
-    if (hg_core_handle->is_self)
-        flags |= HG_CORE_SELF_FORWARD;
 
-    /* Set callback, keep request and response callbacks separate so that
-     * they do not get overwritten when forwarding to ourself */
-    hg_core_handle->request_callback = callback;
-    hg_core_handle->request_arg = arg;
+    ret = hg_core_forward((struct hg_core_private_handle *) handle, callback,
+        arg, flags, payload_size, 0);
 
-    /* Set header */
-    hg_core_handle->in_header.msg.request.id =
-        hg_core_handle->core_handle.info.id;
-    hg_core_handle->in_header.msg.request.flags = flags;
-    /* Set the cookie as origin context ID, so that when the cookie is unpacked
-     * by the target and assigned to HG info context_id, the NA layer knows
-     * which context ID it needs to send the response to. */
-    hg_core_handle->in_header.msg.request.cookie =
-        hg_core_handle->core_handle.info.context->id;
+done:
+    return ret;
+}
 
-    /* Encode request header */
-    ret = hg_core_proc_header_request(
-        &hg_core_handle->core_handle, &hg_core_handle->in_header, HG_ENCODE);
-    HG_CHECK_HG_ERROR(error, ret, "Could not encode header");
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Core_forward_timed(hg_core_handle_t handle, hg_core_cb_t callback,
+    void *arg, hg_uint8_t flags, hg_size_t payload_size, unsigned int timeout)
+{
+    hg_return_t ret = HG_SUCCESS;
 
-    /* If addr is self, forward locally, otherwise send the encoded buffer
-     * through NA and pre-post response */
-    ret = hg_core_handle->forward(hg_core_handle);
-    if (ret == HG_AGAIN)
-        goto error;
+    HG_CHECK_ERROR(handle == HG_CORE_HANDLE_NULL, done, ret, HG_INVALID_ARG,
+        "NULL HG core handle");
+    /* Expired forwards are canceled, which is not supported locally */
+    HG_CHECK_ERROR(timeout > 0 &&
+                       ((struct hg_core_private_handle *) handle)->is_self,
+        done, ret, HG_OPNOTSUPPORTED,
+        "Timed forward to self is not supported");
 
-    HG_CHECK_HG_ERROR(error, ret, "Could not forward buffer");
+    ret = hg_core_forward((struct hg_core_private_handle *) handle, callback,
+        arg, flags, payload_size, timeout);
 
 done:
     return ret;
-
-error:
-    /* Handle is no longer in use */
-    hg_atomic_set32(&hg_core_handle->in_use, HG_FALSE);
-    /* Rollback ref_count taken above */
-    hg_atomic_decr32(&hg_core_handle->ref_count);
-
-    return ret;
 }
 
 /*---------------------------------------------------------------------------*/
@@ -4169,6 +5580,10 @@ HG_Core_respond(hg_core_handle_t handle, hg_core_cb_t callback, void *arg,
     HG_CHECK_ERROR(hg_core_handle->no_response, done, ret, HG_OPNOTSUPPORTED,
         "Sending response was disabled on that RPC");
 
+    /* Fragment op IDs of the previous call must not be reposted */
+    HG_CHECK_ERROR(hg_atomic_get32(&hg_core_handle->frag_send_pending) > 0,
+        done, ret, HG_BUSY, "Fragments of previous call are still in flight");
+
     /* Set header size */
     header_size = hg_core_header_response_get_size() +
                   hg_core_handle->core_handle.na_out_header_offset;
@@ -4186,23 +5601,141 @@ HG_Core_respond(hg_core_handle_t handle, hg_core_cb_t callback, void *arg,
 
     /* Set header */
     hg_core_handle->out_header.msg.response.ret_code = hg_core_handle->ret;
+    if (hg_core_handle->frag_buf_size > 0 &&
+        !(hg_core_handle->in_header.msg.request.flags & HG_CORE_SELF_FORWARD))
+        flags |= HG_CORE_MORE_DATA_FRAG;
     hg_core_handle->out_header.msg.response.flags = flags;
     hg_core_handle->out_header.msg.response.cookie = hg_core_handle->cookie;
+    hg_core_handle->out_header.protocol =
+        hg_core_handle->in_header.msg.request.protocol;
+    hg_core_handle->send_frag_count = 0;
 
     /* Encode response header */
     ret = hg_core_proc_header_response(
         &hg_core_handle->core_handle, &hg_core_handle->out_header, HG_ENCODE);
     HG_CHECK_HG_ERROR(done, ret, "Could not encode header");
 
+    if (hg_core_handle->capture)
+        hg_capture_respond(hg_core_handle->capture, payload_size);
+
     /* If addr is self, forward locally, otherwise send the encoded buffer
      * through NA and pre-post response */
     ret = hg_core_handle->respond(hg_core_handle);
+
+    /* Fragments must be registered again before next call */
+    hg_core_handle->frag_buf = NULL;
+    hg_core_handle->frag_buf_size = 0;
+
     HG_CHECK_HG_ERROR(done, ret, "Could not respond");
 
+    HG_TOOL_NOTIFY(HG_TOOL_RESPOND_POSTED,
+        hg_core_handle->core_handle.info.context,
+        (hg_core_handle_t) hg_core_handle, NULL, hg_core_handle->out_buf_used,
+        HG_SUCCESS);
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_uint8_t
+HG_Core_get_protocol(hg_core_handle_t handle)
+{
+    HG_CHECK_ERROR_NORET(handle == NULL, error, "NULL HG core handle");
+
+    /* Responses always follow the protocol of the request */
+    return ((struct hg_core_private_handle *) handle)
+        ->in_header.msg.request.protocol;
+
+error:
+    return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Core_set_frag(hg_core_handle_t handle, const void *buf, hg_size_t buf_size)
+{
+    struct hg_core_private_handle *hg_core_handle =
+        (struct hg_core_private_handle *) handle;
+    hg_return_t ret = HG_SUCCESS;
+
+    HG_CHECK_ERROR(hg_core_handle == NULL, done, ret, HG_INVALID_ARG,
+        "NULL HG core handle");
+
+    hg_core_handle->frag_buf = buf;
+    hg_core_handle->frag_buf_size = (na_size_t) buf_size;
+
 done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Core_recv_frag(hg_core_handle_t handle, void *buf, hg_size_t buf_size,
+    hg_return_t (*done_callback)(hg_core_handle_t))
+{
+    struct hg_core_private_handle *hg_core_handle =
+        (struct hg_core_private_handle *) handle;
+    na_size_t frag_size;
+    unsigned int i = 0, count;
+    hg_return_t ret = HG_SUCCESS;
+
+    HG_CHECK_ERROR(hg_core_handle == NULL, done, ret, HG_INVALID_ARG,
+        "NULL HG core handle");
+    HG_CHECK_ERROR(buf_size == 0 || done_callback == NULL, done, ret,
+        HG_INVALID_ARG, "Invalid fragment arguments");
+
+    frag_size = hg_core_handle->core_handle.out_buf_size -
+                hg_core_handle->core_handle.na_out_header_offset;
+    count = hg_core_frag_count(hg_core_handle, (na_size_t) buf_size);
+
+    ret = hg_core_frag_alloc(hg_core_handle, &hg_core_handle->recv_frags,
+        &hg_core_handle->recv_frag_max, count);
+    HG_CHECK_HG_ERROR(done, ret, "Could not allocate fragments");
+
+    hg_core_handle->recv_frag_count = count;
+    hg_core_handle->frag_done_callback = done_callback;
+    hg_atomic_set32(&hg_core_handle->frag_recv_pending, (hg_util_int32_t) count);
+
+    /* Fragments that arrived before this call are buffered by NA */
+    for (i = 0; i < count; i++) {
+        struct hg_core_frag *frag = &hg_core_handle->recv_frags[i];
+        na_return_t na_ret;
+
+        frag->dest = (char *) buf + i * frag_size;
+        frag->size = (i < count - 1) ? frag_size
+                                     : (na_size_t) buf_size - i * frag_size;
+
+        na_ret = NA_Msg_recv_expected(hg_core_handle->na_class,
+            hg_core_handle->na_context, hg_core_recv_frag_cb, frag, frag->buf,
+            hg_core_handle->core_handle.out_buf_size, frag->buf_plugin_data,
+            hg_core_handle->core_handle.info.addr->na_addr,
+            hg_core_handle->core_handle.info.context_id, hg_core_handle->tag,
+            &frag->na_op_id);
+        HG_CHECK_ERROR(na_ret != NA_SUCCESS, error, ret, (hg_return_t) na_ret,
+            "Could not post recv for fragment (%s)",
+            NA_Error_to_string(na_ret));
+    }
+
+done:
+    return ret;
+
+error:
+    hg_core_handle->recv_frag_count = i;
+    if (i == 0)
+        return ret; /* Nothing was posted */
+
+    /* Account for fragments that were not posted */
+    hg_core_handle->ret = ret;
+    for (; i < count; i++) {
+        if (hg_core_atomic_decr32(HG_CORE_HANDLE_CLASS(hg_core_handle),
+                &hg_core_handle->frag_recv_pending) == 0)
+            return done_callback(handle);
+    }
+
+    return HG_SUCCESS;
+}
+
 /*---------------------------------------------------------------------------*/
 hg_return_t
 HG_Core_progress(hg_core_context_t *context, unsigned int timeout)
@@ -231,6 +231,38 @@ HG_Core_class_get_input_eager_size(const hg_core_class_t *hg_core_class);
 static HG_INLINE hg_size_t
 HG_Core_class_get_output_eager_size(const hg_core_class_t *hg_core_class);
 
+/**
+ * Set the maximum size of extra payload that is sent as a series of expected
+ * messages (fragments) instead of being pulled by the target through a bulk
+ * transfer. Fragments save the bulk registration and transfer, as well as the
+ * ack message on output, but cost one message per output eager size. Setting
+ * the threshold to 0 disables fragmentation. Both origin and target must agree
+ * on the threshold, it should therefore be set before any RPC is issued.
+ * Fragmentation is enabled by default for plugins that support early
+ * expected messages (see NA_Msg_has_early_expected()), HG_OPNOTSUPPORTED is
+ * returned when enabling it for other plugins. Peers must use the same
+ * expected message size (mismatching fragment sizes are reported as
+ * HG_PROTOCOL_ERROR).
+ *
+ * \param hg_core_class [IN]    pointer to HG core class
+ * \param threshold [IN]        threshold size
+ *
+ * \return HG_SUCCESS, HG_OPNOTSUPPORTED or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+HG_Core_class_set_frag_threshold(
+    hg_core_class_t *hg_core_class, hg_size_t threshold);
+
+/**
+ * Get the maximum size of extra payload that is sent as fragments.
+ *
+ * \param hg_core_class [IN]    pointer to HG core class
+ *
+ * \return the threshold size, or 0 if fragmentation is disabled
+ */
+HG_PUBLIC hg_size_t
+HG_Core_class_get_frag_threshold(const hg_core_class_t *hg_core_class);
+
 /**
  * Associate user data to class. When HG_Core_finalize() is called,
  * free_callback (if defined) is called to free the associated data.
@@ -388,6 +420,35 @@ HG_PUBLIC hg_return_t
 HG_Core_context_post(
     hg_core_context_t *context, unsigned int request_count, hg_bool_t repost);
 
+/**
+ * Retrieve progress loop accounting of context: number of times each phase
+ * of HG_Core_progress() / HG_Core_trigger() was entered and time spent in it.
+ * Idle time is the sum of the HG_PROGRESS_PHASE_POLL_WAIT and
+ * HG_PROGRESS_PHASE_TRIGGER_WAIT phases. Accounting is only available when
+ * mercury is built with stats support and the class was initialized with
+ * hg_init_info.stats set.
+ *
+ * \param context [IN]          pointer to HG core context
+ * \param stats [OUT]           pointer to progress stats
+ *
+ * \return HG_SUCCESS or corresponding HG error code (HG_OPNOTSUPPORTED if
+ * accounting is not enabled)
+ */
+HG_PUBLIC hg_return_t
+HG_Core_context_get_progress_stats(
+    hg_core_context_t *context, struct hg_progress_stats *stats);
+
+/**
+ * Reset progress loop accounting of context.
+ *
+ * \param context [IN]          pointer to HG core context
+ *
+ * \return HG_SUCCESS or corresponding HG error code (HG_OPNOTSUPPORTED if
+ * accounting is not enabled)
+ */
+HG_PUBLIC hg_return_t
+HG_Core_context_reset_progress_stats(hg_core_context_t *context);
+
 /**
  * Dynamically register an RPC ID as well as the RPC callback executed
  * when the RPC request ID is received.
@@ -762,6 +823,18 @@ static HG_INLINE hg_return_t
 HG_Core_get_output(
     hg_core_handle_t handle, void **out_buf, hg_size_t *out_buf_size);
 
+/**
+ * Get the size of the payload carried by each fragment (see
+ * HG_Core_set_frag()). Fragments are only reassembled correctly if origin and
+ * target use the same fragment size.
+ *
+ * \param handle [IN]           HG handle
+ *
+ * \return the fragment size
+ */
+static HG_INLINE hg_size_t
+HG_Core_get_frag_size(hg_core_handle_t handle);
+
 /**
  * Forward a call using an existing HG handle. Input and output buffers can be
  * queried from the handle to serialize/deserialize parameters.
@@ -782,6 +855,27 @@ HG_PUBLIC hg_return_t
 HG_Core_forward(hg_core_handle_t handle, hg_core_cb_t callback, void *arg,
     hg_uint8_t flags, hg_size_t payload_size);
 
+/**
+ * Forward a call using an existing HG handle, see HG_Core_forward(). If the
+ * operation has not completed within timeout, it is canceled by the progress
+ * of the handle's context and the user callback is passed HG_TIMEOUT.
+ * Deadlines are kept in a timer wheel so that arming, disarming and expiring
+ * them costs O(1) regardless of the number of forwards in flight. Progress
+ * does not block past the next deadline. Timed forwards to self are not
+ * supported.
+ *
+ * \param handle [IN]           HG handle
+ * \param callback [IN]         pointer to function callback
+ * \param arg [IN]              pointer to data passed to callback
+ * \param payload_size [IN]     size of payload to send
+ * \param timeout [IN]          timeout (in milliseconds, 0 if none)
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+HG_Core_forward_timed(hg_core_handle_t handle, hg_core_cb_t callback,
+    void *arg, hg_uint8_t flags, hg_size_t payload_size, unsigned int timeout);
+
 /**
  * Respond back to the origin. The output buffer, which can be used to encode
  * the response, must first be queried using HG_Core_get_output().
@@ -799,6 +893,54 @@ HG_PUBLIC hg_return_t
 HG_Core_respond(hg_core_handle_t handle, hg_core_cb_t callback, void *arg,
     hg_uint8_t flags, hg_size_t payload_size);
 
+/**
+ * Get the core protocol version used by the exchange that the handle is part
+ * of. On the origin this is the protocol used to encode the request, on the
+ * target the protocol of the request received. Upper layers can use it to
+ * keep their payload format compatible with older peers.
+ *
+ * \param handle [IN]           HG handle
+ *
+ * \return protocol version or 0 if any error has occurred
+ */
+HG_PUBLIC hg_uint8_t
+HG_Core_get_protocol(hg_core_handle_t handle);
+
+/**
+ * Register extra payload that must be sent as fragments along with the next
+ * HG_Core_forward() or HG_Core_respond() call (HG_CORE_MORE_DATA must also be
+ * passed). Fragments are sent as expected messages that use the same tag as
+ * the request. The buffer must remain valid until the operation completes.
+ * Fragments are posted once the request / response itself is on its way: if
+ * posting them fails, HG_Core_forward() / HG_Core_respond() still return
+ * HG_SUCCESS and the error is reported to the user callback, which is only
+ * called once all the fragments that were posted have completed.
+ *
+ * \param handle [IN]           HG handle
+ * \param buf [IN]              pointer to payload
+ * \param buf_size [IN]         payload size
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+HG_Core_set_frag(hg_core_handle_t handle, const void *buf, hg_size_t buf_size);
+
+/**
+ * Receive extra payload that was sent as fragments by the remote peer, must
+ * be called from the more data acquire callback. done_callback is called once
+ * all the fragments have been received into buf.
+ *
+ * \param handle [IN]           HG handle
+ * \param buf [IN]              pointer to destination buffer
+ * \param buf_size [IN]         payload size
+ * \param done_callback [IN]    done callback passed to acquire callback
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+HG_Core_recv_frag(hg_core_handle_t handle, void *buf, hg_size_t buf_size,
+    hg_return_t (*done_callback)(hg_core_handle_t));
+
 /**
  * Try to progress RPC execution for at most timeout until timeout is reached or
  * any completion has occurred.
@@ -1116,6 +1258,14 @@ HG_Core_get_output(
     return HG_SUCCESS;
 }
 
+/*---------------------------------------------------------------------------*/
+static HG_INLINE hg_size_t
+HG_Core_get_frag_size(hg_core_handle_t handle)
+{
+    /* Fragments are expected messages that only carry the NA header */
+    return handle->out_buf_size - handle->na_out_header_offset;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -20,8 +20,12 @@
 #else
 #    include <arpa/inet.h>
 #endif
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
+#if defined(HG_HAS_CHECKSUMS) && defined(__ARM_FEATURE_CRC32)
+#    include <arm_acle.h>
+#endif
 
 /****************/
 /* Local Macros */
@@ -49,6 +53,35 @@
 #define hg_core_header_proc_hg_int8_t_dec(x)                                   \
     (hg_int8_t) hg_core_header_proc_hg_uint8_t_dec((hg_uint8_t) x)
 
+/* Compact header fields are little-endian */
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#    define hg_core_header_le16(x) __builtin_bswap16(x)
+#    define hg_core_header_le32(x) __builtin_bswap32(x)
+#    define hg_core_header_le64(x) __builtin_bswap64(x)
+#else
+#    define hg_core_header_le16(x) (x)
+#    define hg_core_header_le32(x) (x)
+#    define hg_core_header_le64(x) (x)
+#    define HG_CORE_HEADER_LITTLE_ENDIAN
+#endif
+
+/* CRC32C (Castagnoli) implementation used by compact headers */
+#ifdef HG_HAS_CHECKSUMS
+#    define HG_CORE_HEADER_CRC32C_POLY 0x82F63B78U
+#    if defined(__SSE4_2__)
+#        define HG_CORE_HEADER_CRC32C_X86
+#    elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#        define HG_CORE_HEADER_CRC32C_X86
+#        define HG_CORE_HEADER_CRC32C_X86_DISPATCH
+#        define HG_CORE_HEADER_CRC32C_X86_ATTR __attribute__((target("sse4.2")))
+#    elif defined(__ARM_FEATURE_CRC32) && defined(HG_CORE_HEADER_LITTLE_ENDIAN)
+#        define HG_CORE_HEADER_CRC32C_ARM
+#    endif
+#    ifndef HG_CORE_HEADER_CRC32C_X86_ATTR
+#        define HG_CORE_HEADER_CRC32C_X86_ATTR
+#    endif
+#endif
+
 /* Update checksum */
 #ifdef HG_HAS_CHECKSUMS
 #    define HG_CORE_HEADER_CHECKSUM_UPDATE(hg_header, data, type)              \
@@ -82,16 +115,132 @@
 /* Local Type and Struct Definition */
 /************************************/
 
+/* Wire layout of compact headers, same size as the NBO headers */
+#if defined(__GNUC__) || defined(_WIN32)
+#    pragma pack(push, 1)
+#endif
+struct hg_core_header_request_compact {
+    hg_uint8_t hg;       /* Mercury identifier */
+    hg_uint8_t protocol; /* Version number */
+    hg_uint8_t flags;    /* Flags */
+    hg_uint8_t cookie;   /* Cookie */
+    hg_uint64_t id;      /* RPC request identifier */
+#ifdef HG_HAS_CHECKSUMS
+    hg_uint32_t crc32c; /* CRC32C of preceding fields */
+#endif
+};
+
+struct hg_core_header_response_compact {
+    hg_int8_t ret_code; /* Return code */
+    hg_uint8_t flags;   /* Flags */
+    hg_uint16_t cookie; /* Cookie */
+#ifdef HG_HAS_CHECKSUMS
+    hg_uint32_t crc32c; /* CRC32C of preceding fields */
+#endif
+};
+#if defined(__GNUC__) || defined(_WIN32)
+#    pragma pack(pop)
+#endif
+
 /********************/
 /* Local Prototypes */
 /********************/
 extern const char *
 HG_Error_to_string(hg_return_t errnum);
 
+/**
+ * Proc request header in network byte order (HG_CORE_PROTOCOL_VERSION_NBO).
+ */
+static hg_return_t
+hg_core_header_request_proc_nbo(
+    hg_proc_op_t op, void *buf, struct hg_core_header *hg_core_header);
+
+/**
+ * Proc compact request header (HG_CORE_PROTOCOL_VERSION).
+ */
+static hg_return_t
+hg_core_header_request_proc_compact(
+    hg_proc_op_t op, void *buf, struct hg_core_header *hg_core_header);
+
+/**
+ * Proc response header in network byte order (HG_CORE_PROTOCOL_VERSION_NBO).
+ */
+static hg_return_t
+hg_core_header_response_proc_nbo(
+    hg_proc_op_t op, void *buf, struct hg_core_header *hg_core_header);
+
+/**
+ * Proc compact response header (HG_CORE_PROTOCOL_VERSION).
+ */
+static hg_return_t
+hg_core_header_response_proc_compact(
+    hg_proc_op_t op, void *buf, struct hg_core_header *hg_core_header);
+
 /*******************/
 /* Local Variables */
 /*******************/
 
+#ifdef HG_HAS_CHECKSUMS
+#    ifdef HG_CORE_HEADER_CRC32C_X86
+/*---------------------------------------------------------------------------*/
+static HG_CORE_HEADER_CRC32C_X86_ATTR hg_uint32_t
+hg_core_header_crc32c_x86(const unsigned char *buf, size_t len)
+{
+    unsigned int crc = 0xFFFFFFFFU;
+
+    for (; len >= sizeof(unsigned int); len -= sizeof(unsigned int)) {
+        unsigned int val;
+
+        memcpy(&val, buf, sizeof(unsigned int));
+        crc = __builtin_ia32_crc32si(crc, val);
+        buf += sizeof(unsigned int);
+    }
+    while (len--)
+        crc = __builtin_ia32_crc32qi(crc, *buf++);
+
+    return (hg_uint32_t) ~crc;
+}
+#    endif
+
+/*---------------------------------------------------------------------------*/
+hg_uint32_t
+hg_core_header_crc32c(const void *buf, size_t len)
+{
+    const unsigned char *ptr = (const unsigned char *) buf;
+    hg_uint32_t crc = 0xFFFFFFFFU;
+
+#    if defined(HG_CORE_HEADER_CRC32C_X86_DISPATCH)
+    if (__builtin_cpu_supports("sse4.2"))
+        return hg_core_header_crc32c_x86(ptr, len);
+#    elif defined(HG_CORE_HEADER_CRC32C_X86)
+    return hg_core_header_crc32c_x86(ptr, len);
+#    elif defined(HG_CORE_HEADER_CRC32C_ARM)
+    for (; len >= sizeof(hg_uint32_t); len -= sizeof(hg_uint32_t)) {
+        hg_uint32_t val;
+
+        memcpy(&val, ptr, sizeof(hg_uint32_t));
+        crc = __crc32cw(crc, val);
+        ptr += sizeof(hg_uint32_t);
+    }
+    while (len--)
+        crc = __crc32cb(crc, *ptr++);
+
+    return ~crc;
+#    endif
+
+    /* Bitwise fallback, headers are only a few bytes long */
+    while (len--) {
+        int i;
+
+        crc ^= *ptr++;
+        for (i = 0; i < 8; i++)
+            crc = (crc >> 1) ^ (HG_CORE_HEADER_CRC32C_POLY & (0U - (crc & 1U)));
+    }
+
+    return ~crc;
+}
+#endif
+
 /*---------------------------------------------------------------------------*/
 void
 hg_core_header_request_init(struct hg_core_header *hg_core_header)
@@ -157,6 +306,7 @@ hg_core_header_response_reset(struct hg_core_header *hg_core_header)
 {
     memset(&hg_core_header->msg.response, 0,
         sizeof(struct hg_core_header_response));
+    hg_core_header->protocol = HG_CORE_PROTOCOL_VERSION;
 #ifdef HG_HAS_CHECKSUMS
     mchecksum_reset(hg_core_header->checksum);
 #endif
@@ -167,13 +317,36 @@ hg_return_t
 hg_core_header_request_proc(hg_proc_op_t op, void *buf, size_t buf_size,
     struct hg_core_header *hg_core_header)
 {
-    void *buf_ptr = buf;
-    struct hg_core_header_request *header = &hg_core_header->msg.request;
+    hg_uint8_t protocol;
     hg_return_t ret = HG_SUCCESS;
 
     HG_CHECK_ERROR(buf_size < sizeof(struct hg_core_header_request), done, ret,
         HG_INVALID_ARG, "Invalid buffer size");
 
+    /* Protocol byte is at the same offset in all header versions */
+    protocol = (op == HG_DECODE)
+                   ? ((const hg_uint8_t *) buf)[1]
+                   : hg_core_header->msg.request.protocol;
+
+    /* Unknown versions are decoded as NBO and rejected by verify */
+    if (protocol == HG_CORE_PROTOCOL_VERSION)
+        ret = hg_core_header_request_proc_compact(op, buf, hg_core_header);
+    else
+        ret = hg_core_header_request_proc_nbo(op, buf, hg_core_header);
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_core_header_request_proc_nbo(
+    hg_proc_op_t op, void *buf, struct hg_core_header *hg_core_header)
+{
+    void *buf_ptr = buf;
+    struct hg_core_header_request *header = &hg_core_header->msg.request;
+    hg_return_t ret = HG_SUCCESS;
+
 #ifdef HG_HAS_CHECKSUMS
     /* Reset header checksum first */
     mchecksum_reset(hg_core_header->checksum);
@@ -211,9 +384,54 @@ hg_core_header_request_proc(hg_proc_op_t op, void *buf, size_t buf_size,
             HG_CHECKSUM_ERROR,
             "checksum 0x%04X does not match (expected 0x%04X!)");
     }
+
+done:
+#endif
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_core_header_request_proc_compact(
+    hg_proc_op_t op, void *buf, struct hg_core_header *hg_core_header)
+{
+    struct hg_core_header_request *header = &hg_core_header->msg.request;
+    struct hg_core_header_request_compact wire;
+    hg_return_t ret = HG_SUCCESS;
+
+    if (op == HG_ENCODE) {
+        wire.hg = header->hg;
+        wire.protocol = header->protocol;
+        wire.flags = header->flags;
+        wire.cookie = header->cookie;
+        wire.id = hg_core_header_le64(header->id);
+#ifdef HG_HAS_CHECKSUMS
+        header->hash.crc32c = hg_core_header_crc32c(
+            &wire, offsetof(struct hg_core_header_request_compact, crc32c));
+        wire.crc32c = hg_core_header_le32(header->hash.crc32c);
 #endif
+        memcpy(buf, &wire, sizeof(wire));
+    } else { /* HG_DECODE */
+        memcpy(&wire, buf, sizeof(wire));
+        header->hg = wire.hg;
+        header->protocol = wire.protocol;
+        header->flags = wire.flags;
+        header->cookie = wire.cookie;
+        header->id = hg_core_header_le64(wire.id);
+#ifdef HG_HAS_CHECKSUMS
+        header->hash.crc32c = hg_core_header_crc32c(
+            &wire, offsetof(struct hg_core_header_request_compact, crc32c));
+        HG_CHECK_ERROR(
+            header->hash.crc32c != hg_core_header_le32(wire.crc32c), done, ret,
+            HG_CHECKSUM_ERROR,
+            "checksum 0x%08X does not match (expected 0x%08X!)",
+            hg_core_header_le32(wire.crc32c), header->hash.crc32c);
+#endif
+    }
 
+#ifdef HG_HAS_CHECKSUMS
 done:
+#endif
     return ret;
 }
 
@@ -222,13 +440,29 @@ hg_return_t
 hg_core_header_response_proc(hg_proc_op_t op, void *buf, size_t buf_size,
     struct hg_core_header *hg_core_header)
 {
-    void *buf_ptr = buf;
-    struct hg_core_header_response *header = &hg_core_header->msg.response;
     hg_return_t ret = HG_SUCCESS;
 
     HG_CHECK_ERROR(buf_size < sizeof(struct hg_core_header_response), done, ret,
         HG_OVERFLOW, "Invalid buffer size");
 
+    if (hg_core_header->protocol == HG_CORE_PROTOCOL_VERSION)
+        ret = hg_core_header_response_proc_compact(op, buf, hg_core_header);
+    else
+        ret = hg_core_header_response_proc_nbo(op, buf, hg_core_header);
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_core_header_response_proc_nbo(
+    hg_proc_op_t op, void *buf, struct hg_core_header *hg_core_header)
+{
+    void *buf_ptr = buf;
+    struct hg_core_header_response *header = &hg_core_header->msg.response;
+    hg_return_t ret = HG_SUCCESS;
+
 #ifdef HG_HAS_CHECKSUMS
     /* Reset header checksum first */
     mchecksum_reset(hg_core_header->checksum);
@@ -260,9 +494,50 @@ hg_core_header_response_proc(hg_proc_op_t op, void *buf, size_t buf_size,
             HG_CHECKSUM_ERROR,
             "checksum 0x%04X does not match (expected 0x%04X!)");
     }
+
+done:
 #endif
+    return ret;
+}
 
+/*---------------------------------------------------------------------------*/
+static hg_return_t
+hg_core_header_response_proc_compact(
+    hg_proc_op_t op, void *buf, struct hg_core_header *hg_core_header)
+{
+    struct hg_core_header_response *header = &hg_core_header->msg.response;
+    struct hg_core_header_response_compact wire;
+    hg_return_t ret = HG_SUCCESS;
+
+    if (op == HG_ENCODE) {
+        wire.ret_code = header->ret_code;
+        wire.flags = header->flags;
+        wire.cookie = hg_core_header_le16(header->cookie);
+#ifdef HG_HAS_CHECKSUMS
+        header->hash.crc32c = hg_core_header_crc32c(
+            &wire, offsetof(struct hg_core_header_response_compact, crc32c));
+        wire.crc32c = hg_core_header_le32(header->hash.crc32c);
+#endif
+        memcpy(buf, &wire, sizeof(wire));
+    } else { /* HG_DECODE */
+        memcpy(&wire, buf, sizeof(wire));
+        header->ret_code = wire.ret_code;
+        header->flags = wire.flags;
+        header->cookie = hg_core_header_le16(wire.cookie);
+#ifdef HG_HAS_CHECKSUMS
+        header->hash.crc32c = hg_core_header_crc32c(
+            &wire, offsetof(struct hg_core_header_response_compact, crc32c));
+        HG_CHECK_ERROR(
+            header->hash.crc32c != hg_core_header_le32(wire.crc32c), done, ret,
+            HG_CHECKSUM_ERROR,
+            "checksum 0x%08X does not match (expected 0x%08X!)",
+            hg_core_header_le32(wire.crc32c), header->hash.crc32c);
+#endif
+    }
+
+#ifdef HG_HAS_CHECKSUMS
 done:
+#endif
     return ret;
 }
 
@@ -278,8 +553,11 @@ hg_core_header_request_verify(const struct hg_core_header *hg_core_header)
         (((header->hg >> 1) & 'H') != 'H') || (((header->hg) & 'G') != 'G'),
         done, ret, HG_PROTOCOL_ERROR, "Invalid HG byte");
 
-    HG_CHECK_ERROR(header->protocol != HG_CORE_PROTOCOL_VERSION, done, ret,
-        HG_PROTONOSUPPORT, "Invalid protocol version");
+    HG_CHECK_ERROR(header->protocol != HG_CORE_PROTOCOL_VERSION &&
+                       (header->protocol < HG_CORE_PROTOCOL_VERSION_NBO_MIN ||
+                           header->protocol > HG_CORE_PROTOCOL_VERSION_NBO),
+        done, ret, HG_PROTONOSUPPORT, "Invalid protocol version (0x%02X)",
+        header->protocol);
 
 done:
     return ret;
@@ -26,7 +26,7 @@
 #ifdef HG_HAS_CHECKSUMS
 union hg_core_header_hash {
     hg_uint16_t header; /* Header checksum (16-bits checksum) */
-    hg_uint32_t pad;
+    hg_uint32_t crc32c; /* Compact header checksum (32-bits CRC32C) */
 };
 #endif
 
@@ -65,6 +65,7 @@ struct hg_core_header {
 #ifdef HG_HAS_CHECKSUMS
     void *checksum; /* Checksum of header */
 #endif
+    hg_uint8_t protocol; /* Response protocol (follows request protocol) */
 };
 
 /*
@@ -74,11 +75,21 @@ struct hg_core_header {
  * |______________|__________________________|
  *
  *
- * Request:
+ * Request (HG_CORE_PROTOCOL_VERSION_NBO, network byte order):
  * mercury byte / protocol version number / rpc id / flags / cookie / checksum
  *
- * Response:
- * flags / return code / cookie / checksum
+ * Request (HG_CORE_PROTOCOL_VERSION, little-endian, single CRC32C):
+ * mercury byte / protocol version number / flags / cookie / rpc id / checksum
+ *
+ * Response (same protocol as the request it answers):
+ * return code / flags / cookie / checksum
+ *
+ * The mercury byte and the protocol version are always the first two bytes,
+ * receivers use them to select the decoder. Responses follow the protocol of
+ * the request so that older peers keep working. HG_CORE_PROTOCOL_VERSION also
+ * implies the overflow descriptor of the HG layer that carries the payload
+ * size and the HG_CORE_MORE_DATA_FRAG mode, older protocols only carry the
+ * extra bulk handle.
  */
 
 /*****************/
@@ -88,16 +99,23 @@ struct hg_core_header {
 /* Mercury identifier for packets sent */
 #define HG_CORE_IDENTIFIER (('H' << 1) | ('G')) /* 0xD7 */
 
-/* Mercury protocol version number */
-#define HG_CORE_PROTOCOL_VERSION 0x04
+/* Mercury protocol version numbers */
+#define HG_CORE_PROTOCOL_VERSION     0x06 /* Compact little-endian header */
+#define HG_CORE_PROTOCOL_VERSION_NBO 0x05 /* Network byte order header */
+/* Oldest NBO version accepted on receive, 0x04 shares the 0x05 layout */
+#define HG_CORE_PROTOCOL_VERSION_NBO_MIN 0x04
 
 /* Flags */
-#define HG_CORE_SELF_FORWARD 0x80 /* Forward to self */
+#define HG_CORE_MORE_DATA_FRAG 0x40 /* More data sent as expected fragments */
+#define HG_CORE_SELF_FORWARD   0x80 /* Forward to self */
 
 /*********************/
 /* Public Prototypes */
 /*********************/
 
+/* Header routines are internal to the library, they are exported so that
+ * header encoding can be tested without going through the network. */
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -135,7 +153,7 @@ hg_core_header_response_get_size(void)
  * \param hg_core_header [IN/OUT]   pointer to request header structure
  *
  */
-HG_PRIVATE void
+HG_PUBLIC void
 hg_core_header_request_init(struct hg_core_header *hg_core_header);
 
 /**
@@ -144,7 +162,7 @@ hg_core_header_request_init(struct hg_core_header *hg_core_header);
  * \param hg_core_header [IN/OUT]   pointer to response header structure
  *
  */
-HG_PRIVATE void
+HG_PUBLIC void
 hg_core_header_response_init(struct hg_core_header *hg_core_header);
 
 /**
@@ -153,7 +171,7 @@ hg_core_header_response_init(struct hg_core_header *hg_core_header);
  * \param hg_core_header [IN/OUT]   pointer to request header structure
  *
  */
-HG_PRIVATE void
+HG_PUBLIC void
 hg_core_header_request_finalize(struct hg_core_header *hg_core_header);
 
 /**
@@ -162,7 +180,7 @@ hg_core_header_request_finalize(struct hg_core_header *hg_core_header);
  * \param hg_core_header [IN/OUT]   pointer to response header structure
  *
  */
-HG_PRIVATE void
+HG_PUBLIC void
 hg_core_header_response_finalize(struct hg_core_header *hg_core_header);
 
 /**
@@ -171,7 +189,7 @@ hg_core_header_response_finalize(struct hg_core_header *hg_core_header);
  * \param hg_core_header [IN/OUT]   pointer to request header structure
  *
  */
-HG_PRIVATE void
+HG_PUBLIC void
 hg_core_header_request_reset(struct hg_core_header *hg_core_header);
 
 /**
@@ -180,7 +198,7 @@ hg_core_header_request_reset(struct hg_core_header *hg_core_header);
  * \param hg_core_header [IN/OUT]   pointer to response header structure
  *
  */
-HG_PRIVATE void
+HG_PUBLIC void
 hg_core_header_response_reset(struct hg_core_header *hg_core_header);
 
 /**
@@ -193,12 +211,13 @@ hg_core_header_response_reset(struct hg_core_header *hg_core_header);
  *
  * \return HG_SUCCESS or corresponding HG error code
  */
-HG_PRIVATE hg_return_t
+HG_PUBLIC hg_return_t
 hg_core_header_request_proc(hg_proc_op_t op, void *buf, size_t buf_size,
     struct hg_core_header *hg_core_header);
 
 /**
- * Process private information for sending/receiving response.
+ * Process private information for sending/receiving response. The wire
+ * format is selected by hg_core_header->protocol.
  *
  * \param op [IN]               operation type: HG_ENCODE / HG_DECODE
  * \param buf [IN/OUT]          buffer
@@ -207,7 +226,7 @@ hg_core_header_request_proc(hg_proc_op_t op, void *buf, size_t buf_size,
  *
  * \return HG_SUCCESS or corresponding HG error code
  */
-HG_PRIVATE hg_return_t
+HG_PUBLIC hg_return_t
 hg_core_header_response_proc(hg_proc_op_t op, void *buf, size_t buf_size,
     struct hg_core_header *hg_core_header);
 
@@ -218,7 +237,7 @@ hg_core_header_response_proc(hg_proc_op_t op, void *buf, size_t buf_size,
  *
  * \return HG_SUCCESS or corresponding HG error code
  */
-HG_PRIVATE hg_return_t
+HG_PUBLIC hg_return_t
 hg_core_header_request_verify(const struct hg_core_header *hg_core_header);
 
 /**
@@ -228,9 +247,22 @@ hg_core_header_request_verify(const struct hg_core_header *hg_core_header);
  *
  * \return HG_SUCCESS or corresponding HG error code
  */
-HG_PRIVATE hg_return_t
+HG_PUBLIC hg_return_t
 hg_core_header_response_verify(const struct hg_core_header *hg_core_header);
 
+#ifdef HG_HAS_CHECKSUMS
+/**
+ * Compute CRC32C of buffer, using CRC instructions when available.
+ *
+ * \param buf [IN]              buffer
+ * \param len [IN]              buffer length
+ *
+ * \return CRC32C value
+ */
+HG_PUBLIC hg_uint32_t
+hg_core_header_crc32c(const void *buf, size_t len);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -27,6 +27,7 @@ struct hg_init_info {
     na_class_t *na_class;             /* NA class */
     hg_bool_t auto_sm;                /* Use NA SM plugin with local addrs */
     hg_bool_t stats;                  /* (Debug) Print stats at exit */
+    hg_bool_t single_threaded; /* Class and contexts used by one thread only */
 };
 
 /* Error return codes:
@@ -89,6 +90,25 @@ typedef enum {
                   request */
 } hg_proc_op_t;
 
+/* Progress loop phases (see HG_Core_context_get_progress_stats()) */
+typedef enum hg_progress_phase {
+    HG_PROGRESS_PHASE_PROGRESS,     /*!< total time spent in progress */
+    HG_PROGRESS_PHASE_POLL_WAIT,    /*!< blocking wait for network events */
+    HG_PROGRESS_PHASE_NA_PROGRESS,  /*!< non-blocking NA progress */
+    HG_PROGRESS_PHASE_NA_TRIGGER,   /*!< NA completion callbacks */
+    HG_PROGRESS_PHASE_TRIGGER,      /*!< total time spent in trigger */
+    HG_PROGRESS_PHASE_TRIGGER_WAIT, /*!< blocking wait for completions */
+    HG_PROGRESS_PHASE_CALLBACK,     /*!< user completion callbacks */
+    HG_PROGRESS_PHASE_MAX
+} hg_progress_phase_t;
+
+/* Progress loop accounting */
+struct hg_progress_stats {
+    hg_uint64_t count[HG_PROGRESS_PHASE_MAX]; /* Times each phase was entered */
+    hg_uint64_t ns[HG_PROGRESS_PHASE_MAX];    /* Time spent in each phase */
+    hg_uint64_t elapsed_ns; /* Time since accounting was (re)started */
+};
+
 /*****************/
 /* Public Macros */
 /*****************/
@@ -102,7 +122,7 @@ typedef enum {
 /* HG init info initializer */
 #define HG_INIT_INFO_INITIALIZER                                               \
     {                                                                          \
-        NA_INIT_INFO_INITIALIZER, NULL, HG_FALSE, HG_FALSE                     \
+        NA_INIT_INFO_INITIALIZER, NULL, HG_FALSE, HG_FALSE, HG_FALSE           \
     }
 
 #endif /* MERCURY_CORE_TYPES_H */
@@ -0,0 +1,453 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#ifndef MERCURY_CORO_HPP
+#define MERCURY_CORO_HPP
+
+/*
+ * C++20 coroutine bindings for HG_Forward(), HG_Respond() and
+ * HG_Bulk_transfer(). Awaiting one of these operations suspends the calling
+ * coroutine; it is resumed from the HG callback, i.e. on the thread that
+ * calls HG_Trigger(). No additional thread or queue is involved, ordering
+ * and threading therefore remain those of the regular callback API.
+ *
+ * This header is optional and only usable by C++20 compilers, the C library
+ * itself does not depend on it.
+ */
+
+#include "mercury.h"
+#include "mercury_bulk.h"
+
+#if defined(__cplusplus) && __cplusplus >= 202002L                           \
+    && __has_include(<coroutine>)
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <new>
+
+namespace hg {
+
+/*****************/
+/* Frame pooling */
+/*****************/
+
+namespace detail {
+
+/* Coroutine frames are rounded up to HG_CORO_FRAME_ALIGN and kept on a
+ * per-thread free list for each size class up to HG_CORO_FRAME_MAX, larger
+ * frames go through the global allocator. Frames released on a different
+ * thread (e.g. by the trigger thread) simply populate that thread's list. */
+#ifndef HG_CORO_FRAME_ALIGN
+#define HG_CORO_FRAME_ALIGN 64
+#endif
+#ifndef HG_CORO_FRAME_MAX
+#define HG_CORO_FRAME_MAX 1024
+#endif
+#ifndef HG_CORO_FRAME_CACHE
+#define HG_CORO_FRAME_CACHE 64 /* Max cached frames per size class */
+#endif
+
+class frame_pool {
+public:
+    static void *
+    alloc(std::size_t size)
+    {
+        std::size_t idx = size_class(size);
+        if (idx < nclasses) {
+            bucket &b = local().buckets[idx];
+            if (b.head) {
+                node *n = b.head;
+                b.head = n->next;
+                b.count--;
+                return n;
+            }
+            return ::operator new((idx + 1) * HG_CORO_FRAME_ALIGN);
+        }
+        return ::operator new(size);
+    }
+
+    static void
+    free(void *ptr, std::size_t size) noexcept
+    {
+        std::size_t idx = size_class(size);
+        if (idx < nclasses) {
+            bucket &b = local().buckets[idx];
+            if (b.count < HG_CORO_FRAME_CACHE) {
+                node *n = static_cast<node *>(ptr);
+                n->next = b.head;
+                b.head = n;
+                b.count++;
+                return;
+            }
+        }
+        ::operator delete(ptr);
+    }
+
+private:
+    static constexpr std::size_t nclasses =
+        HG_CORO_FRAME_MAX / HG_CORO_FRAME_ALIGN;
+
+    struct node {
+        node *next;
+    };
+    struct bucket {
+        node *head = nullptr;
+        std::size_t count = 0;
+    };
+    struct cache {
+        bucket buckets[nclasses];
+        ~cache()
+        {
+            for (bucket &b : buckets)
+                while (b.head) {
+                    node *n = b.head;
+                    b.head = n->next;
+                    ::operator delete(n);
+                }
+        }
+    };
+
+    static std::size_t
+    size_class(std::size_t size) noexcept
+    {
+        return (size + HG_CORO_FRAME_ALIGN - 1) / HG_CORO_FRAME_ALIGN - 1;
+    }
+
+    static cache &
+    local() noexcept
+    {
+        static thread_local cache c;
+        return c;
+    }
+};
+
+} /* namespace detail */
+
+/********/
+/* Task */
+/********/
+
+/**
+ * Coroutine return type. The task starts eagerly and runs until its first
+ * suspension point; completion can be polled with done() (see executor).
+ * The returned hg_return_t is available through result() once done.
+ * Destroying a task that is still waiting on an HG operation detaches it:
+ * the coroutine keeps running when the operation completes and its frame is
+ * released once it finishes.
+ */
+class task {
+    enum { running, finished, detached }; /* Promise states */
+
+public:
+    struct promise_type;
+    using handle_t = std::coroutine_handle<promise_type>;
+
+    struct promise_type {
+        hg_return_t ret = HG_SUCCESS;
+        std::exception_ptr exception;
+        std::atomic<int> state{running};
+
+        /* Last of coroutine completion and task destruction frees frame */
+        struct final_awaitable {
+            bool
+            await_ready() const noexcept
+            {
+                return false;
+            }
+            bool
+            await_suspend(handle_t h) const noexcept
+            {
+                /* Not suspending destroys the frame */
+                return h.promise().state.exchange(
+                           finished, std::memory_order_acq_rel) != detached;
+            }
+            void
+            await_resume() const noexcept
+            {
+            }
+        };
+
+        task
+        get_return_object() noexcept
+        {
+            return task{handle_t::from_promise(*this)};
+        }
+        std::suspend_never
+        initial_suspend() noexcept
+        {
+            return {};
+        }
+        final_awaitable
+        final_suspend() noexcept
+        {
+            return {};
+        }
+        void
+        return_value(hg_return_t r) noexcept
+        {
+            ret = r;
+        }
+        void
+        unhandled_exception() noexcept
+        {
+            exception = std::current_exception();
+        }
+
+        static void *
+        operator new(std::size_t size)
+        {
+            return detail::frame_pool::alloc(size);
+        }
+        static void
+        operator delete(void *ptr, std::size_t size) noexcept
+        {
+            detail::frame_pool::free(ptr, size);
+        }
+    };
+
+    task(task &&other) noexcept : h_(other.h_) { other.h_ = nullptr; }
+    task(const task &) = delete;
+    task &operator=(const task &) = delete;
+    ~task()
+    {
+        if (h_ &&
+            h_.promise().state.exchange(detached, std::memory_order_acq_rel) ==
+                finished)
+            h_.destroy();
+    }
+
+    /* Completion may happen on the thread that calls HG_Trigger() */
+    bool
+    done() const noexcept
+    {
+        return !h_ ||
+               h_.promise().state.load(std::memory_order_acquire) == finished;
+    }
+
+    /* Return HG_BUSY if the task has not completed yet */
+    hg_return_t
+    result() const
+    {
+        if (!h_)
+            return HG_INVALID_ARG;
+        if (!done())
+            return HG_BUSY;
+        if (h_.promise().exception)
+            std::rethrow_exception(h_.promise().exception);
+        return h_.promise().ret;
+    }
+
+private:
+    explicit task(handle_t h) noexcept : h_(h) {}
+    handle_t h_;
+};
+
+/**************/
+/* Awaitables */
+/**************/
+
+namespace detail {
+
+/* Common part: the HG callback stores the return code and resumes the
+ * awaiting coroutine in place, from within HG_Trigger(). */
+struct awaitable_base {
+    hg_return_t ret = HG_SUCCESS;
+    std::coroutine_handle<> cont;
+
+    bool
+    await_ready() const noexcept
+    {
+        return false;
+    }
+    hg_return_t
+    await_resume() const noexcept
+    {
+        return ret;
+    }
+
+    static hg_return_t
+    resume_cb(const struct hg_cb_info *callback_info)
+    {
+        awaitable_base *self = static_cast<awaitable_base *>(callback_info->arg);
+        self->ret = callback_info->ret;
+        self->cont.resume();
+        return HG_SUCCESS;
+    }
+
+    /* Posting may complete and resume on another thread before it returns,
+     * do not touch *this once the operation has been successfully posted. */
+    template <typename F>
+    bool
+    post(std::coroutine_handle<> h, F &&f) noexcept
+    {
+        cont = h;
+        hg_return_t r = f();
+        if (r != HG_SUCCESS) {
+            ret = r;
+            return false; /* Resume immediately with error */
+        }
+        return true;
+    }
+};
+
+struct forward_awaitable : awaitable_base {
+    hg_handle_t handle;
+    void *in_struct;
+
+    bool
+    await_suspend(std::coroutine_handle<> h) noexcept
+    {
+        return post(h, [this] {
+            return HG_Forward(handle, resume_cb, this, in_struct);
+        });
+    }
+};
+
+struct respond_awaitable : awaitable_base {
+    hg_handle_t handle;
+    void *out_struct;
+
+    bool
+    await_suspend(std::coroutine_handle<> h) noexcept
+    {
+        return post(h, [this] {
+            return HG_Respond(handle, resume_cb, this, out_struct);
+        });
+    }
+};
+
+struct bulk_awaitable : awaitable_base {
+    hg_context_t *context;
+    hg_bulk_op_t op;
+    hg_addr_t origin_addr;
+    hg_bulk_t origin_handle;
+    hg_size_t origin_offset;
+    hg_bulk_t local_handle;
+    hg_size_t local_offset;
+    hg_size_t size;
+    hg_op_id_t *op_id;
+
+    bool
+    await_suspend(std::coroutine_handle<> h) noexcept
+    {
+        return post(h, [this] {
+            return HG_Bulk_transfer(context, resume_cb, this, op, origin_addr,
+                origin_handle, origin_offset, local_handle, local_offset, size,
+                op_id);
+        });
+    }
+};
+
+} /* namespace detail */
+
+/**
+ * Forward a call, co_await returns the hg_return_t passed to the callback.
+ */
+inline detail::forward_awaitable
+forward(hg_handle_t handle, void *in_struct)
+{
+    detail::forward_awaitable a;
+    a.handle = handle;
+    a.in_struct = in_struct;
+    return a;
+}
+
+/**
+ * Respond to a call, co_await returns the hg_return_t passed to the callback.
+ */
+inline detail::respond_awaitable
+respond(hg_handle_t handle, void *out_struct)
+{
+    detail::respond_awaitable a;
+    a.handle = handle;
+    a.out_struct = out_struct;
+    return a;
+}
+
+/**
+ * Transfer data, co_await returns the hg_return_t passed to the callback.
+ * op_id may be used to cancel the transfer with HG_Bulk_cancel().
+ */
+inline detail::bulk_awaitable
+bulk_transfer(hg_context_t *context, hg_bulk_op_t op, hg_addr_t origin_addr,
+    hg_bulk_t origin_handle, hg_size_t origin_offset, hg_bulk_t local_handle,
+    hg_size_t local_offset, hg_size_t size, hg_op_id_t *op_id = HG_OP_ID_IGNORE)
+{
+    detail::bulk_awaitable a;
+    a.context = context;
+    a.op = op;
+    a.origin_addr = origin_addr;
+    a.origin_handle = origin_handle;
+    a.origin_offset = origin_offset;
+    a.local_handle = local_handle;
+    a.local_offset = local_offset;
+    a.size = size;
+    a.op_id = op_id;
+    return a;
+}
+
+/************/
+/* Executor */
+/************/
+
+/**
+ * Minimal single-threaded executor: drives HG_Progress() / HG_Trigger() on
+ * the given context so that awaiting coroutines get resumed on the calling
+ * thread. Applications that already run their own progress loop do not need
+ * it, coroutines are resumed from whichever thread calls HG_Trigger().
+ */
+class executor {
+public:
+    explicit executor(hg_context_t *context, unsigned int timeout = 100)
+        : context_(context), timeout_(timeout)
+    {
+    }
+
+    /* Make progress and trigger callbacks once */
+    hg_return_t
+    run_once()
+    {
+        unsigned int actual_count = 0;
+        hg_return_t ret;
+
+        do {
+            ret = HG_Trigger(context_, 0, 1, &actual_count);
+        } while (ret == HG_SUCCESS && actual_count);
+
+        ret = HG_Progress(context_, timeout_);
+        if (ret == HG_TIMEOUT)
+            ret = HG_SUCCESS;
+        return ret;
+    }
+
+    /* Run until the task completes and return its result */
+    hg_return_t
+    run(const task &t)
+    {
+        while (!t.done()) {
+            hg_return_t ret = run_once();
+            if (ret != HG_SUCCESS)
+                return ret;
+        }
+        return t.result();
+    }
+
+private:
+    hg_context_t *context_;
+    unsigned int timeout_;
+};
+
+} /* namespace hg */
+
+#endif /* __cplusplus >= 202002L */
+
+#endif /* MERCURY_CORO_HPP */
@@ -11,8 +11,11 @@
 #ifndef MERCURY_PRIVATE_H
 #define MERCURY_PRIVATE_H
 
+#include "mercury_capture.h"
 #include "mercury_core.h"
+#include "mercury_tool.h"
 
+#include "mercury_atomic.h"
 #include "mercury_queue.h"
 
 /*************************************/
@@ -37,4 +40,79 @@ struct hg_completion_entry {
     hg_op_type_t op_type;
 };
 
+/* Request being captured */
+struct hg_capture_entry;
+
+/*****************/
+/* Public Macros */
+/*****************/
+
+/* Notify attached tools of event, costs a single branch if none attached */
+#define HG_TOOL_NOTIFY(event, context, handle, op_id, size, ret)               \
+    do {                                                                       \
+        if (hg_atomic_get32(&hg_tool_event_mask_g) &                           \
+            (hg_util_int32_t) HG_TOOL_EVENT_MASK(event))                       \
+            hg_tool_notify(event, context, handle, op_id, size, ret);          \
+    } while (0)
+
+/* Capture is active (see HG_Capture_start()) */
+#define HG_CAPTURE_ENABLED() hg_atomic_get32(&hg_capture_enabled_g)
+
+/********************/
+/* Public Variables */
+/********************/
+
+/* Mask of events that at least one tool is attached to */
+extern HG_PRIVATE hg_atomic_int32_t hg_tool_event_mask_g;
+
+/* Capture is active */
+extern HG_PRIVATE hg_atomic_int32_t hg_capture_enabled_g;
+
+/*********************/
+/* Public Prototypes */
+/*********************/
+
+/**
+ * Invoke tool callbacks attached to event.
+ */
+HG_PRIVATE void
+hg_tool_notify(hg_tool_event_t event, hg_core_context_t *context,
+    hg_core_handle_t handle, const void *op_id, hg_size_t size,
+    hg_return_t ret);
+
+/**
+ * Start capture if HG_CAPTURE_FILE is set (checked once per process).
+ */
+HG_PRIVATE void
+hg_capture_init_env(void);
+
+/**
+ * Start capturing a request, in_buf points to the input that follows the
+ * core header and must remain valid until hg_capture_complete() is called.
+ */
+HG_PRIVATE struct hg_capture_entry *
+hg_capture_request(
+    hg_id_t id, hg_uint32_t flags, const void *in_buf, hg_size_t in_size);
+
+/**
+ * Record size of response payload.
+ */
+HG_PRIVATE void
+hg_capture_respond(
+    struct hg_capture_entry *hg_capture_entry, hg_size_t out_size);
+
+/**
+ * Attribute bulk transfer to the request whose input holds the origin
+ * descriptor desc, if any.
+ */
+HG_PRIVATE void
+hg_capture_bulk(const void *desc, hg_size_t desc_size, hg_size_t bulk_size,
+    hg_size_t size, hg_bulk_op_t op);
+
+/**
+ * Write record of request to log and release it.
+ */
+HG_PRIVATE void
+hg_capture_complete(struct hg_capture_entry *hg_capture_entry);
+
 #endif /* MERCURY_PRIVATE_H */
@@ -16,10 +16,20 @@
 #    include <mchecksum.h>
 #endif
 
+#if defined(__SSSE3__)
+#    include <tmmintrin.h>
+#elif defined(__ARM_NEON)
+#    include <arm_neon.h>
+#endif
+
 /****************/
 /* Local Macros */
 /****************/
 
+/* Byte-order flags used by array proc routines */
+#define HG_PROC_LITTLE_ENDIAN (0)
+#define HG_PROC_BIG_ENDIAN    (1)
+
 /************************************/
 /* Local Type and Struct Definition */
 /************************************/
@@ -28,6 +38,12 @@
 /* Local Prototypes */
 /********************/
 
+/**
+ * Get native byte order.
+ */
+static HG_INLINE hg_uint32_t
+hg_proc_byte_order(void);
+
 /*******************/
 /* Local Variables */
 /*******************/
@@ -144,8 +160,10 @@ hg_proc_free(hg_proc_t proc)
 #endif
 
     /* Free extra proc buffer if needed */
-    if (hg_proc->extra_buf.buf && hg_proc->extra_buf.is_mine)
+    if (hg_proc->extra_buf.buf && hg_proc->extra_buf.is_mine) {
+        hg_mem_usage_sub(HG_MEM_USAGE_PROC_EXTRA, hg_proc->extra_buf.size);
         hg_mem_aligned_free(hg_proc->extra_buf.buf);
+    }
 
     /* Free proc */
     free(hg_proc);
@@ -194,8 +212,10 @@ hg_proc_reset(hg_proc_t proc, void *buf, hg_size_t buf_size, hg_proc_op_t op)
     hg_proc->proc_buf.size_left = hg_proc->proc_buf.size;
 
     /* Free extra proc buffer if needed */
-    if (hg_proc->extra_buf.buf && hg_proc->extra_buf.is_mine)
+    if (hg_proc->extra_buf.buf && hg_proc->extra_buf.is_mine) {
+        hg_mem_usage_sub(HG_MEM_USAGE_PROC_EXTRA, hg_proc->extra_buf.size);
         hg_mem_aligned_free(hg_proc->extra_buf.buf);
+    }
     hg_proc->extra_buf.buf = NULL;
     hg_proc->extra_buf.size = 0;
     hg_proc->extra_buf.buf_ptr = hg_proc->extra_buf.buf;
@@ -251,6 +271,8 @@ hg_proc_set_size(hg_proc_t proc, hg_size_t req_buf_size)
         new_buf = realloc(hg_proc->extra_buf.buf, new_buf_size);
     HG_CHECK_ERROR(new_buf == NULL, error, ret, HG_NOMEM,
         "Could not allocate buffer of size %zu", new_buf_size);
+    if (!allocated && hg_proc->extra_buf.is_mine)
+        hg_mem_usage_sub(HG_MEM_USAGE_PROC_EXTRA, hg_proc->extra_buf.size);
 
     if (!hg_proc->extra_buf.buf) {
         /* Copy proc_buf (should be small) */
@@ -266,6 +288,7 @@ hg_proc_set_size(hg_proc_t proc, hg_size_t req_buf_size)
     hg_proc->extra_buf.size_left =
         hg_proc->extra_buf.size - (hg_size_t) current_pos;
     hg_proc->extra_buf.is_mine = HG_TRUE;
+    hg_mem_usage_add(HG_MEM_USAGE_PROC_EXTRA, new_buf_size);
 
     return ret;
 
@@ -339,6 +362,11 @@ hg_proc_set_extra_buf_is_mine(hg_proc_t proc, hg_bool_t theirs)
     HG_CHECK_ERROR(hg_proc->extra_buf.buf == NULL, done, ret, HG_INVALID_ARG,
         "Extra buf is not set");
 
+    /* Buffers handed over to the caller are no longer accounted here */
+    if (hg_proc->extra_buf.is_mine && theirs)
+        hg_mem_usage_sub(HG_MEM_USAGE_PROC_EXTRA, hg_proc->extra_buf.size);
+    else if (!hg_proc->extra_buf.is_mine && !theirs)
+        hg_mem_usage_add(HG_MEM_USAGE_PROC_EXTRA, hg_proc->extra_buf.size);
     hg_proc->extra_buf.is_mine = (hg_bool_t)(!theirs);
 
 done:
@@ -369,6 +397,154 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+static HG_INLINE hg_uint32_t
+hg_proc_byte_order(void)
+{
+    const union {
+        hg_uint32_t i;
+        char c[4];
+    } u = {1};
+
+    return (u.c[0] == 1) ? HG_PROC_LITTLE_ENDIAN : HG_PROC_BIG_ENDIAN;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+hg_proc_array(hg_proc_t proc, void *data, hg_size_t count, hg_size_t elem_size)
+{
+    hg_uint32_t byte_order = hg_proc_byte_order();
+    hg_size_t data_size = count * elem_size;
+    void *buf_ptr;
+    hg_return_t ret = HG_SUCCESS;
+
+    HG_CHECK_ERROR(proc == HG_PROC_NULL, done, ret, HG_INVALID_ARG,
+        "Proc is not initialized");
+    HG_CHECK_ERROR(elem_size != 1 && elem_size != 2 && elem_size != 4 &&
+                       elem_size != 8,
+        done, ret, HG_INVALID_ARG, "Unsupported element size (%zu)",
+        (size_t) elem_size);
+
+    /* Do nothing in HG_FREE for basic types */
+    if (hg_proc_get_op(proc) == HG_FREE)
+        goto done;
+
+    /* Byte-order flag (uses XDR if enabled so that positions stay aligned) */
+    ret = hg_proc_hg_uint32_t(proc, &byte_order);
+    HG_CHECK_HG_ERROR(done, ret, "Could not proc byte order");
+
+    if (data_size == 0)
+        goto done;
+
+    /* Array is copied as is, bypassing per-element encoding */
+    buf_ptr = hg_proc_save_ptr(proc, data_size);
+    HG_CHECK_ERROR(buf_ptr == NULL, done, ret, HG_OVERFLOW,
+        "Could not get pointer to array");
+
+    if (hg_proc_get_op(proc) == HG_ENCODE)
+        memcpy(buf_ptr, data, data_size);
+    else
+        memcpy(data, buf_ptr, data_size);
+
+    /* Checksum is computed on the wire representation */
+    ret = hg_proc_restore_ptr(proc, buf_ptr, data_size);
+    HG_CHECK_HG_ERROR(done, ret, "Could not restore ptr");
+
+    /* Convert in a single pass if sender had a different byte order */
+    if (hg_proc_get_op(proc) == HG_DECODE && elem_size > 1 &&
+        byte_order != hg_proc_byte_order())
+        hg_proc_byte_swap(data, count, elem_size);
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_proc_byte_swap(void *data, hg_size_t count, hg_size_t elem_size)
+{
+    unsigned char *ptr = (unsigned char *) data;
+    hg_size_t i = 0;
+
+#if defined(__SSSE3__)
+    const __m128i mask16 =
+        _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+    const __m128i mask32 =
+        _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    const __m128i mask64 =
+        _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+    const __m128i *mask = (elem_size == 2)
+                              ? &mask16
+                              : (elem_size == 4) ? &mask32 : &mask64;
+    hg_size_t nvec = (count * elem_size) / 16;
+
+    if (elem_size > 1) {
+        hg_size_t j;
+
+        for (j = 0; j < nvec; j++, ptr += 16) {
+            __m128i v = _mm_loadu_si128((const __m128i *) ptr);
+            _mm_storeu_si128((__m128i *) ptr, _mm_shuffle_epi8(v, *mask));
+        }
+        i = nvec * (16 / elem_size);
+    }
+#elif defined(__ARM_NEON)
+    hg_size_t nvec = (count * elem_size) / 16;
+
+    if (elem_size > 1) {
+        hg_size_t j;
+
+        for (j = 0; j < nvec; j++, ptr += 16) {
+            uint8x16_t v = vld1q_u8(ptr);
+            if (elem_size == 2)
+                v = vrev16q_u8(v);
+            else if (elem_size == 4)
+                v = vrev32q_u8(v);
+            else
+                v = vrev64q_u8(v);
+            vst1q_u8(ptr, v);
+        }
+        i = nvec * (16 / elem_size);
+    }
+#endif
+
+    /* Remaining elements */
+    switch (elem_size) {
+        case 2:
+            for (; i < count; i++, ptr += 2) {
+                unsigned char t = ptr[0];
+                ptr[0] = ptr[1];
+                ptr[1] = t;
+            }
+            break;
+        case 4:
+            for (; i < count; i++, ptr += 4) {
+                hg_uint32_t v;
+                memcpy(&v, ptr, sizeof(v));
+                v = ((v & 0x000000FFU) << 24) | ((v & 0x0000FF00U) << 8) |
+                    ((v & 0x00FF0000U) >> 8) | ((v & 0xFF000000U) >> 24);
+                memcpy(ptr, &v, sizeof(v));
+            }
+            break;
+        case 8:
+            for (; i < count; i++, ptr += 8) {
+                hg_uint64_t v;
+                memcpy(&v, ptr, sizeof(v));
+                v = ((v & 0x00000000000000FFULL) << 56) |
+                    ((v & 0x000000000000FF00ULL) << 40) |
+                    ((v & 0x0000000000FF0000ULL) << 24) |
+                    ((v & 0x00000000FF000000ULL) << 8) |
+                    ((v & 0x000000FF00000000ULL) >> 8) |
+                    ((v & 0x0000FF0000000000ULL) >> 24) |
+                    ((v & 0x00FF000000000000ULL) >> 40) |
+                    ((v & 0xFF00000000000000ULL) >> 56);
+                memcpy(ptr, &v, sizeof(v));
+            }
+            break;
+        default:
+            break;
+    }
+}
+
 #ifdef HG_HAS_CHECKSUMS
 /*---------------------------------------------------------------------------*/
 void
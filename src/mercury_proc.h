@@ -400,6 +400,36 @@ hg_proc_set_extra_buf_is_mine(hg_proc_t proc, hg_bool_t mine);
 HG_PUBLIC hg_return_t
 hg_proc_flush(hg_proc_t proc);
 
+/**
+ * Generic processing routine for arrays of fixed-size integers. The array is
+ * encoded in the native byte order of the sender, preceded by a byte-order
+ * flag. When decoding, if the flag does not match the local byte order, the
+ * whole array is byte-swapped in a single pass after being copied. This
+ * avoids per-element conversion (including XDR conversion when XDR is
+ * enabled) while still supporting heterogeneous systems.
+ *
+ * \param proc [IN/OUT]         abstract processor object
+ * \param data [IN/OUT]         pointer to array
+ * \param count [IN]            number of elements in array
+ * \param elem_size [IN]        size of one element (1, 2, 4 or 8 bytes)
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+hg_proc_array(
+    hg_proc_t proc, void *data, hg_size_t count, hg_size_t elem_size);
+
+/**
+ * Reverse byte order of each element of an array in place. Uses vector
+ * byte-shuffles when supported by the target.
+ *
+ * \param data [IN/OUT]         pointer to array
+ * \param count [IN]            number of elements in array
+ * \param elem_size [IN]        size of one element (1, 2, 4 or 8 bytes)
+ */
+HG_PUBLIC void
+hg_proc_byte_swap(void *data, hg_size_t count, hg_size_t elem_size);
+
 #ifdef HG_HAS_CHECKSUMS
 /**
  * Retrieve internal proc checksum hash.
@@ -533,6 +563,78 @@ hg_proc_hg_uint64_t(hg_proc_t proc, void *data);
 static HG_INLINE hg_return_t
 hg_proc_bytes(hg_proc_t proc, void *data, hg_size_t data_size);
 
+/**
+ * Array processing routine (see hg_proc_array()).
+ *
+ * \param proc [IN/OUT]         abstract processor object
+ * \param data [IN/OUT]         pointer to array
+ * \param count [IN]            number of elements in array
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+static HG_INLINE hg_return_t
+hg_proc_hg_int16_array(hg_proc_t proc, hg_int16_t *data, hg_size_t count);
+
+/**
+ * Array processing routine (see hg_proc_array()).
+ *
+ * \param proc [IN/OUT]         abstract processor object
+ * \param data [IN/OUT]         pointer to array
+ * \param count [IN]            number of elements in array
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+static HG_INLINE hg_return_t
+hg_proc_hg_uint16_array(hg_proc_t proc, hg_uint16_t *data, hg_size_t count);
+
+/**
+ * Array processing routine (see hg_proc_array()).
+ *
+ * \param proc [IN/OUT]         abstract processor object
+ * \param data [IN/OUT]         pointer to array
+ * \param count [IN]            number of elements in array
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+static HG_INLINE hg_return_t
+hg_proc_hg_int32_array(hg_proc_t proc, hg_int32_t *data, hg_size_t count);
+
+/**
+ * Array processing routine (see hg_proc_array()).
+ *
+ * \param proc [IN/OUT]         abstract processor object
+ * \param data [IN/OUT]         pointer to array
+ * \param count [IN]            number of elements in array
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+static HG_INLINE hg_return_t
+hg_proc_hg_uint32_array(hg_proc_t proc, hg_uint32_t *data, hg_size_t count);
+
+/**
+ * Array processing routine (see hg_proc_array()).
+ *
+ * \param proc [IN/OUT]         abstract processor object
+ * \param data [IN/OUT]         pointer to array
+ * \param count [IN]            number of elements in array
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+static HG_INLINE hg_return_t
+hg_proc_hg_int64_array(hg_proc_t proc, hg_int64_t *data, hg_size_t count);
+
+/**
+ * Array processing routine (see hg_proc_array()).
+ *
+ * \param proc [IN/OUT]         abstract processor object
+ * \param data [IN/OUT]         pointer to array
+ * \param count [IN]            number of elements in array
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+static HG_INLINE hg_return_t
+hg_proc_hg_uint64_array(hg_proc_t proc, hg_uint64_t *data, hg_size_t count);
+
 /**
  * For convenience map stdint types to hg types
  */
@@ -545,6 +647,13 @@ hg_proc_bytes(hg_proc_t proc, void *data, hg_size_t data_size);
 #define hg_proc_int64_t  hg_proc_hg_int64_t
 #define hg_proc_uint64_t hg_proc_hg_uint64_t
 
+#define hg_proc_int16_array  hg_proc_hg_int16_array
+#define hg_proc_uint16_array hg_proc_hg_uint16_array
+#define hg_proc_int32_array  hg_proc_hg_int32_array
+#define hg_proc_uint32_array hg_proc_hg_uint32_array
+#define hg_proc_int64_array  hg_proc_hg_int64_array
+#define hg_proc_uint64_array hg_proc_hg_uint64_array
+
 /* Map mercury common types */
 #define hg_proc_hg_bool_t hg_proc_hg_uint8_t
 #define hg_proc_hg_ptr_t  hg_proc_hg_uint64_t
@@ -759,6 +868,48 @@ done:
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+static HG_INLINE hg_return_t
+hg_proc_hg_int16_array(hg_proc_t proc, hg_int16_t *data, hg_size_t count)
+{
+    return hg_proc_array(proc, data, count, sizeof(hg_int16_t));
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE hg_return_t
+hg_proc_hg_uint16_array(hg_proc_t proc, hg_uint16_t *data, hg_size_t count)
+{
+    return hg_proc_array(proc, data, count, sizeof(hg_uint16_t));
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE hg_return_t
+hg_proc_hg_int32_array(hg_proc_t proc, hg_int32_t *data, hg_size_t count)
+{
+    return hg_proc_array(proc, data, count, sizeof(hg_int32_t));
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE hg_return_t
+hg_proc_hg_uint32_array(hg_proc_t proc, hg_uint32_t *data, hg_size_t count)
+{
+    return hg_proc_array(proc, data, count, sizeof(hg_uint32_t));
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE hg_return_t
+hg_proc_hg_int64_array(hg_proc_t proc, hg_int64_t *data, hg_size_t count)
+{
+    return hg_proc_array(proc, data, count, sizeof(hg_int64_t));
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_INLINE hg_return_t
+hg_proc_hg_uint64_array(hg_proc_t proc, hg_uint64_t *data, hg_size_t count)
+{
+    return hg_proc_array(proc, data, count, sizeof(hg_uint64_t));
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#include "mercury_tool.h"
+#include "mercury_error.h"
+#include "mercury_private.h"
+
+#include "mercury_thread.h"
+#include "mercury_thread_mutex.h"
+#include "mercury_time.h"
+
+/************************************/
+/* Local Type and Struct Definition */
+/************************************/
+
+/* Attached tool */
+struct hg_tool {
+    hg_tool_cb_t callback;    /* Tool callback */
+    void *arg;                /* Callback argument */
+    hg_atomic_int32_t mask;   /* Event mask (0 if slot is free) */
+    hg_atomic_int32_t active; /* Notifications in progress on slot */
+};
+
+/*******************/
+/* Local Variables */
+/*******************/
+
+/* Mask of events that at least one tool is attached to */
+hg_atomic_int32_t hg_tool_event_mask_g = HG_ATOMIC_VAR_INIT(0);
+
+/* Attached tools */
+static struct hg_tool hg_tool_table_g[HG_TOOL_MAX];
+
+/* Protects registration */
+static hg_thread_mutex_t hg_tool_mutex_g = HG_THREAD_MUTEX_INITIALIZER;
+
+/* Event names */
+static const char *const hg_tool_event_names_g[HG_TOOL_EVENT_MAX] = {
+    "HG_TOOL_FORWARD_POSTED", "HG_TOOL_REQUEST_RECEIVED",
+    "HG_TOOL_HANDLER_START", "HG_TOOL_HANDLER_END", "HG_TOOL_RESPOND_POSTED",
+    "HG_TOOL_RESPONSE_RECEIVED", "HG_TOOL_BULK_START", "HG_TOOL_BULK_END",
+    "HG_TOOL_OVERFLOW"};
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_tool_update_mask(void)
+{
+    hg_util_int32_t mask = 0;
+    unsigned int i;
+
+    for (i = 0; i < HG_TOOL_MAX; i++)
+        mask |= hg_atomic_get32(&hg_tool_table_g[i].mask);
+
+    hg_atomic_set32(&hg_tool_event_mask_g, mask);
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_tool_notify(hg_tool_event_t event, hg_core_context_t *context,
+    hg_core_handle_t handle, const void *op_id, hg_size_t size,
+    hg_return_t ret)
+{
+    struct hg_tool_event_info event_info;
+    hg_util_int32_t event_mask = (hg_util_int32_t) HG_TOOL_EVENT_MASK(event);
+    unsigned int i;
+
+    event_info.event = event;
+    event_info.context = context;
+    event_info.handle = handle;
+    event_info.info = (handle) ? HG_Core_get_info(handle) : NULL;
+    event_info.op_id = op_id;
+    event_info.size = size;
+    event_info.time_ns = hg_time_fast_to_ns(hg_time_fast_now());
+    event_info.ret = ret;
+
+    for (i = 0; i < HG_TOOL_MAX; i++) {
+        struct hg_tool *hg_tool = &hg_tool_table_g[i];
+
+        if (!(hg_atomic_get32(&hg_tool->mask) & event_mask))
+            continue;
+
+        /* Deregistration waits for active notifications before the slot can
+         * be reused, mask is checked again once marked active and is set last
+         * on registration, callback and arg are therefore consistent */
+        hg_atomic_incr32(&hg_tool->active);
+        if (hg_atomic_get32(&hg_tool->mask) & event_mask)
+            hg_tool->callback(&event_info, hg_tool->arg);
+        hg_atomic_decr32(&hg_tool->active);
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Tool_register(unsigned int event_mask, hg_tool_cb_t callback, void *arg,
+    hg_tool_id_t *id_p)
+{
+    hg_return_t ret = HG_SUCCESS;
+    unsigned int i;
+
+    HG_CHECK_ERROR(callback == NULL, done, ret, HG_INVALID_ARG,
+        "NULL tool callback");
+    HG_CHECK_ERROR(id_p == NULL, done, ret, HG_INVALID_ARG, "NULL tool ID");
+    HG_CHECK_ERROR(event_mask == 0 || (event_mask & ~HG_TOOL_EVENT_ALL), done,
+        ret, HG_INVALID_ARG, "Invalid event mask (%x)", event_mask);
+
+    hg_thread_mutex_lock(&hg_tool_mutex_g);
+
+    for (i = 0; i < HG_TOOL_MAX; i++)
+        if (hg_atomic_get32(&hg_tool_table_g[i].mask) == 0)
+            break;
+    if (i == HG_TOOL_MAX) {
+        hg_thread_mutex_unlock(&hg_tool_mutex_g);
+        HG_GOTO_ERROR(done, ret, HG_NOMEM, "Cannot attach more than %d tools",
+            HG_TOOL_MAX);
+    }
+
+    hg_tool_table_g[i].callback = callback;
+    hg_tool_table_g[i].arg = arg;
+    hg_atomic_set32(&hg_tool_table_g[i].mask, (hg_util_int32_t) event_mask);
+    hg_tool_update_mask();
+
+    hg_thread_mutex_unlock(&hg_tool_mutex_g);
+
+    *id_p = (hg_tool_id_t) i;
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_return_t
+HG_Tool_deregister(hg_tool_id_t id)
+{
+    hg_return_t ret = HG_SUCCESS;
+
+    HG_CHECK_ERROR(id < 0 || id >= HG_TOOL_MAX, done, ret, HG_INVALID_ARG,
+        "Invalid tool ID (%d)", id);
+
+    hg_thread_mutex_lock(&hg_tool_mutex_g);
+
+    if (hg_atomic_get32(&hg_tool_table_g[id].mask) == 0) {
+        hg_thread_mutex_unlock(&hg_tool_mutex_g);
+        HG_GOTO_ERROR(
+            done, ret, HG_NOENTRY, "Tool ID (%d) is not registered", id);
+    }
+
+    hg_atomic_set32(&hg_tool_table_g[id].mask, 0);
+    hg_tool_update_mask();
+
+    /* Wait for notifications that may still use callback and arg */
+    while (hg_atomic_get32(&hg_tool_table_g[id].active) != 0)
+        hg_thread_yield();
+
+    hg_thread_mutex_unlock(&hg_tool_mutex_g);
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+const char *
+HG_Tool_event_to_string(hg_tool_event_t event)
+{
+    if ((int) event < 0 || event >= HG_TOOL_EVENT_MAX)
+        return "UNDEFINED/UNRECOGNIZED EVENT";
+
+    return hg_tool_event_names_g[event];
+}
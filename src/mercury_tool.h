@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#ifndef MERCURY_TOOL_H
+#define MERCURY_TOOL_H
+
+#include "mercury_core.h"
+
+/*************************************/
+/* Public Type and Struct Definition */
+/*************************************/
+
+/* RPC lifecycle events */
+typedef enum hg_tool_event {
+    HG_TOOL_FORWARD_POSTED,    /*!< origin: request successfully posted */
+    HG_TOOL_REQUEST_RECEIVED,  /*!< target: request received and decoded */
+    HG_TOOL_HANDLER_START,     /*!< target: RPC callback about to be called */
+    HG_TOOL_HANDLER_END,       /*!< target: RPC callback returned */
+    HG_TOOL_RESPOND_POSTED,    /*!< target: response successfully posted */
+    HG_TOOL_RESPONSE_RECEIVED, /*!< origin: response received (size is the
+                                    size of the received message) */
+    HG_TOOL_BULK_START,        /*!< bulk transfer posted */
+    HG_TOOL_BULK_END,          /*!< bulk transfer completed */
+    HG_TOOL_OVERFLOW,          /*!< payload overflow, extra data requested */
+    HG_TOOL_EVENT_MAX
+} hg_tool_event_t;
+
+/* Event info passed to tool callbacks */
+struct hg_tool_event_info {
+    hg_tool_event_t event;           /* Event type */
+    hg_core_context_t *context;      /* HG core context */
+    hg_core_handle_t handle;         /* RPC handle (NULL for bulk events) */
+    const struct hg_core_info *info; /* RPC info (NULL for bulk events) */
+    const void *op_id;               /* Bulk op ID (matches start/end events) */
+    hg_size_t size;                  /* Message size or bulk transfer size */
+    hg_uint64_t time_ns;             /* Monotonic time stamp (ns) */
+    hg_return_t ret;                 /* Status (handler and bulk end events) */
+};
+
+/* Tool callback */
+typedef void (*hg_tool_cb_t)(
+    const struct hg_tool_event_info *event_info, void *arg);
+
+/* Tool ID */
+typedef int hg_tool_id_t;
+
+/*****************/
+/* Public Macros */
+/*****************/
+
+/* Max number of tools attached at the same time */
+#define HG_TOOL_MAX 8
+
+/* Event masks */
+#define HG_TOOL_EVENT_MASK(event) (1U << (event))
+#define HG_TOOL_EVENT_ALL         ((1U << HG_TOOL_EVENT_MAX) - 1)
+
+/*********************/
+/* Public Prototypes */
+/*********************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Attach a tool: callback is invoked with arg for every event of
+ * event_mask (combination of HG_TOOL_EVENT_MASK() values or
+ * HG_TOOL_EVENT_ALL), for all classes and contexts. Callbacks are invoked
+ * inline from the thread that generates the event, possibly concurrently,
+ * and must therefore be thread-safe and must not block. When no tool is
+ * attached, each event costs a single test of a global flag.
+ *
+ * \param event_mask [IN]       mask of events
+ * \param callback [IN]         pointer to tool callback
+ * \param arg [IN]              pointer to data passed to callback
+ * \param id_p [OUT]            pointer to returned tool ID
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+HG_Tool_register(unsigned int event_mask, hg_tool_cb_t callback, void *arg,
+    hg_tool_id_t *id_p);
+
+/**
+ * Detach a tool previously attached with HG_Tool_register(). Callbacks
+ * that are already executing are waited for, once this call returns the
+ * callback is no longer invoked and resources that it uses can be released.
+ * It must therefore not be called from a tool callback.
+ *
+ * \param id [IN]               tool ID
+ *
+ * \return HG_SUCCESS or corresponding HG error code
+ */
+HG_PUBLIC hg_return_t
+HG_Tool_deregister(hg_tool_id_t id);
+
+/**
+ * Convert an event type to a string.
+ *
+ * \param event [IN]            event type
+ *
+ * \return String
+ */
+HG_PUBLIC const char *
+HG_Tool_event_to_string(hg_tool_event_t event);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MERCURY_TOOL_H */
@@ -10,7 +10,9 @@
 
 #include "na_plugin.h"
 
+#include "mercury_eventcount.h"
 #include "mercury_mem.h"
+#include "mercury_thread_lock_prof.h"
 #include "mercury_time.h"
 
 #include <stdlib.h>
@@ -33,6 +35,10 @@
 /* 32-bit lock value for serial progress */
 #define NA_PROGRESS_LOCK 0x80000000
 
+/* Class and contexts are only used from one thread */
+#define NA_SINGLE_THREADED(na_class)                                           \
+    ((na_class)->progress_mode & NA_SINGLE_THREAD)
+
 /************************************/
 /* Local Type and Struct Definition */
 /************************************/
@@ -44,21 +50,22 @@ struct na_private_class {
 /* Private context / do not expose private members to plugins */
 struct na_private_context {
     struct na_context context;              /* Must remain as first field */
-    hg_thread_cond_t completion_queue_cond; /* Completion queue cond */
+    hg_eventcount_t completion_queue_ec;    /* Completion queue wait */
 #ifdef NA_HAS_MULTI_PROGRESS
     hg_thread_cond_t progress_cond; /* Progress cond */
 #endif
     hg_thread_mutex_t completion_queue_mutex; /* Completion queue mutex */
+    hg_thread_lock_prof_t completion_queue_mutex_prof; /* Mutex profile */
 #ifdef NA_HAS_MULTI_PROGRESS
-    hg_thread_mutex_t progress_mutex; /* Progress mutex */
+    hg_thread_mutex_t progress_mutex;          /* Progress mutex */
+    hg_thread_lock_prof_t progress_mutex_prof; /* Progress mutex profile */
 #endif
     HG_QUEUE_HEAD(na_cb_completion_data)
     backfill_queue;                           /* Backfill completion queue */
     struct hg_atomic_queue *completion_queue; /* Default completion queue */
     na_class_t *na_class;                     /* Pointer to NA class */
     hg_atomic_int32_t
-        backfill_queue_count;          /* Number of entries in backfill queue */
-    hg_atomic_int32_t trigger_waiting; /* Polling/waiting in trigger */
+        backfill_queue_count; /* Number of entries in backfill queue */
 #ifdef NA_HAS_MULTI_PROGRESS
     hg_atomic_int32_t progressing; /* Progressing count */
 #endif
@@ -232,8 +239,8 @@ NA_Initialize_opt(const char *info_string, na_bool_t listen,
 #ifdef NA_HAS_VERBOSE_ERROR
     /* Set log level */
     log_level = getenv("HG_NA_LOG_LEVEL");
-    if (log_level && (strcmp(log_level, "debug") == 0))
-        NA_LOG_MASK |= HG_LOG_TYPE_DEBUG;
+    if (log_level)
+        NA_Set_log_level(log_level);
 #endif
 
     na_private_class =
@@ -364,8 +371,8 @@ NA_Cleanup(void)
 
     /* Set log level */
     log_level = getenv("HG_NA_LOG_LEVEL");
-    if (log_level && (strcmp(log_level, "debug") == 0))
-        NA_LOG_MASK |= HG_LOG_TYPE_DEBUG;
+    if (log_level)
+        NA_Set_log_level(log_level);
 #endif
 
     for (i = 0; i < plugin_count; i++) {
@@ -417,12 +424,15 @@ NA_Context_create_id(na_class_t *na_class, na_uint8_t id)
 
     /* Initialize completion queue mutex/cond */
     hg_thread_mutex_init(&na_private_context->completion_queue_mutex);
-    hg_thread_cond_init(&na_private_context->completion_queue_cond);
-    hg_atomic_init32(&na_private_context->trigger_waiting, 0);
+    na_private_context->completion_queue_mutex_prof =
+        hg_thread_lock_prof_register("na.completion_queue");
+    hg_eventcount_init(&na_private_context->completion_queue_ec);
 
 #ifdef NA_HAS_MULTI_PROGRESS
     /* Initialize progress mutex/cond */
     hg_thread_mutex_init(&na_private_context->progress_mutex);
+    na_private_context->progress_mutex_prof =
+        hg_thread_lock_prof_register("na.progress");
     hg_thread_cond_init(&na_private_context->progress_cond);
     hg_atomic_init32(&na_private_context->progressing, 0);
 #endif
@@ -455,7 +465,8 @@ NA_Context_destroy(na_class_t *na_class, na_context_t *context)
     hg_atomic_queue_free(na_private_context->completion_queue);
 
     /* Check that backfill completion queue is empty now */
-    hg_thread_mutex_lock(&na_private_context->completion_queue_mutex);
+    hg_thread_mutex_lock_prof(&na_private_context->completion_queue_mutex,
+        na_private_context->completion_queue_mutex_prof);
     empty = HG_QUEUE_IS_EMPTY(&na_private_context->backfill_queue);
     hg_thread_mutex_unlock(&na_private_context->completion_queue_mutex);
     NA_CHECK_ERROR(empty == NA_FALSE, done, ret, NA_BUSY,
@@ -463,7 +474,7 @@ NA_Context_destroy(na_class_t *na_class, na_context_t *context)
 
     /* Destroy completion queue mutex/cond */
     hg_thread_mutex_destroy(&na_private_context->completion_queue_mutex);
-    hg_thread_cond_destroy(&na_private_context->completion_queue_cond);
+    hg_eventcount_destroy(&na_private_context->completion_queue_ec);
 
     /* Destroy NA plugin context */
     NA_CHECK_ERROR(
@@ -1145,6 +1156,10 @@ NA_Progress(na_class_t *na_class, na_context_t *context, unsigned int timeout)
         NA_OPNOTSUPPORTED, "progress plugin callback is not defined");
 
 #ifdef NA_HAS_MULTI_PROGRESS
+    /* No other thread can be progressing */
+    if (NA_SINGLE_THREADED(na_class))
+        goto progress;
+
     hg_atomic_incr32(&na_private_context->progressing);
     for (;;) {
         hg_time_t t1, t2;
@@ -1165,7 +1180,8 @@ NA_Progress(na_class_t *na_class, na_context_t *context, unsigned int timeout)
 
         /* Prevent multiple threads from concurrently calling progress on
          * the same context */
-        hg_thread_mutex_lock(&na_private_context->progress_mutex);
+        hg_thread_mutex_lock_prof(&na_private_context->progress_mutex,
+            na_private_context->progress_mutex_prof);
 
         num = hg_atomic_get32(&na_private_context->progressing);
         /* Do not need to enter condition if lock is already released */
@@ -1187,8 +1203,9 @@ NA_Progress(na_class_t *na_class, na_context_t *context, unsigned int timeout)
         if (remaining < 0)
             remaining = 0;
     }
-#endif
 
+progress:
+#endif
     /* Something is in one of the completion queues */
     if (!hg_atomic_queue_is_empty(na_private_context->completion_queue) ||
         hg_atomic_get32(&na_private_context->backfill_queue_count)) {
@@ -1206,6 +1223,9 @@ NA_Progress(na_class_t *na_class, na_context_t *context, unsigned int timeout)
 
 #ifdef NA_HAS_MULTI_PROGRESS
 unlock:
+    if (NA_SINGLE_THREADED(na_class))
+        goto done;
+
     do {
         old = hg_atomic_get32(&na_private_context->progressing);
         num = (old - 1) ^ (hg_util_int32_t) NA_PROGRESS_LOCK;
@@ -1213,7 +1233,8 @@ unlock:
 
     if (num > 0) {
         /* If there is another processes entered in progress, signal it */
-        hg_thread_mutex_lock(&na_private_context->progress_mutex);
+        hg_thread_mutex_lock_prof(&na_private_context->progress_mutex,
+            na_private_context->progress_mutex_prof);
         hg_thread_cond_signal(&na_private_context->progress_cond);
         hg_thread_mutex_unlock(&na_private_context->progress_mutex);
     }
@@ -1245,18 +1266,32 @@ NA_Trigger(na_context_t *context, unsigned int timeout, unsigned int max_count,
         if (!completion_data) {
             /* Check backfill queue */
             if (hg_atomic_get32(&na_private_context->backfill_queue_count)) {
-                hg_thread_mutex_lock(
-                    &na_private_context->completion_queue_mutex);
+                na_bool_t single_threaded =
+                    NA_SINGLE_THREADED(na_private_context->na_class);
+
+                if (!single_threaded)
+                    hg_thread_mutex_lock_prof(
+                        &na_private_context->completion_queue_mutex,
+                        na_private_context->completion_queue_mutex_prof);
                 completion_data =
                     HG_QUEUE_FIRST(&na_private_context->backfill_queue);
                 HG_QUEUE_POP_HEAD(&na_private_context->backfill_queue, entry);
-                hg_atomic_decr32(&na_private_context->backfill_queue_count);
-                hg_thread_mutex_unlock(
-                    &na_private_context->completion_queue_mutex);
+                if (single_threaded) {
+                    hg_atomic_set32(&na_private_context->backfill_queue_count,
+                        hg_atomic_get32(
+                            &na_private_context->backfill_queue_count) -
+                            1);
+                } else {
+                    hg_atomic_decr32(
+                        &na_private_context->backfill_queue_count);
+                    hg_thread_mutex_unlock(
+                        &na_private_context->completion_queue_mutex);
+                }
                 if (!completion_data)
                     continue; /* Give another chance to grab it */
             } else {
-                hg_time_t t1, t2;
+                hg_time_fast_t t1, t2;
+                hg_util_int32_t key;
 
                 /* If something was already processed leave */
                 if (count)
@@ -1268,33 +1303,27 @@ NA_Trigger(na_context_t *context, unsigned int timeout, unsigned int max_count,
                     break;
                 }
 
-                hg_time_get_current_ms(&t1);
+                t1 = hg_time_fast_now();
 
-                hg_atomic_incr32(&na_private_context->trigger_waiting);
-                hg_thread_mutex_lock(
-                    &na_private_context->completion_queue_mutex);
                 /* Otherwise wait timeout ms */
-                while (hg_atomic_queue_is_empty(
-                           na_private_context->completion_queue) &&
-                       !hg_atomic_get32(
-                           &na_private_context->backfill_queue_count)) {
-                    if (hg_thread_cond_timedwait(
-                            &na_private_context->completion_queue_cond,
-                            &na_private_context->completion_queue_mutex,
-                            timeout) != HG_UTIL_SUCCESS) {
-                        /* Timeout occurred so leave */
-                        ret = NA_TIMEOUT;
-                        break;
-                    }
-                }
-                hg_thread_mutex_unlock(
-                    &na_private_context->completion_queue_mutex);
-                hg_atomic_decr32(&na_private_context->trigger_waiting);
-                if (ret == NA_TIMEOUT)
+                key = hg_eventcount_prepare_wait(
+                    &na_private_context->completion_queue_ec);
+                if (!hg_atomic_queue_is_empty(
+                        na_private_context->completion_queue) ||
+                    hg_atomic_get32(&na_private_context->backfill_queue_count))
+                    hg_eventcount_cancel_wait(
+                        &na_private_context->completion_queue_ec);
+                else if (hg_eventcount_commit_wait(
+                             &na_private_context->completion_queue_ec, key,
+                             (unsigned int) (remaining * 1000.0)) !=
+                         HG_UTIL_SUCCESS) {
+                    /* Timeout occurred so leave */
+                    ret = NA_TIMEOUT;
                     break;
+                }
 
-                hg_time_get_current_ms(&t2);
-                remaining -= hg_time_diff(t2, t1);
+                t2 = hg_time_fast_now();
+                remaining -= hg_time_fast_diff(t2, t1);
                 continue; /* Give another chance to grab it */
             }
         }
@@ -1361,6 +1390,25 @@ NA_Error_to_string(na_return_t errnum)
     return na_return_name[errnum];
 }
 
+/*---------------------------------------------------------------------------*/
+na_return_t
+NA_Set_log_level(const char *level)
+{
+#ifdef NA_HAS_VERBOSE_ERROR
+    unsigned int mask;
+
+    if (level == NULL || hg_log_level_to_mask(level, &mask) != HG_UTIL_SUCCESS)
+        return NA_INVALID_ARG;
+    NA_LOG_MASK = mask;
+
+    return NA_SUCCESS;
+#else
+    (void) level;
+
+    return NA_OPNOTSUPPORTED;
+#endif
+}
+
 /*---------------------------------------------------------------------------*/
 na_return_t
 na_cb_completion_add(
@@ -1370,23 +1418,30 @@ na_cb_completion_add(
         (struct na_private_context *) context;
     na_return_t ret = NA_SUCCESS;
 
+    /* Single-threaded mode only uses the (unlocked) backfill queue */
+    if (NA_SINGLE_THREADED(na_private_context->na_class)) {
+        HG_QUEUE_PUSH_TAIL(
+            &na_private_context->backfill_queue, na_cb_completion_data, entry);
+        hg_atomic_set32(&na_private_context->backfill_queue_count,
+            hg_atomic_get32(&na_private_context->backfill_queue_count) + 1);
+        goto done;
+    }
+
     if (hg_atomic_queue_push(na_private_context->completion_queue,
             na_cb_completion_data) != HG_UTIL_SUCCESS) {
         /* Queue is full */
-        hg_thread_mutex_lock(&na_private_context->completion_queue_mutex);
+        hg_thread_mutex_lock_prof(&na_private_context->completion_queue_mutex,
+            na_private_context->completion_queue_mutex_prof);
         HG_QUEUE_PUSH_TAIL(
             &na_private_context->backfill_queue, na_cb_completion_data, entry);
         hg_atomic_incr32(&na_private_context->backfill_queue_count);
         hg_thread_mutex_unlock(&na_private_context->completion_queue_mutex);
     }
 
-    if (hg_atomic_get32(&na_private_context->trigger_waiting)) {
-        hg_thread_mutex_lock(&na_private_context->completion_queue_mutex);
-        /* Callback is pushed to the completion queue when something completes
-         * so wake up anyone waiting in the trigger */
-        hg_thread_cond_signal(&na_private_context->completion_queue_cond);
-        hg_thread_mutex_unlock(&na_private_context->completion_queue_mutex);
-    }
+    /* Callback is pushed to the completion queue when something completes
+     * so wake up anyone waiting in the trigger */
+    hg_eventcount_notify(&na_private_context->completion_queue_ec);
 
+done:
     return ret;
 }
@@ -375,6 +375,20 @@ NA_Msg_get_expected_header_size(
 static NA_INLINE na_tag_t
 NA_Msg_get_max_tag(const na_class_t *na_class) NA_WARN_UNUSED_RESULT;
 
+/**
+ * Check whether expected messages that arrive before the matching
+ * NA_Msg_recv_expected() is posted are buffered by the plugin, and whether
+ * expected messages of a same source and tag are delivered in order. Upper
+ * layers may only send several expected messages to a single posted recv at a
+ * time when this is the case.
+ *
+ * \param na_class [IN]         pointer to NA class
+ *
+ * \return NA_TRUE if early expected messages are supported
+ */
+static NA_INLINE na_bool_t
+NA_Msg_has_early_expected(const na_class_t *na_class) NA_WARN_UNUSED_RESULT;
+
 /**
  * Allocate buf_size bytes and return a pointer to the allocated memory.
  * If size is 0, NA_Msg_buf_alloc() returns NULL. The plugin_data output
@@ -867,6 +881,18 @@ NA_Cancel(na_class_t *na_class, na_context_t *context, na_op_id_t op_id);
 NA_PUBLIC const char *
 NA_Error_to_string(na_return_t errnum) NA_WARN_UNUSED_RESULT;
 
+/**
+ * Set log level of the NA layer at runtime ("none", "error", "warning" or
+ * "debug"). The level can also be set with the HG_NA_LOG_LEVEL environment
+ * variable.
+ *
+ * \param level [IN]            log level name
+ *
+ * \return NA_SUCCESS or corresponding NA error code
+ */
+NA_PUBLIC na_return_t
+NA_Set_log_level(const char *level);
+
 /************************************/
 /* Local Type and Struct Definition */
 /************************************/
@@ -929,6 +955,7 @@ struct na_class_ops {
     na_size_t (*msg_get_unexpected_header_size)(const na_class_t *na_class);
     na_size_t (*msg_get_expected_header_size)(const na_class_t *na_class);
     na_tag_t (*msg_get_max_tag)(const na_class_t *na_class);
+    na_bool_t (*msg_has_early_expected)(const na_class_t *na_class);
     void *(*msg_buf_alloc)(
         na_class_t *na_class, na_size_t buf_size, void **plugin_data);
     na_return_t (*msg_buf_free)(
@@ -1065,6 +1092,15 @@ NA_Msg_get_max_tag(const na_class_t *na_class)
     return na_class->ops->msg_get_max_tag(na_class);
 }
 
+/*---------------------------------------------------------------------------*/
+static NA_INLINE na_bool_t
+NA_Msg_has_early_expected(const na_class_t *na_class)
+{
+    return (na_class->ops->msg_has_early_expected)
+               ? na_class->ops->msg_has_early_expected(na_class)
+               : NA_FALSE;
+}
+
 /*---------------------------------------------------------------------------*/
 static NA_INLINE na_return_t
 NA_Msg_send_unexpected(na_class_t *na_class, na_context_t *context,
@@ -383,6 +383,7 @@ const struct na_class_ops NA_PLUGIN_OPS(bmi) = {
     NULL,                                 /* msg_get_unexpected_header_size */
     NULL,                                 /* msg_get_expected_header_size */
     na_bmi_msg_get_max_tag,               /* msg_get_max_tag */
+    NULL,                                 /* msg_has_early_expected */
     NULL,                                 /* msg_buf_alloc */
     NULL,                                 /* msg_buf_free */
     NULL,                                 /* msg_init_unexpected */
@@ -2223,6 +2224,8 @@ na_bmi_complete(struct na_bmi_op_id *na_bmi_op_id)
                 ret = NA_SIZE_ERROR;
                 goto done;
             }
+            callback_info->info.recv_expected.actual_buf_size =
+                (na_size_t) na_bmi_op_id->info.recv_expected.actual_size;
             break;
         case NA_CB_PUT:
             /* Transfer is now done so free RMA info */
@@ -390,6 +390,7 @@ const struct na_class_ops NA_PLUGIN_OPS(cci) = {
     NULL,                                 /* msg_get_unexpected_header_size */
     NULL,                                 /* msg_get_expected_header_size */
     na_cci_msg_get_max_tag,               /* msg_get_max_tag */
+    NULL,                                 /* msg_has_early_expected */
     NULL,                                 /* msg_buf_alloc */
     NULL,                                 /* msg_buf_free */
     NULL,                                 /* msg_init_unexpected */
@@ -2079,6 +2080,8 @@ na_cci_complete(
                 ret = NA_SIZE_ERROR;
                 goto out;
             }
+            callback_info->info.recv_expected.actual_buf_size =
+                (na_size_t) na_cci_op_id->info.recv_expected.actual_size;
             break;
         case NA_CB_SEND_UNEXPECTED:
         case NA_CB_SEND_EXPECTED:
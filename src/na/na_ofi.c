@@ -51,6 +51,7 @@
 #include "mercury_hash_table.h"
 #include "mercury_list.h"
 #include "mercury_mem.h"
+#include "mercury_thread_lock_prof.h"
 #include "mercury_thread_rwlock.h"
 #include "mercury_thread_spin.h"
 #include "mercury_time.h"
@@ -303,6 +304,7 @@ struct na_ofi_op_id {
 /* Op queue */
 struct na_ofi_queue {
     hg_thread_mutex_t mutex;
+    hg_thread_lock_prof_t mutex_prof;
     HG_QUEUE_HEAD(na_ofi_op_id) queue;
 };
 
@@ -331,6 +333,8 @@ struct na_ofi_endpoint {
 struct na_ofi_domain {
     hg_thread_mutex_t mutex;            /* Mutex for AV etc         */
     hg_thread_rwlock_t rwlock;          /* RW lock for addr_ht      */
+    hg_thread_lock_prof_t mutex_prof;   /* Mutex profile            */
+    hg_thread_lock_prof_t rwlock_prof;  /* RW lock profile          */
     HG_LIST_ENTRY(na_ofi_domain) entry; /* Entry in domain list     */
 #ifdef NA_OFI_HAS_EXT_GNI_H
     struct fi_gni_auth_key fi_gni_auth_key; /* GNI auth key             */
@@ -365,7 +369,9 @@ struct na_ofi_mem_pool {
     HG_QUEUE_ENTRY(na_ofi_mem_pool) entry;    /* Entry in pool list       */
     struct fid_mr *mr_hdl;                    /* MR handle                */
     na_size_t block_size;                     /* Node block size          */
+    na_size_t pool_size;                      /* Total pool size          */
     hg_thread_spin_t node_list_lock;          /* Node list lock           */
+    hg_thread_lock_prof_t node_list_lock_prof; /* Node list lock profile  */
 };
 
 /* Private data */
@@ -375,6 +381,8 @@ struct na_ofi_class {
     struct na_ofi_domain *domain;            /* Domain pointer           */
     struct na_ofi_endpoint *endpoint;        /* Endpoint pointer         */
     hg_thread_spin_t buf_pool_lock;          /* Buf pool lock            */
+    hg_thread_lock_prof_t mutex_prof;        /* Mutex profile            */
+    hg_thread_lock_prof_t buf_pool_lock_prof; /* Buf pool lock profile   */
     na_uint8_t contexts;                     /* Number of context        */
     na_uint8_t max_contexts;                 /* Max number of contexts   */
     na_bool_t no_wait;                       /* Ignore wait object       */
@@ -927,6 +935,7 @@ const struct na_class_ops NA_PLUGIN_OPS(ofi) = {
     na_ofi_msg_get_unexpected_header_size, /* msg_get_unexpected_header_size */
     NULL,                                  /* msg_get_expected_header_size */
     na_ofi_msg_get_max_tag,                /* msg_get_max_tag */
+    NULL,                                  /* msg_has_early_expected */
     na_ofi_msg_buf_alloc,                  /* msg_buf_alloc */
     na_ofi_msg_buf_free,                   /* msg_buf_free */
     na_ofi_msg_init_unexpected,            /* msg_init_unexpected */
@@ -960,6 +969,7 @@ static HG_LIST_HEAD(na_ofi_domain)
 /* Protects domain list */
 static hg_thread_mutex_t na_ofi_domain_list_mutex_g =
     HG_THREAD_MUTEX_INITIALIZER;
+static hg_thread_lock_prof_t na_ofi_domain_list_prof_g = NULL;
 
 /*---------------------------------------------------------------------------*/
 static NA_INLINE enum na_ofi_prov_type
@@ -980,7 +990,7 @@ static NA_INLINE void
 na_ofi_domain_lock(struct na_ofi_domain *domain)
 {
     if (na_ofi_prov_flags[domain->prov_type] & NA_OFI_DOMAIN_LOCK)
-        hg_thread_mutex_lock(&domain->mutex);
+        hg_thread_mutex_lock_prof(&domain->mutex, domain->mutex_prof);
 }
 
 /*---------------------------------------------------------------------------*/
@@ -1244,7 +1254,7 @@ na_ofi_addr_ht_lookup(struct na_ofi_domain *domain, na_uint32_t addr_format,
         "Could not generate key from addr");
 
     /* Lookup key */
-    hg_thread_rwlock_rdlock(&domain->rwlock);
+    hg_thread_rwlock_rdlock_prof(&domain->rwlock, domain->rwlock_prof);
     ht_value = hg_hash_table_lookup(domain->addr_ht, ht_key);
     if (ht_value != HG_HASH_TABLE_NULL) {
         /* Found */
@@ -1261,7 +1271,7 @@ na_ofi_addr_ht_lookup(struct na_ofi_domain *domain, na_uint32_t addr_format,
     NA_CHECK_ERROR(rc < 1, out, ret, NA_PROTOCOL_ERROR,
         "fi_av_insert() failed, rc: %d (%s)", rc, fi_strerror((int) -rc));
 
-    hg_thread_rwlock_wrlock(&domain->rwlock);
+    hg_thread_rwlock_wrlock_prof(&domain->rwlock, domain->rwlock_prof);
 
     ht_value = hg_hash_table_lookup(domain->addr_ht, ht_key);
     if (ht_value != HG_HASH_TABLE_NULL) {
@@ -1319,7 +1329,7 @@ na_ofi_addr_ht_remove(
     na_return_t ret = NA_SUCCESS;
     int rc;
 
-    hg_thread_rwlock_wrlock(&domain->rwlock);
+    hg_thread_rwlock_wrlock_prof(&domain->rwlock, domain->rwlock_prof);
     ht_value =
         hg_hash_table_lookup(domain->addr_ht, (hg_hash_table_key_t) addr_key);
     if (ht_value == HG_HASH_TABLE_NULL)
@@ -1710,7 +1720,8 @@ na_ofi_domain_open(struct na_ofi_class *priv, enum na_ofi_prov_type prov_type,
      * providers. The endpoints with same provider name can reuse the same
      * na_ofi_domain.
      */
-    hg_thread_mutex_lock(&na_ofi_domain_list_mutex_g);
+    hg_thread_mutex_lock_prof(&na_ofi_domain_list_mutex_g,
+        na_ofi_domain_list_prof_g);
     HG_LIST_FOREACH (na_ofi_domain, &na_ofi_domain_list_g, entry) {
         if (na_ofi_verify_provider(
                 prov_type, domain_name, na_ofi_domain->fi_prov)) {
@@ -1759,11 +1770,14 @@ na_ofi_domain_open(struct na_ofi_class *priv, enum na_ofi_prov_type prov_type,
     rc = hg_thread_mutex_init(&na_ofi_domain->mutex);
     NA_CHECK_ERROR(rc != HG_UTIL_SUCCESS, error, ret, NA_NOMEM,
         "hg_thread_mutex_init() failed");
+    na_ofi_domain->mutex_prof = hg_thread_lock_prof_register("na_ofi.domain");
 
     /* Init rw lock */
     rc = hg_thread_rwlock_init(&na_ofi_domain->rwlock);
     NA_CHECK_ERROR(rc != HG_UTIL_SUCCESS, error, ret, NA_NOMEM,
         "hg_thread_rwlock_init() failed");
+    na_ofi_domain->rwlock_prof =
+        hg_thread_lock_prof_register("na_ofi.domain_rwlock");
 
     /* Keep fi_info */
     na_ofi_domain->fi_prov = fi_dupinfo(prov);
@@ -1902,7 +1916,8 @@ na_ofi_domain_open(struct na_ofi_class *priv, enum na_ofi_prov_type prov_type,
     hg_hash_table_register_free_functions(na_ofi_domain->addr_ht, free, free);
 
     /* Insert to global domain list */
-    hg_thread_mutex_lock(&na_ofi_domain_list_mutex_g);
+    hg_thread_mutex_lock_prof(&na_ofi_domain_list_mutex_g,
+        na_ofi_domain_list_prof_g);
     HG_LIST_INSERT_HEAD(&na_ofi_domain_list_g, na_ofi_domain, entry);
     hg_thread_mutex_unlock(&na_ofi_domain_list_mutex_g);
 
@@ -1936,7 +1951,8 @@ na_ofi_domain_close(struct na_ofi_domain *na_ofi_domain)
         goto out;
 
     /* Remove from domain list */
-    hg_thread_mutex_lock(&na_ofi_domain_list_mutex_g);
+    hg_thread_mutex_lock_prof(&na_ofi_domain_list_mutex_g,
+        na_ofi_domain_list_prof_g);
     if (na_ofi_domain->entry.next || na_ofi_domain->entry.prev)
         HG_LIST_REMOVE(na_ofi_domain, entry);
     hg_thread_mutex_unlock(&na_ofi_domain_list_mutex_g);
@@ -2087,6 +2103,8 @@ na_ofi_basic_ep_open(const struct na_ofi_domain *na_ofi_domain,
         "Could not allocate retry_op_queue");
     HG_QUEUE_INIT(&na_ofi_endpoint->retry_op_queue->queue);
     hg_thread_mutex_init(&na_ofi_endpoint->retry_op_queue->mutex);
+    na_ofi_endpoint->retry_op_queue->mutex_prof =
+        hg_thread_lock_prof_register("na_ofi.retry_op_queue");
 
     if (!no_wait) {
         if (na_ofi_prov_flags[na_ofi_domain->prov_type] & NA_OFI_WAIT_FD)
@@ -2389,8 +2407,12 @@ na_ofi_mem_pool_create(
 
     HG_QUEUE_INIT(&na_ofi_mem_pool->node_list);
     hg_thread_spin_init(&na_ofi_mem_pool->node_list_lock);
+    na_ofi_mem_pool->node_list_lock_prof =
+        hg_thread_lock_prof_register("na_ofi.mem_pool");
     na_ofi_mem_pool->mr_hdl = mr_hdl;
     na_ofi_mem_pool->block_size = block_size;
+    na_ofi_mem_pool->pool_size = pool_size;
+    hg_mem_usage_add(HG_MEM_USAGE_NA_POOL, pool_size);
 
     /* Assign nodes and insert them to free list */
     for (i = 0; i < block_count; i++) {
@@ -2408,6 +2430,7 @@ out:
 static void
 na_ofi_mem_pool_destroy(struct na_ofi_mem_pool *na_ofi_mem_pool)
 {
+    hg_mem_usage_sub(HG_MEM_USAGE_NA_POOL, na_ofi_mem_pool->pool_size);
     na_ofi_mem_free(na_ofi_mem_pool, na_ofi_mem_pool->mr_hdl);
     hg_thread_spin_destroy(&na_ofi_mem_pool->node_list_lock);
 }
@@ -2474,10 +2497,12 @@ na_ofi_mem_pool_alloc(
 
 retry:
     /* Check whether we can get a block from one of the pools */
-    hg_thread_spin_lock(&NA_OFI_CLASS(na_class)->buf_pool_lock);
+    hg_thread_spin_lock_prof(&NA_OFI_CLASS(na_class)->buf_pool_lock,
+        NA_OFI_CLASS(na_class)->buf_pool_lock_prof);
     HG_QUEUE_FOREACH (
         na_ofi_mem_pool, &NA_OFI_CLASS(na_class)->buf_pool, entry) {
-        hg_thread_spin_lock(&na_ofi_mem_pool->node_list_lock);
+        hg_thread_spin_lock_prof(&na_ofi_mem_pool->node_list_lock,
+            na_ofi_mem_pool->node_list_lock_prof);
         found = !HG_QUEUE_IS_EMPTY(&na_ofi_mem_pool->node_list);
         hg_thread_spin_unlock(&na_ofi_mem_pool->node_list_lock);
         if (found)
@@ -2490,7 +2515,8 @@ retry:
         na_ofi_mem_pool = na_ofi_mem_pool_create(na_class,
             na_ofi_msg_get_max_unexpected_size(na_class),
             NA_OFI_MEM_BLOCK_COUNT);
-        hg_thread_spin_lock(&NA_OFI_CLASS(na_class)->buf_pool_lock);
+        hg_thread_spin_lock_prof(&NA_OFI_CLASS(na_class)->buf_pool_lock,
+            NA_OFI_CLASS(na_class)->buf_pool_lock_prof);
         HG_QUEUE_PUSH_TAIL(
             &NA_OFI_CLASS(na_class)->buf_pool, na_ofi_mem_pool, entry);
         hg_thread_spin_unlock(&NA_OFI_CLASS(na_class)->buf_pool_lock);
@@ -2500,7 +2526,8 @@ retry:
         "Block size is too small for requested size");
 
     /* Pick a node from one of the available pools */
-    hg_thread_spin_lock(&na_ofi_mem_pool->node_list_lock);
+    hg_thread_spin_lock_prof(&na_ofi_mem_pool->node_list_lock,
+        na_ofi_mem_pool->node_list_lock_prof);
     na_ofi_mem_node = HG_QUEUE_FIRST(&na_ofi_mem_pool->node_list);
     if (!na_ofi_mem_node) {
         hg_thread_spin_unlock(&na_ofi_mem_pool->node_list_lock);
@@ -2524,14 +2551,16 @@ na_ofi_mem_pool_free(na_class_t *na_class, void *mem_ptr, struct fid_mr *mr_hdl)
         container_of(mem_ptr, struct na_ofi_mem_node, block);
 
     /* Put the node back to the pool */
-    hg_thread_spin_lock(&NA_OFI_CLASS(na_class)->buf_pool_lock);
+    hg_thread_spin_lock_prof(&NA_OFI_CLASS(na_class)->buf_pool_lock,
+        NA_OFI_CLASS(na_class)->buf_pool_lock_prof);
     HG_QUEUE_FOREACH (
         na_ofi_mem_pool, &NA_OFI_CLASS(na_class)->buf_pool, entry) {
         /* If MR handle is NULL, it does not really matter which pool we push
          * the node back to.
          */
         if (na_ofi_mem_pool->mr_hdl == mr_hdl) {
-            hg_thread_spin_lock(&na_ofi_mem_pool->node_list_lock);
+            hg_thread_spin_lock_prof(&na_ofi_mem_pool->node_list_lock,
+                na_ofi_mem_pool->node_list_lock_prof);
             HG_QUEUE_PUSH_TAIL(
                 &na_ofi_mem_pool->node_list, na_ofi_mem_node, entry);
             hg_thread_spin_unlock(&na_ofi_mem_pool->node_list_lock);
@@ -2561,6 +2590,7 @@ na_ofi_op_id_decref(struct na_ofi_op_id *na_ofi_op_id)
 
     /* No more references, cleanup */
     free(na_ofi_op_id);
+    hg_mem_usage_sub(HG_MEM_USAGE_NA_OP, sizeof(struct na_ofi_op_id));
 }
 
 /*---------------------------------------------------------------------------*/
@@ -2839,7 +2869,8 @@ na_ofi_cq_process_retries(na_context_t *context)
     do {
         ssize_t rc = 0;
 
-        hg_thread_mutex_lock(&ctx->retry_op_queue->mutex);
+        hg_thread_mutex_lock_prof(&ctx->retry_op_queue->mutex,
+            ctx->retry_op_queue->mutex_prof);
 
         na_ofi_op_id = HG_QUEUE_FIRST(&ctx->retry_op_queue->queue);
         if (!na_ofi_op_id)
@@ -2988,6 +3019,8 @@ na_ofi_complete(struct na_ofi_op_id *na_ofi_op_id)
                                na_ofi_op_id->info.msg.buf_size,
                 out, ret, NA_MSGSIZE,
                 "Expected recv msg size too large for buffer");
+            callback_info->info.recv_expected.actual_buf_size =
+                na_ofi_op_id->info.msg.actual_buf_size;
             break;
         case NA_CB_SEND_UNEXPECTED:
         case NA_CB_SEND_EXPECTED:
@@ -3209,9 +3242,15 @@ na_ofi_initialize(na_class_t *na_class, const struct na_info *na_info,
 
     /* Initialize queue / mutex */
     hg_thread_mutex_init(&priv->mutex);
+    priv->mutex_prof = hg_thread_lock_prof_register("na_ofi.class");
 
     /* Initialize buf pool */
     hg_thread_spin_init(&priv->buf_pool_lock);
+    priv->buf_pool_lock_prof = hg_thread_lock_prof_register("na_ofi.buf_pool");
+
+    /* Domain list is global, registration of its profile is idempotent */
+    na_ofi_domain_list_prof_g =
+        hg_thread_lock_prof_register("na_ofi.domain_list");
     HG_QUEUE_INIT(&priv->buf_pool);
 
     /* Create domain */
@@ -3304,7 +3343,7 @@ na_ofi_context_create(na_class_t *na_class, void **context, na_uint8_t id)
     ctx->idx = id;
 
     /* If not using SEP, just point to endpoint objects */
-    hg_thread_mutex_lock(&priv->mutex);
+    hg_thread_mutex_lock_prof(&priv->mutex, priv->mutex_prof);
 
     if (!na_ofi_with_sep(na_class)) {
         ctx->fi_tx = ep->fi_ep;
@@ -3320,6 +3359,8 @@ na_ofi_context_create(na_class_t *na_class, void **context, na_uint8_t id)
         /* Initialize queue / mutex */
         HG_QUEUE_INIT(&ctx->retry_op_queue->queue);
         hg_thread_mutex_init(&ctx->retry_op_queue->mutex);
+        ctx->retry_op_queue->mutex_prof =
+            hg_thread_lock_prof_register("na_ofi.retry_op_queue");
 
         NA_CHECK_ERROR(
             priv->contexts >= priv->max_contexts || id >= priv->max_contexts,
@@ -3443,7 +3484,7 @@ na_ofi_context_destroy(na_class_t *na_class, void *context)
         free(ctx->retry_op_queue);
     }
 
-    hg_thread_mutex_lock(&priv->mutex);
+    hg_thread_mutex_lock_prof(&priv->mutex, priv->mutex_prof);
     priv->contexts--;
     hg_thread_mutex_unlock(&priv->mutex);
 
@@ -3463,6 +3504,7 @@ na_ofi_op_create(na_class_t NA_UNUSED *na_class)
         (struct na_ofi_op_id *) calloc(1, sizeof(struct na_ofi_op_id));
     NA_CHECK_ERROR_NORET(
         na_ofi_op_id == NULL, out, "Could not allocate NA OFI operation ID");
+    hg_mem_usage_add(HG_MEM_USAGE_NA_OP, sizeof(struct na_ofi_op_id));
     hg_atomic_init32(&na_ofi_op_id->refcount, 1);
     /* Completed by default */
     hg_atomic_init32(&na_ofi_op_id->status, NA_OFI_OP_COMPLETED);
@@ -3937,7 +3979,8 @@ na_ofi_msg_send_unexpected(na_class_t *na_class, na_context_t *context,
             NA_LOG_DEBUG("Pushing %p for retry", na_ofi_op_id);
 
             /* Push op ID to retry queue */
-            hg_thread_mutex_lock(&ctx->retry_op_queue->mutex);
+            hg_thread_mutex_lock_prof(&ctx->retry_op_queue->mutex,
+                ctx->retry_op_queue->mutex_prof);
             HG_QUEUE_PUSH_TAIL(
                 &ctx->retry_op_queue->queue, na_ofi_op_id, entry);
             hg_atomic_or32(&na_ofi_op_id->status, NA_OFI_OP_QUEUED);
@@ -4011,7 +4054,8 @@ na_ofi_msg_recv_unexpected(na_class_t *na_class, na_context_t *context,
             NA_LOG_DEBUG("Pushing %p for retry", na_ofi_op_id);
 
             /* Push op ID to retry queue */
-            hg_thread_mutex_lock(&ctx->retry_op_queue->mutex);
+            hg_thread_mutex_lock_prof(&ctx->retry_op_queue->mutex,
+                ctx->retry_op_queue->mutex_prof);
             HG_QUEUE_PUSH_TAIL(
                 &ctx->retry_op_queue->queue, na_ofi_op_id, entry);
             hg_atomic_or32(&na_ofi_op_id->status, NA_OFI_OP_QUEUED);
@@ -4089,7 +4133,8 @@ na_ofi_msg_send_expected(na_class_t *na_class, na_context_t *context,
             NA_LOG_DEBUG("Pushing %p for retry", na_ofi_op_id);
 
             /* Push op ID to retry queue */
-            hg_thread_mutex_lock(&ctx->retry_op_queue->mutex);
+            hg_thread_mutex_lock_prof(&ctx->retry_op_queue->mutex,
+                ctx->retry_op_queue->mutex_prof);
             HG_QUEUE_PUSH_TAIL(
                 &ctx->retry_op_queue->queue, na_ofi_op_id, entry);
             hg_atomic_or32(&na_ofi_op_id->status, NA_OFI_OP_QUEUED);
@@ -4167,7 +4212,8 @@ na_ofi_msg_recv_expected(na_class_t *na_class, na_context_t *context,
             NA_LOG_DEBUG("Pushing %p for retry", na_ofi_op_id);
 
             /* Push op ID to retry queue */
-            hg_thread_mutex_lock(&ctx->retry_op_queue->mutex);
+            hg_thread_mutex_lock_prof(&ctx->retry_op_queue->mutex,
+                ctx->retry_op_queue->mutex_prof);
             HG_QUEUE_PUSH_TAIL(
                 &ctx->retry_op_queue->queue, na_ofi_op_id, entry);
             hg_atomic_or32(&na_ofi_op_id->status, NA_OFI_OP_QUEUED);
@@ -4439,7 +4485,8 @@ na_ofi_put(na_class_t *na_class, na_context_t *context, na_cb_t callback,
             NA_LOG_DEBUG("Pushing %p for retry", na_ofi_op_id);
 
             /* Push op ID to retry queue */
-            hg_thread_mutex_lock(&ctx->retry_op_queue->mutex);
+            hg_thread_mutex_lock_prof(&ctx->retry_op_queue->mutex,
+                ctx->retry_op_queue->mutex_prof);
             HG_QUEUE_PUSH_TAIL(
                 &ctx->retry_op_queue->queue, na_ofi_op_id, entry);
             hg_atomic_or32(&na_ofi_op_id->status, NA_OFI_OP_QUEUED);
@@ -4545,7 +4592,8 @@ na_ofi_get(na_class_t *na_class, na_context_t *context, na_cb_t callback,
             NA_LOG_DEBUG("Pushing %p for retry", na_ofi_op_id);
 
             /* Push op ID to retry queue */
-            hg_thread_mutex_lock(&ctx->retry_op_queue->mutex);
+            hg_thread_mutex_lock_prof(&ctx->retry_op_queue->mutex,
+                ctx->retry_op_queue->mutex_prof);
             HG_QUEUE_PUSH_TAIL(
                 &ctx->retry_op_queue->queue, na_ofi_op_id, entry);
             hg_atomic_or32(&na_ofi_op_id->status, NA_OFI_OP_QUEUED);
@@ -4598,7 +4646,8 @@ na_ofi_poll_try_wait(na_class_t *na_class, na_context_t *context)
     int rc;
 
     /* Keep making progress if retry queue is not empty */
-    hg_thread_mutex_lock(&ctx->retry_op_queue->mutex);
+    hg_thread_mutex_lock_prof(&ctx->retry_op_queue->mutex,
+        ctx->retry_op_queue->mutex_prof);
     if (!HG_QUEUE_IS_EMPTY(&ctx->retry_op_queue->queue)) {
         hg_thread_mutex_unlock(&ctx->retry_op_queue->mutex);
         return NA_FALSE;
@@ -4734,7 +4783,8 @@ na_ofi_cancel(na_class_t *na_class, na_context_t *context, na_op_id_t op_id)
     }
 
     /* Check if op_id is in retry queue */
-    hg_thread_mutex_lock(&NA_OFI_CONTEXT(context)->retry_op_queue->mutex);
+    hg_thread_mutex_lock_prof(&NA_OFI_CONTEXT(context)->retry_op_queue->mutex,
+        NA_OFI_CONTEXT(context)->retry_op_queue->mutex_prof);
     if (hg_atomic_get32(&na_ofi_op_id->status) & NA_OFI_OP_QUEUED) {
         HG_QUEUE_REMOVE(&NA_OFI_CONTEXT(context)->retry_op_queue->queue,
             na_ofi_op_id, na_ofi_op_id, entry);
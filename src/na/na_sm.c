@@ -20,6 +20,7 @@
 #include "mercury_mem.h"
 #include "mercury_poll.h"
 #include "mercury_queue.h"
+#include "mercury_thread_lock_prof.h"
 #include "mercury_thread_rwlock.h"
 #include "mercury_thread_spin.h"
 #include "mercury_time.h"
@@ -90,6 +91,18 @@
 /* Max tag */
 #define NA_SM_MAX_TAG NA_TAG_MAX
 
+/* Max number of early expected msgs buffered before their recv is posted */
+#define NA_SM_EXPECTED_MSG_MAX (NA_SM_NUM_BUFS * 64)
+
+/* Rx queue states of an addr, a queue stalls on an expected msg that cannot
+ * be buffered and resumes once a recv is posted */
+#define NA_SM_RX_RUNNING  0
+#define NA_SM_RX_STALLED  1
+#define NA_SM_RX_RESUMING 2
+
+/* Number of canceled expected recvs remembered to drop their late msgs */
+#define NA_SM_CANCELED_RECV_MAX 64
+
 /* Max events */
 #define NA_SM_MAX_EVENTS 16
 
@@ -235,6 +248,10 @@ struct na_sm_addr {
     na_sm_poll_type_t tx_poll_type;     /* Tx poll type */
     na_sm_poll_type_t rx_poll_type;     /* Rx poll type */
     hg_atomic_int32_t ref_count;        /* Ref count */
+    hg_atomic_int32_t retry_count;      /* Sends queued for retry */
+    unsigned int retry_pass;            /* Last retry pass that was blocked */
+    na_sm_msg_hdr_t rx_stalled_hdr;     /* Expected msg waiting for room */
+    hg_atomic_int32_t rx_stalled;       /* Rx queue stalled (NA_SM_RX_*) */
     pid_t pid;                          /* PID */
     na_uint8_t id;                      /* SM ID */
     na_uint8_t queue_pair_idx;          /* Shared queue pair index */
@@ -245,11 +262,13 @@ struct na_sm_addr {
 struct na_sm_addr_list {
     HG_LIST_HEAD(na_sm_addr) list;
     hg_thread_spin_t lock;
+    hg_thread_lock_prof_t lock_prof;
 };
 
 /* Map (used to cache addresses) */
 struct na_sm_map {
     hg_thread_rwlock_t lock;
+    hg_thread_lock_prof_t lock_prof;
     hg_hash_table_t *map;
 };
 
@@ -289,10 +308,27 @@ struct na_sm_unexpected_info {
     na_tag_t tag;
 };
 
+/* Canceled expected recv */
+struct na_sm_canceled_recv {
+    struct na_sm_addr *na_sm_addr; /* Source addr (no reference is held) */
+    na_tag_t tag;                  /* Tag */
+};
+
+/* Recently canceled expected recvs (protected by expected op queue lock) */
+struct na_sm_canceled_recvs {
+    struct na_sm_canceled_recv entries[NA_SM_CANCELED_RECV_MAX];
+    unsigned int next;   /* Next entry to overwrite */
+    na_uint64_t dropped; /* Number of late msgs dropped */
+};
+
 /* Unexpected msg queue */
 struct na_sm_unexpected_msg_queue {
     HG_QUEUE_HEAD(na_sm_unexpected_info) queue;
     hg_thread_spin_t lock;
+    hg_thread_lock_prof_t lock_prof;
+    unsigned int count;     /* Number of queued msgs */
+    unsigned int max_count; /* Max number of queued msgs */
+    na_uint64_t total;      /* Number of msgs ever queued */
 };
 
 /* Operation ID */
@@ -313,6 +349,15 @@ struct na_sm_op_id {
 struct na_sm_op_queue {
     HG_QUEUE_HEAD(na_sm_op_id) queue;
     hg_thread_spin_t lock;
+    hg_thread_lock_prof_t lock_prof;
+};
+
+/* Endpoint counters (see NA_SM_Get_stats()) */
+struct na_sm_counters {
+    hg_atomic_int64_t send_retries;   /* Sends pushed to retry queue */
+    hg_atomic_int64_t rx_stalls;      /* Rx queues stalled on early msgs */
+    hg_atomic_int64_t poll_wakeups;   /* Poll waits that returned events */
+    hg_atomic_int64_t notify_wakeups; /* Notifications consumed */
 };
 
 /* Endpoint */
@@ -322,9 +367,15 @@ struct na_sm_endpoint {
         unexpected_msg_queue;                  /* Unexpected msg queue */
     struct na_sm_op_queue unexpected_op_queue; /* Unexpected op queue */
     struct na_sm_op_queue expected_op_queue;   /* Expected op queue */
+    struct na_sm_unexpected_msg_queue
+        expected_msg_queue;                    /* Early expected msg queue */
+    struct na_sm_canceled_recvs canceled_recvs; /* Canceled expected recvs */
     struct na_sm_op_queue retry_op_queue;      /* Retry op queue */
+    hg_atomic_int32_t retry_op_count;          /* Number of ops to retry */
+    unsigned int retry_pass;                   /* Retry pass (under lock) */
     struct na_sm_addr_list poll_addr_list;     /* List of addresses to poll */
     struct na_sm_addr *source_addr;            /* Source addr */
+    struct na_sm_counters counters;            /* Counters */
     hg_poll_set_t *poll_set;                   /* Poll set */
     int sock;                                  /* Sock fd */
     na_sm_poll_type_t sock_poll_type;          /* Sock poll type */
@@ -685,7 +736,7 @@ static na_return_t
 na_sm_progress_rx_notify(struct na_sm_addr *poll_addr, na_bool_t *progressed);
 
 /**
- * Progress rx queue.
+ * Progress rx queue (drains all queued messages).
  */
 static na_return_t
 na_sm_progress_rx_queue(struct na_sm_endpoint *na_sm_endpoint,
@@ -704,13 +755,51 @@ na_sm_process_unexpected(struct na_sm_op_queue *unexpected_op_queue,
  */
 static na_return_t
 na_sm_process_expected(struct na_sm_op_queue *expected_op_queue,
-    struct na_sm_addr *poll_addr, na_sm_msg_hdr_t msg_hdr);
+    struct na_sm_addr *poll_addr, na_sm_msg_hdr_t msg_hdr,
+    struct na_sm_unexpected_msg_queue *expected_msg_queue,
+    struct na_sm_canceled_recvs *canceled_recvs);
+
+/**
+ * Remember canceled expected recv (op queue must be locked).
+ */
+static NA_INLINE void
+na_sm_canceled_recv_add(struct na_sm_canceled_recvs *canceled_recvs,
+    struct na_sm_addr *na_sm_addr, na_tag_t tag);
+
+/**
+ * Forget canceled expected recvs matching addr/tag (op queue must be locked).
+ */
+static NA_INLINE void
+na_sm_canceled_recv_remove(struct na_sm_canceled_recvs *canceled_recvs,
+    struct na_sm_addr *na_sm_addr, na_tag_t tag);
+
+/**
+ * Check whether addr/tag matches a canceled expected recv (op queue must be
+ * locked).
+ */
+static NA_INLINE na_bool_t
+na_sm_canceled_recv_match(struct na_sm_canceled_recvs *canceled_recvs,
+    struct na_sm_addr *na_sm_addr, na_tag_t tag);
+
+/**
+ * Find and remove expected op ID matching addr/tag (op queue must be locked).
+ */
+static NA_INLINE struct na_sm_op_id *
+na_sm_expected_op_match(struct na_sm_op_queue *expected_op_queue,
+    struct na_sm_addr *na_sm_addr, na_tag_t tag);
+
+/**
+ * Push op ID to retry queue.
+ */
+static NA_INLINE void
+na_sm_op_retry(
+    struct na_sm_endpoint *na_sm_endpoint, struct na_sm_op_id *na_sm_op_id);
 
 /**
  * Process retries.
  */
 static na_return_t
-na_sm_process_retries(struct na_sm_op_queue *retry_op_queue);
+na_sm_process_retries(struct na_sm_endpoint *na_sm_endpoint);
 
 /**
  * Complete operation.
@@ -812,6 +901,10 @@ na_sm_msg_get_max_expected_size(const na_class_t *na_class);
 static NA_INLINE na_tag_t
 na_sm_msg_get_max_tag(const na_class_t *na_class);
 
+/* msg_has_early_expected */
+static NA_INLINE na_bool_t
+na_sm_msg_has_early_expected(const na_class_t *na_class);
+
 /* msg_send_unexpected */
 static na_return_t
 na_sm_msg_send_unexpected(na_class_t *na_class, na_context_t *context,
@@ -908,6 +1001,9 @@ na_sm_cancel(na_class_t *na_class, na_context_t *context, na_op_id_t op_id);
 /* Local Variables */
 /*******************/
 
+/* Profile of copy buffer locks */
+static hg_thread_lock_prof_t na_sm_copy_buf_prof_g = NULL;
+
 const struct na_class_ops NA_PLUGIN_OPS(sm) = {
     "na",                              /* name */
     na_sm_check_protocol,              /* check_protocol */
@@ -934,6 +1030,7 @@ const struct na_class_ops NA_PLUGIN_OPS(sm) = {
     NULL,                              /* msg_get_unexpected_header_size */
     NULL,                              /* msg_get_expected_header_size */
     na_sm_msg_get_max_tag,             /* msg_get_max_tag */
+    na_sm_msg_has_early_expected,      /* msg_has_early_expected */
     NULL,                              /* msg_buf_alloc */
     NULL,                              /* msg_buf_free */
     NULL,                              /* msg_init_unexpected */
@@ -1085,6 +1182,51 @@ NA_SM_Host_id_cmp(na_sm_id_t id1, na_sm_id_t id2)
 #endif
 }
 
+/*---------------------------------------------------------------------------*/
+na_return_t
+NA_SM_Get_stats(na_class_t *na_class, struct na_sm_stats *stats)
+{
+    struct na_sm_endpoint *na_sm_endpoint;
+    na_return_t ret = NA_SUCCESS;
+
+    NA_CHECK_ERROR(na_class == NULL || na_class->ops != &NA_PLUGIN_OPS(sm),
+        done, ret, NA_INVALID_ARG, "Not an SM class");
+    NA_CHECK_ERROR(stats == NULL, done, ret, NA_INVALID_ARG, "NULL stats");
+
+    na_sm_endpoint = &NA_SM_CLASS(na_class)->endpoint;
+    stats->send_retries = (na_uint64_t) hg_atomic_get64(
+        &na_sm_endpoint->counters.send_retries);
+    stats->rx_stalls =
+        (na_uint64_t) hg_atomic_get64(&na_sm_endpoint->counters.rx_stalls);
+    stats->poll_wakeups = (na_uint64_t) hg_atomic_get64(
+        &na_sm_endpoint->counters.poll_wakeups);
+    stats->notify_wakeups = (na_uint64_t) hg_atomic_get64(
+        &na_sm_endpoint->counters.notify_wakeups);
+
+    hg_thread_spin_lock_prof(&na_sm_endpoint->unexpected_msg_queue.lock,
+        na_sm_endpoint->unexpected_msg_queue.lock_prof);
+    stats->unexpected_queued = na_sm_endpoint->unexpected_msg_queue.total;
+    stats->unexpected_depth = na_sm_endpoint->unexpected_msg_queue.count;
+    stats->unexpected_depth_max =
+        na_sm_endpoint->unexpected_msg_queue.max_count;
+    hg_thread_spin_unlock(&na_sm_endpoint->unexpected_msg_queue.lock);
+
+    hg_thread_spin_lock_prof(&na_sm_endpoint->expected_msg_queue.lock,
+        na_sm_endpoint->expected_msg_queue.lock_prof);
+    stats->early_expected_queued = na_sm_endpoint->expected_msg_queue.total;
+    stats->early_expected_depth = na_sm_endpoint->expected_msg_queue.count;
+    hg_thread_spin_unlock(&na_sm_endpoint->expected_msg_queue.lock);
+    stats->early_expected_max = NA_SM_EXPECTED_MSG_MAX;
+
+    hg_thread_spin_lock_prof(&na_sm_endpoint->expected_op_queue.lock,
+        na_sm_endpoint->expected_op_queue.lock_prof);
+    stats->late_expected_dropped = na_sm_endpoint->canceled_recvs.dropped;
+    hg_thread_spin_unlock(&na_sm_endpoint->expected_op_queue.lock);
+
+done:
+    return ret;
+}
+
 /*---------------------------------------------------------------------------*/
 static char *
 getlogin_safe(void)
@@ -1403,6 +1545,9 @@ na_sm_region_open(const char *username, pid_t pid, na_uint8_t id,
         shm_name, sizeof(struct na_sm_region), create);
     NA_CHECK_ERROR(na_sm_region == NULL, done, ret, NA_NODEV,
         "Could not map new SM region (%s)", shm_name);
+    hg_mem_usage_add(HG_MEM_USAGE_SM_REGION,
+        sizeof(struct na_sm_region) - sizeof(struct na_sm_copy_buf));
+    hg_mem_usage_add(HG_MEM_USAGE_SM_COPY_BUF, sizeof(struct na_sm_copy_buf));
 
     if (create) {
         int i;
@@ -1458,6 +1603,9 @@ na_sm_region_close(const char *username, pid_t pid, na_uint8_t id,
     ret = na_sm_shm_unmap(shm_name_ptr, region, sizeof(struct na_sm_region));
     NA_CHECK_NA_ERROR(
         done, ret, "Could not unmap SM region (%s)", shm_name_ptr);
+    hg_mem_usage_sub(HG_MEM_USAGE_SM_REGION,
+        sizeof(struct na_sm_region) - sizeof(struct na_sm_copy_buf));
+    hg_mem_usage_sub(HG_MEM_USAGE_SM_COPY_BUF, sizeof(struct na_sm_copy_buf));
 
 done:
     return ret;
@@ -1854,22 +2002,54 @@ na_sm_endpoint_open(struct na_sm_endpoint *na_sm_endpoint, const char *username,
     /* Save listen state */
     na_sm_endpoint->listen = listen;
 
+    /* Initialize counters */
+    hg_atomic_init64(&na_sm_endpoint->counters.send_retries, 0);
+    hg_atomic_init64(&na_sm_endpoint->counters.rx_stalls, 0);
+    hg_atomic_init64(&na_sm_endpoint->counters.poll_wakeups, 0);
+    hg_atomic_init64(&na_sm_endpoint->counters.notify_wakeups, 0);
+
     /* Initialize queues */
     HG_QUEUE_INIT(&na_sm_endpoint->unexpected_msg_queue.queue);
     hg_thread_spin_init(&na_sm_endpoint->unexpected_msg_queue.lock);
+    na_sm_endpoint->unexpected_msg_queue.lock_prof =
+        hg_thread_lock_prof_register("na_sm.unexpected_msg_queue");
+    na_sm_endpoint->unexpected_msg_queue.count = 0;
+    na_sm_endpoint->unexpected_msg_queue.max_count = 0;
+    na_sm_endpoint->unexpected_msg_queue.total = 0;
 
     HG_QUEUE_INIT(&na_sm_endpoint->unexpected_op_queue.queue);
     hg_thread_spin_init(&na_sm_endpoint->unexpected_op_queue.lock);
+    na_sm_endpoint->unexpected_op_queue.lock_prof =
+        hg_thread_lock_prof_register("na_sm.unexpected_op_queue");
 
     HG_QUEUE_INIT(&na_sm_endpoint->expected_op_queue.queue);
     hg_thread_spin_init(&na_sm_endpoint->expected_op_queue.lock);
+    na_sm_endpoint->expected_op_queue.lock_prof =
+        hg_thread_lock_prof_register("na_sm.expected_op_queue");
+
+    HG_QUEUE_INIT(&na_sm_endpoint->expected_msg_queue.queue);
+    hg_thread_spin_init(&na_sm_endpoint->expected_msg_queue.lock);
+    na_sm_endpoint->expected_msg_queue.lock_prof =
+        hg_thread_lock_prof_register("na_sm.expected_msg_queue");
+    na_sm_endpoint->expected_msg_queue.count = 0;
+    na_sm_endpoint->expected_msg_queue.max_count = 0;
+    na_sm_endpoint->expected_msg_queue.total = 0;
+
+    memset(&na_sm_endpoint->canceled_recvs, 0,
+        sizeof(na_sm_endpoint->canceled_recvs));
 
     HG_QUEUE_INIT(&na_sm_endpoint->retry_op_queue.queue);
     hg_thread_spin_init(&na_sm_endpoint->retry_op_queue.lock);
+    na_sm_endpoint->retry_op_queue.lock_prof =
+        hg_thread_lock_prof_register("na_sm.retry_op_queue");
+    hg_atomic_init32(&na_sm_endpoint->retry_op_count, 0);
+    na_sm_endpoint->retry_pass = 0;
 
     /* Initialize poll addr list */
     HG_LIST_INIT(&na_sm_endpoint->poll_addr_list.list);
     hg_thread_spin_init(&na_sm_endpoint->poll_addr_list.lock);
+    na_sm_endpoint->poll_addr_list.lock_prof =
+        hg_thread_lock_prof_register("na_sm.poll_addr_list");
 
     /* Create addr hash-table */
     na_sm_endpoint->addr_map.map =
@@ -1879,6 +2059,12 @@ na_sm_endpoint_open(struct na_sm_endpoint *na_sm_endpoint, const char *username,
     hg_hash_table_register_free_functions(
         na_sm_endpoint->addr_map.map, free, free);
     hg_thread_rwlock_init(&na_sm_endpoint->addr_map.lock);
+    na_sm_endpoint->addr_map.lock_prof =
+        hg_thread_lock_prof_register("na_sm.addr_map");
+
+    /* Copy buffers live in shared memory, their profile is process-local and
+     * registration is idempotent */
+    na_sm_copy_buf_prof_g = hg_thread_lock_prof_register("na_sm.copy_buf");
 
     if (listen) {
         /* If we're listening, create a new shm region */
@@ -1966,6 +2152,7 @@ error:
     hg_thread_spin_destroy(&na_sm_endpoint->unexpected_msg_queue.lock);
     hg_thread_spin_destroy(&na_sm_endpoint->unexpected_op_queue.lock);
     hg_thread_spin_destroy(&na_sm_endpoint->expected_op_queue.lock);
+    hg_thread_spin_destroy(&na_sm_endpoint->expected_msg_queue.lock);
     hg_thread_spin_destroy(&na_sm_endpoint->retry_op_queue.lock);
     hg_thread_spin_destroy(&na_sm_endpoint->poll_addr_list.lock);
 
@@ -1981,15 +2168,43 @@ na_sm_endpoint_close(
     na_return_t ret = NA_SUCCESS;
     na_bool_t empty;
 
+    /* Discard early expected messages that were never matched (e.g., their
+     * operation was canceled) */
+    hg_thread_spin_lock_prof(&na_sm_endpoint->expected_msg_queue.lock,
+        na_sm_endpoint->expected_msg_queue.lock_prof);
+    while (!HG_QUEUE_IS_EMPTY(&na_sm_endpoint->expected_msg_queue.queue)) {
+        struct na_sm_unexpected_info *na_sm_unexpected_info =
+            HG_QUEUE_FIRST(&na_sm_endpoint->expected_msg_queue.queue);
+        HG_QUEUE_POP_HEAD(&na_sm_endpoint->expected_msg_queue.queue, entry);
+        na_sm_endpoint->expected_msg_queue.count--;
+        NA_LOG_DEBUG("Discarding unmatched expected msg (tag=%u)",
+            na_sm_unexpected_info->tag);
+        if (hg_atomic_decr32(&na_sm_unexpected_info->na_sm_addr->ref_count) ==
+            0) {
+            hg_thread_spin_lock_prof(&na_sm_endpoint->poll_addr_list.lock,
+                na_sm_endpoint->poll_addr_list.lock_prof);
+            HG_LIST_REMOVE(na_sm_unexpected_info->na_sm_addr, entry);
+            hg_thread_spin_unlock(&na_sm_endpoint->poll_addr_list.lock);
+            ret = na_sm_addr_destroy(
+                na_sm_endpoint, username, na_sm_unexpected_info->na_sm_addr);
+            NA_CHECK_ERROR_DONE(ret != NA_SUCCESS, "Could not destroy address");
+        }
+        free(na_sm_unexpected_info->buf);
+        free(na_sm_unexpected_info);
+    }
+    hg_thread_spin_unlock(&na_sm_endpoint->expected_msg_queue.lock);
+
     /* Check that poll addr list is empty */
-    hg_thread_spin_lock(&na_sm_endpoint->poll_addr_list.lock);
+    hg_thread_spin_lock_prof(&na_sm_endpoint->poll_addr_list.lock,
+        na_sm_endpoint->poll_addr_list.lock_prof);
     empty = HG_LIST_IS_EMPTY(&na_sm_endpoint->poll_addr_list.list);
     hg_thread_spin_unlock(&na_sm_endpoint->poll_addr_list.lock);
 
     if (!empty) {
         struct na_sm_addr *na_sm_addr;
 
-        hg_thread_spin_lock(&na_sm_endpoint->poll_addr_list.lock);
+        hg_thread_spin_lock_prof(&na_sm_endpoint->poll_addr_list.lock,
+            na_sm_endpoint->poll_addr_list.lock_prof);
         na_sm_addr = HG_LIST_FIRST(&na_sm_endpoint->poll_addr_list.list);
         while (na_sm_addr) {
             struct na_sm_addr *next = HG_LIST_NEXT(na_sm_addr, entry);
@@ -2009,28 +2224,32 @@ na_sm_endpoint_close(
         "Poll addr list should be empty");
 
     /* Check that unexpected message queue is empty */
-    hg_thread_spin_lock(&na_sm_endpoint->unexpected_msg_queue.lock);
+    hg_thread_spin_lock_prof(&na_sm_endpoint->unexpected_msg_queue.lock,
+        na_sm_endpoint->unexpected_msg_queue.lock_prof);
     empty = HG_QUEUE_IS_EMPTY(&na_sm_endpoint->unexpected_msg_queue.queue);
     hg_thread_spin_unlock(&na_sm_endpoint->unexpected_msg_queue.lock);
     NA_CHECK_ERROR(empty == NA_FALSE, done, ret, NA_BUSY,
         "Unexpected msg queue should be empty");
 
     /* Check that unexpected op queue is empty */
-    hg_thread_spin_lock(&na_sm_endpoint->unexpected_op_queue.lock);
+    hg_thread_spin_lock_prof(&na_sm_endpoint->unexpected_op_queue.lock,
+        na_sm_endpoint->unexpected_op_queue.lock_prof);
     empty = HG_QUEUE_IS_EMPTY(&na_sm_endpoint->unexpected_op_queue.queue);
     hg_thread_spin_unlock(&na_sm_endpoint->unexpected_op_queue.lock);
     NA_CHECK_ERROR(empty == NA_FALSE, done, ret, NA_BUSY,
         "Unexpected op queue should be empty");
 
     /* Check that expected op queue is empty */
-    hg_thread_spin_lock(&na_sm_endpoint->expected_op_queue.lock);
+    hg_thread_spin_lock_prof(&na_sm_endpoint->expected_op_queue.lock,
+        na_sm_endpoint->expected_op_queue.lock_prof);
     empty = HG_QUEUE_IS_EMPTY(&na_sm_endpoint->expected_op_queue.queue);
     hg_thread_spin_unlock(&na_sm_endpoint->expected_op_queue.lock);
     NA_CHECK_ERROR(empty == NA_FALSE, done, ret, NA_BUSY,
         "Expected op queue should be empty");
 
     /* Check that retry op queue is empty */
-    hg_thread_spin_lock(&na_sm_endpoint->retry_op_queue.lock);
+    hg_thread_spin_lock_prof(&na_sm_endpoint->retry_op_queue.lock,
+        na_sm_endpoint->retry_op_queue.lock_prof);
     empty = HG_QUEUE_IS_EMPTY(&na_sm_endpoint->retry_op_queue.queue);
     hg_thread_spin_unlock(&na_sm_endpoint->retry_op_queue.lock);
     NA_CHECK_ERROR(empty == NA_FALSE, done, ret, NA_BUSY,
@@ -2090,6 +2309,7 @@ na_sm_endpoint_close(
     hg_thread_spin_destroy(&na_sm_endpoint->unexpected_msg_queue.lock);
     hg_thread_spin_destroy(&na_sm_endpoint->unexpected_op_queue.lock);
     hg_thread_spin_destroy(&na_sm_endpoint->expected_op_queue.lock);
+    hg_thread_spin_destroy(&na_sm_endpoint->expected_msg_queue.lock);
     hg_thread_spin_destroy(&na_sm_endpoint->retry_op_queue.lock);
     hg_thread_spin_destroy(&na_sm_endpoint->poll_addr_list.lock);
 
@@ -2159,7 +2379,7 @@ na_sm_addr_map_lookup(struct na_sm_map *na_sm_map, na_uint64_t key)
     hg_hash_table_value_t value = NULL;
 
     /* Lookup key */
-    hg_thread_rwlock_rdlock(&na_sm_map->lock);
+    hg_thread_rwlock_rdlock_prof(&na_sm_map->lock, na_sm_map->lock_prof);
     value = hg_hash_table_lookup(na_sm_map->map, (hg_hash_table_key_t) &key);
     hg_thread_rwlock_release_rdlock(&na_sm_map->lock);
 
@@ -2179,7 +2399,7 @@ na_sm_addr_map_insert(struct na_sm_map *na_sm_map, na_uint64_t key,
     na_bool_t inserted = NA_FALSE;
     int rc;
 
-    hg_thread_rwlock_wrlock(&na_sm_map->lock);
+    hg_thread_rwlock_wrlock_prof(&na_sm_map->lock, na_sm_map->lock_prof);
 
     /* Look up again to prevent race between lock release/acquire */
     value = hg_hash_table_lookup(na_sm_map->map, key_ptr);
@@ -2293,7 +2513,8 @@ na_sm_addr_lookup_insert_cb(void *arg, struct na_sm_addr **addr)
     NA_CHECK_NA_ERROR(error, ret, "Could not allocate address");
 
     /* Add address to list of addresses to poll */
-    hg_thread_spin_lock(&args->endpoint->poll_addr_list.lock);
+    hg_thread_spin_lock_prof(&args->endpoint->poll_addr_list.lock,
+        args->endpoint->poll_addr_list.lock_prof);
     HG_LIST_INSERT_HEAD(
         &args->endpoint->poll_addr_list.list, na_sm_addr, entry);
     hg_thread_spin_unlock(&args->endpoint->poll_addr_list.lock);
@@ -2349,6 +2570,8 @@ na_sm_addr_create(struct na_sm_endpoint *na_sm_endpoint,
     memset(na_sm_addr, 0, sizeof(struct na_sm_addr));
     na_sm_addr->unexpected = unexpected;
     hg_atomic_init32(&na_sm_addr->ref_count, 1);
+    hg_atomic_init32(&na_sm_addr->retry_count, 0);
+    hg_atomic_init32(&na_sm_addr->rx_stalled, NA_SM_RX_RUNNING);
 
     /* Assign PID/ID */
     na_sm_addr->pid = pid;
@@ -2656,7 +2879,8 @@ static NA_INLINE void
 na_sm_buf_copy_to(struct na_sm_copy_buf *na_sm_copy_buf, unsigned int index,
     const void *src, size_t n)
 {
-    hg_thread_spin_lock(&na_sm_copy_buf->buf_locks[index]);
+    hg_thread_spin_lock_prof(&na_sm_copy_buf->buf_locks[index],
+        na_sm_copy_buf_prof_g);
     memcpy(na_sm_copy_buf->buf[index], src, n);
     hg_thread_spin_unlock(&na_sm_copy_buf->buf_locks[index]);
 }
@@ -2666,7 +2890,8 @@ static NA_INLINE void
 na_sm_buf_copy_from(struct na_sm_copy_buf *na_sm_copy_buf, unsigned int index,
     void *dest, size_t n)
 {
-    hg_thread_spin_lock(&na_sm_copy_buf->buf_locks[index]);
+    hg_thread_spin_lock_prof(&na_sm_copy_buf->buf_locks[index],
+        na_sm_copy_buf_prof_g);
     memcpy(dest, na_sm_copy_buf->buf[index], n);
     hg_thread_spin_unlock(&na_sm_copy_buf->buf_locks[index]);
 }
@@ -2759,7 +2984,8 @@ na_sm_process_cmd(struct na_sm_endpoint *na_sm_endpoint, const char *username,
                 done, ret, "Could not allocate unexpected address");
 
             /* Add address to list of addresses to poll */
-            hg_thread_spin_lock(&na_sm_endpoint->poll_addr_list.lock);
+            hg_thread_spin_lock_prof(&na_sm_endpoint->poll_addr_list.lock,
+                na_sm_endpoint->poll_addr_list.lock_prof);
             HG_LIST_INSERT_HEAD(
                 &na_sm_endpoint->poll_addr_list.list, na_sm_addr, entry);
             hg_thread_spin_unlock(&na_sm_endpoint->poll_addr_list.lock);
@@ -2770,7 +2996,8 @@ na_sm_process_cmd(struct na_sm_endpoint *na_sm_endpoint, const char *username,
             na_bool_t found = NA_FALSE;
 
             /* Find address from list of addresses to poll */
-            hg_thread_spin_lock(&na_sm_endpoint->poll_addr_list.lock);
+            hg_thread_spin_lock_prof(&na_sm_endpoint->poll_addr_list.lock,
+                na_sm_endpoint->poll_addr_list.lock_prof);
             HG_LIST_FOREACH (
                 na_sm_addr, &na_sm_endpoint->poll_addr_list.list, entry) {
                 if ((na_sm_addr->queue_pair_idx == cmd_hdr.hdr.pair_idx) &&
@@ -2798,7 +3025,8 @@ na_sm_process_cmd(struct na_sm_endpoint *na_sm_endpoint, const char *username,
                 na_sm_addr->id);
 
             /* Remove address from list of addresses to poll */
-            hg_thread_spin_lock(&na_sm_endpoint->poll_addr_list.lock);
+            hg_thread_spin_lock_prof(&na_sm_endpoint->poll_addr_list.lock,
+                na_sm_endpoint->poll_addr_list.lock_prof);
             HG_LIST_REMOVE(na_sm_addr, entry);
             hg_thread_spin_unlock(&na_sm_endpoint->poll_addr_list.lock);
 
@@ -2860,34 +3088,67 @@ na_sm_progress_rx_queue(struct na_sm_endpoint *na_sm_endpoint,
     na_sm_msg_hdr_t msg_hdr;
     na_return_t ret = NA_SUCCESS;
 
-    /* Look for message in rx queue */
-    if (!na_sm_msg_queue_pop(poll_addr->rx_queue, &msg_hdr)) {
-        *progressed = NA_FALSE;
-        goto done;
-    }
+    *progressed = NA_FALSE;
 
-    NA_LOG_DEBUG("Found msg in queue");
+    /* An expected msg that could not be buffered must be processed before
+     * any msg that follows it, only one thread retries it */
+    if (unlikely(hg_atomic_get32(&poll_addr->rx_stalled) != NA_SM_RX_RUNNING)) {
+        if (!hg_atomic_cas32(&poll_addr->rx_stalled, NA_SM_RX_STALLED,
+                NA_SM_RX_RESUMING))
+            goto done;
 
-    /* Process expected and unexpected messages */
-    switch (msg_hdr.hdr.type) {
-        case NA_CB_SEND_UNEXPECTED:
-            ret = na_sm_process_unexpected(&na_sm_endpoint->unexpected_op_queue,
-                poll_addr, msg_hdr, &na_sm_endpoint->unexpected_msg_queue);
-            NA_CHECK_NA_ERROR(
-                done, ret, "Could not make progress on unexpected msg");
-            break;
-        case NA_CB_SEND_EXPECTED:
-            ret = na_sm_process_expected(
-                &na_sm_endpoint->expected_op_queue, poll_addr, msg_hdr);
-            NA_CHECK_NA_ERROR(
-                done, ret, "Could not make progress on expected msg");
-            break;
-        default:
-            NA_GOTO_ERROR(
-                done, ret, NA_INVALID_ARG, "Unknown type of operation");
+        ret = na_sm_process_expected(&na_sm_endpoint->expected_op_queue,
+            poll_addr, poll_addr->rx_stalled_hdr,
+            &na_sm_endpoint->expected_msg_queue,
+            &na_sm_endpoint->canceled_recvs);
+        if (ret == NA_AGAIN) {
+            /* Still stalled */
+            ret = NA_SUCCESS;
+            goto done;
+        }
+        hg_atomic_set32(&poll_addr->rx_stalled, NA_SM_RX_RUNNING);
+        NA_CHECK_NA_ERROR(done, ret, "Could not make progress on expected msg");
+
+        *progressed = NA_TRUE;
     }
 
-    *progressed = NA_TRUE;
+    /* Notifications of several messages are coalesced, the thread that
+     * consumed the notification must therefore drain the rx queue, other
+     * threads may otherwise keep waiting with messages left in the queue */
+    while (hg_atomic_get32(&poll_addr->rx_stalled) == NA_SM_RX_RUNNING &&
+           na_sm_msg_queue_pop(poll_addr->rx_queue, &msg_hdr)) {
+        NA_LOG_DEBUG("Found msg in queue");
+
+        /* Process expected and unexpected messages */
+        switch (msg_hdr.hdr.type) {
+            case NA_CB_SEND_UNEXPECTED:
+                ret = na_sm_process_unexpected(
+                    &na_sm_endpoint->unexpected_op_queue, poll_addr, msg_hdr,
+                    &na_sm_endpoint->unexpected_msg_queue);
+                NA_CHECK_NA_ERROR(
+                    done, ret, "Could not make progress on unexpected msg");
+                break;
+            case NA_CB_SEND_EXPECTED:
+                ret = na_sm_process_expected(
+                    &na_sm_endpoint->expected_op_queue, poll_addr, msg_hdr,
+                    &na_sm_endpoint->expected_msg_queue,
+                    &na_sm_endpoint->canceled_recvs);
+                if (unlikely(ret == NA_AGAIN)) {
+                    /* Rx queue stalled, see na_sm_process_expected() */
+                    hg_atomic_incr64(&na_sm_endpoint->counters.rx_stalls);
+                    ret = NA_SUCCESS;
+                    goto done;
+                }
+                NA_CHECK_NA_ERROR(
+                    done, ret, "Could not make progress on expected msg");
+                break;
+            default:
+                NA_GOTO_ERROR(
+                    done, ret, NA_INVALID_ARG, "Unknown type of operation");
+        }
+
+        *progressed = NA_TRUE;
+    }
 
 done:
     return ret;
@@ -2906,7 +3167,8 @@ na_sm_process_unexpected(struct na_sm_op_queue *unexpected_op_queue,
     NA_LOG_DEBUG("Processing unexpected msg");
 
     /* Pop op ID from queue */
-    hg_thread_spin_lock(&unexpected_op_queue->lock);
+    hg_thread_spin_lock_prof(&unexpected_op_queue->lock,
+        unexpected_op_queue->lock_prof);
     na_sm_op_id = HG_QUEUE_FIRST(&unexpected_op_queue->queue);
     HG_QUEUE_POP_HEAD(&unexpected_op_queue->queue, entry);
     hg_atomic_and32(&na_sm_op_id->status, ~NA_SM_OP_QUEUED);
@@ -2960,9 +3222,13 @@ na_sm_process_unexpected(struct na_sm_op_queue *unexpected_op_queue,
 
         /* Otherwise push the unexpected message into our unexpected queue so
          * that we can treat it later when a recv_unexpected is posted */
-        hg_thread_spin_lock(&unexpected_msg_queue->lock);
+        hg_thread_spin_lock_prof(&unexpected_msg_queue->lock,
+            unexpected_msg_queue->lock_prof);
         HG_QUEUE_PUSH_TAIL(
             &unexpected_msg_queue->queue, na_sm_unexpected_info, entry);
+        if (++unexpected_msg_queue->count > unexpected_msg_queue->max_count)
+            unexpected_msg_queue->max_count = unexpected_msg_queue->count;
+        unexpected_msg_queue->total++;
         hg_thread_spin_unlock(&unexpected_msg_queue->lock);
     }
 
@@ -2977,97 +3243,250 @@ error:
 /*---------------------------------------------------------------------------*/
 static na_return_t
 na_sm_process_expected(struct na_sm_op_queue *expected_op_queue,
-    struct na_sm_addr *poll_addr, na_sm_msg_hdr_t msg_hdr)
+    struct na_sm_addr *poll_addr, na_sm_msg_hdr_t msg_hdr,
+    struct na_sm_unexpected_msg_queue *expected_msg_queue,
+    struct na_sm_canceled_recvs *canceled_recvs)
 {
+    struct na_sm_unexpected_info *na_sm_unexpected_info = NULL;
     struct na_sm_op_id *na_sm_op_id = NULL;
+    na_bool_t full;
     na_return_t ret = NA_SUCCESS;
 
     NA_LOG_DEBUG("Processing expected msg");
 
     /* Try to match addr/tag */
-    hg_thread_spin_lock(&expected_op_queue->lock);
+    hg_thread_spin_lock_prof(&expected_op_queue->lock,
+        expected_op_queue->lock_prof);
+    na_sm_op_id = na_sm_expected_op_match(
+        expected_op_queue, poll_addr, (na_tag_t) msg_hdr.hdr.tag);
+    if (likely(na_sm_op_id)) {
+        hg_thread_spin_unlock(&expected_op_queue->lock);
+
+        na_sm_op_id->info.msg.actual_buf_size = msg_hdr.hdr.buf_size;
+
+        /* Copy buffer */
+        na_sm_buf_copy_from(&poll_addr->shared_region->copy_bufs,
+            msg_hdr.hdr.buf_idx, na_sm_op_id->info.msg.buf.ptr,
+            msg_hdr.hdr.buf_size);
+
+        /* Release buffer */
+        na_sm_buf_release(
+            &poll_addr->shared_region->copy_bufs, msg_hdr.hdr.buf_idx);
+
+        /* Complete operation */
+        ret = na_sm_complete(na_sm_op_id, 0);
+        NA_CHECK_NA_ERROR(done, ret, "Could not complete operation");
+    } else if (unlikely(na_sm_canceled_recv_match(canceled_recvs, poll_addr,
+                   (na_tag_t) msg_hdr.hdr.tag))) {
+        /* Late message (e.g., response to an RPC that timed out), its recv
+         * was canceled and it would otherwise never be matched */
+        NA_LOG_DEBUG("Dropping late expected msg (tag=%u)",
+            (unsigned int) msg_hdr.hdr.tag);
+        canceled_recvs->dropped++;
+        hg_thread_spin_unlock(&expected_op_queue->lock);
+
+        na_sm_buf_release(
+            &poll_addr->shared_region->copy_bufs, msg_hdr.hdr.buf_idx);
+    } else {
+        /* Message arrived before the matching recv was posted (e.g., when a
+         * payload is split into several expected messages), keep a copy of it
+         * so that it can be matched by na_sm_msg_recv_expected(). The op queue
+         * lock is kept so that a concurrent post cannot miss it. */
+        hg_thread_spin_lock_prof(&expected_msg_queue->lock,
+            expected_msg_queue->lock_prof);
+        full = (expected_msg_queue->count >= NA_SM_EXPECTED_MSG_MAX);
+        hg_thread_spin_unlock(&expected_msg_queue->lock);
+        /* Keep the copy buffer of the msg and stop processing the rx queue
+         * of that peer until a recv is posted (see na_sm_msg_recv_expected()),
+         * the sender is held back once it runs out of copy buffers. The state
+         * is set under the op queue lock so that a concurrent post sees it. */
+        if (unlikely(full)) {
+            NA_LOG_DEBUG("Early expected msg queue is full, stalling rx queue "
+                         "(tag=%u)",
+                (unsigned int) msg_hdr.hdr.tag);
+            poll_addr->rx_stalled_hdr = msg_hdr;
+            hg_atomic_set32(&poll_addr->rx_stalled, NA_SM_RX_STALLED);
+            ret = NA_AGAIN;
+            goto unlock;
+        }
+
+        na_sm_unexpected_info = (struct na_sm_unexpected_info *) malloc(
+            sizeof(struct na_sm_unexpected_info));
+        NA_CHECK_ERROR(na_sm_unexpected_info == NULL, unlock, ret, NA_NOMEM,
+            "Could not allocate expected info");
+
+        na_sm_unexpected_info->na_sm_addr = poll_addr;
+        na_sm_unexpected_info->buf_size = (na_size_t) msg_hdr.hdr.buf_size;
+        na_sm_unexpected_info->tag = (na_tag_t) msg_hdr.hdr.tag;
+
+        /* Allocate buf */
+        na_sm_unexpected_info->buf = malloc(na_sm_unexpected_info->buf_size);
+        NA_CHECK_ERROR(na_sm_unexpected_info->buf == NULL, error, ret, NA_NOMEM,
+            "Could not allocate na_sm_unexpected_info buf");
+
+        /* Copy buffer */
+        na_sm_buf_copy_from(&poll_addr->shared_region->copy_bufs,
+            msg_hdr.hdr.buf_idx, na_sm_unexpected_info->buf,
+            msg_hdr.hdr.buf_size);
+
+        /* Release buffer */
+        na_sm_buf_release(
+            &poll_addr->shared_region->copy_bufs, msg_hdr.hdr.buf_idx);
+
+        /* Keep addr alive until the msg is discarded or matched, in which
+         * case the reference is handed over to the op ID */
+        hg_atomic_incr32(&poll_addr->ref_count);
+
+        hg_thread_spin_lock_prof(&expected_msg_queue->lock,
+            expected_msg_queue->lock_prof);
+        HG_QUEUE_PUSH_TAIL(
+            &expected_msg_queue->queue, na_sm_unexpected_info, entry);
+        if (++expected_msg_queue->count > expected_msg_queue->max_count)
+            expected_msg_queue->max_count = expected_msg_queue->count;
+        expected_msg_queue->total++;
+        hg_thread_spin_unlock(&expected_msg_queue->lock);
+
+        hg_thread_spin_unlock(&expected_op_queue->lock);
+    }
+
+done:
+    return ret;
+
+error:
+    free(na_sm_unexpected_info);
+unlock:
+    hg_thread_spin_unlock(&expected_op_queue->lock);
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static NA_INLINE struct na_sm_op_id *
+na_sm_expected_op_match(struct na_sm_op_queue *expected_op_queue,
+    struct na_sm_addr *na_sm_addr, na_tag_t tag)
+{
+    struct na_sm_op_id *na_sm_op_id = NULL;
+
     HG_QUEUE_FOREACH (na_sm_op_id, &expected_op_queue->queue, entry) {
-        if (na_sm_op_id->na_sm_addr == poll_addr &&
-            na_sm_op_id->info.msg.tag == msg_hdr.hdr.tag) {
+        if (na_sm_op_id->na_sm_addr == na_sm_addr &&
+            na_sm_op_id->info.msg.tag == tag) {
             HG_QUEUE_REMOVE(
                 &expected_op_queue->queue, na_sm_op_id, na_sm_op_id, entry);
             hg_atomic_and32(&na_sm_op_id->status, ~NA_SM_OP_QUEUED);
             break;
         }
     }
-    hg_thread_spin_unlock(&expected_op_queue->lock);
 
-    NA_CHECK_ERROR(
-        na_sm_op_id == NULL, done, ret, NA_INVALID_ARG, "Invalid operation ID");
-    /* Cannot have an already completed operation ID, TODO add sanity check */
+    return na_sm_op_id;
+}
 
-    na_sm_op_id->info.msg.actual_buf_size = msg_hdr.hdr.buf_size;
+/*---------------------------------------------------------------------------*/
+static NA_INLINE void
+na_sm_canceled_recv_add(struct na_sm_canceled_recvs *canceled_recvs,
+    struct na_sm_addr *na_sm_addr, na_tag_t tag)
+{
+    /* Oldest entry is overwritten, msgs that are later than that are left to
+     * the bound of the early expected msg queue */
+    canceled_recvs->entries[canceled_recvs->next].na_sm_addr = na_sm_addr;
+    canceled_recvs->entries[canceled_recvs->next].tag = tag;
+    canceled_recvs->next = (canceled_recvs->next + 1) % NA_SM_CANCELED_RECV_MAX;
+}
 
-    /* Copy buffer */
-    na_sm_buf_copy_from(&poll_addr->shared_region->copy_bufs,
-        msg_hdr.hdr.buf_idx, na_sm_op_id->info.msg.buf.ptr,
-        msg_hdr.hdr.buf_size);
+/*---------------------------------------------------------------------------*/
+static NA_INLINE void
+na_sm_canceled_recv_remove(struct na_sm_canceled_recvs *canceled_recvs,
+    struct na_sm_addr *na_sm_addr, na_tag_t tag)
+{
+    unsigned int i;
 
-    /* Release buffer */
-    na_sm_buf_release(
-        &poll_addr->shared_region->copy_bufs, msg_hdr.hdr.buf_idx);
+    for (i = 0; i < NA_SM_CANCELED_RECV_MAX; i++) {
+        if (canceled_recvs->entries[i].na_sm_addr == na_sm_addr &&
+            canceled_recvs->entries[i].tag == tag)
+            canceled_recvs->entries[i].na_sm_addr = NULL;
+    }
+}
 
-    /* Complete operation */
-    ret = na_sm_complete(na_sm_op_id, 0);
-    NA_CHECK_NA_ERROR(done, ret, "Could not complete operation");
+/*---------------------------------------------------------------------------*/
+static NA_INLINE na_bool_t
+na_sm_canceled_recv_match(struct na_sm_canceled_recvs *canceled_recvs,
+    struct na_sm_addr *na_sm_addr, na_tag_t tag)
+{
+    unsigned int i;
 
-done:
-    return ret;
+    for (i = 0; i < NA_SM_CANCELED_RECV_MAX; i++) {
+        if (canceled_recvs->entries[i].na_sm_addr == na_sm_addr &&
+            canceled_recvs->entries[i].tag == tag)
+            return NA_TRUE;
+    }
+
+    return NA_FALSE;
+}
+
+/*---------------------------------------------------------------------------*/
+static NA_INLINE void
+na_sm_op_retry(
+    struct na_sm_endpoint *na_sm_endpoint, struct na_sm_op_id *na_sm_op_id)
+{
+    struct na_sm_op_queue *retry_op_queue = &na_sm_endpoint->retry_op_queue;
+
+    NA_LOG_DEBUG("Pushing %p for retry", na_sm_op_id);
+
+    hg_atomic_incr64(&na_sm_endpoint->counters.send_retries);
+
+    hg_thread_spin_lock_prof(&retry_op_queue->lock, retry_op_queue->lock_prof);
+    HG_QUEUE_PUSH_TAIL(&retry_op_queue->queue, na_sm_op_id, entry);
+    hg_atomic_or32(&na_sm_op_id->status, NA_SM_OP_QUEUED);
+    hg_atomic_incr32(&na_sm_op_id->na_sm_addr->retry_count);
+    hg_atomic_incr32(&na_sm_endpoint->retry_op_count);
+    hg_thread_spin_unlock(&retry_op_queue->lock);
 }
 
 /*---------------------------------------------------------------------------*/
 static na_return_t
-na_sm_process_retries(struct na_sm_op_queue *retry_op_queue)
+na_sm_process_retries(struct na_sm_endpoint *na_sm_endpoint)
 {
-    struct na_sm_op_id *na_sm_op_id = NULL;
-    unsigned int buf_idx;
+    struct na_sm_op_queue *retry_op_queue = &na_sm_endpoint->retry_op_queue;
+    HG_QUEUE_HEAD(na_sm_op_id) completed_queue;
+    struct na_sm_op_id *na_sm_op_id, *next;
     na_return_t ret = NA_SUCCESS;
 
-    do {
+    if (hg_atomic_get32(&na_sm_endpoint->retry_op_count) == 0)
+        return ret;
+
+    /* Only one thread processes retries at a time, an op that has been
+     * pushed to the tx queue must not be sent again by another thread */
+    if (hg_thread_spin_try_lock(&retry_op_queue->lock) != HG_UTIL_SUCCESS)
+        return ret;
+
+    /* Ops are retried in order for a given destination, a destination that
+     * has no buffer left is skipped for the rest of the pass without
+     * blocking sends to other destinations */
+    HG_QUEUE_INIT(&completed_queue);
+    na_sm_endpoint->retry_pass++;
+    for (na_sm_op_id = HG_QUEUE_FIRST(&retry_op_queue->queue); na_sm_op_id;
+         na_sm_op_id = next) {
+        struct na_sm_addr *na_sm_addr = na_sm_op_id->na_sm_addr;
         na_sm_msg_hdr_t msg_hdr;
-        na_bool_t rc;
+        unsigned int buf_idx;
 
-        hg_thread_spin_lock(&retry_op_queue->lock);
-        na_sm_op_id = HG_QUEUE_FIRST(&retry_op_queue->queue);
-        hg_thread_spin_unlock(&retry_op_queue->lock);
+        next = HG_QUEUE_NEXT(na_sm_op_id, entry);
 
-        if (!na_sm_op_id)
-            break;
+        /* Canceled ops are removed from the queue by na_sm_cancel() */
+        if (na_sm_addr->retry_pass == na_sm_endpoint->retry_pass ||
+            (hg_atomic_get32(&na_sm_op_id->status) & NA_SM_OP_CANCELED))
+            continue;
 
         NA_LOG_DEBUG("Attempting to retry %p", na_sm_op_id);
 
         /* Try to reserve buffer atomically */
-        if (na_sm_buf_reserve(
-                &na_sm_op_id->na_sm_addr->shared_region->copy_bufs, &buf_idx) ==
-            NA_AGAIN)
-            break;
-
-        /* Successfully reserved a buffer, check that the operation has not
-         * been canceled in the meantime so that we can dequeue the op from
-         * the queue properly. */
-        hg_thread_spin_lock(&retry_op_queue->lock);
-
-        if ((hg_atomic_get32(&na_sm_op_id->status) & NA_SM_OP_CANCELED)) {
-            hg_thread_spin_unlock(&retry_op_queue->lock);
-            na_sm_buf_release(
-                &na_sm_op_id->na_sm_addr->shared_region->copy_bufs, buf_idx);
+        if (na_sm_buf_reserve(&na_sm_addr->shared_region->copy_bufs,
+                &buf_idx) == NA_AGAIN) {
+            na_sm_addr->retry_pass = na_sm_endpoint->retry_pass;
             continue;
         }
 
-        HG_QUEUE_REMOVE(
-            &retry_op_queue->queue, na_sm_op_id, na_sm_op_id, entry);
-        hg_atomic_and32(&na_sm_op_id->status, ~NA_SM_OP_QUEUED);
-
-        hg_thread_spin_unlock(&retry_op_queue->lock);
-
         /* Copy buffer */
-        na_sm_buf_copy_to(&na_sm_op_id->na_sm_addr->shared_region->copy_bufs,
-            buf_idx, na_sm_op_id->info.msg.buf.const_ptr,
+        na_sm_buf_copy_to(&na_sm_addr->shared_region->copy_bufs, buf_idx,
+            na_sm_op_id->info.msg.buf.const_ptr,
             na_sm_op_id->info.msg.buf_size);
 
         /* Post message to queue */
@@ -3076,29 +3495,42 @@ na_sm_process_retries(struct na_sm_op_queue *retry_op_queue)
         msg_hdr.hdr.buf_size = na_sm_op_id->info.msg.buf_size & 0xffff;
         msg_hdr.hdr.tag = na_sm_op_id->info.msg.tag;
 
-        rc = na_sm_msg_queue_push(na_sm_op_id->na_sm_addr->tx_queue, msg_hdr);
-        NA_CHECK_ERROR(rc == NA_FALSE, error, ret, NA_AGAIN, "Full queue");
+        if (unlikely(
+                na_sm_msg_queue_push(na_sm_addr->tx_queue, msg_hdr) ==
+                NA_FALSE)) {
+            /* Queue is full, keep op ID queued and try again later */
+            na_sm_buf_release(&na_sm_addr->shared_region->copy_bufs, buf_idx);
+            na_sm_addr->retry_pass = na_sm_endpoint->retry_pass;
+            continue;
+        }
+
+        HG_QUEUE_REMOVE(
+            &retry_op_queue->queue, na_sm_op_id, na_sm_op_id, entry);
+        hg_atomic_and32(&na_sm_op_id->status, ~NA_SM_OP_QUEUED);
+        hg_atomic_decr32(&na_sm_addr->retry_count);
+        hg_atomic_decr32(&na_sm_endpoint->retry_op_count);
+        HG_QUEUE_PUSH_TAIL(&completed_queue, na_sm_op_id, entry);
+    }
+    hg_thread_spin_unlock(&retry_op_queue->lock);
+
+    /* Complete outside of the lock */
+    while ((na_sm_op_id = HG_QUEUE_FIRST(&completed_queue)) != NULL) {
+        HG_QUEUE_POP_HEAD(&completed_queue, entry);
 
         /* Notify remote if notifications are enabled */
         if (na_sm_op_id->na_sm_addr->tx_notify > 0) {
-            ret = na_sm_event_set(na_sm_op_id->na_sm_addr->tx_notify);
-            NA_CHECK_NA_ERROR(
-                error, ret, "Could not send completion notification");
+            na_return_t notify_ret =
+                na_sm_event_set(na_sm_op_id->na_sm_addr->tx_notify);
+            NA_CHECK_ERROR_DONE(notify_ret != NA_SUCCESS,
+                "Could not send completion notification");
         }
 
-        /* Immediate completion, add directly to completion queue. */
+        /* Message was sent, add directly to completion queue */
         ret = na_sm_complete(na_sm_op_id, 0);
-        NA_CHECK_NA_ERROR(error, ret, "Could not complete operation");
-    } while (1);
-
-    return ret;
-
-error:
-    na_sm_buf_release(
-        &na_sm_op_id->na_sm_addr->shared_region->copy_bufs, buf_idx);
-    hg_atomic_decr32(&na_sm_op_id->na_sm_addr->ref_count);
-    hg_atomic_decr32(&na_sm_op_id->ref_count);
+        NA_CHECK_NA_ERROR(done, ret, "Could not complete operation");
+    }
 
+done:
     return ret;
 }
 
@@ -3150,6 +3582,10 @@ na_sm_complete(struct na_sm_op_id *na_sm_op_id, int notify)
         case NA_CB_SEND_EXPECTED:
             break;
         case NA_CB_RECV_EXPECTED:
+            callback_info->info.recv_expected.actual_buf_size =
+                (callback_info->ret == NA_SUCCESS)
+                    ? na_sm_op_id->info.msg.actual_buf_size
+                    : 0;
             break;
         case NA_CB_PUT:
             break;
@@ -3366,6 +3802,7 @@ na_sm_op_create(na_class_t *na_class)
     NA_CHECK_ERROR_NORET(
         na_sm_op_id == NULL, done, "Could not allocate NA SM operation ID");
     memset(na_sm_op_id, 0, sizeof(struct na_sm_op_id));
+    hg_mem_usage_add(HG_MEM_USAGE_NA_OP, sizeof(struct na_sm_op_id));
 
     na_sm_op_id->na_class = na_class;
     hg_atomic_init32(&na_sm_op_id->ref_count, 1);
@@ -3391,6 +3828,7 @@ na_sm_op_destroy(na_class_t NA_UNUSED *na_class, na_op_id_t op_id)
         goto done;
     }
     free(na_sm_op_id);
+    hg_mem_usage_sub(HG_MEM_USAGE_NA_OP, sizeof(struct na_sm_op_id));
 
 done:
     return NA_SUCCESS;
@@ -3466,7 +3904,8 @@ na_sm_addr_free(na_class_t *na_class, na_addr_t addr)
         "Freeing addr for PID=%d, ID=%d", na_sm_addr->pid, na_sm_addr->id);
 
     /* Remove address from list of addresses to poll */
-    hg_thread_spin_lock(&na_sm_endpoint->poll_addr_list.lock);
+    hg_thread_spin_lock_prof(&na_sm_endpoint->poll_addr_list.lock,
+        na_sm_endpoint->poll_addr_list.lock_prof);
     HG_LIST_REMOVE(na_sm_addr, entry);
     hg_thread_spin_unlock(&na_sm_endpoint->poll_addr_list.lock);
 
@@ -3651,6 +4090,15 @@ na_sm_msg_get_max_tag(const na_class_t NA_UNUSED *na_class)
     return NA_SM_MAX_TAG;
 }
 
+/*---------------------------------------------------------------------------*/
+static NA_INLINE na_bool_t
+na_sm_msg_has_early_expected(const na_class_t NA_UNUSED *na_class)
+{
+    /* Buffered by na_sm_process_expected(), the rx queue of a peer is drained
+     * in order and stops while the early msg queue is full */
+    return NA_TRUE;
+}
+
 /*---------------------------------------------------------------------------*/
 static na_return_t
 na_sm_msg_send_unexpected(na_class_t *na_class, na_context_t *context,
@@ -3694,20 +4142,16 @@ na_sm_msg_send_unexpected(na_class_t *na_class, na_context_t *context,
     na_sm_op_id->info.msg.actual_buf_size = buf_size;
     na_sm_op_id->info.msg.tag = tag;
 
-    /* Try to reserve buffer atomically */
-    ret = na_sm_buf_reserve(&na_sm_addr->shared_region->copy_bufs, &buf_idx);
+    /* Try to reserve buffer atomically, unless earlier sends to the same
+     * destination are still waiting for a buffer, in which case queue behind
+     * them so that message ordering is preserved */
+    if (unlikely(hg_atomic_get32(&na_sm_addr->retry_count) > 0))
+        ret = NA_AGAIN;
+    else
+        ret = na_sm_buf_reserve(
+            &na_sm_addr->shared_region->copy_bufs, &buf_idx);
     if (unlikely(ret == NA_AGAIN)) {
-        struct na_sm_op_queue *retry_op_queue =
-            &NA_SM_CLASS(na_class)->endpoint.retry_op_queue;
-
-        NA_LOG_DEBUG("Pushing %p for retry", na_sm_op_id);
-
-        /* Push op ID to retry queue */
-        hg_thread_spin_lock(&retry_op_queue->lock);
-        HG_QUEUE_PUSH_TAIL(&retry_op_queue->queue, na_sm_op_id, entry);
-        hg_atomic_or32(&na_sm_op_id->status, NA_SM_OP_QUEUED);
-        hg_thread_spin_unlock(&retry_op_queue->lock);
-
+        na_sm_op_retry(&NA_SM_CLASS(na_class)->endpoint, na_sm_op_id);
         ret = NA_SUCCESS;
     } else {
         na_sm_msg_hdr_t msg_hdr;
@@ -3727,7 +4171,12 @@ na_sm_msg_send_unexpected(na_class_t *na_class, na_context_t *context,
         msg_hdr.hdr.tag = tag;
 
         rc = na_sm_msg_queue_push(na_sm_addr->tx_queue, msg_hdr);
-        NA_CHECK_ERROR(rc == NA_FALSE, error, ret, NA_AGAIN, "Full queue");
+        if (unlikely(rc == NA_FALSE)) {
+            /* Queue is full, release buffer and retry later */
+            na_sm_buf_release(&na_sm_addr->shared_region->copy_bufs, buf_idx);
+            na_sm_op_retry(&NA_SM_CLASS(na_class)->endpoint, na_sm_op_id);
+            goto done;
+        }
 
         /* Notify remote if notifications are enabled */
         if (na_sm_addr->tx_notify > 0) {
@@ -3792,9 +4241,13 @@ na_sm_msg_recv_unexpected(na_class_t *na_class, na_context_t *context,
     na_sm_op_id->info.msg.buf_size = buf_size;
 
     /* Look for an unexpected message already received */
-    hg_thread_spin_lock(&unexpected_msg_queue->lock);
+    hg_thread_spin_lock_prof(&unexpected_msg_queue->lock,
+        unexpected_msg_queue->lock_prof);
     na_sm_unexpected_info = HG_QUEUE_FIRST(&unexpected_msg_queue->queue);
-    HG_QUEUE_POP_HEAD(&unexpected_msg_queue->queue, entry);
+    if (unlikely(na_sm_unexpected_info)) {
+        HG_QUEUE_POP_HEAD(&unexpected_msg_queue->queue, entry);
+        unexpected_msg_queue->count--;
+    }
     hg_thread_spin_unlock(&unexpected_msg_queue->lock);
     if (unlikely(na_sm_unexpected_info)) {
         na_sm_op_id->na_sm_addr = na_sm_unexpected_info->na_sm_addr;
@@ -3820,7 +4273,8 @@ na_sm_msg_recv_unexpected(na_class_t *na_class, na_context_t *context,
         na_sm_op_id->info.msg.tag = 0;
 
         /* Nothing has been received yet so add op_id to progress queue */
-        hg_thread_spin_lock(&unexpected_op_queue->lock);
+        hg_thread_spin_lock_prof(&unexpected_op_queue->lock,
+            unexpected_op_queue->lock_prof);
         HG_QUEUE_PUSH_TAIL(&unexpected_op_queue->queue, na_sm_op_id, entry);
         hg_atomic_or32(&na_sm_op_id->status, NA_SM_OP_QUEUED);
         hg_thread_spin_unlock(&unexpected_op_queue->lock);
@@ -3879,20 +4333,16 @@ na_sm_msg_send_expected(na_class_t *na_class, na_context_t *context,
     na_sm_op_id->info.msg.actual_buf_size = buf_size;
     na_sm_op_id->info.msg.tag = tag;
 
-    /* Try to reserve buffer atomically */
-    ret = na_sm_buf_reserve(&na_sm_addr->shared_region->copy_bufs, &buf_idx);
+    /* Try to reserve buffer atomically, unless earlier sends to the same
+     * destination are still waiting for a buffer, in which case queue behind
+     * them so that message ordering is preserved */
+    if (unlikely(hg_atomic_get32(&na_sm_addr->retry_count) > 0))
+        ret = NA_AGAIN;
+    else
+        ret = na_sm_buf_reserve(
+            &na_sm_addr->shared_region->copy_bufs, &buf_idx);
     if (unlikely(ret == NA_AGAIN)) {
-        struct na_sm_op_queue *retry_op_queue =
-            &NA_SM_CLASS(na_class)->endpoint.retry_op_queue;
-
-        NA_LOG_DEBUG("Pushing %p for retry", na_sm_op_id);
-
-        /* Push op ID to retry queue */
-        hg_thread_spin_lock(&retry_op_queue->lock);
-        HG_QUEUE_PUSH_TAIL(&retry_op_queue->queue, na_sm_op_id, entry);
-        hg_atomic_or32(&na_sm_op_id->status, NA_SM_OP_QUEUED);
-        hg_thread_spin_unlock(&retry_op_queue->lock);
-
+        na_sm_op_retry(&NA_SM_CLASS(na_class)->endpoint, na_sm_op_id);
         ret = NA_SUCCESS;
     } else {
         na_sm_msg_hdr_t msg_hdr;
@@ -3912,7 +4362,12 @@ na_sm_msg_send_expected(na_class_t *na_class, na_context_t *context,
         msg_hdr.hdr.tag = tag;
 
         rc = na_sm_msg_queue_push(na_sm_addr->tx_queue, msg_hdr);
-        NA_CHECK_ERROR(rc == NA_FALSE, error, ret, NA_AGAIN, "Full queue");
+        if (unlikely(rc == NA_FALSE)) {
+            /* Queue is full, release buffer and retry later */
+            na_sm_buf_release(&na_sm_addr->shared_region->copy_bufs, buf_idx);
+            na_sm_op_retry(&NA_SM_CLASS(na_class)->endpoint, na_sm_op_id);
+            goto done;
+        }
 
         /* Notify remote if notifications are enabled */
         if (na_sm_addr->tx_notify > 0) {
@@ -3948,8 +4403,12 @@ na_sm_msg_recv_expected(na_class_t *na_class, na_context_t *context,
 {
     struct na_sm_op_queue *expected_op_queue =
         &NA_SM_CLASS(na_class)->endpoint.expected_op_queue;
+    struct na_sm_unexpected_msg_queue *expected_msg_queue =
+        &NA_SM_CLASS(na_class)->endpoint.expected_msg_queue;
+    struct na_sm_unexpected_info *na_sm_unexpected_info = NULL;
     struct na_sm_op_id *na_sm_op_id = NULL;
     struct na_sm_addr *na_sm_addr = (struct na_sm_addr *) source_addr;
+    na_bool_t stalled;
     na_return_t ret = NA_SUCCESS;
 
     NA_CHECK_ERROR(buf_size > NA_SM_EXPECTED_SIZE, done, ret, NA_OVERFLOW,
@@ -3972,7 +4431,8 @@ na_sm_msg_recv_expected(na_class_t *na_class, na_context_t *context,
     na_sm_op_id->completion_data.callback_info.type = NA_CB_RECV_EXPECTED;
     na_sm_op_id->completion_data.callback = callback;
     na_sm_op_id->completion_data.callback_info.arg = arg;
-    hg_atomic_incr32(&na_sm_addr->ref_count);
+    /* Addr reference of the op ID is taken below, it is released by
+     * na_sm_release() once the op completes */
     na_sm_op_id->na_sm_addr = na_sm_addr;
     hg_atomic_set32(&na_sm_op_id->status, 0);
     na_sm_op_id->info.msg.buf.ptr = buf;
@@ -3980,16 +4440,78 @@ na_sm_msg_recv_expected(na_class_t *na_class, na_context_t *context,
     na_sm_op_id->info.msg.actual_buf_size = 0;
     na_sm_op_id->info.msg.tag = tag;
 
-    /* Expected messages must always be pre-posted, therefore a message should
-     * never arrive before that call returns (not completes), simply add
-     * op_id to queue */
-    hg_thread_spin_lock(&expected_op_queue->lock);
-    HG_QUEUE_PUSH_TAIL(&expected_op_queue->queue, na_sm_op_id, entry);
-    hg_atomic_or32(&na_sm_op_id->status, NA_SM_OP_QUEUED);
+    /* Expected messages are usually pre-posted, a message may however arrive
+     * early, in which case it has been buffered by na_sm_process_expected(),
+     * look for it first (in arrival order) before adding op_id to queue */
+    hg_thread_spin_lock_prof(&expected_op_queue->lock,
+        expected_op_queue->lock_prof);
+    hg_thread_spin_lock_prof(&expected_msg_queue->lock,
+        expected_msg_queue->lock_prof);
+    if (unlikely(!HG_QUEUE_IS_EMPTY(&expected_msg_queue->queue))) {
+        HG_QUEUE_FOREACH (
+            na_sm_unexpected_info, &expected_msg_queue->queue, entry) {
+            if (na_sm_unexpected_info->na_sm_addr == na_sm_addr &&
+                na_sm_unexpected_info->tag == tag) {
+                HG_QUEUE_REMOVE(&expected_msg_queue->queue,
+                    na_sm_unexpected_info, na_sm_unexpected_info, entry);
+                expected_msg_queue->count--;
+                break;
+            }
+        }
+    }
+    hg_thread_spin_unlock(&expected_msg_queue->lock);
+    if (likely(na_sm_unexpected_info == NULL)) {
+        /* Tag is in use again, msgs matching it are no longer late */
+        na_sm_canceled_recv_remove(
+            &NA_SM_CLASS(na_class)->endpoint.canceled_recvs, na_sm_addr, tag);
+        /* Queued op ID holds its own reference, take it before the op can be
+         * matched and completed by na_sm_process_expected() */
+        hg_atomic_incr32(&na_sm_addr->ref_count);
+        HG_QUEUE_PUSH_TAIL(&expected_op_queue->queue, na_sm_op_id, entry);
+        hg_atomic_or32(&na_sm_op_id->status, NA_SM_OP_QUEUED);
+    }
+    /* Either a slot was freed in the early msg queue or the stalled msg may
+     * match the new recv, progress must retry it */
+    stalled = (hg_atomic_get32(&na_sm_addr->rx_stalled) != NA_SM_RX_RUNNING);
     hg_thread_spin_unlock(&expected_op_queue->lock);
 
+    if (unlikely(stalled) && na_sm_addr->rx_notify > 0) {
+        na_return_t wakeup_ret = na_sm_event_set(na_sm_addr->rx_notify);
+        NA_CHECK_WARNING(
+            wakeup_ret != NA_SUCCESS, "Could not wake up stalled rx queue");
+    }
+
+    if (unlikely(na_sm_unexpected_info)) {
+        na_sm_op_id->info.msg.actual_buf_size =
+            (na_sm_unexpected_info->buf_size < buf_size)
+                ? na_sm_unexpected_info->buf_size
+                : buf_size;
+
+        /* Copy buffers */
+        memcpy(na_sm_op_id->info.msg.buf.ptr, na_sm_unexpected_info->buf,
+            na_sm_op_id->info.msg.actual_buf_size);
+
+        /* The reference that na_sm_process_expected() took for the early msg
+         * is handed over to the op ID, no new reference is taken */
+        free(na_sm_unexpected_info->buf);
+        free(na_sm_unexpected_info);
+
+        ret = na_sm_complete(na_sm_op_id,
+            NA_SM_CLASS(na_class)->endpoint.source_addr->tx_notify);
+        NA_CHECK_NA_ERROR(error, ret, "Could not complete operation");
+    }
+
 done:
     return ret;
+
+error:
+    /* Only reached once an early msg was matched, the op ID then owns the
+     * single addr reference handed over from that msg */
+    na_sm_addr_free(na_class, (na_addr_t) na_sm_op_id->na_sm_addr);
+    na_sm_op_id->na_sm_addr = NULL;
+    hg_atomic_decr32(&na_sm_op_id->ref_count);
+
+    return ret;
 }
 
 /*---------------------------------------------------------------------------*/
@@ -4497,11 +5019,20 @@ na_sm_poll_try_wait(na_class_t *na_class, na_context_t NA_UNUSED *context)
 {
     struct na_sm_addr *na_sm_addr;
 
-    /* Check whether something is in one of the rx queues */
-    hg_thread_spin_lock(&NA_SM_CLASS(na_class)->endpoint.poll_addr_list.lock);
+    /* Sends waiting for a buffer are only retried from progress, the remote
+     * does not notify when buffers are released */
+    if (hg_atomic_get32(&NA_SM_CLASS(na_class)->endpoint.retry_op_count) > 0)
+        return NA_FALSE;
+
+    /* Check whether something is in one of the rx queues, stalled queues are
+     * only resumed once a recv is posted, which signals their rx notify */
+    hg_thread_spin_lock_prof(
+        &NA_SM_CLASS(na_class)->endpoint.poll_addr_list.lock,
+        NA_SM_CLASS(na_class)->endpoint.poll_addr_list.lock_prof);
     HG_LIST_FOREACH (na_sm_addr,
         &NA_SM_CLASS(na_class)->endpoint.poll_addr_list.list, entry) {
-        if (!na_sm_msg_queue_is_empty(na_sm_addr->rx_queue)) {
+        if (hg_atomic_get32(&na_sm_addr->rx_stalled) != NA_SM_RX_STALLED &&
+            !na_sm_msg_queue_is_empty(na_sm_addr->rx_queue)) {
             hg_thread_spin_unlock(
                 &NA_SM_CLASS(na_class)->endpoint.poll_addr_list.lock);
             return NA_FALSE;
@@ -4541,6 +5072,8 @@ na_sm_progress(
                 &nevents);
             NA_CHECK_ERROR(rc != HG_UTIL_SUCCESS, done, ret,
                 na_sm_errno_to_na(errno), "hg_poll_wait() failed");
+            if (nevents > 0)
+                hg_atomic_incr64(&na_sm_endpoint->counters.poll_wakeups);
 
             /* Process events */
             for (i = 0; i < nevents; i++) {
@@ -4586,15 +5119,49 @@ na_sm_progress(
                             *(na_sm_poll_type_t *) events[i].data.ptr);
                 }
 
+                if (progressed_notify && poll_addr)
+                    hg_atomic_incr64(&na_sm_endpoint->counters.notify_wakeups);
                 progressed |= (progressed_rx | progressed_notify);
             }
+
+            /* na_sm_poll_try_wait() prevents blocking while an rx queue is
+             * not empty, the notification of these messages may however
+             * already have been consumed by another thread, make sure that
+             * they are processed so that callers do not spin */
+            if (nevents == 0) {
+                struct na_sm_addr_list *poll_addr_list =
+                    &na_sm_endpoint->poll_addr_list;
+                struct na_sm_addr *poll_addr;
+
+                hg_thread_spin_lock_prof(&poll_addr_list->lock,
+                    poll_addr_list->lock_prof);
+                HG_LIST_FOREACH (poll_addr, &poll_addr_list->list, entry) {
+                    na_bool_t progressed_rx = NA_FALSE;
+
+                    if (na_sm_msg_queue_is_empty(poll_addr->rx_queue) ||
+                        hg_atomic_get32(&poll_addr->rx_stalled) ==
+                            NA_SM_RX_STALLED)
+                        continue;
+
+                    hg_thread_spin_unlock(&poll_addr_list->lock);
+                    ret = na_sm_progress_rx_queue(
+                        na_sm_endpoint, poll_addr, &progressed_rx);
+                    NA_CHECK_NA_ERROR(
+                        done, ret, "Could not progress rx queue");
+                    progressed |= progressed_rx;
+                    hg_thread_spin_lock_prof(&poll_addr_list->lock,
+                        poll_addr_list->lock_prof);
+                }
+                hg_thread_spin_unlock(&poll_addr_list->lock);
+            }
         } else {
             struct na_sm_addr_list *poll_addr_list =
                 &na_sm_endpoint->poll_addr_list;
             struct na_sm_addr *poll_addr;
 
             /* Check whether something is in one of the rx queues */
-            hg_thread_spin_lock(&poll_addr_list->lock);
+            hg_thread_spin_lock_prof(&poll_addr_list->lock,
+                poll_addr_list->lock_prof);
             HG_LIST_FOREACH (poll_addr, &poll_addr_list->list, entry) {
                 na_bool_t progressed_rx = NA_FALSE;
 
@@ -4606,6 +5173,9 @@ na_sm_progress(
                         na_sm_progress_rx_notify(poll_addr, &progressed_notify);
                     NA_CHECK_NA_ERROR(
                         done, ret, "Could not progress rx notify");
+                    if (progressed_notify)
+                        hg_atomic_incr64(
+                            &na_sm_endpoint->counters.notify_wakeups);
                     progressed |= progressed_notify;
                 }
                 ret = na_sm_progress_rx_queue(
@@ -4613,7 +5183,8 @@ na_sm_progress(
                 NA_CHECK_NA_ERROR(done, ret, "Could not progress rx queue");
                 progressed |= progressed_rx;
 
-                hg_thread_spin_lock(&poll_addr_list->lock);
+                hg_thread_spin_lock_prof(&poll_addr_list->lock,
+                    poll_addr_list->lock_prof);
             }
             hg_thread_spin_unlock(&poll_addr_list->lock);
 
@@ -4648,7 +5219,7 @@ na_sm_progress(
         }
 
         /* Process retries */
-        ret = na_sm_process_retries(&na_sm_endpoint->retry_op_queue);
+        ret = na_sm_process_retries(na_sm_endpoint);
         NA_CHECK_NA_ERROR(done, ret, "Could not process retried msgs");
 
         if (timeout) {
@@ -4715,6 +5286,16 @@ na_sm_cancel(
         if (hg_atomic_get32(&na_sm_op_id->status) & NA_SM_OP_QUEUED) {
             HG_QUEUE_REMOVE(&op_queue->queue, na_sm_op_id, na_sm_op_id, entry);
             hg_atomic_and32(&na_sm_op_id->status, ~NA_SM_OP_QUEUED);
+            if (op_queue == &NA_SM_CLASS(na_class)->endpoint.retry_op_queue) {
+                hg_atomic_decr32(&na_sm_op_id->na_sm_addr->retry_count);
+                hg_atomic_decr32(
+                    &NA_SM_CLASS(na_class)->endpoint.retry_op_count);
+            } else if (op_queue ==
+                       &NA_SM_CLASS(na_class)->endpoint.expected_op_queue)
+                /* Msg may still be sent by the remote */
+                na_sm_canceled_recv_add(
+                    &NA_SM_CLASS(na_class)->endpoint.canceled_recvs,
+                    na_sm_op_id->na_sm_addr, na_sm_op_id->info.msg.tag);
             canceled = NA_TRUE;
         }
         hg_thread_spin_unlock(&op_queue->lock);
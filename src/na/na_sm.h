@@ -23,6 +23,28 @@ typedef unsigned char na_sm_id_t[16];
 typedef long na_sm_id_t;
 #endif
 
+/* SM counters (see NA_SM_Get_stats()) */
+struct na_sm_stats {
+    na_uint64_t send_retries;          /* Sends delayed by copy buffer or
+                                          queue exhaustion (NA_AGAIN) */
+    na_uint64_t unexpected_queued;     /* Unexpected msgs received before a
+                                          recv was posted */
+    na_uint64_t unexpected_depth;      /* Current depth of unexpected queue */
+    na_uint64_t unexpected_depth_max;  /* Max depth of unexpected queue */
+    na_uint64_t early_expected_queued; /* Expected msgs received before a
+                                          recv was posted */
+    na_uint64_t early_expected_depth;  /* Current depth of early expected
+                                          queue */
+    na_uint64_t early_expected_max;    /* Max depth of early expected queue,
+                                          rx queues stall beyond it */
+    na_uint64_t rx_stalls;             /* Rx queues stalled because the early
+                                          expected queue was full */
+    na_uint64_t late_expected_dropped; /* Expected msgs dropped because their
+                                          recv was canceled */
+    na_uint64_t poll_wakeups;          /* Poll waits that returned events */
+    na_uint64_t notify_wakeups;        /* Notifications consumed */
+};
+
 /*****************/
 /* Public Macros */
 /*****************/
@@ -94,6 +116,18 @@ NA_SM_Host_id_copy(na_sm_id_t *dst, na_sm_id_t src);
 NA_PUBLIC na_bool_t
 NA_SM_Host_id_cmp(na_sm_id_t id1, na_sm_id_t id2);
 
+/**
+ * Get counters of an SM class. Counters are cumulative since the class was
+ * initialized.
+ *
+ * \param na_class [IN]         pointer to NA class (must be an SM class)
+ * \param stats [OUT]           pointer to stats
+ *
+ * \return NA_SUCCESS or corresponding NA error code
+ */
+NA_PUBLIC na_return_t
+NA_SM_Get_stats(na_class_t *na_class, struct na_sm_stats *stats);
+
 #ifdef __cplusplus
 }
 #endif
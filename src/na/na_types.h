@@ -90,10 +90,15 @@ struct na_cb_info_recv_unexpected {
     na_tag_t tag;
 };
 
+struct na_cb_info_recv_expected {
+    na_size_t actual_buf_size;
+};
+
 /* Callback info struct */
 struct na_cb_info {
     union { /* Union of callback info structures */
         struct na_cb_info_recv_unexpected recv_unexpected;
+        struct na_cb_info_recv_expected recv_expected;
     } info;
     void *arg;         /* User data */
     na_cb_type_t type; /* Callback type */
@@ -133,6 +138,7 @@ typedef int (*na_cb_t)(const struct na_cb_info *callback_info);
 /* Progress modes */
 #define NA_NO_BLOCK 0x01 /*!< no blocking progress */
 #define NA_NO_RETRY 0x02 /*!< no retry of operations in progress */
+#define NA_SINGLE_THREAD 0x04 /*!< single-threaded use, no locking */
 
 /* NA init info initializer */
 #define NA_INIT_INFO_INITIALIZER                                               \
@@ -55,6 +55,21 @@ typedef struct {
 #    error "Not supported on this platform."
 #endif
 
+/* For busy loop spinning */
+#ifndef cpu_spinwait
+#    if defined(_WIN32)
+#        define cpu_spinwait YieldProcessor
+#    elif defined(__x86_64__) || defined(__i386__)
+#        include <immintrin.h>
+#        define cpu_spinwait _mm_pause
+#    elif defined(__arm__)
+#        define cpu_spinwait() __asm__ __volatile__("yield")
+#    else
+#        warning "Processor yield is not supported on this architecture."
+#        define cpu_spinwait(x)
+#    endif
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
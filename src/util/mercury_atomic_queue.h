@@ -43,20 +43,12 @@
 
 #include "mercury_atomic.h"
 #include "mercury_mem.h"
+#include "mercury_thread.h"
 
-/* For busy loop spinning */
-#ifndef cpu_spinwait
-#    if defined(_WIN32)
-#        define cpu_spinwait YieldProcessor
-#    elif defined(__x86_64__) || defined(__i386__)
-#        include <immintrin.h>
-#        define cpu_spinwait _mm_pause
-#    elif defined(__arm__)
-#        define cpu_spinwait() __asm__ __volatile__("yield")
-#    else
-#        warning "Processor yield is not supported on this architecture."
-#        define cpu_spinwait(x)
-#    endif
+/* Number of spins before yielding while waiting for a preceding enqueue or
+ * dequeue to complete */
+#ifndef HG_ATOMIC_QUEUE_SPIN_COUNT
+#    define HG_ATOMIC_QUEUE_SPIN_COUNT 128
 #endif
 
 /*************************************/
@@ -163,6 +155,7 @@ static HG_UTIL_INLINE int
 hg_atomic_queue_push(struct hg_atomic_queue *hg_atomic_queue, void *entry)
 {
     hg_util_int32_t prod_head, prod_next, cons_tail;
+    unsigned int spins = 0;
 
     do {
         prod_head = hg_atomic_get32(&hg_atomic_queue->prod_head);
@@ -187,10 +180,13 @@ hg_atomic_queue_push(struct hg_atomic_queue *hg_atomic_queue, void *entry)
     /*
      * If there are other enqueues in progress
      * that preceded us, we need to wait for them
-     * to complete
+     * to complete, a preempted thread must be given a chance to run
      */
-    while (hg_atomic_get32(&hg_atomic_queue->prod_tail) != prod_head)
+    while (hg_atomic_get32(&hg_atomic_queue->prod_tail) != prod_head) {
         cpu_spinwait();
+        if (++spins % HG_ATOMIC_QUEUE_SPIN_COUNT == 0)
+            hg_thread_yield();
+    }
 
     hg_atomic_set32(&hg_atomic_queue->prod_tail, prod_next);
 
@@ -202,6 +198,7 @@ static HG_UTIL_INLINE void *
 hg_atomic_queue_pop_mc(struct hg_atomic_queue *hg_atomic_queue)
 {
     hg_util_int32_t cons_head, cons_next;
+    unsigned int spins = 0;
     void *entry = NULL;
 
     do {
@@ -218,10 +215,13 @@ hg_atomic_queue_pop_mc(struct hg_atomic_queue *hg_atomic_queue)
     /*
      * If there are other dequeues in progress
      * that preceded us, we need to wait for them
-     * to complete
+     * to complete, a preempted thread must be given a chance to run
      */
-    while (hg_atomic_get32(&hg_atomic_queue->cons_tail) != cons_head)
+    while (hg_atomic_get32(&hg_atomic_queue->cons_tail) != cons_head) {
         cpu_spinwait();
+        if (++spins % HG_ATOMIC_QUEUE_SPIN_COUNT == 0)
+            hg_thread_yield();
+    }
 
     hg_atomic_set32(&hg_atomic_queue->cons_tail, cons_next);
 
@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#include "mercury_eventcount.h"
+
+#include "mercury_util_error.h"
+
+#ifdef HG_EVENTCOUNT_HAS_FUTEX
+#    include <errno.h>
+#    include <limits.h>
+#    include <linux/futex.h>
+#    include <stdint.h>
+#    include <sys/syscall.h>
+#    include <time.h>
+#    include <unistd.h>
+#endif
+
+/****************/
+/* Local Macros */
+/****************/
+
+#ifdef HG_EVENTCOUNT_HAS_FUTEX
+/* Atomic 32-bit integers have the layout of an int */
+#    define HG_EVENTCOUNT_FUTEX_ADDR(x) ((int *) (uintptr_t) (x))
+#endif
+
+/*---------------------------------------------------------------------------*/
+int
+hg_eventcount_init(hg_eventcount_t *ec)
+{
+    int ret = HG_UTIL_SUCCESS;
+
+    hg_atomic_init32(&ec->epoch, 0);
+    hg_atomic_init32(&ec->waiters, 0);
+#ifndef HG_EVENTCOUNT_HAS_FUTEX
+    ret = hg_thread_mutex_init(&ec->mutex);
+    HG_UTIL_CHECK_ERROR_NORET(
+        ret != HG_UTIL_SUCCESS, done, "Could not initialize mutex");
+
+    ret = hg_thread_cond_init(&ec->cond);
+    HG_UTIL_CHECK_ERROR_NORET(
+        ret != HG_UTIL_SUCCESS, done, "Could not initialize thread condition");
+
+done:
+#endif
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+int
+hg_eventcount_destroy(hg_eventcount_t *ec)
+{
+    int ret = HG_UTIL_SUCCESS;
+
+#ifndef HG_EVENTCOUNT_HAS_FUTEX
+    ret = hg_thread_mutex_destroy(&ec->mutex);
+    HG_UTIL_CHECK_ERROR_NORET(
+        ret != HG_UTIL_SUCCESS, done, "Could not destroy mutex");
+
+    ret = hg_thread_cond_destroy(&ec->cond);
+    HG_UTIL_CHECK_ERROR_NORET(
+        ret != HG_UTIL_SUCCESS, done, "Could not destroy thread condition");
+
+done:
+#else
+    (void) ec;
+#endif
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_util_int32_t
+hg_eventcount_prepare_wait(hg_eventcount_t *ec)
+{
+    hg_util_int32_t key = hg_atomic_get32(&ec->epoch);
+
+    hg_atomic_incr32(&ec->waiters);
+    /* Make waiter visible before the condition is checked again */
+    HG_EVENTCOUNT_MB();
+
+    return key;
+}
+
+/*---------------------------------------------------------------------------*/
+int
+hg_eventcount_commit_wait(
+    hg_eventcount_t *ec, hg_util_int32_t key, unsigned int timeout)
+{
+    int ret = HG_UTIL_SUCCESS;
+#ifdef HG_EVENTCOUNT_HAS_FUTEX
+    struct timespec ts, *ts_ptr = NULL;
+
+    if (timeout != HG_EVENTCOUNT_INFINITE) {
+        ts.tv_sec = (time_t) (timeout / 1000);
+        ts.tv_nsec = (long) (timeout % 1000) * 1000000L;
+        ts_ptr = &ts;
+    }
+
+    /* Returns immediately (EAGAIN) if epoch is no longer key */
+    if (syscall(SYS_futex, HG_EVENTCOUNT_FUTEX_ADDR(&ec->epoch),
+            FUTEX_WAIT_PRIVATE, key, ts_ptr, NULL, 0) == -1 &&
+        errno == ETIMEDOUT)
+        ret = HG_UTIL_FAIL;
+#else
+    hg_thread_mutex_lock(&ec->mutex);
+    if (hg_atomic_get32(&ec->epoch) == key) {
+        if (timeout == HG_EVENTCOUNT_INFINITE)
+            ret = hg_thread_cond_wait(&ec->cond, &ec->mutex);
+        else
+            ret = hg_thread_cond_timedwait(&ec->cond, &ec->mutex, timeout);
+        if (ret != HG_UTIL_SUCCESS && hg_atomic_get32(&ec->epoch) != key)
+            ret = HG_UTIL_SUCCESS; /* Notified while timing out */
+    }
+    hg_thread_mutex_unlock(&ec->mutex);
+#endif
+    hg_atomic_decr32(&ec->waiters);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_eventcount_wake(hg_eventcount_t *ec, hg_util_bool_t all)
+{
+#ifdef HG_EVENTCOUNT_HAS_FUTEX
+    hg_atomic_incr32(&ec->epoch);
+    (void) syscall(SYS_futex, HG_EVENTCOUNT_FUTEX_ADDR(&ec->epoch),
+        FUTEX_WAKE_PRIVATE, all ? INT_MAX : 1, NULL, NULL, 0);
+#else
+    hg_thread_mutex_lock(&ec->mutex);
+    hg_atomic_incr32(&ec->epoch);
+    if (all)
+        hg_thread_cond_broadcast(&ec->cond);
+    else
+        hg_thread_cond_signal(&ec->cond);
+    hg_thread_mutex_unlock(&ec->mutex);
+#endif
+}
@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#ifndef MERCURY_EVENTCOUNT_H
+#define MERCURY_EVENTCOUNT_H
+
+#include "mercury_atomic.h"
+
+#if defined(__linux__)
+#    define HG_EVENTCOUNT_HAS_FUTEX
+#else
+#    include "mercury_thread_condition.h"
+#endif
+
+/*
+ * Eventcount: lets a thread sleep until some condition, which is published
+ * without any lock (e.g., an entry pushed to an atomic queue), becomes true.
+ *
+ * Waiter:
+ *   key = hg_eventcount_prepare_wait(ec);
+ *   if (condition)
+ *       hg_eventcount_cancel_wait(ec);
+ *   else
+ *       hg_eventcount_commit_wait(ec, key, timeout);
+ *
+ * Notifier:
+ *   publish condition;
+ *   hg_eventcount_notify(ec);
+ *
+ * Notifying costs a memory barrier and a load when nobody waits. Waiters
+ * sleep on a futex on Linux, on a condition variable elsewhere.
+ */
+
+/*************************************/
+/* Public Type and Struct Definition */
+/*************************************/
+
+typedef struct hg_eventcount {
+    hg_atomic_int32_t epoch;   /* Incremented on each wake up */
+    hg_atomic_int32_t waiters; /* Number of threads in prepare/commit */
+#ifndef HG_EVENTCOUNT_HAS_FUTEX
+    hg_thread_mutex_t mutex;
+    hg_thread_cond_t cond;
+#endif
+} hg_eventcount_t;
+
+/*****************/
+/* Public Macros */
+/*****************/
+
+/* Wait without timeout */
+#define HG_EVENTCOUNT_INFINITE ((unsigned int) -1)
+
+/* Full (store-load) memory barrier */
+#if defined(_WIN32)
+#    define HG_EVENTCOUNT_MB() MemoryBarrier()
+#elif defined(HG_UTIL_HAS_OPA_PRIMITIVES_H)
+#    define HG_EVENTCOUNT_MB() OPA_read_write_barrier()
+#elif defined(HG_UTIL_HAS_STDATOMIC_H)
+#    define HG_EVENTCOUNT_MB() atomic_thread_fence(memory_order_seq_cst)
+#else
+#    define HG_EVENTCOUNT_MB() __sync_synchronize()
+#endif
+
+/*********************/
+/* Public Prototypes */
+/*********************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Initialize the eventcount.
+ *
+ * \param ec [IN/OUT]           pointer to eventcount object
+ *
+ * \return Non-negative on success or negative on failure
+ */
+HG_UTIL_PUBLIC int
+hg_eventcount_init(hg_eventcount_t *ec);
+
+/**
+ * Destroy the eventcount.
+ *
+ * \param ec [IN/OUT]           pointer to eventcount object
+ *
+ * \return Non-negative on success or negative on failure
+ */
+HG_UTIL_PUBLIC int
+hg_eventcount_destroy(hg_eventcount_t *ec);
+
+/**
+ * Announce intent to wait. The condition must be re-checked after this call
+ * and before either hg_eventcount_commit_wait() or hg_eventcount_cancel_wait()
+ * is called.
+ *
+ * \param ec [IN/OUT]           pointer to eventcount object
+ *
+ * \return key to pass to hg_eventcount_commit_wait()
+ */
+HG_UTIL_PUBLIC hg_util_int32_t
+hg_eventcount_prepare_wait(hg_eventcount_t *ec);
+
+/**
+ * Cancel wait, the condition became true after hg_eventcount_prepare_wait().
+ *
+ * \param ec [IN/OUT]           pointer to eventcount object
+ */
+static HG_UTIL_INLINE void
+hg_eventcount_cancel_wait(hg_eventcount_t *ec);
+
+/**
+ * Wait for at most timeout ms unless a notification occurred since key was
+ * obtained. Returns early (success) on spurious wake ups, callers must
+ * re-check their condition.
+ *
+ * \param ec [IN/OUT]           pointer to eventcount object
+ * \param key [IN]              key returned by hg_eventcount_prepare_wait()
+ * \param timeout [IN]          timeout (in milliseconds) or
+ *                              HG_EVENTCOUNT_INFINITE
+ *
+ * \return Non-negative on success or negative on timeout / failure
+ */
+HG_UTIL_PUBLIC int
+hg_eventcount_commit_wait(
+    hg_eventcount_t *ec, hg_util_int32_t key, unsigned int timeout);
+
+/**
+ * Wake up waiters (internal, use hg_eventcount_notify()).
+ *
+ * \param ec [IN/OUT]           pointer to eventcount object
+ * \param all [IN]              wake up all waiters instead of one
+ */
+HG_UTIL_PUBLIC void
+hg_eventcount_wake(hg_eventcount_t *ec, hg_util_bool_t all);
+
+/**
+ * Wake up one waiter if any. Must be called after the condition has been
+ * published.
+ *
+ * \param ec [IN/OUT]           pointer to eventcount object
+ */
+static HG_UTIL_INLINE void
+hg_eventcount_notify(hg_eventcount_t *ec);
+
+/**
+ * Wake up all waiters if any. Must be called after the condition has been
+ * published.
+ *
+ * \param ec [IN/OUT]           pointer to eventcount object
+ */
+static HG_UTIL_INLINE void
+hg_eventcount_notify_all(hg_eventcount_t *ec);
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE void
+hg_eventcount_cancel_wait(hg_eventcount_t *ec)
+{
+    hg_atomic_decr32(&ec->waiters);
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE void
+hg_eventcount_notify(hg_eventcount_t *ec)
+{
+    /* Make condition visible before checking for waiters */
+    HG_EVENTCOUNT_MB();
+    if (hg_atomic_get32(&ec->waiters) > 0)
+        hg_eventcount_wake(ec, HG_UTIL_FALSE);
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE void
+hg_eventcount_notify_all(hg_eventcount_t *ec)
+{
+    HG_EVENTCOUNT_MB();
+    if (hg_atomic_get32(&ec->waiters) > 0)
+        hg_eventcount_wake(ec, HG_UTIL_TRUE);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MERCURY_EVENTCOUNT_H */
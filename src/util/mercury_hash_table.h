@@ -85,11 +85,18 @@ typedef void *hg_hash_table_value_t;
  * Definition of a \ref hg_hash_table_iter.
  */
 
+#ifdef HG_UTIL_HAS_OA_HASH_TABLE
+struct hg_hash_table_iter {
+    hg_hash_table_t *hash_table;
+    unsigned int next_slot;
+};
+#else
 struct hg_hash_table_iter {
     hg_hash_table_t *hash_table;
     hg_hash_table_entry_t *next_entry;
     unsigned int next_chain;
 };
+#endif
 
 /**
  * A null \ref HashTableValue.
@@ -193,6 +200,39 @@ hg_hash_table_insert(hg_hash_table_t *hash_table, hg_hash_table_key_t key,
 HG_UTIL_PUBLIC hg_hash_table_value_t
 hg_hash_table_lookup(hg_hash_table_t *hash_table, hg_hash_table_key_t key);
 
+#ifdef HG_UTIL_HAS_OA_HASH_TABLE
+/**
+ * Create a new hash table that supports hg_hash_table_lookup_concurrent().
+ * Arrays released when the table grows are kept until the table is freed.
+ *
+ * \param hash_func            Function used to generate hash keys for the
+ *                             keys used in the table.
+ * \param equal_func           Function used to test keys used in the table
+ *                             for equality.
+ * \return                     A new hash table structure, or NULL if it
+ *                             was not possible to allocate the new hash
+ *                             table.
+ */
+HG_UTIL_PUBLIC hg_hash_table_t *
+hg_hash_table_new_concurrent(
+    hg_hash_table_hash_func_t hash_func, hg_hash_table_equal_func_t equal_func);
+
+/**
+ * Look up a value without locking. Only valid on tables created with
+ * hg_hash_table_new_concurrent(), may run concurrently with one writer
+ * (writers must still be serialized). Keys and values of removed entries
+ * must remain valid until concurrent lookups have returned.
+ *
+ * \param hash_table          The hash table.
+ * \param key                 The key of the value to look up.
+ * \return                    The value, or \ref HASH_TABLE_NULL if there
+ *                            is no value with that key in the hash table.
+ */
+HG_UTIL_PUBLIC hg_hash_table_value_t
+hg_hash_table_lookup_concurrent(
+    hg_hash_table_t *hash_table, hg_hash_table_key_t key);
+#endif
+
 /**
  * Remove a value from a hash table.
  *
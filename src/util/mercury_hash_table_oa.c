@@ -0,0 +1,643 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+/* Open-addressing hash table implementation (Swiss table layout): slots are
+ * indexed by a power-of-two mask and each slot has a one-byte control word
+ * holding either its state (empty / deleted) or 7 bits of the hash. Probing
+ * compares a whole group of control bytes at once (SSE2 or 64-bit SWAR),
+ * keys are only compared on a control byte match. Entries are stored inline,
+ * no allocation takes place on insert unless the table grows. */
+
+#include "mercury_hash_table.h"
+#include "mercury_atomic.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#    include <emmintrin.h>
+#    define HG_HASH_TABLE_SSE2
+#endif
+
+/****************/
+/* Local Macros */
+/****************/
+
+/* Control bytes */
+#define HG_HASH_TABLE_CTRL_EMPTY   ((hg_util_int8_t) -128) /* 0b10000000 */
+#define HG_HASH_TABLE_CTRL_DELETED ((hg_util_int8_t) -2)   /* 0b11111110 */
+
+/* Group width and bit stride of group match masks */
+#ifdef HG_HASH_TABLE_SSE2
+#    define HG_HASH_TABLE_GROUP_SIZE  16
+#    define HG_HASH_TABLE_GROUP_SHIFT 0
+#else
+#    define HG_HASH_TABLE_GROUP_SIZE  8
+#    define HG_HASH_TABLE_GROUP_SHIFT 3
+#    define HG_HASH_TABLE_LSBS        0x0101010101010101ULL
+#    define HG_HASH_TABLE_MSBS        0x8080808080808080ULL
+#endif
+
+/* Initial number of slots (power of two, at least one group) */
+#define HG_HASH_TABLE_MIN_CAPACITY 16
+
+/* Maximum load factor is 7/8 */
+#define HG_HASH_TABLE_MAX_LOAD(capacity) ((capacity) - (capacity) / 8)
+
+/* Split hash into slot position and control byte */
+#define HG_HASH_TABLE_H1(hash) ((hash) >> 7)
+#define HG_HASH_TABLE_H2(hash) ((hg_util_int8_t)((hash) &0x7f))
+
+/* Control byte state */
+#define HG_HASH_TABLE_IS_FULL(ctrl) ((ctrl) >= 0)
+
+/************************************/
+/* Local Type and Struct Definition */
+/************************************/
+
+/* Group match result: one bit (SSE2) or one byte (SWAR) per slot */
+typedef hg_util_uint64_t hg_hash_table_mask_t;
+
+struct hg_hash_table_slot {
+    hg_hash_table_key_t key;
+    hg_hash_table_value_t value;
+};
+
+/* Slots and control bytes, allocated together so that concurrent readers
+ * can get a consistent view from a single pointer */
+struct hg_hash_table_array {
+    struct hg_hash_table_array *retired; /* Next retired array */
+    unsigned int capacity;
+    unsigned int mask;
+    hg_util_int8_t *ctrl; /* capacity + GROUP_SIZE - 1 cloned bytes */
+    struct hg_hash_table_slot slots[];
+};
+
+struct hg_hash_table {
+    struct hg_hash_table_array *array;
+    struct hg_hash_table_array *retired; /* Arrays kept for readers */
+    hg_hash_table_hash_func_t hash_func;
+    hg_hash_table_equal_func_t equal_func;
+    hg_hash_table_key_free_func_t key_free_func;
+    hg_hash_table_value_free_func_t value_free_func;
+    unsigned int entries;
+    unsigned int growth_left; /* Insertions left before rehash */
+    hg_atomic_int32_t seq;    /* Odd while a write is in progress */
+    hg_util_bool_t concurrent;
+};
+
+/********************/
+/* Local Prototypes */
+/********************/
+
+/* Mix user hash, users frequently pass identity hashes of small integers */
+static HG_UTIL_INLINE unsigned int
+hash_table_hash(hg_hash_table_t *hash_table, hg_hash_table_key_t key);
+
+/* Group matching */
+static HG_UTIL_INLINE hg_hash_table_mask_t
+hash_table_group_match(const hg_util_int8_t *ctrl, hg_util_int8_t h2);
+static HG_UTIL_INLINE hg_hash_table_mask_t
+hash_table_group_match_empty(const hg_util_int8_t *ctrl);
+static HG_UTIL_INLINE hg_hash_table_mask_t
+hash_table_group_match_free(const hg_util_int8_t *ctrl);
+static HG_UTIL_INLINE unsigned int
+hash_table_mask_first(hg_hash_table_mask_t mask);
+
+/* Set control byte and its clone */
+static HG_UTIL_INLINE void
+hash_table_set_ctrl(
+    struct hg_hash_table_array *array, unsigned int i, hg_util_int8_t h2);
+
+/* Find slot index of key or capacity if not found */
+static HG_UTIL_INLINE unsigned int
+hash_table_find(hg_hash_table_t *hash_table, struct hg_hash_table_array *array,
+    hg_hash_table_key_t key, unsigned int hash);
+
+/* Find first empty or deleted slot for hash */
+static HG_UTIL_INLINE unsigned int
+hash_table_find_free(struct hg_hash_table_array *array, unsigned int hash);
+
+/* Allocate array of capacity slots */
+static struct hg_hash_table_array *
+hash_table_array_alloc(unsigned int capacity);
+
+/* Rehash to capacity (grow or drop tombstones) */
+static int
+hash_table_rehash(hg_hash_table_t *hash_table, unsigned int capacity);
+
+/* Write section for concurrent readers */
+static HG_UTIL_INLINE void
+hash_table_write_begin(hg_hash_table_t *hash_table);
+static HG_UTIL_INLINE void
+hash_table_write_end(hg_hash_table_t *hash_table);
+
+/* Create table */
+static hg_hash_table_t *
+hash_table_new(hg_hash_table_hash_func_t hash_func,
+    hg_hash_table_equal_func_t equal_func, hg_util_bool_t concurrent);
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE unsigned int
+hash_table_hash(hg_hash_table_t *hash_table, hg_hash_table_key_t key)
+{
+    unsigned int h = hash_table->hash_func(key);
+
+    /* murmur3 finalizer */
+    h ^= h >> 16;
+    h *= 0x85ebca6bU;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35U;
+    h ^= h >> 16;
+
+    return h;
+}
+
+/*---------------------------------------------------------------------------*/
+#ifdef HG_HASH_TABLE_SSE2
+static HG_UTIL_INLINE hg_hash_table_mask_t
+hash_table_group_match(const hg_util_int8_t *ctrl, hg_util_int8_t h2)
+{
+    __m128i group = _mm_loadu_si128((const __m128i *) ctrl);
+
+    return (hg_hash_table_mask_t) _mm_movemask_epi8(
+        _mm_cmpeq_epi8(_mm_set1_epi8((char) h2), group));
+}
+
+static HG_UTIL_INLINE hg_hash_table_mask_t
+hash_table_group_match_empty(const hg_util_int8_t *ctrl)
+{
+    return hash_table_group_match(ctrl, HG_HASH_TABLE_CTRL_EMPTY);
+}
+
+static HG_UTIL_INLINE hg_hash_table_mask_t
+hash_table_group_match_free(const hg_util_int8_t *ctrl)
+{
+    /* Empty and deleted have their sign bit set */
+    return (hg_hash_table_mask_t) _mm_movemask_epi8(
+        _mm_loadu_si128((const __m128i *) ctrl));
+}
+#else
+static HG_UTIL_INLINE hg_util_uint64_t
+hash_table_group_load(const hg_util_int8_t *ctrl)
+{
+    hg_util_uint64_t group;
+
+    memcpy(&group, ctrl, sizeof(group));
+#    if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+    group = __builtin_bswap64(group);
+#    endif
+
+    return group;
+}
+
+static HG_UTIL_INLINE hg_hash_table_mask_t
+hash_table_group_match(const hg_util_int8_t *ctrl, hg_util_int8_t h2)
+{
+    /* May report false positives, keys are compared anyway */
+    hg_util_uint64_t x = hash_table_group_load(ctrl) ^
+                         (HG_HASH_TABLE_LSBS * (hg_util_uint8_t) h2);
+
+    return (x - HG_HASH_TABLE_LSBS) & ~x & HG_HASH_TABLE_MSBS;
+}
+
+static HG_UTIL_INLINE hg_hash_table_mask_t
+hash_table_group_match_empty(const hg_util_int8_t *ctrl)
+{
+    /* Sign bit set and bit 1 clear */
+    hg_util_uint64_t group = hash_table_group_load(ctrl);
+
+    return group & (~group << 6) & HG_HASH_TABLE_MSBS;
+}
+
+static HG_UTIL_INLINE hg_hash_table_mask_t
+hash_table_group_match_free(const hg_util_int8_t *ctrl)
+{
+    return hash_table_group_load(ctrl) & HG_HASH_TABLE_MSBS;
+}
+#endif
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE unsigned int
+hash_table_mask_first(hg_hash_table_mask_t mask)
+{
+#if defined(__GNUC__)
+    return (unsigned int) __builtin_ctzll(mask) >> HG_HASH_TABLE_GROUP_SHIFT;
+#else
+    unsigned int i = 0;
+
+    while (!(mask & 1)) {
+        mask >>= 1;
+        i++;
+    }
+    return i >> HG_HASH_TABLE_GROUP_SHIFT;
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE void
+hash_table_set_ctrl(
+    struct hg_hash_table_array *array, unsigned int i, hg_util_int8_t h2)
+{
+    array->ctrl[i] = h2;
+
+    /* Clone the first group after the end so that unaligned group loads
+     * never need to wrap around */
+    if (i < HG_HASH_TABLE_GROUP_SIZE - 1)
+        array->ctrl[array->capacity + i] = h2;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE unsigned int
+hash_table_find(hg_hash_table_t *hash_table, struct hg_hash_table_array *array,
+    hg_hash_table_key_t key, unsigned int hash)
+{
+    hg_util_int8_t h2 = HG_HASH_TABLE_H2(hash);
+    unsigned int pos = HG_HASH_TABLE_H1(hash) & array->mask;
+    unsigned int stride = 0;
+
+    /* Triangular probing over groups visits every group once */
+    while (stride < array->capacity) {
+        const hg_util_int8_t *ctrl = &array->ctrl[pos];
+        hg_hash_table_mask_t match = hash_table_group_match(ctrl, h2);
+
+        while (match) {
+            unsigned int i =
+                (pos + hash_table_mask_first(match)) & array->mask;
+
+            if (hash_table->equal_func(array->slots[i].key, key) != 0)
+                return i;
+            match &= match - 1;
+        }
+        if (hash_table_group_match_empty(ctrl))
+            break;
+
+        stride += HG_HASH_TABLE_GROUP_SIZE;
+        pos = (pos + stride) & array->mask;
+    }
+
+    return array->capacity;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE unsigned int
+hash_table_find_free(struct hg_hash_table_array *array, unsigned int hash)
+{
+    unsigned int pos = HG_HASH_TABLE_H1(hash) & array->mask;
+    unsigned int stride = 0;
+
+    /* Load factor guarantees that a free slot exists */
+    while (1) {
+        hg_hash_table_mask_t match =
+            hash_table_group_match_free(&array->ctrl[pos]);
+
+        if (match)
+            return (pos + hash_table_mask_first(match)) & array->mask;
+
+        stride += HG_HASH_TABLE_GROUP_SIZE;
+        pos = (pos + stride) & array->mask;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+static struct hg_hash_table_array *
+hash_table_array_alloc(unsigned int capacity)
+{
+    struct hg_hash_table_array *array;
+    size_t slots_size = capacity * sizeof(struct hg_hash_table_slot);
+
+    array = (struct hg_hash_table_array *) malloc(sizeof(*array) + slots_size +
+                                                  capacity +
+                                                  HG_HASH_TABLE_GROUP_SIZE - 1);
+    if (array == NULL)
+        return NULL;
+
+    array->retired = NULL;
+    array->capacity = capacity;
+    array->mask = capacity - 1;
+    array->ctrl = (hg_util_int8_t *) ((char *) array->slots + slots_size);
+    memset(array->ctrl, HG_HASH_TABLE_CTRL_EMPTY,
+        capacity + HG_HASH_TABLE_GROUP_SIZE - 1);
+
+    return array;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hash_table_rehash(hg_hash_table_t *hash_table, unsigned int capacity)
+{
+    struct hg_hash_table_array *old_array = hash_table->array, *new_array;
+    unsigned int i;
+
+    new_array = hash_table_array_alloc(capacity);
+    if (new_array == NULL)
+        return 0;
+
+    for (i = 0; i < old_array->capacity; i++) {
+        unsigned int hash, j;
+
+        if (!HG_HASH_TABLE_IS_FULL(old_array->ctrl[i]))
+            continue;
+
+        hash = hash_table_hash(hash_table, old_array->slots[i].key);
+        j = hash_table_find_free(new_array, hash);
+        hash_table_set_ctrl(new_array, j, HG_HASH_TABLE_H2(hash));
+        new_array->slots[j] = old_array->slots[i];
+    }
+
+    hash_table->array = new_array;
+    hash_table->growth_left =
+        HG_HASH_TABLE_MAX_LOAD(capacity) - hash_table->entries;
+
+    /* Concurrent readers may still be looking at the old array */
+    if (hash_table->concurrent) {
+        old_array->retired = hash_table->retired;
+        hash_table->retired = old_array;
+    } else
+        free(old_array);
+
+    return 1;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE void
+hash_table_write_begin(hg_hash_table_t *hash_table)
+{
+    if (hash_table->concurrent)
+        hg_atomic_incr32(&hash_table->seq);
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE void
+hash_table_write_end(hg_hash_table_t *hash_table)
+{
+    if (hash_table->concurrent)
+        hg_atomic_incr32(&hash_table->seq);
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_hash_table_t *
+hash_table_new(hg_hash_table_hash_func_t hash_func,
+    hg_hash_table_equal_func_t equal_func, hg_util_bool_t concurrent)
+{
+    hg_hash_table_t *hash_table;
+
+    hash_table = (hg_hash_table_t *) malloc(sizeof(hg_hash_table_t));
+    if (hash_table == NULL)
+        return NULL;
+
+    hash_table->array = hash_table_array_alloc(HG_HASH_TABLE_MIN_CAPACITY);
+    if (hash_table->array == NULL) {
+        free(hash_table);
+        return NULL;
+    }
+    hash_table->retired = NULL;
+    hash_table->hash_func = hash_func;
+    hash_table->equal_func = equal_func;
+    hash_table->key_free_func = NULL;
+    hash_table->value_free_func = NULL;
+    hash_table->entries = 0;
+    hash_table->growth_left =
+        HG_HASH_TABLE_MAX_LOAD(HG_HASH_TABLE_MIN_CAPACITY);
+    hg_atomic_init32(&hash_table->seq, 0);
+    hash_table->concurrent = concurrent;
+
+    return hash_table;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_hash_table_t *
+hg_hash_table_new(
+    hg_hash_table_hash_func_t hash_func, hg_hash_table_equal_func_t equal_func)
+{
+    return hash_table_new(hash_func, equal_func, HG_UTIL_FALSE);
+}
+
+/*---------------------------------------------------------------------------*/
+hg_hash_table_t *
+hg_hash_table_new_concurrent(
+    hg_hash_table_hash_func_t hash_func, hg_hash_table_equal_func_t equal_func)
+{
+    return hash_table_new(hash_func, equal_func, HG_UTIL_TRUE);
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_hash_table_free(hg_hash_table_t *hash_table)
+{
+    struct hg_hash_table_array *array = hash_table->array;
+    unsigned int i;
+
+    /* Free all entries */
+    for (i = 0; i < array->capacity; i++) {
+        if (!HG_HASH_TABLE_IS_FULL(array->ctrl[i]))
+            continue;
+        if (hash_table->key_free_func != NULL)
+            hash_table->key_free_func(array->slots[i].key);
+        if (hash_table->value_free_func != NULL)
+            hash_table->value_free_func(array->slots[i].value);
+    }
+    free(array);
+
+    while (hash_table->retired) {
+        array = hash_table->retired;
+        hash_table->retired = array->retired;
+        free(array);
+    }
+
+    free(hash_table);
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_hash_table_register_free_functions(hg_hash_table_t *hash_table,
+    hg_hash_table_key_free_func_t key_free_func,
+    hg_hash_table_value_free_func_t value_free_func)
+{
+    hash_table->key_free_func = key_free_func;
+    hash_table->value_free_func = value_free_func;
+}
+
+/*---------------------------------------------------------------------------*/
+int
+hg_hash_table_insert(hg_hash_table_t *hash_table, hg_hash_table_key_t key,
+    hg_hash_table_value_t value)
+{
+    struct hg_hash_table_array *array = hash_table->array;
+    unsigned int hash = hash_table_hash(hash_table, key);
+    unsigned int i;
+    int ret = 1;
+
+    hash_table_write_begin(hash_table);
+
+    i = hash_table_find(hash_table, array, key, hash);
+    if (i != array->capacity) {
+        struct hg_hash_table_slot *slot = &array->slots[i];
+
+        /* Same key: overwrite this entry with new data */
+        if (hash_table->value_free_func != NULL)
+            hash_table->value_free_func(slot->value);
+        if (hash_table->key_free_func != NULL)
+            hash_table->key_free_func(slot->key);
+        slot->key = key;
+        slot->value = value;
+        goto done;
+    }
+
+    i = hash_table_find_free(array, hash);
+    if (hash_table->growth_left == 0 &&
+        array->ctrl[i] == HG_HASH_TABLE_CTRL_EMPTY) {
+        /* Grow unless most of the load is made of tombstones */
+        unsigned int capacity =
+            (hash_table->entries * 2 < HG_HASH_TABLE_MAX_LOAD(array->capacity))
+                ? array->capacity
+                : array->capacity * 2;
+
+        if (!hash_table_rehash(hash_table, capacity)) {
+            ret = 0;
+            goto done;
+        }
+        array = hash_table->array;
+        i = hash_table_find_free(array, hash);
+    }
+
+    /* Reusing a tombstone does not consume growth */
+    if (array->ctrl[i] == HG_HASH_TABLE_CTRL_EMPTY)
+        hash_table->growth_left--;
+    array->slots[i].key = key;
+    array->slots[i].value = value;
+    hash_table_set_ctrl(array, i, HG_HASH_TABLE_H2(hash));
+    hash_table->entries++;
+
+done:
+    hash_table_write_end(hash_table);
+
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_hash_table_value_t
+hg_hash_table_lookup(hg_hash_table_t *hash_table, hg_hash_table_key_t key)
+{
+    struct hg_hash_table_array *array = hash_table->array;
+    unsigned int i =
+        hash_table_find(hash_table, array, key, hash_table_hash(hash_table, key));
+
+    return (i != array->capacity) ? array->slots[i].value : HG_HASH_TABLE_NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_hash_table_value_t
+hg_hash_table_lookup_concurrent(
+    hg_hash_table_t *hash_table, hg_hash_table_key_t key)
+{
+    unsigned int hash = hash_table_hash(hash_table, key);
+    hg_hash_table_value_t value;
+    hg_util_int32_t seq;
+
+    do {
+        struct hg_hash_table_array *array;
+        unsigned int i;
+
+        /* Wait for writer to complete */
+        while ((seq = hg_atomic_get32(&hash_table->seq)) & 1)
+            continue;
+
+        array = hash_table->array;
+        i = hash_table_find(hash_table, array, key, hash);
+        value =
+            (i != array->capacity) ? array->slots[i].value : HG_HASH_TABLE_NULL;
+
+        hg_atomic_fence();
+    } while (hg_atomic_get32(&hash_table->seq) != seq);
+
+    return value;
+}
+
+/*---------------------------------------------------------------------------*/
+int
+hg_hash_table_remove(hg_hash_table_t *hash_table, hg_hash_table_key_t key)
+{
+    struct hg_hash_table_array *array = hash_table->array;
+    hg_hash_table_key_t old_key;
+    hg_hash_table_value_t old_value;
+    unsigned int i;
+
+    i = hash_table_find(
+        hash_table, array, key, hash_table_hash(hash_table, key));
+    if (i == array->capacity)
+        return 0;
+
+    old_key = array->slots[i].key;
+    old_value = array->slots[i].value;
+
+    hash_table_write_begin(hash_table);
+    hash_table_set_ctrl(array, i, HG_HASH_TABLE_CTRL_DELETED);
+    hash_table->entries--;
+    hash_table_write_end(hash_table);
+
+    /* Free after the entry is no longer reachable (key may alias it) */
+    if (hash_table->key_free_func != NULL)
+        hash_table->key_free_func(old_key);
+    if (hash_table->value_free_func != NULL)
+        hash_table->value_free_func(old_value);
+
+    return 1;
+}
+
+/*---------------------------------------------------------------------------*/
+unsigned int
+hg_hash_table_num_entries(hg_hash_table_t *hash_table)
+{
+    return hash_table->entries;
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_hash_table_iterate(hg_hash_table_t *hash_table, hg_hash_table_iter_t *iter)
+{
+    struct hg_hash_table_array *array = hash_table->array;
+    unsigned int i;
+
+    iter->hash_table = hash_table;
+
+    for (i = 0; i < array->capacity; i++)
+        if (HG_HASH_TABLE_IS_FULL(array->ctrl[i]))
+            break;
+    iter->next_slot = i;
+}
+
+/*---------------------------------------------------------------------------*/
+int
+hg_hash_table_iter_has_more(hg_hash_table_iter_t *iter)
+{
+    return iter->next_slot < iter->hash_table->array->capacity;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_hash_table_value_t
+hg_hash_table_iter_next(hg_hash_table_iter_t *iter)
+{
+    struct hg_hash_table_array *array = iter->hash_table->array;
+    hg_hash_table_value_t result;
+    unsigned int i;
+
+    if (iter->next_slot >= array->capacity)
+        return HG_HASH_TABLE_NULL;
+
+    result = array->slots[iter->next_slot].value;
+
+    for (i = iter->next_slot + 1; i < array->capacity; i++)
+        if (HG_HASH_TABLE_IS_FULL(array->ctrl[i]))
+            break;
+    iter->next_slot = i;
+
+    return result;
+}
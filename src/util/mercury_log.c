@@ -9,8 +9,16 @@
  */
 
 #include "mercury_log.h"
+#include "mercury_eventcount.h"
+#include "mercury_thread.h"
+#include "mercury_thread_mutex.h"
+#include "mercury_time.h"
 
 #include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 
 /****************/
 /* Local Macros */
@@ -31,6 +39,170 @@
 #    define HG_LOG_CYAN    "36m"
 #endif
 
+/* Max number of arguments (including '*' width / precision) in a record */
+#define HG_LOG_ASYNC_MAX_ARGS 16
+
+/* Max number of bytes copied from a string argument */
+#define HG_LOG_ASYNC_MAX_STR HG_LOG_MAX_BUF
+
+/* Min size of per-thread buffers */
+#define HG_LOG_ASYNC_BUF_SIZE_MIN 1024
+
+/* Interval between drains of log buffers (ms) */
+#define HG_LOG_ASYNC_INTERVAL 10
+
+/* Max length of a single conversion specification */
+#define HG_LOG_SPEC_MAX 32
+
+/* States of asynchronous logging globals */
+#define HG_LOG_ASYNC_INIT_NONE 0
+#define HG_LOG_ASYNC_INIT_BUSY 1 /* Being initialized */
+#define HG_LOG_ASYNC_INIT_DONE 2
+#define HG_LOG_ASYNC_INIT_EXIT 3 /* Released at exit */
+
+/* Records are 8-byte aligned */
+#define HG_LOG_ALIGN(x) (((x) + 7) & ~((size_t) 7))
+
+/* Length modifiers */
+#define HG_LOG_LEN_NONE 0
+#define HG_LOG_LEN_HH   1
+#define HG_LOG_LEN_H    2
+#define HG_LOG_LEN_L    3
+#define HG_LOG_LEN_LL   4
+#define HG_LOG_LEN_Z    5
+#define HG_LOG_LEN_J    6
+#define HG_LOG_LEN_T    7
+#define HG_LOG_LEN_LD   8
+
+/************************************/
+/* Local Type and Struct Definition */
+/************************************/
+
+/* Recorded argument */
+union hg_log_arg {
+    long long i;
+    double d;
+    void *p;
+    size_t off; /* Offset of string from record start */
+};
+
+/* Binary log record, type 0 is used for padding at the end of buffers */
+struct hg_log_record {
+    hg_util_uint32_t size; /* Aligned size of record */
+    hg_util_uint32_t type; /* Log type */
+    unsigned int line;
+    unsigned int nargs;
+    const char *module;
+    const char *file;
+    const char *func;
+    const char *format;
+    union hg_log_arg args[];
+};
+
+/* Per-thread single-producer / single-consumer ring buffer */
+struct hg_log_buf {
+    hg_atomic_int64_t head;      /* Consumer position */
+    hg_atomic_int64_t tail;      /* Producer position */
+    hg_atomic_int64_t dropped;   /* Records dropped by producer */
+    hg_util_int64_t reported;    /* Drops already reported by consumer */
+    struct hg_log_buf *next;     /* Next buffer in list of buffers */
+    size_t size;                 /* Size of data */
+    char *data;
+};
+
+/* Conversion specification */
+struct hg_log_spec {
+    const char *start; /* Starts at '%' */
+    size_t len;
+    int length;
+    char conv;
+    hg_util_bool_t star_width;
+    hg_util_bool_t star_prec;
+};
+
+/********************/
+/* Local Prototypes */
+/********************/
+
+/**
+ * Write formatted message to stream.
+ */
+static void
+hg_log_output(unsigned int log_type, const char *module, const char *file,
+    unsigned int line, const char *func, const char *buf);
+
+/**
+ * Write log, asynchronously if enabled.
+ */
+static void
+hg_log_vwrite(unsigned int log_type, const char *module, const char *file,
+    unsigned int line, const char *func, const char *format, va_list ap);
+
+/**
+ * Check rate limit of call site.
+ */
+static hg_util_bool_t
+hg_log_site_allow(struct hg_log_site *site, hg_util_int32_t *suppressed);
+
+/**
+ * Parse conversion specification starting at '%'.
+ */
+static const char *
+hg_log_spec_parse(const char *p, struct hg_log_spec *spec);
+
+/**
+ * Record arguments, return number of arguments or -1 if unsupported.
+ */
+static int
+hg_log_args_record(const char *format, va_list *ap, union hg_log_arg *args,
+    const char **strs, size_t *lens);
+
+/**
+ * Format record into buf.
+ */
+static void
+hg_log_record_format(
+    const struct hg_log_record *record, char *buf, size_t buf_size);
+
+/**
+ * Get buffer of calling thread.
+ */
+static struct hg_log_buf *
+hg_log_buf_get(void);
+
+/**
+ * Write record into buffer of calling thread, return HG_UTIL_FAIL if
+ * message must be written synchronously.
+ */
+static int
+hg_log_async_vwrite(unsigned int log_type, const char *module,
+    const char *file, unsigned int line, const char *func, const char *format,
+    va_list ap);
+
+/**
+ * Drain buffer.
+ */
+static void
+hg_log_buf_drain(struct hg_log_buf *buf);
+
+/**
+ * Drain thread.
+ */
+static HG_THREAD_RETURN_TYPE
+hg_log_async_thread(void *arg);
+
+/**
+ * Initialize asynchronous logging globals once.
+ */
+static int
+hg_log_async_init(void);
+
+/**
+ * Stop asynchronous logging and release buffers at exit.
+ */
+static void
+hg_log_async_atexit(void);
+
 /*******************/
 /* Local Variables */
 /*******************/
@@ -40,6 +212,20 @@ static FILE *hg_log_stream_debug_g = NULL;
 static FILE *hg_log_stream_warning_g = NULL;
 static FILE *hg_log_stream_error_g = NULL;
 
+/* Rate limiting */
+static hg_atomic_int32_t hg_log_rate_burst_g;
+static hg_atomic_int32_t hg_log_rate_interval_g;
+
+/* Asynchronous logging */
+static hg_atomic_int32_t hg_log_async_g;      /* Enabled */
+static hg_atomic_int32_t hg_log_async_init_g; /* State of globals */
+static hg_thread_mutex_t hg_log_async_mutex_g;
+static hg_thread_key_t hg_log_async_key_g;
+static hg_eventcount_t hg_log_async_ec_g;
+static hg_thread_t hg_log_async_thread_g;
+static struct hg_log_buf *hg_log_async_bufs_g = NULL;
+static size_t hg_log_async_buf_size_g = HG_LOG_ASYNC_BUF_SIZE_DEFAULT;
+
 /*---------------------------------------------------------------------------*/
 void
 hg_log_set_func(int (*log_func)(FILE *stream, const char *format, ...))
@@ -69,17 +255,15 @@ hg_log_set_stream_error(FILE *stream)
 }
 
 /*---------------------------------------------------------------------------*/
-void
-hg_log_write(unsigned int log_type, const char *module, const char *file,
-    unsigned int line, const char *func, const char *format, ...)
+static void
+hg_log_output(unsigned int log_type, const char *module, const char *file,
+    unsigned int line, const char *func, const char *buf)
 {
-    char buf[HG_LOG_MAX_BUF];
     FILE *stream = NULL;
     const char *msg_type = NULL;
 #ifdef HG_UTIL_HAS_LOG_COLOR
     const char *color = "";
 #endif
-    va_list ap;
 
     switch (log_type) {
         case HG_LOG_TYPE_DEBUG:
@@ -107,10 +291,6 @@ hg_log_write(unsigned int log_type, const char *module, const char *file,
             return;
     };
 
-    va_start(ap, format);
-    vsnprintf(buf, HG_LOG_MAX_BUF, format, ap);
-    va_end(ap);
-
 /* Print using logging function */
 #ifdef HG_UTIL_HAS_LOG_COLOR
     hg_log_func_g(stream,
@@ -126,3 +306,686 @@ hg_log_write(unsigned int log_type, const char *module, const char *file,
         module, msg_type, file, line, func, buf);
 #endif
 }
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_log_vwrite(unsigned int log_type, const char *module, const char *file,
+    unsigned int line, const char *func, const char *format, va_list ap)
+{
+    char buf[HG_LOG_MAX_BUF];
+
+    /* Errors are always written synchronously */
+    if (log_type != HG_LOG_TYPE_ERROR && hg_atomic_get32(&hg_log_async_g) &&
+        hg_log_async_vwrite(log_type, module, file, line, func, format, ap) ==
+            HG_UTIL_SUCCESS)
+        return;
+
+    vsnprintf(buf, HG_LOG_MAX_BUF, format, ap);
+    hg_log_output(log_type, module, file, line, func, buf);
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_log_write(unsigned int log_type, const char *module, const char *file,
+    unsigned int line, const char *func, const char *format, ...)
+{
+    va_list ap;
+
+    va_start(ap, format);
+    hg_log_vwrite(log_type, module, file, line, func, format, ap);
+    va_end(ap);
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_util_bool_t
+hg_log_site_allow(struct hg_log_site *site, hg_util_int32_t *suppressed)
+{
+    hg_util_int32_t burst = hg_atomic_get32(&hg_log_rate_burst_g);
+    hg_util_int64_t interval, window, now;
+
+    *suppressed = 0;
+    if (burst == 0)
+        return HG_UTIL_TRUE;
+
+    interval = (hg_util_int64_t) hg_atomic_get32(&hg_log_rate_interval_g) *
+               1000000;
+    now = (hg_util_int64_t) hg_time_fast_to_ns(hg_time_fast_now());
+    window = hg_atomic_get64(&site->window);
+    if ((window == 0 || now - window >= interval) &&
+        hg_atomic_cas64(&site->window, window, now)) {
+        /* New window, report what was suppressed in the previous one */
+        hg_atomic_set32(&site->count, 0);
+        do {
+            *suppressed = hg_atomic_get32(&site->suppressed);
+        } while (!hg_atomic_cas32(&site->suppressed, *suppressed, 0));
+    }
+
+    if (hg_atomic_incr32(&site->count) > burst) {
+        hg_atomic_incr32(&site->suppressed);
+        return HG_UTIL_FALSE;
+    }
+
+    return HG_UTIL_TRUE;
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_log_write_site(struct hg_log_site *site, unsigned int log_type,
+    const char *module, const char *file, unsigned int line, const char *func,
+    const char *format, ...)
+{
+    hg_util_int32_t suppressed = 0;
+    va_list ap;
+
+    /* Errors are never suppressed */
+    if (log_type != HG_LOG_TYPE_ERROR && !hg_log_site_allow(site, &suppressed))
+        return;
+
+    if (suppressed > 0)
+        hg_log_write(log_type, module, file, line, func,
+            "%d similar messages suppressed", (int) suppressed);
+
+    va_start(ap, format);
+    hg_log_vwrite(log_type, module, file, line, func, format, ap);
+    va_end(ap);
+}
+
+/*---------------------------------------------------------------------------*/
+int
+hg_log_level_to_mask(const char *level, unsigned int *mask)
+{
+    if (strcmp(level, "none") == 0)
+        *mask = HG_LOG_TYPE_NONE;
+    else if (strcmp(level, "error") == 0)
+        *mask = HG_LOG_TYPE_ERROR;
+    else if (strcmp(level, "warning") == 0)
+        *mask = HG_LOG_TYPE_ERROR | HG_LOG_TYPE_WARNING;
+    else if (strcmp(level, "debug") == 0)
+        *mask = HG_LOG_TYPE_ERROR | HG_LOG_TYPE_WARNING | HG_LOG_TYPE_DEBUG;
+    else
+        return HG_UTIL_FAIL;
+
+    return HG_UTIL_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_log_set_rate_limit(unsigned int burst, unsigned int interval_ms)
+{
+    hg_atomic_set32(&hg_log_rate_interval_g, (hg_util_int32_t) interval_ms);
+    hg_atomic_set32(&hg_log_rate_burst_g, (hg_util_int32_t) burst);
+}
+
+/*---------------------------------------------------------------------------*/
+static const char *
+hg_log_spec_parse(const char *p, struct hg_log_spec *spec)
+{
+    spec->start = p++;
+    spec->length = HG_LOG_LEN_NONE;
+    spec->star_width = HG_UTIL_FALSE;
+    spec->star_prec = HG_UTIL_FALSE;
+
+    /* Flags */
+    while (*p && strchr("-+ #0'", *p))
+        p++;
+
+    /* Width */
+    if (*p == '*') {
+        spec->star_width = HG_UTIL_TRUE;
+        p++;
+    } else
+        while (*p >= '0' && *p <= '9')
+            p++;
+
+    /* Precision */
+    if (*p == '.') {
+        p++;
+        if (*p == '*') {
+            spec->star_prec = HG_UTIL_TRUE;
+            p++;
+        } else
+            while (*p >= '0' && *p <= '9')
+                p++;
+    }
+
+    /* Length modifier */
+    switch (*p) {
+        case 'h':
+            spec->length = (p[1] == 'h') ? HG_LOG_LEN_HH : HG_LOG_LEN_H;
+            p += (p[1] == 'h') ? 2 : 1;
+            break;
+        case 'l':
+            spec->length = (p[1] == 'l') ? HG_LOG_LEN_LL : HG_LOG_LEN_L;
+            p += (p[1] == 'l') ? 2 : 1;
+            break;
+        case 'q':
+            spec->length = HG_LOG_LEN_LL;
+            p++;
+            break;
+        case 'z':
+            spec->length = HG_LOG_LEN_Z;
+            p++;
+            break;
+        case 'j':
+            spec->length = HG_LOG_LEN_J;
+            p++;
+            break;
+        case 't':
+            spec->length = HG_LOG_LEN_T;
+            p++;
+            break;
+        case 'L':
+            spec->length = HG_LOG_LEN_LD;
+            p++;
+            break;
+        default:
+            break;
+    }
+
+    spec->conv = *p;
+    if (*p)
+        p++;
+    spec->len = (size_t) (p - spec->start);
+
+    return p;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_log_args_record(const char *format, va_list *ap, union hg_log_arg *args,
+    const char **strs, size_t *lens)
+{
+    const char *p = format;
+    int nargs = 0;
+
+    while ((p = strchr(p, '%')) != NULL) {
+        struct hg_log_spec spec;
+
+        if (p[1] == '%') {
+            p += 2;
+            continue;
+        }
+        p = hg_log_spec_parse(p, &spec);
+        if (nargs + (int) spec.star_width + (int) spec.star_prec + 1 >
+            HG_LOG_ASYNC_MAX_ARGS)
+            return -1;
+
+        if (spec.star_width) {
+            strs[nargs] = NULL;
+            args[nargs++].i = va_arg(*ap, int);
+        }
+        if (spec.star_prec) {
+            strs[nargs] = NULL;
+            args[nargs++].i = va_arg(*ap, int);
+        }
+
+        strs[nargs] = NULL;
+        switch (spec.conv) {
+            case 'd':
+            case 'i':
+            case 'o':
+            case 'u':
+            case 'x':
+            case 'X':
+                switch (spec.length) {
+                    case HG_LOG_LEN_L:
+                        args[nargs].i = (long long) va_arg(*ap, long);
+                        break;
+                    case HG_LOG_LEN_LL:
+                        args[nargs].i = va_arg(*ap, long long);
+                        break;
+                    case HG_LOG_LEN_Z:
+                        args[nargs].i = (long long) va_arg(*ap, size_t);
+                        break;
+                    case HG_LOG_LEN_J:
+                        args[nargs].i = (long long) va_arg(*ap, intmax_t);
+                        break;
+                    case HG_LOG_LEN_T:
+                        args[nargs].i = (long long) va_arg(*ap, ptrdiff_t);
+                        break;
+                    case HG_LOG_LEN_LD:
+                        return -1;
+                    default:
+                        args[nargs].i = (long long) va_arg(*ap, int);
+                        break;
+                }
+                break;
+            case 'c':
+                if (spec.length != HG_LOG_LEN_NONE)
+                    return -1;
+                args[nargs].i = (long long) va_arg(*ap, int);
+                break;
+            case 'e':
+            case 'E':
+            case 'f':
+            case 'F':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                if (spec.length == HG_LOG_LEN_LD)
+                    args[nargs].d = (double) va_arg(*ap, long double);
+                else
+                    args[nargs].d = va_arg(*ap, double);
+                break;
+            case 'p':
+                args[nargs].p = va_arg(*ap, void *);
+                break;
+            case 's':
+                if (spec.length != HG_LOG_LEN_NONE)
+                    return -1;
+                strs[nargs] = va_arg(*ap, const char *);
+                if (strs[nargs] == NULL) {
+                    args[nargs].off = (size_t) -1;
+                    break;
+                }
+                lens[nargs] = strlen(strs[nargs]);
+                if (lens[nargs] > HG_LOG_ASYNC_MAX_STR)
+                    lens[nargs] = HG_LOG_ASYNC_MAX_STR;
+                break;
+            default:
+                /* %n and unknown conversions */
+                return -1;
+        }
+        nargs++;
+    }
+
+    return nargs;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_log_record_format(
+    const struct hg_log_record *record, char *buf, size_t buf_size)
+{
+    const char *p = record->format;
+    unsigned int arg = 0;
+    size_t pos = 0;
+
+    while (*p && pos < buf_size - 1) {
+        struct hg_log_spec spec;
+        char spec_buf[HG_LOG_SPEC_MAX + 16];
+        const union hg_log_arg *a;
+        size_t i, j = 0;
+        int len;
+
+        if (*p != '%' || p[1] == '%') {
+            buf[pos++] = *p;
+            p += (*p == '%') ? 2 : 1;
+            continue;
+        }
+        p = hg_log_spec_parse(p, &spec);
+        if (spec.len > HG_LOG_SPEC_MAX)
+            break;
+
+        /* Substitute '*' with recorded width / precision */
+        for (i = 0; i < spec.len; i++) {
+            if (spec.start[i] == '*') {
+                j += (size_t) snprintf(spec_buf + j, sizeof(spec_buf) - j,
+                    "%d", (int) record->args[arg++].i);
+                if (j >= sizeof(spec_buf) - 1)
+                    goto done;
+            } else
+                spec_buf[j++] = spec.start[i];
+        }
+        spec_buf[j] = '\0';
+        a = &record->args[arg++];
+
+        switch (spec.conv) {
+            case 'd':
+            case 'i':
+            case 'o':
+            case 'u':
+            case 'x':
+            case 'X':
+                switch (spec.length) {
+                    case HG_LOG_LEN_L:
+                        len = snprintf(
+                            buf + pos, buf_size - pos, spec_buf, (long) a->i);
+                        break;
+                    case HG_LOG_LEN_LL:
+                        len = snprintf(
+                            buf + pos, buf_size - pos, spec_buf, a->i);
+                        break;
+                    case HG_LOG_LEN_Z:
+                        len = snprintf(
+                            buf + pos, buf_size - pos, spec_buf, (size_t) a->i);
+                        break;
+                    case HG_LOG_LEN_J:
+                        len = snprintf(buf + pos, buf_size - pos, spec_buf,
+                            (intmax_t) a->i);
+                        break;
+                    case HG_LOG_LEN_T:
+                        len = snprintf(buf + pos, buf_size - pos, spec_buf,
+                            (ptrdiff_t) a->i);
+                        break;
+                    default:
+                        len = snprintf(
+                            buf + pos, buf_size - pos, spec_buf, (int) a->i);
+                        break;
+                }
+                break;
+            case 'c':
+                len = snprintf(buf + pos, buf_size - pos, spec_buf, (int) a->i);
+                break;
+            case 'p':
+                len = snprintf(buf + pos, buf_size - pos, spec_buf, a->p);
+                break;
+            case 's':
+                len = snprintf(buf + pos, buf_size - pos, spec_buf,
+                    (a->off == (size_t) -1)
+                        ? "(null)"
+                        : (const char *) record + a->off);
+                break;
+            default:
+                if (spec.length == HG_LOG_LEN_LD)
+                    len = snprintf(buf + pos, buf_size - pos, spec_buf,
+                        (long double) a->d);
+                else
+                    len = snprintf(buf + pos, buf_size - pos, spec_buf, a->d);
+                break;
+        }
+        if (len < 0)
+            break;
+        pos += (size_t) len;
+    }
+
+done:
+    if (pos > buf_size - 1)
+        pos = buf_size - 1;
+    buf[pos] = '\0';
+}
+
+/*---------------------------------------------------------------------------*/
+static struct hg_log_buf *
+hg_log_buf_get(void)
+{
+    struct hg_log_buf *buf = hg_thread_getspecific(hg_log_async_key_g);
+
+    if (buf)
+        return buf;
+
+    buf = (struct hg_log_buf *) malloc(sizeof(struct hg_log_buf));
+    if (buf == NULL)
+        return NULL;
+    buf->size = hg_log_async_buf_size_g;
+    buf->data = (char *) malloc(buf->size);
+    if (buf->data == NULL) {
+        free(buf);
+        return NULL;
+    }
+    hg_atomic_init64(&buf->head, 0);
+    hg_atomic_init64(&buf->tail, 0);
+    hg_atomic_init64(&buf->dropped, 0);
+    buf->reported = 0;
+
+    /* Buffers are kept until exit as records may still be pending */
+    hg_thread_mutex_lock(&hg_log_async_mutex_g);
+    buf->next = hg_log_async_bufs_g;
+    hg_log_async_bufs_g = buf;
+    hg_thread_mutex_unlock(&hg_log_async_mutex_g);
+
+    hg_thread_setspecific(hg_log_async_key_g, buf);
+
+    return buf;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_log_async_vwrite(unsigned int log_type, const char *module,
+    const char *file, unsigned int line, const char *func, const char *format,
+    va_list ap)
+{
+    union hg_log_arg args[HG_LOG_ASYNC_MAX_ARGS];
+    const char *strs[HG_LOG_ASYNC_MAX_ARGS];
+    size_t lens[HG_LOG_ASYNC_MAX_ARGS];
+    struct hg_log_record *record;
+    struct hg_log_buf *buf;
+    hg_util_int64_t head, tail;
+    size_t size, pos, contig, str_off;
+    va_list ap_copy;
+    int nargs, i;
+
+    buf = hg_log_buf_get();
+    if (buf == NULL)
+        return HG_UTIL_FAIL;
+
+    /* Keep ap intact for synchronous fallback */
+    va_copy(ap_copy, ap);
+    nargs = hg_log_args_record(format, &ap_copy, args, strs, lens);
+    va_end(ap_copy);
+    if (nargs < 0)
+        return HG_UTIL_FAIL;
+
+    size = offsetof(struct hg_log_record, args) +
+           (size_t) nargs * sizeof(union hg_log_arg);
+    str_off = size;
+    for (i = 0; i < nargs; i++)
+        if (strs[i])
+            size += lens[i] + 1;
+    size = HG_LOG_ALIGN(size);
+
+    /* Only this thread produces into buf */
+    tail = hg_atomic_get64(&buf->tail);
+    head = hg_atomic_get64(&buf->head);
+    pos = (size_t) tail % buf->size;
+    contig = buf->size - pos;
+    if (size + ((contig < size) ? contig : 0) >
+        buf->size - (size_t) (tail - head)) {
+        hg_atomic_incr64(&buf->dropped);
+        return HG_UTIL_SUCCESS;
+    }
+    if (contig < size) {
+        /* Pad until end of buffer */
+        record = (struct hg_log_record *) (buf->data + pos);
+        record->size = (hg_util_uint32_t) contig;
+        record->type = 0;
+        tail += (hg_util_int64_t) contig;
+        pos = 0;
+    }
+
+    record = (struct hg_log_record *) (buf->data + pos);
+    record->size = (hg_util_uint32_t) size;
+    record->type = log_type;
+    record->line = line;
+    record->nargs = (unsigned int) nargs;
+    record->module = module;
+    record->file = file;
+    record->func = func;
+    record->format = format;
+    for (i = 0; i < nargs; i++) {
+        if (strs[i]) {
+            record->args[i].off = str_off;
+            memcpy((char *) record + str_off, strs[i], lens[i]);
+            ((char *) record)[str_off + lens[i]] = '\0';
+            str_off += lens[i] + 1;
+        } else
+            record->args[i] = args[i];
+    }
+
+    /* Publish record */
+    hg_atomic_set64(&buf->tail, tail + (hg_util_int64_t) size);
+
+    return HG_UTIL_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_log_buf_drain(struct hg_log_buf *buf)
+{
+    hg_util_int64_t head = hg_atomic_get64(&buf->head);
+    hg_util_int64_t tail = hg_atomic_get64(&buf->tail);
+    hg_util_int64_t dropped;
+
+    while (head < tail) {
+        const struct hg_log_record *record =
+            (const struct hg_log_record *) (buf->data +
+                                            (size_t) head % buf->size);
+
+        if (record->type != 0) {
+            char msg[HG_LOG_MAX_BUF];
+
+            hg_log_record_format(record, msg, sizeof(msg));
+            hg_log_output(record->type, record->module, record->file,
+                record->line, record->func, msg);
+        }
+        head += (hg_util_int64_t) record->size;
+        /* Release space to producer */
+        hg_atomic_set64(&buf->head, head);
+    }
+
+    dropped = hg_atomic_get64(&buf->dropped);
+    if (dropped != buf->reported) {
+        char msg[HG_LOG_MAX_BUF];
+
+        snprintf(msg, sizeof(msg), "%lld log records dropped (buffer full)",
+            (long long) (dropped - buf->reported));
+        hg_log_output(
+            HG_LOG_TYPE_WARNING, "HG Log", __FILE__, __LINE__, __func__, msg);
+        buf->reported = dropped;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_THREAD_RETURN_TYPE
+hg_log_async_thread(void *arg)
+{
+    hg_thread_ret_t thread_ret = (hg_thread_ret_t) 0;
+
+    (void) arg;
+
+    while (hg_atomic_get32(&hg_log_async_g)) {
+        hg_util_int32_t key;
+
+        hg_log_flush();
+
+        key = hg_eventcount_prepare_wait(&hg_log_async_ec_g);
+        if (!hg_atomic_get32(&hg_log_async_g))
+            hg_eventcount_cancel_wait(&hg_log_async_ec_g);
+        else
+            hg_eventcount_commit_wait(
+                &hg_log_async_ec_g, key, HG_LOG_ASYNC_INTERVAL);
+    }
+
+    hg_thread_exit(thread_ret);
+    return thread_ret;
+}
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_log_async_init(void)
+{
+    hg_util_int32_t state;
+
+    /* First caller initializes globals, concurrent callers wait for it */
+    while ((state = hg_atomic_get32(&hg_log_async_init_g)) !=
+           HG_LOG_ASYNC_INIT_DONE) {
+        if (state == HG_LOG_ASYNC_INIT_EXIT)
+            return HG_UTIL_FAIL;
+        if (state == HG_LOG_ASYNC_INIT_BUSY ||
+            !hg_atomic_cas32(&hg_log_async_init_g, HG_LOG_ASYNC_INIT_NONE,
+                HG_LOG_ASYNC_INIT_BUSY)) {
+            hg_thread_yield();
+            continue;
+        }
+
+        if (hg_thread_mutex_init(&hg_log_async_mutex_g) != HG_UTIL_SUCCESS)
+            goto error;
+        if (hg_thread_key_create(&hg_log_async_key_g) != HG_UTIL_SUCCESS)
+            goto error_key;
+        if (hg_eventcount_init(&hg_log_async_ec_g) != HG_UTIL_SUCCESS)
+            goto error_ec;
+        if (atexit(hg_log_async_atexit) != 0)
+            goto error_atexit;
+        hg_atomic_set32(&hg_log_async_init_g, HG_LOG_ASYNC_INIT_DONE);
+    }
+
+    return HG_UTIL_SUCCESS;
+
+error_atexit:
+    hg_eventcount_destroy(&hg_log_async_ec_g);
+error_ec:
+    hg_thread_key_delete(hg_log_async_key_g);
+error_key:
+    hg_thread_mutex_destroy(&hg_log_async_mutex_g);
+error:
+    hg_atomic_set32(&hg_log_async_init_g, HG_LOG_ASYNC_INIT_NONE);
+    return HG_UTIL_FAIL;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_log_async_atexit(void)
+{
+    struct hg_log_buf *buf;
+
+    hg_log_set_async(HG_UTIL_FALSE, 0);
+
+    /* Buffers may still be referenced by threads, prevent further use */
+    hg_atomic_set32(&hg_log_async_init_g, HG_LOG_ASYNC_INIT_EXIT);
+
+    hg_thread_mutex_lock(&hg_log_async_mutex_g);
+    buf = hg_log_async_bufs_g;
+    hg_log_async_bufs_g = NULL;
+    hg_thread_mutex_unlock(&hg_log_async_mutex_g);
+
+    while (buf != NULL) {
+        struct hg_log_buf *next = buf->next;
+
+        free(buf->data);
+        free(buf);
+        buf = next;
+    }
+    hg_thread_setspecific(hg_log_async_key_g, NULL);
+
+    hg_eventcount_destroy(&hg_log_async_ec_g);
+    hg_thread_key_delete(hg_log_async_key_g);
+    hg_thread_mutex_destroy(&hg_log_async_mutex_g);
+}
+
+/*---------------------------------------------------------------------------*/
+int
+hg_log_set_async(hg_util_bool_t enable, unsigned int buf_size)
+{
+    if (hg_log_async_init() != HG_UTIL_SUCCESS)
+        return HG_UTIL_FAIL;
+
+    if (enable) {
+        if (!hg_atomic_cas32(&hg_log_async_g, 0, 1))
+            return HG_UTIL_SUCCESS; /* Already enabled */
+
+        /* Only applies to buffers of threads that did not log yet */
+        if (buf_size)
+            hg_log_async_buf_size_g =
+                HG_LOG_ALIGN((size_t) ((buf_size < HG_LOG_ASYNC_BUF_SIZE_MIN)
+                                           ? HG_LOG_ASYNC_BUF_SIZE_MIN
+                                           : buf_size));
+        if (hg_thread_create(&hg_log_async_thread_g, hg_log_async_thread,
+                NULL) != HG_UTIL_SUCCESS) {
+            hg_atomic_set32(&hg_log_async_g, 0);
+            return HG_UTIL_FAIL;
+        }
+    } else if (hg_atomic_cas32(&hg_log_async_g, 1, 0)) {
+        hg_eventcount_notify_all(&hg_log_async_ec_g);
+        hg_thread_join(hg_log_async_thread_g);
+        hg_log_flush();
+    }
+
+    return HG_UTIL_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_log_flush(void)
+{
+    struct hg_log_buf *buf;
+
+    if (hg_atomic_get32(&hg_log_async_init_g) != HG_LOG_ASYNC_INIT_DONE)
+        return;
+
+    /* Serializes consumers */
+    hg_thread_mutex_lock(&hg_log_async_mutex_g);
+    for (buf = hg_log_async_bufs_g; buf != NULL; buf = buf->next)
+        hg_log_buf_drain(buf);
+    hg_thread_mutex_unlock(&hg_log_async_mutex_g);
+}
@@ -13,6 +13,8 @@
 
 #include "mercury_util_config.h"
 
+#include "mercury_atomic.h"
+
 #include <stdio.h>
 
 #define HG_LOG_TYPE_NONE    0
@@ -31,20 +33,33 @@
 #    define __func__ __FUNCTION__
 #endif
 
+/* Default size of per-thread asynchronous log buffers */
+#define HG_LOG_ASYNC_BUF_SIZE_DEFAULT (64 * 1024)
+
+/* Per call site state used for rate limiting */
+struct hg_log_site {
+    hg_atomic_int64_t window; /* Start of current window (ns) */
+    hg_atomic_int32_t count;  /* Messages written in current window */
+    hg_atomic_int32_t suppressed; /* Messages suppressed in current window */
+};
+
 #define HG_LOG_WRITE_ERROR(HG_LOG_MODULE_NAME, ...)                            \
     do {                                                                       \
-        hg_log_write(HG_LOG_TYPE_ERROR, HG_LOG_MODULE_NAME, __FILE__,          \
-            __LINE__, __func__, __VA_ARGS__);                                  \
+        static struct hg_log_site hg_log_site_;                               \
+        hg_log_write_site(&hg_log_site_, HG_LOG_TYPE_ERROR,                    \
+            HG_LOG_MODULE_NAME, __FILE__, __LINE__, __func__, __VA_ARGS__);    \
     } while (0)
 #define HG_LOG_WRITE_DEBUG(HG_LOG_MODULE_NAME, ...)                            \
     do {                                                                       \
-        hg_log_write(HG_LOG_TYPE_DEBUG, HG_LOG_MODULE_NAME, __FILE__,          \
-            __LINE__, __func__, __VA_ARGS__);                                  \
+        static struct hg_log_site hg_log_site_;                               \
+        hg_log_write_site(&hg_log_site_, HG_LOG_TYPE_DEBUG,                    \
+            HG_LOG_MODULE_NAME, __FILE__, __LINE__, __func__, __VA_ARGS__);    \
     } while (0)
 #define HG_LOG_WRITE_WARNING(HG_LOG_MODULE_NAME, ...)                          \
     do {                                                                       \
-        hg_log_write(HG_LOG_TYPE_WARNING, HG_LOG_MODULE_NAME, __FILE__,        \
-            __LINE__, __func__, __VA_ARGS__);                                  \
+        static struct hg_log_site hg_log_site_;                               \
+        hg_log_write_site(&hg_log_site_, HG_LOG_TYPE_WARNING,                  \
+            HG_LOG_MODULE_NAME, __FILE__, __LINE__, __func__, __VA_ARGS__);    \
     } while (0)
 
 #ifdef __cplusplus
@@ -97,6 +112,67 @@ HG_UTIL_PUBLIC void
 hg_log_write(unsigned int log_type, const char *module, const char *file,
     unsigned int line, const char *func, const char *format, ...);
 
+/**
+ * Write log from call site, applying rate limiting (see HG_LOG_WRITE_*()).
+ *
+ * \param site [IN/OUT]         pointer to call site state
+ * \param log_type [IN]         log type (HG_LOG_TYPE_DEBUG, etc)
+ * \param module [IN]           module name
+ * \param file [IN]             file name
+ * \param line [IN]             line number
+ * \param func [IN]             function name
+ * \param format [IN]           string format
+ */
+HG_UTIL_PUBLIC void
+hg_log_write_site(struct hg_log_site *site, unsigned int log_type,
+    const char *module, const char *file, unsigned int line, const char *func,
+    const char *format, ...);
+
+/**
+ * Convert log level name ("none", "error", "warning" or "debug") to a log
+ * mask. Each level includes the levels above it.
+ *
+ * \param level [IN]            log level name
+ * \param mask [OUT]            pointer to returned log mask
+ *
+ * \return Non-negative on success or negative if level is unknown
+ */
+HG_UTIL_PUBLIC int
+hg_log_level_to_mask(const char *level, unsigned int *mask);
+
+/**
+ * Limit each call site to burst messages per interval, messages above that
+ * limit are dropped and counted. Error messages are never dropped. A burst of
+ * 0 disables rate limiting (default).
+ *
+ * \param burst [IN]            max number of messages per interval
+ * \param interval_ms [IN]      interval (in milliseconds)
+ */
+HG_UTIL_PUBLIC void
+hg_log_set_rate_limit(unsigned int burst, unsigned int interval_ms);
+
+/**
+ * Enable or disable asynchronous logging. When enabled, debug and warning
+ * messages are recorded in binary form (format pointer and arguments) into
+ * per-thread lock-free ring buffers that a background thread formats and
+ * writes. Error messages are still written synchronously. Records are
+ * dropped (and counted) if a ring buffer is full. Pending records are written
+ * and buffers released at exit, asynchronous logging cannot be enabled after.
+ *
+ * \param enable [IN]           enable asynchronous logging
+ * \param buf_size [IN]         size of per-thread buffers (0 for default)
+ *
+ * \return Non-negative on success or negative on failure
+ */
+HG_UTIL_PUBLIC int
+hg_log_set_async(hg_util_bool_t enable, unsigned int buf_size);
+
+/**
+ * Format and write all pending asynchronous log records.
+ */
+HG_UTIL_PUBLIC void
+hg_log_flush(void);
+
 #ifdef __cplusplus
 }
 #endif
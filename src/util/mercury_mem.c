@@ -10,6 +10,7 @@
 
 #include "mercury_mem.h"
 
+#include "mercury_atomic.h"
 #include "mercury_util_error.h"
 
 #ifdef _WIN32
@@ -24,6 +25,22 @@
 #    include <unistd.h>
 #endif
 #include <stdlib.h>
+#include <string.h>
+
+/*******************/
+/* Local Variables */
+/*******************/
+
+#ifdef HG_UTIL_HAS_MEM_STATS
+/* Memory usage counters */
+static hg_atomic_int64_t hg_mem_usage_current_g[HG_MEM_USAGE_MAX];
+static hg_atomic_int64_t hg_mem_usage_high_water_g[HG_MEM_USAGE_MAX];
+#endif
+
+/* Memory usage category names */
+static const char *const hg_mem_usage_names_g[HG_MEM_USAGE_MAX] = {"handle",
+    "msg_buf", "na_op", "na_pool", "sm_region", "sm_copy_buf",
+    "completion_queue", "proc_extra", "bulk"};
 
 /*---------------------------------------------------------------------------*/
 long
@@ -177,3 +194,63 @@ hg_mem_shm_unmap(const char *name, void *mem_ptr, size_t size)
 done:
     return ret;
 }
+
+#ifdef HG_UTIL_HAS_MEM_STATS
+/*---------------------------------------------------------------------------*/
+void
+hg_mem_usage_add(hg_mem_usage_type_t type, size_t size)
+{
+    hg_util_int64_t old, new, max;
+
+    do {
+        old = hg_atomic_get64(&hg_mem_usage_current_g[type]);
+        new = old + (hg_util_int64_t) size;
+    } while (!hg_atomic_cas64(&hg_mem_usage_current_g[type], old, new));
+
+    /* Update high-water mark */
+    max = hg_atomic_get64(&hg_mem_usage_high_water_g[type]);
+    while (new > max &&
+           !hg_atomic_cas64(&hg_mem_usage_high_water_g[type], max, new))
+        max = hg_atomic_get64(&hg_mem_usage_high_water_g[type]);
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_mem_usage_sub(hg_mem_usage_type_t type, size_t size)
+{
+    hg_util_int64_t old;
+
+    do {
+        old = hg_atomic_get64(&hg_mem_usage_current_g[type]);
+    } while (!hg_atomic_cas64(&hg_mem_usage_current_g[type], old,
+        old - (hg_util_int64_t) size));
+}
+#endif
+
+/*---------------------------------------------------------------------------*/
+void
+hg_mem_usage_get(struct hg_mem_usage *usage)
+{
+#ifdef HG_UTIL_HAS_MEM_STATS
+    unsigned int i;
+
+    for (i = 0; i < HG_MEM_USAGE_MAX; i++) {
+        usage->current[i] =
+            (hg_util_uint64_t) hg_atomic_get64(&hg_mem_usage_current_g[i]);
+        usage->high_water[i] =
+            (hg_util_uint64_t) hg_atomic_get64(&hg_mem_usage_high_water_g[i]);
+    }
+#else
+    memset(usage, 0, sizeof(*usage));
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+const char *
+hg_mem_usage_type_to_string(hg_mem_usage_type_t type)
+{
+    if ((int) type < 0 || type >= HG_MEM_USAGE_MAX)
+        return "UNDEFINED/UNRECOGNIZED TYPE";
+
+    return hg_mem_usage_names_g[type];
+}
@@ -17,6 +17,26 @@
 /* Public Type and Struct Definition */
 /*************************************/
 
+/* Memory usage categories */
+typedef enum hg_mem_usage_type {
+    HG_MEM_USAGE_HANDLE,           /*!< RPC handles */
+    HG_MEM_USAGE_MSG_BUF,          /*!< message buffers of RPC handles */
+    HG_MEM_USAGE_NA_OP,            /*!< NA operation IDs */
+    HG_MEM_USAGE_NA_POOL,          /*!< NA plugin buffer pools */
+    HG_MEM_USAGE_SM_REGION,        /*!< NA SM regions, excl. copy buffers */
+    HG_MEM_USAGE_SM_COPY_BUF,      /*!< NA SM copy buffers */
+    HG_MEM_USAGE_COMPLETION_QUEUE, /*!< context completion queues */
+    HG_MEM_USAGE_PROC_EXTRA,       /*!< proc extra (overflow) buffers */
+    HG_MEM_USAGE_BULK,             /*!< registered bulk regions */
+    HG_MEM_USAGE_MAX
+} hg_mem_usage_type_t;
+
+/* Memory usage report (bytes) */
+struct hg_mem_usage {
+    hg_util_uint64_t current[HG_MEM_USAGE_MAX];    /* Currently held */
+    hg_util_uint64_t high_water[HG_MEM_USAGE_MAX]; /* Max held */
+};
+
 /*****************/
 /* Public Macros */
 /*****************/
@@ -85,6 +105,49 @@ hg_mem_shm_map(const char *name, size_t size, hg_util_bool_t create);
 HG_UTIL_PUBLIC int
 hg_mem_shm_unmap(const char *name, void *mem_ptr, size_t size);
 
+#ifdef HG_UTIL_HAS_MEM_STATS
+/**
+ * Account size bytes as held in category type.
+ *
+ * \param type [IN]             memory usage category
+ * \param size [IN]             size in bytes
+ */
+HG_UTIL_PUBLIC void
+hg_mem_usage_add(hg_mem_usage_type_t type, size_t size);
+
+/**
+ * Account size bytes as released from category type.
+ *
+ * \param type [IN]             memory usage category
+ * \param size [IN]             size in bytes
+ */
+HG_UTIL_PUBLIC void
+hg_mem_usage_sub(hg_mem_usage_type_t type, size_t size);
+#else
+/* Accounting is compiled out, callers do not pay for shared counters */
+#    define hg_mem_usage_add(type, size) ((void) (type), (void) (size))
+#    define hg_mem_usage_sub(type, size) ((void) (type), (void) (size))
+#endif
+
+/**
+ * Retrieve current and high-water memory usage of all categories. Values are
+ * always zero if memory usage is not accounted (HG_UTIL_HAS_MEM_STATS).
+ *
+ * \param usage [OUT]           pointer to memory usage report
+ */
+HG_UTIL_PUBLIC void
+hg_mem_usage_get(struct hg_mem_usage *usage);
+
+/**
+ * Convert a memory usage category to a string.
+ *
+ * \param type [IN]             memory usage category
+ *
+ * \return String
+ */
+HG_UTIL_PUBLIC const char *
+hg_mem_usage_type_to_string(hg_mem_usage_type_t type);
+
 #ifdef __cplusplus
 }
 #endif
@@ -205,10 +205,23 @@ hg_poll_add(hg_poll_set_t *poll_set, int fd, struct hg_poll_event *event)
     if (event->events & HG_POLLOUT)
         poll_flags |= EPOLLOUT;
 
-    ev.events = poll_flags;
     ev.data.u64 = (uint64_t) event->data.u64;
 
+#    ifdef EPOLLEXCLUSIVE
+    if (event->events & HG_POLLEXCLUSIVE) {
+        ev.events = poll_flags | EPOLLEXCLUSIVE;
+        rc = epoll_ctl(poll_set->fd, EPOLL_CTL_ADD, fd, &ev);
+        /* Not supported by kernel or fd is an epoll fd, add without it */
+        if (rc == 0 || errno != EINVAL)
+            goto added;
+    }
+#    endif
+
+    ev.events = poll_flags;
     rc = epoll_ctl(poll_set->fd, EPOLL_CTL_ADD, fd, &ev);
+#    ifdef EPOLLEXCLUSIVE
+added:
+#    endif
     HG_UTIL_CHECK_ERROR(rc != 0, done, ret, HG_UTIL_FAIL,
         "epoll_ctl() failed (%s)", strerror(errno));
 #elif defined(HG_UTIL_HAS_SYSEVENT_H)
@@ -43,6 +43,11 @@ struct hg_poll_event {
 #define HG_POLLERR 0x008 /* Error condition. */
 #define HG_POLLHUP 0x010 /* Hung up. */
 
+/**
+ * Poll flags (passed with events to hg_poll_add()).
+ */
+#define HG_POLLEXCLUSIVE 0x100 /* Wake up one waiter only, when supported */
+
 /*********************/
 /* Public Prototypes */
 /*********************/
@@ -80,7 +85,9 @@ HG_UTIL_PUBLIC int
 hg_poll_get_fd(hg_poll_set_t *poll_set);
 
 /**
- * Add file descriptor to poll set.
+ * Add file descriptor to poll set. With HG_POLLEXCLUSIVE, only one of the
+ * poll sets that share fd gets woken up when fd becomes ready (EPOLLEXCLUSIVE),
+ * the flag is ignored when the system or fd does not support it.
  *
  * \param poll_set [IN]         pointer to poll set
  * \param fd [IN]               file descriptor
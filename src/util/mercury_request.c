@@ -9,8 +9,7 @@
  */
 
 #include "mercury_request.h"
-#include "mercury_thread_condition.h"
-#include "mercury_thread_mutex.h"
+#include "mercury_eventcount.h"
 #include "mercury_time.h"
 #include "mercury_util_error.h"
 
@@ -28,9 +27,8 @@ struct hg_request_class {
     hg_request_progress_func_t progress_func;
     hg_request_trigger_func_t trigger_func;
     void *arg;
-    hg_util_bool_t progressing;
-    hg_thread_mutex_t progress_mutex;
-    hg_thread_cond_t progress_cond;
+    hg_atomic_int32_t progressing; /* One thread makes progress at a time */
+    hg_eventcount_t progress_ec;   /* Wait for progressing thread */
 };
 
 /********************/
@@ -49,10 +47,13 @@ hg_request_check(hg_request_t *request)
     unsigned int trigger_flag = 0;
     hg_util_bool_t ret = HG_UTIL_FALSE;
 
-    do {
-        trigger_ret = request->request_class->trigger_func(
-            0, &trigger_flag, request->request_class->arg);
-    } while ((trigger_ret == HG_UTIL_SUCCESS) && trigger_flag);
+    /* Completed requests do not need to go through trigger */
+    if (!hg_atomic_get32(&request->completed)) {
+        do {
+            trigger_ret = request->request_class->trigger_func(
+                0, &trigger_flag, request->request_class->arg);
+        } while ((trigger_ret == HG_UTIL_SUCCESS) && trigger_flag);
+    }
 
     if (hg_atomic_cas32(&request->completed, HG_UTIL_TRUE, HG_UTIL_FALSE))
         ret = HG_UTIL_TRUE;
@@ -75,9 +76,8 @@ hg_request_init(hg_request_progress_func_t progress_func,
     hg_request_class->progress_func = progress_func;
     hg_request_class->trigger_func = trigger_func;
     hg_request_class->arg = arg;
-    hg_request_class->progressing = HG_UTIL_FALSE;
-    hg_thread_mutex_init(&hg_request_class->progress_mutex);
-    hg_thread_cond_init(&hg_request_class->progress_cond);
+    hg_atomic_init32(&hg_request_class->progressing, HG_UTIL_FALSE);
+    hg_eventcount_init(&hg_request_class->progress_ec);
 
 done:
     return hg_request_class;
@@ -92,8 +92,7 @@ hg_request_finalize(hg_request_class_t *request_class, void **arg)
 
     if (arg)
         *arg = request_class->arg;
-    hg_thread_mutex_destroy(&request_class->progress_mutex);
-    hg_thread_cond_destroy(&request_class->progress_cond);
+    hg_eventcount_destroy(&request_class->progress_ec);
     free(request_class);
 
 done:
@@ -129,94 +128,96 @@ hg_request_destroy(hg_request_t *request)
     return ret;
 }
 
+/*---------------------------------------------------------------------------*/
+void
+hg_request_notify(hg_request_class_t *request_class)
+{
+    hg_eventcount_notify_all(&request_class->progress_ec);
+}
+
 /*---------------------------------------------------------------------------*/
 /*
- * lock(progress_mutex)
  * while (!completed) {
  *   check_request
- *   if (completed) {
- *     unlock(progress_mutex);
+ *   if (completed)
  *     return;
- *     }
- *   if (in_progress) {
- *     wait_cond(progress_cond);
+ *   if (!cas(in_progress, false, true)) {
+ *     key = prepare_wait(progress_ec);
+ *     if (in_progress && !request->completed)
+ *       commit_wait(progress_ec, key);
+ *     else
+ *       cancel_wait(progress_ec);
  *     continue;
  *   }
- *   in_progress = true;
- *   unlock(progress_mutex);
  *   trigger;
  *   progress;
- *   lock(progress);
  *   in_progress = false;
- *   signal(progress_cond);
+ *   notify_all(progress_ec);
  * }
- * unlock(progress_mutex);
  */
 
 /*---------------------------------------------------------------------------*/
 int
 hg_request_wait(hg_request_t *request, unsigned int timeout, unsigned int *flag)
 {
+    struct hg_request_class *request_class = request->request_class;
     double remaining =
         timeout / 1000.0; /* Convert timeout in ms into seconds */
     hg_util_bool_t completed = HG_UTIL_FALSE;
     int ret = HG_UTIL_SUCCESS;
 
-    hg_thread_mutex_lock(&request->request_class->progress_mutex);
-
     do {
-        hg_time_t t3, t4;
+        hg_time_fast_t t3, t4;
 
         completed = hg_request_check(request);
         if (completed)
             break;
 
-        if (request->request_class->progressing) {
-            hg_time_t t1, t2;
+        if (!hg_atomic_cas32(
+                &request_class->progressing, HG_UTIL_FALSE, HG_UTIL_TRUE)) {
+            hg_time_fast_t t1, t2;
+            hg_util_int32_t key;
 
             if (remaining <= 0) {
                 /* Timeout occurred so leave */
                 break;
             }
 
-            hg_time_get_current_ms(&t1);
-            if (hg_thread_cond_timedwait(&request->request_class->progress_cond,
-                    &request->request_class->progress_mutex,
-                    (unsigned int) (remaining * 1000.0)) != HG_UTIL_SUCCESS) {
+            t1 = hg_time_fast_now();
+            key = hg_eventcount_prepare_wait(&request_class->progress_ec);
+            if (!hg_atomic_get32(&request_class->progressing) ||
+                hg_atomic_get32(&request->completed))
+                hg_eventcount_cancel_wait(&request_class->progress_ec);
+            else if (hg_eventcount_commit_wait(&request_class->progress_ec,
+                         key, (unsigned int) (remaining * 1000.0)) !=
+                     HG_UTIL_SUCCESS) {
                 /* Timeout occurred so leave */
                 break;
             }
-            hg_time_get_current_ms(&t2);
-            remaining -= hg_time_diff(t2, t1);
+            t2 = hg_time_fast_now();
+            remaining -= hg_time_fast_diff(t2, t1);
             if (remaining < 0)
                 break;
             /* Continue as request may have completed in the meantime */
             continue;
         }
 
-        request->request_class->progressing = HG_UTIL_TRUE;
-
-        hg_thread_mutex_unlock(&request->request_class->progress_mutex);
-
         if (timeout)
-            hg_time_get_current_ms(&t3);
+            t3 = hg_time_fast_now();
 
-        request->request_class->progress_func(
-            (unsigned int) (remaining * 1000.0), request->request_class->arg);
+        request_class->progress_func(
+            (unsigned int) (remaining * 1000.0), request_class->arg);
 
         if (timeout) {
-            hg_time_get_current_ms(&t4);
-            remaining -= hg_time_diff(t4, t3);
+            t4 = hg_time_fast_now();
+            remaining -= hg_time_fast_diff(t4, t3);
         }
 
-        hg_thread_mutex_lock(&request->request_class->progress_mutex);
-        request->request_class->progressing = HG_UTIL_FALSE;
-        hg_thread_cond_broadcast(&request->request_class->progress_cond);
+        hg_atomic_set32(&request_class->progressing, HG_UTIL_FALSE);
+        hg_eventcount_notify_all(&request_class->progress_ec);
 
     } while (!completed && (remaining > 0));
 
-    hg_thread_mutex_unlock(&request->request_class->progress_mutex);
-
     if (flag)
         *flag = completed;
 
@@ -118,6 +118,15 @@ hg_request_destroy(hg_request_t *request);
 static HG_UTIL_INLINE int
 hg_request_reset(hg_request_t *request);
 
+/**
+ * Wake up threads waiting on requests of the class (internal, called by
+ * hg_request_complete()).
+ *
+ * \param request_class [IN]    pointer to request class
+ */
+HG_UTIL_PUBLIC void
+hg_request_notify(hg_request_class_t *request_class);
+
 /**
  * Mark the request as completed. (most likely called by a callback triggered
  * after a call to trigger)
@@ -203,6 +212,9 @@ hg_request_complete(hg_request_t *request)
 {
     hg_atomic_incr32(&request->completed);
 
+    /* Waiters parked behind the progressing thread re-check their request */
+    hg_request_notify(request->request_class);
+
     return HG_UTIL_SUCCESS;
 }
 
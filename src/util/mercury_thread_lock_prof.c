@@ -0,0 +1,245 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#include "mercury_thread_lock_prof.h"
+
+#include "mercury_atomic.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/****************/
+/* Local Macros */
+/****************/
+
+/* Time acquisition of a lock that was not immediately available */
+#define HG_THREAD_LOCK_PROF_WAIT(lock, prof)                                   \
+    do {                                                                       \
+        hg_time_fast_t t0;                                                     \
+                                                                               \
+        if (prof == NULL)                                                      \
+            return (lock);                                                     \
+        t0 = hg_time_fast_now();                                               \
+        if ((lock) != HG_UTIL_SUCCESS)                                         \
+            return HG_UTIL_FAIL;                                               \
+        hg_thread_lock_prof_record(                                            \
+            prof, HG_UTIL_TRUE, hg_time_fast_now() - t0);                      \
+                                                                               \
+        return HG_UTIL_SUCCESS;                                                \
+    } while (0)
+
+/************************************/
+/* Local Type and Struct Definition */
+/************************************/
+
+/* Lock profile slot, keyed by name pointer (0 if slot is free) */
+struct hg_thread_lock_prof {
+    hg_atomic_int64_t name;            /* Lock name */
+    hg_atomic_int64_t acquire_count;   /* Number of acquisitions */
+    hg_atomic_int64_t contended_count; /* Acquisitions that had to wait */
+    hg_atomic_int64_t wait;            /* Time spent waiting (fast ticks) */
+};
+
+/********************/
+/* Local Prototypes */
+/********************/
+
+#ifdef HG_UTIL_HAS_LOCK_PROF
+/**
+ * Find or insert slot of name. Slots are never released so lookups are
+ * lock-free. Returns NULL if the table is full.
+ */
+static struct hg_thread_lock_prof *
+hg_thread_lock_prof_lookup(const char *name);
+#endif
+
+/**
+ * Sort profiles by decreasing wait time.
+ */
+static int
+hg_thread_lock_prof_cmp(const void *a, const void *b);
+
+/*******************/
+/* Local Variables */
+/*******************/
+
+/* Lock profile table */
+static struct hg_thread_lock_prof
+    hg_thread_lock_prof_table_g[HG_THREAD_LOCK_PROF_MAX];
+
+/*---------------------------------------------------------------------------*/
+#ifdef HG_UTIL_HAS_LOCK_PROF
+static struct hg_thread_lock_prof *
+hg_thread_lock_prof_lookup(const char *name)
+{
+    hg_util_int64_t key = (hg_util_int64_t) (intptr_t) name;
+    unsigned int hash =
+        (unsigned int) (((uintptr_t) name >> 4) % HG_THREAD_LOCK_PROF_MAX);
+    unsigned int i;
+
+    for (i = 0; i < HG_THREAD_LOCK_PROF_MAX; i++) {
+        struct hg_thread_lock_prof *prof =
+            &hg_thread_lock_prof_table_g[(hash + i) % HG_THREAD_LOCK_PROF_MAX];
+        hg_util_int64_t slot_key = hg_atomic_get64(&prof->name);
+
+        if (slot_key == 0 && (hg_atomic_cas64(&prof->name, 0, key) ||
+                                 hg_atomic_get64(&prof->name) == key))
+            return prof;
+        if (slot_key == key)
+            return prof;
+    }
+
+    return NULL;
+}
+#endif
+
+/*---------------------------------------------------------------------------*/
+static int
+hg_thread_lock_prof_cmp(const void *a, const void *b)
+{
+    const struct hg_thread_lock_prof_info *info_a =
+        (const struct hg_thread_lock_prof_info *) a;
+    const struct hg_thread_lock_prof_info *info_b =
+        (const struct hg_thread_lock_prof_info *) b;
+
+    if (info_a->wait_ns != info_b->wait_ns)
+        return (info_a->wait_ns < info_b->wait_ns) ? 1 : -1;
+    if (info_a->contended_count != info_b->contended_count)
+        return (info_a->contended_count < info_b->contended_count) ? 1 : -1;
+
+    return strcmp(info_a->name, info_b->name);
+}
+
+/*---------------------------------------------------------------------------*/
+hg_thread_lock_prof_t
+hg_thread_lock_prof_register(const char *name)
+{
+#ifdef HG_UTIL_HAS_LOCK_PROF
+    return hg_thread_lock_prof_lookup(name);
+#else
+    (void) name;
+
+    return NULL;
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_thread_lock_prof_record(
+    hg_thread_lock_prof_t prof, hg_util_bool_t contended, hg_time_fast_t wait)
+{
+    hg_util_int64_t prev;
+
+    hg_atomic_incr64(&prof->acquire_count);
+    if (!contended)
+        return;
+
+    hg_atomic_incr64(&prof->contended_count);
+    do {
+        prev = hg_atomic_get64(&prof->wait);
+    } while (!hg_atomic_cas64(
+        &prof->wait, prev, prev + (hg_util_int64_t) wait));
+}
+
+/*---------------------------------------------------------------------------*/
+int
+hg_thread_spin_lock_prof_slow(
+    hg_thread_spin_t *lock, hg_thread_lock_prof_t prof)
+{
+    HG_THREAD_LOCK_PROF_WAIT(hg_thread_spin_lock(lock), prof);
+}
+
+/*---------------------------------------------------------------------------*/
+int
+hg_thread_mutex_lock_prof_slow(
+    hg_thread_mutex_t *mutex, hg_thread_lock_prof_t prof)
+{
+    HG_THREAD_LOCK_PROF_WAIT(hg_thread_mutex_lock(mutex), prof);
+}
+
+/*---------------------------------------------------------------------------*/
+int
+hg_thread_rwlock_rdlock_prof_slow(
+    hg_thread_rwlock_t *rwlock, hg_thread_lock_prof_t prof)
+{
+    HG_THREAD_LOCK_PROF_WAIT(hg_thread_rwlock_rdlock(rwlock), prof);
+}
+
+/*---------------------------------------------------------------------------*/
+int
+hg_thread_rwlock_wrlock_prof_slow(
+    hg_thread_rwlock_t *rwlock, hg_thread_lock_prof_t prof)
+{
+    HG_THREAD_LOCK_PROF_WAIT(hg_thread_rwlock_wrlock(rwlock), prof);
+}
+
+/*---------------------------------------------------------------------------*/
+unsigned int
+hg_thread_lock_prof_get(
+    struct hg_thread_lock_prof_info *info, unsigned int max)
+{
+    struct hg_thread_lock_prof_info *merged;
+    unsigned int count = 0, i, j;
+
+    merged = (struct hg_thread_lock_prof_info *) malloc(
+        HG_THREAD_LOCK_PROF_MAX * sizeof(struct hg_thread_lock_prof_info));
+    if (merged == NULL)
+        return 0;
+
+    /* Same name may be registered with different pointers, merge them */
+    for (i = 0; i < HG_THREAD_LOCK_PROF_MAX; i++) {
+        struct hg_thread_lock_prof *prof = &hg_thread_lock_prof_table_g[i];
+        const char *name =
+            (const char *) (intptr_t) hg_atomic_get64(&prof->name);
+
+        if (name == NULL)
+            continue;
+
+        for (j = 0; j < count; j++)
+            if (strcmp(merged[j].name, name) == 0)
+                break;
+        if (j == count) {
+            memset(&merged[j], 0, sizeof(merged[j]));
+            merged[j].name = name;
+            count++;
+        }
+        merged[j].acquire_count +=
+            (hg_util_uint64_t) hg_atomic_get64(&prof->acquire_count);
+        merged[j].contended_count +=
+            (hg_util_uint64_t) hg_atomic_get64(&prof->contended_count);
+        merged[j].wait_ns += hg_time_fast_to_ns(
+            (hg_time_fast_t) hg_atomic_get64(&prof->wait));
+    }
+
+    qsort(merged, count, sizeof(struct hg_thread_lock_prof_info),
+        hg_thread_lock_prof_cmp);
+
+    if (count > max)
+        count = max;
+    memcpy(info, merged, count * sizeof(struct hg_thread_lock_prof_info));
+    free(merged);
+
+    return count;
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_thread_lock_prof_reset(void)
+{
+    unsigned int i;
+
+    /* Names are kept, slots are never released */
+    for (i = 0; i < HG_THREAD_LOCK_PROF_MAX; i++) {
+        hg_atomic_set64(&hg_thread_lock_prof_table_g[i].acquire_count, 0);
+        hg_atomic_set64(&hg_thread_lock_prof_table_g[i].contended_count, 0);
+        hg_atomic_set64(&hg_thread_lock_prof_table_g[i].wait, 0);
+    }
+}
@@ -0,0 +1,232 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#ifndef MERCURY_THREAD_LOCK_PROF_H
+#define MERCURY_THREAD_LOCK_PROF_H
+
+#include "mercury_util_config.h"
+
+#include "mercury_thread_mutex.h"
+#include "mercury_thread_rwlock.h"
+#include "mercury_thread_spin.h"
+#include "mercury_time.h"
+
+/*
+ * Profiled lock wrappers. When MERCURY_ENABLE_LOCK_PROF is set, a profile is
+ * registered under a name when the lock is initialized (locks sharing a name
+ * are aggregated) and every acquisition made through one of the *_prof()
+ * calls below is accounted to it: number of acquisitions, number of contended
+ * acquisitions (lock was not immediately available) and time spent waiting.
+ * Otherwise profiles are NULL and the wrappers reduce to the plain lock calls.
+ */
+
+/*************************************/
+/* Public Type and Struct Definition */
+/*************************************/
+
+/* Lock profile handle, NULL if profiling is not enabled */
+typedef struct hg_thread_lock_prof *hg_thread_lock_prof_t;
+
+/* Named lock profile */
+struct hg_thread_lock_prof_info {
+    const char *name;                 /* Lock name */
+    hg_util_uint64_t acquire_count;   /* Number of acquisitions */
+    hg_util_uint64_t contended_count; /* Acquisitions that had to wait */
+    hg_util_uint64_t wait_ns;         /* Total time spent waiting (ns) */
+};
+
+/*****************/
+/* Public Macros */
+/*****************/
+
+/* Max number of distinct lock names that can be profiled */
+#ifndef HG_THREAD_LOCK_PROF_MAX
+#    define HG_THREAD_LOCK_PROF_MAX 128
+#endif
+
+/*********************/
+/* Public Prototypes */
+/*********************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Get the profile of locks named name, to be called once when the lock is
+ * initialized.
+ *
+ * \param name [IN]             lock name (must remain valid)
+ *
+ * \return Profile, or NULL if profiling is not enabled or if the table of
+ * profiles is full
+ */
+HG_UTIL_PUBLIC hg_thread_lock_prof_t
+hg_thread_lock_prof_register(const char *name);
+
+/**
+ * Account an acquisition of a lock (internal, use the *_prof() lock calls).
+ *
+ * \param prof [IN]             lock profile
+ * \param contended [IN]        lock was not immediately available
+ * \param wait [IN]             time spent waiting
+ */
+HG_UTIL_PUBLIC void
+hg_thread_lock_prof_record(
+    hg_thread_lock_prof_t prof, hg_util_bool_t contended, hg_time_fast_t wait);
+
+/**
+ * Wait for the lock and account contended acquisition to prof (internal,
+ * use the *_prof() lock calls).
+ *
+ * \param lock [IN/OUT]         pointer to lock object
+ * \param prof [IN]             lock profile
+ *
+ * \return Non-negative on success or negative on failure
+ */
+HG_UTIL_PUBLIC int
+hg_thread_spin_lock_prof_slow(
+    hg_thread_spin_t *lock, hg_thread_lock_prof_t prof);
+HG_UTIL_PUBLIC int
+hg_thread_mutex_lock_prof_slow(
+    hg_thread_mutex_t *mutex, hg_thread_lock_prof_t prof);
+HG_UTIL_PUBLIC int
+hg_thread_rwlock_rdlock_prof_slow(
+    hg_thread_rwlock_t *rwlock, hg_thread_lock_prof_t prof);
+HG_UTIL_PUBLIC int
+hg_thread_rwlock_wrlock_prof_slow(
+    hg_thread_rwlock_t *rwlock, hg_thread_lock_prof_t prof);
+
+/**
+ * Retrieve lock profiles, hottest locks (most time spent waiting) first.
+ *
+ * \param info [OUT]            array of at least max profiles
+ * \param max [IN]              max number of profiles returned
+ *
+ * \return Number of profiles returned (0 if profiling is not enabled)
+ */
+HG_UTIL_PUBLIC unsigned int
+hg_thread_lock_prof_get(
+    struct hg_thread_lock_prof_info *info, unsigned int max);
+
+/**
+ * Reset all lock profiles.
+ */
+HG_UTIL_PUBLIC void
+hg_thread_lock_prof_reset(void);
+
+/**
+ * Lock the spin lock and account acquisition to prof.
+ *
+ * \param lock [IN/OUT]         pointer to lock object
+ * \param prof [IN]             lock profile
+ *
+ * \return Non-negative on success or negative on failure
+ */
+static HG_UTIL_INLINE int
+hg_thread_spin_lock_prof(hg_thread_spin_t *lock, hg_thread_lock_prof_t prof);
+
+/**
+ * Lock the mutex and account acquisition to prof.
+ *
+ * \param mutex [IN/OUT]        pointer to mutex object
+ * \param prof [IN]             lock profile
+ *
+ * \return Non-negative on success or negative on failure
+ */
+static HG_UTIL_INLINE int
+hg_thread_mutex_lock_prof(
+    hg_thread_mutex_t *mutex, hg_thread_lock_prof_t prof);
+
+/**
+ * Take a read lock on the rwlock and account acquisition to prof.
+ *
+ * \param rwlock [IN/OUT]       pointer to rwlock object
+ * \param prof [IN]             lock profile
+ *
+ * \return Non-negative on success or negative on failure
+ */
+static HG_UTIL_INLINE int
+hg_thread_rwlock_rdlock_prof(
+    hg_thread_rwlock_t *rwlock, hg_thread_lock_prof_t prof);
+
+/**
+ * Take a write lock on the rwlock and account acquisition to prof.
+ *
+ * \param rwlock [IN/OUT]       pointer to rwlock object
+ * \param prof [IN]             lock profile
+ *
+ * \return Non-negative on success or negative on failure
+ */
+static HG_UTIL_INLINE int
+hg_thread_rwlock_wrlock_prof(
+    hg_thread_rwlock_t *rwlock, hg_thread_lock_prof_t prof);
+
+/* Try lock first, only acquisitions that have to wait are timed */
+#ifdef HG_UTIL_HAS_LOCK_PROF
+#    define HG_THREAD_LOCK_PROF(try_lock, lock, lock_slow, prof)               \
+        do {                                                                   \
+            if ((try_lock) != HG_UTIL_SUCCESS)                                 \
+                return (lock_slow);                                            \
+            if (prof)                                                          \
+                hg_thread_lock_prof_record(prof, HG_UTIL_FALSE, 0);            \
+            return HG_UTIL_SUCCESS;                                            \
+        } while (0)
+#else
+#    define HG_THREAD_LOCK_PROF(try_lock, lock, lock_slow, prof)               \
+        do {                                                                   \
+            (void) (prof);                                                     \
+            return (lock);                                                     \
+        } while (0)
+#endif
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE int
+hg_thread_spin_lock_prof(hg_thread_spin_t *lock, hg_thread_lock_prof_t prof)
+{
+    HG_THREAD_LOCK_PROF(hg_thread_spin_try_lock(lock),
+        hg_thread_spin_lock(lock), hg_thread_spin_lock_prof_slow(lock, prof),
+        prof);
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE int
+hg_thread_mutex_lock_prof(hg_thread_mutex_t *mutex, hg_thread_lock_prof_t prof)
+{
+    HG_THREAD_LOCK_PROF(hg_thread_mutex_try_lock(mutex),
+        hg_thread_mutex_lock(mutex),
+        hg_thread_mutex_lock_prof_slow(mutex, prof), prof);
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE int
+hg_thread_rwlock_rdlock_prof(
+    hg_thread_rwlock_t *rwlock, hg_thread_lock_prof_t prof)
+{
+    HG_THREAD_LOCK_PROF(hg_thread_rwlock_try_rdlock(rwlock),
+        hg_thread_rwlock_rdlock(rwlock),
+        hg_thread_rwlock_rdlock_prof_slow(rwlock, prof), prof);
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE int
+hg_thread_rwlock_wrlock_prof(
+    hg_thread_rwlock_t *rwlock, hg_thread_lock_prof_t prof)
+{
+    HG_THREAD_LOCK_PROF(hg_thread_rwlock_try_wrlock(rwlock),
+        hg_thread_rwlock_wrlock(rwlock),
+        hg_thread_rwlock_wrlock_prof_slow(rwlock, prof), prof);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MERCURY_THREAD_LOCK_PROF_H */
@@ -10,28 +10,137 @@
 
 #include "mercury_thread_pool.h"
 
+#include "mercury_atomic_queue.h"
+#include "mercury_eventcount.h"
+#include "mercury_thread_spin.h"
 #include "mercury_util_error.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 /****************/
 /* Local Macros */
 /****************/
 
+/* Number of steal rounds before a worker goes to sleep */
+#define HG_THREAD_POOL_SPIN_COUNT (16)
+
+/* Full (store-load) memory barrier required by the deque, hg_atomic_fence()
+ * only provides acquire/release semantics */
+#define HG_THREAD_POOL_MB() HG_EVENTCOUNT_MB()
+
+/* Owner-only counter increment (read concurrently by get_stats) */
+#define HG_THREAD_POOL_STAT_INCR(x)                                            \
+    hg_atomic_set64(&(x), hg_atomic_get64(&(x)) + 1)
+
 /************************************/
 /* Local Type and Struct Definition */
 /************************************/
 
-struct hg_thread_pool_private {
-    struct hg_thread_pool pool;
+/* Chase-Lev work-stealing deque (fixed size): the owner pushes and pops at
+ * the bottom, thieves take from the top */
+struct hg_thread_pool_deque {
+    hg_atomic_int64_t top __attribute__((aligned(HG_MEM_CACHE_LINE_SIZE)));
+    hg_atomic_int64_t bottom __attribute__((aligned(HG_MEM_CACHE_LINE_SIZE)));
+    hg_atomic_int64_t *buf;
+    hg_util_int64_t mask;
+};
+
+/* Per-worker stats */
+struct hg_thread_pool_worker_stats {
+    hg_atomic_int64_t executed;
+    hg_atomic_int64_t local;
+    hg_atomic_int64_t injected;
+    hg_atomic_int64_t stolen;
+    hg_atomic_int64_t parked;
+};
+
+/* Worker */
+struct hg_thread_pool_worker {
+    struct hg_thread_pool_deque deque;
+    struct hg_thread_pool_worker_stats stats;
+    struct hg_thread_pool *pool;
+    hg_thread_t thread;
+    unsigned int id;
+    hg_util_uint32_t seed; /* Victim selection */
+    hg_util_bool_t started;
+} __attribute__((aligned(HG_MEM_CACHE_LINE_SIZE)));
+
+struct hg_thread_pool {
+    hg_eventcount_t event; /* Used to park idle workers */
+    struct hg_atomic_queue *inject_queue; /* MPMC injection queue */
+    HG_QUEUE_HEAD(hg_thread_work) overflow_queue; /* Injection overflow */
+    hg_thread_spin_t overflow_lock;
+    hg_atomic_int32_t overflow_count;
+    hg_atomic_int32_t posting; /* Number of posts in progress */
+    hg_atomic_int32_t shutdown; /* No longer accepting work */
+    hg_atomic_int32_t stop;     /* Workers exit once idle */
+    hg_thread_key_t worker_key; /* Worker of the calling thread */
+    struct hg_thread_pool_worker *workers;
     unsigned int thread_count;
-    hg_thread_t *threads;
+    hg_util_bool_t key_created;
 };
 
 /********************/
 /* Local Prototypes */
 /********************/
 
+/**
+ * Initialize deque.
+ */
+static int
+hg_thread_pool_deque_init(
+    struct hg_thread_pool_deque *deque, unsigned int deque_size);
+
+/**
+ * Push work to the bottom of the deque (owner only).
+ */
+static HG_UTIL_INLINE int
+hg_thread_pool_deque_push(
+    struct hg_thread_pool_deque *deque, struct hg_thread_work *work);
+
+/**
+ * Pop work from the bottom of the deque (owner only).
+ */
+static HG_UTIL_INLINE struct hg_thread_work *
+hg_thread_pool_deque_pop(struct hg_thread_pool_deque *deque);
+
+/**
+ * Steal work from the top of the deque.
+ */
+static HG_UTIL_INLINE struct hg_thread_work *
+hg_thread_pool_deque_steal(struct hg_thread_pool_deque *deque);
+
+/**
+ * Check whether the deque is empty.
+ */
+static HG_UTIL_INLINE hg_util_bool_t
+hg_thread_pool_deque_is_empty(struct hg_thread_pool_deque *deque);
+
+/**
+ * Push work to the injection queue.
+ */
+static void
+hg_thread_pool_inject(hg_thread_pool_t *pool, struct hg_thread_work *work);
+
+/**
+ * Get work from the injection queue.
+ */
+static struct hg_thread_work *
+hg_thread_pool_get_injected(hg_thread_pool_t *pool);
+
+/**
+ * Find work for worker.
+ */
+static struct hg_thread_work *
+hg_thread_pool_find_work(struct hg_thread_pool_worker *worker);
+
+/**
+ * Check whether there is work left anywhere in the pool.
+ */
+static hg_util_bool_t
+hg_thread_pool_has_work(hg_thread_pool_t *pool);
+
 /**
  * Worker thread run by the thread pool
  */
@@ -43,45 +152,241 @@ hg_thread_pool_worker(void *args);
 /*******************/
 
 /*---------------------------------------------------------------------------*/
-static HG_THREAD_RETURN_TYPE
-hg_thread_pool_worker(void *args)
+static int
+hg_thread_pool_deque_init(
+    struct hg_thread_pool_deque *deque, unsigned int deque_size)
 {
-    hg_thread_ret_t ret = 0;
-    hg_thread_pool_t *pool = (hg_thread_pool_t *) args;
-    struct hg_thread_work *work;
+    unsigned int i;
 
-    while (1) {
-        hg_thread_mutex_lock(&pool->mutex);
+    hg_atomic_init64(&deque->top, 0);
+    hg_atomic_init64(&deque->bottom, 0);
+    deque->mask = (hg_util_int64_t) deque_size - 1;
+    deque->buf =
+        (hg_atomic_int64_t *) malloc(deque_size * sizeof(hg_atomic_int64_t));
+    if (!deque->buf)
+        return HG_UTIL_FAIL;
+    for (i = 0; i < deque_size; i++)
+        hg_atomic_init64(&deque->buf[i], 0);
+
+    return HG_UTIL_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE int
+hg_thread_pool_deque_push(
+    struct hg_thread_pool_deque *deque, struct hg_thread_work *work)
+{
+    hg_util_int64_t b = hg_atomic_get64(&deque->bottom);
+    hg_util_int64_t t = hg_atomic_get64(&deque->top);
 
-        /* If not shutting down and nothing to do, worker sleeps */
-        while (!pool->shutdown && HG_QUEUE_IS_EMPTY(&pool->queue)) {
-            int rc;
+    /* Full, let caller use the injection queue */
+    if (b - t > deque->mask)
+        return HG_UTIL_FAIL;
 
-            pool->sleeping_worker_count++;
+    hg_atomic_set64(&deque->buf[b & deque->mask], (hg_util_int64_t) work);
+    hg_atomic_set64(&deque->bottom, b + 1);
 
-            rc = hg_thread_cond_wait(&pool->cond, &pool->mutex);
-            HG_UTIL_CHECK_ERROR_NORET(rc != HG_UTIL_SUCCESS, unlock,
-                "Thread cannot wait on condition variable");
+    return HG_UTIL_SUCCESS;
+}
 
-            pool->sleeping_worker_count--;
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE struct hg_thread_work *
+hg_thread_pool_deque_pop(struct hg_thread_pool_deque *deque)
+{
+    hg_util_int64_t b = hg_atomic_get64(&deque->bottom) - 1;
+    hg_util_int64_t t;
+    struct hg_thread_work *work = NULL;
+
+    hg_atomic_set64(&deque->bottom, b);
+    HG_THREAD_POOL_MB();
+    t = hg_atomic_get64(&deque->top);
+
+    if (t <= b) {
+        work = (struct hg_thread_work *) hg_atomic_get64(
+            &deque->buf[b & deque->mask]);
+        if (t == b) {
+            /* Last element, race against thieves */
+            if (!hg_atomic_cas64(&deque->top, t, t + 1))
+                work = NULL;
+            hg_atomic_set64(&deque->bottom, b + 1);
         }
+    } else
+        hg_atomic_set64(&deque->bottom, b + 1);
+
+    return work;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE struct hg_thread_work *
+hg_thread_pool_deque_steal(struct hg_thread_pool_deque *deque)
+{
+    hg_util_int64_t t = hg_atomic_get64(&deque->top);
+    hg_util_int64_t b;
+    struct hg_thread_work *work;
+
+    HG_THREAD_POOL_MB();
+    b = hg_atomic_get64(&deque->bottom);
+    if (t >= b)
+        return NULL;
+
+    work =
+        (struct hg_thread_work *) hg_atomic_get64(&deque->buf[t & deque->mask]);
+    if (!hg_atomic_cas64(&deque->top, t, t + 1))
+        return NULL; /* Lost the race */
+
+    return work;
+}
 
-        if (pool->shutdown && HG_QUEUE_IS_EMPTY(&pool->queue))
-            goto unlock;
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE hg_util_bool_t
+hg_thread_pool_deque_is_empty(struct hg_thread_pool_deque *deque)
+{
+    return (hg_atomic_get64(&deque->bottom) <= hg_atomic_get64(&deque->top));
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_thread_pool_inject(hg_thread_pool_t *pool, struct hg_thread_work *work)
+{
+    if (hg_atomic_queue_push(pool->inject_queue, work) == HG_UTIL_SUCCESS)
+        return;
+
+    /* Injection queue is full */
+    hg_thread_spin_lock(&pool->overflow_lock);
+    HG_QUEUE_PUSH_TAIL(&pool->overflow_queue, work, entry);
+    hg_atomic_incr32(&pool->overflow_count);
+    hg_thread_spin_unlock(&pool->overflow_lock);
+}
+
+/*---------------------------------------------------------------------------*/
+static struct hg_thread_work *
+hg_thread_pool_get_injected(hg_thread_pool_t *pool)
+{
+    struct hg_thread_work *work;
+
+    work = (struct hg_thread_work *) hg_atomic_queue_pop_mc(pool->inject_queue);
+    if (work || hg_atomic_get32(&pool->overflow_count) == 0)
+        return work;
+
+    hg_thread_spin_lock(&pool->overflow_lock);
+    work = HG_QUEUE_FIRST(&pool->overflow_queue);
+    if (work) {
+        HG_QUEUE_POP_HEAD(&pool->overflow_queue, entry);
+        hg_atomic_decr32(&pool->overflow_count);
+    }
+    hg_thread_spin_unlock(&pool->overflow_lock);
+
+    return work;
+}
+
+/*---------------------------------------------------------------------------*/
+static struct hg_thread_work *
+hg_thread_pool_find_work(struct hg_thread_pool_worker *worker)
+{
+    hg_thread_pool_t *pool = worker->pool;
+    struct hg_thread_work *work;
+    unsigned int i, victim;
 
-        /* Grab our task */
-        work = HG_QUEUE_FIRST(&pool->queue);
-        HG_QUEUE_POP_HEAD(&pool->queue, entry);
+    work = hg_thread_pool_deque_pop(&worker->deque);
+    if (work) {
+        HG_THREAD_POOL_STAT_INCR(worker->stats.local);
+        return work;
+    }
 
-        /* Unlock */
-        hg_thread_mutex_unlock(&pool->mutex);
+    work = hg_thread_pool_get_injected(pool);
+    if (work) {
+        HG_THREAD_POOL_STAT_INCR(worker->stats.injected);
+        return work;
+    }
 
-        /* Get to work */
-        (*work->func)(work->args);
+    if (pool->thread_count < 2)
+        return NULL;
+
+    /* Pick a random victim (xorshift) and scan from there */
+    worker->seed ^= worker->seed << 13;
+    worker->seed ^= worker->seed >> 17;
+    worker->seed ^= worker->seed << 5;
+    victim = worker->seed % pool->thread_count;
+    for (i = 0; i < pool->thread_count; i++) {
+        struct hg_thread_pool_worker *other =
+            &pool->workers[(victim + i) % pool->thread_count];
+
+        if (other == worker)
+            continue;
+        work = hg_thread_pool_deque_steal(&other->deque);
+        if (work) {
+            HG_THREAD_POOL_STAT_INCR(worker->stats.stolen);
+            return work;
+        }
     }
 
-unlock:
-    hg_thread_mutex_unlock(&pool->mutex);
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_util_bool_t
+hg_thread_pool_has_work(hg_thread_pool_t *pool)
+{
+    unsigned int i;
+
+    if (!hg_atomic_queue_is_empty(pool->inject_queue) ||
+        hg_atomic_get32(&pool->overflow_count) > 0)
+        return HG_UTIL_TRUE;
+
+    for (i = 0; i < pool->thread_count; i++)
+        if (!hg_thread_pool_deque_is_empty(&pool->workers[i].deque))
+            return HG_UTIL_TRUE;
+
+    return HG_UTIL_FALSE;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_THREAD_RETURN_TYPE
+hg_thread_pool_worker(void *args)
+{
+    hg_thread_ret_t ret = 0;
+    struct hg_thread_pool_worker *worker =
+        (struct hg_thread_pool_worker *) args;
+    hg_thread_pool_t *pool = worker->pool;
+    unsigned int spin = 0;
+    int rc;
+
+    rc = hg_thread_setspecific(pool->worker_key, worker);
+    HG_UTIL_CHECK_WARNING(
+        rc != HG_UTIL_SUCCESS, "Could not set thread-specific worker");
+
+    while (1) {
+        struct hg_thread_work *work = hg_thread_pool_find_work(worker);
+        hg_util_int32_t key;
+
+        if (work) {
+            /* Get to work */
+            (*work->func)(work->args);
+            HG_THREAD_POOL_STAT_INCR(worker->stats.executed);
+            spin = 0;
+            continue;
+        }
+
+        if (++spin < HG_THREAD_POOL_SPIN_COUNT) {
+            cpu_spinwait();
+            continue;
+        }
+        spin = 0;
+
+        /* Announce ourselves and check again before sleeping */
+        key = hg_eventcount_prepare_wait(&pool->event);
+        if (hg_thread_pool_has_work(pool)) {
+            hg_eventcount_cancel_wait(&pool->event);
+            continue;
+        }
+        if (hg_atomic_get32(&pool->stop)) {
+            hg_eventcount_cancel_wait(&pool->event);
+            break;
+        }
+        HG_THREAD_POOL_STAT_INCR(worker->stats.parked);
+        (void) hg_eventcount_commit_wait(
+            &pool->event, key, HG_EVENTCOUNT_INFINITE);
+    }
 
     return ret;
 }
@@ -89,53 +394,111 @@ unlock:
 /*---------------------------------------------------------------------------*/
 int
 hg_thread_pool_init(unsigned int thread_count, hg_thread_pool_t **pool_ptr)
+{
+    return hg_thread_pool_init_opt(thread_count, NULL, pool_ptr);
+}
+
+/*---------------------------------------------------------------------------*/
+int
+hg_thread_pool_init_opt(unsigned int thread_count,
+    const struct hg_thread_pool_info *info, hg_thread_pool_t **pool_ptr)
 {
     int ret = HG_UTIL_SUCCESS, rc;
-    struct hg_thread_pool_private *priv_pool = NULL;
+    hg_thread_pool_t *pool = NULL;
+    unsigned int deque_size = HG_THREAD_POOL_DEQUE_SIZE_DEFAULT,
+                 inject_size = HG_THREAD_POOL_INJECT_SIZE_DEFAULT;
     unsigned int i;
 
     HG_UTIL_CHECK_ERROR(
         pool_ptr == NULL, error, ret, HG_UTIL_FAIL, "NULL pointer");
 
-    priv_pool = (struct hg_thread_pool_private *) malloc(
-        sizeof(struct hg_thread_pool_private));
-    HG_UTIL_CHECK_ERROR(priv_pool == NULL, error, ret, HG_UTIL_FAIL,
-        "Could not allocate thread pool");
+    if (info) {
+        if (info->deque_size)
+            deque_size = info->deque_size;
+        if (info->inject_size)
+            inject_size = info->inject_size;
+        HG_UTIL_CHECK_ERROR(info->cpu_set_count > 0 && !info->cpu_sets, error,
+            ret, HG_UTIL_FAIL, "NULL CPU sets");
+    }
+    HG_UTIL_CHECK_ERROR((deque_size & (deque_size - 1)) != 0 ||
+                            (inject_size & (inject_size - 1)) != 0,
+        error, ret, HG_UTIL_FAIL, "Queue sizes must be powers of 2");
 
-    priv_pool->pool.sleeping_worker_count = 0;
-    priv_pool->thread_count = thread_count;
-    priv_pool->threads = NULL;
-    HG_QUEUE_INIT(&priv_pool->pool.queue);
-    priv_pool->pool.shutdown = 0;
+    pool = (hg_thread_pool_t *) calloc(1, sizeof(hg_thread_pool_t));
+    HG_UTIL_CHECK_ERROR(pool == NULL, error, ret, HG_UTIL_FAIL,
+        "Could not allocate thread pool");
 
-    rc = hg_thread_mutex_init(&priv_pool->pool.mutex);
+    HG_QUEUE_INIT(&pool->overflow_queue);
+    hg_thread_spin_init(&pool->overflow_lock);
+    rc = hg_eventcount_init(&pool->event);
     HG_UTIL_CHECK_ERROR(rc != HG_UTIL_SUCCESS, error, ret, HG_UTIL_FAIL,
-        "Could not initialize mutex");
-
-    rc = hg_thread_cond_init(&priv_pool->pool.cond);
+        "Could not initialize eventcount");
+    hg_atomic_init32(&pool->overflow_count, 0);
+    hg_atomic_init32(&pool->posting, 0);
+    hg_atomic_init32(&pool->shutdown, 0);
+    hg_atomic_init32(&pool->stop, 0);
+    pool->thread_count = thread_count;
+
+    rc = hg_thread_key_create(&pool->worker_key);
     HG_UTIL_CHECK_ERROR(rc != HG_UTIL_SUCCESS, error, ret, HG_UTIL_FAIL,
-        "Could not initialize thread condition");
+        "Could not create thread key");
+    pool->key_created = HG_UTIL_TRUE;
+
+    pool->inject_queue = hg_atomic_queue_alloc(inject_size);
+    HG_UTIL_CHECK_ERROR(pool->inject_queue == NULL, error, ret, HG_UTIL_FAIL,
+        "Could not allocate injection queue");
+
+    if (thread_count > 0) {
+        pool->workers = (struct hg_thread_pool_worker *) hg_mem_aligned_alloc(
+            HG_MEM_CACHE_LINE_SIZE,
+            thread_count * sizeof(struct hg_thread_pool_worker));
+        HG_UTIL_CHECK_ERROR(!pool->workers, error, ret, HG_UTIL_FAIL,
+            "Could not allocate thread pool array");
+        memset(pool->workers, 0,
+            thread_count * sizeof(struct hg_thread_pool_worker));
+    }
+
+    for (i = 0; i < thread_count; i++) {
+        struct hg_thread_pool_worker *worker = &pool->workers[i];
 
-    priv_pool->threads =
-        (hg_thread_t *) malloc(thread_count * sizeof(hg_thread_t));
-    HG_UTIL_CHECK_ERROR(!priv_pool->threads, error, ret, HG_UTIL_FAIL,
-        "Could not allocate thread pool array");
+        rc = hg_thread_pool_deque_init(&worker->deque, deque_size);
+        HG_UTIL_CHECK_ERROR(rc != HG_UTIL_SUCCESS, error, ret, HG_UTIL_FAIL,
+            "Could not initialize worker deque");
+        hg_atomic_init64(&worker->stats.executed, 0);
+        hg_atomic_init64(&worker->stats.local, 0);
+        hg_atomic_init64(&worker->stats.injected, 0);
+        hg_atomic_init64(&worker->stats.stolen, 0);
+        hg_atomic_init64(&worker->stats.parked, 0);
+        worker->pool = pool;
+        worker->id = i;
+        worker->seed = 2654435761U * (i + 1);
+    }
 
     /* Start worker threads */
     for (i = 0; i < thread_count; i++) {
+        struct hg_thread_pool_worker *worker = &pool->workers[i];
+
         rc = hg_thread_create(
-            &priv_pool->threads[i], hg_thread_pool_worker, (void *) priv_pool);
+            &worker->thread, hg_thread_pool_worker, (void *) worker);
         HG_UTIL_CHECK_ERROR(rc != HG_UTIL_SUCCESS, error, ret, HG_UTIL_FAIL,
             "Could not create thread");
+        worker->started = HG_UTIL_TRUE;
+
+        if (info && info->cpu_set_count > 0) {
+            rc = hg_thread_setaffinity(
+                worker->thread, &info->cpu_sets[i % info->cpu_set_count]);
+            HG_UTIL_CHECK_WARNING(
+                rc != HG_UTIL_SUCCESS, "Could not set worker affinity");
+        }
     }
 
-    *pool_ptr = (struct hg_thread_pool *) priv_pool;
+    *pool_ptr = pool;
 
     return ret;
 
 error:
-    if (priv_pool)
-        hg_thread_pool_destroy((struct hg_thread_pool *) priv_pool);
+    if (pool)
+        hg_thread_pool_destroy(pool);
 
     return ret;
 }
@@ -144,48 +507,111 @@ error:
 int
 hg_thread_pool_destroy(hg_thread_pool_t *pool)
 {
-    struct hg_thread_pool_private *priv_pool =
-        (struct hg_thread_pool_private *) pool;
     int ret = HG_UTIL_SUCCESS, rc;
     unsigned int i;
 
-    if (!priv_pool)
+    if (!pool)
         goto done;
 
-    if (priv_pool->threads) {
-        hg_thread_mutex_lock(&priv_pool->pool.mutex);
+    /* Stop accepting work and wait for posts in progress */
+    hg_atomic_set32(&pool->shutdown, 1);
+    HG_THREAD_POOL_MB();
+    while (hg_atomic_get32(&pool->posting) > 0)
+        cpu_spinwait();
+
+    /* Workers drain remaining work and exit */
+    hg_atomic_set32(&pool->stop, 1);
+    hg_eventcount_notify_all(&pool->event);
+
+    for (i = 0; i < pool->thread_count && pool->workers; i++) {
+        if (!pool->workers[i].started)
+            continue;
+        rc = hg_thread_join(pool->workers[i].thread);
+        HG_UTIL_CHECK_ERROR(rc != HG_UTIL_SUCCESS, done, ret, HG_UTIL_FAIL,
+            "Could not join thread");
+    }
 
-        priv_pool->pool.shutdown = 1;
+    for (i = 0; i < pool->thread_count && pool->workers; i++)
+        free(pool->workers[i].deque.buf);
+    hg_mem_aligned_free(pool->workers);
 
-        rc = hg_thread_cond_broadcast(&priv_pool->pool.cond);
-        HG_UTIL_CHECK_ERROR(rc != HG_UTIL_SUCCESS, error, ret, HG_UTIL_FAIL,
-            "Could not broadcast condition signal");
+    hg_atomic_queue_free(pool->inject_queue);
+    hg_thread_spin_destroy(&pool->overflow_lock);
 
-        hg_thread_mutex_unlock(&priv_pool->pool.mutex);
-
-        for (i = 0; i < priv_pool->thread_count; i++) {
-            rc = hg_thread_join(priv_pool->threads[i]);
-            HG_UTIL_CHECK_ERROR(rc != HG_UTIL_SUCCESS, done, ret, HG_UTIL_FAIL,
-                "Could not join thread");
-        }
+    if (pool->key_created) {
+        rc = hg_thread_key_delete(pool->worker_key);
+        HG_UTIL_CHECK_ERROR(rc != HG_UTIL_SUCCESS, done, ret, HG_UTIL_FAIL,
+            "Could not delete thread key");
     }
 
-    rc = hg_thread_mutex_destroy(&priv_pool->pool.mutex);
+    rc = hg_eventcount_destroy(&pool->event);
     HG_UTIL_CHECK_ERROR(rc != HG_UTIL_SUCCESS, done, ret, HG_UTIL_FAIL,
-        "Could not destroy mutex");
+        "Could not destroy eventcount");
 
-    rc = hg_thread_cond_destroy(&priv_pool->pool.cond);
-    HG_UTIL_CHECK_ERROR(rc != HG_UTIL_SUCCESS, done, ret, HG_UTIL_FAIL,
-        "Could not destroy thread condition");
+    free(pool);
+
+done:
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+int
+hg_thread_pool_post(hg_thread_pool_t *pool, struct hg_thread_work *work)
+{
+    struct hg_thread_pool_worker *worker;
+    int ret = HG_UTIL_SUCCESS;
+
+    if (!pool || !work)
+        return HG_UTIL_FAIL;
+
+    if (!work->func)
+        return HG_UTIL_FAIL;
+
+    hg_atomic_incr32(&pool->posting);
+    HG_THREAD_POOL_MB();
 
-    free(priv_pool->threads);
-    free(priv_pool);
+    /* Are we shutting down ? */
+    if (hg_atomic_get32(&pool->shutdown)) {
+        ret = HG_UTIL_FAIL;
+        goto done;
+    }
+
+    /* Posting from a worker of this pool goes to its own deque */
+    worker = (struct hg_thread_pool_worker *) hg_thread_getspecific(
+        pool->worker_key);
+    if (!worker || hg_thread_pool_deque_push(&worker->deque, work) !=
+                       HG_UTIL_SUCCESS)
+        hg_thread_pool_inject(pool, work);
+
+    /* Wake up sleeping worker */
+    hg_eventcount_notify(&pool->event);
 
 done:
+    hg_atomic_decr32(&pool->posting);
+
     return ret;
+}
 
-error:
-    hg_thread_mutex_unlock(&priv_pool->pool.mutex);
+/*---------------------------------------------------------------------------*/
+int
+hg_thread_pool_get_stats(hg_thread_pool_t *pool, unsigned int worker_id,
+    struct hg_thread_pool_stats *stats)
+{
+    struct hg_thread_pool_worker_stats *worker_stats;
+    int ret = HG_UTIL_SUCCESS;
 
+    HG_UTIL_CHECK_ERROR(
+        pool == NULL || stats == NULL, done, ret, HG_UTIL_FAIL, "NULL pointer");
+    HG_UTIL_CHECK_ERROR(worker_id >= pool->thread_count, done, ret,
+        HG_UTIL_FAIL, "Invalid worker ID (%u)", worker_id);
+
+    worker_stats = &pool->workers[worker_id].stats;
+    stats->executed = (hg_util_uint64_t) hg_atomic_get64(&worker_stats->executed);
+    stats->local = (hg_util_uint64_t) hg_atomic_get64(&worker_stats->local);
+    stats->injected = (hg_util_uint64_t) hg_atomic_get64(&worker_stats->injected);
+    stats->stolen = (hg_util_uint64_t) hg_atomic_get64(&worker_stats->stolen);
+    stats->parked = (hg_util_uint64_t) hg_atomic_get64(&worker_stats->parked);
+
+done:
     return ret;
 }
@@ -21,24 +21,37 @@
 
 typedef struct hg_thread_pool hg_thread_pool_t;
 
-struct hg_thread_pool {
-    unsigned int sleeping_worker_count;
-    HG_QUEUE_HEAD(hg_thread_work) queue;
-    int shutdown;
-    hg_thread_mutex_t mutex;
-    hg_thread_cond_t cond;
-};
-
 struct hg_thread_work {
     hg_thread_func_t func;
     void *args;
     HG_QUEUE_ENTRY(hg_thread_work) entry; /* Internal */
 };
 
+/* Pool options (see hg_thread_pool_init_opt()) */
+struct hg_thread_pool_info {
+    unsigned int deque_size;          /* Per-worker deque size (power of 2) */
+    unsigned int inject_size;         /* Injection queue size (power of 2) */
+    const hg_cpu_set_t *cpu_sets;     /* CPU sets worker i is bound to */
+    unsigned int cpu_set_count;       /* cpu_sets[i % cpu_set_count] */
+};
+
+/* Per-worker statistics */
+struct hg_thread_pool_stats {
+    hg_util_uint64_t executed; /* Total number of work items executed */
+    hg_util_uint64_t local;    /* Items taken from own deque */
+    hg_util_uint64_t injected; /* Items taken from the injection queue */
+    hg_util_uint64_t stolen;   /* Items stolen from other workers */
+    hg_util_uint64_t parked;   /* Number of times the worker went to sleep */
+};
+
 /*****************/
 /* Public Macros */
 /*****************/
 
+/* Defaults used by hg_thread_pool_init() */
+#define HG_THREAD_POOL_DEQUE_SIZE_DEFAULT  256
+#define HG_THREAD_POOL_INJECT_SIZE_DEFAULT 1024
+
 /*********************/
 /* Public Prototypes */
 /*********************/
@@ -50,6 +63,11 @@ extern "C" {
 /**
  * Initialize the thread pool.
  *
+ * Each worker owns a work-stealing deque, work posted from a worker thread
+ * is pushed to that worker's deque, while work posted from other threads
+ * goes through a shared injection queue. Idle workers steal from others
+ * before going to sleep.
+ *
  * \param thread_count [IN]     number of threads that will be created at
  *                              initialization
  * \param pool [OUT]            pointer to pool object
@@ -60,7 +78,22 @@ HG_UTIL_PUBLIC int
 hg_thread_pool_init(unsigned int thread_count, hg_thread_pool_t **pool);
 
 /**
- * Destroy the thread pool.
+ * Initialize the thread pool with options.
+ *
+ * \param thread_count [IN]     number of threads that will be created at
+ *                              initialization
+ * \param info [IN]             pointer to options (NULL for defaults)
+ * \param pool [OUT]            pointer to pool object
+ *
+ * \return Non-negative on success or negative on failure
+ */
+HG_UTIL_PUBLIC int
+hg_thread_pool_init_opt(unsigned int thread_count,
+    const struct hg_thread_pool_info *info, hg_thread_pool_t **pool);
+
+/**
+ * Destroy the thread pool. Work already posted is executed before the
+ * worker threads exit.
  *
  * \param pool [IN/OUT]         pointer to pool object
  *
@@ -78,42 +111,21 @@ hg_thread_pool_destroy(hg_thread_pool_t *pool);
  *
  * \return Non-negative on success or negative on failure
  */
-static HG_UTIL_INLINE int
+HG_UTIL_PUBLIC int
 hg_thread_pool_post(hg_thread_pool_t *pool, struct hg_thread_work *work);
 
-/*---------------------------------------------------------------------------*/
-static HG_UTIL_INLINE int
-hg_thread_pool_post(hg_thread_pool_t *pool, struct hg_thread_work *work)
-{
-    int ret = HG_UTIL_SUCCESS;
-
-    if (!pool || !work)
-        return HG_UTIL_FAIL;
-
-    if (!work->func)
-        return HG_UTIL_FAIL;
-
-    hg_thread_mutex_lock(&pool->mutex);
-
-    /* Are we shutting down ? */
-    if (pool->shutdown) {
-        ret = HG_UTIL_FAIL;
-        goto unlock;
-    }
-
-    /* Add task to task queue */
-    HG_QUEUE_PUSH_TAIL(&pool->queue, work, entry);
-
-    /* Wake up sleeping worker */
-    if (pool->sleeping_worker_count &&
-        (hg_thread_cond_signal(&pool->cond) != HG_UTIL_SUCCESS))
-        ret = HG_UTIL_FAIL;
-
-unlock:
-    hg_thread_mutex_unlock(&pool->mutex);
-
-    return ret;
-}
+/**
+ * Retrieve statistics of a given worker.
+ *
+ * \param pool [IN]             pointer to pool object
+ * \param worker_id [IN]        worker index (less than thread count)
+ * \param stats [OUT]           pointer to stats struct
+ *
+ * \return Non-negative on success or negative on failure
+ */
+HG_UTIL_PUBLIC int
+hg_thread_pool_get_stats(hg_thread_pool_t *pool, unsigned int worker_id,
+    struct hg_thread_pool_stats *stats);
 
 #ifdef __cplusplus
 }
@@ -10,16 +10,62 @@
 
 #include "mercury_thread_spin.h"
 
+#include <string.h>
+
+#if defined(__linux__)
+#    include <linux/futex.h>
+#    include <stdint.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#    define HG_THREAD_ADAPTIVE_HAS_FUTEX
+#elif defined(_WIN32)
+#    include <windows.h>
+#else
+#    include <sched.h>
+#endif
+
+/****************/
+/* Local Macros */
+/****************/
+
+#ifdef HG_THREAD_ADAPTIVE_HAS_FUTEX
+/* Atomic 32-bit integers have the layout of an int */
+#    define HG_THREAD_ADAPTIVE_FUTEX_ADDR(x) ((int *) (uintptr_t) (x))
+#endif
+
+/********************/
+/* Local Prototypes */
+/********************/
+
+/**
+ * Atomically exchange lock state.
+ */
+static HG_UTIL_INLINE hg_util_int32_t
+hg_thread_adaptive_xchg(hg_thread_adaptive_t *lock, hg_util_int32_t value);
+
+/**
+ * Park until lock state is no longer value.
+ */
+static HG_UTIL_INLINE void
+hg_thread_adaptive_park(hg_thread_adaptive_t *lock, hg_util_int32_t value);
+
 /*---------------------------------------------------------------------------*/
 int
 hg_thread_spin_init(hg_thread_spin_t *lock)
 {
-#if defined(_WIN32)
+#if defined(HG_UTIL_SPIN_TICKET)
+    return hg_thread_ticket_init(lock);
+#elif defined(HG_UTIL_SPIN_ADAPTIVE)
+    return hg_thread_adaptive_init(lock);
+#elif defined(_WIN32)
     *lock = 0;
 
     return HG_UTIL_SUCCESS;
 #elif defined(HG_UTIL_HAS_PTHREAD_SPINLOCK_T)
-    if (pthread_spin_init(lock, 0))
+#    ifdef HG_UTIL_HAS_LOCK_STATS
+    memset(&lock->stats, 0, sizeof(lock->stats));
+#    endif
+    if (pthread_spin_init(HG_THREAD_SPIN_NATIVE(lock), 0))
         return HG_UTIL_FAIL;
 
     return HG_UTIL_SUCCESS;
@@ -32,12 +78,13 @@ hg_thread_spin_init(hg_thread_spin_t *lock)
 int
 hg_thread_spin_destroy(hg_thread_spin_t *lock)
 {
-#if defined(_WIN32)
+#if defined(HG_UTIL_SPIN_TICKET) || defined(HG_UTIL_SPIN_ADAPTIVE) ||        \
+    defined(_WIN32)
     (void) lock;
 
     return HG_UTIL_SUCCESS;
 #elif defined(HG_UTIL_HAS_PTHREAD_SPINLOCK_T)
-    if (pthread_spin_destroy(lock))
+    if (pthread_spin_destroy(HG_THREAD_SPIN_NATIVE(lock)))
         return HG_UTIL_FAIL;
 
     return HG_UTIL_SUCCESS;
@@ -45,3 +92,131 @@ hg_thread_spin_destroy(hg_thread_spin_t *lock)
     return hg_thread_mutex_destroy(lock);
 #endif
 }
+
+/*---------------------------------------------------------------------------*/
+int
+hg_thread_spin_get_stats(
+    hg_thread_spin_t *lock, struct hg_thread_lock_stats *stats)
+{
+#if defined(HG_UTIL_HAS_LOCK_STATS) &&                                         \
+    (defined(HG_UTIL_SPIN_TICKET) || defined(HG_UTIL_SPIN_ADAPTIVE) ||         \
+        (!defined(_WIN32) && defined(HG_UTIL_HAS_PTHREAD_SPINLOCK_T)))
+    *stats = lock->stats;
+
+    return HG_UTIL_SUCCESS;
+#else
+    (void) lock;
+    memset(stats, 0, sizeof(*stats));
+
+    return HG_UTIL_FAIL;
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+int
+hg_thread_ticket_init(hg_thread_ticket_t *lock)
+{
+    hg_atomic_init32(&lock->next, 0);
+    hg_atomic_init32(&lock->owner, 0);
+#ifdef HG_UTIL_HAS_LOCK_STATS
+    memset(&lock->stats, 0, sizeof(lock->stats));
+#endif
+
+    return HG_UTIL_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+int
+hg_thread_mcs_init(hg_thread_mcs_t *lock)
+{
+    hg_atomic_init64(&lock->tail, 0);
+#ifdef HG_UTIL_HAS_LOCK_STATS
+    memset(&lock->stats, 0, sizeof(lock->stats));
+#endif
+
+    return HG_UTIL_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+int
+hg_thread_adaptive_init(hg_thread_adaptive_t *lock)
+{
+    hg_atomic_init32(&lock->state, 0);
+#ifdef HG_UTIL_HAS_LOCK_STATS
+    memset(&lock->stats, 0, sizeof(lock->stats));
+#endif
+
+    return HG_UTIL_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE hg_util_int32_t
+hg_thread_adaptive_xchg(hg_thread_adaptive_t *lock, hg_util_int32_t value)
+{
+    hg_util_int32_t prev;
+
+    do {
+        prev = hg_atomic_get32(&lock->state);
+    } while (!hg_atomic_cas32(&lock->state, prev, value));
+
+    return prev;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE void
+hg_thread_adaptive_park(hg_thread_adaptive_t *lock, hg_util_int32_t value)
+{
+#if defined(HG_THREAD_ADAPTIVE_HAS_FUTEX)
+    /* Returns immediately if state is no longer value */
+    (void) syscall(SYS_futex, HG_THREAD_ADAPTIVE_FUTEX_ADDR(&lock->state),
+        FUTEX_WAIT_PRIVATE, value, NULL, NULL, 0);
+#elif defined(_WIN32)
+    (void) lock;
+    (void) value;
+    SwitchToThread();
+#else
+    (void) lock;
+    (void) value;
+    sched_yield();
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+int
+hg_thread_adaptive_lock_slow(hg_thread_adaptive_t *lock)
+{
+    unsigned int spins = 0;
+
+    /* Spin first, lock holders are expected to release quickly */
+    while (spins < HG_THREAD_SPIN_COUNT) {
+        if (hg_atomic_get32(&lock->state) == 0 &&
+            hg_atomic_cas32(&lock->state, 0, 1))
+            goto done;
+        cpu_spinwait();
+        spins++;
+    }
+
+    /* Mark lock as contended and park until it is released */
+    while (hg_thread_adaptive_xchg(lock, 2) != 0) {
+        hg_thread_adaptive_park(lock, 2);
+        spins++;
+    }
+
+done:
+    HG_THREAD_LOCK_STATS_UPDATE(lock, spins);
+
+    return HG_UTIL_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+int
+hg_thread_adaptive_unlock_slow(hg_thread_adaptive_t *lock)
+{
+    hg_atomic_set32(&lock->state, 0);
+#ifdef HG_THREAD_ADAPTIVE_HAS_FUTEX
+    (void) syscall(SYS_futex, HG_THREAD_ADAPTIVE_FUTEX_ADDR(&lock->state),
+        FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+#endif
+
+    return HG_UTIL_SUCCESS;
+}
@@ -13,18 +13,115 @@
 
 #include "mercury_util_config.h"
 
-#if defined(_WIN32)
+#include "mercury_atomic.h"
+#include "mercury_thread.h"
+
+/*
+ * Besides the default spin lock (hg_thread_spin_t), the following lock types
+ * can be used on a per-lock basis:
+ *   - hg_thread_ticket_t: FIFO ticket lock
+ *   - hg_thread_mcs_t: MCS queue lock, each waiter spins on its own node
+ *   - hg_thread_adaptive_t: spins for a while then parks (futex on Linux)
+ * The implementation behind hg_thread_spin_t is selected at build time
+ * (MERCURY_SPINLOCK_TYPE), contention statistics are collected when
+ * MERCURY_ENABLE_LOCK_STATS is set.
+ */
+
+/*************************************/
+/* Public Type and Struct Definition */
+/*************************************/
+
+/* Lock contention statistics */
+struct hg_thread_lock_stats {
+    hg_util_uint64_t acquire_count;   /* Number of acquisitions */
+    hg_util_uint64_t contended_count; /* Acquisitions that had to wait */
+    hg_util_uint64_t spin_count;      /* Busy-wait iterations */
+};
+
+#ifdef HG_UTIL_HAS_LOCK_STATS
+#    define HG_THREAD_LOCK_STATS_DECL struct hg_thread_lock_stats stats;
+#else
+#    define HG_THREAD_LOCK_STATS_DECL
+#endif
+
+/* Ticket lock */
+typedef struct {
+    hg_atomic_int32_t next;  /* Next ticket to hand out */
+    hg_atomic_int32_t owner; /* Ticket currently being served */
+    HG_THREAD_LOCK_STATS_DECL
+} hg_thread_ticket_t;
+
+/* MCS lock queue node, must remain valid until unlock */
+struct hg_thread_mcs_node {
+    hg_atomic_int64_t next;
+    hg_atomic_int32_t locked;
+};
+
+/* MCS lock */
+typedef struct {
+    hg_atomic_int64_t tail; /* Last node in queue */
+    HG_THREAD_LOCK_STATS_DECL
+} hg_thread_mcs_t;
+
+/* Adaptive lock: 0 unlocked, 1 locked, 2 locked with sleeping waiters */
+typedef struct {
+    hg_atomic_int32_t state;
+    HG_THREAD_LOCK_STATS_DECL
+} hg_thread_adaptive_t;
+
+/* Default spin lock */
+#if defined(HG_UTIL_SPIN_TICKET)
+typedef hg_thread_ticket_t hg_thread_spin_t;
+#elif defined(HG_UTIL_SPIN_ADAPTIVE)
+typedef hg_thread_adaptive_t hg_thread_spin_t;
+#elif defined(_WIN32)
 #    include <windows.h>
 typedef volatile LONG hg_thread_spin_t;
 #elif defined(HG_UTIL_HAS_PTHREAD_SPINLOCK_T)
 #    include <pthread.h>
+#    ifdef HG_UTIL_HAS_LOCK_STATS
+typedef struct {
+    pthread_spinlock_t lock;
+    struct hg_thread_lock_stats stats;
+} hg_thread_spin_t;
+#        define HG_THREAD_SPIN_NATIVE(lock) (&(lock)->lock)
+#    else
 typedef pthread_spinlock_t hg_thread_spin_t;
+#        define HG_THREAD_SPIN_NATIVE(lock) (lock)
+#    endif
 #else
 /* Default to hg_thread_mutex_t if pthread_spinlock_t is not supported */
 #    include "mercury_thread_mutex.h"
 typedef hg_thread_mutex_t hg_thread_spin_t;
 #endif
 
+/*****************/
+/* Public Macros */
+/*****************/
+
+/* Number of spins before a waiter yields (ticket, MCS) or parks (adaptive) */
+#ifndef HG_THREAD_SPIN_COUNT
+#    define HG_THREAD_SPIN_COUNT 128
+#endif
+
+/* Update stats of lock after acquisition (protected by the lock itself) */
+#ifdef HG_UTIL_HAS_LOCK_STATS
+#    define HG_THREAD_LOCK_STATS_UPDATE(lock, spins)                           \
+        do {                                                                   \
+            (lock)->stats.acquire_count++;                                     \
+            if (spins) {                                                       \
+                (lock)->stats.contended_count++;                               \
+                (lock)->stats.spin_count += (hg_util_uint64_t)(spins);         \
+            }                                                                  \
+        } while (0)
+#else
+#    define HG_THREAD_LOCK_STATS_UPDATE(lock, spins) (void) (spins)
+#endif
+
+/*********************/
+/* Public Prototypes */
+/*********************/
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -79,11 +176,294 @@ hg_thread_spin_try_lock(hg_thread_spin_t *lock);
 static HG_UTIL_INLINE int
 hg_thread_spin_unlock(hg_thread_spin_t *lock);
 
+/**
+ * Retrieve contention statistics of the spin lock.
+ *
+ * \param lock [IN]             pointer to lock object
+ * \param stats [OUT]           pointer to stats
+ *
+ * \return Non-negative on success or negative if stats are not available
+ */
+HG_UTIL_PUBLIC int
+hg_thread_spin_get_stats(
+    hg_thread_spin_t *lock, struct hg_thread_lock_stats *stats);
+
+/**
+ * Initialize the ticket lock.
+ *
+ * \param lock [IN/OUT]         pointer to lock object
+ *
+ * \return Non-negative on success or negative on failure
+ */
+HG_UTIL_PUBLIC int
+hg_thread_ticket_init(hg_thread_ticket_t *lock);
+
+/**
+ * Lock the ticket lock.
+ *
+ * \param lock [IN/OUT]         pointer to lock object
+ *
+ * \return Non-negative on success or negative on failure
+ */
+static HG_UTIL_INLINE int
+hg_thread_ticket_lock(hg_thread_ticket_t *lock);
+
+/**
+ * Try locking the ticket lock.
+ *
+ * \param lock [IN/OUT]         pointer to lock object
+ *
+ * \return Non-negative on success or negative on failure
+ */
+static HG_UTIL_INLINE int
+hg_thread_ticket_try_lock(hg_thread_ticket_t *lock);
+
+/**
+ * Unlock the ticket lock.
+ *
+ * \param lock [IN/OUT]         pointer to lock object
+ *
+ * \return Non-negative on success or negative on failure
+ */
+static HG_UTIL_INLINE int
+hg_thread_ticket_unlock(hg_thread_ticket_t *lock);
+
+/**
+ * Initialize the MCS lock.
+ *
+ * \param lock [IN/OUT]         pointer to lock object
+ *
+ * \return Non-negative on success or negative on failure
+ */
+HG_UTIL_PUBLIC int
+hg_thread_mcs_init(hg_thread_mcs_t *lock);
+
+/**
+ * Lock the MCS lock. The same node must be passed to hg_thread_mcs_unlock().
+ *
+ * \param lock [IN/OUT]         pointer to lock object
+ * \param node [IN/OUT]         pointer to caller-owned queue node
+ *
+ * \return Non-negative on success or negative on failure
+ */
+static HG_UTIL_INLINE int
+hg_thread_mcs_lock(hg_thread_mcs_t *lock, struct hg_thread_mcs_node *node);
+
+/**
+ * Unlock the MCS lock.
+ *
+ * \param lock [IN/OUT]         pointer to lock object
+ * \param node [IN/OUT]         pointer to node passed to hg_thread_mcs_lock()
+ *
+ * \return Non-negative on success or negative on failure
+ */
+static HG_UTIL_INLINE int
+hg_thread_mcs_unlock(hg_thread_mcs_t *lock, struct hg_thread_mcs_node *node);
+
+/**
+ * Initialize the adaptive lock.
+ *
+ * \param lock [IN/OUT]         pointer to lock object
+ *
+ * \return Non-negative on success or negative on failure
+ */
+HG_UTIL_PUBLIC int
+hg_thread_adaptive_init(hg_thread_adaptive_t *lock);
+
+/**
+ * Lock the adaptive lock (contended path).
+ *
+ * \param lock [IN/OUT]         pointer to lock object
+ *
+ * \return Non-negative on success or negative on failure
+ */
+HG_UTIL_PUBLIC int
+hg_thread_adaptive_lock_slow(hg_thread_adaptive_t *lock);
+
+/**
+ * Unlock the adaptive lock and wake up a waiter (contended path).
+ *
+ * \param lock [IN/OUT]         pointer to lock object
+ *
+ * \return Non-negative on success or negative on failure
+ */
+HG_UTIL_PUBLIC int
+hg_thread_adaptive_unlock_slow(hg_thread_adaptive_t *lock);
+
+/**
+ * Lock the adaptive lock.
+ *
+ * \param lock [IN/OUT]         pointer to lock object
+ *
+ * \return Non-negative on success or negative on failure
+ */
+static HG_UTIL_INLINE int
+hg_thread_adaptive_lock(hg_thread_adaptive_t *lock);
+
+/**
+ * Try locking the adaptive lock.
+ *
+ * \param lock [IN/OUT]         pointer to lock object
+ *
+ * \return Non-negative on success or negative on failure
+ */
+static HG_UTIL_INLINE int
+hg_thread_adaptive_try_lock(hg_thread_adaptive_t *lock);
+
+/**
+ * Unlock the adaptive lock.
+ *
+ * \param lock [IN/OUT]         pointer to lock object
+ *
+ * \return Non-negative on success or negative on failure
+ */
+static HG_UTIL_INLINE int
+hg_thread_adaptive_unlock(hg_thread_adaptive_t *lock);
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE int
+hg_thread_ticket_lock(hg_thread_ticket_t *lock)
+{
+    hg_util_int32_t ticket = hg_atomic_incr32(&lock->next) - 1;
+    hg_util_int32_t owner;
+    unsigned int spins = 0;
+
+    while ((owner = hg_atomic_get32(&lock->owner)) != ticket) {
+        /* Proportional back-off */
+        hg_util_int32_t i = ticket - owner;
+
+        while (i-- > 0)
+            cpu_spinwait();
+
+        /* Let a preempted owner run */
+        if (++spins % HG_THREAD_SPIN_COUNT == 0)
+            hg_thread_yield();
+    }
+    HG_THREAD_LOCK_STATS_UPDATE(lock, spins);
+
+    return HG_UTIL_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE int
+hg_thread_ticket_try_lock(hg_thread_ticket_t *lock)
+{
+    hg_util_int32_t owner = hg_atomic_get32(&lock->owner);
+
+    if (!hg_atomic_cas32(&lock->next, owner, owner + 1))
+        return HG_UTIL_FAIL;
+    HG_THREAD_LOCK_STATS_UPDATE(lock, 0);
+
+    return HG_UTIL_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE int
+hg_thread_ticket_unlock(hg_thread_ticket_t *lock)
+{
+    /* Only the owner writes to owner */
+    hg_atomic_set32(&lock->owner, hg_atomic_get32(&lock->owner) + 1);
+
+    return HG_UTIL_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE int
+hg_thread_mcs_lock(hg_thread_mcs_t *lock, struct hg_thread_mcs_node *node)
+{
+    hg_util_int64_t prev;
+    unsigned int spins = 0;
+
+    hg_atomic_set64(&node->next, 0);
+    hg_atomic_set32(&node->locked, 1);
+
+    /* Swap ourselves in as the new tail */
+    do {
+        prev = hg_atomic_get64(&lock->tail);
+    } while (!hg_atomic_cas64(&lock->tail, prev, (hg_util_int64_t) node));
+
+    if (prev) {
+        /* Link behind predecessor and spin on our own node */
+        hg_atomic_set64(&((struct hg_thread_mcs_node *) prev)->next,
+            (hg_util_int64_t) node);
+        while (hg_atomic_get32(&node->locked)) {
+            cpu_spinwait();
+            if (++spins % HG_THREAD_SPIN_COUNT == 0)
+                hg_thread_yield();
+        }
+    }
+    HG_THREAD_LOCK_STATS_UPDATE(lock, spins);
+
+    return HG_UTIL_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE int
+hg_thread_mcs_unlock(hg_thread_mcs_t *lock, struct hg_thread_mcs_node *node)
+{
+    hg_util_int64_t next = hg_atomic_get64(&node->next);
+    unsigned int spins = 0;
+
+    if (!next) {
+        /* No known successor, try to release */
+        if (hg_atomic_cas64(&lock->tail, (hg_util_int64_t) node, 0))
+            return HG_UTIL_SUCCESS;
+
+        /* Successor is linking itself */
+        while (!(next = hg_atomic_get64(&node->next))) {
+            cpu_spinwait();
+            if (++spins % HG_THREAD_SPIN_COUNT == 0)
+                hg_thread_yield();
+        }
+    }
+    hg_atomic_set32(&((struct hg_thread_mcs_node *) next)->locked, 0);
+
+    return HG_UTIL_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE int
+hg_thread_adaptive_lock(hg_thread_adaptive_t *lock)
+{
+    if (hg_atomic_cas32(&lock->state, 0, 1)) {
+        HG_THREAD_LOCK_STATS_UPDATE(lock, 0);
+        return HG_UTIL_SUCCESS;
+    }
+
+    return hg_thread_adaptive_lock_slow(lock);
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE int
+hg_thread_adaptive_try_lock(hg_thread_adaptive_t *lock)
+{
+    if (!hg_atomic_cas32(&lock->state, 0, 1))
+        return HG_UTIL_FAIL;
+    HG_THREAD_LOCK_STATS_UPDATE(lock, 0);
+
+    return HG_UTIL_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE int
+hg_thread_adaptive_unlock(hg_thread_adaptive_t *lock)
+{
+    if (hg_atomic_cas32(&lock->state, 1, 0))
+        return HG_UTIL_SUCCESS;
+
+    /* There are sleeping waiters */
+    return hg_thread_adaptive_unlock_slow(lock);
+}
+
 /*---------------------------------------------------------------------------*/
 static HG_UTIL_INLINE int
 hg_thread_spin_lock(hg_thread_spin_t *lock)
 {
-#if defined(_WIN32)
+#if defined(HG_UTIL_SPIN_TICKET)
+    return hg_thread_ticket_lock(lock);
+#elif defined(HG_UTIL_SPIN_ADAPTIVE)
+    return hg_thread_adaptive_lock(lock);
+#elif defined(_WIN32)
     while (InterlockedExchange(lock, EBUSY)) {
         /* Don't lock while waiting */
         while (*lock) {
@@ -95,8 +475,18 @@ hg_thread_spin_lock(hg_thread_spin_t *lock)
     }
     return HG_UTIL_SUCCESS;
 #elif defined(HG_UTIL_HAS_PTHREAD_SPINLOCK_T)
-    if (pthread_spin_lock(lock))
+#    ifdef HG_UTIL_HAS_LOCK_STATS
+    unsigned int spins = 0;
+
+    while (pthread_spin_trylock(HG_THREAD_SPIN_NATIVE(lock))) {
+        cpu_spinwait();
+        spins++;
+    }
+    HG_THREAD_LOCK_STATS_UPDATE(lock, spins);
+#    else
+    if (pthread_spin_lock(HG_THREAD_SPIN_NATIVE(lock)))
         return HG_UTIL_FAIL;
+#    endif
 
     return HG_UTIL_SUCCESS;
 #else
@@ -108,11 +498,16 @@ hg_thread_spin_lock(hg_thread_spin_t *lock)
 static HG_UTIL_INLINE int
 hg_thread_spin_try_lock(hg_thread_spin_t *lock)
 {
-#if defined(_WIN32)
+#if defined(HG_UTIL_SPIN_TICKET)
+    return hg_thread_ticket_try_lock(lock);
+#elif defined(HG_UTIL_SPIN_ADAPTIVE)
+    return hg_thread_adaptive_try_lock(lock);
+#elif defined(_WIN32)
     return InterlockedExchange(lock, EBUSY);
 #elif defined(HG_UTIL_HAS_PTHREAD_SPINLOCK_T)
-    if (pthread_spin_trylock(lock))
+    if (pthread_spin_trylock(HG_THREAD_SPIN_NATIVE(lock)))
         return HG_UTIL_FAIL;
+    HG_THREAD_LOCK_STATS_UPDATE(lock, 0);
 
     return HG_UTIL_SUCCESS;
 #else
@@ -124,14 +519,18 @@ hg_thread_spin_try_lock(hg_thread_spin_t *lock)
 static HG_UTIL_INLINE int
 hg_thread_spin_unlock(hg_thread_spin_t *lock)
 {
-#if defined(_WIN32)
+#if defined(HG_UTIL_SPIN_TICKET)
+    return hg_thread_ticket_unlock(lock);
+#elif defined(HG_UTIL_SPIN_ADAPTIVE)
+    return hg_thread_adaptive_unlock(lock);
+#elif defined(_WIN32)
     /* Compiler barrier. The store below acts with release semantics */
     MemoryBarrier();
     *lock = 0;
 
     return HG_UTIL_SUCCESS;
 #elif defined(HG_UTIL_HAS_PTHREAD_SPINLOCK_T)
-    if (pthread_spin_unlock(lock))
+    if (pthread_spin_unlock(HG_THREAD_SPIN_NATIVE(lock)))
         return HG_UTIL_FAIL;
     return HG_UTIL_SUCCESS;
 #else
@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#include "mercury_time.h"
+
+#include "mercury_atomic.h"
+
+#include <stdlib.h>
+
+/****************/
+/* Local Macros */
+/****************/
+
+/* Hardware counter usable for fast time stamps */
+#if defined(_WIN32)
+#    define HG_TIME_FAST_HAS_COUNTER
+#elif (defined(__x86_64__) || defined(__i386__)) &&                           \
+    (defined(__GNUC__) || defined(__clang__))
+#    include <cpuid.h>
+#    include <x86intrin.h>
+#    define HG_TIME_FAST_HAS_COUNTER
+#elif defined(__aarch64__)
+#    define HG_TIME_FAST_HAS_COUNTER
+#endif
+
+/* Calibration states */
+#define HG_TIME_FAST_UNINITIALIZED 0
+#define HG_TIME_FAST_CALIBRATING   1
+#define HG_TIME_FAST_READY         2
+
+/* Time spent comparing counter against clock (ns) */
+#define HG_TIME_FAST_CALIBRATION_NS 2000000
+
+/* Max fixed-point shift */
+#define HG_TIME_FAST_SHIFT_MAX 32
+
+/************************************/
+/* Local Type and Struct Definition */
+/************************************/
+
+/* Fast clock calibration */
+struct hg_time_fast_clock {
+    hg_atomic_int32_t state;       /* Calibration state */
+    hg_atomic_int32_t use_counter; /* Read hardware counter, set last */
+    hg_util_uint64_t mult;         /* ns = (ticks * mult) >> shift */
+    unsigned int shift;            /* Fixed-point shift, mult < 2^32 */
+};
+
+/********************/
+/* Local Prototypes */
+/********************/
+
+/**
+ * Read the hardware counter.
+ */
+static HG_UTIL_INLINE hg_time_fast_t
+hg_time_fast_counter(void);
+
+/**
+ * Return counter frequency in Hz or 0 if the counter cannot be used.
+ */
+static hg_util_uint64_t
+hg_time_fast_counter_freq(void);
+
+/*******************/
+/* Local Variables */
+/*******************/
+
+/* Fast clock calibration */
+static struct hg_time_fast_clock hg_time_fast_clock_g;
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE hg_time_fast_t
+hg_time_fast_counter(void)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER t;
+
+    QueryPerformanceCounter(&t);
+
+    return (hg_time_fast_t) t.QuadPart;
+#elif defined(HG_TIME_FAST_HAS_COUNTER) &&                                     \
+    (defined(__x86_64__) || defined(__i386__))
+    return (hg_time_fast_t) __rdtsc();
+#elif defined(HG_TIME_FAST_HAS_COUNTER) && defined(__aarch64__)
+    hg_time_fast_t t;
+
+    __asm__ __volatile__("isb; mrs %0, cntvct_el0" : "=r"(t)::"memory");
+
+    return t;
+#else
+    return 0;
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_util_uint64_t
+hg_time_fast_counter_freq(void)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER freq;
+
+    if (!QueryPerformanceFrequency(&freq))
+        return 0;
+
+    return (hg_util_uint64_t) freq.QuadPart;
+#elif defined(HG_TIME_FAST_HAS_COUNTER) &&                                     \
+    (defined(__x86_64__) || defined(__i386__))
+    unsigned int eax, ebx, ecx, edx;
+    hg_time_t tv1, tv2;
+    hg_time_fast_t t1, t2;
+    double elapsed;
+
+    /* TSC must be invariant (constant rate across P/C-states) */
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) ||
+        !(edx & (1U << 8)))
+        return 0;
+
+    /* Compare TSC against monotonic clock */
+    hg_time_get_current(&tv1);
+    t1 = hg_time_fast_counter();
+    do {
+        hg_time_get_current(&tv2);
+        elapsed = hg_time_diff(tv2, tv1);
+    } while (elapsed < (double) HG_TIME_FAST_CALIBRATION_NS * 0.000000001);
+    t2 = hg_time_fast_counter();
+    if (t2 <= t1)
+        return 0;
+
+    return (hg_util_uint64_t) ((double) (t2 - t1) / elapsed);
+#elif defined(HG_TIME_FAST_HAS_COUNTER) && defined(__aarch64__)
+    hg_util_uint64_t freq;
+
+    __asm__ __volatile__("mrs %0, cntfrq_el0" : "=r"(freq));
+
+    return freq;
+#else
+    return 0;
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+int
+hg_time_fast_init(void)
+{
+    hg_util_uint64_t freq = 0;
+    unsigned int shift = HG_TIME_FAST_SHIFT_MAX;
+    const char *env;
+
+    if (!hg_atomic_cas32(&hg_time_fast_clock_g.state,
+            HG_TIME_FAST_UNINITIALIZED, HG_TIME_FAST_CALIBRATING)) {
+        /* Another thread is calibrating */
+        while (hg_atomic_get32(&hg_time_fast_clock_g.state) !=
+               HG_TIME_FAST_READY)
+            cpu_spinwait();
+        return HG_UTIL_SUCCESS;
+    }
+
+    /* Allow hardware counter to be disabled */
+    env = getenv("HG_TIME_FAST_DISABLE_COUNTER");
+    if (!env || atoi(env) == 0)
+        freq = hg_time_fast_counter_freq();
+
+    if (freq) {
+        /* Largest shift that keeps mult below 2^32 */
+        while (shift > 0 &&
+               (((hg_util_uint64_t) 1000000000 << shift) / freq) >> 32)
+            shift--;
+        hg_time_fast_clock_g.mult =
+            ((hg_util_uint64_t) 1000000000 << shift) / freq;
+        hg_time_fast_clock_g.shift = shift;
+    } else {
+        /* Ticks are ns */
+        hg_time_fast_clock_g.mult = 1;
+        hg_time_fast_clock_g.shift = 0;
+    }
+
+    /* Publish conversion factors before counter gets used */
+    hg_atomic_set32(&hg_time_fast_clock_g.state, HG_TIME_FAST_READY);
+    if (freq)
+        hg_atomic_set32(&hg_time_fast_clock_g.use_counter, HG_UTIL_TRUE);
+
+    return HG_UTIL_SUCCESS;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_time_fast_t
+hg_time_fast_now(void)
+{
+    hg_time_t tv;
+
+    if (hg_atomic_get32(&hg_time_fast_clock_g.use_counter))
+        return hg_time_fast_counter();
+
+    if (hg_atomic_get32(&hg_time_fast_clock_g.state) != HG_TIME_FAST_READY) {
+        hg_time_fast_init();
+        if (hg_atomic_get32(&hg_time_fast_clock_g.use_counter))
+            return hg_time_fast_counter();
+    }
+
+    /* Fallback to monotonic clock, ticks are ns */
+    hg_time_get_current(&tv);
+#if defined(HG_UTIL_HAS_TIME_H) && defined(HG_UTIL_HAS_CLOCK_GETTIME)
+    return (hg_time_fast_t) tv.tv_sec * 1000000000 +
+           (hg_time_fast_t) tv.tv_nsec;
+#else
+    return (hg_time_fast_t) tv.tv_sec * 1000000000 +
+           (hg_time_fast_t) tv.tv_usec * 1000;
+#endif
+}
+
+/*---------------------------------------------------------------------------*/
+hg_util_uint64_t
+hg_time_fast_to_ns(hg_time_fast_t t)
+{
+    hg_util_uint64_t mult = hg_time_fast_clock_g.mult;
+    unsigned int shift = hg_time_fast_clock_g.shift;
+
+    /* Split multiplication to avoid overflowing 64 bits */
+    return (t >> shift) * mult +
+           (((t & ((((hg_util_uint64_t) 1) << shift) - 1)) * mult) >> shift);
+}
+
+/*---------------------------------------------------------------------------*/
+double
+hg_time_fast_diff(hg_time_fast_t t2, hg_time_fast_t t1)
+{
+    return (double) hg_time_fast_to_ns(t2 - t1) * 0.000000001;
+}
@@ -45,6 +45,9 @@ struct hg_time {
 };
 #endif
 
+/* Fast time stamp (raw counter ticks, use hg_time_fast_to_ns() to convert) */
+typedef hg_util_uint64_t hg_time_fast_t;
+
 /*****************/
 /* Public Macros */
 /*****************/
@@ -160,6 +163,47 @@ hg_time_sleep(const hg_time_t rqt);
 static HG_UTIL_INLINE char *
 hg_time_stamp(void);
 
+/**
+ * Calibrate the fast clock. Uses an invariant TSC (x86), the generic timer
+ * (ARMv8) or the performance counter (Windows) when available, the monotonic
+ * clock otherwise. Called on first use of hg_time_fast_now(). The
+ * HG_TIME_FAST_DISABLE_COUNTER environment variable forces the monotonic
+ * clock.
+ *
+ * \return Non-negative on success or negative on failure
+ */
+HG_UTIL_PUBLIC int
+hg_time_fast_init(void);
+
+/**
+ * Get a fast time stamp. Values are only meaningful relative to each other.
+ *
+ * \return Time stamp
+ */
+HG_UTIL_PUBLIC hg_time_fast_t
+hg_time_fast_now(void);
+
+/**
+ * Convert fast time stamp (or difference of time stamps) to ns.
+ *
+ * \param t [IN]                time stamp
+ *
+ * \return Time in ns
+ */
+HG_UTIL_PUBLIC hg_util_uint64_t
+hg_time_fast_to_ns(hg_time_fast_t t);
+
+/**
+ * Return the number of seconds elapsed between fast time stamps \t1 and \t2.
+ *
+ * \param t2 [IN]               time stamp
+ * \param t1 [IN]               time stamp
+ *
+ * \return Elapsed time in seconds
+ */
+HG_UTIL_PUBLIC double
+hg_time_fast_diff(hg_time_fast_t t2, hg_time_fast_t t1);
+
 /*---------------------------------------------------------------------------*/
 #ifdef _WIN32
 static HG_UTIL_INLINE LARGE_INTEGER
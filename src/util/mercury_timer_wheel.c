@@ -0,0 +1,268 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#include "mercury_timer_wheel.h"
+
+#include <stddef.h>
+
+/****************/
+/* Local Macros */
+/****************/
+
+/* Slot index mask */
+#define HG_TIMER_WHEEL_MASK ((hg_util_uint64_t) HG_TIMER_WHEEL_SIZE - 1)
+
+/* Number of ticks covered by the wheel */
+#define HG_TIMER_WHEEL_RANGE                                                   \
+    ((hg_util_uint64_t) 1 << (HG_TIMER_WHEEL_LEVELS * HG_TIMER_WHEEL_BITS))
+
+/********************/
+/* Local Prototypes */
+/********************/
+
+/**
+ * Insert node into the slot matching its expiration tick. Timers are placed
+ * on the lowest level whose range covers their distance from now, timers
+ * beyond the range of the wheel are placed on the last slot of the top level
+ * and re-inserted when that slot is cascaded.
+ */
+static void
+hg_timer_wheel_insert(
+    struct hg_timer_wheel *wheel, struct hg_timer_wheel_node *node);
+
+/**
+ * Re-insert timers of slot index of level into lower levels.
+ */
+static void
+hg_timer_wheel_cascade(
+    struct hg_timer_wheel *wheel, unsigned int level, unsigned int index);
+
+/**
+ * Timer that precedes node in the list of expired timers (NULL if first).
+ */
+static struct hg_timer_wheel_node *
+hg_timer_wheel_prev(
+    struct hg_timer_wheel *wheel, struct hg_timer_wheel_node *node);
+
+/**
+ * Next tick that must be processed (either a tick whose level 0 slot is not
+ * empty or a tick at which a non-empty slot must be cascaded).
+ */
+static hg_util_uint64_t
+hg_timer_wheel_next_tick(const struct hg_timer_wheel *wheel);
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_timer_wheel_insert(
+    struct hg_timer_wheel *wheel, struct hg_timer_wheel_node *node)
+{
+    hg_util_uint64_t expire = node->expire;
+    hg_util_uint64_t delta = (expire > wheel->now) ? expire - wheel->now : 0;
+    unsigned int level, slot;
+
+    if (delta >= HG_TIMER_WHEEL_RANGE)
+        expire = wheel->now + HG_TIMER_WHEEL_RANGE - 1;
+
+    for (level = 0; level < HG_TIMER_WHEEL_LEVELS - 1; level++)
+        if ((delta >> ((level + 1) * HG_TIMER_WHEEL_BITS)) == 0)
+            break;
+
+    slot = (unsigned int) ((expire >> (level * HG_TIMER_WHEEL_BITS)) &
+                           HG_TIMER_WHEEL_MASK);
+    node->slot = level * HG_TIMER_WHEEL_SIZE + slot;
+    HG_LIST_INSERT_HEAD(&wheel->slots[node->slot], node, entry);
+    wheel->bitmap[level] |= (hg_util_uint64_t) 1 << slot;
+    wheel->count++;
+}
+
+/*---------------------------------------------------------------------------*/
+static void
+hg_timer_wheel_cascade(
+    struct hg_timer_wheel *wheel, unsigned int level, unsigned int index)
+{
+    unsigned int slot = level * HG_TIMER_WHEEL_SIZE + index;
+    struct hg_timer_wheel_node *node = HG_LIST_FIRST(&wheel->slots[slot]);
+
+    /* Detach slot, timers are due within range of lower levels */
+    HG_LIST_INIT(&wheel->slots[slot]);
+    wheel->bitmap[level] &= ~((hg_util_uint64_t) 1 << index);
+
+    while (node) {
+        struct hg_timer_wheel_node *next = HG_LIST_NEXT(node, entry);
+
+        wheel->count--;
+        hg_timer_wheel_insert(wheel, node);
+        node = next;
+    }
+}
+
+/*---------------------------------------------------------------------------*/
+static struct hg_timer_wheel_node *
+hg_timer_wheel_prev(
+    struct hg_timer_wheel *wheel, struct hg_timer_wheel_node *node)
+{
+    /* prev points to the next field of the previous timer or to the head */
+    if (node->entry.prev == &wheel->expired.head)
+        return NULL;
+
+    return (struct hg_timer_wheel_node *) ((char *) node->entry.prev -
+                                           offsetof(struct hg_timer_wheel_node,
+                                               entry.next));
+}
+
+/*---------------------------------------------------------------------------*/
+static hg_util_uint64_t
+hg_timer_wheel_next_tick(const struct hg_timer_wheel *wheel)
+{
+    unsigned int level;
+
+    for (level = 0; level < HG_TIMER_WHEEL_LEVELS; level++) {
+        unsigned int shift = level * HG_TIMER_WHEEL_BITS;
+        hg_util_uint64_t base = wheel->now >> shift;
+        unsigned int index = (unsigned int) (base & HG_TIMER_WHEEL_MASK);
+
+        /* Next non-empty slot in current round of that level */
+        if (index < HG_TIMER_WHEEL_SIZE - 1) {
+            hg_util_uint64_t mask = wheel->bitmap[level] >> (index + 1);
+
+            if (mask)
+                return (base + 1 + (hg_util_uint64_t) __builtin_ctzll(mask))
+                       << shift;
+        }
+
+        /* Remaining slots belong to next round, which starts when the next
+         * level is cascaded */
+        if (wheel->bitmap[level])
+            return ((base | HG_TIMER_WHEEL_MASK) + 1) << shift;
+    }
+
+    return HG_TIMER_WHEEL_NEVER;
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_timer_wheel_init(struct hg_timer_wheel *wheel, hg_util_uint64_t now)
+{
+    unsigned int i;
+
+    for (i = 0; i < HG_TIMER_WHEEL_LEVELS * HG_TIMER_WHEEL_SIZE; i++)
+        HG_LIST_INIT(&wheel->slots[i]);
+    HG_LIST_INIT(&wheel->expired);
+    wheel->expired_last = NULL;
+    for (i = 0; i < HG_TIMER_WHEEL_LEVELS; i++)
+        wheel->bitmap[i] = 0;
+    wheel->now = now;
+    wheel->count = 0;
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_timer_wheel_arm(struct hg_timer_wheel *wheel,
+    struct hg_timer_wheel_node *node, hg_util_uint64_t expire)
+{
+    /* Current tick was already processed */
+    node->expire = (expire > wheel->now) ? expire : wheel->now + 1;
+    hg_timer_wheel_insert(wheel, node);
+}
+
+/*---------------------------------------------------------------------------*/
+void
+hg_timer_wheel_disarm(
+    struct hg_timer_wheel *wheel, struct hg_timer_wheel_node *node)
+{
+    if (node->slot == HG_TIMER_WHEEL_NONE)
+        return;
+
+    /* Expired list is appended to, keep track of its last timer */
+    if (node == wheel->expired_last)
+        wheel->expired_last = hg_timer_wheel_prev(wheel, node);
+
+    HG_LIST_REMOVE(node, entry);
+    if (node->slot != HG_TIMER_WHEEL_EXPIRED) {
+        if (HG_LIST_IS_EMPTY(&wheel->slots[node->slot]))
+            wheel->bitmap[node->slot / HG_TIMER_WHEEL_SIZE] &=
+                ~((hg_util_uint64_t) 1 << (node->slot % HG_TIMER_WHEEL_SIZE));
+        wheel->count--;
+    }
+    node->slot = HG_TIMER_WHEEL_NONE;
+}
+
+/*---------------------------------------------------------------------------*/
+unsigned int
+hg_timer_wheel_advance(struct hg_timer_wheel *wheel, hg_util_uint64_t now)
+{
+    unsigned int count = 0;
+
+    while (wheel->now < now) {
+        hg_util_uint64_t tick = hg_timer_wheel_next_tick(wheel);
+        struct hg_timer_wheel_node *node;
+        unsigned int index, level;
+
+        /* Nothing to process up to now */
+        if (tick > now) {
+            wheel->now = now;
+            break;
+        }
+        wheel->now = tick;
+
+        /* Cascade upper levels whose index wrapped */
+        for (level = 1; level < HG_TIMER_WHEEL_LEVELS; level++) {
+            unsigned int shift = level * HG_TIMER_WHEEL_BITS;
+
+            if (tick & (((hg_util_uint64_t) 1 << shift) - 1))
+                break;
+            index = (unsigned int) ((tick >> shift) & HG_TIMER_WHEEL_MASK);
+            hg_timer_wheel_cascade(wheel, level, index);
+        }
+
+        /* Expire level 0 slot */
+        index = (unsigned int) (tick & HG_TIMER_WHEEL_MASK);
+        while ((node = HG_LIST_FIRST(&wheel->slots[index])) != NULL) {
+            HG_LIST_REMOVE(node, entry);
+            if (wheel->expired_last)
+                HG_LIST_INSERT_AFTER(wheel->expired_last, node, entry);
+            else
+                HG_LIST_INSERT_HEAD(&wheel->expired, node, entry);
+            wheel->expired_last = node;
+            node->slot = HG_TIMER_WHEEL_EXPIRED;
+            wheel->count--;
+            count++;
+        }
+        wheel->bitmap[0] &= ~((hg_util_uint64_t) 1 << index);
+    }
+
+    return count;
+}
+
+/*---------------------------------------------------------------------------*/
+struct hg_timer_wheel_node *
+hg_timer_wheel_pop(struct hg_timer_wheel *wheel)
+{
+    struct hg_timer_wheel_node *node = HG_LIST_FIRST(&wheel->expired);
+
+    if (node) {
+        if (node == wheel->expired_last)
+            wheel->expired_last = NULL;
+        HG_LIST_REMOVE(node, entry);
+        node->slot = HG_TIMER_WHEEL_NONE;
+    }
+
+    return node;
+}
+
+/*---------------------------------------------------------------------------*/
+hg_util_uint64_t
+hg_timer_wheel_next(const struct hg_timer_wheel *wheel)
+{
+    if (!HG_LIST_IS_EMPTY(&wheel->expired))
+        return wheel->now;
+
+    return hg_timer_wheel_next_tick(wheel);
+}
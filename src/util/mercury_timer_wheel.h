@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2013-2019 Argonne National Laboratory, Department of Energy,
+ *                    UChicago Argonne, LLC and The HDF Group.
+ * All rights reserved.
+ *
+ * The full copyright notice, including terms governing use, modification,
+ * and redistribution, is contained in the COPYING file that can be
+ * found at the root of the source code distribution tree.
+ */
+
+#ifndef MERCURY_TIMER_WHEEL_H
+#define MERCURY_TIMER_WHEEL_H
+
+#include "mercury_util_config.h"
+
+#include "mercury_list.h"
+
+/*
+ * Hierarchical timer wheel. Timers are intrusive nodes embedded by the caller
+ * and expire at a given tick (the caller picks the unit, e.g. milliseconds).
+ * Arming and disarming a timer are O(1), expiring is O(1) amortized per timer
+ * (a timer is moved down at most once per level). The wheel is not thread
+ * safe, callers must serialize access.
+ */
+
+/*****************/
+/* Public Macros */
+/*****************/
+
+/* Number of levels and slots per level (one bit per slot in bitmap) */
+#define HG_TIMER_WHEEL_LEVELS 4
+#define HG_TIMER_WHEEL_BITS   6
+#define HG_TIMER_WHEEL_SIZE   (1 << HG_TIMER_WHEEL_BITS)
+
+/* Slot of a timer that is not armed */
+#define HG_TIMER_WHEEL_NONE ((unsigned int) -1)
+
+/* Slot of a timer that expired and has not been popped yet */
+#define HG_TIMER_WHEEL_EXPIRED (HG_TIMER_WHEEL_LEVELS * HG_TIMER_WHEEL_SIZE)
+
+/* Returned by hg_timer_wheel_next() when no timer is armed */
+#define HG_TIMER_WHEEL_NEVER ((hg_util_uint64_t) -1)
+
+/*************************************/
+/* Public Type and Struct Definition */
+/*************************************/
+
+/* Timer node */
+struct hg_timer_wheel_node {
+    HG_LIST_ENTRY(hg_timer_wheel_node) entry; /* Slot or expired list entry */
+    hg_util_uint64_t expire;                  /* Expiration tick */
+    unsigned int slot;                        /* Slot (if armed) */
+};
+
+/* Timer wheel */
+struct hg_timer_wheel {
+    HG_LIST_HEAD(hg_timer_wheel_node)
+    slots[HG_TIMER_WHEEL_LEVELS * HG_TIMER_WHEEL_SIZE]; /* Timer slots */
+    HG_LIST_HEAD(hg_timer_wheel_node) expired;      /* Expired timers */
+    struct hg_timer_wheel_node *expired_last;       /* Last expired timer */
+    hg_util_uint64_t bitmap[HG_TIMER_WHEEL_LEVELS]; /* Occupied slots */
+    hg_util_uint64_t now;                           /* Last processed tick */
+    unsigned int count;                             /* Timers in slots */
+};
+
+/*********************/
+/* Public Prototypes */
+/*********************/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Initialize timer wheel.
+ *
+ * \param wheel [IN/OUT]        pointer to timer wheel
+ * \param now [IN]              current tick
+ */
+HG_UTIL_PUBLIC void
+hg_timer_wheel_init(struct hg_timer_wheel *wheel, hg_util_uint64_t now);
+
+/**
+ * Initialize timer node, must be called before the node is first armed.
+ *
+ * \param node [IN/OUT]         pointer to timer node
+ */
+static HG_UTIL_INLINE void
+hg_timer_wheel_node_init(struct hg_timer_wheel_node *node);
+
+/**
+ * Arm timer to expire at tick expire. Timers that are already due expire on
+ * the next call to hg_timer_wheel_advance() that moves the wheel forward.
+ * The timer must not be armed.
+ *
+ * \param wheel [IN/OUT]        pointer to timer wheel
+ * \param node [IN/OUT]         pointer to timer node
+ * \param expire [IN]           expiration tick
+ */
+HG_UTIL_PUBLIC void
+hg_timer_wheel_arm(struct hg_timer_wheel *wheel,
+    struct hg_timer_wheel_node *node, hg_util_uint64_t expire);
+
+/**
+ * Disarm timer, removing it from the wheel or from the list of expired timers
+ * if it has not been popped yet. Disarming a timer that is not armed has no
+ * effect.
+ *
+ * \param wheel [IN/OUT]        pointer to timer wheel
+ * \param node [IN/OUT]         pointer to timer node
+ */
+HG_UTIL_PUBLIC void
+hg_timer_wheel_disarm(
+    struct hg_timer_wheel *wheel, struct hg_timer_wheel_node *node);
+
+/**
+ * Advance wheel up to tick now and move timers that expired to the list of
+ * expired timers, which can then be retrieved using hg_timer_wheel_pop().
+ * Ticks that cannot expire any timer are skipped.
+ *
+ * \param wheel [IN/OUT]        pointer to timer wheel
+ * \param now [IN]              current tick
+ *
+ * \return Number of timers that expired
+ */
+HG_UTIL_PUBLIC unsigned int
+hg_timer_wheel_advance(struct hg_timer_wheel *wheel, hg_util_uint64_t now);
+
+/**
+ * Retrieve next expired timer, timers are retrieved in order of expiration.
+ * The timer is no longer armed.
+ *
+ * \param wheel [IN/OUT]        pointer to timer wheel
+ *
+ * \return Pointer to timer node or NULL if no timer has expired
+ */
+HG_UTIL_PUBLIC struct hg_timer_wheel_node *
+hg_timer_wheel_pop(struct hg_timer_wheel *wheel);
+
+/**
+ * Get the next tick at which the wheel must be advanced. No timer expires
+ * before that tick, it can be used to bound the time spent waiting.
+ *
+ * \param wheel [IN]            pointer to timer wheel
+ *
+ * \return Tick or HG_TIMER_WHEEL_NEVER if no timer is armed
+ */
+HG_UTIL_PUBLIC hg_util_uint64_t
+hg_timer_wheel_next(const struct hg_timer_wheel *wheel);
+
+/*---------------------------------------------------------------------------*/
+static HG_UTIL_INLINE void
+hg_timer_wheel_node_init(struct hg_timer_wheel_node *node)
+{
+    node->expire = 0;
+    node->slot = HG_TIMER_WHEEL_NONE;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MERCURY_TIMER_WHEEL_H */